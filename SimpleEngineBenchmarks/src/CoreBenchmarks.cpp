@@ -0,0 +1,1131 @@
+#include "SimpleEngineCore/Camera.hpp"
+#include "SimpleEngineCore/Event.hpp"
+#include "SimpleEngineCore/Input.hpp"
+#include "SimpleEngineCore/JobSystem.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Memory.hpp"
+#include "SimpleEngineCore/ProceduralTextures.hpp"
+#include "SimpleEngineCore/TransformHierarchy.hpp"
+#include "SimpleEngineCore/WorldPartition.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/ResourcePool.hpp"
+#include "SimpleEngineCore/Assets/AssetArchive.hpp"
+#include "SimpleEngineCore/Assets/AssetArchiveWriter.hpp"
+#include "SimpleEngineCore/IO/VirtualFileSystem.hpp"
+#include "SimpleEngineCore/Scene/SceneFile.hpp"
+#include "SimpleEngineCore/Math/BatchMath.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/VertexBuffer.hpp"
+
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+#include <glm/matrix.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SimpleEngine {
+
+    static void BM_Camera_ViewMatrix(benchmark::State& state)
+    {
+        Camera camera({ -5.f, 0.f, 0.f });
+        float yaw = 0.f;
+        for (auto _ : state)
+        {
+            camera.add_movement_and_rotation({ 0.01f, 0.f, 0.f }, { 0.f, 0.f, yaw });
+            benchmark::DoNotOptimize(camera.get_view_matrix());
+            yaw = yaw > 1.f ? -1.f : yaw + 0.001f;
+        }
+    }
+    BENCHMARK(BM_Camera_ViewMatrix);
+
+    static void BM_Camera_ProjectionMatrix(benchmark::State& state)
+    {
+        Camera camera;
+        float width = 800.f;
+        for (auto _ : state)
+        {
+            camera.set_viewport_size(width, 600.f);
+            benchmark::DoNotOptimize(camera.get_projection_matrix());
+            width = width > 1600.f ? 800.f : width + 1.f;
+        }
+    }
+    BENCHMARK(BM_Camera_ProjectionMatrix);
+
+    // well conditioned affine transforms: rotation, scales within [0.5, 2], translation within 100 units
+    static std::vector<glm::mat4> make_batch_math_matrices(const size_t count)
+    {
+        std::mt19937 random_engine(42);
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        std::uniform_real_distribution<float> scale(0.5f, 2.f);
+        std::vector<glm::mat4> matrices(count);
+        for (glm::mat4& matrix : matrices)
+        {
+            const glm::vec3 axis(unit(random_engine), unit(random_engine), unit(random_engine) + 2.f);
+            matrix = glm::translate(glm::mat4(1.f), 100.f * glm::vec3(unit(random_engine), unit(random_engine), unit(random_engine)));
+            matrix = glm::rotate(matrix, 3.f * unit(random_engine), axis);
+            matrix = glm::scale(matrix, glm::vec3(scale(random_engine), scale(random_engine), scale(random_engine)));
+        }
+        return matrices;
+    }
+
+    // error relative to the magnitude of the expected value, absolute below 1
+    static float get_batch_math_error(const float* values, const float* expected, const size_t count)
+    {
+        float max_error = 0.f;
+        for (size_t i = 0; i < count; ++i)
+        {
+            max_error = std::max(max_error, std::abs(values[i] - expected[i]) / std::max(1.f, std::abs(expected[i])));
+        }
+        return max_error;
+    }
+
+    // Every kernel of instruction_set against glm, over every count from 1 to 67: the widest kernels handle
+    // 16 floats, 4 matrices, at once, so every tail length is covered several times. The outputs past count
+    // must be left untouched. Returns what failed, empty when everything is within tolerance.
+    static std::string check_batch_math(const BatchMath::EInstructionSet instruction_set)
+    {
+        constexpr size_t max_count = 67;
+        constexpr float matrix_tolerance = 1e-5f;
+        constexpr float inverse_tolerance = 1e-4f;
+        constexpr float sincos_tolerance = 1e-6f;
+        constexpr float sentinel = 12345.f;
+
+        const BatchMath::EInstructionSet previous_instruction_set = BatchMath::get_instruction_set();
+        if (!BatchMath::set_instruction_set(instruction_set))
+        {
+            return "not supported by this CPU";
+        }
+
+        const std::vector<glm::mat4> a = make_batch_math_matrices(max_count);
+        std::vector<glm::mat4> b = make_batch_math_matrices(max_count + 1);
+        b.erase(b.begin());
+        std::vector<glm::vec4> vectors(max_count);
+        std::vector<AABB> boxes(max_count);
+        std::vector<float> angles(max_count);
+        std::mt19937 random_engine(7);
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        for (size_t i = 0; i < max_count; ++i)
+        {
+            vectors[i] = glm::vec4(unit(random_engine), unit(random_engine), unit(random_engine), 1.f) * 50.f;
+            const glm::vec3 center(unit(random_engine) * 20.f, unit(random_engine) * 20.f, unit(random_engine) * 20.f);
+            const glm::vec3 extent(unit(random_engine) + 1.5f, unit(random_engine) + 1.5f, unit(random_engine) + 1.5f);
+            boxes[i] = AABB{ center - extent, center + extent };
+            angles[i] = unit(random_engine) * 1000.f;
+        }
+
+        std::vector<glm::mat4> matrices_out(max_count + 1);
+        std::vector<glm::mat3> normal_out(max_count + 1);
+        std::vector<glm::vec4> vectors_out(max_count + 1);
+        std::vector<AABB> boxes_out(max_count + 1);
+        std::vector<float> sin_out(max_count + 1);
+        std::vector<float> cos_out(max_count + 1);
+
+        std::string error;
+        const auto check = [&error](const char* kernel, const size_t count, const float max_error, const float tolerance, const bool tail_untouched)
+        {
+            if (error.empty() && (!(max_error <= tolerance) || !tail_untouched))
+            {
+                error = std::string(kernel) + " with " + std::to_string(count) + " items: "
+                    + (tail_untouched ? "error " + std::to_string(max_error) : std::string("wrote past the end"));
+            }
+        };
+
+        for (size_t count = 1; count <= max_count && error.empty(); ++count)
+        {
+            std::fill(matrices_out.begin(), matrices_out.end(), glm::mat4(sentinel));
+            BatchMath::mat4_mul(a.data(), b.data(), matrices_out.data(), count);
+            float max_error = 0.f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const glm::mat4 expected = a[i] * b[i];
+                max_error = std::max(max_error, get_batch_math_error(&matrices_out[i][0][0], &expected[0][0], 16));
+            }
+            check("mat4_mul", count, max_error, matrix_tolerance, matrices_out[count][0][0] == sentinel);
+
+            std::fill(matrices_out.begin(), matrices_out.end(), glm::mat4(sentinel));
+            BatchMath::mat4_mul(a[0], b.data(), matrices_out.data(), count);
+            max_error = 0.f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const glm::mat4 expected = a[0] * b[i];
+                max_error = std::max(max_error, get_batch_math_error(&matrices_out[i][0][0], &expected[0][0], 16));
+            }
+            check("mat4_mul with one matrix", count, max_error, matrix_tolerance, matrices_out[count][0][0] == sentinel);
+
+            std::fill(vectors_out.begin(), vectors_out.end(), glm::vec4(sentinel));
+            BatchMath::mat4_mul_vec4(a[0], vectors.data(), vectors_out.data(), count);
+            max_error = 0.f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const glm::vec4 expected = a[0] * vectors[i];
+                max_error = std::max(max_error, get_batch_math_error(&vectors_out[i][0], &expected[0], 4));
+            }
+            check("mat4_mul_vec4", count, max_error, matrix_tolerance, vectors_out[count][0] == sentinel);
+
+            std::fill(matrices_out.begin(), matrices_out.end(), glm::mat4(sentinel));
+            BatchMath::affine_inverse(a.data(), matrices_out.data(), count);
+            max_error = 0.f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const glm::mat4 expected = glm::inverse(a[i]);
+                max_error = std::max(max_error, get_batch_math_error(&matrices_out[i][0][0], &expected[0][0], 16));
+            }
+            check("affine_inverse", count, max_error, inverse_tolerance, matrices_out[count][0][0] == sentinel);
+
+            std::fill(normal_out.begin(), normal_out.end(), glm::mat3(sentinel));
+            BatchMath::normal_matrix(a.data(), normal_out.data(), count);
+            max_error = 0.f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const glm::mat3 expected = glm::transpose(glm::inverse(glm::mat3(a[i])));
+                max_error = std::max(max_error, get_batch_math_error(&normal_out[i][0][0], &expected[0][0], 9));
+            }
+            check("normal_matrix", count, max_error, inverse_tolerance, normal_out[count][0][0] == sentinel);
+
+            std::fill(boxes_out.begin(), boxes_out.end(), AABB{ glm::vec3(sentinel), glm::vec3(sentinel) });
+            BatchMath::transform_aabb(a.data(), boxes.data(), boxes_out.data(), count);
+            max_error = 0.f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                AABB expected{ glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()) };
+                for (int corner = 0; corner < 8; ++corner)
+                {
+                    const glm::vec3 point((corner & 1) ? boxes[i].max.x : boxes[i].min.x,
+                                          (corner & 2) ? boxes[i].max.y : boxes[i].min.y,
+                                          (corner & 4) ? boxes[i].max.z : boxes[i].min.z);
+                    const glm::vec3 transformed = glm::vec3(a[i] * glm::vec4(point, 1.f));
+                    expected.min = glm::min(expected.min, transformed);
+                    expected.max = glm::max(expected.max, transformed);
+                }
+                max_error = std::max(max_error, get_batch_math_error(&boxes_out[i].min.x, &expected.min.x, 3));
+                max_error = std::max(max_error, get_batch_math_error(&boxes_out[i].max.x, &expected.max.x, 3));
+            }
+            check("transform_aabb", count, max_error, matrix_tolerance, boxes_out[count].min.x == sentinel);
+
+            std::fill(sin_out.begin(), sin_out.end(), sentinel);
+            std::fill(cos_out.begin(), cos_out.end(), sentinel);
+            BatchMath::sincos(angles.data(), sin_out.data(), cos_out.data(), count);
+            max_error = 0.f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                max_error = std::max(max_error, static_cast<float>(std::abs(sin_out[i] - std::sin(static_cast<double>(angles[i])))));
+                max_error = std::max(max_error, static_cast<float>(std::abs(cos_out[i] - std::cos(static_cast<double>(angles[i])))));
+            }
+            check("sincos", count, max_error, sincos_tolerance, sin_out[count] == sentinel && cos_out[count] == sentinel);
+        }
+
+        BatchMath::set_instruction_set(previous_instruction_set);
+        return error;
+    }
+
+    // the instruction set picked at startup, restored after each benchmark
+    static BatchMath::EInstructionSet get_best_batch_math_instruction_set()
+    {
+        static const BatchMath::EInstructionSet best_instruction_set = BatchMath::get_instruction_set();
+        return best_instruction_set;
+    }
+
+    // range(0) is the BatchMath::EInstructionSet; skipped when the CPU doesn't support it
+    // or when its kernels don't match glm
+    static bool begin_batch_math_benchmark(benchmark::State& state)
+    {
+        get_best_batch_math_instruction_set();
+        const BatchMath::EInstructionSet instruction_set = static_cast<BatchMath::EInstructionSet>(state.range(0));
+        static std::string errors[4];
+        static bool checked[4] = {};
+        const size_t index = static_cast<size_t>(instruction_set);
+        if (!checked[index])
+        {
+            errors[index] = check_batch_math(instruction_set);
+            checked[index] = true;
+        }
+        if (!errors[index].empty())
+        {
+            state.SkipWithError(errors[index].c_str());
+            return false;
+        }
+        BatchMath::set_instruction_set(instruction_set);
+        state.SetLabel(BatchMath::get_instruction_set_name(instruction_set));
+        return true;
+    }
+
+    // items per second are matrices (vectors, boxes, angles) per second
+    static void end_batch_math_benchmark(benchmark::State& state, const size_t count)
+    {
+        BatchMath::set_instruction_set(get_best_batch_math_instruction_set());
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+    }
+
+    constexpr size_t batch_math_count = 1024;
+
+    static void BM_BatchMath_Mat4Mul(benchmark::State& state)
+    {
+        if (!begin_batch_math_benchmark(state))
+        {
+            return;
+        }
+        const std::vector<glm::mat4> a = make_batch_math_matrices(batch_math_count);
+        const std::vector<glm::mat4> b = make_batch_math_matrices(batch_math_count);
+        std::vector<glm::mat4> out(batch_math_count);
+        for (auto _ : state)
+        {
+            BatchMath::mat4_mul(a.data(), b.data(), out.data(), batch_math_count);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        end_batch_math_benchmark(state, batch_math_count);
+    }
+    BENCHMARK(BM_BatchMath_Mat4Mul)->DenseRange(0, 3);
+
+    // one parent matrix times many local ones, how TransformHierarchy uses it
+    static void BM_BatchMath_Mat4MulShared(benchmark::State& state)
+    {
+        if (!begin_batch_math_benchmark(state))
+        {
+            return;
+        }
+        const std::vector<glm::mat4> b = make_batch_math_matrices(batch_math_count);
+        const glm::mat4 a = make_batch_math_matrices(1)[0];
+        std::vector<glm::mat4> out(batch_math_count);
+        for (auto _ : state)
+        {
+            BatchMath::mat4_mul(a, b.data(), out.data(), batch_math_count);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        end_batch_math_benchmark(state, batch_math_count);
+    }
+    BENCHMARK(BM_BatchMath_Mat4MulShared)->DenseRange(0, 3);
+
+    static void BM_BatchMath_Mat4MulVec4(benchmark::State& state)
+    {
+        if (!begin_batch_math_benchmark(state))
+        {
+            return;
+        }
+        const glm::mat4 m = make_batch_math_matrices(1)[0];
+        std::vector<glm::vec4> vectors(batch_math_count, glm::vec4(1.f, 2.f, 3.f, 1.f));
+        std::vector<glm::vec4> out(batch_math_count);
+        for (auto _ : state)
+        {
+            BatchMath::mat4_mul_vec4(m, vectors.data(), out.data(), batch_math_count);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        end_batch_math_benchmark(state, batch_math_count);
+    }
+    BENCHMARK(BM_BatchMath_Mat4MulVec4)->DenseRange(0, 3);
+
+    static void BM_BatchMath_AffineInverse(benchmark::State& state)
+    {
+        if (!begin_batch_math_benchmark(state))
+        {
+            return;
+        }
+        const std::vector<glm::mat4> matrices = make_batch_math_matrices(batch_math_count);
+        std::vector<glm::mat4> out(batch_math_count);
+        for (auto _ : state)
+        {
+            BatchMath::affine_inverse(matrices.data(), out.data(), batch_math_count);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        end_batch_math_benchmark(state, batch_math_count);
+    }
+    BENCHMARK(BM_BatchMath_AffineInverse)->DenseRange(0, 3);
+
+    static void BM_BatchMath_NormalMatrix(benchmark::State& state)
+    {
+        if (!begin_batch_math_benchmark(state))
+        {
+            return;
+        }
+        const std::vector<glm::mat4> matrices = make_batch_math_matrices(batch_math_count);
+        std::vector<glm::mat3> out(batch_math_count);
+        for (auto _ : state)
+        {
+            BatchMath::normal_matrix(matrices.data(), out.data(), batch_math_count);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        end_batch_math_benchmark(state, batch_math_count);
+    }
+    BENCHMARK(BM_BatchMath_NormalMatrix)->DenseRange(0, 3);
+
+    static void BM_BatchMath_TransformAabb(benchmark::State& state)
+    {
+        if (!begin_batch_math_benchmark(state))
+        {
+            return;
+        }
+        const std::vector<glm::mat4> matrices = make_batch_math_matrices(batch_math_count);
+        std::vector<AABB> boxes(batch_math_count, AABB{ glm::vec3(-1.f), glm::vec3(1.f) });
+        std::vector<AABB> out(batch_math_count);
+        for (auto _ : state)
+        {
+            BatchMath::transform_aabb(matrices.data(), boxes.data(), out.data(), batch_math_count);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        end_batch_math_benchmark(state, batch_math_count);
+    }
+    BENCHMARK(BM_BatchMath_TransformAabb)->DenseRange(0, 3);
+
+    static void BM_BatchMath_Sincos(benchmark::State& state)
+    {
+        if (!begin_batch_math_benchmark(state))
+        {
+            return;
+        }
+        std::vector<float> angles(batch_math_count);
+        for (size_t i = 0; i < batch_math_count; ++i)
+        {
+            angles[i] = static_cast<float>(i) * 0.1f - 50.f;
+        }
+        std::vector<float> sin_out(batch_math_count);
+        std::vector<float> cos_out(batch_math_count);
+        for (auto _ : state)
+        {
+            BatchMath::sincos(angles.data(), sin_out.data(), cos_out.data(), batch_math_count);
+            benchmark::DoNotOptimize(sin_out.data());
+            benchmark::DoNotOptimize(cos_out.data());
+            benchmark::ClobberMemory();
+        }
+        end_batch_math_benchmark(state, batch_math_count);
+    }
+    BENCHMARK(BM_BatchMath_Sincos)->DenseRange(0, 3);
+
+    // A 1M node tree, every node has 8 children, with 1% of the nodes picked at random moved before each
+    // update(); the subtrees below them are updated too. Only update() is timed, on the JobSystem workers
+    // as in the Application. Items per second are updated nodes per second.
+    static void BM_TransformHierarchy_Update(benchmark::State& state)
+    {
+        constexpr size_t nodes_count = 1000000;
+        constexpr size_t children_per_node = 8;
+        constexpr size_t moved_count = nodes_count / 100;
+
+        JobSystem::init();
+        const std::vector<glm::vec3> positions(nodes_count, glm::vec3(1.f, 0.f, 0.f));
+        const std::vector<glm::quat> rotations(nodes_count, glm::angleAxis(0.1f, glm::vec3(0.f, 1.f, 0.f)));
+        const std::vector<glm::vec3> scales(nodes_count, glm::vec3(1.f));
+        std::vector<uint32_t> parents(nodes_count);
+        parents[0] = TransformHierarchy::invalid_node;
+        for (size_t i = 1; i < nodes_count; ++i)
+        {
+            parents[i] = static_cast<uint32_t>((i - 1) / children_per_node);
+        }
+        std::vector<TransformHierarchy::NodeId> nodes(nodes_count);
+        TransformHierarchy transforms;
+        transforms.create_nodes(nodes_count, positions.data(), rotations.data(), scales.data(), parents.data(), nodes.data());
+        transforms.update();
+
+        std::mt19937 random_engine(42);
+        std::uniform_int_distribution<size_t> random_node(0, nodes_count - 1);
+        int64_t updated_nodes_count = 0;
+        float offset = 0.f;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            offset += 0.01f;
+            for (size_t i = 0; i < moved_count; ++i)
+            {
+                transforms.set_local_position(nodes[random_node(random_engine)], glm::vec3(1.f, offset, 0.f));
+            }
+            state.ResumeTiming();
+
+            transforms.update();
+            updated_nodes_count += static_cast<int64_t>(transforms.get_last_update_stats().updated_nodes_count);
+        }
+        JobSystem::shutdown();
+
+        state.SetItemsProcessed(updated_nodes_count);
+        state.counters["updated_nodes"] = static_cast<double>(updated_nodes_count) / std::max<double>(1.0, static_cast<double>(state.iterations()));
+    }
+    BENCHMARK(BM_TransformHierarchy_Update)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    static bool count_mouse_moved(void* pContext, const EventMouseMoved& event)
+    {
+        *static_cast<double*>(pContext) += event.x;
+        return false;
+    }
+
+    // every listener sees the event, arg = listeners count with distinct priorities
+    static void BM_EventBus_Dispatch(benchmark::State& state)
+    {
+        EventBus bus;
+        double sum = 0.0;
+        for (int64_t i = 0; i < state.range(0); ++i)
+        {
+            bus.subscribe<EventMouseMoved>(&count_mouse_moved, &sum, static_cast<int>(i));
+        }
+        EventMouseMoved event(1.0, 2.0);
+        for (auto _ : state)
+        {
+            bus.dispatch(event);
+        }
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_EventBus_Dispatch)->Arg(1)->Arg(4)->Arg(16);
+
+    // the highest priority listener consumes the event, the others are skipped
+    static void BM_EventBus_DispatchConsumed(benchmark::State& state)
+    {
+        EventBus bus;
+        double sum = 0.0;
+        for (int i = 0; i < 16; ++i)
+        {
+            bus.subscribe<EventMouseMoved>(&count_mouse_moved, &sum, i);
+        }
+        bus.subscribe<EventMouseMoved>(
+            [](void* pContext, const EventMouseMoved& event)
+            {
+                return true;
+            }, nullptr, 100);
+        EventMouseMoved event(1.0, 2.0);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(bus.dispatch(event));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_EventBus_DispatchConsumed);
+
+    // events without a listener still pay for the table lookup
+    static void BM_EventBus_DispatchUnhandled(benchmark::State& state)
+    {
+        EventBus bus;
+        EventWindowClose event;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(bus.dispatch(event));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_EventBus_DispatchUnhandled);
+
+    static bool count_key_pressed(void* pContext, const EventKeyPressed& event)
+    {
+        ++*static_cast<int64_t*>(pContext);
+        return false;
+    }
+
+    // a frame of key presses: queued, then delivered, arg = events per frame
+    static void BM_EventBus_PostAndDispatchQueued(benchmark::State& state)
+    {
+        EventBus bus;
+        int64_t delivered = 0;
+        bus.subscribe<EventKeyPressed>(&count_key_pressed, &delivered);
+        for (auto _ : state)
+        {
+            for (int64_t i = 0; i < state.range(0); ++i)
+            {
+                bus.post(EventKeyPressed(KeyCode::KEY_W, true));
+            }
+            bus.dispatch_queued();
+        }
+        benchmark::DoNotOptimize(delivered);
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_EventBus_PostAndDispatchQueued)->Arg(16)->Arg(256);
+
+    // a frame of mouse moves from a high polling rate mouse, coalesced into a single delivered event
+    static void BM_EventBus_MouseMoveStorm(benchmark::State& state)
+    {
+        EventBus bus;
+        double sum = 0.0;
+        bus.subscribe<EventMouseMoved>(&count_mouse_moved, &sum);
+        for (auto _ : state)
+        {
+            for (int64_t i = 0; i < state.range(0); ++i)
+            {
+                bus.post(EventMouseMoved(static_cast<double>(i), 0.0));
+            }
+            bus.dispatch_queued();
+        }
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_EventBus_MouseMoveStorm)->Arg(256);
+
+    // producers on several threads contending for the queue, thread 0 also delivers
+    static void BM_EventBus_PostFromThreads(benchmark::State& state)
+    {
+        static EventBus bus;
+        for (auto _ : state)
+        {
+            bus.post(EventKeyReleased(KeyCode::KEY_SPACE));
+            if (state.thread_index() == 0)
+            {
+                bus.dispatch_queued();
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_EventBus_PostFromThreads)->Threads(1)->Threads(4);
+
+    // the writer thread formats into a logger without sinks while the benchmark runs
+    class NullLoggerScope
+    {
+    public:
+        NullLoggerScope()
+            : m_pPreviousLogger(spdlog::default_logger())
+        {
+            Log::flush();
+            spdlog::set_default_logger(std::make_shared<spdlog::logger>("benchmark"));
+        }
+
+        ~NullLoggerScope()
+        {
+            Log::flush();
+            spdlog::set_default_logger(m_pPreviousLogger);
+        }
+
+    private:
+        std::shared_ptr<spdlog::logger> m_pPreviousLogger;
+    };
+
+    // cost of one call on the logging thread; the buffer is flushed untimed every 1024 calls, so nothing is dropped
+    static void BM_Log_Numbers(benchmark::State& state)
+    {
+        NullLoggerScope null_logger;
+        const uint64_t dropped_count = Log::get_dropped_count();
+        int i = 0;
+        for (auto _ : state)
+        {
+            LOG_INFO("[Mouse button pressed: {0}, at ({1}, {2})", i, 512.5, 384.25);
+            if (++i == 1024)
+            {
+                state.PauseTiming();
+                Log::flush();
+                i = 0;
+                state.ResumeTiming();
+            }
+        }
+        state.counters["dropped"] = static_cast<double>(Log::get_dropped_count() - dropped_count);
+    }
+    BENCHMARK(BM_Log_Numbers);
+
+    static void BM_Log_Strings(benchmark::State& state)
+    {
+        NullLoggerScope null_logger;
+        const std::string path = "frames/frame_000042.png";
+        int i = 0;
+        for (auto _ : state)
+        {
+            LOG_ERROR("Can't write frame {0}: {1}", path, "disk full");
+            if (++i == 1024)
+            {
+                state.PauseTiming();
+                Log::flush();
+                i = 0;
+                state.ResumeTiming();
+            }
+        }
+    }
+    BENCHMARK(BM_Log_Strings);
+
+    // below the runtime level: one relaxed load
+    static void BM_Log_Filtered(benchmark::State& state)
+    {
+        Log::set_level(Log::ELevel::Warn);
+        int i = 0;
+        for (auto _ : state)
+        {
+            LOG_INFO("[Mouse button pressed: {0}, at ({1}, {2})", i++, 512.5, 384.25);
+        }
+        Log::set_level(Log::ELevel::Info);
+    }
+    BENCHMARK(BM_Log_Filtered);
+
+    // what each LOG_* call cost before: formatting and writing on the calling thread
+    static void BM_Log_SpdlogSynchronous(benchmark::State& state)
+    {
+        NullLoggerScope null_logger;
+        int i = 0;
+        for (auto _ : state)
+        {
+            spdlog::info("[Mouse button pressed: {0}, at ({1}, {2})", i++, 512.5, 384.25);
+        }
+    }
+    BENCHMARK(BM_Log_SpdlogSynchronous);
+
+    static void BM_BufferLayout_Construct(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            BufferLayout layout{
+                ShaderDataType::Float3,
+                ShaderDataType::Float3,
+                ShaderDataType::Float2,
+                ShaderDataType::Float2
+            };
+            benchmark::DoNotOptimize(layout.get_stride());
+        }
+    }
+    BENCHMARK(BM_BufferLayout_Construct);
+
+    // one bump of the arena offset per allocation, the arena is reset every 1024 allocations like a frame would
+    static void BM_FrameArena_Allocate(benchmark::State& state)
+    {
+        FrameArena arena(size_t(1) << 20);
+        int i = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(arena.allocate(64, 16));
+            if (++i == 1024)
+            {
+                arena.reset();
+                i = 0;
+            }
+        }
+    }
+    BENCHMARK(BM_FrameArena_Allocate);
+
+    template<typename TAllocator>
+    static void BM_List_PushPop(benchmark::State& state)
+    {
+        std::list<uint64_t, TAllocator> list;
+        for (auto _ : state)
+        {
+            for (uint64_t i = 0; i < 64; ++i)
+            {
+                list.push_back(i);
+            }
+            while (!list.empty())
+            {
+                list.pop_front();
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * 64);
+    }
+    BENCHMARK_TEMPLATE(BM_List_PushPop, std::allocator<uint64_t>);
+    BENCHMARK_TEMPLATE(BM_List_PushPop, PoolAllocator<uint64_t>);
+
+    static void BM_ObjectPool_CreateDestroy(benchmark::State& state)
+    {
+        ObjectPool<Camera> pool;
+        for (auto _ : state)
+        {
+            Camera* pCamera = pool.create();
+            benchmark::DoNotOptimize(pCamera);
+            pool.destroy(pCamera);
+        }
+    }
+    BENCHMARK(BM_ObjectPool_CreateDestroy);
+
+    static void BM_ProceduralTextures_Smile(benchmark::State& state)
+    {
+        const unsigned int size = static_cast<unsigned int>(state.range(0));
+        std::vector<unsigned char> data(size * size * 3);
+        for (auto _ : state)
+        {
+            generate_smile_texture(data.data(), size, size);
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+    }
+    BENCHMARK(BM_ProceduralTextures_Smile)->Arg(256)->Arg(1000);
+
+    static void BM_ProceduralTextures_Quads(benchmark::State& state)
+    {
+        const unsigned int size = static_cast<unsigned int>(state.range(0));
+        std::vector<unsigned char> data(size * size * 3);
+        for (auto _ : state)
+        {
+            generate_quads_texture(data.data(), size, size);
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+    }
+    BENCHMARK(BM_ProceduralTextures_Quads)->Arg(256)->Arg(1000);
+
+    static void BM_Input_Queries(benchmark::State& state)
+    {
+        Input::PressKey(KeyCode::KEY_W);
+        Input::PressMouseButton(MouseButton::MOUSE_BUTTON_RIGHT);
+        Input::NewFrame(0.0);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(Input::IsKeyPressed(KeyCode::KEY_W));
+            benchmark::DoNotOptimize(Input::IsKeyPressed(KeyCode::KEY_S));
+            benchmark::DoNotOptimize(Input::IsMouseButtonPressed(MouseButton::MOUSE_BUTTON_RIGHT));
+        }
+        Input::ReleaseKey(KeyCode::KEY_W);
+        Input::ReleaseMouseButton(MouseButton::MOUSE_BUTTON_RIGHT);
+        Input::NewFrame(0.0);
+        state.SetItemsProcessed(state.iterations() * 3);
+    }
+    BENCHMARK(BM_Input_Queries);
+
+    // a frame of typical input: a key tap, a held key and a few cursor moves, then the snapshot swap
+    static void BM_Input_NewFrame(benchmark::State& state)
+    {
+        double time = 0.0;
+        Input::PressKey(KeyCode::KEY_W);
+        for (auto _ : state)
+        {
+            Input::PressKey(KeyCode::KEY_E);
+            Input::ReleaseKey(KeyCode::KEY_E);
+            for (int i = 0; i < 4; ++i)
+            {
+                Input::MoveMouse(time, time);
+            }
+            Input::NewFrame(time);
+            benchmark::DoNotOptimize(Input::GetKeyHeldTime(KeyCode::KEY_W));
+            time += 1.0 / 60.0;
+        }
+        Input::ReleaseKey(KeyCode::KEY_W);
+        Input::NewFrame(time);
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_Input_NewFrame);
+
+    struct PooledResource
+    {
+        unsigned int id = 0;
+        unsigned int size = 0;
+    };
+
+    // what a render command pays to turn its 32-bit handles back into objects
+    static void BM_ResourcePool_Get(benchmark::State& state)
+    {
+        ResourcePool<PooledResource> pool;
+        std::vector<Handle<PooledResource>> handles;
+        for (unsigned int i = 0; i < static_cast<unsigned int>(state.range(0)); ++i)
+        {
+            handles.push_back(pool.create(PooledResource{ i, i * 4 }));
+        }
+        for (auto _ : state)
+        {
+            unsigned int sum = 0;
+            for (const Handle<PooledResource> handle : handles)
+            {
+                sum += pool.get(handle)->size;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_ResourcePool_Get)->Arg(64)->Arg(4096);
+
+    static void BM_ResourcePool_CreateDestroy(benchmark::State& state)
+    {
+        ResourcePool<PooledResource> pool;
+        uint64_t frame_index = 0;
+        for (auto _ : state)
+        {
+            const Handle<PooledResource> handle = pool.create(PooledResource{ 1, 4 });
+            pool.destroy(handle, frame_index);
+            pool.release_retired(frame_index);
+            ++frame_index;
+        }
+    }
+    BENCHMARK(BM_ResourcePool_CreateDestroy);
+
+    constexpr size_t archive_entries_count = 10000;
+    constexpr size_t archive_entry_size = 64 * 1024;
+
+    static std::string get_archive_entry_path(const size_t index)
+    {
+        return "textures/level_" + std::to_string(index % 16) + "/texture_" + std::to_string(index) + ".tex";
+    }
+
+    // written once: 10k entries of 64 KB, each stored raw, with LZ4 and with zstd in turn
+    static const std::string& get_benchmark_archive()
+    {
+        static const std::string path = [] {
+            const std::string archive_path = (std::filesystem::temp_directory_path() / "SimpleEngineBenchmarks.archive").string();
+            // texture-like data: smooth gradients with a little noise, compresses about 3:1
+            std::vector<uint8_t> data(archive_entry_size);
+            uint32_t seed = 1;
+            for (size_t i = 0; i < data.size(); ++i)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                data[i] = static_cast<uint8_t>((i / 64) + ((seed >> 28) & 3));
+            }
+            AssetArchiveWriter writer;
+            writer.open(archive_path);
+            for (size_t i = 0; i < archive_entries_count; ++i)
+            {
+                writer.add(get_archive_entry_path(i), data.data(), data.size(), AssetArchiveFormat::EAssetType::Raw,
+                           static_cast<AssetArchiveFormat::ECompression>(i % 3));
+            }
+            writer.finish();
+            return archive_path;
+        }();
+        return path;
+    }
+
+    static void BM_AssetArchive_Open(benchmark::State& state)
+    {
+        const std::string& path = get_benchmark_archive();
+        for (auto _ : state)
+        {
+            AssetArchive archive;
+            benchmark::DoNotOptimize(archive.open(path));
+        }
+    }
+    BENCHMARK(BM_AssetArchive_Open);
+
+    static void BM_AssetArchive_Find(benchmark::State& state)
+    {
+        AssetArchive archive;
+        archive.open(get_benchmark_archive());
+        std::vector<std::string> paths;
+        for (size_t i = 0; i < archive_entries_count; i += 7)
+        {
+            paths.push_back(get_archive_entry_path(i));
+        }
+        for (auto _ : state)
+        {
+            for (const std::string& path : paths)
+            {
+                benchmark::DoNotOptimize(archive.find(path));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(paths.size()));
+    }
+    BENCHMARK(BM_AssetArchive_Find);
+
+    // range(0) is the ECompression of the entries loaded: in place, LZ4 or zstd
+    static void BM_AssetArchive_Load(benchmark::State& state)
+    {
+        AssetArchive archive;
+        archive.open(get_benchmark_archive());
+        std::vector<uint8_t> storage;
+        size_t index = static_cast<size_t>(state.range(0));
+        for (auto _ : state)
+        {
+            ByteSpan data;
+            archive.load(archive.find(get_archive_entry_path(index)), storage, data);
+            benchmark::DoNotOptimize(data.data[data.size - 1]);
+            index = (index + 3) % archive_entries_count;
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(archive_entry_size));
+    }
+    BENCHMARK(BM_AssetArchive_Load)->Arg(0)->Arg(1)->Arg(2);
+
+    constexpr size_t small_files_count = 4096;
+    constexpr size_t small_file_size = 4 * 1024;
+
+    // written once: 4096 loose files of 4 KB, the page cache holds them after the first run
+    static const std::string& get_small_files_directory()
+    {
+        static const std::string directory = [] {
+            const std::filesystem::path path = std::filesystem::temp_directory_path() / "SimpleEngineBenchmarks.files";
+            std::filesystem::create_directories(path);
+            const std::vector<char> data(small_file_size, 'x');
+            for (size_t i = 0; i < small_files_count; ++i)
+            {
+                std::ofstream file(path / std::to_string(i), std::ios::binary);
+                file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            }
+            return path.string();
+        }();
+        return directory;
+    }
+
+    struct SmallRead
+    {
+        std::chrono::steady_clock::time_point completed;
+        std::atomic<size_t>* pRemaining = nullptr;
+    };
+
+    // range(0): 0 reads on the thread pool, 1 through io_uring. Every iteration queues all the files at once,
+    // the latencies are from that moment to each callback
+    static void BM_VirtualFileSystem_SmallReads(benchmark::State& state)
+    {
+        const std::string& directory = get_small_files_directory();
+        VirtualFileSystem::Settings settings;
+        settings.use_io_uring = state.range(0) != 0;
+        VirtualFileSystem::init(settings);
+        if (settings.use_io_uring && !VirtualFileSystem::get_stats().io_uring)
+        {
+            VirtualFileSystem::shutdown();
+            state.SkipWithError("io_uring isn't available");
+            return;
+        }
+        VirtualFileSystem::mount_directory("", directory);
+
+        std::vector<std::string> paths(small_files_count);
+        std::vector<SmallRead> reads(small_files_count);
+        std::vector<VirtualFileSystem::ReadRequest> requests(small_files_count);
+        std::atomic<size_t> remaining{ 0 };
+        for (size_t i = 0; i < small_files_count; ++i)
+        {
+            paths[i] = std::to_string(i);
+            reads[i].pRemaining = &remaining;
+            requests[i].path = paths[i];
+            requests[i].pContext = &reads[i];
+            requests[i].callback = [](void* pContext, const VirtualFileSystem::ReadResult&)
+            {
+                SmallRead& read = *static_cast<SmallRead*>(pContext);
+                read.completed = std::chrono::steady_clock::now();
+                read.pRemaining->fetch_sub(1, std::memory_order_release);
+            };
+        }
+
+        std::vector<double> latencies;
+        latencies.reserve(small_files_count * 16);
+        for (auto _ : state)
+        {
+            remaining.store(small_files_count, std::memory_order_relaxed);
+            const auto start = std::chrono::steady_clock::now();
+            VirtualFileSystem::read_async(requests.data(), requests.size(), nullptr);
+            while (remaining.load(std::memory_order_acquire) != 0)
+            {
+                std::this_thread::yield();
+            }
+            if (latencies.size() < latencies.capacity())
+            {
+                for (const SmallRead& read : reads)
+                {
+                    latencies.push_back(std::chrono::duration<double, std::micro>(read.completed - start).count());
+                }
+            }
+        }
+        VirtualFileSystem::shutdown();
+
+        std::sort(latencies.begin(), latencies.end());
+        state.counters["p50_us"] = latencies[latencies.size() / 2];
+        state.counters["p99_us"] = latencies[latencies.size() * 99 / 100];
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(small_files_count));
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(small_files_count * small_file_size));
+    }
+    BENCHMARK(BM_VirtualFileSystem_SmallReads)->Arg(0)->Arg(1)->UseRealTime();
+
+    constexpr int world_cells_per_side = 32;
+    constexpr size_t world_cubes_per_side = 16;
+
+    // written once: 32x32 cells of 256 cubes, 64 units wide
+    static const std::string& get_world_directory()
+    {
+        static const std::string directory = [] {
+            const std::filesystem::path path = std::filesystem::temp_directory_path() / "SimpleEngineBenchmarks.world";
+            std::filesystem::create_directories(path);
+            std::vector<WorldPartition::Cube> cubes(world_cubes_per_side * world_cubes_per_side);
+            for (int y = 0; y < world_cells_per_side; ++y)
+            {
+                for (int x = 0; x < world_cells_per_side; ++x)
+                {
+                    for (size_t i = 0; i < cubes.size(); ++i)
+                    {
+                        cubes[i].position = glm::vec3(x * 64.f + (i % world_cubes_per_side) * 4.f, y * 64.f + (i / world_cubes_per_side) * 4.f, 0.f);
+                    }
+                    WorldPartition::save_cell(WorldPartition::get_cell_path(path.string(), glm::ivec2(x, y)), cubes.data(), cubes.size());
+                }
+            }
+            return path.string();
+        }();
+        return directory;
+    }
+
+    // main thread cost of a frame while the camera circles the world at 60 units per second of 60 Hz frames,
+    // cells are read and unloaded all the way round
+    static void BM_WorldPartition_Fly(benchmark::State& state)
+    {
+        VirtualFileSystem::init();
+        VirtualFileSystem::mount_directory("", get_world_directory());
+        TransformHierarchy transforms;
+        WorldPartition::Settings settings;
+        settings.directory = "";
+        WorldPartition::init(settings, transforms,
+                             [](void*, const TransformHierarchy::NodeId*, const size_t) {},
+                             [](void*, const TransformHierarchy::NodeId*, const size_t) {}, nullptr);
+
+        const glm::vec2 center(world_cells_per_side * 32.f);
+        const float radius = world_cells_per_side * 20.f;
+        uint64_t frame = 0;
+        size_t cubes_count = 0;
+        for (auto _ : state)
+        {
+            const double time = frame++ / 60.0;
+            const float angle = static_cast<float>(time) * 60.f / radius;
+            WorldPartition::update(glm::vec3(center.x + radius * std::cos(angle), center.y + radius * std::sin(angle), 0.f), time);
+            transforms.update();
+            cubes_count += transforms.get_nodes_count();
+        }
+        const WorldPartition::Stats stats = WorldPartition::get_stats();
+        WorldPartition::shutdown();
+        VirtualFileSystem::shutdown();
+
+        state.counters["cubes"] = static_cast<double>(cubes_count) / std::max<int64_t>(state.iterations(), 1);
+        state.counters["loaded_cells"] = static_cast<double>(stats.loaded_cells_count);
+        state.counters["unloaded_cells"] = static_cast<double>(stats.unloaded_cells_count);
+    }
+    BENCHMARK(BM_WorldPartition_Fly)->UseRealTime();
+
+    constexpr size_t scene_cubes_count = 1000000;
+
+    // written once in both forms: a million cubes, every 16th parented to the one before it, and 1024 point lights
+    static const std::string& get_benchmark_scene(const bool text)
+    {
+        static const std::array<std::string, 2> paths = [] {
+            const std::filesystem::path directory = std::filesystem::temp_directory_path();
+            SceneData scene;
+            scene.cubes.reserve(scene_cubes_count);
+            for (size_t i = 0; i < scene_cubes_count; ++i)
+            {
+                SceneCube cube;
+                cube.position = glm::vec3((i % 1000) * 4.f, (i / 1000) * 4.f, static_cast<float>(i % 7));
+                cube.rotation = glm::quat(glm::vec3(0.f, 0.f, i * 0.001f));
+                cube.parent = i % 16 == 15 ? static_cast<uint32_t>(i - 1) : SceneCube::no_parent;
+                scene.cubes.push_back(cube);
+            }
+            for (size_t i = 0; i < 1024; ++i)
+            {
+                PointLight light;
+                light.position = glm::vec3((i % 32) * 125.f, (i / 32) * 125.f, 2.f);
+                scene.point_lights.push_back(light);
+            }
+            scene.directional_lights.push_back(DirectionalLight());
+            scene.environments.push_back(SceneEnvironment());
+            const std::string binary_path = (directory / "SimpleEngineBenchmarks.sescene").string();
+            const std::string text_path = (directory / "SimpleEngineBenchmarks.sescene.txt").string();
+            write_scene_binary(binary_path, scene);
+            write_scene_text(text_path, scene);
+            return std::array<std::string, 2>{ binary_path, text_path };
+        }();
+        return paths[text ? 1 : 0];
+    }
+
+    // range(0): 0 reads the binary form, 1 the text form. What Application::load_scene() does before touching
+    // the GPU: read the file, then create the cubes' nodes from the field arrays
+    static void BM_SceneFile_Load(benchmark::State& state)
+    {
+        const std::string& path = get_benchmark_scene(state.range(0) != 0);
+        const int64_t file_size = static_cast<int64_t>(std::filesystem::file_size(path));
+        SceneData scene;
+        std::vector<TransformHierarchy::NodeId> nodes;
+        for (auto _ : state)
+        {
+            read_scene(path, scene);
+            TransformHierarchy transforms;
+            nodes.resize(scene.cubes.size());
+            transforms.create_nodes(scene.cubes.size(),
+                                    scene.cubes.get_field<&SceneCube::position>().data(),
+                                    scene.cubes.get_field<&SceneCube::rotation>().data(),
+                                    scene.cubes.get_field<&SceneCube::scale>().data(),
+                                    scene.cubes.get_field<&SceneCube::parent>().data(),
+                                    nodes.data());
+            benchmark::DoNotOptimize(transforms.get_nodes_count());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(scene_cubes_count));
+        state.SetBytesProcessed(state.iterations() * file_size);
+    }
+    BENCHMARK(BM_SceneFile_Load)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
@@ -0,0 +1,151 @@
+#include "SimpleEngineCore/Rendering/OpenGL/HeadlessContext.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/Renderer_OpenGL.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/Framebuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/ShaderProgram.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/ShaderStorageBuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/VertexArray.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/VertexBuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/IndexBuffer.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace SimpleEngine {
+
+    constexpr unsigned int target_size = 256;
+
+    const float cube_positions[] = {
+        -1.f, -1.f, -1.f,    1.f, -1.f, -1.f,    1.f,  1.f, -1.f,   -1.f,  1.f, -1.f,
+        -1.f, -1.f,  1.f,    1.f, -1.f,  1.f,    1.f,  1.f,  1.f,   -1.f,  1.f,  1.f
+    };
+
+    const uint32_t cube_indices[] = {
+        0, 1, 2, 2, 3, 0,    4, 5, 6, 6, 7, 4,    0, 4, 7, 7, 3, 0,
+        1, 5, 6, 6, 2, 1,    3, 2, 6, 6, 7, 3,    0, 1, 5, 5, 4, 0
+    };
+
+    const char* draw_vertex_shader =
+        R"(#version 450
+           layout(location = 0) in vec3 vertex_position;
+           uniform mat4 model_view_projection_matrix;
+           void main() {
+              gl_Position = model_view_projection_matrix * vec4(vertex_position * 0.1, 1.0);
+           }
+        )";
+
+    const char* draw_fragment_shader =
+        R"(#version 450
+           out vec4 frag_color;
+           void main() {
+              frag_color = vec4(1.0, 0.5, 0.0, 1.0);
+           }
+        )";
+
+    // one context for the whole run, created on first use so the CPU-only benchmarks run without EGL
+    struct GLBenchmarkContext
+    {
+        HeadlessContext context;
+        std::unique_ptr<Framebuffer> target;
+        bool initialized = false;
+    };
+
+    static GLBenchmarkContext* get_gl_context()
+    {
+        static GLBenchmarkContext s_gl;
+        static bool s_tried = false;
+        if (!s_tried)
+        {
+            s_tried = true;
+            if (s_gl.context.create() && Renderer_OpenGL::init(&HeadlessContext::get_proc_address))
+            {
+                s_gl.target = std::make_unique<Framebuffer>(target_size, target_size,
+                    std::initializer_list<Framebuffer::EFormat>{ Framebuffer::EFormat::RGBA8 });
+                s_gl.target->set_as_default();
+                Renderer_OpenGL::set_viewport(target_size, target_size);
+                s_gl.initialized = true;
+            }
+        }
+        return s_gl.initialized ? &s_gl : nullptr;
+    }
+
+    static void BM_GL_VertexBufferCreate(benchmark::State& state)
+    {
+        if (!get_gl_context())
+        {
+            state.SkipWithError("no headless OpenGL context");
+            return;
+        }
+        const std::vector<float> vertices(static_cast<size_t>(state.range(0)) / sizeof(float), 1.f);
+        for (auto _ : state)
+        {
+            VertexBuffer vertex_buffer(vertices.data(), vertices.size() * sizeof(float), { ShaderDataType::Float3 });
+            benchmark::DoNotOptimize(vertex_buffer.get_handle());
+        }
+        Renderer_OpenGL::finish();
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_GL_VertexBufferCreate)->Arg(4 << 10)->Arg(1 << 20);
+
+    static void BM_GL_ShaderStorageBufferUpload(benchmark::State& state)
+    {
+        if (!get_gl_context())
+        {
+            state.SkipWithError("no headless OpenGL context");
+            return;
+        }
+        const std::vector<uint8_t> data(static_cast<size_t>(state.range(0)), 1);
+        ShaderStorageBuffer buffer;
+        for (auto _ : state)
+        {
+            buffer.set_data(data.data(), data.size());
+        }
+        Renderer_OpenGL::finish();
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_GL_ShaderStorageBufferUpload)->Arg(4 << 10)->Arg(64 << 10)->Arg(1 << 20);
+
+    // submission of range(0) draw calls plus the wait for the GPU, like one frame
+    static void BM_GL_DrawSubmission(benchmark::State& state)
+    {
+        if (!get_gl_context())
+        {
+            state.SkipWithError("no headless OpenGL context");
+            return;
+        }
+        ShaderProgram shader_program(draw_vertex_shader, draw_fragment_shader);
+        if (!shader_program.is_compiled())
+        {
+            state.SkipWithError("draw shader didn't compile");
+            return;
+        }
+        VertexBuffer vertex_buffer(cube_positions, sizeof(cube_positions), { ShaderDataType::Float3 });
+        IndexBuffer index_buffer(cube_indices, sizeof(cube_indices) / sizeof(uint32_t));
+        VertexArray vertex_array;
+        vertex_array.add_vertex_buffer(vertex_buffer);
+        vertex_array.set_index_buffer(index_buffer);
+
+        const int64_t draws_count = state.range(0);
+        Renderer_OpenGL::enable_depth_test();
+        for (auto _ : state)
+        {
+            Renderer_OpenGL::clear();
+            shader_program.bind();
+            for (int64_t i = 0; i < draws_count; ++i)
+            {
+                glm::mat4 model_view_projection_matrix(1.f);
+                model_view_projection_matrix[3][0] = static_cast<float>(i % 16) / 8.f - 1.f;
+                model_view_projection_matrix[3][1] = static_cast<float>(i / 16 % 16) / 8.f - 1.f;
+                shader_program.set_matrix4("model_view_projection_matrix", model_view_projection_matrix);
+                Renderer_OpenGL::draw(vertex_array);
+            }
+            Renderer_OpenGL::finish();
+        }
+        Renderer_OpenGL::disable_depth_test();
+        state.SetItemsProcessed(state.iterations() * draws_count);
+    }
+    BENCHMARK(BM_GL_DrawSubmission)->Arg(100)->Arg(1000)->UseRealTime();
+
+}
@@ -0,0 +1,33 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <vector>
+
+// Writes JSON results to SimpleEngineBenchmarks.json unless --benchmark_out is given,
+// compare runs with tools/compare.py from the Google Benchmark repository.
+int main(int argc, char** argv)
+{
+    std::vector<char*> arguments(argv, argv + argc);
+    bool has_output = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        has_output = has_output || std::strncmp(argv[i], "--benchmark_out=", 16) == 0;
+    }
+    char default_output[] = "--benchmark_out=SimpleEngineBenchmarks.json";
+    char default_output_format[] = "--benchmark_out_format=json";
+    if (!has_output)
+    {
+        arguments.push_back(default_output);
+        arguments.push_back(default_output_format);
+    }
+    int arguments_count = static_cast<int>(arguments.size());
+
+    benchmark::Initialize(&arguments_count, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(arguments_count, arguments.data()))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,413 @@
+#include "Converters.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_TGA
+#define STBI_ONLY_BMP
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace SimpleEngine {
+
+    using namespace AssetArchiveFormat;
+
+    static std::string_view get_extension(std::string_view path)
+    {
+        const size_t dot = path.rfind('.');
+        return dot == std::string_view::npos || path.find('/', dot) != std::string_view::npos ? std::string_view() : path.substr(dot + 1);
+    }
+
+    bool get_cooked_type(const std::string& path, EAssetType& type)
+    {
+        std::string extension(get_extension(path));
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        if (extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "tga" || extension == "bmp")
+        {
+            type = EAssetType::Texture;
+            return true;
+        }
+        if (extension == "obj")
+        {
+            type = EAssetType::Mesh;
+            return true;
+        }
+        if (extension == "vert" || extension == "frag" || extension == "geom" || extension == "comp")
+        {
+            type = EAssetType::Shader;
+            return true;
+        }
+        return false;
+    }
+
+    bool read_file(const std::string& path, std::vector<uint8_t>& data)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            return false;
+        }
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        return data.empty() || file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    template<typename T>
+    static void append(std::vector<uint8_t>& output, const T& value)
+    {
+        const size_t offset = output.size();
+        output.resize(offset + sizeof(T));
+        std::memcpy(output.data() + offset, &value, sizeof(T));
+    }
+
+    bool cook_texture(const std::string& path, const std::vector<uint8_t>& source, std::vector<uint8_t>& output)
+    {
+        stbi_set_flip_vertically_on_load_thread(1);
+        int width = 0;
+        int height = 0;
+        int channels_count = 0;
+        stbi_uc* pixels = stbi_load_from_memory(source.data(), static_cast<int>(source.size()), &width, &height, &channels_count, 4);
+        if (!pixels)
+        {
+            LOG_ERROR("Cooker: {0} can't be decoded: {1}", path, stbi_failure_reason());
+            return false;
+        }
+
+        TextureHeader header;
+        header.width = static_cast<uint32_t>(width);
+        header.height = static_cast<uint32_t>(height);
+        header.mip_levels = 1;
+        while ((std::max(header.width, header.height) >> header.mip_levels) > 0)
+        {
+            ++header.mip_levels;
+        }
+        header.format = ETextureFormat::RGBA8;
+
+        output.clear();
+        append(output, header);
+        size_t level_offset = output.size();
+        output.insert(output.end(), pixels, pixels + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+
+        // each level is the 2x2 average of the previous one, the last texel row or column repeats on odd sizes
+        uint32_t level_width = header.width;
+        uint32_t level_height = header.height;
+        for (uint32_t level = 1; level < header.mip_levels; ++level)
+        {
+            const uint32_t next_width = std::max(level_width / 2, 1u);
+            const uint32_t next_height = std::max(level_height / 2, 1u);
+            const size_t next_offset = output.size();
+            output.resize(next_offset + static_cast<size_t>(next_width) * next_height * 4);
+            const uint8_t* pSource = output.data() + level_offset;
+            uint8_t* pDestination = output.data() + next_offset;
+            for (uint32_t y = 0; y < next_height; ++y)
+            {
+                const uint32_t y0 = std::min(y * 2, level_height - 1);
+                const uint32_t y1 = std::min(y * 2 + 1, level_height - 1);
+                for (uint32_t x = 0; x < next_width; ++x)
+                {
+                    const uint32_t x0 = std::min(x * 2, level_width - 1);
+                    const uint32_t x1 = std::min(x * 2 + 1, level_width - 1);
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        const uint32_t sum = pSource[(static_cast<size_t>(y0) * level_width + x0) * 4 + c] + pSource[(static_cast<size_t>(y0) * level_width + x1) * 4 + c]
+                                           + pSource[(static_cast<size_t>(y1) * level_width + x0) * 4 + c] + pSource[(static_cast<size_t>(y1) * level_width + x1) * 4 + c];
+                        pDestination[(static_cast<size_t>(y) * next_width + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+                    }
+                }
+            }
+            level_offset = next_offset;
+            level_width = next_width;
+            level_height = next_height;
+        }
+        return true;
+    }
+
+    struct ObjVertex
+    {
+        int position;
+        int uv;
+        int normal;
+
+        bool operator==(const ObjVertex& other) const { return position == other.position && uv == other.uv && normal == other.normal; }
+    };
+
+    struct ObjVertexHash
+    {
+        size_t operator()(const ObjVertex& vertex) const
+        {
+            return (static_cast<size_t>(vertex.position) * 73856093u) ^ (static_cast<size_t>(vertex.uv) * 19349663u) ^ (static_cast<size_t>(vertex.normal) * 83492791u);
+        }
+    };
+
+    // 1-based, negative counts back from the last element so far, 0 is absent
+    static bool resolve_obj_index(const long index, const size_t count, int& resolved)
+    {
+        const long absolute = index < 0 ? static_cast<long>(count) + index + 1 : index;
+        if (absolute <= 0 || absolute > static_cast<long>(count))
+        {
+            return false;
+        }
+        resolved = static_cast<int>(absolute);
+        return true;
+    }
+
+    bool cook_mesh(const std::string& path, const std::vector<uint8_t>& source, std::vector<uint8_t>& output)
+    {
+        std::vector<float> positions;
+        std::vector<float> uvs;
+        std::vector<float> normals;
+        std::vector<ObjVertex> face;
+        std::vector<ObjVertex> corners;
+
+        // strtof and strtol stop at the end of the line, the null terminated copy keeps them inside the buffer
+        const std::string text(reinterpret_cast<const char*>(source.data()), source.size());
+        size_t line_start = 0;
+        size_t line_index = 0;
+        while (line_start < text.size())
+        {
+            size_t line_end = text.find('\n', line_start);
+            line_end = line_end == std::string::npos ? text.size() : line_end;
+            ++line_index;
+            const char* pLine = text.c_str() + line_start;
+            line_start = line_end + 1;
+
+            char* pEnd = nullptr;
+            if (pLine[0] == 'v' && (pLine[1] == ' ' || pLine[1] == '\t'))
+            {
+                pLine += 1;
+                for (int i = 0; i < 3; ++i)
+                {
+                    positions.push_back(std::strtof(pLine, &pEnd));
+                    pLine = pEnd;
+                }
+            }
+            else if (pLine[0] == 'v' && pLine[1] == 't')
+            {
+                pLine += 2;
+                for (int i = 0; i < 2; ++i)
+                {
+                    uvs.push_back(std::strtof(pLine, &pEnd));
+                    pLine = pEnd;
+                }
+            }
+            else if (pLine[0] == 'v' && pLine[1] == 'n')
+            {
+                pLine += 2;
+                for (int i = 0; i < 3; ++i)
+                {
+                    normals.push_back(std::strtof(pLine, &pEnd));
+                    pLine = pEnd;
+                }
+            }
+            else if (pLine[0] == 'f' && (pLine[1] == ' ' || pLine[1] == '\t'))
+            {
+                // v, v/vt, v//vn or v/vt/vn per corner
+                face.clear();
+                const char* pCorner = pLine + 1;
+                const char* pLineEnd = text.c_str() + line_end;
+                while (true)
+                {
+                    while (pCorner < pLineEnd && (*pCorner == ' ' || *pCorner == '\t' || *pCorner == '\r'))
+                    {
+                        ++pCorner;
+                    }
+                    if (pCorner >= pLineEnd)
+                    {
+                        break;
+                    }
+                    ObjVertex vertex{ 0, 0, 0 };
+                    bool valid = resolve_obj_index(std::strtol(pCorner, &pEnd, 10), positions.size() / 3, vertex.position);
+                    pCorner = pEnd;
+                    if (*pCorner == '/')
+                    {
+                        ++pCorner;
+                        if (*pCorner != '/')
+                        {
+                            valid = valid && resolve_obj_index(std::strtol(pCorner, &pEnd, 10), uvs.size() / 2, vertex.uv);
+                            pCorner = pEnd;
+                        }
+                        if (*pCorner == '/')
+                        {
+                            valid = valid && resolve_obj_index(std::strtol(pCorner + 1, &pEnd, 10), normals.size() / 3, vertex.normal);
+                            pCorner = pEnd;
+                        }
+                    }
+                    if (!valid)
+                    {
+                        LOG_ERROR("Cooker: {0}:{1} has an invalid face", path, line_index);
+                        return false;
+                    }
+                    face.push_back(vertex);
+                }
+                for (size_t i = 2; i < face.size(); ++i)
+                {
+                    corners.push_back(face[0]);
+                    corners.push_back(face[i - 1]);
+                    corners.push_back(face[i]);
+                }
+            }
+        }
+        if (corners.empty())
+        {
+            LOG_ERROR("Cooker: {0} has no faces", path);
+            return false;
+        }
+
+        MeshHeader header{};
+        header.attributes = MeshPosition;
+        header.vertex_stride = 3 * sizeof(float);
+        const bool has_uvs = std::any_of(corners.begin(), corners.end(), [](const ObjVertex& vertex) { return vertex.uv != 0; });
+        const bool has_normals = std::any_of(corners.begin(), corners.end(), [](const ObjVertex& vertex) { return vertex.normal != 0; });
+        if (has_normals)
+        {
+            header.attributes |= MeshNormal;
+            header.vertex_stride += 3 * sizeof(float);
+        }
+        if (has_uvs)
+        {
+            header.attributes |= MeshUV;
+            header.vertex_stride += 2 * sizeof(float);
+        }
+
+        std::unordered_map<ObjVertex, uint32_t, ObjVertexHash> vertex_indices;
+        std::vector<float> vertices;
+        std::vector<uint32_t> indices;
+        indices.reserve(corners.size());
+        for (const ObjVertex& corner : corners)
+        {
+            const auto [it, inserted] = vertex_indices.emplace(corner, static_cast<uint32_t>(vertex_indices.size()));
+            indices.push_back(it->second);
+            if (!inserted)
+            {
+                continue;
+            }
+            const float* pPosition = &positions[(corner.position - 1) * 3];
+            vertices.insert(vertices.end(), pPosition, pPosition + 3);
+            if (has_normals)
+            {
+                const float zero[3] = {};
+                const float* pNormal = corner.normal ? &normals[(corner.normal - 1) * 3] : zero;
+                vertices.insert(vertices.end(), pNormal, pNormal + 3);
+            }
+            if (has_uvs)
+            {
+                const float zero[2] = {};
+                const float* pUV = corner.uv ? &uvs[(corner.uv - 1) * 2] : zero;
+                vertices.insert(vertices.end(), pUV, pUV + 2);
+            }
+            for (int i = 0; i < 3; ++i)
+            {
+                header.bounds_min[i] = vertex_indices.size() == 1 ? pPosition[i] : std::min(header.bounds_min[i], pPosition[i]);
+                header.bounds_max[i] = vertex_indices.size() == 1 ? pPosition[i] : std::max(header.bounds_max[i], pPosition[i]);
+            }
+        }
+        header.vertices_count = static_cast<uint32_t>(vertex_indices.size());
+        header.indices_count = static_cast<uint32_t>(indices.size());
+
+        output.clear();
+        append(output, header);
+        output.insert(output.end(), reinterpret_cast<const uint8_t*>(vertices.data()), reinterpret_cast<const uint8_t*>(vertices.data() + vertices.size()));
+        output.resize(get_mesh_indices_offset(header));
+        output.insert(output.end(), reinterpret_cast<const uint8_t*>(indices.data()), reinterpret_cast<const uint8_t*>(indices.data() + indices.size()));
+        return true;
+    }
+
+    static bool parse_include(std::string_view line, std::string_view& include)
+    {
+        size_t i = line.find_first_not_of(" \t");
+        if (i == std::string_view::npos || line.compare(i, 8, "#include") != 0)
+        {
+            return false;
+        }
+        const size_t open = line.find('"', i + 8);
+        const size_t close = open == std::string_view::npos ? open : line.find('"', open + 1);
+        if (close == std::string_view::npos)
+        {
+            return false;
+        }
+        include = line.substr(open + 1, close - open - 1);
+        return true;
+    }
+
+    static bool expand_includes(const std::string& source_directory, const std::string& path, std::string_view source,
+                                std::string& output, std::vector<std::string>& dependencies, std::vector<std::string>& include_stack)
+    {
+        constexpr size_t max_include_depth = 32;
+        include_stack.push_back(path);
+        size_t line_start = 0;
+        while (line_start < source.size())
+        {
+            size_t line_end = source.find('\n', line_start);
+            line_end = line_end == std::string_view::npos ? source.size() : line_end + 1;
+            const std::string_view line = source.substr(line_start, line_end - line_start);
+            line_start = line_end;
+
+            std::string_view include;
+            if (!parse_include(line, include))
+            {
+                output.append(line.data(), line.size());
+                continue;
+            }
+
+            // next to the including file first, then from the source directory
+            const size_t slash = path.rfind('/');
+            std::string include_path = slash == std::string::npos ? std::string(include) : path.substr(0, slash + 1) + std::string(include);
+            if (!std::filesystem::is_regular_file(source_directory + "/" + include_path))
+            {
+                include_path = std::string(include);
+            }
+            include_path = std::filesystem::path(include_path).lexically_normal().generic_string();
+            if (include_stack.size() >= max_include_depth || std::find(include_stack.begin(), include_stack.end(), include_path) != include_stack.end())
+            {
+                LOG_ERROR("Cooker: {0} includes {1} recursively", include_stack.front(), include_path);
+                return false;
+            }
+            std::vector<uint8_t> include_source;
+            if (!read_file(source_directory + "/" + include_path, include_source))
+            {
+                LOG_ERROR("Cooker: {0} includes {1}, which can't be read", path, include_path);
+                return false;
+            }
+            if (std::find(dependencies.begin(), dependencies.end(), include_path) == dependencies.end())
+            {
+                dependencies.push_back(include_path);
+            }
+            if (!expand_includes(source_directory, include_path, std::string_view(reinterpret_cast<const char*>(include_source.data()), include_source.size()),
+                                 output, dependencies, include_stack))
+            {
+                return false;
+            }
+            if (!output.empty() && output.back() != '\n')
+            {
+                output.push_back('\n');
+            }
+        }
+        include_stack.pop_back();
+        return true;
+    }
+
+    bool cook_shader(const std::string& source_directory, const std::string& path, const std::vector<uint8_t>& source,
+                     std::vector<uint8_t>& output, std::vector<std::string>& dependencies)
+    {
+        std::string text;
+        std::vector<std::string> include_stack;
+        if (!expand_includes(source_directory, path, std::string_view(reinterpret_cast<const char*>(source.data()), source.size()), text, dependencies, include_stack))
+        {
+            return false;
+        }
+        output.assign(text.begin(), text.end());
+        return true;
+    }
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "SimpleEngineCore/Assets/AssetArchiveFormat.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // Source file to runtime format conversions. Paths are relative to the source directory and use '/'.
+    // Every converter is a pure function of its inputs, safe to run on any thread.
+
+    // the asset type a source file cooks into, false for files that are not assets (shader includes among them)
+    bool get_cooked_type(const std::string& path, AssetArchiveFormat::EAssetType& type);
+
+    // PNG, JPEG, TGA or BMP into RGBA8 with a full box filtered mip chain, bottom row first as GL wants it
+    bool cook_texture(const std::string& path, const std::vector<uint8_t>& source, std::vector<uint8_t>& output);
+
+    // Wavefront OBJ: positions, normals and UVs when present, polygons fanned into triangles, duplicate vertices merged
+    bool cook_mesh(const std::string& path, const std::vector<uint8_t>& source, std::vector<uint8_t>& output);
+
+    // GLSL with #include "file" lines replaced by the file, looked up next to the including file then in the source directory.
+    // The included files are appended to dependencies.
+    bool cook_shader(const std::string& source_directory, const std::string& path, const std::vector<uint8_t>& source,
+                     std::vector<uint8_t>& output, std::vector<std::string>& dependencies);
+
+    bool read_file(const std::string& path, std::vector<uint8_t>& data);
+
+}
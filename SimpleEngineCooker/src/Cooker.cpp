@@ -0,0 +1,558 @@
+#include "Cooker.hpp"
+#include "Converters.hpp"
+
+#include "SimpleEngineCore/Assets/AssetArchive.hpp"
+#include "SimpleEngineCore/Assets/AssetManifest.hpp"
+#include "SimpleEngineCore/JobSystem.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace SimpleEngine {
+
+    using namespace AssetArchiveFormat;
+
+    constexpr char cache_magic[8] = { 'S', 'E', 'C', 'O', 'O', 'K', 'E', 'R' };
+    constexpr uint32_t cache_version = 1;
+    // bump when a converter's output changes, every asset is cooked again
+    constexpr uint64_t converters_version = 1;
+    // assets converted together before their results are written, bounds the cooked data held in memory
+    constexpr size_t batch_size = 256;
+
+    constexpr const char* archive_name = "assets.archive";
+    constexpr const char* manifest_name = "assets.manifest";
+    constexpr const char* cache_name = "cooker.cache";
+
+    // XXH64: fast enough that hashing stays well below reading the files
+    static uint64_t hash_bytes(const uint8_t* data, const size_t size, const uint64_t seed = 0)
+    {
+        constexpr uint64_t prime1 = 11400714785074694791ull;
+        constexpr uint64_t prime2 = 14029467366897019727ull;
+        constexpr uint64_t prime3 = 1609587929392839161ull;
+        constexpr uint64_t prime4 = 9650029242287828579ull;
+        constexpr uint64_t prime5 = 2870177450012600261ull;
+        const auto rotl = [](const uint64_t x, const int r) { return (x << r) | (x >> (64 - r)); };
+        const auto read64 = [](const uint8_t* p) { uint64_t value; std::memcpy(&value, p, sizeof(value)); return value; };
+        const auto read32 = [](const uint8_t* p) { uint32_t value; std::memcpy(&value, p, sizeof(value)); return static_cast<uint64_t>(value); };
+        const auto round = [&](uint64_t accumulator, const uint64_t input) { return rotl(accumulator + input * prime2, 31) * prime1; };
+        const auto merge = [&](const uint64_t accumulator, const uint64_t value) { return (accumulator ^ round(0, value)) * prime1 + prime4; };
+
+        const uint8_t* p = data;
+        const uint8_t* const end = data + size;
+        uint64_t hash = 0;
+        if (size >= 32)
+        {
+            uint64_t v1 = seed + prime1 + prime2;
+            uint64_t v2 = seed + prime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - prime1;
+            for (; p + 32 <= end; p += 32)
+            {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+            }
+            hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            hash = merge(hash, v1);
+            hash = merge(hash, v2);
+            hash = merge(hash, v3);
+            hash = merge(hash, v4);
+        }
+        else
+        {
+            hash = seed + prime5;
+        }
+        hash += static_cast<uint64_t>(size);
+        for (; p + 8 <= end; p += 8)
+        {
+            hash = rotl(hash ^ round(0, read64(p)), 27) * prime1 + prime4;
+        }
+        if (p + 4 <= end)
+        {
+            hash = rotl(hash ^ (read32(p) * prime1), 23) * prime2 + prime3;
+            p += 4;
+        }
+        for (; p < end; ++p)
+        {
+            hash = rotl(hash ^ (*p * prime5), 11) * prime1;
+        }
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    template<typename T>
+    static void write_value(std::ofstream& file, const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static void write_string(std::ofstream& file, const std::string& value)
+    {
+        write_value(file, static_cast<uint32_t>(value.size()));
+        file.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    template<typename T>
+    static bool read_value(std::ifstream& file, T& value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    static bool read_string(std::ifstream& file, std::string& value)
+    {
+        constexpr uint32_t max_path_size = 4096;
+        uint32_t size = 0;
+        if (!read_value(file, size) || size > max_path_size)
+        {
+            return false;
+        }
+        value.resize(size);
+        return static_cast<bool>(file.read(value.data(), size));
+    }
+
+    static double get_elapsed_ms(const std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    Cooker::Cooker(const Settings& settings)
+        : m_settings(settings)
+    {
+    }
+
+    bool Cooker::scan()
+    {
+        namespace fs = std::filesystem;
+        std::error_code error;
+        const fs::path source_directory = fs::weakly_canonical(m_settings.source_directory, error);
+        const fs::path output_directory = fs::weakly_canonical(m_settings.output_directory, error);
+        if (!fs::is_directory(source_directory, error))
+        {
+            LOG_ERROR("Cooker: {0} isn't a directory", m_settings.source_directory);
+            return false;
+        }
+
+        for (fs::recursive_directory_iterator it(source_directory, error), end; it != end; it.increment(error))
+        {
+            // the output may live inside the sources
+            if (it->is_directory(error) && it->path() == output_directory)
+            {
+                it.disable_recursion_pending();
+                continue;
+            }
+            if (!it->is_regular_file(error))
+            {
+                continue;
+            }
+            const std::string path = it->path().lexically_relative(source_directory).generic_string();
+            FileState& file = m_files[path];
+            file.size = it->file_size(error);
+            file.write_time = static_cast<int64_t>(it->last_write_time(error).time_since_epoch().count());
+
+            EAssetType type;
+            if (get_cooked_type(path, type))
+            {
+                Asset asset;
+                asset.path = path;
+                asset.type = type;
+                m_assets.push_back(std::move(asset));
+            }
+        }
+        if (error)
+        {
+            LOG_ERROR("Cooker: scanning {0} failed: {1}", m_settings.source_directory, error.message());
+            return false;
+        }
+        // the archive comes out the same whatever order the file system lists the files in
+        std::sort(m_assets.begin(), m_assets.end(), [](const Asset& a, const Asset& b) { return a.path < b.path; });
+        return true;
+    }
+
+    void Cooker::load_cache()
+    {
+        std::ifstream file(m_settings.output_directory + "/" + cache_name, std::ios::binary);
+        if (!file)
+        {
+            return;
+        }
+
+        char magic[sizeof(cache_magic)];
+        uint32_t version = 0;
+        uint32_t files_count = 0;
+        bool valid = file.read(magic, sizeof(magic)) && std::memcmp(magic, cache_magic, sizeof(magic)) == 0
+            && read_value(file, version) && version == cache_version && read_value(file, files_count);
+        for (uint32_t i = 0; valid && i < files_count; ++i)
+        {
+            std::string path;
+            FileState state;
+            valid = read_string(file, path) && read_value(file, state.size) && read_value(file, state.write_time) && read_value(file, state.hash);
+            state.hashed = true;
+            m_cached_files[path] = state;
+        }
+        uint32_t assets_count = 0;
+        valid = valid && read_value(file, assets_count);
+        for (uint32_t i = 0; valid && i < assets_count; ++i)
+        {
+            std::string path;
+            CachedAsset asset;
+            uint32_t dependencies_count = 0;
+            valid = read_string(file, path) && read_value(file, asset.key) && read_value(file, dependencies_count);
+            for (uint32_t j = 0; valid && j < dependencies_count; ++j)
+            {
+                valid = read_string(file, asset.dependencies.emplace_back());
+            }
+            m_cached_assets[path] = std::move(asset);
+        }
+        if (!valid)
+        {
+            LOG_WARN("Cooker: {0} is unreadable, cooking everything", cache_name);
+            m_cached_files.clear();
+            m_cached_assets.clear();
+        }
+    }
+
+    bool Cooker::save_cache(const std::vector<Asset>& assets) const
+    {
+        const std::string path = m_settings.output_directory + "/" + cache_name;
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(cache_magic, sizeof(cache_magic));
+        write_value(file, cache_version);
+        const uint32_t files_count = static_cast<uint32_t>(std::count_if(m_files.begin(), m_files.end(), [](const auto& file) { return file.second.hashed; }));
+        write_value(file, files_count);
+        for (const auto& [file_path, state] : m_files)
+        {
+            if (state.hashed)
+            {
+                write_string(file, file_path);
+                write_value(file, state.size);
+                write_value(file, state.write_time);
+                write_value(file, state.hash);
+            }
+        }
+        write_value(file, static_cast<uint32_t>(assets.size()));
+        for (const Asset& asset : assets)
+        {
+            write_string(file, asset.path);
+            write_value(file, asset.key);
+            write_value(file, static_cast<uint32_t>(asset.dependencies.size()));
+            for (const std::string& dependency : asset.dependencies)
+            {
+                write_string(file, dependency);
+            }
+        }
+        file.flush();
+        if (!file)
+        {
+            LOG_ERROR("Cooker: writing {0} failed", path);
+            return false;
+        }
+        return true;
+    }
+
+    void Cooker::hash_files(const std::vector<std::string>& paths, Stats& stats)
+    {
+        std::vector<std::pair<const std::string*, FileState*>> stale_files;
+        for (const std::string& path : paths)
+        {
+            const auto it = m_files.find(path);
+            if (it == m_files.end() || it->second.hashed)
+            {
+                continue;
+            }
+            FileState& file = it->second;
+            const auto cached = m_cached_files.find(path);
+            if (cached != m_cached_files.end() && cached->second.size == file.size && cached->second.write_time == file.write_time)
+            {
+                file.hash = cached->second.hash;
+                file.hashed = true;
+            }
+            else
+            {
+                stale_files.emplace_back(&it->first, &file);
+                // a file listed twice is hashed once
+                file.hashed = true;
+            }
+        }
+
+        JobSystem::parallel_for(stale_files.size(), 1, [&](const size_t begin, const size_t end)
+            {
+                std::vector<uint8_t> data;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    FileState& file = *stale_files[i].second;
+                    if (!read_file(m_settings.source_directory + "/" + *stale_files[i].first, data))
+                    {
+                        // unreadable files hash to 0, whatever depends on them is cooked again and reports the error
+                        file.hash = 0;
+                        file.hashed = false;
+                        continue;
+                    }
+                    file.size = data.size();
+                    file.hash = hash_bytes(data.data(), data.size());
+                }
+            });
+
+        stats.hashed_files_count += stale_files.size();
+        for (const auto& stale_file : stale_files)
+        {
+            stats.hashed_bytes += stale_file.second->size;
+        }
+    }
+
+    uint64_t Cooker::compute_key(const Asset& asset) const
+    {
+        std::vector<uint64_t> values = { converters_version, static_cast<uint64_t>(asset.type) };
+        const auto add_file = [&](const std::string& path)
+            {
+                const auto it = m_files.find(path);
+                values.push_back(hash_bytes(reinterpret_cast<const uint8_t*>(path.data()), path.size()));
+                values.push_back(it != m_files.end() && it->second.hashed ? it->second.hash : 0);
+            };
+        add_file(asset.path);
+        for (const std::string& dependency : asset.dependencies)
+        {
+            add_file(dependency);
+        }
+        return hash_bytes(reinterpret_cast<const uint8_t*>(values.data()), values.size() * sizeof(uint64_t));
+    }
+
+    bool Cooker::write_outputs(Stats& stats)
+    {
+        struct CookResult
+        {
+            std::vector<uint8_t> stored;
+            std::vector<std::string> dependencies;
+            size_t size = 0;
+            ECompression compression = ECompression::None;
+            bool succeeded = false;
+        };
+
+        AssetArchive previous_archive;
+        const std::string archive_path = m_settings.output_directory + "/" + archive_name;
+        if (!m_settings.force && std::filesystem::exists(archive_path) && !previous_archive.open(archive_path))
+        {
+            LOG_WARN("Cooker: the previous archive is unusable, cooking everything");
+        }
+
+        // whatever the cache says, an asset the previous archive lacks is cooked
+        for (Asset& asset : m_assets)
+        {
+            if (asset.reused && (!previous_archive.is_open() || previous_archive.find(asset.path) == AssetArchive::invalid_entry))
+            {
+                asset.reused = false;
+                asset.dependencies.clear();
+            }
+        }
+
+        const std::string temporary_path = archive_path + ".tmp";
+        AssetArchiveWriter writer(m_settings.archive);
+        if (!writer.open(temporary_path))
+        {
+            return false;
+        }
+
+        std::vector<Asset> written_assets;
+        std::vector<CookResult> results(batch_size);
+        std::vector<size_t> cooked_indices;
+        for (size_t batch_begin = 0; batch_begin < m_assets.size(); batch_begin += batch_size)
+        {
+            const size_t batch_end = std::min(batch_begin + batch_size, m_assets.size());
+            cooked_indices.clear();
+            for (size_t i = batch_begin; i < batch_end; ++i)
+            {
+                if (!m_assets[i].reused)
+                {
+                    cooked_indices.push_back(i);
+                }
+            }
+
+            const auto cook_start = std::chrono::steady_clock::now();
+            JobSystem::parallel_for(cooked_indices.size(), 1, [&](const size_t begin, const size_t end)
+                {
+                    std::vector<uint8_t> source;
+                    std::vector<uint8_t> cooked;
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const Asset& asset = m_assets[cooked_indices[i]];
+                        CookResult& result = results[cooked_indices[i] - batch_begin];
+                        result = CookResult();
+                        if (!read_file(m_settings.source_directory + "/" + asset.path, source))
+                        {
+                            LOG_ERROR("Cooker: {0} can't be read", asset.path);
+                            continue;
+                        }
+
+                        ECompression compression = ECompression::Zstd;
+                        bool cooked_successfully = false;
+                        switch (asset.type)
+                        {
+                            case EAssetType::Texture:
+                                // streamed at run time, LZ4 decompresses several times faster
+                                compression = ECompression::LZ4;
+                                cooked_successfully = cook_texture(asset.path, source, cooked);
+                                break;
+                            case EAssetType::Mesh:
+                                cooked_successfully = cook_mesh(asset.path, source, cooked);
+                                break;
+                            case EAssetType::Shader:
+                                cooked_successfully = cook_shader(m_settings.source_directory, asset.path, source, cooked, result.dependencies);
+                                break;
+                            case EAssetType::Raw:
+                                cooked.swap(source);
+                                cooked_successfully = true;
+                                break;
+                        }
+                        if (!cooked_successfully)
+                        {
+                            continue;
+                        }
+
+                        result.size = cooked.size();
+                        if (AssetArchiveWriter::compress(compression, m_settings.archive, cooked.data(), cooked.size(), result.stored))
+                        {
+                            result.compression = compression;
+                        }
+                        else
+                        {
+                            result.stored.swap(cooked);
+                            result.compression = ECompression::None;
+                        }
+                        result.succeeded = true;
+                    }
+                });
+            stats.cook_time_ms += get_elapsed_ms(cook_start);
+
+            // newly found dependencies are hashed here, on one thread, as several assets may share them
+            for (const size_t i : cooked_indices)
+            {
+                hash_files(results[i - batch_begin].dependencies, stats);
+            }
+
+            for (size_t i = batch_begin; i < batch_end; ++i)
+            {
+                Asset& asset = m_assets[i];
+                bool written = false;
+                if (asset.reused)
+                {
+                    const AssetArchive::EntryIndex entry = previous_archive.find(asset.path);
+                    const Entry& previous_entry = previous_archive.get_entry(entry);
+                    const ByteSpan stored = previous_archive.get_stored_data(entry);
+                    written = writer.add_stored(asset.path, stored.data, stored.size, previous_entry.size, previous_entry.type, previous_entry.compression);
+                    ++stats.reused_count;
+                }
+                else
+                {
+                    CookResult& result = results[i - batch_begin];
+                    if (!result.succeeded)
+                    {
+                        ++stats.failed_count;
+                        continue;
+                    }
+                    asset.dependencies = std::move(result.dependencies);
+                    asset.key = compute_key(asset);
+                    written = writer.add_stored(asset.path, result.stored.data(), result.stored.size(), result.size, asset.type, result.compression);
+                    result = CookResult();
+                    ++stats.cooked_count;
+                }
+                if (!written)
+                {
+                    return false;
+                }
+                written_assets.push_back(asset);
+            }
+        }
+
+        if (!writer.finish())
+        {
+            return false;
+        }
+        // the previous archive stays mapped until it has been copied from
+        previous_archive.close();
+        std::error_code error;
+        std::filesystem::rename(temporary_path, archive_path, error);
+        if (error)
+        {
+            LOG_ERROR("Cooker: can't replace {0}: {1}", archive_path, error.message());
+            return false;
+        }
+        stats.archive_bytes = std::filesystem::file_size(archive_path, error);
+
+        std::vector<AssetManifest::Asset> manifest_assets(written_assets.size());
+        for (size_t i = 0; i < written_assets.size(); ++i)
+        {
+            manifest_assets[i].path = written_assets[i].path;
+            manifest_assets[i].type = written_assets[i].type;
+            manifest_assets[i].content_hash = written_assets[i].key;
+        }
+        return AssetManifest::save(m_settings.output_directory + "/" + manifest_name, archive_name, manifest_assets)
+            && save_cache(written_assets);
+    }
+
+    bool Cooker::run(Stats& stats)
+    {
+        stats = Stats();
+        const auto start = std::chrono::steady_clock::now();
+        m_assets.clear();
+        m_files.clear();
+        m_cached_files.clear();
+        m_cached_assets.clear();
+
+        std::error_code error;
+        std::filesystem::create_directories(m_settings.output_directory, error);
+        if (!scan())
+        {
+            return false;
+        }
+        if (!m_settings.force)
+        {
+            load_cache();
+        }
+        stats.assets_count = m_assets.size();
+        stats.scan_time_ms = get_elapsed_ms(start);
+
+        // the sources and what they included last time, the only files a change can come from
+        const auto hash_start = std::chrono::steady_clock::now();
+        std::vector<std::string> paths;
+        for (const Asset& asset : m_assets)
+        {
+            paths.push_back(asset.path);
+            const auto cached = m_cached_assets.find(asset.path);
+            if (cached != m_cached_assets.end())
+            {
+                paths.insert(paths.end(), cached->second.dependencies.begin(), cached->second.dependencies.end());
+            }
+        }
+        hash_files(paths, stats);
+        for (Asset& asset : m_assets)
+        {
+            const auto cached = m_cached_assets.find(asset.path);
+            if (cached == m_cached_assets.end())
+            {
+                continue;
+            }
+            asset.dependencies = cached->second.dependencies;
+            asset.key = compute_key(asset);
+            asset.reused = asset.key == cached->second.key;
+            if (!asset.reused)
+            {
+                asset.dependencies.clear();
+            }
+        }
+        stats.hash_time_ms = get_elapsed_ms(hash_start);
+
+        const bool written = write_outputs(stats);
+        stats.total_time_ms = get_elapsed_ms(start);
+        return written && stats.failed_count == 0;
+    }
+
+}
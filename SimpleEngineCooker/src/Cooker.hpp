@@ -0,0 +1,90 @@
+#pragma once
+
+#include "SimpleEngineCore/Assets/AssetArchiveFormat.hpp"
+#include "SimpleEngineCore/Assets/AssetArchiveWriter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // Cooks a source directory into output_directory/assets.archive and the assets.manifest the engine loads.
+    // An asset is cooked again only when the content hash of its source or of a file it includes changed,
+    // or when the converters did; the rest is copied over from the previous archive still compressed.
+    // The hashes are kept in output_directory/cooker.cache, files whose size and write time didn't change aren't read.
+    class Cooker
+    {
+    public:
+        struct Settings
+        {
+            std::string source_directory;
+            std::string output_directory;
+            // ignores the cache and the previous archive
+            bool force = false;
+            AssetArchiveWriter::Settings archive;
+        };
+
+        struct Stats
+        {
+            size_t assets_count = 0;
+            size_t cooked_count = 0;
+            size_t reused_count = 0;
+            size_t failed_count = 0;
+            size_t hashed_files_count = 0;
+            uint64_t hashed_bytes = 0;
+            uint64_t archive_bytes = 0;
+            double scan_time_ms = 0.0;
+            double hash_time_ms = 0.0;
+            double cook_time_ms = 0.0;
+            double total_time_ms = 0.0;
+        };
+
+        explicit Cooker(const Settings& settings);
+
+        // converts on the JobSystem workers, false when an asset failed or the outputs can't be written
+        bool run(Stats& stats);
+
+    private:
+        struct FileState
+        {
+            uint64_t size = 0;
+            int64_t write_time = 0;
+            uint64_t hash = 0;
+            bool hashed = false;
+        };
+
+        struct CachedAsset
+        {
+            uint64_t key = 0;
+            std::vector<std::string> dependencies;
+        };
+
+        struct Asset
+        {
+            std::string path;
+            AssetArchiveFormat::EAssetType type = AssetArchiveFormat::EAssetType::Raw;
+            // hash of the converters' version, the source and the dependencies
+            uint64_t key = 0;
+            std::vector<std::string> dependencies;
+            bool reused = false;
+        };
+
+        bool scan();
+        void load_cache();
+        bool save_cache(const std::vector<Asset>& assets) const;
+        // hashes the files whose size or write time changed since the cache was written
+        void hash_files(const std::vector<std::string>& paths, Stats& stats);
+        uint64_t compute_key(const Asset& asset) const;
+        bool write_outputs(Stats& stats);
+
+        Settings m_settings;
+        std::vector<Asset> m_assets;
+        std::unordered_map<std::string, FileState> m_files;
+        std::unordered_map<std::string, FileState> m_cached_files;
+        std::unordered_map<std::string, CachedAsset> m_cached_assets;
+    };
+
+}
@@ -0,0 +1,56 @@
+#include "Cooker.hpp"
+
+#include "SimpleEngineCore/JobSystem.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <cstdio>
+#include <string>
+
+// SimpleEngineCooker source_directory output_directory [--force] [--jobs=N]
+// Cooks textures (png, jpg, tga, bmp), meshes (obj) and shaders (vert, frag, geom, comp) into an archive and a manifest,
+// only what changed since the last run unless --force is given. --jobs=1 cooks on the calling thread.
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "usage: %s source_directory output_directory [--force] [--jobs=N]\n", argv[0]);
+        return -1;
+    }
+
+    SimpleEngine::Cooker::Settings settings;
+    settings.source_directory = argv[1];
+    settings.output_directory = argv[2];
+    unsigned int jobs_count = 0;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--force")
+        {
+            settings.force = true;
+        }
+        else if (argument.rfind("--jobs=", 0) == 0)
+        {
+            jobs_count = static_cast<unsigned int>(std::stoul(argument.substr(7)));
+        }
+        else
+        {
+            std::fprintf(stderr, "Unknown argument %s\n", argument.c_str());
+            return -1;
+        }
+    }
+
+    if (jobs_count != 1)
+    {
+        SimpleEngine::JobSystem::init(jobs_count > 1 ? jobs_count - 1 : 0);
+    }
+    SimpleEngine::Cooker::Stats stats;
+    const bool succeeded = SimpleEngine::Cooker(settings).run(stats);
+    SimpleEngine::JobSystem::shutdown();
+    SimpleEngine::Log::flush();
+
+    std::printf("%zu assets: %zu cooked, %zu up to date, %zu failed\n", stats.assets_count, stats.cooked_count, stats.reused_count, stats.failed_count);
+    std::printf("hashed   %zu files, %.1f MB\n", stats.hashed_files_count, stats.hashed_bytes / (1024.0 * 1024.0));
+    std::printf("archive  %.1f MB\n", stats.archive_bytes / (1024.0 * 1024.0));
+    std::printf("scan %.1f ms, hash %.1f ms, cook %.1f ms, total %.1f ms\n", stats.scan_time_ms, stats.hash_time_ms, stats.cook_time_ms, stats.total_time_ms);
+    return succeeded ? 0 : -1;
+}
@@ -2,14 +2,40 @@
 
 #include "SimpleEngineCore/Event.hpp"
 #include "SimpleEngineCore/Camera.hpp"
-
+#include "SimpleEngineCore/TransformHierarchy.hpp"
+#include "SimpleEngineCore/LightClusters.hpp"
+#include "SimpleEngineCore/DirectionalLight.hpp"
+#include "SimpleEngineCore/SpotLight.hpp"
+#include "SimpleEngineCore/ShadowMaps.hpp"
+#include "SimpleEngineCore/LightmapBaker.hpp"
+#include "SimpleEngineCore/IrradianceProbes.hpp"
+#include "SimpleEngineCore/FrameTimeHarness.hpp"
+#include "SimpleEngineCore/Input.hpp"
+#include "SimpleEngineCore/WorldPartition.hpp"
+
+#include <chrono>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace SimpleEngine {
 
     class Application
     {
     public:
+        enum class ERenderPath
+        {
+            Forward,
+            Deferred
+        };
+
+        enum class EWindowMode
+        {
+            Windowed,
+            // offscreen rendering without an OS window, e.g. for perf runs on CI machines
+            Headless
+        };
+
         Application();
         virtual ~Application();
 
@@ -18,7 +44,7 @@ namespace SimpleEngine {
         Application& operator=(const Application&) = delete;
         Application& operator=(Application&&) = delete;
 
-        virtual int start(unsigned int window_width, unsigned int window_height, const char* title);
+        virtual int start(unsigned int window_width, unsigned int window_height, const char* title, const EWindowMode window_mode = EWindowMode::Windowed);
         void close();
 
         virtual void on_update() {}
@@ -30,9 +56,87 @@ namespace SimpleEngine {
                                            const double y_pos,
                                            const bool pressed) {}
 
+        // as of the current frame's input snapshot
         glm::vec2 get_current_cursor_position() const;
+        // window input is posted here and delivered at the start of each frame
+        EventBus& get_event_bus() { return m_event_bus; }
+
+        // fills the scene with a floor of cubes and lights_count animated point lights
+        void load_lights_benchmark_scene(const size_t lights_count);
+        // a square floor of static cubes, point lights above it and procedural textures spread over the cubes,
+        // generated from fixed seeds so the same arguments always give the same scene
+        void load_stress_scene(const size_t cubes_count, const size_t lights_count, const size_t textures_count);
+        // streams the cells of settings.directory around the camera, their cubes join the ones already in the scene.
+        // Replaces the world loaded before, nothing is read before start() has mounted the file system
+        void load_world(const WorldPartition::Settings& settings);
+        void unload_world();
+        // a square of cells_per_side cells around the origin, each a floor of cubes at heights from a fixed seed
+        static bool save_stress_world(const WorldPartition::Settings& settings, const int cells_per_side, const size_t cubes_per_side);
+
+        enum class ESceneFormat
+        {
+            // the fields' arrays as they are in memory, loading is one copy per field
+            Binary,
+            // a line per object, for diffing
+            Text
+        };
+
+        // removes the cubes and the lights, the streamed world included, and resets the lighting parameters
+        void new_scene();
+        // replaces the scene with the cubes, lights and lighting parameters of path, written in either format.
+        // The scene is kept when the file can't be read
+        bool load_scene(const std::string& path);
+        // snapshots the scene on the calling thread and writes it on a background thread
+        void save_scene(const std::string& path, const ESceneFormat format = ESceneFormat::Binary);
+        bool is_saving_scene() const;
+
+        // loads the stress scene and draws it headless along the camera path, then saves the report.
+        // Returns 0 when nothing regressed against the baseline, 1 on a regression, negative when the run failed.
+        int run_frame_time_harness(const FrameTimeHarness::Settings& settings);
+        // the last run, empty before the first one
+        const FrameTimeHarness::Report& get_frame_time_report() const { return m_frame_time_report; }
+        // records every GL call of the next frames_count frames into path, for SimpleEngineReplay.
+        // False while a capture is running or when the engine is built without SIMPLE_ENGINE_GL_CAPTURE.
+        bool capture_gl_frames(const std::string& path, const uint32_t frames_count);
+        bool is_capturing_gl_frames() const;
+
+        enum class EImageFormat
+        {
+            // uncompressed PNG
+            Png,
+            // headerless RGBA8 rows, top row first
+            Raw
+        };
+
+        // writes the next frames_count frames, UI included, to directory/frame_000000.png (or .rgba).
+        // Frames are read back asynchronously and encoded on a background thread, recording costs the main thread
+        // well under a millisecond per frame; frames are skipped rather than stalling if the disk can't keep up.
+        bool record_frames(const std::string& directory, const uint32_t frames_count, const EImageFormat format = EImageFormat::Png);
+        bool is_recording_frames() const { return m_recorded_frames_left > 0; }
+        // writes the next frame to path as PNG
+        void save_screenshot(const std::string& path);
+        // main thread time spent on readback in the last frame
+        double get_readback_time_ms() const { return m_readback_time_ms; }
+        const LightClusters::Stats& get_light_clusters_stats() const { return m_light_clusters.get_last_build_stats(); }
+
+        // smoothed GPU time of the scene passes, excluding UI
+        double get_render_path_time_ms(const ERenderPath path) const { return m_render_path_times_ms[static_cast<size_t>(path)]; }
+
+        // the directional light and the spot lights share one shadow atlas sized to fit the budget
+        void set_shadow_memory_budget(const size_t bytes) { m_shadow_maps.set_memory_budget(bytes); }
+        size_t get_shadow_memory_budget() const { return m_shadow_maps.get_memory_budget(); }
+        const ShadowMaps::Stats& get_shadow_stats() const { return m_shadow_maps.get_stats(); }
+
+        // bakes indirect light of the static cubes, blocks until the bake is done
+        bool bake_lightmaps(const LightmapBaker::Settings& settings = LightmapBaker::Settings());
+        const LightmapBaker::Stats& get_lightmap_stats() const { return m_lightmap_stats; }
+
+        // ambient light of cubes without a lightmap, re-baked when static geometry or lights change
+        void configure_irradiance_probes(const IrradianceProbes::Settings& settings);
+        const IrradianceProbes::Stats& get_irradiance_probes_stats() const { return m_irradiance_probes.get_stats(); }
 
         Camera camera{glm::vec3(-5.f, 0.f, 0.f)};
+        TransformHierarchy transforms;
 
         float light_source_position[3] = { 0.f, 0.f, 0.f };
         float light_source_color[3] = { 1.f, 1.f, 1.f };
@@ -41,13 +145,98 @@ namespace SimpleEngine {
         float specular_factor = 0.5f;
         float shininess = 32.f;
 
+        std::vector<PointLight> point_lights;
+        bool animate_point_lights = false;
+
+        DirectionalLight directional_light;
+        std::vector<SpotLight> spot_lights;
+        // spins the initial cubes, the only dynamic shadow casters
+        bool animate_dynamic_casters = false;
+
+        bool irradiance_probes_enabled = true;
+        // CPU time per frame spent re-baking stale probes
+        float irradiance_probes_budget_ms = 2.f;
+
+        ERenderPath render_path = ERenderPath::Forward;
+        // alternates the render paths every frame so both timings stay current
+        bool compare_render_paths = false;
+
+        // CPU and GPU timeline of recent frames, empty unless built with SIMPLE_ENGINE_PROFILING
+        bool show_profiler = false;
+        // heap use per subsystem, frame arenas and pools
+        bool show_memory = false;
+        // GPU memory per category against GpuMemory's budget
+        bool show_gpu_memory = false;
+
+        // written by SimpleEngineCooker, loaded by start() when it exists
+        std::string asset_manifest_path = "assets/assets.manifest";
+
     private:
         void draw();
+        void draw_cubes(const class ShaderProgram& shader_program);
+        void set_lighting_uniforms(const class ShaderProgram& shader_program);
+        void animate_benchmark_lights();
+        void update_shadows();
+        size_t draw_shadow_casters(const glm::mat4& light_view_projection, const bool dynamic);
+        uint64_t get_static_geometry_version() const;
+        void remove_cubes(const TransformHierarchy::NodeId* nodes, const size_t count);
+        void update_irradiance_probes();
+        void set_irradiance_probes_uniforms(const class ShaderProgram& shader_program);
+        float get_animation_time() const;
+        void read_back_frame();
+        // what start() set up, on its normal and early exits alike; the JobSystem and VirtualFileSystem threads
+        // must be joined before static destruction
+        void shutdown_systems();
 
         std::unique_ptr<class Window> m_pWindow;
-
-        EventDispatcher m_event_dispatcher;
+        std::unique_ptr<class AssetManifest> m_pAssetManifest;
+        std::unique_ptr<class SceneSaver> m_pSceneSaver;
+
+        std::vector<TransformHierarchy::NodeId> m_cube_nodes;
+        std::vector<uint8_t> m_dynamic_cubes;
+        std::vector<glm::vec4> m_lightmap_scale_offsets;
+        std::vector<glm::mat4> m_model_view_matrices;
+        std::vector<glm::mat4> m_mvp_matrices;
+        LightClusters m_light_clusters;
+        bool m_benchmark_scene_loaded = false;
+        // the transforms update that destroys the last removed static cubes
+        uint64_t m_removed_static_geometry_version = 0;
+        double m_render_path_times_ms[2] = { 0.0, 0.0 };
+
+        ShadowMaps m_shadow_maps;
+        std::vector<uint32_t> m_shadow_resolutions;
+        // world matrices of the casters of one draw_shadow_casters() call, then their light MVPs
+        std::vector<glm::mat4> m_shadow_world_matrices;
+        std::vector<glm::mat4> m_shadow_mvp_matrices;
+        glm::mat4 m_directional_shadow_matrix{ 1.f };
+        glm::vec4 m_directional_shadow_rect{ 0.f };
+        LightmapBaker::Stats m_lightmap_stats;
+
+        IrradianceProbes m_irradiance_probes;
+        bool m_irradiance_probes_scene_set = false;
+        uint64_t m_irradiance_probes_geometry_version = 0;
+        DirectionalLight m_irradiance_probes_directional_light;
+        std::vector<SpotLight> m_irradiance_probes_spot_lights;
+
+        std::unique_ptr<FrameTimeHarness> m_pFrameTimeHarness;
+        // replayed from the first recorded frame of the harness run
+        std::unique_ptr<InputRecording> m_pHarnessInputRecording;
+        FrameTimeHarness::Report m_frame_time_report;
+        size_t m_stress_textures_count = 0;
+
+        EventBus m_event_bus;
         bool m_bCloseWindow = false;
+        std::chrono::steady_clock::time_point m_start_time;
+        uint64_t m_frame_index = 0;
+        // harness frames that allocated and were reported with their tags, the rest are only counted
+        uint32_t m_reported_allocating_frames_count = 0;
+
+        std::string m_recording_directory;
+        EImageFormat m_recording_format = EImageFormat::Png;
+        uint32_t m_recorded_frames_left = 0;
+        uint32_t m_recorded_frames_count = 0;
+        std::string m_screenshot_path;
+        double m_readback_time_ms = 0.0;
     };
 
 }
\ No newline at end of file
@@ -32,6 +32,9 @@ namespace SimpleEngine {
         const float get_far_clip_plane() const { return m_far_clip_plane; }
         const float get_near_clip_plane() const { return m_near_clip_plane; }
         const float get_field_of_view() const { return m_field_of_view; }
+        const float get_viewport_width() const { return m_viewport_width; }
+        const float get_viewport_height() const { return m_viewport_height; }
+        ProjectionMode get_projection_mode() const { return m_projection_mode; }
 
         void move_forward(const float delta);
         void move_right(const float delta);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+
+namespace SimpleEngine {
+
+    struct DirectionalLight
+    {
+        glm::vec3 direction{ -0.3f, -0.2f, -1.f };
+        float intensity = 0.6f;
+        glm::vec3 color{ 1.f, 1.f, 1.f };
+
+        // the shadow covers a fixed box so the cached map survives camera movement
+        bool cast_shadows = true;
+        uint32_t shadow_resolution = 1024;
+        glm::vec3 shadow_center{ 0.f, 0.f, 0.f };
+        float shadow_extent = 50.f;
+    };
+
+}
@@ -4,8 +4,11 @@
 
 #include "Keys.hpp"
 
-#include <functional>
 #include <array>
+#include <cstdint>
+#include <mutex>
+#include <variant>
+#include <vector>
 
 namespace SimpleEngine {
 
@@ -25,44 +28,9 @@ namespace SimpleEngine {
         EventsCount
     };
 
-    struct BaseEvent
-    {
-        virtual ~BaseEvent() = default;
-        virtual EventType get_type() const = 0;
-    };
-
+    // events are plain values: the type is known at compile time, nothing is dispatched through a vtable
 
-    class EventDispatcher
-    {
-    public:
-        template<typename EventType>
-        void add_event_listener(std::function<void(EventType&)> callback)
-        {
-            auto baseCallback = [func = std::move(callback)](BaseEvent& e)
-            {
-                if (e.get_type() == EventType::type)
-                {
-                    func(static_cast<EventType&>(e));
-                }
-            };
-            m_eventCallbacks[static_cast<size_t>(EventType::type)] = std::move(baseCallback);
-        }
-
-        void dispatch(BaseEvent& event)
-        {
-            auto& callback = m_eventCallbacks[static_cast<size_t>(event.get_type())];
-            if (callback)
-            {
-                callback(event);
-            }
-        }
-
-    private:
-        std::array<std::function<void(BaseEvent&)>, static_cast<size_t>(EventType::EventsCount)> m_eventCallbacks;
-    };
-
-
-    struct EventMouseMoved : public BaseEvent
+    struct EventMouseMoved
     {
         EventMouseMoved(const double new_x, const double new_y)
             : x(new_x)
@@ -70,18 +38,13 @@ namespace SimpleEngine {
         {
         }
 
-        virtual EventType get_type() const override
-        {
-            return type;
-        }
-
         double x;
         double y;
 
-        static const EventType type = EventType::MouseMoved;
+        static constexpr EventType type = EventType::MouseMoved;
     };
 
-    struct EventWindowResize : public BaseEvent
+    struct EventWindowResize
     {
         EventWindowResize(const unsigned int new_width, const unsigned int new_height)
             : width(new_width)
@@ -89,28 +52,18 @@ namespace SimpleEngine {
         {
         }
 
-        virtual EventType get_type() const override
-        {
-            return type;
-        }
-
         unsigned int width;
         unsigned int height;
 
-        static const EventType type = EventType::WindowResize;
+        static constexpr EventType type = EventType::WindowResize;
     };
 
-    struct EventWindowClose : public BaseEvent
+    struct EventWindowClose
     {
-        virtual EventType get_type() const override
-        {
-            return type;
-        }
-
-        static const EventType type = EventType::WindowClose;
+        static constexpr EventType type = EventType::WindowClose;
     };
 
-    struct EventKeyPressed : public BaseEvent
+    struct EventKeyPressed
     {
         EventKeyPressed(const KeyCode key_code, const bool repeated)
             : key_code(key_code)
@@ -118,35 +71,25 @@ namespace SimpleEngine {
         {
         }
 
-        virtual EventType get_type() const override
-        {
-            return type;
-        }
-
         KeyCode key_code;
         bool repeated;
 
-        static const EventType type = EventType::KeyPressed;
+        static constexpr EventType type = EventType::KeyPressed;
     };
 
-    struct EventKeyReleased : public BaseEvent
+    struct EventKeyReleased
     {
         EventKeyReleased(const KeyCode key_code)
             : key_code(key_code)
         {
         }
 
-        virtual EventType get_type() const override
-        {
-            return type;
-        }
-
         KeyCode key_code;
 
-        static const EventType type = EventType::KeyReleased;
+        static constexpr EventType type = EventType::KeyReleased;
     };
 
-    struct EventMouseButtonPressed : public BaseEvent
+    struct EventMouseButtonPressed
     {
         EventMouseButtonPressed(const MouseButton mouse_button, const double x_pos, const double y_pos)
             : mouse_button(mouse_button)
@@ -155,19 +98,14 @@ namespace SimpleEngine {
         {
         }
 
-        virtual EventType get_type() const override
-        {
-            return type;
-        }
-
         MouseButton mouse_button;
         double x_pos;
         double y_pos;
 
-        static const EventType type = EventType::MouseButtonPressed;
+        static constexpr EventType type = EventType::MouseButtonPressed;
     };
 
-    struct EventMouseButtonReleased : public BaseEvent
+    struct EventMouseButtonReleased
     {
         EventMouseButtonReleased(const MouseButton mouse_button, const double x_pos, const double y_pos)
             : mouse_button(mouse_button)
@@ -176,15 +114,142 @@ namespace SimpleEngine {
         {
         }
 
-        virtual EventType get_type() const override
-        {
-            return type;
-        }
-
         MouseButton mouse_button;
         double x_pos;
         double y_pos;
 
-        static const EventType type = EventType::MouseButtonReleased;
+        static constexpr EventType type = EventType::MouseButtonReleased;
+    };
+
+
+    // Typed event bus with prioritized subscribers.
+    // Listeners are a function pointer plus a context pointer, kept per event type sorted by priority (highest first),
+    // a listener returning true consumes the event and the lower priority ones don't see it.
+    // post() may be called from any thread, it queues the event into the current frame's buffer, dispatch_queued()
+    // delivers the buffer on the thread calling it (the main thread, once per frame).
+    // Runs of mouse moves and resizes are coalesced while queued: a new one replaces the pending one of the same type
+    // unless a different kind of event was queued in between, so clicks and key presses still see the positions they followed.
+    // Subscribing and unsubscribing is done from the dispatching thread, outside of listeners.
+    class EventBus
+    {
+    public:
+        template<typename TEvent>
+        using Callback = bool(*)(void* pContext, const TEvent& event);
+        using SubscriptionId = uint32_t;
+
+        EventBus()
+        {
+            m_coalesce_indices.fill(s_no_index);
+        }
+
+        EventBus(const EventBus&) = delete;
+        EventBus& operator=(const EventBus&) = delete;
+
+        template<typename TEvent>
+        SubscriptionId subscribe(const Callback<TEvent> callback, void* pContext, const int priority = 0)
+        {
+            return add_listener(TEvent::type, reinterpret_cast<GenericCallback>(callback), pContext, priority);
+        }
+
+        // bus.subscribe<&Class::on_event>(pObject), with bool Class::on_event(const EventX&)
+        template<auto Method, typename T>
+        SubscriptionId subscribe(T* pObject, const int priority = 0)
+        {
+            using TEvent = typename MethodTraits<decltype(Method)>::Event;
+            const Callback<TEvent> callback = [](void* pContext, const TEvent& event)
+            {
+                return (static_cast<T*>(pContext)->*Method)(event);
+            };
+            return subscribe<TEvent>(callback, pObject, priority);
+        }
+
+        void unsubscribe(const SubscriptionId id);
+
+        // delivers immediately on the calling thread, true if a listener consumed the event
+        template<typename TEvent>
+        bool dispatch(const TEvent& event) const
+        {
+            const std::vector<Listener>& listeners = m_listeners[static_cast<size_t>(TEvent::type)];
+            for (const Listener& listener : listeners)
+            {
+                if (reinterpret_cast<Callback<TEvent>>(listener.callback)(listener.pContext, event))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template<typename TEvent>
+        void post(const TEvent& event)
+        {
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            size_t& coalesce_index = m_coalesce_indices[static_cast<size_t>(TEvent::type)];
+            if constexpr (is_coalesced(TEvent::type))
+            {
+                if (coalesce_index != s_no_index)
+                {
+                    m_queue[coalesce_index] = event;
+                    ++m_coalesced_count;
+                    return;
+                }
+                // the pending events of the other types are no longer the last of the queue
+                m_coalesce_indices.fill(s_no_index);
+                coalesce_index = m_queue.size();
+            }
+            else
+            {
+                m_coalesce_indices.fill(s_no_index);
+            }
+            m_queue.emplace_back(event);
+        }
+
+        // events posted by the listeners go to the next call
+        void dispatch_queued();
+
+        // events merged into a pending one since the bus was created
+        uint64_t get_coalesced_count() const;
+
+    private:
+        using GenericCallback = void(*)();
+        using QueuedEvent = std::variant<EventWindowResize, EventWindowClose, EventKeyPressed, EventKeyReleased,
+                                         EventMouseButtonPressed, EventMouseButtonReleased, EventMouseMoved>;
+
+        struct Listener
+        {
+            GenericCallback callback;
+            void* pContext;
+            int priority;
+            SubscriptionId id;
+        };
+
+        template<typename TMethod>
+        struct MethodTraits;
+
+        template<typename T, typename TEvent>
+        struct MethodTraits<bool (T::*)(const TEvent&)>
+        {
+            using Event = TEvent;
+        };
+
+        static constexpr bool is_coalesced(const EventType type)
+        {
+            return type == EventType::MouseMoved || type == EventType::WindowResize;
+        }
+
+        SubscriptionId add_listener(const EventType type, const GenericCallback callback, void* pContext, const int priority);
+
+        static constexpr size_t s_no_index = static_cast<size_t>(-1);
+
+        std::array<std::vector<Listener>, static_cast<size_t>(EventType::EventsCount)> m_listeners;
+        SubscriptionId m_next_subscription_id = 1;
+
+        mutable std::mutex m_queue_mutex;
+        std::vector<QueuedEvent> m_queue;
+        // swapped with m_queue on dispatch, both keep their capacity so a steady frame doesn't allocate
+        std::vector<QueuedEvent> m_dispatched_queue;
+        // position in m_queue of the pending event each coalesced type merges into
+        std::array<size_t, static_cast<size_t>(EventType::EventsCount)> m_coalesce_indices;
+        uint64_t m_coalesced_count = 0;
     };
-}
\ No newline at end of file
+}
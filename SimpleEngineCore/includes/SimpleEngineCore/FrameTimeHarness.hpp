@@ -0,0 +1,100 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // Frame time regression run: a generated stress scene is drawn headless along a scripted camera path
+    // for a fixed number of frames. Animations advance by frame index, never by wall clock, so two runs
+    // of the same build draw exactly the same frames. CPU and GPU frame time percentiles and hitch counts
+    // are saved as JSON and checked against a baseline saved by an earlier run.
+    class FrameTimeHarness
+    {
+    public:
+        struct CameraKeyframe
+        {
+            glm::vec3 position{ 0.f };
+            // degrees: roll, pitch, yaw, like Camera
+            glm::vec3 rotation{ 0.f };
+        };
+
+        struct Settings
+        {
+            size_t cubes_count = 2048;
+            size_t lights_count = 1024;
+            size_t textures_count = 16;
+            unsigned int width = 1280;
+            unsigned int height = 720;
+            // drawn before recording: probe bakes, shadow caches and driver warm-up happen here
+            uint32_t warmup_frames = 60;
+            uint32_t frames_count = 600;
+            // visited at a constant rate over frames_count frames, an orbit around the scene if empty
+            std::vector<CameraKeyframe> camera_path;
+            // Input::StartRecording file replayed from the first recorded frame, the camera then starts where
+            // the path starts and moves with the replayed input
+            std::string input_recording_path;
+            // frames slower than hitch_factor times the median are hitches
+            double hitch_factor = 2.0;
+            std::string output_path = "frame_times.json";
+            // no comparison when empty
+            std::string baseline_path;
+            // allowed relative growth of the p50/p95/p99 frame times over the baseline
+            double regression_threshold = 0.1;
+            // hitches on top of baseline * (1 + regression_threshold) before the run fails
+            size_t allowed_extra_hitches = 2;
+            // fails the run when a recorded frame allocates from the heap, needs SIMPLE_ENGINE_MEMORY_TRACKING
+            bool assert_no_heap_allocations = false;
+        };
+
+        struct Distribution
+        {
+            double p50_ms = 0.0;
+            double p95_ms = 0.0;
+            double p99_ms = 0.0;
+            double max_ms = 0.0;
+            double mean_ms = 0.0;
+            size_t hitches_count = 0;
+        };
+
+        struct Report
+        {
+            size_t frames_count = 0;
+            Distribution cpu;
+            Distribution gpu;
+            size_t frames_with_heap_allocations_count = 0;
+            uint64_t max_heap_allocations_per_frame = 0;
+        };
+
+        explicit FrameTimeHarness(Settings settings);
+
+        const Settings& get_settings() const { return m_settings; }
+
+        // camera for a recorded frame, warm-up frames use frame 0
+        CameraKeyframe get_camera(const uint32_t frame) const;
+
+        void record_frame(const double cpu_time_ms, const double gpu_time_ms, const uint64_t heap_allocations_count);
+        size_t get_recorded_frames_count() const { return m_cpu_times_ms.size(); }
+        bool is_finished() const { return m_cpu_times_ms.size() >= m_settings.frames_count; }
+
+        Report make_report() const;
+        bool save_report(const Report& report, const std::string& path) const;
+        // reads a file written by save_report
+        static bool load_report(const std::string& path, Report& report);
+        // names of the metrics that regressed, empty when the run passes
+        static std::vector<std::string> compare(const Report& report, const Report& baseline, const double threshold, const size_t allowed_extra_hitches);
+
+        static Distribution make_distribution(std::vector<double> times_ms, const double hitch_factor);
+
+    private:
+        Settings m_settings;
+        std::vector<double> m_cpu_times_ms;
+        std::vector<double> m_gpu_times_ms;
+        std::vector<uint64_t> m_heap_allocations_counts;
+    };
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+    enum class EGpuMemoryCategory : uint8_t
+    {
+        VertexBuffers,
+        IndexBuffers,
+        StorageBuffers,
+        Textures,
+        RenderTargets,
+        ShadowMaps,
+        Readback,
+
+        Count
+    };
+
+    const char* get_gpu_memory_category_name(const EGpuMemoryCategory category);
+
+    // Bookkeeping of the GPU memory the engine allocates: every buffer and texture registers its size
+    // (mip chains included) under a category. Sizes are what the data needs, drivers add alignment and padding.
+    // Over the budget, new_frame() asks streamable resources to give memory back, least recently used first.
+    // Like the GL calls it mirrors, it is only used from the thread owning the GL context.
+    class GpuMemory
+    {
+    public:
+        using ResourceId = uint32_t;
+        static constexpr ResourceId invalid_resource = 0;
+
+        // asked to free at least bytes_over_budget, returns what it freed (through resize or unregister)
+        using EvictCallback = size_t(*)(void* pContext, const size_t bytes_over_budget);
+
+        struct CategoryStats
+        {
+            uint64_t bytes = 0;
+            uint64_t peak_bytes = 0;
+            size_t resources_count = 0;
+        };
+
+        struct Stats
+        {
+            uint64_t total_bytes = 0;
+            uint64_t peak_total_bytes = 0;
+            // 0 when there is no budget
+            uint64_t budget_bytes = 0;
+            uint64_t evicted_bytes = 0;
+            uint64_t evictions_count = 0;
+            CategoryStats categories[static_cast<size_t>(EGpuMemoryCategory::Count)];
+        };
+
+        struct ResourceInfo
+        {
+            const char* name = nullptr;
+            EGpuMemoryCategory category = EGpuMemoryCategory::Textures;
+            uint64_t bytes = 0;
+            uint64_t last_used_frame = 0;
+            bool streamable = false;
+        };
+
+        // what the driver reports, through GL_NVX_gpu_memory_info or GL_ATI_meminfo
+        struct DriverInfo
+        {
+            bool available = false;
+            const char* extension = "";
+            // 0 when the extension doesn't report it
+            uint64_t total_bytes = 0;
+            uint64_t available_bytes = 0;
+            uint64_t evicted_bytes = 0;
+            uint64_t evictions_count = 0;
+        };
+
+        // name is kept by pointer, it has to be a literal
+        static ResourceId register_resource(const EGpuMemoryCategory category, const uint64_t bytes, const char* name);
+        static void resize_resource(const ResourceId id, const uint64_t bytes);
+        static void unregister_resource(const ResourceId id);
+
+        // makes the resource an eviction candidate, nullptr makes it resident again
+        static void set_evict_callback(const ResourceId id, const EvictCallback callback, void* pContext);
+        // marks the resource used this frame, the least recently used streamable resources are evicted first
+        static void touch(const ResourceId id);
+
+        static void set_budget(const uint64_t bytes);
+        static uint64_t get_budget();
+        // once per frame: advances the frame counter and evicts until the total fits the budget
+        static void new_frame();
+
+        static Stats get_stats();
+        static void get_resources(std::vector<ResourceInfo>& resources);
+        // needs the GL context
+        static DriverInfo query_driver_memory();
+
+        // texture storage of a GL sized internal format, every mip level from the base one down
+        static uint64_t get_texture_bytes(const unsigned int internal_format, const unsigned int width, const unsigned int height,
+                                          const unsigned int depth, const unsigned int mip_levels);
+    };
+
+}
@@ -2,20 +2,102 @@
 
 #include "Keys.hpp"
 
+#include <glm/vec2.hpp>
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace SimpleEngine {
 
+    // Input state of one frame, published by Input::NewFrame
+    struct InputSnapshot
+    {
+        static constexpr size_t keys_count = static_cast<size_t>(KeyCode::KEY_LAST) + 1;
+        static constexpr size_t mouse_buttons_count = static_cast<size_t>(MouseButton::MOUSE_BUTTON_LAST) + 1;
+
+        uint64_t frame_index = 0;
+        // seconds, the time given to NewFrame or the recorded one while replaying
+        double time = 0.0;
+
+        std::bitset<keys_count> keys_down;
+        // went down / up since the previous frame, a tap shorter than a frame sets both
+        std::bitset<keys_count> keys_pressed;
+        std::bitset<keys_count> keys_released;
+        // time of the frame each key went down in, valid while it is down
+        double key_press_times[keys_count] = {};
+
+        std::bitset<mouse_buttons_count> mouse_buttons_down;
+        std::bitset<mouse_buttons_count> mouse_buttons_pressed;
+        std::bitset<mouse_buttons_count> mouse_buttons_released;
+        double mouse_button_press_times[mouse_buttons_count] = {};
+
+        glm::vec2 mouse_position{ 0.f };
+        // sum of every cursor move since the previous frame
+        glm::vec2 mouse_delta{ 0.f };
+    };
+
+    // What fed Input, frame by frame, in a compact binary stream replayed through Input::StartReplay.
+    // File: "SEINPUT\0", uint32 version, uint32 frames count, then for each frame a float32 time in seconds since
+    // the recording started, a uint16 events count and the events: a uint8 EInputEvent followed by a uint16 key code,
+    // a uint8 mouse button or two float32 cursor coordinates. Little endian.
+    class InputRecording
+    {
+    public:
+        bool save(const std::string& path) const;
+        bool load(const std::string& path);
+
+        uint32_t get_frames_count() const { return m_frames_count; }
+        size_t get_size() const { return m_stream.size(); }
+
+    private:
+        friend class Input;
+
+        std::vector<uint8_t> m_stream;
+        uint32_t m_frames_count = 0;
+    };
+
+    // Window events feed a pending state, NewFrame() turns it into the snapshot every query of the frame reads.
+    // Snapshots are double buffered: a published one is left untouched until the second NewFrame() after it,
+    // so jobs of a frame can read GetSnapshot() lock-free while the main thread feeds the next one.
     class Input {
     public:
         static bool IsKeyPressed(const KeyCode key_code);
-        static void PressKey(const KeyCode key_code);
-        static void ReleaseKey(const KeyCode key_code);
+        static bool WasKeyPressedThisFrame(const KeyCode key_code);
+        static bool WasKeyReleasedThisFrame(const KeyCode key_code);
+        // seconds since the key went down, 0 when it is up
+        static double GetKeyHeldTime(const KeyCode key_code);
 
         static bool IsMouseButtonPressed(const MouseButton mouse_button);
+        static bool WasMouseButtonPressedThisFrame(const MouseButton mouse_button);
+        static bool WasMouseButtonReleasedThisFrame(const MouseButton mouse_button);
+        static double GetMouseButtonHeldTime(const MouseButton mouse_button);
+
+        static glm::vec2 GetMousePosition();
+        static glm::vec2 GetMouseDelta();
+
+        static const InputSnapshot& GetSnapshot();
+
+        // feeding, from the thread delivering the window events; ignored while replaying
+        static void PressKey(const KeyCode key_code);
+        static void ReleaseKey(const KeyCode key_code);
         static void PressMouseButton(const MouseButton mouse_button);
         static void ReleaseMouseButton(const MouseButton mouse_button);
+        static void MoveMouse(const double x_pos, const double y_pos);
 
-    private:
-        static bool m_keys_pressed[];
-        static bool m_mouse_buttons_pressed[];
-};
-}
\ No newline at end of file
+        // once per frame before anything reads input, publishes what was fed since the last call
+        static void NewFrame(const double time);
+
+        // records from the next NewFrame(), the keys already down and the cursor position are the first frame's events
+        static void StartRecording();
+        static bool IsRecording();
+        static InputRecording StopRecording();
+
+        // the next NewFrame() calls feed the recorded frames in place of the window events, until the recording ends
+        static void StartReplay(InputRecording recording);
+        static bool IsReplaying();
+        static void StopReplay();
+    };
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "SimpleEngineCore/DirectionalLight.hpp"
+#include "SimpleEngineCore/SpotLight.hpp"
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/ext/vector_int3.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace SimpleEngine {
+
+    class BakeScene;
+
+    // Regular grid of L2 spherical harmonics irradiance probes for objects without a lightmap.
+    // Probes are baked on the CPU against static geometry, nearest to the camera first and only for
+    // as long as the per frame budget allows, so a changed scene converges over several frames.
+    // The 27 coefficients of a probe are packed into 7 RGBA texels: texel k of every probe lives in
+    // slab k of a grid_size.x x grid_size.y x (grid_size.z * texels_per_probe) volume, so the shader
+    // samples each slab with hardware trilinear filtering.
+    class IrradianceProbes
+    {
+    public:
+        static constexpr size_t coefficients_count = 9;
+        static constexpr size_t texels_per_probe = 7;
+
+        struct Settings
+        {
+            // world position of probe (0, 0, 0)
+            glm::vec3 origin{ 0.f };
+            glm::vec3 spacing{ 4.f };
+            glm::ivec3 grid_size{ 8, 8, 4 };
+            uint32_t rays_per_probe = 256;
+            uint32_t max_bounces = 2;
+            float albedo = 0.7f;
+            // irradiance from rays leaving the scene, also what probes hold before their first bake
+            glm::vec3 sky_color{ 0.25f, 0.3f, 0.4f };
+        };
+
+        struct Stats
+        {
+            size_t probes_count = 0;
+            size_t stale_probes_count = 0;
+            size_t triangles_count = 0;
+            size_t probes_baked_last_update = 0;
+            uint64_t rays_count = 0;
+            double update_time_ms = 0.0;
+        };
+
+        IrradianceProbes();
+        ~IrradianceProbes();
+
+        IrradianceProbes(const IrradianceProbes&) = delete;
+        IrradianceProbes& operator=(const IrradianceProbes&) = delete;
+
+        // resets every probe to the sky color and forgets the scene
+        void configure(const Settings& settings);
+        // Replaces the static geometry (three world space vertices per triangle) and lights.
+        // Probes keep their current values until update re-bakes them.
+        void set_scene(const std::vector<glm::vec3>& vertices, const DirectionalLight& directional_light, const std::vector<SpotLight>& spot_lights);
+        // bakes stale probes, nearest to camera_position first, until time_budget_ms has passed
+        void update(const glm::vec3& camera_position, const double time_budget_ms);
+
+        const Settings& get_settings() const { return m_settings; }
+        const Stats& get_stats() const { return m_stats; }
+        glm::ivec3 get_texture_size() const { return glm::ivec3(m_settings.grid_size.x, m_settings.grid_size.y, m_settings.grid_size.z * static_cast<int>(texels_per_probe)); }
+        // RGBA texels in get_texture_size order, changed since the last clear_changes
+        const std::vector<glm::vec4>& get_texture_data() const { return m_texture_data; }
+        bool has_changes() const { return m_has_changes; }
+        void clear_changes() { m_has_changes = false; }
+
+        // irradiance the shaders reconstruct for a normal at a world position
+        glm::vec3 evaluate(const glm::vec3& position, const glm::vec3& normal) const;
+
+    private:
+        using Coefficients = std::array<glm::vec3, coefficients_count>;
+
+        glm::vec3 get_probe_position(const size_t probe) const;
+        Coefficients bake_probe(const size_t probe, uint64_t& rays_count) const;
+        void store_probe(const size_t probe, const Coefficients& coefficients);
+
+        Settings m_settings;
+        std::unique_ptr<BakeScene> m_scene;
+        std::vector<glm::vec3> m_directions;
+        std::vector<size_t> m_stale_probes;
+        // reused by update() so a frame with stale probes doesn't allocate
+        std::vector<size_t> m_batch;
+        std::vector<Coefficients> m_batch_results;
+        std::vector<glm::vec4> m_texture_data;
+        bool m_has_changes = false;
+        uint32_t m_scene_generation = 0;
+        Stats m_stats;
+    };
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "SimpleEngineCore/PointLight.hpp"
+
+#include <glm/vec4.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+    class Camera;
+
+    // View-space froxel grid: the view frustum is split into tiles on screen and
+    // into exponentially growing depth slices, and every cluster keeps the list of
+    // point lights that touch it. Built on the CPU every frame, one slice per job.
+    class LightClusters
+    {
+    public:
+        static constexpr uint32_t grid_size_x = 16;
+        static constexpr uint32_t grid_size_y = 9;
+        static constexpr uint32_t grid_size_z = 24;
+        static constexpr uint32_t clusters_count = grid_size_x * grid_size_y * grid_size_z;
+
+        // std430 layouts of the lighting shader buffers
+        struct GpuPointLight
+        {
+            glm::vec4 position_radius; // view space
+            glm::vec4 color_intensity;
+        };
+
+        struct GpuCluster
+        {
+            uint32_t offset;
+            uint32_t count;
+        };
+
+        struct Stats
+        {
+            size_t lights_count = 0;
+            size_t visible_lights_count = 0;
+            size_t light_indices_count = 0;
+            uint32_t max_lights_per_cluster = 0;
+            double build_time_ms = 0.0;
+        };
+
+        void build(const std::vector<PointLight>& lights, Camera& camera);
+
+        const std::vector<GpuPointLight>& get_gpu_lights() const { return m_gpu_lights; }
+        const std::vector<GpuCluster>& get_clusters() const { return m_clusters; }
+        const std::vector<uint32_t>& get_light_indices() const { return m_light_indices; }
+
+        // slice = log(view_depth) * z_scale + z_bias
+        float get_z_scale() const { return m_z_scale; }
+        float get_z_bias() const { return m_z_bias; }
+
+        const Stats& get_last_build_stats() const { return m_last_build_stats; }
+
+    private:
+        struct LightBounds
+        {
+            uint32_t first_slice;
+            uint32_t last_slice;
+        };
+
+        struct SliceBin
+        {
+            std::vector<uint64_t> tile_light_pairs;
+            std::vector<uint32_t> tile_offsets;
+            std::vector<uint32_t> light_indices;
+            uint32_t max_lights_per_cluster = 0;
+        };
+
+        void assign_slice(const uint32_t slice);
+
+        std::vector<glm::vec4> m_world_positions;
+        std::vector<glm::vec4> m_view_positions;
+        std::vector<LightBounds> m_light_bounds;
+        std::array<SliceBin, grid_size_z> m_slice_bins;
+        std::array<float, grid_size_z + 1> m_slice_depths;
+
+        std::vector<GpuPointLight> m_gpu_lights;
+        std::vector<GpuCluster> m_clusters = std::vector<GpuCluster>(clusters_count, GpuCluster{ 0, 0 });
+        std::vector<uint32_t> m_light_indices;
+
+        bool m_perspective = true;
+        float m_projection_scale_x = 1.f;
+        float m_projection_scale_y = 1.f;
+        float m_projection_offset_x = 0.f;
+        float m_projection_offset_y = 0.f;
+        float m_z_scale = 0.f;
+        float m_z_bias = 0.f;
+
+        Stats m_last_build_stats;
+    };
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "SimpleEngineCore/DirectionalLight.hpp"
+#include "SimpleEngineCore/SpotLight.hpp"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // CPU path tracer baking the indirect lighting of static geometry into one lightmap atlas.
+    // Direct light stays real-time; the lightmap replaces the ambient term.
+    // Nothing here touches OpenGL, so baking works the same with or without a window.
+    class LightmapBaker
+    {
+    public:
+        // instances never get a region smaller than this, so the default gutter stays two texels wide
+        static constexpr uint32_t min_region_size = 32;
+
+        struct Settings
+        {
+            uint32_t lightmap_size = 1024;
+            // shrunk until every instance fits the atlas
+            float texels_per_unit = 4.f;
+            uint32_t samples_per_texel = 64;
+            uint32_t max_bounces = 2;
+            float albedo = 0.7f;
+            // irradiance from rays leaving the scene
+            glm::vec3 sky_color{ 0.25f, 0.3f, 0.4f };
+            uint32_t denoise_radius = 2;
+            uint32_t dilation_passes = 4;
+            uint32_t seed = 1;
+        };
+
+        struct Stats
+        {
+            size_t instances_count = 0;
+            size_t triangles_count = 0;
+            size_t covered_texels_count = 0;
+            float texels_per_unit = 0.f;
+            uint64_t rays_count = 0;
+            double bvh_build_time_ms = 0.0;
+            double bake_time_ms = 0.0;
+            double rays_per_second = 0.0;
+        };
+
+        struct Mesh
+        {
+            std::vector<glm::vec3> positions;
+            std::vector<glm::vec3> normals;
+            // from generate_lightmap_uvs, in the unit square
+            std::vector<glm::vec2> lightmap_uvs;
+            std::vector<uint32_t> indices;
+        };
+
+        // Groups coplanar triangles sharing vertices into charts and packs them into the unit square with
+        // gutter (a fraction of the square) around every chart. A vertex shared by several charts keeps
+        // the uv of the first one, so meshes should split their vertices at hard edges.
+        static std::vector<glm::vec2> generate_lightmap_uvs(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const float gutter = 1.f / 16.f);
+
+        size_t add_mesh(Mesh mesh);
+        size_t add_instance(const size_t mesh_index, const glm::mat4& world_matrix);
+        void clear();
+
+        // Returns false when there is nothing to bake or the instances cannot fit the atlas
+        bool bake(const Settings& settings, const DirectionalLight& directional_light, const std::vector<SpotLight>& spot_lights);
+
+        uint32_t get_lightmap_size() const { return m_lightmap_size; }
+        // linear RGB irradiance, rows from the bottom like OpenGL textures
+        const std::vector<glm::vec3>& get_lightmap() const { return m_lightmap; }
+        // maps the mesh lightmap uvs of an instance into the atlas: uv * xy + zw
+        const glm::vec4& get_scale_offset(const size_t instance_index) const { return m_instances[instance_index].scale_offset; }
+        const Stats& get_stats() const { return m_stats; }
+
+        // portable float map, readable by most HDR viewers
+        bool save_pfm(const std::string& path) const;
+
+    private:
+        struct Instance
+        {
+            size_t mesh_index = 0;
+            glm::mat4 world_matrix{ 1.f };
+            uint32_t region_x = 0;
+            uint32_t region_y = 0;
+            uint32_t region_size = 0;
+            glm::vec4 scale_offset{ 0.f };
+        };
+
+        bool allocate_regions(const Settings& settings);
+
+        std::vector<Mesh> m_meshes;
+        std::vector<Instance> m_instances;
+        uint32_t m_lightmap_size = 0;
+        std::vector<glm::vec3> m_lightmap;
+        Stats m_stats;
+    };
+
+}
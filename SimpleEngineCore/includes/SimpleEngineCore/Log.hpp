@@ -1,24 +1,195 @@
 #pragma once
 
-#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+// levels below it are compiled out: 0 info, 1 warn, 2 error, 3 critical, 4 no logging at all
+#ifndef SIMPLE_ENGINE_LOG_LEVEL
+#define SIMPLE_ENGINE_LOG_LEVEL 0
+#endif
 
 namespace SimpleEngine {
 
-#ifdef NDEBUG
+    // Asynchronous logger: a call copies its arguments as a binary record into a lock-free ring buffer owned by
+    // the calling thread, a background thread formats the records and writes them through spdlog's default logger.
+    // Numbers, enums and pointers are copied as is, strings by value, other types are formatted on the calling thread.
+    // The format string is kept by pointer, it has to be a literal.
+    // A full buffer drops info and warning records, errors and critical ones wait for room; critical ones are
+    // written before the call returns. Records of one thread keep their order, records of different threads are
+    // written thread by thread with their own timestamps.
+    class Log
+    {
+    public:
+        enum class ELevel : uint32_t
+        {
+            Info,
+            Warn,
+            Error,
+            Critical,
+            Off
+        };
+
+        static void set_level(const ELevel level) { s_level.store(level, std::memory_order_relaxed); }
+        static ELevel get_level() { return s_level.load(std::memory_order_relaxed); }
+        static bool is_enabled(const ELevel level) { return level >= s_level.load(std::memory_order_relaxed); }
+
+        // returns when everything logged before the call is written
+        static void flush();
+        static uint64_t get_dropped_count();
+
+        template<size_t N, typename... Args>
+        static void write(const ELevel level, const char (&format)[N], const Args&... args)
+        {
+            if (is_enabled(level))
+            {
+                write_record(level, format, prepare(args)...);
+            }
+        }
+
+    private:
+        using DecodeFn = void(*)(const uint8_t* pArgs, const char* format, fmt::memory_buffer& buffer);
+
+        template<typename T>
+        static constexpr bool is_raw()
+        {
+            return std::is_arithmetic_v<T> || std::is_enum_v<T>
+                || (std::is_pointer_v<T> && !std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>);
+        }
+
+        template<typename T>
+        static constexpr bool is_string()
+        {
+            return std::is_convertible_v<const T&, std::string_view>;
+        }
+
+        // what is recorded for an argument: itself, or its text when the type is neither raw nor a string
+        template<typename T>
+        static decltype(auto) prepare(const T& arg)
+        {
+            if constexpr (is_raw<T>() || is_string<T>())
+            {
+                return (arg);
+            }
+            else
+            {
+                return fmt::format("{}", arg);
+            }
+        }
+
+        // strings of any kind are recorded the same way
+        template<typename T>
+        using Stored = std::conditional_t<is_raw<std::decay_t<T>>(), std::decay_t<T>, std::string_view>;
+
+        template<typename T>
+        struct Codec
+        {
+            static size_t size(const T& arg)
+            {
+                if constexpr (is_raw<T>())
+                {
+                    return sizeof(T);
+                }
+                else
+                {
+                    return sizeof(uint32_t) + arg.size();
+                }
+            }
+
+            static void encode(uint8_t*& pData, const T& arg)
+            {
+                if constexpr (is_raw<T>())
+                {
+                    std::memcpy(pData, &arg, sizeof(T));
+                    pData += sizeof(T);
+                }
+                else
+                {
+                    const uint32_t length = static_cast<uint32_t>(arg.size());
+                    std::memcpy(pData, &length, sizeof(length));
+                    std::memcpy(pData + sizeof(length), arg.data(), length);
+                    pData += sizeof(length) + length;
+                }
+            }
 
-#define LOG_INFO(...)
-#define LOG_WARN(...)
-#define LOG_ERROR(...)
-#define LOG_CRITICAL(...)
+            static T decode(const uint8_t*& pData)
+            {
+                if constexpr (is_raw<T>())
+                {
+                    T arg;
+                    std::memcpy(&arg, pData, sizeof(T));
+                    pData += sizeof(T);
+                    return arg;
+                }
+                else
+                {
+                    uint32_t length = 0;
+                    std::memcpy(&length, pData, sizeof(length));
+                    const std::string_view text(reinterpret_cast<const char*>(pData + sizeof(length)), length);
+                    pData += sizeof(length) + length;
+                    return text;
+                }
+            }
+        };
 
+        template<typename... Args>
+        static void decode(const uint8_t* pArgs, const char* format, fmt::memory_buffer& buffer)
+        {
+            // braced initialization decodes left to right
+            const std::tuple<Stored<Args>...> args{ Codec<Stored<Args>>::decode(pArgs)... };
+            std::apply([&](const auto&... values)
+                {
+                    fmt::vformat_to(std::back_inserter(buffer), fmt::string_view(format), fmt::make_format_args(values...));
+                }, args);
+        }
+
+        template<typename... Args>
+        static void write_record(const ELevel level, const char* format, const Args&... args)
+        {
+            const size_t args_size = (size_t(0) + ... + Codec<Stored<Args>>::size(args));
+            uint8_t* pData = begin_record(level, format, args_size, &decode<Args...>);
+            if (pData)
+            {
+                (Codec<Stored<Args>>::encode(pData, args), ...);
+                end_record(level);
+            }
+        }
+
+        // room for the arguments in the calling thread's buffer, nullptr when the record is dropped
+        static uint8_t* begin_record(const ELevel level, const char* format, const size_t args_size, const DecodeFn decode);
+        static void end_record(const ELevel level);
+
+        static inline std::atomic<ELevel> s_level{ ELevel::Info };
+    };
+
+}
+
+#if SIMPLE_ENGINE_LOG_LEVEL <= 0
+#define LOG_INFO(...)       ::SimpleEngine::Log::write(::SimpleEngine::Log::ELevel::Info, __VA_ARGS__)
 #else
+#define LOG_INFO(...)       ((void)0)
+#endif
 
-#define LOG_INFO(...)       spdlog::info(__VA_ARGS__)
-#define LOG_WARN(...)       spdlog::warn(__VA_ARGS__)
-#define LOG_ERROR(...)      spdlog::error(__VA_ARGS__)
-#define LOG_CRITICAL(...)   spdlog::critical(__VA_ARGS__)
+#if SIMPLE_ENGINE_LOG_LEVEL <= 1
+#define LOG_WARN(...)       ::SimpleEngine::Log::write(::SimpleEngine::Log::ELevel::Warn, __VA_ARGS__)
+#else
+#define LOG_WARN(...)       ((void)0)
+#endif
 
+#if SIMPLE_ENGINE_LOG_LEVEL <= 2
+#define LOG_ERROR(...)      ::SimpleEngine::Log::write(::SimpleEngine::Log::ELevel::Error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...)      ((void)0)
 #endif
 
-}
\ No newline at end of file
+#if SIMPLE_ENGINE_LOG_LEVEL <= 3
+#define LOG_CRITICAL(...)   ::SimpleEngine::Log::write(::SimpleEngine::Log::ELevel::Critical, __VA_ARGS__)
+#else
+#define LOG_CRITICAL(...)   ((void)0)
+#endif
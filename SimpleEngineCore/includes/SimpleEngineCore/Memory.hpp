@@ -0,0 +1,275 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // subsystem an allocation is accounted to, set per thread with MemoryTagScope
+    enum class EMemoryTag : uint8_t
+    {
+        General,
+        Rendering,
+        Lighting,
+        Jobs,
+        Events,
+        Input,
+        UI,
+        Profiler,
+        Log,
+        IO,
+
+        Count
+    };
+
+    const char* get_memory_tag_name(const EMemoryTag tag);
+
+    // Heap accounting per tag. With SIMPLE_ENGINE_MEMORY_TRACKING the engine replaces the global operator new and
+    // delete, every allocation is counted under the calling thread's current tag and freed under the tag it was
+    // made with. Pools and arenas take their memory from the heap in large blocks, so only their growth shows up here.
+    class MemoryTracker
+    {
+    public:
+        struct TagStats
+        {
+            uint64_t live_bytes = 0;
+            uint64_t live_allocations_count = 0;
+            uint64_t peak_live_bytes = 0;
+            // the last finished frame
+            uint64_t frame_allocations_count = 0;
+            uint64_t frame_bytes = 0;
+            uint64_t peak_frame_allocations_count = 0;
+            uint64_t peak_frame_bytes = 0;
+        };
+
+        // false when the engine is built without SIMPLE_ENGINE_MEMORY_TRACKING, every count then stays 0
+        static bool is_enabled();
+
+        // closes the frame, once per frame on the main thread
+        static void new_frame();
+
+        static TagStats get_stats(const EMemoryTag tag);
+        // allocations made under the tag since the last new_frame()
+        static uint64_t get_current_frame_allocations_count(const EMemoryTag tag);
+        static void reset_peaks();
+    };
+
+    class MemoryTagScope
+    {
+    public:
+        explicit MemoryTagScope(const EMemoryTag tag);
+        ~MemoryTagScope();
+
+        MemoryTagScope(const MemoryTagScope&) = delete;
+        MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+        static EMemoryTag get_current();
+
+    private:
+        EMemoryTag m_previous_tag;
+    };
+
+
+    // Linear allocator: allocation is a lock-free bump of an offset, any thread may allocate, nothing is freed
+    // until reset(). Past the capacity it falls back to the heap for the rest of the frame and reset() grows
+    // the buffer to the largest frame seen, so a steady frame stops touching the heap after the first frames.
+    class FrameArena
+    {
+    public:
+        explicit FrameArena(const size_t capacity, const EMemoryTag tag = EMemoryTag::General);
+        ~FrameArena();
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        // alignment is a power of two
+        void* allocate(const size_t size, const size_t alignment = alignof(std::max_align_t));
+
+        template<typename T>
+        T* allocate_array(const size_t count)
+        {
+            return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+        }
+
+        // no allocation may be in progress
+        void reset();
+
+        size_t get_capacity() const { return m_capacity; }
+        size_t get_used_bytes() const;
+        // the largest frame since the arena was created, overflow included
+        size_t get_peak_used_bytes() const { return m_peak_used_bytes; }
+        size_t get_overflow_bytes() const { return m_overflow_bytes.load(std::memory_order_relaxed); }
+
+    private:
+        void* allocate_overflow(const size_t size, const size_t alignment);
+        void free_overflow_blocks();
+
+        std::unique_ptr<uint8_t[]> m_pBuffer;
+        size_t m_capacity = 0;
+        EMemoryTag m_tag;
+        std::atomic<size_t> m_offset{ 0 };
+        std::atomic<size_t> m_overflow_bytes{ 0 };
+        size_t m_peak_used_bytes = 0;
+        std::mutex m_overflow_mutex;
+        std::vector<std::pair<void*, size_t>> m_overflow_blocks;
+    };
+
+    // Two frame arenas used in turn: memory taken from get_arena() in frame N stays valid through frame N + 1,
+    // so what reads a frame's data one frame late (a render thread, uploads of the previous frame) can keep reading it.
+    class FrameMemory
+    {
+    public:
+        static FrameArena& get_arena();
+        static const FrameArena& get_previous_arena();
+
+        // resets the arena of two frames ago and makes it current, once per frame while no job is running
+        static void new_frame();
+    };
+
+    // std containers allocating from the current frame arena, they must not outlive the next frame
+    template<typename T>
+    class FrameAllocator
+    {
+    public:
+        using value_type = T;
+
+        FrameAllocator() noexcept = default;
+        template<typename U>
+        FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+        T* allocate(const size_t count)
+        {
+            return FrameMemory::get_arena().allocate_array<T>(count);
+        }
+
+        void deallocate(T*, const size_t) noexcept {}
+
+        template<typename U>
+        bool operator==(const FrameAllocator<U>&) const noexcept { return true; }
+        template<typename U>
+        bool operator!=(const FrameAllocator<U>&) const noexcept { return false; }
+    };
+
+    template<typename T>
+    using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+
+    // Fixed size blocks carved out of chunks taken from the heap. Freed blocks go to a free list for reuse,
+    // chunks are only released with the pool. Thread-safe.
+    class FixedPool
+    {
+    public:
+        FixedPool(const size_t block_size, const size_t blocks_per_chunk, const EMemoryTag tag = EMemoryTag::General);
+        ~FixedPool();
+
+        FixedPool(const FixedPool&) = delete;
+        FixedPool& operator=(const FixedPool&) = delete;
+
+        void* allocate();
+        void deallocate(void* pBlock);
+
+        size_t get_block_size() const { return m_block_size; }
+        size_t get_used_blocks_count() const { return m_used_blocks_count.load(std::memory_order_relaxed); }
+        size_t get_blocks_count() const { return m_blocks_count.load(std::memory_order_relaxed); }
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* pNext;
+        };
+
+        const size_t m_block_size;
+        const size_t m_blocks_per_chunk;
+        const EMemoryTag m_tag;
+        std::mutex m_mutex;
+        FreeBlock* m_pFreeBlocks = nullptr;
+        std::vector<std::unique_ptr<uint8_t[]>> m_chunks;
+        std::atomic<size_t> m_used_blocks_count{ 0 };
+        std::atomic<size_t> m_blocks_count{ 0 };
+    };
+
+    template<typename T>
+    class ObjectPool
+    {
+    public:
+        static_assert(alignof(T) <= alignof(std::max_align_t), "pool blocks are only aligned for fundamental types");
+
+        explicit ObjectPool(const size_t objects_per_chunk = 64, const EMemoryTag tag = EMemoryTag::General)
+            : m_pool(sizeof(T), objects_per_chunk, tag)
+        {
+        }
+
+        template<typename... Args>
+        T* create(Args&&... args)
+        {
+            void* pBlock = m_pool.allocate();
+            return new (pBlock) T(std::forward<Args>(args)...);
+        }
+
+        void destroy(T* pObject)
+        {
+            pObject->~T();
+            m_pool.deallocate(pObject);
+        }
+
+        const FixedPool& get_pool() const { return m_pool; }
+
+    private:
+        FixedPool m_pool;
+    };
+
+    // Size classes of 16 to 256 bytes per tag, shared by every PoolAllocator. Larger or over-aligned requests go to the heap.
+    class MemoryPools
+    {
+    public:
+        static constexpr size_t size_classes_count = 5;
+        static constexpr size_t min_block_size = 16;
+        static constexpr size_t max_block_size = min_block_size << (size_classes_count - 1);
+
+        static void* allocate(const size_t size, const size_t alignment, const EMemoryTag tag);
+        static void deallocate(void* p, const size_t size, const size_t alignment, const EMemoryTag tag);
+
+        static const FixedPool& get_pool(const EMemoryTag tag, const size_t size_class);
+    };
+
+    // std containers of small nodes or short arrays (lists, maps, small vectors) that come and go often
+    template<typename T, EMemoryTag Tag = EMemoryTag::General>
+    class PoolAllocator
+    {
+    public:
+        using value_type = T;
+
+        // the tag is a non-type parameter, so allocator_traits can't rebind on its own
+        template<typename U>
+        struct rebind
+        {
+            using other = PoolAllocator<U, Tag>;
+        };
+
+        PoolAllocator() noexcept = default;
+        template<typename U>
+        PoolAllocator(const PoolAllocator<U, Tag>&) noexcept {}
+
+        T* allocate(const size_t count)
+        {
+            return static_cast<T*>(MemoryPools::allocate(count * sizeof(T), alignof(T), Tag));
+        }
+
+        void deallocate(T* p, const size_t count) noexcept
+        {
+            MemoryPools::deallocate(p, count * sizeof(T), alignof(T), Tag);
+        }
+
+        template<typename U>
+        bool operator==(const PoolAllocator<U, Tag>&) const noexcept { return true; }
+        template<typename U>
+        bool operator!=(const PoolAllocator<U, Tag>&) const noexcept { return false; }
+    };
+
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+namespace SimpleEngine {
+
+    struct PointLight
+    {
+        glm::vec3 position{ 0.f, 0.f, 0.f };
+        float radius = 5.f;
+        glm::vec3 color{ 1.f, 1.f, 1.f };
+        float intensity = 1.f;
+    };
+
+}
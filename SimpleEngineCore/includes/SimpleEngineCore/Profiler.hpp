@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // Frame profiler. CPU scopes land in a lock-free ring buffer owned by the thread that ran them,
+    // GPU scopes arrive from timestamp queries a few frames later. The main thread collects both once
+    // per frame into a short history for the UI, and into a capture that exports to Chrome trace_event JSON.
+    class Profiler
+    {
+    public:
+        static constexpr uint32_t gpu_thread = ~0u;
+        static constexpr size_t history_frames_count = 240;
+        // per thread and frame, events past it are dropped and counted
+        static constexpr size_t thread_buffer_capacity = 16384;
+
+        struct Event
+        {
+            // a string literal: scopes keep only the pointer
+            const char* name = nullptr;
+            // since the profiler started
+            uint64_t start_ns = 0;
+            uint64_t end_ns = 0;
+            uint32_t depth = 0;
+            // index into get_thread_names, or gpu_thread
+            uint32_t thread = 0;
+        };
+
+        struct Frame
+        {
+            uint64_t index = 0;
+            uint64_t start_ns = 0;
+            uint64_t end_ns = 0;
+            std::vector<Event> events;
+        };
+
+        // closes the current frame with every event finished since the last call
+        static void new_frame();
+        static uint64_t get_frame_index();
+        static uint64_t now_ns();
+
+        // used by ProfileScope
+        static uint32_t begin_scope();
+        static void end_scope(const char* name, const uint64_t start_ns, const uint32_t depth);
+        // used by the GPU profiler once the timestamps of a frame are read back, already in CPU time
+        static void add_gpu_events(const uint64_t frame_index, const std::vector<Event>& events);
+
+        static void set_thread_name(const char* name);
+        static std::vector<std::string> get_thread_names();
+
+        // completed frames, oldest first; a paused history keeps its frames and skips new ones
+        static const std::deque<Frame>& get_frames();
+        static void set_paused(const bool paused);
+        static bool is_paused();
+        static uint64_t get_dropped_events_count();
+
+        static void start_capture();
+        static void stop_capture();
+        static bool is_capturing();
+        static size_t get_captured_events_count();
+        // the capture as Chrome trace_event JSON, for chrome://tracing or Perfetto
+        static bool save_chrome_trace(const std::string& path);
+    };
+
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char* name)
+            : m_name(name)
+            , m_start_ns(Profiler::now_ns())
+            , m_depth(Profiler::begin_scope())
+        {
+        }
+
+        ~ProfileScope()
+        {
+            Profiler::end_scope(m_name, m_start_ns, m_depth);
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        const char* m_name;
+        uint64_t m_start_ns;
+        uint32_t m_depth;
+    };
+
+}
+
+#define SIMPLE_ENGINE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SIMPLE_ENGINE_PROFILE_CONCAT(a, b) SIMPLE_ENGINE_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef SIMPLE_ENGINE_PROFILING
+
+#define PROFILE_SCOPE(name)         ::SimpleEngine::ProfileScope SIMPLE_ENGINE_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_FUNCTION()          PROFILE_SCOPE(__func__)
+#define PROFILE_THREAD_NAME(name)   ::SimpleEngine::Profiler::set_thread_name(name)
+#define PROFILE_FRAME()             ::SimpleEngine::Profiler::new_frame()
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD_NAME(name)
+#define PROFILE_FRAME()
+
+#endif
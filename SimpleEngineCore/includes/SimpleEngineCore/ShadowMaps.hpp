@@ -0,0 +1,90 @@
+#pragma once
+
+#include "SimpleEngineCore/DirectionalLight.hpp"
+#include "SimpleEngineCore/SpotLight.hpp"
+
+#include <glm/vec4.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // Shadow atlas bookkeeping. Every shadow owns a square tile in two atlases of the same size:
+    // the cache holds only static casters and is redrawn when invalidated, the live atlas gets a
+    // copy of the cache every frame with the dynamic casters drawn on top.
+    class ShadowMaps
+    {
+    public:
+        static constexpr uint32_t min_resolution = 128;
+        static constexpr uint32_t min_atlas_size = 512;
+        static constexpr uint32_t max_atlas_size = 8192;
+
+        struct Tile
+        {
+            uint32_t x = 0;
+            uint32_t y = 0;
+            uint32_t size = 0;
+        };
+
+        struct Stats
+        {
+            size_t shadows_count = 0;
+            size_t downgraded_shadows_count = 0;
+            size_t dropped_shadows_count = 0;
+            size_t cache_hits = 0;
+            size_t cache_misses = 0;
+            size_t static_casters_drawn = 0;
+            size_t dynamic_casters_drawn = 0;
+            size_t atlas_bytes = 0;
+            size_t used_bytes = 0;
+            double cpu_time_ms = 0.0;
+            double gpu_time_ms = 0.0;
+        };
+
+        explicit ShadowMaps(const size_t memory_budget_bytes = 64 * 1024 * 1024);
+
+        // The atlas size is the largest power of two whose cache and live atlases fit the budget
+        void set_memory_budget(const size_t memory_budget_bytes);
+        size_t get_memory_budget() const { return m_memory_budget_bytes; }
+        uint32_t get_atlas_size() const { return m_atlas_size; }
+
+        // One requested resolution per shadow, 0 for lights without shadows. When everything
+        // does not fit, the largest tiles are halved first, the last requests before earlier ones.
+        void allocate(const std::vector<uint32_t>& requested_resolutions);
+        const Tile& get_tile(const size_t shadow_index) const { return m_tiles[shadow_index]; }
+        // maps the light's clip space to atlas texture coordinates and [0, 1] depth
+        glm::mat4 get_atlas_matrix(const size_t shadow_index) const;
+        // texture coordinates of the tile as (min x, min y, max x, max y), all zero without a tile
+        glm::vec4 get_atlas_rect(const size_t shadow_index) const;
+
+        // True when the cached static casters must be redrawn: the light changed, the tile moved,
+        // or static geometry changed after the last redraw. Counts cache hits and misses.
+        bool needs_static_redraw(const size_t shadow_index, const glm::mat4& light_view_projection, const uint64_t static_geometry_version);
+        void invalidate_all();
+
+        void begin_frame();
+        void record_casters_drawn(const size_t static_count, const size_t dynamic_count);
+        void record_times(const double cpu_time_ms, const double gpu_time_ms);
+        const Stats& get_stats() const { return m_stats; }
+
+        static glm::mat4 get_view_projection(const DirectionalLight& light);
+        static glm::mat4 get_view_projection(const SpotLight& light);
+
+    private:
+        struct CacheState
+        {
+            glm::mat4 light_view_projection{ 0.f };
+            uint64_t static_geometry_version = 0;
+            bool valid = false;
+        };
+
+        size_t m_memory_budget_bytes = 0;
+        uint32_t m_atlas_size = 0;
+        std::vector<uint32_t> m_requested_resolutions;
+        std::vector<Tile> m_tiles;
+        std::vector<CacheState> m_cache_states;
+        Stats m_stats;
+    };
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+
+namespace SimpleEngine {
+
+    struct SpotLight
+    {
+        glm::vec3 position{ 0.f, 0.f, 5.f };
+        float range = 15.f;
+        glm::vec3 direction{ 0.f, 0.f, -1.f };
+        float intensity = 4.f;
+        glm::vec3 color{ 1.f, 1.f, 1.f };
+        float inner_angle = 20.f; // degrees
+        float outer_angle = 30.f; // degrees
+
+        bool cast_shadows = true;
+        uint32_t shadow_resolution = 512;
+    };
+
+}
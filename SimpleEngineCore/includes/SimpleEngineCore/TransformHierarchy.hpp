@@ -0,0 +1,121 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+    // Parent/child transforms stored breadth-first in contiguous arrays:
+    // every depth level is one range and the children of a node are adjacent,
+    // so update() walks only the subtrees below nodes changed since the last call.
+    class TransformHierarchy
+    {
+    public:
+        using NodeId = uint32_t;
+        static constexpr NodeId invalid_node = UINT32_MAX;
+
+        struct UpdateStats
+        {
+            size_t nodes_count = 0;
+            size_t updated_nodes_count = 0;
+            size_t levels_count = 0;
+            bool order_rebuilt = false;
+        };
+
+        NodeId create_node(const NodeId parent = invalid_node,
+                           const glm::vec3& position = { 0, 0, 0 },
+                           const glm::quat& rotation = { 1, 0, 0, 0 },
+                           const glm::vec3& scale = { 1, 1, 1 });
+        // count nodes at once, one append per array instead of count create_node() calls.
+        // parents: index of each node's parent among the new ones, invalid_node for a root, or null for roots only;
+        // they must not form loops. The new nodes are written to nodes.
+        void create_nodes(const size_t count,
+                          const glm::vec3* positions,
+                          const glm::quat* rotations,
+                          const glm::vec3* scales,
+                          const uint32_t* parents,
+                          NodeId* nodes);
+
+        // Removes the node and its whole subtree. Takes effect on the next update().
+        void destroy_node(const NodeId node);
+        void set_parent(const NodeId node, const NodeId parent);
+
+        void set_local_position(const NodeId node, const glm::vec3& position);
+        void set_local_rotation(const NodeId node, const glm::quat& rotation);
+        void set_local_scale(const NodeId node, const glm::vec3& scale);
+        void set_local_transform(const NodeId node, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+        const glm::vec3& get_local_position(const NodeId node) const { return m_local_positions[m_node_to_index[node]]; }
+        const glm::quat& get_local_rotation(const NodeId node) const { return m_local_rotations[m_node_to_index[node]]; }
+        const glm::vec3& get_local_scale(const NodeId node) const { return m_local_scales[m_node_to_index[node]]; }
+        NodeId get_parent(const NodeId node) const;
+
+        // Valid after update()
+        const glm::mat4& get_world_matrix(const NodeId node) const { return m_world_matrices[m_node_to_index[node]]; }
+        const glm::mat3& get_normal_matrix(const NodeId node) const { return m_normal_matrices[m_node_to_index[node]]; }
+
+        // Dense index of the node inside the breadth-first arrays, stable until the next structural change
+        uint32_t get_index(const NodeId node) const { return m_node_to_index[node]; }
+        const glm::mat4* get_world_matrices() const { return m_world_matrices.data(); }
+        const glm::mat3* get_normal_matrices() const { return m_normal_matrices.data(); }
+
+        // update() calls so far; a node's world version is the update that last changed its world matrix
+        uint64_t get_update_count() const { return m_update_count; }
+        uint64_t get_world_version(const NodeId node) const { return m_world_versions[m_node_to_index[node]]; }
+
+        bool is_alive(const NodeId node) const;
+        size_t get_nodes_count() const { return m_world_matrices.size(); }
+
+        void update();
+        const UpdateStats& get_last_update_stats() const { return m_last_update_stats; }
+
+    private:
+        // [begin, end) of dense indices
+        struct IndexRange
+        {
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        void mark_dirty(const uint32_t index);
+        void rebuild_order();
+        void update_nodes(const IndexRange* ranges, const size_t count);
+        void update_run(const uint32_t first, const uint32_t last);
+
+        // indexed by dense breadth-first index
+        std::vector<uint32_t> m_parent_indices;
+        std::vector<uint32_t> m_first_child_indices;
+        std::vector<uint32_t> m_children_counts;
+        std::vector<glm::vec3> m_local_positions;
+        std::vector<glm::quat> m_local_rotations;
+        std::vector<glm::vec3> m_local_scales;
+        std::vector<glm::mat4> m_world_matrices;
+        std::vector<glm::mat3> m_normal_matrices;
+        std::vector<uint64_t> m_world_versions;
+        std::vector<NodeId> m_index_to_node;
+        // one bit per dense index, so update() finds the dirty nodes in order without sorting them
+        std::vector<uint64_t> m_dirty_bits;
+        size_t m_dirty_count = 0;
+
+        // indexed by NodeId
+        std::vector<uint32_t> m_node_to_index;
+        std::vector<NodeId> m_free_nodes;
+
+        std::vector<uint32_t> m_level_offsets;
+        std::vector<uint32_t> m_pending_destroy;
+        // the nodes update() recomputes on one level, sorted and disjoint, and the number of nodes before each range
+        std::vector<IndexRange> m_current_ranges;
+        std::vector<IndexRange> m_next_ranges;
+        std::vector<uint32_t> m_range_offsets;
+
+        uint64_t m_update_count = 0;
+        bool m_order_dirty = false;
+        UpdateStats m_last_update_stats;
+    };
+
+}
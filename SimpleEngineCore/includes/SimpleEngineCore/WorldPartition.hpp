@@ -0,0 +1,84 @@
+#pragma once
+
+#include "SimpleEngineCore/TransformHierarchy.hpp"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace SimpleEngine {
+
+    // A world cut into square cells over the XY plane, each cell a file of its own read through the
+    // VirtualFileSystem. Cells within load_radius of the camera, or of where its velocity takes it within
+    // prefetch_seconds, are read and parsed off the main thread, then activated a chunk of objects at a time
+    // within a per-frame time budget. Cells further than load_radius + unload_margin are unloaded, so going back
+    // and forth across the edge of the radius doesn't read the same cells again and again.
+    //
+    // Activated objects are nodes of the TransformHierarchy given to init(); the callbacks tell the owner which
+    // nodes appeared and which ones are about to be destroyed, all at once per update(). Main thread only.
+    class WorldPartition
+    {
+    public:
+        // stored as-is in the cell files
+        struct Cube
+        {
+            glm::vec3 position{ 0.f };
+            glm::quat rotation{ 1.f, 0.f, 0.f, 0.f };
+            glm::vec3 scale{ 1.f };
+        };
+
+        struct Settings
+        {
+            // cells are read from directory/x_y.cell, missing ones are empty
+            std::string directory = "world";
+            float cell_size = 64.f;
+            float load_radius = 192.f;
+            float unload_margin = 32.f;
+            // how far ahead along the camera's velocity cells are read, capped at load_radius
+            float prefetch_seconds = 1.f;
+            double activation_budget_ms = 1.0;
+            unsigned int max_reads_in_flight = 8;
+        };
+
+        struct Stats
+        {
+            size_t loading_cells_count = 0;
+            // read and waiting for activation or being activated
+            size_t pending_cells_count = 0;
+            size_t active_cells_count = 0;
+            size_t empty_cells_count = 0;
+            size_t failed_cells_count = 0;
+            size_t active_cubes_count = 0;
+            uint64_t loaded_cells_count = 0;
+            uint64_t unloaded_cells_count = 0;
+            // reads dropped because the camera went away before they finished
+            uint64_t cancelled_reads_count = 0;
+            double update_time_ms = 0.0;
+            glm::vec3 camera_velocity{ 0.f };
+        };
+
+        using NodesCallback = void(*)(void* pContext, const TransformHierarchy::NodeId* nodes, const size_t count);
+
+        // starts from no loaded cell, calls shutdown() first when already initialized
+        static void init(const Settings& settings, TransformHierarchy& transforms, const NodesCallback on_nodes_added,
+                         const NodesCallback on_nodes_removed, void* pContext);
+        // unloads every cell through the callbacks, reads in flight are cancelled
+        static void shutdown();
+        static bool is_initialized();
+
+        // time in seconds, only its differences matter; the camera's velocity is smoothed over the last frames
+        static void update(const glm::vec3& camera_position, const double time);
+
+        static glm::ivec2 get_cell(const glm::vec3& position, const float cell_size);
+        static std::string get_cell_path(const std::string& directory, const glm::ivec2& cell);
+        static bool save_cell(const std::string& path, const Cube* cubes, const size_t count);
+
+        static Stats get_stats();
+        static const Settings& get_settings();
+    };
+
+}
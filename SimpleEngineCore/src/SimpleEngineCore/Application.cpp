@@ -3,22 +3,57 @@
 #include "SimpleEngineCore/Window.hpp"
 #include "SimpleEngineCore/Event.hpp"
 #include "SimpleEngineCore/Input.hpp"
+#include "SimpleEngineCore/JobSystem.hpp"
+#include "SimpleEngineCore/GpuMemory.hpp"
+#include "SimpleEngineCore/Memory.hpp"
+#include "SimpleEngineCore/Math/BatchMath.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
 
 #include "SimpleEngineCore/Rendering/OpenGL/ShaderProgram.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/VertexBuffer.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/VertexArray.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/IndexBuffer.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/Texture2D.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/Texture3D.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/ShaderStorageBuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/Framebuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuTimer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/ShadowAtlas.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuProfiler.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/GLCapture.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/FramebufferReadback.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuResources.hpp"
+#include "SimpleEngineCore/ImageWriter.hpp"
+#include "SimpleEngineCore/ProceduralTextures.hpp"
 #include "SimpleEngineCore/Camera.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/Renderer_OpenGL.hpp"
 #include "SimpleEngineCore/Modules/UIModule.hpp"
+#include "SimpleEngineCore/Modules/ProfilerWindow.hpp"
+#include "SimpleEngineCore/Modules/MemoryWindow.hpp"
+#include "SimpleEngineCore/Modules/GpuMemoryWindow.hpp"
+#include "SimpleEngineCore/Assets/AssetManifest.hpp"
+#include "SimpleEngineCore/Assets/TextureStreamer.hpp"
+#include "SimpleEngineCore/IO/VirtualFileSystem.hpp"
+#include "SimpleEngineCore/Scene/SceneFile.hpp"
+#include "SimpleEngineCore/Scene/SceneSaver.hpp"
 
 #include <imgui/imgui.h>
 #include <glm/mat3x3.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/trigonometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <limits>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <unordered_map>
 
 namespace SimpleEngine {
 
@@ -72,99 +107,28 @@ namespace SimpleEngine {
         20, 21, 22, 22, 23, 20  // bottom
     };
 
-    void generate_circle(unsigned char* data,
-                         const unsigned int width,
-                         const unsigned int height,
-                         const unsigned int center_x,
-                         const unsigned int center_y,
-                         const unsigned int radius,
-                         const unsigned char color_r,
-                         const unsigned char color_g,
-                         const unsigned char color_b)
-    {
-        for (unsigned int x = 0; x < width; ++x)
-        {
-            for (unsigned int y = 0; y < height; ++y)
-            {
-                if ((x - center_x) * (x - center_x) + (y - center_y) * (y - center_y) < radius * radius)
-                {
-                    data[3 * (x + width * y) + 0] = color_r;
-                    data[3 * (x + width * y) + 1] = color_g;
-                    data[3 * (x + width * y) + 2] = color_b;
-                }
-            }
-        }
-    }
-
-    void generate_smile_texture(unsigned char* data,
-                                const unsigned int width,
-                                const unsigned int height)
-    {
-        // background
-        for (unsigned int x = 0; x < width; ++x)
-        {
-            for (unsigned int y = 0; y < height; ++y)
-            {
-                data[3 * (x + width * y) + 0] = 200;
-                data[3 * (x + width * y) + 1] = 191;
-                data[3 * (x + width * y) + 2] = 231;
-            }
-        }
-
-        // face
-        generate_circle(data, width, height, width * 0.5, height * 0.5, width * 0.4, 255, 255, 0);
-
-        // smile
-        generate_circle(data, width, height, width * 0.5, height * 0.4, width * 0.2, 0, 0, 0);
-        generate_circle(data, width, height, width * 0.5, height * 0.45, width * 0.2, 255, 255, 0);
-
-        // eyes
-        generate_circle(data, width, height, width * 0.35, height * 0.6, width * 0.07, 255, 0, 255);
-        generate_circle(data, width, height, width * 0.65, height * 0.6, width * 0.07, 0, 0, 255);
-    }
-
-    void generate_quads_texture(unsigned char* data,
-                                const unsigned int width,
-                                const unsigned int height)
-    {
-        for (unsigned int x = 0; x < width; ++x)
-        {
-            for (unsigned int y = 0; y < height; ++y)
-            {
-                if ((x < width / 2 && y < height / 2) || x >= width / 2 && y >= height / 2)
-                {
-                    data[3 * (x + width * y) + 0] = 0;
-                    data[3 * (x + width * y) + 1] = 0;
-                    data[3 * (x + width * y) + 2] = 0;
-                }
-                else
-                {
-                    data[3 * (x + width * y) + 0] = 255;
-                    data[3 * (x + width * y) + 1] = 255;
-                    data[3 * (x + width * y) + 2] = 255;
-                }
-            }
-        }
-    }
-
     const char* vertex_shader =
-        R"(#version 460
+        R"(#version 450
            layout(location = 0) in vec3 vertex_position;
            layout(location = 1) in vec3 vertex_normal;
            layout(location = 2) in vec2 texture_coord;
+           layout(location = 3) in vec2 lightmap_coord;
 
            uniform mat4 model_view_matrix;
            uniform mat4 mvp_matrix;
            uniform mat3 normal_matrix;
+           uniform vec4 lightmap_scale_offset;
            uniform int current_frame; 
 
            out vec2 tex_coord_smile;
            out vec2 tex_coord_quads;
+           out vec2 frag_lightmap_coord;
            out vec3 frag_position_eye;
            out vec3 frag_normal_eye;
 
            void main() {
               tex_coord_smile = texture_coord;
+              frag_lightmap_coord = lightmap_coord * lightmap_scale_offset.xy + lightmap_scale_offset.zw;
               tex_coord_quads = texture_coord + vec2(current_frame / 1000.f, current_frame / 1000.f);
               frag_normal_eye = normal_matrix * vertex_normal;
               frag_position_eye = vec3(model_view_matrix * vec4(vertex_position, 1.0));
@@ -172,18 +136,186 @@ namespace SimpleEngine {
            }
         )";
 
+    // shared by the forward fragment shader and the deferred lighting pass, must match LightClusters
+    const char* clustered_point_lights_shader =
+        R"(
+           struct PointLight {
+              vec4 position_radius;
+              vec4 color_intensity;
+           };
+           struct Cluster {
+              uint offset;
+              uint count;
+           };
+           layout (std430, binding = 0) readonly buffer PointLights { PointLight point_lights[]; };
+           layout (std430, binding = 1) readonly buffer Clusters { Cluster clusters[]; };
+           layout (std430, binding = 2) readonly buffer LightIndices { uint light_indices[]; };
+
+           const uvec3 cluster_grid_size = uvec3(16, 9, 24);
+           uniform vec2 viewport_size;
+           uniform float cluster_z_scale;
+           uniform float cluster_z_bias;
+
+           vec3 point_lights_contribution(vec3 position_eye, vec3 normal, vec3 view_dir, float diffuse_factor, float specular_factor, float shininess) {
+              float depth = max(-position_eye.z, 1e-4);
+              uint slice = uint(clamp(log(depth) * cluster_z_scale + cluster_z_bias, 0.0, float(cluster_grid_size.z - 1u)));
+              uvec2 tile = min(uvec2(gl_FragCoord.xy / viewport_size * vec2(cluster_grid_size.xy)), cluster_grid_size.xy - 1u);
+              Cluster cluster = clusters[tile.x + cluster_grid_size.x * (tile.y + cluster_grid_size.y * slice)];
+
+              vec3 result = vec3(0.0);
+              for (uint i = 0u; i < cluster.count; ++i) {
+                 PointLight light = point_lights[light_indices[cluster.offset + i]];
+                 vec3 to_light = light.position_radius.xyz - position_eye;
+                 float light_distance = length(to_light);
+                 float radius = light.position_radius.w;
+                 if (light_distance >= radius) {
+                    continue;
+                 }
+                 vec3 light_dir = to_light / light_distance;
+
+                 // inverse square falloff windowed to reach zero at the radius
+                 float window = clamp(1.0 - pow(light_distance / radius, 4.0), 0.0, 1.0);
+                 vec3 radiance = light.color_intensity.rgb * light.color_intensity.w * window * window / (light_distance * light_distance + 1.0);
+
+                 float diffuse = diffuse_factor * max(dot(normal, light_dir), 0.0);
+                 float specular = specular_factor * pow(max(dot(view_dir, reflect(-light_dir, normal)), 0.0), shininess);
+                 result += (diffuse + specular) * radiance;
+              }
+              return result;
+           }
+        )";
+
+    // shared by the forward fragment shader and the deferred lighting pass, must match GpuSpotLight
+    const char* shadowed_lights_shader =
+        R"(
+           struct SpotLight {
+              mat4 shadow_matrix;
+              vec4 position_range;
+              vec4 direction_cos_outer;
+              vec4 color_cos_inner;
+              vec4 shadow_rect;
+           };
+           layout (std430, binding = 3) readonly buffer SpotLights { SpotLight spot_lights[]; };
+           layout (binding = 5) uniform sampler2DShadow shadow_atlas;
+
+           uniform int spot_lights_count;
+           uniform vec3 directional_light_direction_eye;
+           uniform vec3 directional_light_color;
+           uniform mat4 directional_shadow_matrix;
+           uniform vec4 directional_shadow_rect;
+
+           // 3x3 taps of 2x2 hardware PCF, clamped to the tile so neighbouring shadows never bleed in
+           float shadow_visibility(mat4 shadow_matrix, vec4 rect, vec3 position_eye) {
+              if (rect.z <= rect.x) {
+                 return 1.0;
+              }
+              vec4 shadow_position = shadow_matrix * vec4(position_eye, 1.0);
+              vec3 uvz = shadow_position.xyz / shadow_position.w;
+              if (any(lessThan(uvz.xy, rect.xy)) || any(greaterThan(uvz.xy, rect.zw)) || uvz.z >= 1.0) {
+                 return 1.0;
+              }
+              vec2 texel = 1.0 / vec2(textureSize(shadow_atlas, 0));
+              vec2 uv_min = rect.xy + 0.5 * texel;
+              vec2 uv_max = rect.zw - 0.5 * texel;
+              float visibility = 0.0;
+              for (int y = -1; y <= 1; ++y) {
+                 for (int x = -1; x <= 1; ++x) {
+                    visibility += texture(shadow_atlas, vec3(clamp(uvz.xy + vec2(x, y) * texel, uv_min, uv_max), uvz.z));
+                 }
+              }
+              return visibility / 9.0;
+           }
+
+           vec3 shadowed_lights_contribution(vec3 position_eye, vec3 normal, vec3 view_dir, float diffuse_factor, float specular_factor, float shininess) {
+              vec3 result = vec3(0.0);
+
+              vec3 light_dir = -directional_light_direction_eye;
+              float diffuse = diffuse_factor * max(dot(normal, light_dir), 0.0);
+              if (diffuse > 0.0) {
+                 float specular = specular_factor * pow(max(dot(view_dir, reflect(-light_dir, normal)), 0.0), shininess);
+                 result += (diffuse + specular) * directional_light_color * shadow_visibility(directional_shadow_matrix, directional_shadow_rect, position_eye);
+              }
+
+              for (int i = 0; i < spot_lights_count; ++i) {
+                 SpotLight light = spot_lights[i];
+                 vec3 to_light = light.position_range.xyz - position_eye;
+                 float light_distance = length(to_light);
+                 float range = light.position_range.w;
+                 if (light_distance >= range) {
+                    continue;
+                 }
+                 light_dir = to_light / light_distance;
+                 float cone = smoothstep(light.direction_cos_outer.w, light.color_cos_inner.w, dot(-light_dir, light.direction_cos_outer.xyz));
+                 diffuse = diffuse_factor * max(dot(normal, light_dir), 0.0);
+                 if (cone <= 0.0 || diffuse <= 0.0) {
+                    continue;
+                 }
+
+                 float window = clamp(1.0 - pow(light_distance / range, 4.0), 0.0, 1.0);
+                 vec3 radiance = light.color_cos_inner.rgb * cone * window * window / (light_distance * light_distance + 1.0);
+                 float specular = specular_factor * pow(max(dot(view_dir, reflect(-light_dir, normal)), 0.0), shininess);
+                 result += (diffuse + specular) * radiance * shadow_visibility(light.shadow_matrix, light.shadow_rect, position_eye);
+              }
+              return result;
+           }
+        )";
+
+    // shared by the forward fragment shader and the G-buffer pass, must match the IrradianceProbes texture layout
+    const char* irradiance_probes_shader =
+        R"(
+           layout (binding = 8) uniform sampler3D irradiance_probes;
+
+           uniform bool irradiance_probes_enabled;
+           uniform mat4 inverse_view_matrix;
+           uniform vec3 irradiance_probes_origin;
+           uniform vec3 irradiance_probes_spacing;
+           uniform vec3 irradiance_probes_grid_size;
+
+           vec3 irradiance_probes_contribution(vec3 position_eye, vec3 normal_eye) {
+              vec3 position = vec3(inverse_view_matrix * vec4(position_eye, 1.0));
+              vec3 n = normalize(mat3(inverse_view_matrix) * normal_eye);
+
+              // clamped to the outer texel centers so filtering never reaches into the next slab
+              vec3 coord = clamp((position - irradiance_probes_origin) / irradiance_probes_spacing, vec3(0.0), irradiance_probes_grid_size - 1.0) + 0.5;
+              float coefficients[28];
+              for (int texel = 0; texel < 7; ++texel) {
+                 vec3 uvw = vec3(coord.xy, coord.z + float(texel) * irradiance_probes_grid_size.z) / vec3(irradiance_probes_grid_size.xy, irradiance_probes_grid_size.z * 7.0);
+                 vec4 value = texture(irradiance_probes, uvw);
+                 coefficients[4 * texel] = value.r;
+                 coefficients[4 * texel + 1] = value.g;
+                 coefficients[4 * texel + 2] = value.b;
+                 coefficients[4 * texel + 3] = value.a;
+              }
+              vec3 sh[9];
+              for (int i = 0; i < 9; ++i) {
+                 sh[i] = vec3(coefficients[3 * i], coefficients[3 * i + 1], coefficients[3 * i + 2]);
+              }
+
+              vec3 irradiance = 0.282095 * sh[0]
+                              + 0.488603 * (sh[1] * n.y + sh[2] * n.z + sh[3] * n.x)
+                              + 1.092548 * (sh[4] * n.x * n.y + sh[5] * n.y * n.z + sh[7] * n.x * n.z)
+                              + 0.315392 * sh[6] * (3.0 * n.z * n.z - 1.0)
+                              + 0.546274 * sh[8] * (n.x * n.x - n.y * n.y);
+              return max(irradiance, vec3(0.0));
+           }
+        )";
+
+    // prefixed with the version, clustered_point_lights_shader, shadowed_lights_shader and irradiance_probes_shader at startup
     const char* fragment_shader =
-        R"(#version 460
+        R"(
            in vec2 tex_coord_smile;
            in vec2 tex_coord_quads;
+           in vec2 frag_lightmap_coord;
            in vec3 frag_position_eye;
            in vec3 frag_normal_eye;
 
            layout (binding = 0) uniform sampler2D InTexture_Smile;
            layout (binding = 1) uniform sampler2D InTexture_Quads;
+           layout (binding = 6) uniform sampler2D lightmap;
 
            uniform vec3 light_position_eye;
            uniform vec3 light_color;
+           uniform vec4 lightmap_scale_offset;
            uniform float ambient_factor;
            uniform float diffuse_factor;
            uniform float specular_factor;
@@ -193,8 +325,10 @@ namespace SimpleEngine {
 
            void main() {
 
-              // ambient
-              vec3 ambient = ambient_factor * light_color;
+              // ambient, baked indirect lighting from the lightmap or else the probe grid
+              vec3 ambient = lightmap_scale_offset.x > 0.0 ? texture(lightmap, frag_lightmap_coord).rgb
+                           : irradiance_probes_enabled ? irradiance_probes_contribution(frag_position_eye, frag_normal_eye)
+                           : ambient_factor * light_color;
 
               // diffuse
               vec3 normal = normalize(frag_normal_eye);
@@ -207,13 +341,117 @@ namespace SimpleEngine {
               float specular_value = pow(max(dot(view_dir, reflect_dir), 0.0), shininess);
               vec3 specular = specular_factor * specular_value * light_color;
 
+              vec3 point_lights = point_lights_contribution(frag_position_eye, normal, view_dir, diffuse_factor, specular_factor, shininess);
+              vec3 shadowed_lights = shadowed_lights_contribution(frag_position_eye, normal, view_dir, diffuse_factor, specular_factor, shininess);
+
               //frag_color = texture(InTexture_Smile, tex_coord_smile) * texture(InTexture_Quads, tex_coord_quads);
-              frag_color = texture(InTexture_Smile, tex_coord_smile) * vec4(ambient + diffuse + specular, 1.f);
+              frag_color = texture(InTexture_Smile, tex_coord_smile) * vec4(ambient + diffuse + specular + point_lights + shadowed_lights, 1.f);
+           }
+        )";
+
+    // prefixed with the version and irradiance_probes_shader at startup
+    const char* gbuffer_fragment_shader =
+        R"(
+           in vec2 tex_coord_smile;
+           in vec2 tex_coord_quads;
+           in vec2 frag_lightmap_coord;
+           in vec3 frag_position_eye;
+           in vec3 frag_normal_eye;
+
+           layout (binding = 0) uniform sampler2D InTexture_Smile;
+           layout (binding = 6) uniform sampler2D lightmap;
+
+           uniform vec3 light_color;
+           uniform vec4 lightmap_scale_offset;
+           uniform float ambient_factor;
+           uniform float specular_factor;
+
+           layout (location = 0) out vec4 albedo_specular;
+           layout (location = 1) out vec2 octahedral_normal;
+           layout (location = 2) out vec3 ambient_light;
+
+           // unit vector to the [-1, 1] square through an octahedron unfolded onto the z = 0 plane
+           vec2 octahedral_encode(vec3 n) {
+              n /= abs(n.x) + abs(n.y) + abs(n.z);
+              vec2 sign_not_zero = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+              return n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * sign_not_zero;
+           }
+
+           void main() {
+              albedo_specular = vec4(texture(InTexture_Smile, tex_coord_smile).rgb, specular_factor);
+              octahedral_normal = octahedral_encode(normalize(frag_normal_eye));
+              ambient_light = lightmap_scale_offset.x > 0.0 ? texture(lightmap, frag_lightmap_coord).rgb
+                            : irradiance_probes_enabled ? irradiance_probes_contribution(frag_position_eye, frag_normal_eye)
+                            : ambient_factor * light_color;
+           }
+        )";
+
+    const char* fullscreen_vertex_shader =
+        R"(#version 450
+           out vec2 screen_uv;
+
+           // a single triangle covering the screen, no vertex buffers needed
+           void main() {
+              screen_uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+              gl_Position = vec4(screen_uv * 2.0 - 1.0, 0.0, 1.0);
+           }
+        )";
+
+    // prefixed with the version, clustered_point_lights_shader and shadowed_lights_shader at startup
+    const char* deferred_lighting_fragment_shader =
+        R"(
+           in vec2 screen_uv;
+
+           layout (binding = 2) uniform sampler2D gbuffer_albedo_specular;
+           layout (binding = 3) uniform sampler2D gbuffer_normal;
+           layout (binding = 4) uniform sampler2D gbuffer_depth;
+           layout (binding = 7) uniform sampler2D gbuffer_ambient;
+
+           uniform mat4 inverse_projection_matrix;
+           uniform vec3 light_position_eye;
+           uniform vec3 light_color;
+           uniform float diffuse_factor;
+           uniform float shininess;
+
+           out vec4 frag_color;
+
+           vec3 octahedral_decode(vec2 e) {
+              vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+              float t = max(-n.z, 0.0);
+              n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+              return normalize(n);
+           }
+
+           void main() {
+              float depth = texture(gbuffer_depth, screen_uv).r;
+              if (depth == 1.0) {
+                 discard;
+              }
+              vec4 position = inverse_projection_matrix * vec4(vec3(screen_uv, depth) * 2.0 - 1.0, 1.0);
+              vec3 position_eye = position.xyz / position.w;
+
+              vec4 albedo_specular = texture(gbuffer_albedo_specular, screen_uv);
+              float specular_factor = albedo_specular.a;
+              vec3 normal = octahedral_decode(texture(gbuffer_normal, screen_uv).rg);
+
+              vec3 ambient = texture(gbuffer_ambient, screen_uv).rgb;
+
+              vec3 light_dir = normalize(light_position_eye - position_eye);
+              vec3 diffuse = diffuse_factor * light_color * max(dot(normal, light_dir), 0.0);
+
+              vec3 view_dir = normalize(-position_eye);
+              vec3 reflect_dir = reflect(-light_dir, normal);
+              vec3 specular = specular_factor * pow(max(dot(view_dir, reflect_dir), 0.0), shininess) * light_color;
+
+              vec3 point_lights = point_lights_contribution(position_eye, normal, view_dir, diffuse_factor, specular_factor, shininess);
+              vec3 shadowed_lights = shadowed_lights_contribution(position_eye, normal, view_dir, diffuse_factor, specular_factor, shininess);
+
+              frag_color = vec4(albedo_specular.rgb * (ambient + diffuse + specular + point_lights + shadowed_lights), 1.f);
            }
         )";
 
     const char* light_source_vertex_shader =
-        R"(#version 460
+        R"(#version 450
            layout(location = 0) in vec3 vertex_position;
            layout(location = 1) in vec3 vertex_normal;
            layout(location = 2) in vec2 texture_coord;
@@ -226,7 +464,7 @@ namespace SimpleEngine {
         )";
 
     const char* light_source_fragment_shader =
-        R"(#version 460
+        R"(#version 450
            out vec4 frag_color;
 
            uniform vec3 light_color;
@@ -236,13 +474,61 @@ namespace SimpleEngine {
            }
         )";
 
-    std::unique_ptr<ShaderProgram> p_shader_program;
-    std::unique_ptr<ShaderProgram> p_light_source_shader_program;
-    std::unique_ptr<VertexBuffer> p_cube_positions_vbo;
-    std::unique_ptr<IndexBuffer> p_cube_index_buffer;
-    std::unique_ptr<Texture2D> p_texture_smile;
-    std::unique_ptr<Texture2D> p_texture_quads;
-    std::unique_ptr<VertexArray> p_cube_vao;
+    // depth only, the atlas tile viewport does the rest
+    const char* shadow_vertex_shader =
+        R"(#version 450
+           layout(location = 0) in vec3 vertex_position;
+
+           uniform mat4 mvp_matrix;
+
+           void main() {
+              gl_Position = mvp_matrix * vec4(vertex_position, 1.0);
+           }
+        )";
+
+    const char* shadow_fragment_shader =
+        R"(#version 450
+           void main() {
+           }
+        )";
+
+    // std430 layout of the SpotLights buffer, positions and directions in view space
+    struct GpuSpotLight
+    {
+        glm::mat4 shadow_matrix; // view space to atlas texture coordinates and depth
+        glm::vec4 position_range;
+        glm::vec4 direction_cos_outer;
+        glm::vec4 color_cos_inner; // color premultiplied by intensity
+        glm::vec4 shadow_rect;
+    };
+
+    ShaderProgramHandle h_shader_program;
+    ShaderProgramHandle h_light_source_shader_program;
+    VertexBufferHandle h_cube_positions_vbo;
+    VertexBufferHandle h_cube_lightmap_uvs_vbo;
+    Texture2DHandle h_lightmap;
+    Texture3DHandle h_irradiance_probes_texture;
+    IndexBufferHandle h_cube_index_buffer;
+    Texture2DHandle h_texture_smile;
+    Texture2DHandle h_texture_quads;
+    VertexArrayHandle h_cube_vao;
+    ShaderStorageBufferHandle h_point_lights_ssbo;
+    ShaderStorageBufferHandle h_clusters_ssbo;
+    ShaderStorageBufferHandle h_light_indices_ssbo;
+    ShaderProgramHandle h_gbuffer_shader_program;
+    ShaderProgramHandle h_deferred_lighting_shader_program;
+    std::unique_ptr<Framebuffer> p_gbuffer;
+    VertexArrayHandle h_fullscreen_vao;
+    std::array<std::unique_ptr<GpuTimer>, 2> p_render_path_timers;
+    ShaderProgramHandle h_shadow_shader_program;
+    std::unique_ptr<ShadowAtlas> p_shadow_atlas;
+    ShaderStorageBufferHandle h_spot_lights_ssbo;
+    std::unique_ptr<GpuTimer> p_shadow_timer;
+    std::unique_ptr<GpuTimer> p_frame_timer;
+    std::unique_ptr<FramebufferReadback> p_frame_readback;
+    std::vector<Texture2DHandle> h_stress_textures;
+    std::vector<TextureStreamer::TextureId> h_streamed_textures;
+    std::vector<GpuSpotLight> spot_lights_data;
     float m_background_color[4] = { 0.33f, 0.33f, 0.33f, 0.f };
 
     std::array<glm::vec3, 5> positions = {
@@ -253,6 +539,34 @@ namespace SimpleEngine {
             glm::vec3( 1.f, -7.f,  1.f)
     };
 
+    // the cube as the lightmap baker sees it, the same for the uv vertex buffer and every bake
+    static LightmapBaker::Mesh make_cube_lightmap_mesh()
+    {
+        LightmapBaker::Mesh mesh;
+        constexpr size_t floats_per_vertex = 8;
+        for (size_t i = 0; i < sizeof(pos_norm_uv) / sizeof(GLfloat) / floats_per_vertex; ++i)
+        {
+            const GLfloat* vertex = pos_norm_uv + i * floats_per_vertex;
+            mesh.positions.emplace_back(vertex[0], vertex[1], vertex[2]);
+            mesh.normals.emplace_back(vertex[3], vertex[4], vertex[5]);
+        }
+        mesh.indices.assign(std::begin(indices), std::end(indices));
+        mesh.lightmap_uvs = LightmapBaker::generate_lightmap_uvs(mesh.positions, mesh.indices);
+        return mesh;
+    }
+
+    // only what the baked light depends on, shadow settings do not matter to the ray traced probes
+    static bool same_baked_light(const DirectionalLight& a, const DirectionalLight& b)
+    {
+        return a.direction == b.direction && a.intensity == b.intensity && a.color == b.color;
+    }
+
+    static bool same_baked_light(const SpotLight& a, const SpotLight& b)
+    {
+        return a.position == b.position && a.range == b.range && a.direction == b.direction && a.intensity == b.intensity
+            && a.color == b.color && a.inner_angle == b.inner_angle && a.outer_angle == b.outer_angle;
+    }
+
     Application::Application()
     {
         LOG_INFO("Starting Application");
@@ -264,13 +578,296 @@ namespace SimpleEngine {
         LOG_INFO("Closing Application");
     }
 
+    void Application::set_lighting_uniforms(const ShaderProgram& shader_program)
+    {
+        shader_program.set_vec3("light_position_eye", glm::vec3(camera.get_view_matrix() * glm::vec4(light_source_position[0], light_source_position[1], light_source_position[2], 1.f)));
+        shader_program.set_vec3("light_color", glm::vec3(light_source_color[0], light_source_color[1], light_source_color[2]));
+        shader_program.set_float("ambient_factor", ambient_factor);
+        shader_program.set_float("diffuse_factor", diffuse_factor);
+        shader_program.set_float("specular_factor", specular_factor);
+        shader_program.set_float("shininess", shininess);
+        shader_program.set_vec2("viewport_size", glm::vec2(camera.get_viewport_width(), camera.get_viewport_height()));
+        shader_program.set_float("cluster_z_scale", m_light_clusters.get_z_scale());
+        shader_program.set_float("cluster_z_bias", m_light_clusters.get_z_bias());
+
+        const glm::mat3 view_rotation_matrix(camera.get_view_matrix());
+        shader_program.set_vec3("directional_light_direction_eye", glm::normalize(view_rotation_matrix * directional_light.direction));
+        shader_program.set_vec3("directional_light_color", directional_light.color * directional_light.intensity);
+        shader_program.set_matrix4("directional_shadow_matrix", m_directional_shadow_matrix);
+        shader_program.set_vec4("directional_shadow_rect", m_directional_shadow_rect);
+        shader_program.set_int("spot_lights_count", static_cast<int>(spot_lights_data.size()));
+    }
+
+    size_t Application::draw_shadow_casters(const glm::mat4& light_view_projection, const bool dynamic)
+    {
+        // light MVPs of the drawn casters only, a cached tile costs the dynamic ones
+        m_shadow_world_matrices.clear();
+        for (size_t i = 0; i < m_cube_nodes.size(); ++i)
+        {
+            if ((m_dynamic_cubes[i] != 0) == dynamic)
+            {
+                m_shadow_world_matrices.push_back(transforms.get_world_matrix(m_cube_nodes[i]));
+            }
+        }
+        const size_t casters_count = m_shadow_world_matrices.size();
+        m_shadow_mvp_matrices.resize(casters_count);
+        BatchMath::mat4_mul(light_view_projection, m_shadow_world_matrices.data(), m_shadow_mvp_matrices.data(), casters_count);
+
+        const ShaderProgram& shadow_shader_program = *GpuResources::get(h_shadow_shader_program);
+        for (const glm::mat4& mvp_matrix : m_shadow_mvp_matrices)
+        {
+            shadow_shader_program.set_matrix4("mvp_matrix", mvp_matrix);
+            Renderer_OpenGL::draw(h_cube_vao);
+        }
+        return casters_count;
+    }
+
+    uint64_t Application::get_static_geometry_version() const
+    {
+        uint64_t static_geometry_version = m_removed_static_geometry_version;
+        for (size_t i = 0; i < m_cube_nodes.size(); ++i)
+        {
+            if (m_dynamic_cubes[i] == 0)
+            {
+                static_geometry_version = std::max(static_geometry_version, transforms.get_world_version(m_cube_nodes[i]));
+            }
+        }
+        return static_geometry_version;
+    }
+
+    void Application::update_shadows()
+    {
+        PROFILE_SCOPE("Application::update_shadows");
+        PROFILE_GPU_SCOPE("Shadow maps");
+        const auto start_time = std::chrono::steady_clock::now();
+        m_shadow_maps.begin_frame();
+
+        // shadow 0 is the directional light, shadow i + 1 is spot light i
+        m_shadow_resolutions.clear();
+        m_shadow_resolutions.push_back(directional_light.cast_shadows ? directional_light.shadow_resolution : 0);
+        for (const SpotLight& light : spot_lights)
+        {
+            m_shadow_resolutions.push_back(light.cast_shadows ? light.shadow_resolution : 0);
+        }
+        m_shadow_maps.allocate(m_shadow_resolutions);
+        p_shadow_atlas->resize(m_shadow_maps.get_atlas_size());
+
+        // cached maps are stale once any static caster moved after they were drawn
+        const uint64_t static_geometry_version = get_static_geometry_version();
+
+        glm::mat4 inverse_view_matrix;
+        BatchMath::affine_inverse(&camera.get_view_matrix(), &inverse_view_matrix, 1);
+        const glm::mat3 view_rotation_matrix(camera.get_view_matrix());
+        spot_lights_data.resize(spot_lights.size());
+
+        p_shadow_timer->begin();
+        GpuResources::get(h_shadow_shader_program)->bind();
+        for (size_t shadow_index = 0; shadow_index < m_shadow_resolutions.size(); ++shadow_index)
+        {
+            const ShadowMaps::Tile& tile = m_shadow_maps.get_tile(shadow_index);
+            const glm::mat4 light_view_projection = shadow_index == 0
+                ? ShadowMaps::get_view_projection(directional_light)
+                : ShadowMaps::get_view_projection(spot_lights[shadow_index - 1]);
+            const glm::mat4 shadow_matrix = m_shadow_maps.get_atlas_matrix(shadow_index) * light_view_projection * inverse_view_matrix;
+            const glm::vec4 shadow_rect = m_shadow_maps.get_atlas_rect(shadow_index);
+
+            if (shadow_index == 0)
+            {
+                m_directional_shadow_matrix = shadow_matrix;
+                m_directional_shadow_rect = shadow_rect;
+            }
+            else
+            {
+                const SpotLight& light = spot_lights[shadow_index - 1];
+                GpuSpotLight& light_data = spot_lights_data[shadow_index - 1];
+                light_data.shadow_matrix = shadow_matrix;
+                light_data.position_range = glm::vec4(glm::vec3(camera.get_view_matrix() * glm::vec4(light.position, 1.f)), light.range);
+                light_data.direction_cos_outer = glm::vec4(glm::normalize(view_rotation_matrix * light.direction), std::cos(glm::radians(light.outer_angle)));
+                light_data.color_cos_inner = glm::vec4(light.color * light.intensity, std::cos(glm::radians(light.inner_angle)));
+                light_data.shadow_rect = shadow_rect;
+            }
+
+            if (tile.size == 0)
+            {
+                continue;
+            }
+
+            size_t static_casters_count = 0;
+            if (m_shadow_maps.needs_static_redraw(shadow_index, light_view_projection, static_geometry_version))
+            {
+                p_shadow_atlas->begin_cache_tile(tile.x, tile.y, tile.size);
+                static_casters_count = draw_shadow_casters(light_view_projection, false);
+            }
+            p_shadow_atlas->copy_cache_to_live(tile.x, tile.y, tile.size);
+            p_shadow_atlas->begin_live_tile(tile.x, tile.y, tile.size);
+            m_shadow_maps.record_casters_drawn(static_casters_count, draw_shadow_casters(light_view_projection, true));
+        }
+        p_shadow_atlas->end();
+        p_shadow_timer->end();
+
+        Renderer_OpenGL::set_viewport(static_cast<unsigned int>(camera.get_viewport_width()), static_cast<unsigned int>(camera.get_viewport_height()));
+        ShaderStorageBuffer& spot_lights_ssbo = *GpuResources::get(h_spot_lights_ssbo);
+        spot_lights_ssbo.set_data(spot_lights_data.data(), spot_lights_data.size() * sizeof(GpuSpotLight));
+        spot_lights_ssbo.bind(3);
+        p_shadow_atlas->bind_live(5);
+
+        const std::chrono::duration<double, std::milli> cpu_time = std::chrono::steady_clock::now() - start_time;
+        m_shadow_maps.record_times(cpu_time.count(), p_shadow_timer->get_last_time_ms());
+    }
+
+    void Application::update_irradiance_probes()
+    {
+        PROFILE_SCOPE("Application::update_irradiance_probes");
+        // any static geometry or baked light change makes every probe stale
+        const uint64_t static_geometry_version = get_static_geometry_version();
+        const bool same_spot_lights = std::equal(spot_lights.begin(), spot_lights.end(), m_irradiance_probes_spot_lights.begin(), m_irradiance_probes_spot_lights.end(),
+                                                 [](const SpotLight& a, const SpotLight& b) { return same_baked_light(a, b); });
+        if (!m_irradiance_probes_scene_set
+            || static_geometry_version != m_irradiance_probes_geometry_version
+            || !same_baked_light(directional_light, m_irradiance_probes_directional_light)
+            || !same_spot_lights)
+        {
+            constexpr size_t floats_per_vertex = 8;
+            std::vector<glm::vec3> vertices;
+            for (size_t i = 0; i < m_cube_nodes.size(); ++i)
+            {
+                if (m_dynamic_cubes[i] != 0)
+                {
+                    continue;
+                }
+                const glm::mat4& world_matrix = transforms.get_world_matrix(m_cube_nodes[i]);
+                for (const GLuint index : indices)
+                {
+                    const GLfloat* vertex = pos_norm_uv + index * floats_per_vertex;
+                    vertices.push_back(glm::vec3(world_matrix * glm::vec4(vertex[0], vertex[1], vertex[2], 1.f)));
+                }
+            }
+            m_irradiance_probes.set_scene(vertices, directional_light, spot_lights);
+            m_irradiance_probes_scene_set = true;
+            m_irradiance_probes_geometry_version = static_geometry_version;
+            m_irradiance_probes_directional_light = directional_light;
+            m_irradiance_probes_spot_lights = spot_lights;
+        }
+
+        m_irradiance_probes.update(camera.get_position(), irradiance_probes_budget_ms);
+        if (!h_irradiance_probes_texture)
+        {
+            const glm::ivec3 texture_size = m_irradiance_probes.get_texture_size();
+            h_irradiance_probes_texture = GpuResources::create<Texture3D>(texture_size.x, texture_size.y, texture_size.z);
+        }
+        if (m_irradiance_probes.has_changes())
+        {
+            GpuResources::get(h_irradiance_probes_texture)->set_data(&m_irradiance_probes.get_texture_data()[0].x);
+            m_irradiance_probes.clear_changes();
+        }
+        GpuResources::get(h_irradiance_probes_texture)->bind(8);
+    }
+
+    void Application::set_irradiance_probes_uniforms(const ShaderProgram& shader_program)
+    {
+        const IrradianceProbes::Settings& settings = m_irradiance_probes.get_settings();
+        glm::mat4 inverse_view_matrix;
+        BatchMath::affine_inverse(&camera.get_view_matrix(), &inverse_view_matrix, 1);
+        shader_program.set_int("irradiance_probes_enabled", irradiance_probes_enabled ? 1 : 0);
+        shader_program.set_matrix4("inverse_view_matrix", inverse_view_matrix);
+        shader_program.set_vec3("irradiance_probes_origin", settings.origin);
+        shader_program.set_vec3("irradiance_probes_spacing", settings.spacing);
+        shader_program.set_vec3("irradiance_probes_grid_size", glm::vec3(settings.grid_size));
+    }
+
+    void Application::draw_cubes(const ShaderProgram& shader_program)
+    {
+        // the view matrix is a rigid transform, so its rotation part is its own inverse transpose
+        const glm::mat3 view_rotation_matrix(camera.get_view_matrix());
+        for (size_t i = 0; i < m_cube_nodes.size(); ++i)
+        {
+            const TransformHierarchy::NodeId cube_node = m_cube_nodes[i];
+            const uint32_t index = transforms.get_index(cube_node);
+            shader_program.set_matrix4("model_view_matrix", m_model_view_matrices[index]);
+            shader_program.set_matrix4("mvp_matrix", m_mvp_matrices[index]);
+            shader_program.set_matrix3("normal_matrix", view_rotation_matrix * transforms.get_normal_matrix(cube_node));
+            shader_program.set_vec4("lightmap_scale_offset", m_lightmap_scale_offsets[i]);
+            if (!h_streamed_textures.empty())
+            {
+                // the cube spans 2 units and each face maps the whole texture
+                const TextureStreamer::TextureId texture = h_streamed_textures[i % h_streamed_textures.size()];
+                const glm::vec3 position(transforms.get_world_matrices()[index][3]);
+                TextureStreamer::request(texture, position - glm::vec3(1.f), position + glm::vec3(1.f));
+                if (!TextureStreamer::bind(texture, 0))
+                {
+                    GpuResources::get(h_texture_smile)->bind(0);
+                }
+            }
+            else if (!h_stress_textures.empty())
+            {
+                GpuResources::get(h_stress_textures[i % h_stress_textures.size()])->bind(0);
+            }
+            Renderer_OpenGL::draw(h_cube_vao);
+        }
+        if (!h_stress_textures.empty() || !h_streamed_textures.empty())
+        {
+            GpuResources::get(h_texture_smile)->bind(0);
+        }
+    }
+
+    float Application::get_animation_time() const
+    {
+        // harness runs advance a fixed 60 Hz step per frame, so every run draws the same frames
+        if (m_pFrameTimeHarness)
+        {
+            return m_frame_index / 60.f;
+        }
+        return std::chrono::duration<float>(std::chrono::steady_clock::now() - m_start_time).count();
+    }
+
     void Application::draw()
     {
+        PROFILE_FRAME();
+        PROFILE_GPU_FRAME();
+        PROFILE_SCOPE("Application::draw");
+        const auto frame_start_time = std::chrono::steady_clock::now();
+        MemoryTracker::new_frame();
+        FrameMemory::new_frame();
+        GpuMemory::new_frame();
+        GpuResources::collect();
+        MemoryTagScope memory_tag_scope(EMemoryTag::Rendering);
+        // everything the window posted since the last frame, coalesced
+        {
+            MemoryTagScope events_tag_scope(EMemoryTag::Events);
+            m_event_bus.dispatch_queued();
+        }
+        if (m_pFrameTimeHarness)
+        {
+            const uint32_t warmup_frames = m_pFrameTimeHarness->get_settings().warmup_frames;
+            const uint32_t recorded_frame = m_frame_index < warmup_frames ? 0 : static_cast<uint32_t>(m_frame_index - warmup_frames);
+            if (m_pHarnessInputRecording && m_frame_index == warmup_frames)
+            {
+                Input::StartReplay(std::move(*m_pHarnessInputRecording));
+                m_pHarnessInputRecording = nullptr;
+            }
+            // a replayed input recording drives the camera from where the path starts
+            if (!Input::IsReplaying())
+            {
+                const FrameTimeHarness::CameraKeyframe keyframe = m_pFrameTimeHarness->get_camera(recorded_frame);
+                camera.set_position_rotation(keyframe.position, keyframe.rotation);
+            }
+            // the first frame bakes every probe, later frames have nothing stale left
+            irradiance_probes_budget_ms = m_frame_index == 0 ? std::numeric_limits<float>::infinity() : 0.f;
+        }
+        {
+            MemoryTagScope input_tag_scope(EMemoryTag::Input);
+            Input::NewFrame(get_animation_time());
+        }
+        p_frame_timer->begin();
+
+        if (compare_render_paths)
+        {
+            render_path = render_path == ERenderPath::Forward ? ERenderPath::Deferred : ERenderPath::Forward;
+        }
+
         Renderer_OpenGL::set_clear_color(m_background_color[0], m_background_color[1], m_background_color[2], m_background_color[3]);
         Renderer_OpenGL::clear();
 
-        p_shader_program->bind();
-
         //glm::mat4 scale_matrix(scale[0], 0, 0, 0,
         //    0, scale[1], 0, 0,
         //    0, 0, scale[2], 0,
@@ -288,96 +885,273 @@ namespace SimpleEngine {
         //    translate[0], translate[1], translate[2], 1);
 
         //glm::mat4 model_matrix = translate_matrix * rotate_matrix * scale_matrix;
-        //p_shader_program->set_matrix4("model_matrix", model_matrix);
+        //shader_program.set_matrix4("model_matrix", model_matrix);
 
-
-        static int current_frame = 0;
-        p_shader_program->set_int("current_frame", current_frame++);
-        p_shader_program->set_vec3("light_position_eye", glm::vec3(camera.get_view_matrix() * glm::vec4(light_source_position[0], light_source_position[1], light_source_position[2], 1.f)));
-        p_shader_program->set_vec3("light_color", glm::vec3(light_source_color[0], light_source_color[1], light_source_color[2]));
-        p_shader_program->set_float("ambient_factor", ambient_factor);
-        p_shader_program->set_float("diffuse_factor", diffuse_factor);
-        p_shader_program->set_float("specular_factor", specular_factor);
-        p_shader_program->set_float("shininess", shininess);
+        // point lights
+        if (animate_point_lights)
+        {
+            animate_benchmark_lights();
+        }
+        {
+            PROFILE_SCOPE("LightClusters::build");
+            MemoryTagScope lighting_tag_scope(EMemoryTag::Lighting);
+            m_light_clusters.build(point_lights, camera);
+        }
+        const std::vector<LightClusters::GpuPointLight>& gpu_lights = m_light_clusters.get_gpu_lights();
+        const std::vector<LightClusters::GpuCluster>& clusters = m_light_clusters.get_clusters();
+        const std::vector<uint32_t>& light_indices = m_light_clusters.get_light_indices();
+        ShaderStorageBuffer& point_lights_ssbo = *GpuResources::get(h_point_lights_ssbo);
+        ShaderStorageBuffer& clusters_ssbo = *GpuResources::get(h_clusters_ssbo);
+        ShaderStorageBuffer& light_indices_ssbo = *GpuResources::get(h_light_indices_ssbo);
+        point_lights_ssbo.set_data(gpu_lights.data(), gpu_lights.size() * sizeof(LightClusters::GpuPointLight));
+        clusters_ssbo.set_data(clusters.data(), clusters.size() * sizeof(LightClusters::GpuCluster));
+        light_indices_ssbo.set_data(light_indices.data(), light_indices.size() * sizeof(uint32_t));
+        point_lights_ssbo.bind(0);
+        clusters_ssbo.bind(1);
+        light_indices_ssbo.bind(2);
 
         // cubes
-        for (const glm::vec3& current_position : positions)
+        if (animate_dynamic_casters)
         {
-            glm::mat4 translate_matrix(1, 0, 0, 0,
-                0, 1, 0, 0,
-                0, 0, 1, 0,
-                current_position[0], current_position[1], current_position[2], 1);
-            const glm::mat4 model_view_matrix = camera.get_view_matrix()* translate_matrix;
-            p_shader_program->set_matrix4("model_view_matrix", model_view_matrix);
-            p_shader_program->set_matrix4("mvp_matrix", camera.get_projection_matrix() * model_view_matrix);
-            p_shader_program->set_matrix3("normal_matrix", glm::transpose(glm::inverse(glm::mat3(model_view_matrix))));
-            Renderer_OpenGL::draw(*p_cube_vao);
+            const glm::quat rotation = glm::angleAxis(get_animation_time(), glm::vec3(0.f, 0.f, 1.f));
+            for (size_t i = 0; i < m_cube_nodes.size(); ++i)
+            {
+                if (m_dynamic_cubes[i] != 0)
+                {
+                    transforms.set_local_rotation(m_cube_nodes[i], rotation);
+                }
+            }
         }
+        // cubes of the cells around the camera come and go before the transforms are updated
+        WorldPartition::update(camera.get_position(), get_animation_time());
+        transforms.update();
+        const size_t nodes_count = transforms.get_nodes_count();
+        m_model_view_matrices.resize(nodes_count);
+        m_mvp_matrices.resize(nodes_count);
+        BatchMath::mat4_mul(camera.get_view_matrix(), transforms.get_world_matrices(), m_model_view_matrices.data(), nodes_count);
+        BatchMath::mat4_mul(camera.get_projection_matrix(), m_model_view_matrices.data(), m_mvp_matrices.data(), nodes_count);
+        TextureStreamer::begin_frame(camera);
+
+        {
+            MemoryTagScope lighting_tag_scope(EMemoryTag::Lighting);
+            update_shadows();
+            if (irradiance_probes_enabled)
+            {
+                update_irradiance_probes();
+            }
+        }
+
+        static int current_frame = 0;
+        GpuTimer& render_path_timer = *p_render_path_timers[static_cast<size_t>(render_path)];
+        render_path_timer.begin();
+        if (h_lightmap)
+        {
+            GpuResources::get(h_lightmap)->bind(6);
+        }
+        if (render_path == ERenderPath::Forward)
+        {
+            PROFILE_SCOPE("Forward pass");
+            PROFILE_GPU_SCOPE("Forward pass");
+            const ShaderProgram& shader_program = *GpuResources::get(h_shader_program);
+            shader_program.bind();
+            shader_program.set_int("current_frame", current_frame++);
+            set_lighting_uniforms(shader_program);
+            set_irradiance_probes_uniforms(shader_program);
+            draw_cubes(shader_program);
+        }
+        else
+        {
+            PROFILE_SCOPE("Deferred pass");
+            PROFILE_GPU_SCOPE("Deferred pass");
+
+            // geometry pass: albedo, specular and normals only
+            p_gbuffer->bind();
+            Renderer_OpenGL::set_clear_color(0.f, 0.f, 0.f, 0.f);
+            Renderer_OpenGL::clear();
+            const ShaderProgram& gbuffer_shader_program = *GpuResources::get(h_gbuffer_shader_program);
+            gbuffer_shader_program.bind();
+            gbuffer_shader_program.set_float("specular_factor", specular_factor);
+            gbuffer_shader_program.set_float("ambient_factor", ambient_factor);
+            gbuffer_shader_program.set_vec3("light_color", glm::vec3(light_source_color[0], light_source_color[1], light_source_color[2]));
+            set_irradiance_probes_uniforms(gbuffer_shader_program);
+            draw_cubes(gbuffer_shader_program);
+            Framebuffer::unbind();
+
+            // lighting pass: one fullscreen triangle shading every covered pixel once
+            Renderer_OpenGL::disable_depth_test();
+            const ShaderProgram& lighting_shader_program = *GpuResources::get(h_deferred_lighting_shader_program);
+            lighting_shader_program.bind();
+            set_lighting_uniforms(lighting_shader_program);
+            lighting_shader_program.set_matrix4("inverse_projection_matrix", glm::inverse(camera.get_projection_matrix()));
+            p_gbuffer->bind_color_attachment(0, 2);
+            p_gbuffer->bind_color_attachment(1, 3);
+            p_gbuffer->bind_depth_attachment(4);
+            p_gbuffer->bind_color_attachment(2, 7);
+            Renderer_OpenGL::draw_arrays(h_fullscreen_vao, 3);
+            Renderer_OpenGL::enable_depth_test();
+
+            // forward-rendered objects below are depth tested against the scene
+            p_gbuffer->blit_depth_to_default();
+        }
+        render_path_timer.end();
+
+        const double last_time_ms = render_path_timer.get_last_time_ms();
+        double& render_path_time_ms = m_render_path_times_ms[static_cast<size_t>(render_path)];
+        render_path_time_ms = render_path_time_ms == 0.0 ? last_time_ms : render_path_time_ms * 0.95 + last_time_ms * 0.05;
 
         // light source
         {
-            p_light_source_shader_program->bind();
+            const ShaderProgram& light_source_shader_program = *GpuResources::get(h_light_source_shader_program);
+            light_source_shader_program.bind();
             glm::mat4 translate_matrix(1, 0, 0, 0,
                 0, 1, 0, 0,
                 0, 0, 1, 0,
                 light_source_position[0], light_source_position[1], light_source_position[2], 1);
-            p_light_source_shader_program->set_matrix4("mvp_matrix", camera.get_projection_matrix() * camera.get_view_matrix() * translate_matrix);
-            p_light_source_shader_program->set_vec3("light_color", glm::vec3(light_source_color[0], light_source_color[1], light_source_color[2]));
-            Renderer_OpenGL::draw(*p_cube_vao);
+            light_source_shader_program.set_matrix4("mvp_matrix", camera.get_projection_matrix() * camera.get_view_matrix() * translate_matrix);
+            light_source_shader_program.set_vec3("light_color", glm::vec3(light_source_color[0], light_source_color[1], light_source_color[2]));
+            Renderer_OpenGL::draw(h_cube_vao);
         }
+        // every draw has asked for its mips by now
+        TextureStreamer::update();
 
-        UIModule::on_ui_draw_begin();
-        on_ui_draw();
-        UIModule::on_ui_draw_end();
+        {
+            MemoryTagScope ui_tag_scope(EMemoryTag::UI);
+            UIModule::on_ui_draw_begin();
+            on_ui_draw();
+            if (show_profiler)
+            {
+                ProfilerWindow::draw(&show_profiler);
+            }
+            if (show_memory)
+            {
+                MemoryWindow::draw(&show_memory);
+            }
+            if (show_gpu_memory)
+            {
+                GpuMemoryWindow::draw(&show_gpu_memory);
+            }
+            UIModule::on_ui_draw_end();
+        }
+        p_frame_timer->end();
 
+        read_back_frame();
+        GpuResources::end_frame();
         m_pWindow->on_update();
         on_update();
+
+        if (m_pFrameTimeHarness && m_frame_index >= m_pFrameTimeHarness->get_settings().warmup_frames)
+        {
+            // the GPU time is the latest finished frame, one frame behind in headless mode
+            const std::chrono::duration<double, std::milli> cpu_time = std::chrono::steady_clock::now() - frame_start_time;
+            // the profiler's own bookkeeping isn't part of the frame
+            uint64_t heap_allocations_count = 0;
+            for (size_t i = 0; i < static_cast<size_t>(EMemoryTag::Count); ++i)
+            {
+                if (static_cast<EMemoryTag>(i) != EMemoryTag::Profiler)
+                {
+                    heap_allocations_count += MemoryTracker::get_current_frame_allocations_count(static_cast<EMemoryTag>(i));
+                }
+            }
+            if (heap_allocations_count > 0 && m_pFrameTimeHarness->get_settings().assert_no_heap_allocations && m_reported_allocating_frames_count < 8)
+            {
+                ++m_reported_allocating_frames_count;
+                for (size_t i = 0; i < static_cast<size_t>(EMemoryTag::Count); ++i)
+                {
+                    const uint64_t tag_allocations_count = MemoryTracker::get_current_frame_allocations_count(static_cast<EMemoryTag>(i));
+                    if (tag_allocations_count > 0 && static_cast<EMemoryTag>(i) != EMemoryTag::Profiler)
+                    {
+                        LOG_WARN("Frame {0}: {1} heap allocations tagged {2}", m_frame_index, tag_allocations_count, get_memory_tag_name(static_cast<EMemoryTag>(i)));
+                    }
+                }
+            }
+            m_pFrameTimeHarness->record_frame(cpu_time.count(), p_frame_timer->get_last_time_ms(), heap_allocations_count);
+            if (m_pFrameTimeHarness->is_finished())
+            {
+                close();
+            }
+        }
+        ++m_frame_index;
     }
 
-    int Application::start(unsigned int window_width, unsigned int window_height, const char* title)
+    int Application::start(unsigned int window_width, unsigned int window_height, const char* title, const EWindowMode window_mode)
     {
-        m_pWindow = std::make_unique<Window>(title, window_width, window_height);
+        m_pWindow = std::make_unique<Window>(title, window_width, window_height, window_mode == EWindowMode::Headless);
+        if (!m_pWindow->is_initialized())
+        {
+            m_pWindow = nullptr;
+            return -1;
+        }
+        m_start_time = std::chrono::steady_clock::now();
+        JobSystem::init();
+        GpuProfiler::init();
+        PROFILE_THREAD_NAME("Main thread");
+        VirtualFileSystem::init();
+        VirtualFileSystem::mount_directory("", ".");
+        if (!asset_manifest_path.empty() && std::filesystem::exists(asset_manifest_path))
+        {
+            m_pAssetManifest = std::make_unique<AssetManifest>();
+            if (!m_pAssetManifest->load(asset_manifest_path))
+            {
+                m_pAssetManifest = nullptr;
+            }
+            else
+            {
+                // cooked assets shadow the loose files they were cooked from
+                VirtualFileSystem::mount_archive("", m_pAssetManifest->get_archive_path());
+            }
+        }
+        TextureStreamer::init();
         camera.set_viewport_size(static_cast<float>(window_width), static_cast<float>(window_height));
 
-        m_event_dispatcher.add_event_listener<EventMouseMoved>(
-            [](EventMouseMoved& event)
+        // the engine's listeners run at the default priority, a derived application can subscribe above them to consume input first
+        m_event_bus.subscribe<EventMouseMoved>(
+            [](void* pContext, const EventMouseMoved& event)
             {
-                //LOG_INFO("[MouseMoved] Mouse moved to {0}x{1}", event.x, event.y);
-            });
+                Input::MoveMouse(event.x, event.y);
+                return false;
+            }, nullptr);
 
-        m_event_dispatcher.add_event_listener<EventWindowResize>(
-            [&](EventWindowResize& event)
+        m_event_bus.subscribe<EventWindowResize>(
+            [](void* pContext, const EventWindowResize& event)
             {
+                Application& application = *static_cast<Application*>(pContext);
                 LOG_INFO("[Resized] Changed size to {0}x{1}", event.width, event.height);
-                camera.set_viewport_size(static_cast<float>(event.width), static_cast<float>(event.height));
-                draw();
-            });
+                application.camera.set_viewport_size(static_cast<float>(event.width), static_cast<float>(event.height));
+                if (p_gbuffer && event.width > 0 && event.height > 0)
+                {
+                    p_gbuffer->resize(event.width, event.height);
+                }
+                return false;
+            }, this);
 
-        m_event_dispatcher.add_event_listener<EventWindowClose>(
-            [&](EventWindowClose& event)
+        m_event_bus.subscribe<EventWindowClose>(
+            [](void* pContext, const EventWindowClose& event)
             {
                 LOG_INFO("[WindowClose]");
-                close();
-            });
+                static_cast<Application*>(pContext)->close();
+                return false;
+            }, this);
 
-        m_event_dispatcher.add_event_listener<EventMouseButtonPressed>(
-            [&](EventMouseButtonPressed& event)
+        m_event_bus.subscribe<EventMouseButtonPressed>(
+            [](void* pContext, const EventMouseButtonPressed& event)
             {
                 LOG_INFO("[Mouse button pressed: {0}, at ({1}, {2})", static_cast<int>(event.mouse_button), event.x_pos, event.y_pos);
                 Input::PressMouseButton(event.mouse_button);
-                on_mouse_button_event(event.mouse_button, event.x_pos, event.y_pos, true);
-            });
+                static_cast<Application*>(pContext)->on_mouse_button_event(event.mouse_button, event.x_pos, event.y_pos, true);
+                return false;
+            }, this);
 
-        m_event_dispatcher.add_event_listener<EventMouseButtonReleased>(
-            [&](EventMouseButtonReleased& event)
+        m_event_bus.subscribe<EventMouseButtonReleased>(
+            [](void* pContext, const EventMouseButtonReleased& event)
             {
                 LOG_INFO("[Mouse button released: {0}, at ({1}, {2})", static_cast<int>(event.mouse_button), event.x_pos, event.y_pos);
                 Input::ReleaseMouseButton(event.mouse_button);
-                on_mouse_button_event(event.mouse_button, event.x_pos, event.y_pos, false);
-            });
+                static_cast<Application*>(pContext)->on_mouse_button_event(event.mouse_button, event.x_pos, event.y_pos, false);
+                return false;
+            }, this);
 
-        m_event_dispatcher.add_event_listener<EventKeyPressed>(
-            [&](EventKeyPressed& event)
+        m_event_bus.subscribe<EventKeyPressed>(
+            [](void* pContext, const EventKeyPressed& event)
             {
                 if (event.key_code <= KeyCode::KEY_Z)
                 {
@@ -391,24 +1165,21 @@ namespace SimpleEngine {
                     }
                 }
                 Input::PressKey(event.key_code);
-            });
+                return false;
+            }, this);
 
-        m_event_dispatcher.add_event_listener<EventKeyReleased>(
-            [&](EventKeyReleased& event)
+        m_event_bus.subscribe<EventKeyReleased>(
+            [](void* pContext, const EventKeyReleased& event)
             {
                 if (event.key_code <= KeyCode::KEY_Z)
                 {
                     LOG_INFO("[Key released: {0}", static_cast<char>(event.key_code));
                 }
                 Input::ReleaseKey(event.key_code);
-            });
+                return false;
+            }, this);
 
-        m_pWindow->set_event_callback(
-            [&](BaseEvent& event)
-            {
-                m_event_dispatcher.dispatch(event);
-            }
-        );
+        m_pWindow->set_event_bus(&m_event_bus);
         
         const unsigned int width = 1000;
         const unsigned int height = 1000;
@@ -416,20 +1187,59 @@ namespace SimpleEngine {
         auto* data = new unsigned char[width * height * channels];
 
         generate_smile_texture(data, width, height);
-        p_texture_smile = std::make_unique<Texture2D>(data, width, height);
-        p_texture_smile->bind(0);
+        h_texture_smile = GpuResources::create<Texture2D>(data, width, height);
+        GpuResources::get(h_texture_smile)->bind(0);
 
         generate_quads_texture(data, width, height);
-        p_texture_quads = std::make_unique<Texture2D>(data, width, height);
-        p_texture_quads->bind(1);
+        h_texture_quads = GpuResources::create<Texture2D>(data, width, height);
+        GpuResources::get(h_texture_quads)->bind(1);
 
         delete[] data;
 
+        // distinct textures so the stress scene switches textures between draws
+        constexpr unsigned int stress_texture_size = 256;
+        std::vector<unsigned char> stress_texture_data(stress_texture_size * stress_texture_size * channels);
+        std::mt19937 texture_random_engine(7);
+        std::uniform_int_distribution<int> texture_channel(0, 255);
+        for (Texture2DHandle& texture : h_stress_textures)
+        {
+            GpuResources::destroy(texture);
+        }
+        h_stress_textures.clear();
+        // cooked textures take the procedural ones' place, their larger mips streamed in as the camera gets close
+        for (TextureStreamer::TextureId& texture : h_streamed_textures)
+        {
+            TextureStreamer::remove_texture(texture);
+        }
+        h_streamed_textures.clear();
+        if (m_pAssetManifest)
+        {
+            for (const AssetManifest::Asset& asset : m_pAssetManifest->get_assets())
+            {
+                if (asset.type == AssetArchiveFormat::EAssetType::Texture && h_streamed_textures.size() < m_stress_textures_count)
+                {
+                    h_streamed_textures.push_back(TextureStreamer::add_texture(asset.path));
+                }
+            }
+        }
+        for (size_t i = 0; i < m_stress_textures_count && h_streamed_textures.empty(); ++i)
+        {
+            const unsigned char r = static_cast<unsigned char>(texture_channel(texture_random_engine));
+            const unsigned char g = static_cast<unsigned char>(texture_channel(texture_random_engine));
+            const unsigned char b = static_cast<unsigned char>(texture_channel(texture_random_engine));
+            generate_quads_texture(stress_texture_data.data(), stress_texture_size, stress_texture_size);
+            generate_circle(stress_texture_data.data(), stress_texture_size, stress_texture_size,
+                            stress_texture_size / 2, stress_texture_size / 2, stress_texture_size / 3, r, g, b);
+            h_stress_textures.push_back(GpuResources::create<Texture2D>(stress_texture_data.data(), stress_texture_size, stress_texture_size));
+        }
+
         //---------------------------------------//
-        p_shader_program = std::make_unique<ShaderProgram>(vertex_shader, fragment_shader);
-        if (!p_shader_program->is_compiled())
+        const std::string forward_fragment_shader = std::string("#version 450\n") + clustered_point_lights_shader + shadowed_lights_shader + irradiance_probes_shader + fragment_shader;
+        h_shader_program = GpuResources::create<ShaderProgram>(vertex_shader, forward_fragment_shader.c_str());
+        if (!GpuResources::get(h_shader_program)->is_compiled())
         {
-            return false;
+            shutdown_systems();
+            return -1;
         }
 
         BufferLayout buffer_layout_1vec3
@@ -445,18 +1255,81 @@ namespace SimpleEngine {
             ShaderDataType::Float2
         };
 
-        p_cube_vao = std::make_unique<VertexArray>();
-        p_cube_positions_vbo = std::make_unique<VertexBuffer>(pos_norm_uv, sizeof(pos_norm_uv), buffer_layout_vec3_vec3_vec2);
-        p_cube_index_buffer = std::make_unique<IndexBuffer>(indices, sizeof(indices) / sizeof(GLuint));
+        h_cube_vao = GpuResources::create<VertexArray>();
+        h_cube_positions_vbo = GpuResources::create<VertexBuffer>(pos_norm_uv, sizeof(pos_norm_uv), buffer_layout_vec3_vec3_vec2);
+        h_cube_index_buffer = GpuResources::create<IndexBuffer>(indices, sizeof(indices) / sizeof(GLuint));
+
+        GpuResources::get(h_cube_vao)->add_vertex_buffer(*GpuResources::get(h_cube_positions_vbo));
 
-        p_cube_vao->add_vertex_buffer(*p_cube_positions_vbo);
-        p_cube_vao->set_index_buffer(*p_cube_index_buffer);
+        // second uv channel for lightmaps, attribute location 3
+        const std::vector<glm::vec2> cube_lightmap_uvs = make_cube_lightmap_mesh().lightmap_uvs;
+        BufferLayout buffer_layout_vec2
+        {
+            ShaderDataType::Float2
+        };
+        h_cube_lightmap_uvs_vbo = GpuResources::create<VertexBuffer>(cube_lightmap_uvs.data(), cube_lightmap_uvs.size() * sizeof(glm::vec2), buffer_layout_vec2);
+        GpuResources::get(h_cube_vao)->add_vertex_buffer(*GpuResources::get(h_cube_lightmap_uvs_vbo));
+        GpuResources::get(h_cube_vao)->set_index_buffer(*GpuResources::get(h_cube_index_buffer));
         //---------------------------------------//
 
-        p_light_source_shader_program = std::make_unique<ShaderProgram>(light_source_vertex_shader, light_source_fragment_shader);
-        if (!p_light_source_shader_program->is_compiled())
+        h_light_source_shader_program = GpuResources::create<ShaderProgram>(light_source_vertex_shader, light_source_fragment_shader);
+        if (!GpuResources::get(h_light_source_shader_program)->is_compiled())
         {
-            return false;
+            shutdown_systems();
+            return -1;
+        }
+
+        const std::string gbuffer_shader = std::string("#version 450\n") + irradiance_probes_shader + gbuffer_fragment_shader;
+        h_gbuffer_shader_program = GpuResources::create<ShaderProgram>(vertex_shader, gbuffer_shader.c_str());
+        const std::string lighting_fragment_shader = std::string("#version 450\n") + clustered_point_lights_shader + shadowed_lights_shader + deferred_lighting_fragment_shader;
+        h_deferred_lighting_shader_program = GpuResources::create<ShaderProgram>(fullscreen_vertex_shader, lighting_fragment_shader.c_str());
+        if (!GpuResources::get(h_gbuffer_shader_program)->is_compiled() || !GpuResources::get(h_deferred_lighting_shader_program)->is_compiled())
+        {
+            shutdown_systems();
+            return -1;
+        }
+
+        // 16 bytes per pixel: albedo + specular, octahedral normal, ambient or baked light, depth
+        p_gbuffer = std::make_unique<Framebuffer>(window_width, window_height,
+                                                  std::initializer_list<Framebuffer::EFormat>{ Framebuffer::EFormat::RGBA8, Framebuffer::EFormat::RG16_SNORM, Framebuffer::EFormat::R11F_G11F_B10F },
+                                                  Framebuffer::EFormat::Depth24Stencil8);
+        h_fullscreen_vao = GpuResources::create<VertexArray>();
+        for (std::unique_ptr<GpuTimer>& p_timer : p_render_path_timers)
+        {
+            p_timer = std::make_unique<GpuTimer>();
+        }
+
+        h_point_lights_ssbo = GpuResources::create<ShaderStorageBuffer>();
+        h_clusters_ssbo = GpuResources::create<ShaderStorageBuffer>(LightClusters::clusters_count * sizeof(LightClusters::GpuCluster));
+        h_light_indices_ssbo = GpuResources::create<ShaderStorageBuffer>();
+
+        h_shadow_shader_program = GpuResources::create<ShaderProgram>(shadow_vertex_shader, shadow_fragment_shader);
+        if (!GpuResources::get(h_shadow_shader_program)->is_compiled())
+        {
+            shutdown_systems();
+            return -1;
+        }
+        p_shadow_atlas = std::make_unique<ShadowAtlas>(m_shadow_maps.get_atlas_size());
+        h_spot_lights_ssbo = GpuResources::create<ShaderStorageBuffer>();
+        p_shadow_timer = std::make_unique<GpuTimer>();
+        p_frame_timer = std::make_unique<GpuTimer>();
+        p_frame_readback = std::make_unique<FramebufferReadback>();
+
+        for (const glm::vec3& current_position : positions)
+        {
+            m_cube_nodes.push_back(transforms.create_node(TransformHierarchy::invalid_node, current_position));
+            m_dynamic_cubes.push_back(1);
+            m_lightmap_scale_offsets.emplace_back(0.f);
+        }
+        if (!m_benchmark_scene_loaded)
+        {
+            // around the initial cubes, with the sky matching the constant ambient term they had before
+            IrradianceProbes::Settings probes_settings;
+            probes_settings.sky_color = ambient_factor * glm::vec3(light_source_color[0], light_source_color[1], light_source_color[2]);
+            probes_settings.origin = glm::vec3(-8.f, -10.f, -6.f);
+            probes_settings.spacing = glm::vec3(3.f);
+            probes_settings.grid_size = glm::ivec3(6, 6, 5);
+            configure_irradiance_probes(probes_settings);
         }
 
         Renderer_OpenGL::enable_depth_test();
@@ -465,14 +1338,586 @@ namespace SimpleEngine {
             draw();
         }
 
+        shutdown_systems();
+        return 0;
+    }
+
+    void Application::shutdown_systems()
+    {
+        // writes the pending images
+        p_frame_readback = nullptr;
+        WorldPartition::shutdown();
+        h_streamed_textures.clear();
+        TextureStreamer::shutdown();
+        GpuResources::shutdown();
+        GpuProfiler::shutdown();
+        // its callbacks run on the JobSystem workers
+        VirtualFileSystem::shutdown();
+        JobSystem::shutdown();
+        m_pAssetManifest = nullptr;
         m_pWindow = nullptr;
+    }
 
-        return 0;
+    void Application::load_lights_benchmark_scene(const size_t lights_count)
+    {
+        // a floor of cubes under a slab of lights, generated from a fixed seed so runs are comparable
+        if (!m_benchmark_scene_loaded)
+        {
+            constexpr int cubes_per_side = 24;
+            constexpr float cube_spacing = 4.f;
+            for (int x = 0; x < cubes_per_side; ++x)
+            {
+                for (int y = 0; y < cubes_per_side; ++y)
+                {
+                    const glm::vec3 position((x - cubes_per_side / 2) * cube_spacing, (y - cubes_per_side / 2) * cube_spacing, -4.f);
+                    m_cube_nodes.push_back(transforms.create_node(TransformHierarchy::invalid_node, position));
+                    m_dynamic_cubes.push_back(0);
+                    m_lightmap_scale_offsets.emplace_back(0.f);
+                }
+            }
+            m_benchmark_scene_loaded = true;
+
+            // probes between and above the floor cubes
+            IrradianceProbes::Settings probes_settings;
+            probes_settings.origin = glm::vec3(-50.f, -50.f, -2.f);
+            probes_settings.spacing = glm::vec3(4.f);
+            probes_settings.grid_size = glm::ivec3(25, 25, 4);
+            configure_irradiance_probes(probes_settings);
+        }
+
+        // a ring of shadowed spot lights looking down at the floor
+        constexpr size_t spot_lights_count = 8;
+        spot_lights.resize(spot_lights_count);
+        for (size_t i = 0; i < spot_lights_count; ++i)
+        {
+            const float angle = glm::two_pi<float>() * i / spot_lights_count;
+            SpotLight& light = spot_lights[i];
+            light.position = glm::vec3(20.f * std::cos(angle), 20.f * std::sin(angle), 6.f);
+            light.direction = glm::vec3(-0.3f * std::cos(angle), -0.3f * std::sin(angle), -1.f);
+            light.range = 20.f;
+            light.color = glm::vec3(1.f, 0.9f, 0.7f);
+        }
+
+        std::mt19937 random_engine(42);
+        std::uniform_real_distribution<float> horizontal(-48.f, 48.f);
+        std::uniform_real_distribution<float> vertical(-2.5f, 1.f);
+        std::uniform_real_distribution<float> radius(2.f, 5.f);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        point_lights.resize(lights_count);
+        for (PointLight& light : point_lights)
+        {
+            light.position = glm::vec3(horizontal(random_engine), horizontal(random_engine), vertical(random_engine));
+            light.radius = radius(random_engine);
+            light.color = glm::vec3(unit(random_engine), unit(random_engine), unit(random_engine));
+            light.intensity = 4.f;
+        }
+        LOG_INFO("Loaded lights benchmark scene: {0} point lights, {1} spot lights, {2} cubes", lights_count, spot_lights.size(), m_cube_nodes.size());
+    }
+
+    void Application::load_stress_scene(const size_t cubes_count, const size_t lights_count, const size_t textures_count)
+    {
+        const size_t cubes_per_side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(cubes_count))));
+        constexpr float cube_spacing = 4.f;
+        const float half_extent = cubes_per_side * cube_spacing * 0.5f;
+        for (size_t i = 0; i < cubes_count; ++i)
+        {
+            const glm::vec3 position((i % cubes_per_side) * cube_spacing - half_extent, (i / cubes_per_side) * cube_spacing - half_extent, -4.f);
+            m_cube_nodes.push_back(transforms.create_node(TransformHierarchy::invalid_node, position));
+            m_dynamic_cubes.push_back(0);
+            m_lightmap_scale_offsets.emplace_back(0.f);
+        }
+        m_benchmark_scene_loaded = true;
+        // created by start(), they need the GL context
+        m_stress_textures_count = textures_count;
+
+        // at most 24 probe cells per side, the whole grid is baked before recording starts
+        IrradianceProbes::Settings probes_settings;
+        const float probes_spacing = std::max(4.f, 2.f * half_extent / 24.f);
+        const int probes_per_side = static_cast<int>(std::ceil(2.f * half_extent / probes_spacing)) + 1;
+        probes_settings.origin = glm::vec3(-half_extent, -half_extent, -2.f);
+        probes_settings.spacing = glm::vec3(probes_spacing, probes_spacing, 4.f);
+        probes_settings.grid_size = glm::ivec3(probes_per_side, probes_per_side, 4);
+        configure_irradiance_probes(probes_settings);
+
+        constexpr size_t spot_lights_count = 8;
+        spot_lights.resize(spot_lights_count);
+        for (size_t i = 0; i < spot_lights_count; ++i)
+        {
+            const float angle = glm::two_pi<float>() * i / spot_lights_count;
+            SpotLight& light = spot_lights[i];
+            light.position = glm::vec3(0.4f * half_extent * std::cos(angle), 0.4f * half_extent * std::sin(angle), 6.f);
+            light.direction = glm::vec3(-0.3f * std::cos(angle), -0.3f * std::sin(angle), -1.f);
+            light.range = 20.f;
+            light.color = glm::vec3(1.f, 0.9f, 0.7f);
+        }
+
+        std::mt19937 random_engine(42);
+        std::uniform_real_distribution<float> horizontal(-half_extent, half_extent);
+        std::uniform_real_distribution<float> vertical(-2.5f, 1.f);
+        std::uniform_real_distribution<float> radius(2.f, 5.f);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+        point_lights.resize(lights_count);
+        for (PointLight& light : point_lights)
+        {
+            const float x = horizontal(random_engine);
+            const float y = horizontal(random_engine);
+            const float z = vertical(random_engine);
+            light.position = glm::vec3(x, y, z);
+            light.radius = radius(random_engine);
+            const float r = unit(random_engine);
+            const float g = unit(random_engine);
+            const float b = unit(random_engine);
+            light.color = glm::vec3(r, g, b);
+            light.intensity = 4.f;
+        }
+        LOG_INFO("Loaded stress scene: {0} cubes, {1} point lights, {2} spot lights, {3} textures", cubes_count, lights_count, spot_lights.size(), textures_count);
+    }
+
+    void Application::load_world(const WorldPartition::Settings& settings)
+    {
+        WorldPartition::init(settings, transforms,
+            [](void* pContext, const TransformHierarchy::NodeId* nodes, const size_t count)
+            {
+                Application& application = *static_cast<Application*>(pContext);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    application.m_cube_nodes.push_back(nodes[i]);
+                    application.m_dynamic_cubes.push_back(0);
+                    application.m_lightmap_scale_offsets.emplace_back(0.f);
+                }
+            },
+            [](void* pContext, const TransformHierarchy::NodeId* nodes, const size_t count)
+            {
+                static_cast<Application*>(pContext)->remove_cubes(nodes, count);
+            }, this);
+        LOG_INFO("Streaming world from {0}: {1} unit cells within {2} units", settings.directory, settings.cell_size, settings.load_radius);
+    }
+
+    void Application::unload_world()
+    {
+        WorldPartition::shutdown();
+    }
+
+    void Application::remove_cubes(const TransformHierarchy::NodeId* nodes, const size_t count)
+    {
+        // one pass over the cubes however many are removed
+        std::vector<TransformHierarchy::NodeId> removed_nodes(nodes, nodes + count);
+        std::sort(removed_nodes.begin(), removed_nodes.end());
+        size_t kept_count = 0;
+        for (size_t i = 0; i < m_cube_nodes.size(); ++i)
+        {
+            if (std::binary_search(removed_nodes.begin(), removed_nodes.end(), m_cube_nodes[i]))
+            {
+                continue;
+            }
+            m_cube_nodes[kept_count] = m_cube_nodes[i];
+            m_dynamic_cubes[kept_count] = m_dynamic_cubes[i];
+            m_lightmap_scale_offsets[kept_count] = m_lightmap_scale_offsets[i];
+            ++kept_count;
+        }
+        m_cube_nodes.resize(kept_count);
+        m_dynamic_cubes.resize(kept_count);
+        m_lightmap_scale_offsets.resize(kept_count);
+        // cached shadow maps and probes still see the removed cubes, the update destroying their nodes makes them stale
+        m_removed_static_geometry_version = transforms.get_update_count() + 1;
+    }
+
+    bool Application::save_stress_world(const WorldPartition::Settings& settings, const int cells_per_side, const size_t cubes_per_side)
+    {
+        // the directory is on disk relative to the working directory, which start() mounts as the root
+        std::error_code error;
+        std::filesystem::create_directories(settings.directory, error);
+        std::mt19937 random_engine(42);
+        std::uniform_real_distribution<float> height(-6.f, -2.f);
+        std::vector<WorldPartition::Cube> cubes(cubes_per_side * cubes_per_side);
+        const int first_cell = -cells_per_side / 2;
+        for (int y = first_cell; y < first_cell + cells_per_side; ++y)
+        {
+            for (int x = first_cell; x < first_cell + cells_per_side; ++x)
+            {
+                for (size_t i = 0; i < cubes.size(); ++i)
+                {
+                    const float cube_x = x + (i % cubes_per_side + 0.5f) / cubes_per_side;
+                    const float cube_y = y + (i / cubes_per_side + 0.5f) / cubes_per_side;
+                    cubes[i].position = glm::vec3(cube_x * settings.cell_size, cube_y * settings.cell_size, height(random_engine));
+                }
+                const std::string path = WorldPartition::get_cell_path(settings.directory, glm::ivec2(x, y));
+                if (!WorldPartition::save_cell(path, cubes.data(), cubes.size()))
+                {
+                    LOG_ERROR("Can't write {0}", path);
+                    return false;
+                }
+            }
+        }
+        LOG_INFO("Saved stress world: {0} cells of {1} cubes in {2}", cells_per_side * cells_per_side, cubes.size(), settings.directory);
+        return true;
+    }
+
+    static SceneEnvironment get_environment(const Application& application)
+    {
+        SceneEnvironment environment;
+        environment.light_source_position = glm::vec3(application.light_source_position[0], application.light_source_position[1], application.light_source_position[2]);
+        environment.light_source_color = glm::vec3(application.light_source_color[0], application.light_source_color[1], application.light_source_color[2]);
+        environment.ambient_factor = application.ambient_factor;
+        environment.diffuse_factor = application.diffuse_factor;
+        environment.specular_factor = application.specular_factor;
+        environment.shininess = application.shininess;
+        return environment;
+    }
+
+    static void set_environment(Application& application, const SceneEnvironment& environment)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            application.light_source_position[i] = environment.light_source_position[i];
+            application.light_source_color[i] = environment.light_source_color[i];
+        }
+        application.ambient_factor = environment.ambient_factor;
+        application.diffuse_factor = environment.diffuse_factor;
+        application.specular_factor = environment.specular_factor;
+        application.shininess = environment.shininess;
+    }
+
+    void Application::new_scene()
+    {
+        unload_world();
+        for (const TransformHierarchy::NodeId node : m_cube_nodes)
+        {
+            transforms.destroy_node(node);
+        }
+        m_cube_nodes.clear();
+        m_dynamic_cubes.clear();
+        m_lightmap_scale_offsets.clear();
+        m_removed_static_geometry_version = transforms.get_update_count() + 1;
+
+        point_lights.clear();
+        spot_lights.clear();
+        directional_light = DirectionalLight();
+        set_environment(*this, SceneEnvironment());
+    }
+
+    bool Application::load_scene(const std::string& path)
+    {
+        const auto start_time = std::chrono::steady_clock::now();
+        SceneData scene;
+        if (!read_scene(path, scene))
+        {
+            return false;
+        }
+        new_scene();
+
+        // the cubes go to the transforms field by field, the way they are stored
+        const size_t cubes_count = scene.cubes.size();
+        m_cube_nodes.resize(cubes_count);
+        transforms.create_nodes(cubes_count,
+                                scene.cubes.get_field<&SceneCube::position>().data(),
+                                scene.cubes.get_field<&SceneCube::rotation>().data(),
+                                scene.cubes.get_field<&SceneCube::scale>().data(),
+                                scene.cubes.get_field<&SceneCube::parent>().data(),
+                                m_cube_nodes.data());
+        const std::vector<uint8_t>& dynamic_cubes = scene.cubes.get_field<&SceneCube::dynamic>();
+        m_dynamic_cubes.assign(dynamic_cubes.begin(), dynamic_cubes.end());
+        m_lightmap_scale_offsets.assign(cubes_count, glm::vec4(0.f));
+
+        point_lights.resize(scene.point_lights.size());
+        scene.point_lights.copy_to(point_lights.data());
+        spot_lights.resize(scene.spot_lights.size());
+        scene.spot_lights.copy_to(spot_lights.data());
+        if (!scene.directional_lights.empty())
+        {
+            directional_light = scene.directional_lights.get(0);
+        }
+        if (!scene.environments.empty())
+        {
+            set_environment(*this, scene.environments.get(0));
+        }
+
+        const double time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+        LOG_INFO("Loaded scene {0}: {1} cubes, {2} point lights, {3} spot lights in {4:.1f} ms",
+                 path, cubes_count, point_lights.size(), spot_lights.size(), time_ms);
+        return true;
+    }
+
+    void Application::save_scene(const std::string& path, const ESceneFormat format)
+    {
+        SceneData scene;
+        scene.cubes.reserve(m_cube_nodes.size());
+        // filled on the first parented cube, parents that aren't cubes are dropped and their children saved as roots
+        std::unordered_map<TransformHierarchy::NodeId, uint32_t> cube_indices;
+        for (size_t i = 0; i < m_cube_nodes.size(); ++i)
+        {
+            const TransformHierarchy::NodeId node = m_cube_nodes[i];
+            SceneCube cube;
+            cube.position = transforms.get_local_position(node);
+            cube.rotation = transforms.get_local_rotation(node);
+            cube.scale = transforms.get_local_scale(node);
+            cube.dynamic = m_dynamic_cubes[i] != 0;
+            const TransformHierarchy::NodeId parent = transforms.get_parent(node);
+            if (parent != TransformHierarchy::invalid_node)
+            {
+                if (cube_indices.empty())
+                {
+                    cube_indices.reserve(m_cube_nodes.size());
+                    for (size_t j = 0; j < m_cube_nodes.size(); ++j)
+                    {
+                        cube_indices.emplace(m_cube_nodes[j], static_cast<uint32_t>(j));
+                    }
+                }
+                const auto parent_index = cube_indices.find(parent);
+                cube.parent = parent_index != cube_indices.end() ? parent_index->second : SceneCube::no_parent;
+            }
+            scene.cubes.push_back(cube);
+        }
+        scene.point_lights.assign(point_lights.data(), point_lights.size());
+        scene.spot_lights.assign(spot_lights.data(), spot_lights.size());
+        scene.directional_lights.push_back(directional_light);
+        scene.environments.push_back(get_environment(*this));
+
+        if (!m_pSceneSaver)
+        {
+            m_pSceneSaver = std::make_unique<SceneSaver>();
+        }
+        m_pSceneSaver->save(std::move(scene), path, format == ESceneFormat::Text);
+    }
+
+    bool Application::is_saving_scene() const
+    {
+        return m_pSceneSaver && m_pSceneSaver->is_saving();
+    }
+
+    int Application::run_frame_time_harness(const FrameTimeHarness::Settings& settings)
+    {
+        FrameTimeHarness::Settings harness_settings = settings;
+        load_stress_scene(settings.cubes_count, settings.lights_count, settings.textures_count);
+        // same layout as load_stress_scene
+        const float half_extent = std::ceil(std::sqrt(static_cast<float>(settings.cubes_count))) * 2.f;
+        if (harness_settings.camera_path.empty())
+        {
+            // one orbit around the floor looking at its center from above, yaw keeps growing so interpolation never spins back
+            constexpr size_t keyframes_count = 17;
+            const float distance = 1.2f * half_extent;
+            const float height = 0.5f * half_extent + 4.f;
+            const float pitch = glm::degrees(std::atan2(height + 4.f, distance));
+            for (size_t i = 0; i < keyframes_count; ++i)
+            {
+                const float angle = glm::two_pi<float>() * i / (keyframes_count - 1);
+                const glm::vec3 position(distance * std::cos(angle), distance * std::sin(angle), height);
+                harness_settings.camera_path.push_back({ position, glm::vec3(0.f, pitch, glm::degrees(angle) + 180.f) });
+            }
+        }
+        camera.set_far_clip_plane(std::max(camera.get_far_clip_plane(), 4.f * half_extent));
+        animate_point_lights = true;
+        animate_dynamic_casters = true;
+
+        if (!settings.input_recording_path.empty())
+        {
+            m_pHarnessInputRecording = std::make_unique<InputRecording>();
+            if (!m_pHarnessInputRecording->load(settings.input_recording_path))
+            {
+                LOG_ERROR("Can't read input recording {0}", settings.input_recording_path);
+                m_pHarnessInputRecording = nullptr;
+                return -4;
+            }
+            LOG_INFO("Replaying {0} frames of input from {1}", m_pHarnessInputRecording->get_frames_count(), settings.input_recording_path);
+        }
+
+        if (settings.assert_no_heap_allocations && !MemoryTracker::is_enabled())
+        {
+            LOG_WARN("Built without SIMPLE_ENGINE_MEMORY_TRACKING, heap allocations per frame aren't checked");
+        }
+        m_pFrameTimeHarness = std::make_unique<FrameTimeHarness>(std::move(harness_settings));
+        m_frame_index = 0;
+        m_reported_allocating_frames_count = 0;
+        const int start_result = start(settings.width, settings.height, "SimpleEngine frame time harness", EWindowMode::Headless);
+        const std::unique_ptr<FrameTimeHarness> harness = std::move(m_pFrameTimeHarness);
+        m_pHarnessInputRecording = nullptr;
+        Input::StopReplay();
+        if (start_result != 0 || !harness->is_finished())
+        {
+            LOG_CRITICAL("Frame time harness didn't finish: {0} of {1} frames recorded", harness->get_recorded_frames_count(), settings.frames_count);
+            return -1;
+        }
+
+        m_frame_time_report = harness->make_report();
+        const FrameTimeHarness::Report& report = m_frame_time_report;
+        LOG_INFO("Frame times over {0} frames, CPU p50 {1:.2f} p95 {2:.2f} p99 {3:.2f} max {4:.2f} ms, {5} hitches",
+                 report.frames_count, report.cpu.p50_ms, report.cpu.p95_ms, report.cpu.p99_ms, report.cpu.max_ms, report.cpu.hitches_count);
+        LOG_INFO("Frame times over {0} frames, GPU p50 {1:.2f} p95 {2:.2f} p99 {3:.2f} max {4:.2f} ms, {5} hitches",
+                 report.frames_count, report.gpu.p50_ms, report.gpu.p95_ms, report.gpu.p99_ms, report.gpu.max_ms, report.gpu.hitches_count);
+        if (!settings.output_path.empty() && !harness->save_report(report, settings.output_path))
+        {
+            LOG_ERROR("Can't write frame time report {0}", settings.output_path);
+            return -2;
+        }
+        const bool allocates = settings.assert_no_heap_allocations && report.frames_with_heap_allocations_count > 0;
+        if (allocates)
+        {
+            LOG_ERROR("{0} of {1} recorded frames allocated from the heap, up to {2} allocations in a frame",
+                      report.frames_with_heap_allocations_count, report.frames_count, report.max_heap_allocations_per_frame);
+        }
+        if (settings.baseline_path.empty())
+        {
+            return allocates ? 1 : 0;
+        }
+
+        FrameTimeHarness::Report baseline;
+        if (!FrameTimeHarness::load_report(settings.baseline_path, baseline))
+        {
+            LOG_ERROR("Can't read frame time baseline {0}", settings.baseline_path);
+            return -3;
+        }
+        const std::vector<std::string> regressions = FrameTimeHarness::compare(report, baseline, settings.regression_threshold, settings.allowed_extra_hitches);
+        for (const std::string& metric : regressions)
+        {
+            LOG_ERROR("Frame time regression in {0} over baseline {1}", metric, settings.baseline_path);
+        }
+        return regressions.empty() && !allocates ? 0 : 1;
+    }
+
+    bool Application::bake_lightmaps(const LightmapBaker::Settings& settings)
+    {
+        // only static cubes are baked, dynamic ones keep the constant ambient term
+        transforms.update();
+        LightmapBaker baker;
+        const size_t cube_mesh = baker.add_mesh(make_cube_lightmap_mesh());
+        std::vector<size_t> baked_cubes;
+        for (size_t i = 0; i < m_cube_nodes.size(); ++i)
+        {
+            if (m_dynamic_cubes[i] == 0)
+            {
+                baker.add_instance(cube_mesh, transforms.get_world_matrix(m_cube_nodes[i]));
+                baked_cubes.push_back(i);
+            }
+        }
+        const bool baked = baker.bake(settings, directional_light, spot_lights);
+        m_lightmap_stats = baker.get_stats();
+        if (!baked)
+        {
+            return false;
+        }
+
+        std::fill(m_lightmap_scale_offsets.begin(), m_lightmap_scale_offsets.end(), glm::vec4(0.f));
+        for (size_t i = 0; i < baked_cubes.size(); ++i)
+        {
+            m_lightmap_scale_offsets[baked_cubes[i]] = baker.get_scale_offset(i);
+        }
+        GpuResources::destroy(h_lightmap);
+        h_lightmap = GpuResources::create<Texture2D>(&baker.get_lightmap()[0].x, baker.get_lightmap_size(), baker.get_lightmap_size());
+        return true;
+    }
+
+    void Application::configure_irradiance_probes(const IrradianceProbes::Settings& settings)
+    {
+        m_irradiance_probes.configure(settings);
+        m_irradiance_probes_scene_set = false;
+        GpuResources::destroy(h_irradiance_probes_texture);
+    }
+
+    void Application::animate_benchmark_lights()
+    {
+        // every light orbits the scene center, so the clusters change every frame
+        constexpr float angle = 0.005f;
+        const float s = std::sin(angle);
+        const float c = std::cos(angle);
+        for (PointLight& light : point_lights)
+        {
+            const glm::vec3 position = light.position;
+            light.position.x = position.x * c - position.y * s;
+            light.position.y = position.x * s + position.y * c;
+        }
     }
 
     glm::vec2 Application::get_current_cursor_position() const
     {
-        return m_pWindow->get_current_cursor_position();
+        return Input::GetMousePosition();
+    }
+
+    bool Application::capture_gl_frames(const std::string& path, const uint32_t frames_count)
+    {
+        if (!m_pWindow || !GLCapture::begin(path, frames_count, m_pWindow->get_width(), m_pWindow->get_height()))
+        {
+            return false;
+        }
+        LOG_INFO("Capturing {0} frames of GL calls into {1}", frames_count, path);
+        return true;
+    }
+
+    bool Application::is_capturing_gl_frames() const
+    {
+        return GLCapture::is_capturing();
+    }
+
+    bool Application::record_frames(const std::string& directory, const uint32_t frames_count, const EImageFormat format)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error)
+        {
+            LOG_CRITICAL("Can't create {0}: {1}", directory, error.message());
+            return false;
+        }
+        m_recording_directory = directory;
+        m_recording_format = format;
+        m_recorded_frames_left = frames_count;
+        m_recorded_frames_count = 0;
+        return true;
+    }
+
+    void Application::save_screenshot(const std::string& path)
+    {
+        m_screenshot_path = path;
+    }
+
+    void Application::read_back_frame()
+    {
+        PROFILE_SCOPE("Application::read_back_frame");
+        const auto start_time = std::chrono::steady_clock::now();
+        p_frame_readback->poll();
+
+        const auto request = [&](FramebufferReadback::Sink sink)
+        {
+            return p_frame_readback->request(Framebuffer::get_default_handle(), m_pWindow->get_width(), m_pWindow->get_height(), m_frame_index, std::move(sink));
+        };
+        if (!m_screenshot_path.empty())
+        {
+            const bool requested = request([path = m_screenshot_path](const FramebufferReadback::Image& image)
+            {
+                if (!write_png(path, image.pixels, image.width, image.height, true))
+                {
+                    LOG_ERROR("Can't write screenshot {0}", path);
+                }
+            });
+            if (requested)
+            {
+                m_screenshot_path.clear();
+            }
+        }
+        if (m_recorded_frames_left > 0)
+        {
+            char file_name[32];
+            std::snprintf(file_name, sizeof(file_name), "frame_%06u.%s", m_recorded_frames_count, m_recording_format == EImageFormat::Png ? "png" : "rgba");
+            const std::string path = (std::filesystem::path(m_recording_directory) / file_name).string();
+            const bool requested = request([path, format = m_recording_format](const FramebufferReadback::Image& image)
+            {
+                const bool written = format == EImageFormat::Png ? write_png(path, image.pixels, image.width, image.height, true)
+                                                                 : write_raw(path, image.pixels, image.width, image.height, true);
+                if (!written)
+                {
+                    LOG_ERROR("Can't write frame {0}", path);
+                }
+            });
+            // a skipped frame is retried with the next one, the recording still gets frames_count files
+            if (requested)
+            {
+                ++m_recorded_frames_count;
+                if (--m_recorded_frames_left == 0)
+                {
+                    LOG_INFO("Recorded {0} frames into {1}", m_recorded_frames_count, m_recording_directory);
+                }
+            }
+        }
+        m_readback_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
     }
 
     void Application::close()
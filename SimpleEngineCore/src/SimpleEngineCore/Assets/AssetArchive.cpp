@@ -0,0 +1,209 @@
+#include "AssetArchive.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include <cstring>
+#include <memory>
+
+namespace SimpleEngine {
+
+    using namespace AssetArchiveFormat;
+
+    static bool is_range_valid(const uint64_t offset, const uint64_t size, const size_t file_size)
+    {
+        return offset <= file_size && size <= file_size - offset;
+    }
+
+    static bool paths_equal(std::string_view stored_path, std::string_view path)
+    {
+        if (stored_path.size() != path.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < path.size(); ++i)
+        {
+            if (stored_path[i] != (path[i] == '\\' ? '/' : path[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    struct ZstdContextDeleter
+    {
+        void operator()(ZSTD_DCtx* pContext) const { ZSTD_freeDCtx(pContext); }
+    };
+
+    // a decompression context per thread, creating one per read would allocate its tables every time
+    static ZSTD_DCtx* get_zstd_context()
+    {
+        static thread_local std::unique_ptr<ZSTD_DCtx, ZstdContextDeleter> pContext(ZSTD_createDCtx());
+        return pContext.get();
+    }
+
+    bool AssetArchive::open(const std::string& path)
+    {
+        close();
+        if (!m_file.open(path))
+        {
+            return false;
+        }
+
+        const size_t file_size = m_file.get_size();
+        Header header;
+        if (file_size < sizeof(Header))
+        {
+            LOG_ERROR("AssetArchive: {0} is too small", path);
+            close();
+            return false;
+        }
+        std::memcpy(&header, m_file.get_data(), sizeof(Header));
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version)
+        {
+            LOG_ERROR("AssetArchive: {0} isn't a version {1} archive", path, version);
+            close();
+            return false;
+        }
+        const bool buckets_count_valid = header.buckets_count > header.entries_count && (header.buckets_count & (header.buckets_count - 1)) == 0;
+        if (!buckets_count_valid
+            || header.entries_offset % alignof(Entry) != 0 || header.buckets_offset % alignof(uint32_t) != 0
+            || !is_range_valid(header.entries_offset, static_cast<uint64_t>(header.entries_count) * sizeof(Entry), file_size)
+            || !is_range_valid(header.buckets_offset, static_cast<uint64_t>(header.buckets_count) * sizeof(uint32_t), file_size)
+            || !is_range_valid(header.paths_offset, header.paths_size, file_size))
+        {
+            LOG_ERROR("AssetArchive: {0} has invalid tables", path);
+            close();
+            return false;
+        }
+
+        m_pEntries = reinterpret_cast<const Entry*>(m_file.get_data() + header.entries_offset);
+        m_pBuckets = reinterpret_cast<const uint32_t*>(m_file.get_data() + header.buckets_offset);
+        m_pPaths = reinterpret_cast<const char*>(m_file.get_data() + header.paths_offset);
+        m_entries_count = header.entries_count;
+        m_buckets_mask = header.buckets_count - 1;
+        for (size_t i = 0; i < m_entries_count; ++i)
+        {
+            const Entry& entry = m_pEntries[i];
+            if (!is_range_valid(entry.offset, entry.stored_size, file_size) || !is_range_valid(entry.path_offset, entry.path_size, header.paths_size)
+                || (entry.compression == ECompression::None && entry.stored_size != entry.size))
+            {
+                LOG_ERROR("AssetArchive: {0} has an invalid entry {1}", path, i);
+                close();
+                return false;
+            }
+        }
+        // the lookups start right away and touch the tables all over
+        m_file.prefetch(header.entries_offset, file_size - header.entries_offset);
+        return true;
+    }
+
+    void AssetArchive::close()
+    {
+        m_file.close();
+        m_pEntries = nullptr;
+        m_pBuckets = nullptr;
+        m_pPaths = nullptr;
+        m_entries_count = 0;
+        m_buckets_mask = 0;
+    }
+
+    AssetArchive::EntryIndex AssetArchive::find(std::string_view path) const
+    {
+        if (!is_open())
+        {
+            return invalid_entry;
+        }
+        const uint64_t hash = hash_path(path.data(), path.size());
+        // a corrupt table may have no empty bucket to stop at, so never probe more than all of them
+        uint32_t bucket = static_cast<uint32_t>(hash) & m_buckets_mask;
+        for (uint64_t probes = 0; probes <= m_buckets_mask && m_pBuckets[bucket] != 0; ++probes, bucket = (bucket + 1) & m_buckets_mask)
+        {
+            const EntryIndex entry = m_pBuckets[bucket] - 1;
+            if (entry < m_entries_count && m_pEntries[entry].path_hash == hash && paths_equal(get_path(entry), path))
+            {
+                return entry;
+            }
+        }
+        return invalid_entry;
+    }
+
+    std::string_view AssetArchive::get_path(const EntryIndex entry) const
+    {
+        return std::string_view(m_pPaths + m_pEntries[entry].path_offset, m_pEntries[entry].path_size);
+    }
+
+    ByteSpan AssetArchive::get_stored_data(const EntryIndex entry) const
+    {
+        return ByteSpan{ m_file.get_data() + m_pEntries[entry].offset, static_cast<size_t>(m_pEntries[entry].stored_size) };
+    }
+
+    ByteSpan AssetArchive::get_data(const EntryIndex entry) const
+    {
+        if (m_pEntries[entry].compression != ECompression::None)
+        {
+            return ByteSpan();
+        }
+        return get_stored_data(entry);
+    }
+
+    bool AssetArchive::decompress(const ECompression compression, const void* stored_data, const size_t stored_size, void* destination, const size_t size)
+    {
+        switch (compression)
+        {
+            case ECompression::None:
+                if (stored_size != size)
+                {
+                    return false;
+                }
+                std::memcpy(destination, stored_data, size);
+                return true;
+
+            case ECompression::LZ4:
+            {
+                const int decompressed_size = LZ4_decompress_safe(static_cast<const char*>(stored_data), static_cast<char*>(destination),
+                                                                  static_cast<int>(stored_size), static_cast<int>(size));
+                return decompressed_size >= 0 && static_cast<size_t>(decompressed_size) == size;
+            }
+
+            case ECompression::Zstd:
+            {
+                const size_t decompressed_size = ZSTD_decompressDCtx(get_zstd_context(), destination, size, stored_data, stored_size);
+                return !ZSTD_isError(decompressed_size) && decompressed_size == size;
+            }
+        }
+        return false;
+    }
+
+    bool AssetArchive::read(const EntryIndex entry, void* destination) const
+    {
+        const Entry& record = m_pEntries[entry];
+        const ByteSpan stored = get_stored_data(entry);
+        if (!decompress(record.compression, stored.data, stored.size, destination, static_cast<size_t>(record.size)))
+        {
+            LOG_ERROR("AssetArchive: entry {0} is corrupt", get_path(entry));
+            return false;
+        }
+        return true;
+    }
+
+    bool AssetArchive::load(const EntryIndex entry, std::vector<uint8_t>& storage, ByteSpan& data) const
+    {
+        data = get_data(entry);
+        if (data.data)
+        {
+            return true;
+        }
+        storage.resize(static_cast<size_t>(m_pEntries[entry].size));
+        if (!read(entry, storage.data()))
+        {
+            return false;
+        }
+        data = ByteSpan{ storage.data(), storage.size() };
+        return true;
+    }
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "AssetArchiveFormat.hpp"
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SimpleEngine {
+
+    struct ByteSpan
+    {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+
+    // Reader of an AssetArchiveFormat file. The whole archive is one mapping: the tables are used in place
+    // and uncompressed entries are handed out as spans into it, so opening an archive of any number of assets
+    // is one open and no parsing. Lookups and reads are const and safe from any thread.
+    class AssetArchive
+    {
+    public:
+        using EntryIndex = uint32_t;
+        static constexpr EntryIndex invalid_entry = UINT32_MAX;
+
+        // validates the header and the tables, not the entries' data
+        bool open(const std::string& path);
+        void close();
+        bool is_open() const { return m_file.is_open(); }
+
+        EntryIndex find(std::string_view path) const;
+
+        size_t get_entries_count() const { return m_entries_count; }
+        const AssetArchiveFormat::Entry& get_entry(const EntryIndex entry) const { return m_pEntries[entry]; }
+        std::string_view get_path(const EntryIndex entry) const;
+
+        // the bytes as stored, compressed or not
+        ByteSpan get_stored_data(const EntryIndex entry) const;
+        // the entry's data in place, an empty span when it is compressed
+        ByteSpan get_data(const EntryIndex entry) const;
+
+        // decompresses into destination, get_entry().size bytes
+        bool read(const EntryIndex entry, void* destination) const;
+        // the data in place when uncompressed, otherwise decompressed into storage
+        bool load(const EntryIndex entry, std::vector<uint8_t>& storage, ByteSpan& data) const;
+
+        // for stored bytes read some other way than through the mapping, false unless exactly size bytes come out
+        static bool decompress(const AssetArchiveFormat::ECompression compression, const void* stored_data, const size_t stored_size,
+                               void* destination, const size_t size);
+
+        const MappedFile& get_file() const { return m_file; }
+
+    private:
+        MappedFile m_file;
+        const AssetArchiveFormat::Entry* m_pEntries = nullptr;
+        const uint32_t* m_pBuckets = nullptr;
+        const char* m_pPaths = nullptr;
+        size_t m_entries_count = 0;
+        uint32_t m_buckets_mask = 0;
+    };
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+    // Read-only asset archive, little endian, written by AssetArchiveWriter and mapped by AssetArchive.
+    // File: Header padded to an alignment block, the entries' data each starting on an alignment boundary,
+    // then the Entry table, the hash buckets and the paths. The tables come last so the writer streams the data.
+    // Paths use '/' and are hashed with hash_path(). A bucket holds an entry index + 1, 0 is empty;
+    // lookups probe linearly from hash & (buckets_count - 1).
+    namespace AssetArchiveFormat {
+
+        constexpr char magic[8] = { 'S', 'E', 'A', 'R', 'C', 'H', 'I', 'V' };
+        constexpr uint32_t version = 1;
+        // page size: uncompressed entries can be mapped, and read with unbuffered I/O, as they are
+        constexpr uint32_t alignment = 4096;
+
+        enum class ECompression : uint8_t
+        {
+            None,
+            LZ4,
+            Zstd
+        };
+
+        // how the entry's bytes are laid out, Raw is whatever the caller put in
+        enum class EAssetType : uint8_t
+        {
+            Raw,
+            // TextureHeader, then the mip levels from the largest down
+            Texture,
+            // MeshHeader, then the vertices and the indices
+            Mesh,
+            // GLSL source, not null terminated
+            Shader
+        };
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t alignment;
+            uint32_t entries_count;
+            uint32_t buckets_count;
+            uint64_t entries_offset;
+            uint64_t buckets_offset;
+            uint64_t paths_offset;
+            uint64_t paths_size;
+        };
+        static_assert(sizeof(Header) == 56, "Header is read straight from the file");
+
+        struct Entry
+        {
+            uint64_t path_hash;
+            // from the start of the file, a multiple of alignment
+            uint64_t offset;
+            // bytes in the file
+            uint64_t stored_size;
+            // bytes once decompressed
+            uint64_t size;
+            // into the paths block
+            uint32_t path_offset;
+            uint32_t path_size;
+            ECompression compression;
+            EAssetType type;
+            uint16_t reserved0;
+            uint32_t reserved1;
+        };
+        static_assert(sizeof(Entry) == 48, "Entry is read straight from the file");
+
+        enum class ETextureFormat : uint32_t
+        {
+            RGBA8
+        };
+
+        struct TextureHeader
+        {
+            uint32_t width;
+            uint32_t height;
+            uint32_t mip_levels;
+            ETextureFormat format;
+        };
+        static_assert(sizeof(TextureHeader) == 16, "TextureHeader is read straight from the file");
+
+        // bits of MeshHeader::attributes, interleaved in this order
+        enum EMeshAttribute : uint32_t
+        {
+            MeshPosition = 1 << 0,   // float3
+            MeshNormal = 1 << 1,     // float3
+            MeshUV = 1 << 2,         // float2
+            MeshLightmapUV = 1 << 3  // float2
+        };
+
+        // the indices are uint32 and start on a 16 byte boundary after the vertices
+        struct MeshHeader
+        {
+            uint32_t vertices_count;
+            uint32_t indices_count;
+            uint32_t attributes;
+            uint32_t vertex_stride;
+            float bounds_min[3];
+            float bounds_max[3];
+        };
+        static_assert(sizeof(MeshHeader) == 40, "MeshHeader is read straight from the file");
+
+        constexpr size_t get_mesh_indices_offset(const MeshHeader& header)
+        {
+            return (sizeof(MeshHeader) + static_cast<size_t>(header.vertices_count) * header.vertex_stride + 15) & ~static_cast<size_t>(15);
+        }
+
+        // FNV-1a over the path with '\\' read as '/'
+        constexpr uint64_t hash_path(const char* path, const size_t size)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (size_t i = 0; i < size; ++i)
+            {
+                const char c = path[i] == '\\' ? '/' : path[i];
+                hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+    }
+
+}
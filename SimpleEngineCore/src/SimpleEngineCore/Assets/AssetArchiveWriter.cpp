@@ -0,0 +1,207 @@
+#include "AssetArchiveWriter.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace SimpleEngine {
+
+    using namespace AssetArchiveFormat;
+
+    static const char s_zeros[alignment] = {};
+
+    AssetArchiveWriter::AssetArchiveWriter(const Settings& settings)
+        : m_settings(settings)
+    {
+    }
+
+    bool AssetArchiveWriter::open(const std::string& path)
+    {
+        m_path = path;
+        m_file.open(path, std::ios::binary | std::ios::trunc);
+        m_offset = 0;
+        m_entries.clear();
+        m_paths.clear();
+        m_failed = !m_file;
+        if (m_failed)
+        {
+            LOG_ERROR("AssetArchiveWriter: can't create {0}", path);
+            return false;
+        }
+        // the header is written last, over this block
+        return write(s_zeros, alignment);
+    }
+
+    bool AssetArchiveWriter::write(const void* data, const size_t size)
+    {
+        if (m_failed)
+        {
+            return false;
+        }
+        m_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        m_offset += size;
+        if (!m_file)
+        {
+            LOG_ERROR("AssetArchiveWriter: writing {0} failed", m_path);
+            m_failed = true;
+        }
+        return !m_failed;
+    }
+
+    bool AssetArchiveWriter::pad_to(const uint64_t boundary)
+    {
+        const size_t padding = static_cast<size_t>((boundary - m_offset % boundary) % boundary);
+        return write(s_zeros, padding);
+    }
+
+    bool AssetArchiveWriter::compress(const ECompression compression, const Settings& settings, const void* data, const size_t size, std::vector<uint8_t>& output)
+    {
+        size_t compressed_size = 0;
+        switch (compression)
+        {
+            case ECompression::None:
+                return false;
+
+            case ECompression::LZ4:
+            {
+                if (size > static_cast<size_t>(LZ4_MAX_INPUT_SIZE))
+                {
+                    return false;
+                }
+                output.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(size))));
+                const int result = LZ4_compress_HC(static_cast<const char*>(data), reinterpret_cast<char*>(output.data()), static_cast<int>(size),
+                                                   static_cast<int>(output.size()), settings.lz4_level);
+                if (result <= 0)
+                {
+                    return false;
+                }
+                compressed_size = static_cast<size_t>(result);
+                break;
+            }
+
+            case ECompression::Zstd:
+            {
+                output.resize(ZSTD_compressBound(size));
+                const size_t result = ZSTD_compress(output.data(), output.size(), data, size, settings.zstd_level);
+                if (ZSTD_isError(result))
+                {
+                    return false;
+                }
+                compressed_size = result;
+                break;
+            }
+        }
+        output.resize(compressed_size);
+        return static_cast<double>(compressed_size) <= static_cast<double>(size) * (1.0 - settings.min_savings);
+    }
+
+    bool AssetArchiveWriter::add(std::string_view path, const void* data, const size_t size, const EAssetType type, const ECompression compression)
+    {
+        if (compression != ECompression::None && compress(compression, m_settings, data, size, m_compressed))
+        {
+            return add_stored(path, m_compressed.data(), m_compressed.size(), size, type, compression);
+        }
+        return add_stored(path, data, size, size, type, ECompression::None);
+    }
+
+    bool AssetArchiveWriter::add_stored(std::string_view path, const void* stored_data, const size_t stored_size, const size_t size,
+                                        const EAssetType type, const ECompression compression)
+    {
+        if (m_failed || !pad_to(alignment))
+        {
+            return false;
+        }
+
+        Entry entry{};
+        entry.path_hash = hash_path(path.data(), path.size());
+        entry.offset = m_offset;
+        entry.stored_size = stored_size;
+        entry.size = size;
+        entry.path_offset = static_cast<uint32_t>(m_paths.size());
+        entry.path_size = static_cast<uint32_t>(path.size());
+        entry.compression = compression;
+        entry.type = type;
+        m_paths.append(path.data(), path.size());
+        std::replace(m_paths.begin() + entry.path_offset, m_paths.end(), '\\', '/');
+        m_entries.push_back(entry);
+        return write(stored_data, stored_size);
+    }
+
+    bool AssetArchiveWriter::finish()
+    {
+        if (m_failed)
+        {
+            return false;
+        }
+
+        // at most half full, so probes stay short
+        uint32_t buckets_count = 16;
+        while (buckets_count < m_entries.size() * 2)
+        {
+            buckets_count *= 2;
+        }
+        std::vector<uint32_t> buckets(buckets_count, 0);
+        std::unordered_multimap<uint64_t, size_t> entries_by_hash;
+        for (size_t i = 0; i < m_entries.size(); ++i)
+        {
+            const Entry& entry = m_entries[i];
+            const std::string_view path(m_paths.data() + entry.path_offset, entry.path_size);
+            const auto range = entries_by_hash.equal_range(entry.path_hash);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                const Entry& other = m_entries[it->second];
+                if (std::string_view(m_paths.data() + other.path_offset, other.path_size) == path)
+                {
+                    LOG_ERROR("AssetArchiveWriter: {0} is added twice to {1}", path, m_path);
+                    m_failed = true;
+                    return false;
+                }
+            }
+            entries_by_hash.emplace(entry.path_hash, i);
+
+            uint32_t bucket = static_cast<uint32_t>(entry.path_hash) & (buckets_count - 1);
+            while (buckets[bucket] != 0)
+            {
+                bucket = (bucket + 1) & (buckets_count - 1);
+            }
+            buckets[bucket] = static_cast<uint32_t>(i + 1);
+        }
+
+        Header header{};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.alignment = alignment;
+        header.entries_count = static_cast<uint32_t>(m_entries.size());
+        header.buckets_count = buckets_count;
+
+        pad_to(alignof(Entry));
+        header.entries_offset = m_offset;
+        write(m_entries.data(), m_entries.size() * sizeof(Entry));
+        header.buckets_offset = m_offset;
+        write(buckets.data(), buckets.size() * sizeof(uint32_t));
+        header.paths_offset = m_offset;
+        header.paths_size = m_paths.size();
+        write(m_paths.data(), m_paths.size());
+        if (m_failed)
+        {
+            return false;
+        }
+
+        m_file.seekp(0);
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_file.close();
+        if (!m_file)
+        {
+            LOG_ERROR("AssetArchiveWriter: writing {0} failed", m_path);
+            m_failed = true;
+        }
+        return !m_failed;
+    }
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "AssetArchiveFormat.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // Streams an AssetArchiveFormat file: the entries' data goes out as it is added, the tables on finish().
+    class AssetArchiveWriter
+    {
+    public:
+        struct Settings
+        {
+            // LZ4 entries use the HC compressor, they decompress as fast as fast mode ones
+            int lz4_level = 9;
+            int zstd_level = 12;
+            // an entry is stored uncompressed unless compression saves at least this fraction of it
+            float min_savings = 0.05f;
+        };
+
+        AssetArchiveWriter() = default;
+        explicit AssetArchiveWriter(const Settings& settings);
+
+        bool open(const std::string& path);
+        // falls back to ECompression::None when compressing doesn't pay
+        bool add(std::string_view path, const void* data, const size_t size, const AssetArchiveFormat::EAssetType type, const AssetArchiveFormat::ECompression compression);
+        // for data compressed beforehand with compress(), e.g. on several threads
+        bool add_stored(std::string_view path, const void* stored_data, const size_t stored_size, const size_t size,
+                        const AssetArchiveFormat::EAssetType type, const AssetArchiveFormat::ECompression compression);
+        // writes the tables and the header, the archive is unusable until then
+        bool finish();
+
+        size_t get_entries_count() const { return m_entries.size(); }
+
+        // compressed into output, false when the codec fails or the result isn't min_savings smaller
+        static bool compress(const AssetArchiveFormat::ECompression compression, const Settings& settings,
+                             const void* data, const size_t size, std::vector<uint8_t>& output);
+
+    private:
+        bool write(const void* data, const size_t size);
+        bool pad_to(const uint64_t alignment);
+
+        Settings m_settings;
+        std::string m_path;
+        std::ofstream m_file;
+        uint64_t m_offset = 0;
+        std::vector<AssetArchiveFormat::Entry> m_entries;
+        std::string m_paths;
+        std::vector<uint8_t> m_compressed;
+        bool m_failed = false;
+    };
+
+}
@@ -0,0 +1,143 @@
+#include "AssetLoaders.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+    using namespace AssetArchiveFormat;
+
+    static bool load_entry(const AssetArchive& archive, std::string_view path, const EAssetType type, ByteSpan& data)
+    {
+        static thread_local std::vector<uint8_t> s_storage;
+        const AssetArchive::EntryIndex entry = archive.find(path);
+        if (entry == AssetArchive::invalid_entry)
+        {
+            LOG_ERROR("Asset {0} isn't in the archive", path);
+            return false;
+        }
+        if (archive.get_entry(entry).type != type)
+        {
+            LOG_ERROR("Asset {0} has the wrong type", path);
+            return false;
+        }
+        return archive.load(entry, s_storage, data);
+    }
+
+    Texture2DHandle load_texture(const AssetArchive& archive, std::string_view path)
+    {
+        ByteSpan data;
+        if (!load_entry(archive, path, EAssetType::Texture, data))
+        {
+            return Texture2DHandle();
+        }
+
+        TextureHeader header;
+        if (data.size < sizeof(header))
+        {
+            LOG_ERROR("Texture {0} is truncated", path);
+            return Texture2DHandle();
+        }
+        std::memcpy(&header, data.data, sizeof(header));
+        constexpr unsigned int max_mip_levels = 16;
+        if (header.format != ETextureFormat::RGBA8 || header.mip_levels == 0 || header.mip_levels > max_mip_levels)
+        {
+            LOG_ERROR("Texture {0} has an unsupported format", path);
+            return Texture2DHandle();
+        }
+
+        const unsigned char* mip_data[max_mip_levels];
+        size_t offset = sizeof(header);
+        for (unsigned int level = 0; level < header.mip_levels; ++level)
+        {
+            mip_data[level] = data.data + offset;
+            offset += static_cast<size_t>(std::max(header.width >> level, 1u)) * std::max(header.height >> level, 1u) * 4;
+        }
+        if (offset > data.size)
+        {
+            LOG_ERROR("Texture {0} is truncated", path);
+            return Texture2DHandle();
+        }
+        return GpuResources::create<Texture2D>(mip_data, header.mip_levels, header.width, header.height);
+    }
+
+    bool load_mesh(const AssetArchive& archive, std::string_view path, MeshHandles& mesh)
+    {
+        ByteSpan data;
+        if (!load_entry(archive, path, EAssetType::Mesh, data))
+        {
+            return false;
+        }
+
+        MeshHeader header;
+        if (data.size < sizeof(header))
+        {
+            LOG_ERROR("Mesh {0} is truncated", path);
+            return false;
+        }
+        std::memcpy(&header, data.data, sizeof(header));
+        BufferLayout::Elements elements;
+        if (header.attributes & MeshPosition)
+        {
+            elements.emplace_back(ShaderDataType::Float3);
+        }
+        if (header.attributes & MeshNormal)
+        {
+            elements.emplace_back(ShaderDataType::Float3);
+        }
+        if (header.attributes & MeshUV)
+        {
+            elements.emplace_back(ShaderDataType::Float2);
+        }
+        if (header.attributes & MeshLightmapUV)
+        {
+            elements.emplace_back(ShaderDataType::Float2);
+        }
+        BufferLayout layout(std::move(elements));
+        const size_t indices_offset = get_mesh_indices_offset(header);
+        if (layout.get_stride() != header.vertex_stride || indices_offset + static_cast<size_t>(header.indices_count) * sizeof(uint32_t) > data.size)
+        {
+            LOG_ERROR("Mesh {0} is truncated or has an unsupported layout", path);
+            return false;
+        }
+
+        mesh.vertex_buffer = GpuResources::create<VertexBuffer>(data.data + sizeof(header), static_cast<size_t>(header.vertices_count) * header.vertex_stride, std::move(layout));
+        mesh.index_buffer = GpuResources::create<IndexBuffer>(data.data + indices_offset, header.indices_count);
+        mesh.vertex_array = GpuResources::create<VertexArray>();
+        VertexArray& vertex_array = *GpuResources::get(mesh.vertex_array);
+        vertex_array.add_vertex_buffer(*GpuResources::get(mesh.vertex_buffer));
+        vertex_array.set_index_buffer(*GpuResources::get(mesh.index_buffer));
+        std::copy(header.bounds_min, header.bounds_min + 3, mesh.bounds_min);
+        std::copy(header.bounds_max, header.bounds_max + 3, mesh.bounds_max);
+        return true;
+    }
+
+    ShaderProgramHandle load_shader_program(const AssetArchive& archive, std::string_view vertex_shader_path, std::string_view fragment_shader_path)
+    {
+        // the GL wants null terminated sources
+        ByteSpan data;
+        if (!load_entry(archive, vertex_shader_path, EAssetType::Shader, data))
+        {
+            return ShaderProgramHandle();
+        }
+        const std::string vertex_shader(reinterpret_cast<const char*>(data.data), data.size);
+        if (!load_entry(archive, fragment_shader_path, EAssetType::Shader, data))
+        {
+            return ShaderProgramHandle();
+        }
+        const std::string fragment_shader(reinterpret_cast<const char*>(data.data), data.size);
+
+        ShaderProgramHandle shader_program = GpuResources::create<ShaderProgram>(vertex_shader.c_str(), fragment_shader.c_str());
+        if (!GpuResources::get(shader_program)->is_compiled())
+        {
+            LOG_ERROR("Shader program {0} + {1} doesn't compile", vertex_shader_path, fragment_shader_path);
+            GpuResources::destroy(shader_program);
+        }
+        return shader_program;
+    }
+
+}
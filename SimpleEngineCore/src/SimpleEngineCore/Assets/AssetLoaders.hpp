@@ -0,0 +1,30 @@
+#pragma once
+
+#include "AssetArchive.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuResources.hpp"
+
+#include <string_view>
+
+namespace SimpleEngine {
+
+    // GL objects made from AssetArchive entries. Uncompressed entries are uploaded straight from the mapping,
+    // compressed ones are decompressed into a scratch buffer of the calling thread first.
+    // Failures are logged and leave null handles.
+
+    Texture2DHandle load_texture(const AssetArchive& archive, std::string_view path);
+
+    struct MeshHandles
+    {
+        VertexArrayHandle vertex_array;
+        VertexBufferHandle vertex_buffer;
+        IndexBufferHandle index_buffer;
+        float bounds_min[3] = {};
+        float bounds_max[3] = {};
+    };
+
+    // the attributes keep their EMeshAttribute order as vertex attribute locations, absent ones are skipped
+    bool load_mesh(const AssetArchive& archive, std::string_view path, MeshHandles& mesh);
+
+    ShaderProgramHandle load_shader_program(const AssetArchive& archive, std::string_view vertex_shader_path, std::string_view fragment_shader_path);
+
+}
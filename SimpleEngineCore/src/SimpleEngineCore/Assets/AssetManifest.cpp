@@ -0,0 +1,150 @@
+#include "AssetManifest.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace SimpleEngine {
+
+    using namespace AssetArchiveFormat;
+
+    constexpr const char* manifest_magic = "SimpleEngineAssets";
+    constexpr int manifest_version = 1;
+
+    const char* get_asset_type_name(const EAssetType type)
+    {
+        switch (type)
+        {
+            case EAssetType::Raw:     return "raw";
+            case EAssetType::Texture: return "texture";
+            case EAssetType::Mesh:    return "mesh";
+            case EAssetType::Shader:  return "shader";
+        }
+        return "unknown";
+    }
+
+    static bool parse_asset_type(std::string_view name, EAssetType& type)
+    {
+        for (const EAssetType candidate : { EAssetType::Raw, EAssetType::Texture, EAssetType::Mesh, EAssetType::Shader })
+        {
+            if (name == get_asset_type_name(candidate))
+            {
+                type = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool AssetManifest::load(const std::string& path)
+    {
+        close();
+        std::ifstream file(path);
+        if (!file)
+        {
+            LOG_ERROR("AssetManifest: can't open {0}", path);
+            return false;
+        }
+
+        std::string line;
+        std::string magic;
+        int version = 0;
+        if (!std::getline(file, line) || (magic = line.substr(0, line.find(' '))) != manifest_magic
+            || std::sscanf(line.c_str() + magic.size(), "%d", &version) != 1 || version != manifest_version)
+        {
+            LOG_ERROR("AssetManifest: {0} isn't a version {1} manifest", path, manifest_version);
+            return false;
+        }
+        if (!std::getline(file, line) || line.rfind("archive ", 0) != 0)
+        {
+            LOG_ERROR("AssetManifest: {0} doesn't name its archive", path);
+            return false;
+        }
+        m_archive_path = (std::filesystem::path(path).parent_path() / line.substr(8)).string();
+        if (!m_archive.open(m_archive_path))
+        {
+            return false;
+        }
+
+        m_entry_assets.assign(m_archive.get_entries_count(), 0);
+        size_t line_index = 2;
+        while (std::getline(file, line))
+        {
+            ++line_index;
+            if (line.empty())
+            {
+                continue;
+            }
+            // the path is the rest of the line, spaces included
+            const size_t type_end = line.find(' ');
+            const size_t hash_end = type_end == std::string::npos ? std::string::npos : line.find(' ', type_end + 1);
+            Asset asset;
+            if (hash_end == std::string::npos || !parse_asset_type(std::string_view(line).substr(0, type_end), asset.type)
+                || std::sscanf(line.c_str() + type_end + 1, "%" SCNx64, &asset.content_hash) != 1)
+            {
+                LOG_ERROR("AssetManifest: {0}:{1} is malformed", path, line_index);
+                close();
+                return false;
+            }
+            asset.path = line.substr(hash_end + 1);
+            asset.entry = m_archive.find(asset.path);
+            if (asset.entry == AssetArchive::invalid_entry || m_archive.get_entry(asset.entry).type != asset.type)
+            {
+                LOG_ERROR("AssetManifest: {0} lists {1}, the archive doesn't have it", path, asset.path);
+                close();
+                return false;
+            }
+            m_entry_assets[asset.entry] = static_cast<uint32_t>(m_assets.size() + 1);
+            m_assets.push_back(std::move(asset));
+        }
+        LOG_INFO("AssetManifest: {0} assets from {1}", m_assets.size(), path);
+        return true;
+    }
+
+    void AssetManifest::close()
+    {
+        m_archive.close();
+        m_archive_path.clear();
+        m_assets.clear();
+        m_entry_assets.clear();
+    }
+
+    bool AssetManifest::save(const std::string& path, const std::string& archive_name, const std::vector<Asset>& assets)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+        {
+            LOG_ERROR("AssetManifest: can't create {0}", path);
+            return false;
+        }
+        file << manifest_magic << ' ' << manifest_version << '\n';
+        file << "archive " << archive_name << '\n';
+        char hash[17];
+        for (const Asset& asset : assets)
+        {
+            std::snprintf(hash, sizeof(hash), "%016" PRIx64, asset.content_hash);
+            file << get_asset_type_name(asset.type) << ' ' << hash << ' ' << asset.path << '\n';
+        }
+        file.flush();
+        if (!file)
+        {
+            LOG_ERROR("AssetManifest: writing {0} failed", path);
+            return false;
+        }
+        return true;
+    }
+
+    const AssetManifest::Asset* AssetManifest::find(std::string_view path) const
+    {
+        const AssetArchive::EntryIndex entry = m_archive.find(path);
+        if (entry == AssetArchive::invalid_entry || m_entry_assets[entry] == 0)
+        {
+            return nullptr;
+        }
+        return &m_assets[m_entry_assets[entry] - 1];
+    }
+
+}
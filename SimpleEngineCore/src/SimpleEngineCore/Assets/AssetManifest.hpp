@@ -0,0 +1,51 @@
+#pragma once
+
+#include "AssetArchive.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // What SimpleEngineCooker produced: the cooked assets, their types and the hash of everything each was cooked from,
+    // plus the archive holding them. A text file, one asset per line:
+    //     SimpleEngineAssets 1
+    //     archive assets.archive
+    //     <type> <content hash, 16 hex digits> <path>
+    class AssetManifest
+    {
+    public:
+        struct Asset
+        {
+            std::string path;
+            AssetArchiveFormat::EAssetType type = AssetArchiveFormat::EAssetType::Raw;
+            uint64_t content_hash = 0;
+            AssetArchive::EntryIndex entry = AssetArchive::invalid_entry;
+        };
+
+        // opens the archive too, its path is relative to the manifest's directory
+        bool load(const std::string& path);
+        void close();
+        bool is_loaded() const { return m_archive.is_open(); }
+
+        // entry is ignored
+        static bool save(const std::string& path, const std::string& archive_name, const std::vector<Asset>& assets);
+
+        const Asset* find(std::string_view path) const;
+        const std::vector<Asset>& get_assets() const { return m_assets; }
+        const AssetArchive& get_archive() const { return m_archive; }
+        const std::string& get_archive_path() const { return m_archive_path; }
+
+    private:
+        AssetArchive m_archive;
+        std::string m_archive_path;
+        std::vector<Asset> m_assets;
+        // asset index + 1 of every archive entry, 0 when the manifest doesn't list it
+        std::vector<uint32_t> m_entry_assets;
+    };
+
+    const char* get_asset_type_name(const AssetArchiveFormat::EAssetType type);
+
+}
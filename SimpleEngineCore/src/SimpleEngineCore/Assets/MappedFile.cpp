@@ -0,0 +1,168 @@
+#include "MappedFile.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+namespace SimpleEngine {
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& mapped_file) noexcept
+    {
+        *this = std::move(mapped_file);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& mapped_file) noexcept
+    {
+        if (this != &mapped_file)
+        {
+            close();
+            std::swap(m_pData, mapped_file.m_pData);
+            std::swap(m_size, mapped_file.m_size);
+#ifdef _WIN32
+            std::swap(m_file, mapped_file.m_file);
+            std::swap(m_mapping, mapped_file.m_mapping);
+#endif
+        }
+        return *this;
+    }
+
+#ifdef _WIN32
+
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            LOG_ERROR("MappedFile: can't open {0}", path);
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            LOG_ERROR("MappedFile: {0} is empty", path);
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* pData = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!pData)
+        {
+            LOG_ERROR("MappedFile: can't map {0}", path);
+            if (mapping)
+            {
+                CloseHandle(mapping);
+            }
+            CloseHandle(file);
+            return false;
+        }
+        m_file = file;
+        m_mapping = mapping;
+        m_pData = static_cast<const uint8_t*>(pData);
+        m_size = static_cast<size_t>(size.QuadPart);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_pData)
+        {
+            UnmapViewOfFile(m_pData);
+            CloseHandle(m_mapping);
+            CloseHandle(m_file);
+        }
+        m_pData = nullptr;
+        m_size = 0;
+        m_file = nullptr;
+        m_mapping = nullptr;
+    }
+
+    void MappedFile::prefetch(const size_t offset, const size_t size) const
+    {
+        if (!m_pData || offset >= m_size)
+        {
+            return;
+        }
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<uint8_t*>(m_pData + offset);
+        range.NumberOfBytes = std::min(size, m_size - offset);
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+
+#else
+
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+        const int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+        {
+            LOG_ERROR("MappedFile: can't open {0}", path);
+            return false;
+        }
+        struct stat file_stat;
+        if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0)
+        {
+            LOG_ERROR("MappedFile: {0} is empty", path);
+            ::close(file);
+            return false;
+        }
+        const size_t size = static_cast<size_t>(file_stat.st_size);
+        void* pData = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+        // the mapping keeps the file alive
+        ::close(file);
+        if (pData == MAP_FAILED)
+        {
+            LOG_ERROR("MappedFile: can't map {0}", path);
+            return false;
+        }
+        // entries are looked up all over the file, readahead around each fault would mostly read unused pages
+        madvise(pData, size, MADV_RANDOM);
+        m_pData = static_cast<const uint8_t*>(pData);
+        m_size = size;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_pData)
+        {
+            munmap(const_cast<uint8_t*>(m_pData), m_size);
+        }
+        m_pData = nullptr;
+        m_size = 0;
+    }
+
+    void MappedFile::prefetch(const size_t offset, const size_t size) const
+    {
+        if (!m_pData || offset >= m_size)
+        {
+            return;
+        }
+        // madvise wants a page aligned start
+        const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t begin = offset & ~(page_size - 1);
+        const size_t end = std::min(offset + size, m_size);
+        madvise(const_cast<uint8_t*>(m_pData + begin), end - begin, MADV_WILLNEED);
+    }
+
+#endif
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace SimpleEngine {
+
+    // Whole file mapped read-only. Pages are read on first touch and shared with the OS file cache,
+    // so opening costs one open and one mapping whatever the file's size.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& mapped_file) noexcept;
+        MappedFile& operator=(MappedFile&& mapped_file) noexcept;
+
+        bool open(const std::string& path);
+        void close();
+
+        bool is_open() const { return m_pData != nullptr; }
+        const uint8_t* get_data() const { return m_pData; }
+        size_t get_size() const { return m_size; }
+
+        // hints the OS to read the range ahead, e.g. before parsing a block of small entries
+        void prefetch(const size_t offset, const size_t size) const;
+
+    private:
+        const uint8_t* m_pData = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+    };
+
+}
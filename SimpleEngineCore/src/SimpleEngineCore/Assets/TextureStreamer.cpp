@@ -0,0 +1,649 @@
+#include "TextureStreamer.hpp"
+#include "AssetArchiveFormat.hpp"
+
+#include "SimpleEngineCore/Camera.hpp"
+#include "SimpleEngineCore/GpuMemory.hpp"
+#include "SimpleEngineCore/IO/VirtualFileSystem.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SimpleEngine {
+
+    using namespace AssetArchiveFormat;
+    using TextureId = TextureStreamer::TextureId;
+    using RequestId = VirtualFileSystem::RequestId;
+
+    constexpr unsigned int max_mip_levels = 16;
+
+    enum class ETextureState : uint8_t
+    {
+        LoadingHeader,
+        LoadingMips,
+        Resident,
+        Failed
+    };
+
+    struct StreamedTexture
+    {
+        std::string path;
+        Texture2DHandle texture;
+        TextureHeader header{};
+        ETextureState state = ETextureState::LoadingHeader;
+        bool used = false;
+        // set when a read of larger levels failed, the texture keeps what it has
+        bool streaming_failed = false;
+        // the first level of the small mips, it never goes above that
+        unsigned int resident_level = 0;
+        // the finest level this frame's requests need, only valid when requested_frame is the current frame
+        unsigned int wanted_level = 0;
+        uint64_t requested_frame = 0;
+
+        // a read in flight covers the levels [read_first_level, read_end_level)
+        RequestId read = VirtualFileSystem::invalid_request;
+        unsigned int read_first_level = 0;
+        unsigned int read_end_level = 0;
+        uint64_t read_bytes = 0;
+
+        // newly streamed levels are let in one at a time
+        int min_lod = 0;
+        unsigned int fade_counter = 0;
+    };
+
+    struct CompletedRead
+    {
+        RequestId id = VirtualFileSystem::invalid_request;
+        VirtualFileSystem::EReadStatus status = VirtualFileSystem::EReadStatus::Failed;
+        std::vector<uint8_t> data;
+    };
+
+    struct TextureStreamerState
+    {
+        TextureStreamer::Settings settings;
+        bool initialized = false;
+
+        // TextureId i is slot i - 1
+        std::vector<StreamedTexture> textures;
+        std::vector<TextureId> free_ids;
+        std::unordered_map<RequestId, TextureId> reads;
+
+        // filled on the JobSystem workers
+        std::mutex completed_mutex;
+        std::vector<CompletedRead> completed;
+        // completed reads not uploaded yet, oldest first
+        std::vector<CompletedRead> uploads;
+        size_t uploads_begin = 0;
+
+        glm::vec3 camera_position{ 0.f };
+        // pixels one world unit spans at distance 1 (perspective) or anywhere (orthographic)
+        float pixels_per_unit = 0.f;
+        float near_clip_plane = 0.1f;
+        bool perspective = true;
+        uint64_t frame_index = 1;
+
+        uint64_t resident_bytes = 0;
+        uint64_t pending_bytes = 0;
+        uint64_t streamed_in_bytes = 0;
+        uint64_t streamed_out_bytes = 0;
+
+        std::vector<TextureId> candidates;
+        std::vector<TextureId> victims;
+    };
+
+    static TextureStreamerState s_state;
+
+    static uint64_t get_level_bytes(const TextureHeader& header, const unsigned int level)
+    {
+        return static_cast<uint64_t>(std::max(header.width >> level, 1u)) * std::max(header.height >> level, 1u) * 4;
+    }
+
+    // offset of the level in the cooked entry, get_level_offset(mip_levels) is the entry's size
+    static uint64_t get_level_offset(const TextureHeader& header, const unsigned int level)
+    {
+        uint64_t offset = sizeof(TextureHeader);
+        for (unsigned int i = 0; i < level; ++i)
+        {
+            offset += get_level_bytes(header, i);
+        }
+        return offset;
+    }
+
+    // the levels from first_level down
+    static uint64_t get_resident_bytes(const TextureHeader& header, const unsigned int first_level)
+    {
+        return get_level_offset(header, header.mip_levels) - get_level_offset(header, first_level);
+    }
+
+    static StreamedTexture* find_texture(const TextureId id)
+    {
+        if (id == TextureStreamer::invalid_texture || id > s_state.textures.size() || !s_state.textures[id - 1].used)
+        {
+            return nullptr;
+        }
+        return &s_state.textures[id - 1];
+    }
+
+    static void on_read(void*, const VirtualFileSystem::ReadResult& result)
+    {
+        CompletedRead read;
+        read.id = result.id;
+        read.status = result.status;
+        if (result.status == VirtualFileSystem::EReadStatus::Completed)
+        {
+            read.data.assign(result.data, result.data + result.size);
+        }
+        std::lock_guard<std::mutex> lock(s_state.completed_mutex);
+        s_state.completed.push_back(std::move(read));
+    }
+
+    static bool start_read(const TextureId id, StreamedTexture& texture, const uint64_t offset, const uint64_t size, const VirtualFileSystem::EPriority priority)
+    {
+        VirtualFileSystem::ReadRequest request;
+        request.path = texture.path;
+        request.callback = on_read;
+        request.priority = priority;
+        request.offset = offset;
+        request.size = size;
+        texture.read = VirtualFileSystem::read_async(request);
+        if (texture.read == VirtualFileSystem::invalid_request)
+        {
+            return false;
+        }
+        texture.read_bytes = size;
+        s_state.reads.emplace(texture.read, id);
+        s_state.pending_bytes += size;
+        return true;
+    }
+
+    static void cancel_read(StreamedTexture& texture)
+    {
+        if (texture.read == VirtualFileSystem::invalid_request)
+        {
+            return;
+        }
+        VirtualFileSystem::cancel(texture.read);
+        s_state.reads.erase(texture.read);
+        s_state.pending_bytes -= texture.read_bytes;
+        texture.read = VirtualFileSystem::invalid_request;
+        texture.read_bytes = 0;
+    }
+
+    // level_data[0] is first_level, only read for levels not resident yet
+    static void set_first_level(StreamedTexture& texture, const unsigned int first_level, const unsigned char* const* level_data)
+    {
+        Texture2D& gl_texture = *GpuResources::get(texture.texture);
+        const unsigned int old_first_level = gl_texture.get_first_level();
+        if (first_level == old_first_level)
+        {
+            return;
+        }
+        const uint64_t old_bytes = get_resident_bytes(texture.header, old_first_level);
+        const uint64_t new_bytes = get_resident_bytes(texture.header, first_level);
+        gl_texture.set_first_level(first_level, level_data);
+        s_state.resident_bytes = s_state.resident_bytes - old_bytes + new_bytes;
+        if (first_level < old_first_level)
+        {
+            s_state.streamed_in_bytes += new_bytes - old_bytes;
+            // the old first level is now old_first_level - first_level, sampling starts there and moves up
+            texture.min_lod = static_cast<int>(old_first_level - first_level);
+        }
+        else
+        {
+            s_state.streamed_out_bytes += old_bytes - new_bytes;
+            texture.min_lod = std::max(texture.min_lod - static_cast<int>(first_level - old_first_level), 0);
+        }
+        texture.fade_counter = 0;
+        gl_texture.set_min_lod(texture.min_lod);
+    }
+
+    static size_t evict_texture(void* pContext, const size_t)
+    {
+        StreamedTexture* pTexture = find_texture(static_cast<TextureId>(reinterpret_cast<uintptr_t>(pContext)));
+        if (!pTexture || pTexture->state != ETextureState::Resident)
+        {
+            return 0;
+        }
+        // what is read for it would land on storage this is about to drop
+        cancel_read(*pTexture);
+        const uint64_t resident_bytes = s_state.resident_bytes;
+        set_first_level(*pTexture, pTexture->resident_level, nullptr);
+        return static_cast<size_t>(resident_bytes - s_state.resident_bytes);
+    }
+
+    static void destroy_texture(StreamedTexture& texture)
+    {
+        cancel_read(texture);
+        if (texture.texture)
+        {
+            Texture2D& gl_texture = *GpuResources::get(texture.texture);
+            s_state.resident_bytes -= get_resident_bytes(texture.header, gl_texture.get_first_level());
+            // the GL texture outlives the slot until GpuResources deletes it, it mustn't call back into it
+            GpuMemory::set_evict_callback(gl_texture.get_gpu_memory_id(), nullptr, nullptr);
+            GpuResources::destroy(texture.texture);
+        }
+        texture = StreamedTexture();
+    }
+
+    void TextureStreamer::init()
+    {
+        init(Settings());
+    }
+
+    void TextureStreamer::init(const Settings& settings)
+    {
+        s_state.settings = settings;
+        s_state.settings.max_reads_in_flight = std::max(settings.max_reads_in_flight, 1u);
+        s_state.settings.fade_frames = std::max(settings.fade_frames, 1u);
+        {
+            std::lock_guard<std::mutex> lock(s_state.completed_mutex);
+            s_state.completed.clear();
+        }
+        s_state.uploads.clear();
+        s_state.uploads_begin = 0;
+        s_state.initialized = true;
+    }
+
+    void TextureStreamer::shutdown()
+    {
+        if (!s_state.initialized)
+        {
+            return;
+        }
+        for (StreamedTexture& texture : s_state.textures)
+        {
+            if (texture.used)
+            {
+                destroy_texture(texture);
+            }
+        }
+        s_state.textures.clear();
+        s_state.free_ids.clear();
+        s_state.reads.clear();
+        s_state.uploads.clear();
+        s_state.uploads_begin = 0;
+        s_state.resident_bytes = 0;
+        s_state.pending_bytes = 0;
+        s_state.initialized = false;
+    }
+
+    void TextureStreamer::set_budget(const uint64_t bytes)
+    {
+        s_state.settings.budget_bytes = bytes;
+    }
+
+    TextureId TextureStreamer::add_texture(std::string_view path)
+    {
+        TextureId id = invalid_texture;
+        if (!s_state.free_ids.empty())
+        {
+            id = s_state.free_ids.back();
+            s_state.free_ids.pop_back();
+        }
+        else
+        {
+            s_state.textures.emplace_back();
+            id = static_cast<TextureId>(s_state.textures.size());
+        }
+        StreamedTexture& texture = s_state.textures[id - 1];
+        texture.path = path;
+        texture.used = true;
+        if (!start_read(id, texture, 0, sizeof(TextureHeader), VirtualFileSystem::EPriority::High))
+        {
+            LOG_ERROR("TextureStreamer: {0} can't be read, the VirtualFileSystem isn't running", texture.path);
+            texture.state = ETextureState::Failed;
+        }
+        return id;
+    }
+
+    void TextureStreamer::remove_texture(TextureId& id)
+    {
+        StreamedTexture* pTexture = find_texture(id);
+        if (pTexture)
+        {
+            destroy_texture(*pTexture);
+            s_state.free_ids.push_back(id);
+        }
+        id = invalid_texture;
+    }
+
+    void TextureStreamer::begin_frame(Camera& camera)
+    {
+        ++s_state.frame_index;
+        s_state.camera_position = camera.get_position();
+        s_state.pixels_per_unit = camera.get_projection_matrix()[1][1] * camera.get_viewport_height() * 0.5f;
+        s_state.near_clip_plane = camera.get_near_clip_plane();
+        s_state.perspective = camera.get_projection_mode() == Camera::ProjectionMode::Perspective;
+    }
+
+    float TextureStreamer::get_needed_level(const unsigned int width, const unsigned int height, const float pixels_per_uv)
+    {
+        if (pixels_per_uv <= 0.f)
+        {
+            return static_cast<float>(max_mip_levels);
+        }
+        // texels per pixel along the larger side, trilinear filtering samples this level and the next
+        return std::max(std::log2(static_cast<float>(std::max(width, height)) / pixels_per_uv), 0.f);
+    }
+
+    void TextureStreamer::request(const TextureId id, const glm::vec3& bounds_min, const glm::vec3& bounds_max, const float uv_world_size)
+    {
+        StreamedTexture* pTexture = find_texture(id);
+        if (!pTexture || pTexture->state != ETextureState::Resident)
+        {
+            return;
+        }
+        StreamedTexture& texture = *pTexture;
+        const glm::vec3 extent = bounds_max - bounds_min;
+        const float world_size = uv_world_size > 0.f ? uv_world_size : std::max(extent.x, std::max(extent.y, extent.z));
+        float pixels_per_uv = world_size * s_state.pixels_per_unit;
+        if (s_state.perspective)
+        {
+            // the nearest point of the bounds, the camera inside them is as close as it gets
+            const glm::vec3 outside = glm::max(glm::max(bounds_min - s_state.camera_position, s_state.camera_position - bounds_max), glm::vec3(0.f));
+            pixels_per_uv /= std::max(glm::length(outside), s_state.near_clip_plane);
+        }
+        const float level = get_needed_level(texture.header.width, texture.header.height, pixels_per_uv) + s_state.settings.lod_bias;
+        const unsigned int wanted_level = std::min(static_cast<unsigned int>(std::max(level, 0.f)), texture.resident_level);
+        if (texture.requested_frame != s_state.frame_index)
+        {
+            texture.requested_frame = s_state.frame_index;
+            texture.wanted_level = wanted_level;
+        }
+        else
+        {
+            texture.wanted_level = std::min(texture.wanted_level, wanted_level);
+        }
+    }
+
+    bool TextureStreamer::bind(const TextureId id, const unsigned int unit)
+    {
+        const StreamedTexture* pTexture = find_texture(id);
+        if (!pTexture || pTexture->state != ETextureState::Resident)
+        {
+            return false;
+        }
+        GpuResources::get(pTexture->texture)->bind(unit);
+        return true;
+    }
+
+    // the header arrived: reads the small mips
+    static void on_header(const TextureId id, StreamedTexture& texture, const std::vector<uint8_t>& data)
+    {
+        if (data.size() != sizeof(TextureHeader))
+        {
+            LOG_ERROR("TextureStreamer: {0} is truncated", texture.path);
+            texture.state = ETextureState::Failed;
+            return;
+        }
+        std::memcpy(&texture.header, data.data(), sizeof(TextureHeader));
+        const TextureHeader& header = texture.header;
+        const unsigned int largest_side = std::max(header.width, header.height);
+        if (header.format != ETextureFormat::RGBA8 || header.width == 0 || header.height == 0
+            || header.mip_levels == 0 || header.mip_levels > max_mip_levels || (largest_side >> (header.mip_levels - 1)) == 0)
+        {
+            LOG_ERROR("TextureStreamer: {0} isn't a cooked RGBA8 texture", texture.path);
+            texture.state = ETextureState::Failed;
+            return;
+        }
+
+        texture.resident_level = 0;
+        while (texture.resident_level + 1 < header.mip_levels && (largest_side >> texture.resident_level) > s_state.settings.resident_mip_size)
+        {
+            ++texture.resident_level;
+        }
+        texture.state = ETextureState::LoadingMips;
+        texture.read_first_level = texture.resident_level;
+        texture.read_end_level = header.mip_levels;
+        const uint64_t offset = get_level_offset(header, texture.resident_level);
+        if (!start_read(id, texture, offset, get_level_offset(header, header.mip_levels) - offset, VirtualFileSystem::EPriority::High))
+        {
+            texture.state = ETextureState::Failed;
+        }
+    }
+
+    // levels [read_first_level, read_end_level) arrived
+    static void on_levels(const TextureId id, StreamedTexture& texture, const std::vector<uint8_t>& data)
+    {
+        const TextureHeader& header = texture.header;
+        const uint64_t offset = get_level_offset(header, texture.read_first_level);
+        if (data.size() != get_level_offset(header, texture.read_end_level) - offset)
+        {
+            LOG_ERROR("TextureStreamer: {0} is truncated", texture.path);
+            if (texture.state == ETextureState::LoadingMips)
+            {
+                texture.state = ETextureState::Failed;
+            }
+            texture.streaming_failed = true;
+            return;
+        }
+        const unsigned char* level_data[max_mip_levels];
+        for (unsigned int level = texture.read_first_level; level < texture.read_end_level; ++level)
+        {
+            level_data[level - texture.read_first_level] = data.data() + (get_level_offset(header, level) - offset);
+        }
+
+        if (texture.state == ETextureState::LoadingMips)
+        {
+            texture.texture = GpuResources::create<Texture2D>(level_data, header.mip_levels, header.width, header.height, texture.resident_level);
+            const Texture2D& gl_texture = *GpuResources::get(texture.texture);
+            GpuMemory::set_evict_callback(gl_texture.get_gpu_memory_id(), evict_texture, reinterpret_cast<void*>(static_cast<uintptr_t>(id)));
+            s_state.resident_bytes += get_resident_bytes(header, texture.resident_level);
+            texture.state = ETextureState::Resident;
+            return;
+        }
+
+        // evicted below what was read while the read was in flight, the levels in between are missing
+        const unsigned int first_level = GpuResources::get(texture.texture)->get_first_level();
+        if (first_level > texture.read_end_level || first_level <= texture.read_first_level)
+        {
+            return;
+        }
+        set_first_level(texture, texture.read_first_level, level_data);
+    }
+
+    static void upload_completed_reads()
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_state.completed_mutex);
+            for (CompletedRead& read : s_state.completed)
+            {
+                s_state.uploads.push_back(std::move(read));
+            }
+            s_state.completed.clear();
+        }
+
+        uint64_t uploaded_bytes = 0;
+        while (s_state.uploads_begin < s_state.uploads.size() && uploaded_bytes < s_state.settings.upload_bytes_per_frame)
+        {
+            CompletedRead& read = s_state.uploads[s_state.uploads_begin++];
+            const auto found = s_state.reads.find(read.id);
+            // cancelled or removed since
+            if (found == s_state.reads.end())
+            {
+                continue;
+            }
+            const TextureId id = found->second;
+            s_state.reads.erase(found);
+            StreamedTexture& texture = s_state.textures[id - 1];
+            s_state.pending_bytes -= texture.read_bytes;
+            texture.read = VirtualFileSystem::invalid_request;
+            texture.read_bytes = 0;
+
+            if (read.status != VirtualFileSystem::EReadStatus::Completed)
+            {
+                if (read.status == VirtualFileSystem::EReadStatus::Cancelled)
+                {
+                    continue;
+                }
+                LOG_ERROR("TextureStreamer: reading {0} failed: {1}", texture.path, get_read_status_name(read.status));
+                if (texture.state != ETextureState::Resident)
+                {
+                    texture.state = ETextureState::Failed;
+                }
+                texture.streaming_failed = true;
+                continue;
+            }
+            if (texture.state == ETextureState::LoadingHeader)
+            {
+                on_header(id, texture, read.data);
+            }
+            else
+            {
+                on_levels(id, texture, read.data);
+            }
+            uploaded_bytes += read.data.size();
+            // the data isn't needed past the upload
+            std::vector<uint8_t>().swap(read.data);
+        }
+        if (s_state.uploads_begin == s_state.uploads.size())
+        {
+            s_state.uploads.clear();
+            s_state.uploads_begin = 0;
+        }
+    }
+
+    // the first level a texture can drop to: its needed level while it is used, its small mips otherwise
+    static unsigned int get_target_level(const StreamedTexture& texture)
+    {
+        return texture.requested_frame == s_state.frame_index ? texture.wanted_level : texture.resident_level;
+    }
+
+    static void stream()
+    {
+        const TextureStreamer::Settings& settings = s_state.settings;
+        s_state.candidates.clear();
+        s_state.victims.clear();
+        for (size_t i = 0; i < s_state.textures.size(); ++i)
+        {
+            const StreamedTexture& texture = s_state.textures[i];
+            if (!texture.used || texture.state != ETextureState::Resident || texture.read != VirtualFileSystem::invalid_request)
+            {
+                continue;
+            }
+            const unsigned int first_level = GpuResources::get(texture.texture)->get_first_level();
+            const unsigned int target_level = get_target_level(texture);
+            if (target_level < first_level && !texture.streaming_failed)
+            {
+                s_state.candidates.push_back(static_cast<TextureId>(i + 1));
+            }
+            else if (target_level > first_level)
+            {
+                s_state.victims.push_back(static_cast<TextureId>(i + 1));
+            }
+        }
+        // the largest shortfall first, the textures seen closest among equals
+        std::sort(s_state.candidates.begin(), s_state.candidates.end(), [](const TextureId a, const TextureId b)
+            {
+                const StreamedTexture& texture_a = s_state.textures[a - 1];
+                const StreamedTexture& texture_b = s_state.textures[b - 1];
+                const unsigned int shortfall_a = GpuResources::get(texture_a.texture)->get_first_level() - texture_a.wanted_level;
+                const unsigned int shortfall_b = GpuResources::get(texture_b.texture)->get_first_level() - texture_b.wanted_level;
+                return shortfall_a != shortfall_b ? shortfall_a > shortfall_b : texture_a.wanted_level < texture_b.wanted_level;
+            });
+        // the longest unused first
+        std::sort(s_state.victims.begin(), s_state.victims.end(), [](const TextureId a, const TextureId b)
+            {
+                return s_state.textures[a - 1].requested_frame < s_state.textures[b - 1].requested_frame;
+            });
+
+        size_t next_victim = 0;
+        for (const TextureId id : s_state.candidates)
+        {
+            if (s_state.reads.size() >= settings.max_reads_in_flight)
+            {
+                break;
+            }
+            StreamedTexture& texture = s_state.textures[id - 1];
+            const unsigned int first_level = GpuResources::get(texture.texture)->get_first_level();
+            const uint64_t offset = get_level_offset(texture.header, texture.wanted_level);
+            const uint64_t size = get_level_offset(texture.header, first_level) - offset;
+            while (s_state.resident_bytes + s_state.pending_bytes + size > settings.budget_bytes && next_victim < s_state.victims.size())
+            {
+                StreamedTexture& victim = s_state.textures[s_state.victims[next_victim++] - 1];
+                set_first_level(victim, get_target_level(victim), nullptr);
+            }
+            // nothing left to drop, textures needing less could still fit
+            if (s_state.resident_bytes + s_state.pending_bytes + size > settings.budget_bytes)
+            {
+                continue;
+            }
+            texture.read_first_level = texture.wanted_level;
+            texture.read_end_level = first_level;
+            start_read(id, texture, offset, size, texture.wanted_level + 1 < first_level ? VirtualFileSystem::EPriority::Normal : VirtualFileSystem::EPriority::Low);
+        }
+    }
+
+    void TextureStreamer::update()
+    {
+        PROFILE_FUNCTION();
+        if (!s_state.initialized)
+        {
+            return;
+        }
+        upload_completed_reads();
+
+        for (StreamedTexture& texture : s_state.textures)
+        {
+            if (texture.used && texture.state == ETextureState::Resident && texture.min_lod > 0 && ++texture.fade_counter >= s_state.settings.fade_frames)
+            {
+                texture.fade_counter = 0;
+                GpuResources::get(texture.texture)->set_min_lod(--texture.min_lod);
+            }
+        }
+        stream();
+    }
+
+    Texture2DHandle TextureStreamer::get_texture(const TextureId id)
+    {
+        const StreamedTexture* pTexture = find_texture(id);
+        return pTexture && pTexture->state == ETextureState::Resident ? pTexture->texture : Texture2DHandle();
+    }
+
+    TextureStreamer::Stats TextureStreamer::get_stats()
+    {
+        Stats stats;
+        stats.resident_bytes = s_state.resident_bytes;
+        stats.pending_bytes = s_state.pending_bytes;
+        stats.budget_bytes = s_state.settings.budget_bytes;
+        stats.streamed_in_bytes = s_state.streamed_in_bytes;
+        stats.streamed_out_bytes = s_state.streamed_out_bytes;
+        for (const StreamedTexture& texture : s_state.textures)
+        {
+            if (!texture.used)
+            {
+                continue;
+            }
+            ++stats.textures_count;
+            switch (texture.state)
+            {
+                case ETextureState::LoadingHeader:
+                case ETextureState::LoadingMips:
+                    ++stats.loading_count;
+                    break;
+                case ETextureState::Resident:
+                    stats.wanted_bytes += get_resident_bytes(texture.header, get_target_level(texture));
+                    break;
+                case ETextureState::Failed:
+                    ++stats.failed_count;
+                    break;
+            }
+        }
+        return stats;
+    }
+
+    const TextureStreamer::Settings& TextureStreamer::get_settings()
+    {
+        return s_state.settings;
+    }
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "SimpleEngineCore/Rendering/OpenGL/GpuResources.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace SimpleEngine {
+
+    class Camera;
+
+    // Mip streaming of cooked textures read through the VirtualFileSystem. A texture starts with its small mips only,
+    // every level whose larger side is at most resident_mip_size; the larger levels are read when the objects using
+    // the texture get close enough to need them and dropped again when the budget runs short.
+    //
+    // Each frame the renderer reports where the textures are used: begin_frame(), request() per draw with the object's
+    // bounds, then update() once the frame is drawn. The needed level comes from the texels a pixel covers at the point
+    // of the bounds nearest to the camera. The GL textures only allocate their resident levels, streaming in or out
+    // reallocates them and copies the levels kept on the GPU; newly streamed levels are faded in one level at a time
+    // through GL_TEXTURE_MIN_LOD. Textures are also GpuMemory eviction candidates, dropping back to their small mips.
+    //
+    // The mips are read as one range of the entry, which is cheap for entries stored uncompressed; compressed ones
+    // are decompressed whole on a JobSystem worker every time. GL context thread only.
+    class TextureStreamer
+    {
+    public:
+        using TextureId = uint32_t;
+        static constexpr TextureId invalid_texture = 0;
+
+        struct Settings
+        {
+            uint64_t budget_bytes = 256ull * 1024 * 1024;
+            // levels up to this size stay resident from the load on
+            unsigned int resident_mip_size = 64;
+            // mips uploaded per frame, a completed read larger than that still goes out whole
+            uint64_t upload_bytes_per_frame = 16ull * 1024 * 1024;
+            unsigned int max_reads_in_flight = 32;
+            // frames between the fade steps of newly streamed levels
+            unsigned int fade_frames = 4;
+            // added to the needed level, positive values trade sharpness for memory
+            float lod_bias = 0.f;
+        };
+
+        struct Stats
+        {
+            size_t textures_count = 0;
+            // textures waiting for their first mips
+            size_t loading_count = 0;
+            size_t failed_count = 0;
+            uint64_t resident_bytes = 0;
+            // requested, read or waiting for upload
+            uint64_t pending_bytes = 0;
+            // what the visible textures would take at their needed levels
+            uint64_t wanted_bytes = 0;
+            uint64_t budget_bytes = 0;
+            uint64_t streamed_in_bytes = 0;
+            uint64_t streamed_out_bytes = 0;
+        };
+
+        static void init();
+        static void init(const Settings& settings);
+        // destroys the textures, reads in flight are cancelled
+        static void shutdown();
+        static void set_budget(const uint64_t bytes);
+
+        // starts reading the texture's small mips, it can't be bound before they are uploaded
+        static TextureId add_texture(std::string_view path);
+        static void remove_texture(TextureId& id);
+
+        static void begin_frame(Camera& camera);
+        // uv_world_size: world units a UV range of 1 covers on the object, 0 for the bounds' largest side
+        static void request(const TextureId id, const glm::vec3& bounds_min, const glm::vec3& bounds_max, const float uv_world_size = 0.f);
+        // false while the texture isn't loaded, nothing is bound then
+        static bool bind(const TextureId id, const unsigned int unit);
+        // uploads the finished reads, then starts new ones and makes room for them within the budget
+        static void update();
+
+        // null while the texture isn't loaded
+        static Texture2DHandle get_texture(const TextureId id);
+        static Stats get_stats();
+        static const Settings& get_settings();
+
+        // the mip level sampled where a UV range of 1 spans pixels_per_uv pixels on screen, fractional
+        static float get_needed_level(const unsigned int width, const unsigned int height, const float pixels_per_uv);
+    };
+
+}
@@ -0,0 +1,154 @@
+#include "SimpleEngineCore/BakeScene.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SimpleEngine {
+
+    constexpr float ray_offset = 1e-3f;
+
+    void make_orthonormal_basis(const glm::vec3& normal, glm::vec3& tangent, glm::vec3& bitangent)
+    {
+        const float sign = std::copysign(1.f, normal.z);
+        const float a = -1.f / (sign + normal.z);
+        const float b = normal.x * normal.y * a;
+        tangent = glm::vec3(1.f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+        bitangent = glm::vec3(b, sign + normal.y * normal.y * a, -normal.y);
+    }
+
+    glm::vec3 sample_cosine_hemisphere(const glm::vec3& normal, BakeRandom& random)
+    {
+        const float radius = std::sqrt(random.next());
+        const float angle = glm::two_pi<float>() * random.next();
+        const float x = radius * std::cos(angle);
+        const float y = radius * std::sin(angle);
+        glm::vec3 tangent;
+        glm::vec3 bitangent;
+        make_orthonormal_basis(normal, tangent, bitangent);
+        return tangent * x + bitangent * y + normal * std::sqrt(std::max(0.f, 1.f - x * x - y * y));
+    }
+
+    static float smoothstep(const float edge0, const float edge1, const float x)
+    {
+        const float t = std::clamp((x - edge0) / (edge1 - edge0), 0.f, 1.f);
+        return t * t * (3.f - 2.f * t);
+    }
+
+    void BakeScene::build(const std::vector<glm::vec3>& vertices, const DirectionalLight& directional_light, const std::vector<SpotLight>& spot_lights, const Settings& settings)
+    {
+        m_settings = settings;
+        m_directional_light = directional_light;
+        m_spot_lights = spot_lights;
+        m_bvh.build(vertices);
+        m_triangle_normals.resize(vertices.size() / 3);
+        for (size_t i = 0; i < m_triangle_normals.size(); ++i)
+        {
+            const glm::vec3 normal = glm::cross(vertices[3 * i + 1] - vertices[3 * i], vertices[3 * i + 2] - vertices[3 * i]);
+            const float length = glm::length(normal);
+            m_triangle_normals[i] = length > 0.f ? normal / length : glm::vec3(0.f, 0.f, 1.f);
+        }
+    }
+
+    glm::vec3 BakeScene::sample_indirect_irradiance(const glm::vec3& position, const glm::vec3& normal, const uint32_t bounces, BakeRandom& random, uint64_t& rays_count) const
+    {
+        // cosine sampling cancels the cosine and pi of the irradiance integral, leaving albedo * irradiance at the hit
+        glm::vec3 irradiance(0.f);
+        glm::vec3 throughput(1.f);
+        glm::vec3 current_position = position;
+        glm::vec3 current_normal = normal;
+        for (uint32_t bounce = 0; bounce < bounces; ++bounce)
+        {
+            const glm::vec3 origin = current_position + current_normal * ray_offset;
+            const glm::vec3 direction = sample_cosine_hemisphere(current_normal, random);
+            TriangleBvh::Hit hit;
+            ++rays_count;
+            if (!m_bvh.intersect(origin, direction, std::numeric_limits<float>::max(), hit))
+            {
+                irradiance += throughput * m_settings.sky_color;
+                break;
+            }
+            const glm::vec3& hit_normal = m_triangle_normals[hit.triangle];
+            if (glm::dot(hit_normal, direction) > 0.f)
+            {
+                // a back face: the path started inside other geometry
+                break;
+            }
+            current_position = origin + direction * hit.distance;
+            current_normal = hit_normal;
+            throughput *= m_settings.albedo;
+            irradiance += throughput * direct_irradiance(current_position, current_normal, rays_count);
+        }
+        return irradiance;
+    }
+
+    glm::vec3 BakeScene::sample_incoming_radiance(const glm::vec3& origin, const glm::vec3& direction, BakeRandom& random, uint64_t& rays_count) const
+    {
+        TriangleBvh::Hit hit;
+        ++rays_count;
+        if (!m_bvh.intersect(origin, direction, std::numeric_limits<float>::max(), hit))
+        {
+            return m_settings.sky_color / glm::pi<float>();
+        }
+        const glm::vec3& hit_normal = m_triangle_normals[hit.triangle];
+        if (glm::dot(hit_normal, direction) > 0.f)
+        {
+            return glm::vec3(0.f);
+        }
+        const glm::vec3 hit_position = origin + direction * hit.distance;
+        glm::vec3 irradiance = direct_irradiance(hit_position, hit_normal, rays_count);
+        if (m_settings.max_bounces > 1)
+        {
+            irradiance += sample_indirect_irradiance(hit_position, hit_normal, m_settings.max_bounces - 1, random, rays_count);
+        }
+        // radiance leaving a diffuse surface
+        return irradiance * (m_settings.albedo / glm::pi<float>());
+    }
+
+    glm::vec3 BakeScene::direct_irradiance(const glm::vec3& position, const glm::vec3& normal, uint64_t& rays_count) const
+    {
+        glm::vec3 irradiance(0.f);
+        const glm::vec3 origin = position + normal * ray_offset;
+
+        const glm::vec3 to_sun = -glm::normalize(m_directional_light.direction);
+        const float sun_cos = glm::dot(normal, to_sun);
+        if (sun_cos > 0.f)
+        {
+            ++rays_count;
+            if (!m_bvh.occluded(origin, to_sun, std::numeric_limits<float>::max()))
+            {
+                irradiance += m_directional_light.color * m_directional_light.intensity * sun_cos;
+            }
+        }
+
+        for (const SpotLight& light : m_spot_lights)
+        {
+            const glm::vec3 to_light = light.position - origin;
+            const float light_distance = glm::length(to_light);
+            if (light_distance >= light.range || light_distance <= 0.f)
+            {
+                continue;
+            }
+            const glm::vec3 light_dir = to_light / light_distance;
+            const float cone = smoothstep(std::cos(glm::radians(light.outer_angle)), std::cos(glm::radians(light.inner_angle)),
+                                          glm::dot(-light_dir, glm::normalize(light.direction)));
+            const float cos_angle = glm::dot(normal, light_dir);
+            if (cone <= 0.f || cos_angle <= 0.f)
+            {
+                continue;
+            }
+            ++rays_count;
+            if (m_bvh.occluded(origin, light_dir, light_distance))
+            {
+                continue;
+            }
+            const float window = std::clamp(1.f - std::pow(light_distance / light.range, 4.f), 0.f, 1.f);
+            irradiance += light.color * light.intensity * cone * window * window / (light_distance * light_distance + 1.f) * cos_angle;
+        }
+        return irradiance;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "SimpleEngineCore/DirectionalLight.hpp"
+#include "SimpleEngineCore/SpotLight.hpp"
+#include "SimpleEngineCore/Math/TriangleBvh.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // PCG hash: bakers give every texel or probe its own stream, so results do not depend on threading
+    class BakeRandom
+    {
+    public:
+        explicit BakeRandom(const uint32_t seed) : m_state(seed) {}
+
+        float next()
+        {
+            m_state = m_state * 747796405u + 2891336453u;
+            uint32_t word = ((m_state >> ((m_state >> 28u) + 4u)) ^ m_state) * 277803737u;
+            word = (word >> 22u) ^ word;
+            return (word >> 8) * (1.f / 16777216.f);
+        }
+
+    private:
+        uint32_t m_state;
+    };
+
+    // Duff et al., "Building an Orthonormal Basis, Revisited"
+    void make_orthonormal_basis(const glm::vec3& normal, glm::vec3& tangent, glm::vec3& bitangent);
+    glm::vec3 sample_cosine_hemisphere(const glm::vec3& normal, BakeRandom& random);
+
+    // Static world space geometry and the lights bouncing off it, shared by the CPU bakers.
+    // Surfaces are diffuse with one albedo; lights use the real-time falloff with shadow rays.
+    class BakeScene
+    {
+    public:
+        struct Settings
+        {
+            uint32_t max_bounces = 2;
+            float albedo = 0.7f;
+            // irradiance from rays leaving the scene
+            glm::vec3 sky_color{ 0.25f, 0.3f, 0.4f };
+        };
+
+        // three vertices per triangle
+        void build(const std::vector<glm::vec3>& vertices, const DirectionalLight& directional_light, const std::vector<SpotLight>& spot_lights, const Settings& settings);
+
+        // one-path estimate of the irradiance at a surface point from light bounced at most `bounces` times
+        glm::vec3 sample_indirect_irradiance(const glm::vec3& position, const glm::vec3& normal, const uint32_t bounces, BakeRandom& random, uint64_t& rays_count) const;
+        // one-path estimate of the radiance arriving at origin from direction
+        glm::vec3 sample_incoming_radiance(const glm::vec3& origin, const glm::vec3& direction, BakeRandom& random, uint64_t& rays_count) const;
+
+        size_t get_triangles_count() const { return m_bvh.get_triangles_count(); }
+        const Settings& get_settings() const { return m_settings; }
+
+    private:
+        glm::vec3 direct_irradiance(const glm::vec3& position, const glm::vec3& normal, uint64_t& rays_count) const;
+
+        Settings m_settings;
+        DirectionalLight m_directional_light;
+        std::vector<SpotLight> m_spot_lights;
+        TriangleBvh m_bvh;
+        std::vector<glm::vec3> m_triangle_normals;
+    };
+
+}
@@ -1,4 +1,5 @@
 #include "SimpleEngineCore/Camera.hpp"
+#include "SimpleEngineCore/Math/BatchMath.hpp"
 
 #include <glm/trigonometric.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -27,20 +28,22 @@ namespace SimpleEngine {
 
     void Camera::update_view_matrix()
     {
-        const float roll_in_radians  = glm::radians(m_rotation.x);
-        const float pitch_in_radians = glm::radians(m_rotation.y);
-        const float yaw_in_radians   = glm::radians(m_rotation.z);
+        // roll, pitch, yaw
+        const float angles_in_radians[3] = { glm::radians(m_rotation.x), glm::radians(m_rotation.y), glm::radians(m_rotation.z) };
+        float s[3];
+        float c[3];
+        BatchMath::sincos(angles_in_radians, s, c, 3);
 
         const glm::mat3 rotate_matrix_x(1, 0, 0,
-            0, cos(roll_in_radians), sin(roll_in_radians),
-            0, -sin(roll_in_radians), cos(roll_in_radians));
+            0, c[0], s[0],
+            0, -s[0], c[0]);
 
-        const glm::mat3 rotate_matrix_y(cos(pitch_in_radians), 0, -sin(pitch_in_radians),
+        const glm::mat3 rotate_matrix_y(c[1], 0, -s[1],
             0, 1, 0,
-            sin(pitch_in_radians), 0, cos(pitch_in_radians));
+            s[1], 0, c[1]);
 
-        const glm::mat3 rotate_matrix_z(cos(yaw_in_radians), sin(yaw_in_radians), 0,
-            -sin(yaw_in_radians), cos(yaw_in_radians), 0,
+        const glm::mat3 rotate_matrix_z(c[2], s[2], 0,
+            -s[2], c[2], 0,
             0, 0, 1);
 
         const glm::mat3 euler_rotate_matrix = rotate_matrix_z * rotate_matrix_y * rotate_matrix_x;
@@ -0,0 +1,58 @@
+#include "SimpleEngineCore/Event.hpp"
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+    EventBus::SubscriptionId EventBus::add_listener(const EventType type, const GenericCallback callback, void* pContext, const int priority)
+    {
+        std::vector<Listener>& listeners = m_listeners[static_cast<size_t>(type)];
+        // after the listeners of the same priority, so equal priorities keep their subscription order
+        const auto position = std::upper_bound(listeners.begin(), listeners.end(), priority,
+            [](const int priority, const Listener& listener)
+            {
+                return priority > listener.priority;
+            });
+        const SubscriptionId id = m_next_subscription_id++;
+        listeners.insert(position, Listener{ callback, pContext, priority, id });
+        return id;
+    }
+
+    void EventBus::unsubscribe(const SubscriptionId id)
+    {
+        for (std::vector<Listener>& listeners : m_listeners)
+        {
+            const auto it = std::find_if(listeners.begin(), listeners.end(),
+                [id](const Listener& listener)
+                {
+                    return listener.id == id;
+                });
+            if (it != listeners.end())
+            {
+                listeners.erase(it);
+                return;
+            }
+        }
+    }
+
+    void EventBus::dispatch_queued()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            std::swap(m_queue, m_dispatched_queue);
+            m_coalesce_indices.fill(s_no_index);
+        }
+        for (const QueuedEvent& queued_event : m_dispatched_queue)
+        {
+            std::visit([this](const auto& event) { dispatch(event); }, queued_event);
+        }
+        m_dispatched_queue.clear();
+    }
+
+    uint64_t EventBus::get_coalesced_count() const
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        return m_coalesced_count;
+    }
+
+}
@@ -0,0 +1,238 @@
+#include "SimpleEngineCore/FrameTimeHarness.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+
+namespace SimpleEngine {
+
+    FrameTimeHarness::FrameTimeHarness(Settings settings)
+        : m_settings(std::move(settings))
+    {
+        m_cpu_times_ms.reserve(m_settings.frames_count);
+        m_gpu_times_ms.reserve(m_settings.frames_count);
+        m_heap_allocations_counts.reserve(m_settings.frames_count);
+    }
+
+
+    FrameTimeHarness::CameraKeyframe FrameTimeHarness::get_camera(const uint32_t frame) const
+    {
+        const std::vector<CameraKeyframe>& path = m_settings.camera_path;
+        if (path.empty())
+        {
+            return CameraKeyframe();
+        }
+        if (path.size() == 1 || m_settings.frames_count < 2)
+        {
+            return path.front();
+        }
+
+        // the first and last keyframes land exactly on the first and last recorded frames
+        const float t = static_cast<float>(std::min(frame, m_settings.frames_count - 1)) / (m_settings.frames_count - 1) * (path.size() - 1);
+        const size_t segment = std::min(static_cast<size_t>(t), path.size() - 2);
+        const float blend = t - segment;
+        CameraKeyframe keyframe;
+        keyframe.position = path[segment].position + (path[segment + 1].position - path[segment].position) * blend;
+        keyframe.rotation = path[segment].rotation + (path[segment + 1].rotation - path[segment].rotation) * blend;
+        return keyframe;
+    }
+
+
+    void FrameTimeHarness::record_frame(const double cpu_time_ms, const double gpu_time_ms, const uint64_t heap_allocations_count)
+    {
+        if (is_finished())
+        {
+            return;
+        }
+        m_cpu_times_ms.push_back(cpu_time_ms);
+        m_gpu_times_ms.push_back(gpu_time_ms);
+        m_heap_allocations_counts.push_back(heap_allocations_count);
+    }
+
+
+    FrameTimeHarness::Distribution FrameTimeHarness::make_distribution(std::vector<double> times_ms, const double hitch_factor)
+    {
+        Distribution distribution;
+        if (times_ms.empty())
+        {
+            return distribution;
+        }
+        std::sort(times_ms.begin(), times_ms.end());
+
+        // nearest rank, so every percentile is a frame time that really happened
+        const auto percentile = [&times_ms](const double p)
+        {
+            const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * times_ms.size()));
+            return times_ms[std::max<size_t>(rank, 1) - 1];
+        };
+        distribution.p50_ms = percentile(50.0);
+        distribution.p95_ms = percentile(95.0);
+        distribution.p99_ms = percentile(99.0);
+        distribution.max_ms = times_ms.back();
+        distribution.mean_ms = std::accumulate(times_ms.begin(), times_ms.end(), 0.0) / times_ms.size();
+
+        const double hitch_ms = distribution.p50_ms * hitch_factor;
+        distribution.hitches_count = static_cast<size_t>(times_ms.end() - std::upper_bound(times_ms.begin(), times_ms.end(), hitch_ms));
+        return distribution;
+    }
+
+
+    FrameTimeHarness::Report FrameTimeHarness::make_report() const
+    {
+        Report report;
+        report.frames_count = m_cpu_times_ms.size();
+        report.cpu = make_distribution(m_cpu_times_ms, m_settings.hitch_factor);
+        report.gpu = make_distribution(m_gpu_times_ms, m_settings.hitch_factor);
+        for (const uint64_t heap_allocations_count : m_heap_allocations_counts)
+        {
+            report.frames_with_heap_allocations_count += heap_allocations_count > 0 ? 1 : 0;
+            report.max_heap_allocations_per_frame = std::max(report.max_heap_allocations_per_frame, heap_allocations_count);
+        }
+        return report;
+    }
+
+
+    static void write_distribution(std::ofstream& file, const char* name, const FrameTimeHarness::Distribution& distribution)
+    {
+        file << "  \"" << name << "\": {"
+             << "\"p50_ms\": " << distribution.p50_ms
+             << ", \"p95_ms\": " << distribution.p95_ms
+             << ", \"p99_ms\": " << distribution.p99_ms
+             << ", \"max_ms\": " << distribution.max_ms
+             << ", \"mean_ms\": " << distribution.mean_ms
+             << ", \"hitches\": " << distribution.hitches_count << "},\n";
+    }
+
+
+    static void write_times(std::ofstream& file, const char* name, const std::vector<double>& times_ms, const bool last)
+    {
+        file << "  \"" << name << "\": [";
+        for (size_t i = 0; i < times_ms.size(); ++i)
+        {
+            file << (i == 0 ? "" : ", ") << times_ms[i];
+        }
+        file << (last ? "]\n" : "],\n");
+    }
+
+
+    bool FrameTimeHarness::save_report(const Report& report, const std::string& path) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        file.precision(4);
+        file << std::fixed;
+        file << "{\n";
+        file << "  \"frames\": " << report.frames_count << ",\n";
+        file << "  \"scene\": {\"cubes\": " << m_settings.cubes_count
+             << ", \"lights\": " << m_settings.lights_count
+             << ", \"textures\": " << m_settings.textures_count
+             << ", \"width\": " << m_settings.width
+             << ", \"height\": " << m_settings.height << "},\n";
+        file << "  \"hitch_factor\": " << m_settings.hitch_factor << ",\n";
+        write_distribution(file, "cpu", report.cpu);
+        write_distribution(file, "gpu", report.gpu);
+        file << "  \"heap_allocations\": {\"frames\": " << report.frames_with_heap_allocations_count
+             << ", \"max_per_frame\": " << report.max_heap_allocations_per_frame << "},\n";
+        write_times(file, "cpu_frame_times_ms", m_cpu_times_ms, false);
+        write_times(file, "gpu_frame_times_ms", m_gpu_times_ms, true);
+        file << "}\n";
+        return file.good();
+    }
+
+
+    // only understands the layout save_report writes: finds the section object, then the key inside it
+    static bool read_number(const std::string& json, const char* section, const char* key, double& value)
+    {
+        size_t position = 0;
+        if (section)
+        {
+            position = json.find(std::string("\"") + section + "\"");
+            if (position == std::string::npos)
+            {
+                return false;
+            }
+        }
+        position = json.find(std::string("\"") + key + "\"", position);
+        if (position == std::string::npos)
+        {
+            return false;
+        }
+        position = json.find(':', position);
+        if (position == std::string::npos)
+        {
+            return false;
+        }
+        const char* begin = json.c_str() + position + 1;
+        char* end = nullptr;
+        value = std::strtod(begin, &end);
+        return end != begin;
+    }
+
+
+    static bool read_distribution(const std::string& json, const char* section, FrameTimeHarness::Distribution& distribution)
+    {
+        double hitches = 0.0;
+        const bool read = read_number(json, section, "p50_ms", distribution.p50_ms)
+            && read_number(json, section, "p95_ms", distribution.p95_ms)
+            && read_number(json, section, "p99_ms", distribution.p99_ms)
+            && read_number(json, section, "max_ms", distribution.max_ms)
+            && read_number(json, section, "mean_ms", distribution.mean_ms)
+            && read_number(json, section, "hitches", hitches);
+        distribution.hitches_count = static_cast<size_t>(hitches);
+        return read;
+    }
+
+
+    bool FrameTimeHarness::load_report(const std::string& path, Report& report)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        const std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        double frames = 0.0;
+        if (!read_number(json, nullptr, "frames", frames))
+        {
+            return false;
+        }
+        report.frames_count = static_cast<size_t>(frames);
+        return read_distribution(json, "cpu", report.cpu) && read_distribution(json, "gpu", report.gpu);
+    }
+
+
+    std::vector<std::string> FrameTimeHarness::compare(const Report& report, const Report& baseline, const double threshold, const size_t allowed_extra_hitches)
+    {
+        // max and mean are reported but not checked, a single outlier frame would make the check flaky
+        std::vector<std::string> regressions;
+        const auto check_time = [&](const char* name, const double value, const double baseline_value)
+        {
+            if (value > baseline_value * (1.0 + threshold))
+            {
+                regressions.push_back(name);
+            }
+        };
+        const auto check_distribution = [&](const char* p50, const char* p95, const char* p99, const char* hitches,
+                                            const Distribution& distribution, const Distribution& baseline_distribution)
+        {
+            check_time(p50, distribution.p50_ms, baseline_distribution.p50_ms);
+            check_time(p95, distribution.p95_ms, baseline_distribution.p95_ms);
+            check_time(p99, distribution.p99_ms, baseline_distribution.p99_ms);
+            if (distribution.hitches_count > baseline_distribution.hitches_count * (1.0 + threshold) + allowed_extra_hitches)
+            {
+                regressions.push_back(hitches);
+            }
+        };
+        check_distribution("cpu.p50_ms", "cpu.p95_ms", "cpu.p99_ms", "cpu.hitches", report.cpu, baseline.cpu);
+        check_distribution("gpu.p50_ms", "gpu.p95_ms", "gpu.p99_ms", "gpu.hitches", report.gpu, baseline.gpu);
+        return regressions;
+    }
+}
@@ -0,0 +1,153 @@
+#include "IoUring.hpp"
+
+#ifdef SIMPLE_ENGINE_IO_URING
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+namespace SimpleEngine {
+
+    IoUring::~IoUring()
+    {
+        shutdown();
+    }
+
+    bool IoUring::init(const unsigned int entries)
+    {
+        shutdown();
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        const int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd < 0)
+        {
+            return false;
+        }
+        m_ring_fd = ring_fd;
+
+        m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+        m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        // since 5.4 both rings share one mapping
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap)
+        {
+            m_sq_ring_size = m_cq_ring_size = m_sq_ring_size > m_cq_ring_size ? m_sq_ring_size : m_cq_ring_size;
+        }
+        m_pSqRing = mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQ_RING);
+        if (m_pSqRing == MAP_FAILED)
+        {
+            m_pSqRing = nullptr;
+            shutdown();
+            return false;
+        }
+        if (single_mmap)
+        {
+            m_pCqRing = m_pSqRing;
+        }
+        else
+        {
+            m_pCqRing = mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_CQ_RING);
+            if (m_pCqRing == MAP_FAILED)
+            {
+                m_pCqRing = nullptr;
+                shutdown();
+                return false;
+            }
+        }
+        m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* pSqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+        if (pSqes == MAP_FAILED)
+        {
+            shutdown();
+            return false;
+        }
+        m_pSqes = static_cast<io_uring_sqe*>(pSqes);
+
+        uint8_t* pSqRing = static_cast<uint8_t*>(m_pSqRing);
+        m_pSqHead = reinterpret_cast<unsigned int*>(pSqRing + params.sq_off.head);
+        m_pSqTail = reinterpret_cast<unsigned int*>(pSqRing + params.sq_off.tail);
+        m_sq_mask = *reinterpret_cast<unsigned int*>(pSqRing + params.sq_off.ring_mask);
+        m_sq_entries = params.sq_entries;
+        // slot i of the ring always points at entry i, entries are used in ring order
+        unsigned int* pSqArray = reinterpret_cast<unsigned int*>(pSqRing + params.sq_off.array);
+        for (unsigned int i = 0; i < m_sq_entries; ++i)
+        {
+            pSqArray[i] = i;
+        }
+        m_sqe_tail = *m_pSqTail;
+
+        uint8_t* pCqRing = static_cast<uint8_t*>(m_pCqRing);
+        m_pCqHead = reinterpret_cast<unsigned int*>(pCqRing + params.cq_off.head);
+        m_pCqTail = reinterpret_cast<unsigned int*>(pCqRing + params.cq_off.tail);
+        m_cq_mask = *reinterpret_cast<unsigned int*>(pCqRing + params.cq_off.ring_mask);
+        m_pCqes = reinterpret_cast<io_uring_cqe*>(pCqRing + params.cq_off.cqes);
+        return true;
+    }
+
+    void IoUring::shutdown()
+    {
+        if (m_pSqes)
+        {
+            munmap(m_pSqes, m_sqes_size);
+        }
+        if (m_pCqRing && m_pCqRing != m_pSqRing)
+        {
+            munmap(m_pCqRing, m_cq_ring_size);
+        }
+        if (m_pSqRing)
+        {
+            munmap(m_pSqRing, m_sq_ring_size);
+        }
+        if (m_ring_fd >= 0)
+        {
+            close(m_ring_fd);
+        }
+        m_ring_fd = -1;
+        m_pSqRing = nullptr;
+        m_pCqRing = nullptr;
+        m_pSqes = nullptr;
+        m_pSqHead = m_pSqTail = m_pCqHead = m_pCqTail = nullptr;
+        m_pCqes = nullptr;
+        m_sq_entries = 0;
+    }
+
+    io_uring_sqe* IoUring::get_sqe()
+    {
+        const unsigned int head = __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE);
+        if (m_sqe_tail - head >= m_sq_entries)
+        {
+            return nullptr;
+        }
+        io_uring_sqe* pSqe = &m_pSqes[m_sqe_tail & m_sq_mask];
+        ++m_sqe_tail;
+        std::memset(pSqe, 0, sizeof(io_uring_sqe));
+        return pSqe;
+    }
+
+    int IoUring::submit(const unsigned int wait_count)
+    {
+        // the entries have to be written before the kernel sees the new tail
+        __atomic_store_n(m_pSqTail, m_sqe_tail, __ATOMIC_RELEASE);
+        const unsigned int to_submit = m_sqe_tail - __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE);
+        const unsigned int flags = wait_count > 0 ? IORING_ENTER_GETEVENTS : 0;
+        while (true)
+        {
+            const int result = static_cast<int>(syscall(__NR_io_uring_enter, m_ring_fd, to_submit, wait_count, flags, nullptr, 0));
+            if (result >= 0)
+            {
+                return result;
+            }
+            if (errno != EINTR)
+            {
+                return -errno;
+            }
+        }
+    }
+
+}
+
+#endif
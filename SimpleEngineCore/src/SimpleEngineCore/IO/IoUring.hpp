@@ -0,0 +1,74 @@
+#pragma once
+
+#ifdef SIMPLE_ENGINE_IO_URING
+
+#include <linux/io_uring.h>
+
+#include <cstddef>
+
+namespace SimpleEngine {
+
+    // io_uring through the raw system calls, without liburing. A single thread fills the submission queue
+    // and reaps the completions, so the only synchronization is with the kernel.
+    class IoUring
+    {
+    public:
+        IoUring() = default;
+        ~IoUring();
+
+        IoUring(const IoUring&) = delete;
+        IoUring& operator=(const IoUring&) = delete;
+
+        // false when the kernel doesn't have io_uring or doesn't allow it (seccomp, io_uring_disabled)
+        bool init(const unsigned int entries);
+        void shutdown();
+        bool is_initialized() const { return m_ring_fd >= 0; }
+
+        // a zeroed entry, nullptr when the submission queue is full
+        io_uring_sqe* get_sqe();
+        // hands the prepared entries to the kernel and waits until wait_count completions are available.
+        // Returns the number of entries the kernel took or -errno
+        int submit(const unsigned int wait_count);
+
+        // calls handler(const io_uring_cqe&) for every available completion, returns how many there were
+        template<typename F>
+        unsigned int reap(F&& handler)
+        {
+            unsigned int head = *m_pCqHead;
+            const unsigned int tail = __atomic_load_n(m_pCqTail, __ATOMIC_ACQUIRE);
+            const unsigned int count = tail - head;
+            for (; head != tail; ++head)
+            {
+                handler(m_pCqes[head & m_cq_mask]);
+            }
+            __atomic_store_n(m_pCqHead, head, __ATOMIC_RELEASE);
+            return count;
+        }
+
+        unsigned int get_entries_count() const { return m_sq_entries; }
+
+    private:
+        int m_ring_fd = -1;
+        void* m_pSqRing = nullptr;
+        size_t m_sq_ring_size = 0;
+        void* m_pCqRing = nullptr;
+        size_t m_cq_ring_size = 0;
+        io_uring_sqe* m_pSqes = nullptr;
+        size_t m_sqes_size = 0;
+
+        unsigned int* m_pSqHead = nullptr;
+        unsigned int* m_pSqTail = nullptr;
+        unsigned int m_sq_mask = 0;
+        unsigned int m_sq_entries = 0;
+        // entries handed out by get_sqe(), published to the kernel by submit()
+        unsigned int m_sqe_tail = 0;
+
+        unsigned int* m_pCqHead = nullptr;
+        unsigned int* m_pCqTail = nullptr;
+        unsigned int m_cq_mask = 0;
+        io_uring_cqe* m_pCqes = nullptr;
+    };
+
+}
+
+#endif
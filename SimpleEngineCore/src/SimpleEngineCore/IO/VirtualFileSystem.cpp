@@ -0,0 +1,992 @@
+#include "VirtualFileSystem.hpp"
+#include "IoUring.hpp"
+
+#include "SimpleEngineCore/Assets/AssetArchive.hpp"
+#include "SimpleEngineCore/JobSystem.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Memory.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
+
+#ifdef SIMPLE_ENGINE_IO_URING
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace SimpleEngine {
+
+    using namespace AssetArchiveFormat;
+    using EPriority = VirtualFileSystem::EPriority;
+    using EReadStatus = VirtualFileSystem::EReadStatus;
+    using RequestId = VirtualFileSystem::RequestId;
+
+    constexpr size_t priorities_count = static_cast<size_t>(EPriority::Count);
+
+    const char* get_read_status_name(const EReadStatus status)
+    {
+        switch (status)
+        {
+            case EReadStatus::Completed: return "Completed";
+            case EReadStatus::NotFound:  return "Not found";
+            case EReadStatus::Failed:    return "Failed";
+            case EReadStatus::Cancelled: return "Cancelled";
+        }
+        return "Unknown";
+    }
+
+    enum class EMountType : uint8_t
+    {
+        Directory,
+        Archive,
+        Memory
+    };
+
+    // shared with the requests reading it, replacing a memory file doesn't pull the data from under a read
+    using MemoryFile = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Mount
+    {
+        EMountType type = EMountType::Directory;
+        std::string mount_point;
+        std::string directory;
+        AssetArchive archive;
+        std::string archive_path;
+        std::unordered_map<std::string, MemoryFile> files;
+#ifdef SIMPLE_ENGINE_IO_URING
+        int archive_fd = -1;
+
+        ~Mount()
+        {
+            if (archive_fd >= 0)
+            {
+                close(archive_fd);
+            }
+        }
+#endif
+    };
+
+    enum class ERequestState : uint8_t
+    {
+        Pending,
+        Opening,
+        Reading,
+        Done
+    };
+
+    struct Request
+    {
+        VirtualFileSystem::RequestId id = VirtualFileSystem::invalid_request;
+        VirtualFileSystem::ReadCallback callback = nullptr;
+        void* pContext = nullptr;
+        EPriority priority = EPriority::Normal;
+        ERequestState state = ERequestState::Pending;
+        EReadStatus status = EReadStatus::Failed;
+        // set under the requests mutex, so a successful cancel() always ends in EReadStatus::Cancelled
+        bool cancelled = false;
+
+        std::shared_ptr<Mount> mount;
+        // the file on disk for directory mounts
+        std::string path;
+        MemoryFile memory_file;
+
+        // range of the file read into buffer; whole_file until a directory mount's file is opened
+        uint64_t requested_offset = 0;
+        uint64_t requested_size = VirtualFileSystem::whole_file;
+        uint64_t file_offset = 0;
+        uint64_t read_size = 0;
+        uint64_t read_bytes = 0;
+        // archive entries: what buffer holds is compressed when compression isn't None
+        ECompression compression = ECompression::None;
+        uint64_t decompressed_size = 0;
+        std::vector<uint8_t> buffer;
+#ifdef SIMPLE_ENGINE_IO_URING
+        int fd = -1;
+        bool owns_fd = false;
+#endif
+    };
+
+    struct FileSystemState
+    {
+        VirtualFileSystem::Settings settings;
+        bool initialized = false;
+
+        std::mutex mounts_mutex;
+        std::vector<std::shared_ptr<Mount>> mounts;
+
+        // requests: the queues, the id map and stopping
+        std::mutex mutex;
+        std::condition_variable work_available;
+        std::condition_variable released;
+        std::deque<Request*> pending[priorities_count];
+        std::unordered_map<VirtualFileSystem::RequestId, Request*> requests;
+        // cancelled requests the io_uring thread may have in flight
+        std::vector<VirtualFileSystem::RequestId> cancelled_ids;
+        // requests not yet released, shutdown waits for them
+        size_t live_count = 0;
+        VirtualFileSystem::RequestId next_id = 1;
+        bool stopping = false;
+
+        std::vector<std::thread> threads;
+        std::atomic<uint32_t> in_flight_count{ 0 };
+
+        std::atomic<uint64_t> requests_count{ 0 };
+        std::atomic<uint64_t> completed_count{ 0 };
+        std::atomic<uint64_t> not_found_count{ 0 };
+        std::atomic<uint64_t> failed_count{ 0 };
+        std::atomic<uint64_t> cancelled_count{ 0 };
+        std::atomic<uint64_t> bytes_read{ 0 };
+
+#ifdef SIMPLE_ENGINE_IO_URING
+        IoUring ring;
+        int wake_fd = -1;
+        // kernels before 5.6 don't have IORING_OP_OPENAT, the I/O thread opens files itself there
+        bool blocking_open = false;
+#endif
+    };
+
+    static FileSystemState s_state;
+    static ObjectPool<Request> s_requests(256, EMemoryTag::IO);
+
+    static bool uses_io_uring()
+    {
+#ifdef SIMPLE_ENGINE_IO_URING
+        return s_state.ring.is_initialized();
+#else
+        return false;
+#endif
+    }
+
+    static std::string normalize_path(std::string_view path)
+    {
+        std::string normalized(path);
+        std::replace(normalized.begin(), normalized.end(), '\\', '/');
+        while (!normalized.empty() && normalized.back() == '/')
+        {
+            normalized.pop_back();
+        }
+        return normalized;
+    }
+
+    // the path below mount_point, false when mount_point isn't a prefix of it
+    static bool get_relative_path(const std::string& mount_point, const std::string& path, std::string_view& relative_path)
+    {
+        if (mount_point.empty())
+        {
+            relative_path = path;
+            return true;
+        }
+        if (path.size() <= mount_point.size() || path.compare(0, mount_point.size(), mount_point) != 0 || path[mount_point.size()] != '/')
+        {
+            return false;
+        }
+        relative_path = std::string_view(path).substr(mount_point.size() + 1);
+        return true;
+    }
+
+    static void clamp_range(const uint64_t file_size, const uint64_t offset, const uint64_t size, uint64_t& clamped_offset, uint64_t& clamped_size)
+    {
+        clamped_offset = std::min(offset, file_size);
+        clamped_size = std::min(size, file_size - clamped_offset);
+    }
+
+    // finds the mount serving the request's path, false when none does
+    static bool resolve(Request& request, std::string_view path)
+    {
+        const std::string normalized = normalize_path(path);
+        std::lock_guard<std::mutex> lock(s_state.mounts_mutex);
+        for (auto it = s_state.mounts.rbegin(); it != s_state.mounts.rend(); ++it)
+        {
+            Mount& mount = **it;
+            std::string_view relative_path;
+            if (!get_relative_path(mount.mount_point, normalized, relative_path))
+            {
+                continue;
+            }
+            switch (mount.type)
+            {
+                case EMountType::Directory:
+                    request.mount = *it;
+                    request.path = mount.directory + "/" + std::string(relative_path);
+                    return true;
+
+                case EMountType::Archive:
+                {
+                    const AssetArchive::EntryIndex entry_index = mount.archive.find(relative_path);
+                    if (entry_index == AssetArchive::invalid_entry)
+                    {
+                        continue;
+                    }
+                    const Entry& entry = mount.archive.get_entry(entry_index);
+                    request.mount = *it;
+                    request.compression = entry.compression;
+                    request.decompressed_size = entry.size;
+                    if (entry.compression == ECompression::None)
+                    {
+                        clamp_range(entry.size, request.requested_offset, request.requested_size, request.file_offset, request.read_size);
+                        request.file_offset += entry.offset;
+                    }
+                    else
+                    {
+                        // decompressed whole, the range is cut out afterwards
+                        request.file_offset = entry.offset;
+                        request.read_size = entry.stored_size;
+                    }
+                    return true;
+                }
+
+                case EMountType::Memory:
+                {
+                    const auto file = mount.files.find(std::string(relative_path));
+                    if (file == mount.files.end())
+                    {
+                        continue;
+                    }
+                    request.mount = *it;
+                    request.memory_file = file->second;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // on a JobSystem worker: decompresses, hands the data to the callback and releases the request
+    static void complete(Request* pRequest)
+    {
+        Request& request = *pRequest;
+        {
+            std::lock_guard<std::mutex> lock(s_state.mutex);
+            s_state.requests.erase(request.id);
+            if (request.cancelled)
+            {
+                request.status = EReadStatus::Cancelled;
+            }
+        }
+
+        VirtualFileSystem::ReadResult result;
+        result.id = request.id;
+        result.status = request.status;
+        std::vector<uint8_t> decompressed;
+        if (result.status == EReadStatus::Completed)
+        {
+            if (request.memory_file)
+            {
+                uint64_t offset = 0;
+                uint64_t size = 0;
+                clamp_range(request.memory_file->size(), request.requested_offset, request.requested_size, offset, size);
+                result.data = request.memory_file->data() + offset;
+                result.size = static_cast<size_t>(size);
+            }
+            else if (request.compression != ECompression::None)
+            {
+                {
+                    MemoryTagScope tag_scope(EMemoryTag::IO);
+                    decompressed.resize(static_cast<size_t>(request.decompressed_size));
+                }
+                if (AssetArchive::decompress(request.compression, request.buffer.data(), request.buffer.size(), decompressed.data(), decompressed.size()))
+                {
+                    uint64_t offset = 0;
+                    uint64_t size = 0;
+                    clamp_range(decompressed.size(), request.requested_offset, request.requested_size, offset, size);
+                    result.data = decompressed.data() + offset;
+                    result.size = static_cast<size_t>(size);
+                }
+                else
+                {
+                    LOG_ERROR("VirtualFileSystem: {0} is corrupt in {1}", request.id, request.mount->archive_path);
+                    result.status = EReadStatus::Failed;
+                }
+            }
+            else
+            {
+                result.data = request.buffer.data();
+                result.size = request.buffer.size();
+            }
+        }
+
+        switch (result.status)
+        {
+            case EReadStatus::Completed:
+                s_state.completed_count.fetch_add(1, std::memory_order_relaxed);
+                s_state.bytes_read.fetch_add(request.read_bytes, std::memory_order_relaxed);
+                break;
+            case EReadStatus::NotFound:  s_state.not_found_count.fetch_add(1, std::memory_order_relaxed); break;
+            case EReadStatus::Failed:    s_state.failed_count.fetch_add(1, std::memory_order_relaxed); break;
+            case EReadStatus::Cancelled: s_state.cancelled_count.fetch_add(1, std::memory_order_relaxed); break;
+        }
+        request.callback(request.pContext, result);
+
+        s_requests.destroy(pRequest);
+        std::lock_guard<std::mutex> lock(s_state.mutex);
+        if (--s_state.live_count == 0)
+        {
+            s_state.released.notify_all();
+        }
+    }
+
+    static void finish(Request& request, const EReadStatus status)
+    {
+        if (request.state == ERequestState::Opening || request.state == ERequestState::Reading)
+        {
+            s_state.in_flight_count.fetch_sub(1, std::memory_order_relaxed);
+        }
+        request.state = ERequestState::Done;
+        request.status = status;
+#ifdef SIMPLE_ENGINE_IO_URING
+        if (request.owns_fd && request.fd >= 0)
+        {
+            close(request.fd);
+        }
+        request.fd = -1;
+#endif
+        // a pointer fits in std::function's inline storage, completing doesn't allocate
+        Request* pRequest = &request;
+        JobSystem::submit([pRequest]() { complete(pRequest); });
+    }
+
+    // the highest priority pending request, nullptr when there is none; called with the requests mutex held
+    static Request* pop_pending()
+    {
+        for (std::deque<Request*>& queue : s_state.pending)
+        {
+            if (!queue.empty())
+            {
+                Request* pRequest = queue.front();
+                queue.pop_front();
+                return pRequest;
+            }
+        }
+        return nullptr;
+    }
+
+    // reads the request's range on the calling thread
+    static EReadStatus read_blocking(Request& request)
+    {
+        const bool archive = request.mount->type == EMountType::Archive;
+        std::ifstream file(archive ? request.mount->archive_path : request.path, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            return archive ? EReadStatus::Failed : EReadStatus::NotFound;
+        }
+        if (!archive)
+        {
+            clamp_range(static_cast<uint64_t>(file.tellg()), request.requested_offset, request.requested_size, request.file_offset, request.read_size);
+        }
+        request.buffer.resize(static_cast<size_t>(request.read_size));
+        file.seekg(static_cast<std::streamoff>(request.file_offset));
+        if (!file.read(reinterpret_cast<char*>(request.buffer.data()), static_cast<std::streamsize>(request.buffer.size())))
+        {
+            return EReadStatus::Failed;
+        }
+        request.read_bytes = request.read_size;
+        return EReadStatus::Completed;
+    }
+
+    static void reader_thread()
+    {
+        PROFILE_THREAD_NAME("VFS reader");
+        MemoryTagScope tag_scope(EMemoryTag::IO);
+        while (true)
+        {
+            Request* pRequest = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(s_state.mutex);
+                s_state.work_available.wait(lock, []() { return s_state.stopping || std::any_of(std::begin(s_state.pending), std::end(s_state.pending), [](const auto& queue) { return !queue.empty(); }); });
+                pRequest = pop_pending();
+                if (!pRequest)
+                {
+                    return;
+                }
+                if (pRequest->cancelled || s_state.stopping)
+                {
+                    lock.unlock();
+                    finish(*pRequest, EReadStatus::Cancelled);
+                    continue;
+                }
+                pRequest->state = ERequestState::Reading;
+            }
+            s_state.in_flight_count.fetch_add(1, std::memory_order_relaxed);
+            finish(*pRequest, read_blocking(*pRequest));
+        }
+    }
+
+#ifdef SIMPLE_ENGINE_IO_URING
+
+    // user_data of the entries that don't belong to a request
+    static uint64_t s_wake_tag;
+    static uint64_t s_cancel_tag;
+
+    static io_uring_sqe* get_sqe()
+    {
+        // the ring has room for every request in flight, a read and a cancel each, plus the wake up read
+        io_uring_sqe* pSqe = s_state.ring.get_sqe();
+        while (!pSqe)
+        {
+            s_state.ring.submit(0);
+            pSqe = s_state.ring.get_sqe();
+        }
+        return pSqe;
+    }
+
+    static void submit_read(Request& request)
+    {
+        request.state = ERequestState::Reading;
+        // a single read is limited to a little under 2 GB
+        constexpr uint64_t max_read_size = 1u << 30;
+        io_uring_sqe* pSqe = get_sqe();
+        pSqe->opcode = IORING_OP_READ;
+        pSqe->fd = request.fd;
+        pSqe->addr = reinterpret_cast<uint64_t>(request.buffer.data() + request.read_bytes);
+        pSqe->len = static_cast<uint32_t>(std::min(request.read_size - request.read_bytes, max_read_size));
+        pSqe->off = request.file_offset + request.read_bytes;
+        pSqe->user_data = reinterpret_cast<uint64_t>(&request);
+    }
+
+    // the file is open: sizes the range and reads it
+    static void start_read(Request& request)
+    {
+        if (request.mount->type == EMountType::Directory)
+        {
+            struct stat file_stat;
+            if (fstat(request.fd, &file_stat) != 0)
+            {
+                finish(request, EReadStatus::Failed);
+                return;
+            }
+            clamp_range(static_cast<uint64_t>(file_stat.st_size), request.requested_offset, request.requested_size, request.file_offset, request.read_size);
+        }
+        request.buffer.resize(static_cast<size_t>(request.read_size));
+        if (request.read_size == 0)
+        {
+            finish(request, EReadStatus::Completed);
+            return;
+        }
+        submit_read(request);
+    }
+
+    static void start(Request& request)
+    {
+        s_state.in_flight_count.fetch_add(1, std::memory_order_relaxed);
+        if (request.mount->type == EMountType::Archive)
+        {
+            request.fd = request.mount->archive_fd;
+            request.state = ERequestState::Reading;
+            start_read(request);
+            return;
+        }
+
+        request.owns_fd = true;
+        request.state = ERequestState::Opening;
+        if (s_state.blocking_open)
+        {
+            request.fd = open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (request.fd < 0)
+            {
+                finish(request, errno == ENOENT ? EReadStatus::NotFound : EReadStatus::Failed);
+                return;
+            }
+            start_read(request);
+            return;
+        }
+        io_uring_sqe* pSqe = get_sqe();
+        pSqe->opcode = IORING_OP_OPENAT;
+        pSqe->fd = AT_FDCWD;
+        pSqe->addr = reinterpret_cast<uint64_t>(request.path.c_str());
+        pSqe->open_flags = O_RDONLY | O_CLOEXEC;
+        pSqe->user_data = reinterpret_cast<uint64_t>(&request);
+    }
+
+    static void on_completion(Request& request, const int result)
+    {
+        if (request.state == ERequestState::Opening)
+        {
+            if (result == -EINVAL && !s_state.blocking_open)
+            {
+                LOG_WARN("VirtualFileSystem: the kernel can't open files through io_uring, opening them on the I/O thread");
+                s_state.blocking_open = true;
+                s_state.in_flight_count.fetch_sub(1, std::memory_order_relaxed);
+                start(request);
+                return;
+            }
+            if (result < 0)
+            {
+                finish(request, result == -ENOENT ? EReadStatus::NotFound : result == -ECANCELED ? EReadStatus::Cancelled : EReadStatus::Failed);
+                return;
+            }
+            request.fd = result;
+            start_read(request);
+            return;
+        }
+
+        if (result < 0)
+        {
+            finish(request, result == -ECANCELED ? EReadStatus::Cancelled : EReadStatus::Failed);
+            return;
+        }
+        // 0 before the end of the range: the file shrank under the read
+        if (result == 0)
+        {
+            finish(request, EReadStatus::Failed);
+            return;
+        }
+        request.read_bytes += static_cast<uint64_t>(result);
+        if (request.read_bytes < request.read_size)
+        {
+            submit_read(request);
+            return;
+        }
+        finish(request, EReadStatus::Completed);
+    }
+
+    static void ring_thread()
+    {
+        PROFILE_THREAD_NAME("VFS I/O");
+        MemoryTagScope tag_scope(EMemoryTag::IO);
+        std::vector<Request*> dispatched;
+        std::vector<Request*> dropped;
+        std::vector<Request*> cancelled;
+        uint64_t wake_value = 0;
+        bool wake_armed = false;
+        bool stopping = false;
+        bool cancelled_all = false;
+        while (true)
+        {
+            dispatched.clear();
+            dropped.clear();
+            cancelled.clear();
+            {
+                std::lock_guard<std::mutex> lock(s_state.mutex);
+                stopping = s_state.stopping;
+                while (s_state.in_flight_count.load(std::memory_order_relaxed) + dispatched.size() < s_state.settings.queue_depth || stopping)
+                {
+                    Request* pRequest = pop_pending();
+                    if (!pRequest)
+                    {
+                        break;
+                    }
+                    (pRequest->cancelled || stopping ? dropped : dispatched).push_back(pRequest);
+                }
+                // only this thread finishes requests in flight, they stay valid once unlocked
+                for (const RequestId id : s_state.cancelled_ids)
+                {
+                    const auto it = s_state.requests.find(id);
+                    if (it != s_state.requests.end() && (it->second->state == ERequestState::Opening || it->second->state == ERequestState::Reading))
+                    {
+                        cancelled.push_back(it->second);
+                    }
+                }
+                s_state.cancelled_ids.clear();
+                if (stopping && !cancelled_all)
+                {
+                    // everything still in flight is cancelled, the kernel drops what it hasn't started
+                    for (const auto& [id, pRequest] : s_state.requests)
+                    {
+                        if (pRequest->state == ERequestState::Opening || pRequest->state == ERequestState::Reading)
+                        {
+                            cancelled.push_back(pRequest);
+                        }
+                    }
+                    cancelled_all = true;
+                }
+            }
+            if (stopping && dropped.empty() && s_state.in_flight_count.load(std::memory_order_relaxed) == 0)
+            {
+                return;
+            }
+
+            for (Request* pRequest : dropped)
+            {
+                finish(*pRequest, EReadStatus::Cancelled);
+            }
+            bool finished_immediately = !dropped.empty();
+            for (Request* pRequest : dispatched)
+            {
+                start(*pRequest);
+                finished_immediately = finished_immediately || pRequest->state == ERequestState::Done;
+            }
+            for (Request* pRequest : cancelled)
+            {
+                if (pRequest->state == ERequestState::Opening || pRequest->state == ERequestState::Reading)
+                {
+                    io_uring_sqe* pSqe = get_sqe();
+                    pSqe->opcode = IORING_OP_ASYNC_CANCEL;
+                    pSqe->addr = reinterpret_cast<uint64_t>(pRequest);
+                    pSqe->user_data = reinterpret_cast<uint64_t>(&s_cancel_tag);
+                }
+            }
+            if (!wake_armed)
+            {
+                io_uring_sqe* pSqe = get_sqe();
+                pSqe->opcode = IORING_OP_READ;
+                pSqe->fd = s_state.wake_fd;
+                pSqe->addr = reinterpret_cast<uint64_t>(&wake_value);
+                pSqe->len = sizeof(wake_value);
+                pSqe->user_data = reinterpret_cast<uint64_t>(&s_wake_tag);
+                wake_armed = true;
+            }
+
+            // requests that finished without I/O freed room in the queue, the pending ones go out before waiting
+            const int submitted = s_state.ring.submit(finished_immediately ? 0 : 1);
+            if (submitted < 0 && submitted != -EAGAIN && submitted != -EBUSY)
+            {
+                LOG_CRITICAL("VirtualFileSystem: io_uring_enter failed with {0}", -submitted);
+            }
+            s_state.ring.reap([&](const io_uring_cqe& cqe)
+                {
+                    if (cqe.user_data == reinterpret_cast<uint64_t>(&s_wake_tag))
+                    {
+                        wake_armed = false;
+                        return;
+                    }
+                    if (cqe.user_data == reinterpret_cast<uint64_t>(&s_cancel_tag))
+                    {
+                        return;
+                    }
+                    on_completion(*reinterpret_cast<Request*>(cqe.user_data), cqe.res);
+                });
+        }
+    }
+
+    static void wake_ring_thread()
+    {
+        const uint64_t value = 1;
+        [[maybe_unused]] const ssize_t written = write(s_state.wake_fd, &value, sizeof(value));
+    }
+
+#endif
+
+    static void wake_io()
+    {
+#ifdef SIMPLE_ENGINE_IO_URING
+        if (uses_io_uring())
+        {
+            wake_ring_thread();
+            return;
+        }
+#endif
+        s_state.work_available.notify_all();
+    }
+
+    bool VirtualFileSystem::init()
+    {
+        return init(Settings());
+    }
+
+    bool VirtualFileSystem::init(const Settings& settings)
+    {
+        if (s_state.initialized)
+        {
+            return true;
+        }
+        s_state.settings = settings;
+        s_state.settings.queue_depth = std::max(settings.queue_depth, 1u);
+        s_state.stopping = false;
+
+#ifdef SIMPLE_ENGINE_IO_URING
+        if (settings.use_io_uring)
+        {
+            s_state.wake_fd = eventfd(0, EFD_CLOEXEC);
+            if (s_state.wake_fd >= 0 && s_state.ring.init(s_state.settings.queue_depth * 2 + 16))
+            {
+                LOG_INFO("VirtualFileSystem: io_uring with {0} entries", s_state.ring.get_entries_count());
+                s_state.threads.emplace_back(ring_thread);
+                s_state.initialized = true;
+                return true;
+            }
+            LOG_WARN("VirtualFileSystem: io_uring isn't available, reading on a thread pool");
+            if (s_state.wake_fd >= 0)
+            {
+                close(s_state.wake_fd);
+                s_state.wake_fd = -1;
+            }
+        }
+#endif
+
+        const unsigned int threads_count = std::max(settings.threads_count, 1u);
+        LOG_INFO("VirtualFileSystem: {0} reader threads", threads_count);
+        for (unsigned int i = 0; i < threads_count; ++i)
+        {
+            s_state.threads.emplace_back(reader_thread);
+        }
+        s_state.initialized = true;
+        return true;
+    }
+
+    void VirtualFileSystem::shutdown()
+    {
+        if (!s_state.initialized)
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(s_state.mutex);
+            s_state.stopping = true;
+        }
+        wake_io();
+        for (std::thread& thread : s_state.threads)
+        {
+            thread.join();
+        }
+        s_state.threads.clear();
+        {
+            // the callbacks of the last requests may still be queued on the JobSystem
+            std::unique_lock<std::mutex> lock(s_state.mutex);
+            s_state.released.wait(lock, []() { return s_state.live_count == 0; });
+        }
+
+#ifdef SIMPLE_ENGINE_IO_URING
+        s_state.ring.shutdown();
+        if (s_state.wake_fd >= 0)
+        {
+            close(s_state.wake_fd);
+            s_state.wake_fd = -1;
+        }
+#endif
+        std::lock_guard<std::mutex> lock(s_state.mounts_mutex);
+        s_state.mounts.clear();
+        s_state.initialized = false;
+    }
+
+    bool VirtualFileSystem::is_initialized()
+    {
+        return s_state.initialized;
+    }
+
+    static void add_mount(std::shared_ptr<Mount> mount)
+    {
+        std::lock_guard<std::mutex> lock(s_state.mounts_mutex);
+        s_state.mounts.push_back(std::move(mount));
+    }
+
+    bool VirtualFileSystem::mount_directory(std::string_view mount_point, const std::string& directory)
+    {
+        std::shared_ptr<Mount> mount = std::make_shared<Mount>();
+        mount->type = EMountType::Directory;
+        mount->mount_point = normalize_path(mount_point);
+        mount->directory = normalize_path(directory.empty() ? "." : directory);
+        add_mount(std::move(mount));
+        return true;
+    }
+
+    bool VirtualFileSystem::mount_archive(std::string_view mount_point, const std::string& archive_path)
+    {
+        std::shared_ptr<Mount> mount = std::make_shared<Mount>();
+        mount->type = EMountType::Archive;
+        mount->mount_point = normalize_path(mount_point);
+        mount->archive_path = archive_path;
+        // the tables are used through the mapping, the data is read like any file
+        if (!mount->archive.open(archive_path))
+        {
+            return false;
+        }
+#ifdef SIMPLE_ENGINE_IO_URING
+        mount->archive_fd = open(archive_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (mount->archive_fd < 0)
+        {
+            LOG_ERROR("VirtualFileSystem: can't open {0}", archive_path);
+            return false;
+        }
+#endif
+        add_mount(std::move(mount));
+        return true;
+    }
+
+    void VirtualFileSystem::mount_memory(std::string_view mount_point)
+    {
+        std::shared_ptr<Mount> mount = std::make_shared<Mount>();
+        mount->type = EMountType::Memory;
+        mount->mount_point = normalize_path(mount_point);
+        add_mount(std::move(mount));
+    }
+
+    bool VirtualFileSystem::write_memory_file(std::string_view path, const void* data, const size_t size)
+    {
+        const std::string normalized = normalize_path(path);
+        const uint8_t* pBytes = static_cast<const uint8_t*>(data);
+        MemoryFile file = std::make_shared<const std::vector<uint8_t>>(pBytes, pBytes + size);
+        std::lock_guard<std::mutex> lock(s_state.mounts_mutex);
+        for (auto it = s_state.mounts.rbegin(); it != s_state.mounts.rend(); ++it)
+        {
+            std::string_view relative_path;
+            if ((*it)->type == EMountType::Memory && get_relative_path((*it)->mount_point, normalized, relative_path))
+            {
+                (*it)->files[std::string(relative_path)] = std::move(file);
+                return true;
+            }
+        }
+        LOG_ERROR("VirtualFileSystem: no memory mount for {0}", normalized);
+        return false;
+    }
+
+    void VirtualFileSystem::unmount(std::string_view mount_point)
+    {
+        const std::string normalized = normalize_path(mount_point);
+        std::lock_guard<std::mutex> lock(s_state.mounts_mutex);
+        s_state.mounts.erase(std::remove_if(s_state.mounts.begin(), s_state.mounts.end(),
+                                            [&](const std::shared_ptr<Mount>& mount) { return mount->mount_point == normalized; }),
+                             s_state.mounts.end());
+    }
+
+    VirtualFileSystem::RequestId VirtualFileSystem::read_async(const ReadRequest& request)
+    {
+        RequestId id = invalid_request;
+        read_async(&request, 1, &id);
+        return id;
+    }
+
+    void VirtualFileSystem::read_async(const ReadRequest* requests, const size_t count, RequestId* ids)
+    {
+        PROFILE_FUNCTION();
+        if (!s_state.initialized)
+        {
+            if (ids)
+            {
+                std::fill(ids, ids + count, invalid_request);
+            }
+            return;
+        }
+
+        // resolved before taking the requests mutex, the I/O thread isn't held up by the mount lookups
+        MemoryTagScope tag_scope(EMemoryTag::IO);
+        std::vector<Request*> created(count);
+        // nothing to read: memory files and paths no mount has. The others may be released by the time the lock is let go
+        std::vector<Request*> immediate;
+        for (size_t i = 0; i < count; ++i)
+        {
+            Request* pRequest = s_requests.create();
+            pRequest->callback = requests[i].callback;
+            pRequest->pContext = requests[i].pContext;
+            pRequest->priority = std::min(requests[i].priority, EPriority::Low);
+            pRequest->requested_offset = requests[i].offset;
+            pRequest->requested_size = requests[i].size;
+            if (!resolve(*pRequest, requests[i].path))
+            {
+                pRequest->state = ERequestState::Done;
+                pRequest->status = EReadStatus::NotFound;
+            }
+            else if (pRequest->memory_file)
+            {
+                pRequest->state = ERequestState::Done;
+                pRequest->status = EReadStatus::Completed;
+            }
+            created[i] = pRequest;
+            if (pRequest->state == ERequestState::Done)
+            {
+                immediate.push_back(pRequest);
+            }
+        }
+
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(s_state.mutex);
+            for (size_t i = 0; i < count; ++i)
+            {
+                Request* pRequest = created[i];
+                pRequest->id = s_state.next_id++;
+                s_state.requests.emplace(pRequest->id, pRequest);
+                ++s_state.live_count;
+                if (ids)
+                {
+                    ids[i] = pRequest->id;
+                }
+                if (pRequest->state == ERequestState::Pending)
+                {
+                    s_state.pending[static_cast<size_t>(pRequest->priority)].push_back(pRequest);
+                    queued = true;
+                }
+            }
+        }
+        s_state.requests_count.fetch_add(count, std::memory_order_relaxed);
+
+        for (Request* pRequest : immediate)
+        {
+            finish(*pRequest, pRequest->status);
+        }
+        if (queued)
+        {
+            wake_io();
+        }
+    }
+
+    bool VirtualFileSystem::cancel(const RequestId id)
+    {
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(s_state.mutex);
+            const auto it = s_state.requests.find(id);
+            if (it == s_state.requests.end() || it->second->cancelled)
+            {
+                return false;
+            }
+            it->second->cancelled = true;
+            // pending requests are dropped when they reach the front of their queue, the io_uring thread
+            // cancels the ones it has in flight; blocking reads run to the end
+            if (uses_io_uring())
+            {
+                s_state.cancelled_ids.push_back(id);
+                wake = true;
+            }
+        }
+        if (wake)
+        {
+            wake_io();
+        }
+        return true;
+    }
+
+    bool VirtualFileSystem::read_file(std::string_view path, std::vector<uint8_t>& data)
+    {
+        Request request;
+        if (!resolve(request, path))
+        {
+            return false;
+        }
+        if (request.memory_file)
+        {
+            data = *request.memory_file;
+            return true;
+        }
+        if (read_blocking(request) != EReadStatus::Completed)
+        {
+            return false;
+        }
+        if (request.compression == ECompression::None)
+        {
+            data = std::move(request.buffer);
+            return true;
+        }
+        data.resize(static_cast<size_t>(request.decompressed_size));
+        return AssetArchive::decompress(request.compression, request.buffer.data(), request.buffer.size(), data.data(), data.size());
+    }
+
+    VirtualFileSystem::Stats VirtualFileSystem::get_stats()
+    {
+        Stats stats;
+        stats.requests_count = s_state.requests_count.load(std::memory_order_relaxed);
+        stats.completed_count = s_state.completed_count.load(std::memory_order_relaxed);
+        stats.not_found_count = s_state.not_found_count.load(std::memory_order_relaxed);
+        stats.failed_count = s_state.failed_count.load(std::memory_order_relaxed);
+        stats.cancelled_count = s_state.cancelled_count.load(std::memory_order_relaxed);
+        stats.bytes_read = s_state.bytes_read.load(std::memory_order_relaxed);
+        stats.in_flight_count = s_state.in_flight_count.load(std::memory_order_relaxed);
+        stats.io_uring = uses_io_uring();
+        std::lock_guard<std::mutex> lock(s_state.mutex);
+        for (const std::deque<Request*>& queue : s_state.pending)
+        {
+            stats.pending_count += static_cast<uint32_t>(queue.size());
+        }
+        return stats;
+    }
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // Paths seen through mount points: a directory on disk, an AssetArchive, or files held in memory.
+    // A path goes to the mounts whose mount point prefixes it, the most recent mount first; archive and
+    // memory mounts pass on paths they don't have, a directory mount takes every path it is asked for.
+    //
+    // Reads are asynchronous. A dedicated I/O thread drives io_uring on Linux (built with SIMPLE_ENGINE_IO_URING),
+    // elsewhere or when the kernel refuses io_uring a pool of threads does blocking reads. Requests wait in one
+    // queue per priority and at most queue_depth of them are in flight, so a flood of low priority reads can't
+    // hold back a high priority one for long. Completions run on the JobSystem workers.
+    class VirtualFileSystem
+    {
+    public:
+        enum class EPriority : uint8_t
+        {
+            High,
+            Normal,
+            Low,
+
+            Count
+        };
+
+        enum class EReadStatus : uint8_t
+        {
+            Completed,
+            NotFound,
+            Failed,
+            Cancelled
+        };
+
+        using RequestId = uint64_t;
+        static constexpr RequestId invalid_request = 0;
+        static constexpr uint64_t whole_file = UINT64_MAX;
+
+        struct ReadResult
+        {
+            RequestId id = invalid_request;
+            EReadStatus status = EReadStatus::Failed;
+            // only valid during the callback
+            const uint8_t* data = nullptr;
+            size_t size = 0;
+        };
+
+        // called exactly once per request, on a JobSystem worker
+        using ReadCallback = void(*)(void* pContext, const ReadResult& result);
+
+        struct ReadRequest
+        {
+            std::string_view path;
+            ReadCallback callback = nullptr;
+            void* pContext = nullptr;
+            EPriority priority = EPriority::Normal;
+            // of the file's data, decompressed for compressed archive entries
+            uint64_t offset = 0;
+            uint64_t size = whole_file;
+        };
+
+        struct Settings
+        {
+            // reads in flight at once
+            unsigned int queue_depth = 256;
+            bool use_io_uring = true;
+            // reader threads when io_uring isn't used
+            unsigned int threads_count = 4;
+        };
+
+        struct Stats
+        {
+            uint64_t requests_count = 0;
+            uint64_t completed_count = 0;
+            uint64_t not_found_count = 0;
+            uint64_t failed_count = 0;
+            uint64_t cancelled_count = 0;
+            uint64_t bytes_read = 0;
+            uint32_t pending_count = 0;
+            uint32_t in_flight_count = 0;
+            bool io_uring = false;
+        };
+
+        static bool init();
+        static bool init(const Settings& settings);
+        // cancels what is pending, waits for what is in flight and for every callback
+        static void shutdown();
+        static bool is_initialized();
+
+        // mount points are path prefixes without a trailing '/', "" is the root
+        static bool mount_directory(std::string_view mount_point, const std::string& directory);
+        static bool mount_archive(std::string_view mount_point, const std::string& archive_path);
+        static void mount_memory(std::string_view mount_point);
+        // copies the data into the most recent memory mount at a prefix of path, replacing the file if it is there
+        static bool write_memory_file(std::string_view path, const void* data, const size_t size);
+        // every mount at mount_point, reads in flight keep their mount alive
+        static void unmount(std::string_view mount_point);
+
+        static RequestId read_async(const ReadRequest& request);
+        // the whole batch is queued under one lock and wakes the I/O thread once, ids may be nullptr
+        static void read_async(const ReadRequest* requests, const size_t count, RequestId* ids);
+        // the callback then reports EReadStatus::Cancelled, whether or not the read got to finish.
+        // False when the request is unknown or its callback has already started
+        static bool cancel(const RequestId id);
+
+        // blocking read on the calling thread, through the same mounts
+        static bool read_file(std::string_view path, std::vector<uint8_t>& data);
+
+        static Stats get_stats();
+    };
+
+    const char* get_read_status_name(const VirtualFileSystem::EReadStatus status);
+
+}
@@ -0,0 +1,189 @@
+#include "ImageWriter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+namespace SimpleEngine {
+
+    static const std::array<uint32_t, 256>& get_crc_table()
+    {
+        static const std::array<uint32_t, 256> table = []
+        {
+            std::array<uint32_t, 256> crc_table{};
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = crc & 1 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+                }
+                crc_table[i] = crc;
+            }
+            return crc_table;
+        }();
+        return table;
+    }
+
+
+    static uint32_t update_crc(uint32_t crc, const unsigned char* data, const size_t size)
+    {
+        const std::array<uint32_t, 256>& table = get_crc_table();
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+
+    static void update_adler(uint32_t& a, uint32_t& b, const unsigned char* data, size_t size)
+    {
+        // 5552 bytes is the most that can be summed before b overflows 32 bits
+        while (size > 0)
+        {
+            const size_t chunk_size = std::min<size_t>(size, 5552);
+            for (size_t i = 0; i < chunk_size; ++i)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += chunk_size;
+            size -= chunk_size;
+        }
+    }
+
+
+    static void append_u32_big_endian(std::vector<unsigned char>& data, const uint32_t value)
+    {
+        data.push_back(static_cast<unsigned char>(value >> 24));
+        data.push_back(static_cast<unsigned char>(value >> 16));
+        data.push_back(static_cast<unsigned char>(value >> 8));
+        data.push_back(static_cast<unsigned char>(value));
+    }
+
+
+    static void write_chunk(std::ofstream& file, const char type[4], const std::vector<unsigned char>& data)
+    {
+        std::vector<unsigned char> header;
+        append_u32_big_endian(header, static_cast<uint32_t>(data.size()));
+        header.insert(header.end(), type, type + 4);
+        file.write(reinterpret_cast<const char*>(header.data()), header.size());
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+        uint32_t crc = update_crc(0xFFFFFFFFu, reinterpret_cast<const unsigned char*>(type), 4);
+        crc = update_crc(crc, data.data(), data.size()) ^ 0xFFFFFFFFu;
+        std::vector<unsigned char> footer;
+        append_u32_big_endian(footer, crc);
+        file.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+    }
+
+
+    static const unsigned char* get_row(const unsigned char* pixels, const unsigned int width, const unsigned int height, const unsigned int y, const bool bottom_up)
+    {
+        const size_t row = bottom_up ? height - 1 - y : y;
+        return pixels + row * width * 4;
+    }
+
+
+    bool write_png(const std::string& path,
+                   const unsigned char* pixels,
+                   const unsigned int width,
+                   const unsigned int height,
+                   const bool bottom_up)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file || width == 0 || height == 0)
+        {
+            return false;
+        }
+        const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+        std::vector<unsigned char> header;
+        append_u32_big_endian(header, width);
+        append_u32_big_endian(header, height);
+        // 8 bit RGBA, deflate, adaptive filtering, no interlace
+        header.insert(header.end(), { 8, 6, 0, 0, 0 });
+        write_chunk(file, "IHDR", header);
+
+        // every row is the filter type byte (0: none) followed by the pixels
+        const size_t row_size = 1 + static_cast<size_t>(width) * 4;
+        const size_t raw_size = row_size * height;
+        constexpr size_t max_block_size = 65535;
+        std::vector<unsigned char> image_data;
+        image_data.reserve(2 + raw_size + (raw_size / max_block_size + 1) * 5 + 4);
+        // zlib header: deflate with a 32K window, no dictionary, fastest level
+        image_data.push_back(0x78);
+        image_data.push_back(0x01);
+
+        uint32_t adler_a = 1;
+        uint32_t adler_b = 0;
+        size_t remaining = raw_size;
+        size_t row_offset = 0;
+        unsigned int y = 0;
+        while (remaining > 0)
+        {
+            const size_t block_size = std::min(remaining, max_block_size);
+            image_data.push_back(block_size == remaining ? 1 : 0);
+            image_data.push_back(static_cast<unsigned char>(block_size));
+            image_data.push_back(static_cast<unsigned char>(block_size >> 8));
+            image_data.push_back(static_cast<unsigned char>(~block_size));
+            image_data.push_back(static_cast<unsigned char>(~block_size >> 8));
+            for (size_t written = 0; written < block_size;)
+            {
+                const unsigned char* begin = nullptr;
+                size_t size = 0;
+                const unsigned char filter = 0;
+                if (row_offset == 0)
+                {
+                    begin = &filter;
+                    size = 1;
+                }
+                else
+                {
+                    begin = get_row(pixels, width, height, y, bottom_up) + row_offset - 1;
+                    size = std::min(row_size - row_offset, block_size - written);
+                }
+                image_data.insert(image_data.end(), begin, begin + size);
+                update_adler(adler_a, adler_b, begin, size);
+                written += size;
+                row_offset += size;
+                if (row_offset == row_size)
+                {
+                    row_offset = 0;
+                    ++y;
+                }
+            }
+            remaining -= block_size;
+        }
+        append_u32_big_endian(image_data, (adler_b << 16) | adler_a);
+        write_chunk(file, "IDAT", image_data);
+        write_chunk(file, "IEND", {});
+        return file.good();
+    }
+
+
+    bool write_raw(const std::string& path,
+                   const unsigned char* pixels,
+                   const unsigned int width,
+                   const unsigned int height,
+                   const bool bottom_up)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        for (unsigned int y = 0; y < height; ++y)
+        {
+            file.write(reinterpret_cast<const char*>(get_row(pixels, width, height, y, bottom_up)), static_cast<std::streamsize>(width) * 4);
+        }
+        return file.good();
+    }
+
+}
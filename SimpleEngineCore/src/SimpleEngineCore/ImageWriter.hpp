@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+namespace SimpleEngine {
+
+    // RGBA8 images, 4 bytes per pixel, rows of width pixels.
+    // bottom_up: the last row comes first in memory, like glReadPixels returns it; files always start with the top row.
+
+    // uncompressed PNG (stored deflate blocks): cheap enough to write every frame, readable everywhere
+    bool write_png(const std::string& path,
+                   const unsigned char* pixels,
+                   const unsigned int width,
+                   const unsigned int height,
+                   const bool bottom_up);
+
+    // headerless RGBA8 rows, e.g. for ffmpeg -f rawvideo -pixel_format rgba
+    bool write_raw(const std::string& path,
+                   const unsigned char* pixels,
+                   const unsigned int width,
+                   const unsigned int height,
+                   const bool bottom_up);
+
+}
@@ -1,37 +1,503 @@
 #include "SimpleEngineCore/Input.hpp"
+
+#include <atomic>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 
 namespace SimpleEngine {
-    bool Input::m_keys_pressed[static_cast<size_t>(KeyCode::KEY_LAST) + 1] = {};
-    bool Input::m_mouse_buttons_pressed[static_cast<size_t>(MouseButton::MOUSE_BUTTON_LAST) + 1] = {};
+
+    enum class EInputEvent : uint8_t
+    {
+        KeyPressed,
+        KeyReleased,
+        MouseButtonPressed,
+        MouseButtonReleased,
+        MouseMoved
+    };
+
+    constexpr char s_recording_magic[8] = { 'S', 'E', 'I', 'N', 'P', 'U', 'T', '\0' };
+    constexpr uint32_t s_recording_version = 1;
+    constexpr size_t s_recording_header_size = sizeof(s_recording_magic) + 2 * sizeof(uint32_t);
+
+    struct PendingInput
+    {
+        std::bitset<InputSnapshot::keys_count> keys_down;
+        std::bitset<InputSnapshot::keys_count> keys_pressed;
+        std::bitset<InputSnapshot::keys_count> keys_released;
+        std::bitset<InputSnapshot::mouse_buttons_count> mouse_buttons_down;
+        std::bitset<InputSnapshot::mouse_buttons_count> mouse_buttons_pressed;
+        std::bitset<InputSnapshot::mouse_buttons_count> mouse_buttons_released;
+        glm::vec2 mouse_position{ 0.f };
+        glm::vec2 mouse_delta{ 0.f };
+        bool has_mouse_position = false;
+    };
+
+    static InputSnapshot s_snapshots[2];
+    static std::atomic<int> s_current_snapshot{ 0 };
+    static PendingInput s_pending;
+
+    static bool s_is_recording = false;
+    static std::vector<uint8_t> s_recorded_stream;
+    static uint32_t s_recorded_frames_count = 0;
+    static double s_recording_start_time = 0.0;
+    // events fed during the frame being recorded, written behind its header by NewFrame
+    static std::vector<uint8_t> s_recorded_frame_events;
+    static uint16_t s_recorded_frame_events_count = 0;
+
+    static bool s_is_replaying = false;
+    static std::vector<uint8_t> s_replay_stream;
+    static uint32_t s_replay_frames_count = 0;
+    static size_t s_replay_position = 0;
+    static uint32_t s_replayed_frames_count = 0;
+    static double s_replay_start_time = 0.0;
+
+    template<typename T>
+    static void write_value(std::vector<uint8_t>& stream, const T value)
+    {
+        const size_t offset = stream.size();
+        stream.resize(offset + sizeof(T));
+        std::memcpy(stream.data() + offset, &value, sizeof(T));
+    }
+
+    template<typename T>
+    static bool read_value(const std::vector<uint8_t>& stream, size_t& position, T& value)
+    {
+        if (position + sizeof(T) > stream.size())
+        {
+            return false;
+        }
+        std::memcpy(&value, stream.data() + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+
+    static bool is_valid(const KeyCode key_code)
+    {
+        // GLFW reports unknown keys as -1
+        return static_cast<int>(key_code) >= 0 && static_cast<size_t>(key_code) < InputSnapshot::keys_count;
+    }
+
+    static bool is_valid(const MouseButton mouse_button)
+    {
+        return static_cast<int>(mouse_button) >= 0 && static_cast<size_t>(mouse_button) < InputSnapshot::mouse_buttons_count;
+    }
+
+    static void record_event(const EInputEvent event, const uint16_t code)
+    {
+        write_value(s_recorded_frame_events, static_cast<uint8_t>(event));
+        if (event == EInputEvent::KeyPressed || event == EInputEvent::KeyReleased)
+        {
+            write_value(s_recorded_frame_events, code);
+        }
+        else
+        {
+            write_value(s_recorded_frame_events, static_cast<uint8_t>(code));
+        }
+        ++s_recorded_frame_events_count;
+    }
+
+    static void apply_key(const size_t key, const bool pressed)
+    {
+        if (pressed)
+        {
+            s_pending.keys_pressed.set(key, !s_pending.keys_down[key] || s_pending.keys_pressed[key]);
+        }
+        else if (s_pending.keys_down[key])
+        {
+            s_pending.keys_released.set(key);
+        }
+        s_pending.keys_down.set(key, pressed);
+    }
+
+    static void apply_mouse_button(const size_t button, const bool pressed)
+    {
+        if (pressed)
+        {
+            s_pending.mouse_buttons_pressed.set(button, !s_pending.mouse_buttons_down[button] || s_pending.mouse_buttons_pressed[button]);
+        }
+        else if (s_pending.mouse_buttons_down[button])
+        {
+            s_pending.mouse_buttons_released.set(button);
+        }
+        s_pending.mouse_buttons_down.set(button, pressed);
+    }
+
+    static void apply_mouse_move(const glm::vec2 position)
+    {
+        if (s_pending.has_mouse_position)
+        {
+            s_pending.mouse_delta += position - s_pending.mouse_position;
+        }
+        s_pending.mouse_position = position;
+        s_pending.has_mouse_position = true;
+    }
+
+    // feeds the next recorded frame and replaces time by its recorded one, false when the recording is over or damaged
+    static bool replay_frame(double& time)
+    {
+        if (s_replayed_frames_count == 0)
+        {
+            s_replay_start_time = time;
+        }
+        const std::vector<uint8_t>& stream = s_replay_stream;
+        float frame_time = 0.f;
+        uint16_t events_count = 0;
+        if (s_replayed_frames_count >= s_replay_frames_count
+            || !read_value(stream, s_replay_position, frame_time)
+            || !read_value(stream, s_replay_position, events_count))
+        {
+            return false;
+        }
+        for (uint16_t i = 0; i < events_count; ++i)
+        {
+            uint8_t event = 0;
+            if (!read_value(stream, s_replay_position, event))
+            {
+                return false;
+            }
+            switch (static_cast<EInputEvent>(event))
+            {
+                case EInputEvent::KeyPressed:
+                case EInputEvent::KeyReleased:
+                {
+                    uint16_t key = 0;
+                    if (!read_value(stream, s_replay_position, key) || key >= InputSnapshot::keys_count)
+                    {
+                        return false;
+                    }
+                    apply_key(key, static_cast<EInputEvent>(event) == EInputEvent::KeyPressed);
+                    break;
+                }
+                case EInputEvent::MouseButtonPressed:
+                case EInputEvent::MouseButtonReleased:
+                {
+                    uint8_t button = 0;
+                    if (!read_value(stream, s_replay_position, button) || button >= InputSnapshot::mouse_buttons_count)
+                    {
+                        return false;
+                    }
+                    apply_mouse_button(button, static_cast<EInputEvent>(event) == EInputEvent::MouseButtonPressed);
+                    break;
+                }
+                case EInputEvent::MouseMoved:
+                {
+                    glm::vec2 position;
+                    if (!read_value(stream, s_replay_position, position.x) || !read_value(stream, s_replay_position, position.y))
+                    {
+                        return false;
+                    }
+                    apply_mouse_move(position);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        ++s_replayed_frames_count;
+        time = s_replay_start_time + frame_time;
+        return true;
+    }
+
+    bool InputRecording::save(const std::string& path) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        file.write(s_recording_magic, sizeof(s_recording_magic));
+        file.write(reinterpret_cast<const char*>(&s_recording_version), sizeof(s_recording_version));
+        file.write(reinterpret_cast<const char*>(&m_frames_count), sizeof(m_frames_count));
+        file.write(reinterpret_cast<const char*>(m_stream.data()), m_stream.size());
+        return static_cast<bool>(file);
+    }
+
+    bool InputRecording::load(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        uint32_t version = 0;
+        uint32_t frames_count = 0;
+        size_t position = sizeof(s_recording_magic);
+        if (data.size() < s_recording_header_size
+            || std::memcmp(data.data(), s_recording_magic, sizeof(s_recording_magic)) != 0
+            || !read_value(data, position, version) || version != s_recording_version
+            || !read_value(data, position, frames_count))
+        {
+            return false;
+        }
+        m_stream.assign(data.begin() + s_recording_header_size, data.end());
+        m_frames_count = frames_count;
+        return true;
+    }
+
+    const InputSnapshot& Input::GetSnapshot()
+    {
+        return s_snapshots[s_current_snapshot.load(std::memory_order_acquire)];
+    }
 
     bool Input::IsKeyPressed(const KeyCode key_code)
     {
-        return m_keys_pressed[static_cast<size_t>(key_code)];
+        return is_valid(key_code) && GetSnapshot().keys_down[static_cast<size_t>(key_code)];
     }
 
-    void Input::PressKey(const KeyCode key_code)
+    bool Input::WasKeyPressedThisFrame(const KeyCode key_code)
     {
-        m_keys_pressed[static_cast<size_t>(key_code)] = true;
+        return is_valid(key_code) && GetSnapshot().keys_pressed[static_cast<size_t>(key_code)];
     }
 
-    void Input::ReleaseKey(const KeyCode key_code)
+    bool Input::WasKeyReleasedThisFrame(const KeyCode key_code)
+    {
+        return is_valid(key_code) && GetSnapshot().keys_released[static_cast<size_t>(key_code)];
+    }
+
+    double Input::GetKeyHeldTime(const KeyCode key_code)
     {
-        m_keys_pressed[static_cast<size_t>(key_code)] = false;
+        const InputSnapshot& snapshot = GetSnapshot();
+        if (!is_valid(key_code) || !snapshot.keys_down[static_cast<size_t>(key_code)])
+        {
+            return 0.0;
+        }
+        return snapshot.time - snapshot.key_press_times[static_cast<size_t>(key_code)];
     }
 
     bool Input::IsMouseButtonPressed(const MouseButton mouse_button)
     {
-        return m_mouse_buttons_pressed[static_cast<size_t>(mouse_button)];
+        return is_valid(mouse_button) && GetSnapshot().mouse_buttons_down[static_cast<size_t>(mouse_button)];
+    }
+
+    bool Input::WasMouseButtonPressedThisFrame(const MouseButton mouse_button)
+    {
+        return is_valid(mouse_button) && GetSnapshot().mouse_buttons_pressed[static_cast<size_t>(mouse_button)];
+    }
+
+    bool Input::WasMouseButtonReleasedThisFrame(const MouseButton mouse_button)
+    {
+        return is_valid(mouse_button) && GetSnapshot().mouse_buttons_released[static_cast<size_t>(mouse_button)];
+    }
+
+    double Input::GetMouseButtonHeldTime(const MouseButton mouse_button)
+    {
+        const InputSnapshot& snapshot = GetSnapshot();
+        if (!is_valid(mouse_button) || !snapshot.mouse_buttons_down[static_cast<size_t>(mouse_button)])
+        {
+            return 0.0;
+        }
+        return snapshot.time - snapshot.mouse_button_press_times[static_cast<size_t>(mouse_button)];
+    }
+
+    glm::vec2 Input::GetMousePosition()
+    {
+        return GetSnapshot().mouse_position;
+    }
+
+    glm::vec2 Input::GetMouseDelta()
+    {
+        return GetSnapshot().mouse_delta;
+    }
+
+    void Input::PressKey(const KeyCode key_code)
+    {
+        if (s_is_replaying || !is_valid(key_code))
+        {
+            return;
+        }
+        apply_key(static_cast<size_t>(key_code), true);
+        if (s_is_recording)
+        {
+            record_event(EInputEvent::KeyPressed, static_cast<uint16_t>(key_code));
+        }
+    }
+
+    void Input::ReleaseKey(const KeyCode key_code)
+    {
+        if (s_is_replaying || !is_valid(key_code))
+        {
+            return;
+        }
+        apply_key(static_cast<size_t>(key_code), false);
+        if (s_is_recording)
+        {
+            record_event(EInputEvent::KeyReleased, static_cast<uint16_t>(key_code));
+        }
     }
 
     void Input::PressMouseButton(const MouseButton mouse_button)
     {
-        m_mouse_buttons_pressed[static_cast<size_t>(mouse_button)] = true;
+        if (s_is_replaying || !is_valid(mouse_button))
+        {
+            return;
+        }
+        apply_mouse_button(static_cast<size_t>(mouse_button), true);
+        if (s_is_recording)
+        {
+            record_event(EInputEvent::MouseButtonPressed, static_cast<uint16_t>(mouse_button));
+        }
     }
 
     void Input::ReleaseMouseButton(const MouseButton mouse_button)
     {
-        m_mouse_buttons_pressed[static_cast<size_t>(mouse_button)] = false;
+        if (s_is_replaying || !is_valid(mouse_button))
+        {
+            return;
+        }
+        apply_mouse_button(static_cast<size_t>(mouse_button), false);
+        if (s_is_recording)
+        {
+            record_event(EInputEvent::MouseButtonReleased, static_cast<uint16_t>(mouse_button));
+        }
+    }
+
+    void Input::MoveMouse(const double x_pos, const double y_pos)
+    {
+        if (s_is_replaying)
+        {
+            return;
+        }
+        const glm::vec2 position(static_cast<float>(x_pos), static_cast<float>(y_pos));
+        apply_mouse_move(position);
+        if (s_is_recording)
+        {
+            write_value(s_recorded_frame_events, static_cast<uint8_t>(EInputEvent::MouseMoved));
+            write_value(s_recorded_frame_events, position.x);
+            write_value(s_recorded_frame_events, position.y);
+            ++s_recorded_frame_events_count;
+        }
+    }
+
+    void Input::NewFrame(const double time)
+    {
+        double frame_time = time;
+        if (s_is_replaying && !replay_frame(frame_time))
+        {
+            StopReplay();
+            frame_time = time;
+        }
+        if (s_is_recording)
+        {
+            if (s_recorded_frames_count == 0)
+            {
+                s_recording_start_time = time;
+            }
+            write_value(s_recorded_stream, static_cast<float>(time - s_recording_start_time));
+            write_value(s_recorded_stream, s_recorded_frame_events_count);
+            s_recorded_stream.insert(s_recorded_stream.end(), s_recorded_frame_events.begin(), s_recorded_frame_events.end());
+            ++s_recorded_frames_count;
+            s_recorded_frame_events.clear();
+            s_recorded_frame_events_count = 0;
+        }
+
+        // the other buffer was published two frames ago, nobody reads it anymore
+        const int current = s_current_snapshot.load(std::memory_order_relaxed);
+        const InputSnapshot& previous = s_snapshots[current];
+        InputSnapshot& snapshot = s_snapshots[1 - current];
+        snapshot.frame_index = previous.frame_index + 1;
+        snapshot.time = frame_time;
+        snapshot.keys_down = s_pending.keys_down;
+        snapshot.keys_pressed = s_pending.keys_pressed;
+        snapshot.keys_released = s_pending.keys_released;
+        snapshot.mouse_buttons_down = s_pending.mouse_buttons_down;
+        snapshot.mouse_buttons_pressed = s_pending.mouse_buttons_pressed;
+        snapshot.mouse_buttons_released = s_pending.mouse_buttons_released;
+        for (size_t key = 0; key < InputSnapshot::keys_count; ++key)
+        {
+            snapshot.key_press_times[key] = s_pending.keys_pressed[key] ? frame_time : previous.key_press_times[key];
+        }
+        for (size_t button = 0; button < InputSnapshot::mouse_buttons_count; ++button)
+        {
+            snapshot.mouse_button_press_times[button] = s_pending.mouse_buttons_pressed[button] ? frame_time : previous.mouse_button_press_times[button];
+        }
+        snapshot.mouse_position = s_pending.mouse_position;
+        snapshot.mouse_delta = s_pending.mouse_delta;
+        s_current_snapshot.store(1 - current, std::memory_order_release);
+
+        s_pending.keys_pressed.reset();
+        s_pending.keys_released.reset();
+        s_pending.mouse_buttons_pressed.reset();
+        s_pending.mouse_buttons_released.reset();
+        s_pending.mouse_delta = glm::vec2(0.f);
+    }
+
+    void Input::StartRecording()
+    {
+        s_recorded_stream.clear();
+        s_recorded_frames_count = 0;
+        s_recorded_frame_events.clear();
+        s_recorded_frame_events_count = 0;
+        s_is_recording = true;
+        // the replay starts from nothing pressed, so the state the recording starts in is its first events
+        for (size_t key = 0; key < InputSnapshot::keys_count; ++key)
+        {
+            if (s_pending.keys_down[key])
+            {
+                record_event(EInputEvent::KeyPressed, static_cast<uint16_t>(key));
+            }
+        }
+        for (size_t button = 0; button < InputSnapshot::mouse_buttons_count; ++button)
+        {
+            if (s_pending.mouse_buttons_down[button])
+            {
+                record_event(EInputEvent::MouseButtonPressed, static_cast<uint16_t>(button));
+            }
+        }
+        if (s_pending.has_mouse_position)
+        {
+            write_value(s_recorded_frame_events, static_cast<uint8_t>(EInputEvent::MouseMoved));
+            write_value(s_recorded_frame_events, s_pending.mouse_position.x);
+            write_value(s_recorded_frame_events, s_pending.mouse_position.y);
+            ++s_recorded_frame_events_count;
+        }
+    }
+
+    bool Input::IsRecording()
+    {
+        return s_is_recording;
+    }
+
+    InputRecording Input::StopRecording()
+    {
+        s_is_recording = false;
+        s_recorded_frame_events.clear();
+        s_recorded_frame_events_count = 0;
+        InputRecording recording;
+        recording.m_stream = std::move(s_recorded_stream);
+        recording.m_frames_count = s_recorded_frames_count;
+        s_recorded_stream.clear();
+        s_recorded_frames_count = 0;
+        return recording;
+    }
+
+    void Input::StartReplay(InputRecording recording)
+    {
+        s_replay_stream = std::move(recording.m_stream);
+        s_replay_frames_count = recording.m_frames_count;
+        s_replay_position = 0;
+        s_replayed_frames_count = 0;
+        s_pending = PendingInput();
+        s_is_replaying = true;
+    }
+
+    bool Input::IsReplaying()
+    {
+        return s_is_replaying;
+    }
+
+    void Input::StopReplay()
+    {
+        if (!s_is_replaying)
+        {
+            return;
+        }
+        s_is_replaying = false;
+        s_replay_stream.clear();
+        s_replay_frames_count = 0;
+        // nothing stays held once the recording is over
+        s_pending = PendingInput();
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,225 @@
+#include "SimpleEngineCore/IrradianceProbes.hpp"
+#include "SimpleEngineCore/BakeScene.hpp"
+#include "SimpleEngineCore/JobSystem.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+namespace SimpleEngine {
+
+    // real L2 basis functions, same order as irradiance_probes_shader
+    static void evaluate_sh_basis(const glm::vec3& direction, float* basis)
+    {
+        const float x = direction.x;
+        const float y = direction.y;
+        const float z = direction.z;
+        basis[0] = 0.282095f;
+        basis[1] = 0.488603f * y;
+        basis[2] = 0.488603f * z;
+        basis[3] = 0.488603f * x;
+        basis[4] = 1.092548f * x * y;
+        basis[5] = 1.092548f * y * z;
+        basis[6] = 0.315392f * (3.f * z * z - 1.f);
+        basis[7] = 1.092548f * x * z;
+        basis[8] = 0.546274f * (x * x - y * y);
+    }
+
+    IrradianceProbes::IrradianceProbes()
+    {
+        configure(m_settings);
+    }
+
+    IrradianceProbes::~IrradianceProbes() = default;
+
+    void IrradianceProbes::configure(const Settings& settings)
+    {
+        m_settings = settings;
+        m_settings.grid_size = glm::max(m_settings.grid_size, glm::ivec3(1));
+        m_scene.reset();
+        m_stale_probes.clear();
+
+        // spherical Fibonacci points: an even spread of directions for any ray count
+        const uint32_t rays_count = std::max(m_settings.rays_per_probe, 1u);
+        m_directions.resize(rays_count);
+        const float golden_angle = glm::pi<float>() * (3.f - std::sqrt(5.f));
+        for (uint32_t i = 0; i < rays_count; ++i)
+        {
+            const float z = 1.f - (2.f * i + 1.f) / rays_count;
+            const float radius = std::sqrt(std::max(0.f, 1.f - z * z));
+            const float angle = golden_angle * i;
+            m_directions[i] = glm::vec3(radius * std::cos(angle), radius * std::sin(angle), z);
+        }
+
+        const size_t probes_count = size_t(m_settings.grid_size.x) * m_settings.grid_size.y * m_settings.grid_size.z;
+        m_texture_data.assign(probes_count * texels_per_probe, glm::vec4(0.f));
+        Coefficients sky{};
+        sky[0] = m_settings.sky_color / 0.282095f;
+        for (size_t probe = 0; probe < probes_count; ++probe)
+        {
+            store_probe(probe, sky);
+        }
+        m_has_changes = true;
+
+        m_stats = Stats();
+        m_stats.probes_count = probes_count;
+    }
+
+    void IrradianceProbes::set_scene(const std::vector<glm::vec3>& vertices, const DirectionalLight& directional_light, const std::vector<SpotLight>& spot_lights)
+    {
+        BakeScene::Settings scene_settings;
+        scene_settings.max_bounces = m_settings.max_bounces;
+        scene_settings.albedo = m_settings.albedo;
+        scene_settings.sky_color = m_settings.sky_color;
+        m_scene = std::make_unique<BakeScene>();
+        m_scene->build(vertices, directional_light, spot_lights, scene_settings);
+        ++m_scene_generation;
+
+        m_stale_probes.resize(m_stats.probes_count);
+        for (size_t probe = 0; probe < m_stale_probes.size(); ++probe)
+        {
+            m_stale_probes[probe] = probe;
+        }
+        m_stats.triangles_count = m_scene->get_triangles_count();
+        m_stats.stale_probes_count = m_stale_probes.size();
+    }
+
+    void IrradianceProbes::update(const glm::vec3& camera_position, const double time_budget_ms)
+    {
+        const auto start_time = std::chrono::steady_clock::now();
+        m_stats.probes_baked_last_update = 0;
+        m_stats.update_time_ms = 0.0;
+        if (!m_scene || m_stale_probes.empty())
+        {
+            return;
+        }
+
+        // nearest probes go last, so batches pop off the back
+        std::sort(m_stale_probes.begin(), m_stale_probes.end(), [&](const size_t a, const size_t b)
+            {
+                const glm::vec3 to_a = get_probe_position(a) - camera_position;
+                const glm::vec3 to_b = get_probe_position(b) - camera_position;
+                return glm::dot(to_a, to_a) > glm::dot(to_b, to_b);
+            });
+
+        // one probe per thread and batch keeps the overshoot past the budget to about one probe
+        const size_t batch_size = size_t(JobSystem::get_workers_count()) + 1;
+        std::atomic<uint64_t> rays_count{ 0 };
+        do
+        {
+            const size_t count = std::min(batch_size, m_stale_probes.size());
+            m_batch.assign(m_stale_probes.end() - count, m_stale_probes.end());
+            m_stale_probes.resize(m_stale_probes.size() - count);
+            m_batch_results.resize(count);
+            JobSystem::parallel_for(count, 1, [&](const size_t begin, const size_t end)
+                {
+                    uint64_t local_rays_count = 0;
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        m_batch_results[i] = bake_probe(m_batch[i], local_rays_count);
+                    }
+                    rays_count.fetch_add(local_rays_count, std::memory_order_relaxed);
+                });
+            for (size_t i = 0; i < count; ++i)
+            {
+                store_probe(m_batch[i], m_batch_results[i]);
+            }
+            m_stats.probes_baked_last_update += count;
+            m_stats.update_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+        } while (!m_stale_probes.empty() && m_stats.update_time_ms < time_budget_ms);
+
+        m_has_changes = true;
+        m_stats.rays_count += rays_count.load();
+        m_stats.stale_probes_count = m_stale_probes.size();
+    }
+
+    glm::vec3 IrradianceProbes::evaluate(const glm::vec3& position, const glm::vec3& normal) const
+    {
+        const glm::vec3 grid_position = glm::clamp((position - m_settings.origin) / m_settings.spacing, glm::vec3(0.f), glm::vec3(m_settings.grid_size - 1));
+        const glm::ivec3 cell = glm::min(glm::ivec3(grid_position), glm::max(m_settings.grid_size - 2, glm::ivec3(0)));
+        const glm::vec3 weights = grid_position - glm::vec3(cell);
+        const size_t slab_size = size_t(m_settings.grid_size.x) * m_settings.grid_size.y * m_settings.grid_size.z;
+
+        float packed[texels_per_probe * 4] = {};
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            const glm::ivec3 offset(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+            const glm::ivec3 probe_cell = glm::min(cell + offset, m_settings.grid_size - 1);
+            const float weight = (offset.x ? weights.x : 1.f - weights.x) * (offset.y ? weights.y : 1.f - weights.y) * (offset.z ? weights.z : 1.f - weights.z);
+            const size_t probe = (size_t(probe_cell.z) * m_settings.grid_size.y + probe_cell.y) * m_settings.grid_size.x + probe_cell.x;
+            for (size_t texel = 0; texel < texels_per_probe; ++texel)
+            {
+                const glm::vec4& value = m_texture_data[texel * slab_size + probe];
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    packed[texel * 4 + channel] += value[channel] * weight;
+                }
+            }
+        }
+
+        float basis[coefficients_count];
+        evaluate_sh_basis(glm::normalize(normal), basis);
+        glm::vec3 irradiance(0.f);
+        for (size_t i = 0; i < coefficients_count; ++i)
+        {
+            irradiance += glm::vec3(packed[3 * i], packed[3 * i + 1], packed[3 * i + 2]) * basis[i];
+        }
+        return glm::max(irradiance, glm::vec3(0.f));
+    }
+
+    glm::vec3 IrradianceProbes::get_probe_position(const size_t probe) const
+    {
+        const size_t x = probe % m_settings.grid_size.x;
+        const size_t y = probe / m_settings.grid_size.x % m_settings.grid_size.y;
+        const size_t z = probe / (size_t(m_settings.grid_size.x) * m_settings.grid_size.y);
+        return m_settings.origin + m_settings.spacing * glm::vec3(float(x), float(y), float(z));
+    }
+
+    IrradianceProbes::Coefficients IrradianceProbes::bake_probe(const size_t probe, uint64_t& rays_count) const
+    {
+        BakeRandom random(static_cast<uint32_t>(probe) * 7919u + m_scene_generation * 104729u + 1u);
+        const glm::vec3 position = get_probe_position(probe);
+        Coefficients coefficients{};
+        float basis[coefficients_count];
+        for (const glm::vec3& direction : m_directions)
+        {
+            const glm::vec3 radiance = m_scene->sample_incoming_radiance(position, direction, random, rays_count);
+            evaluate_sh_basis(direction, basis);
+            for (size_t i = 0; i < coefficients_count; ++i)
+            {
+                coefficients[i] += radiance * basis[i];
+            }
+        }
+
+        // Monte Carlo weight of a uniform sphere sample times the cosine lobe convolution per band
+        // (Ramamoorthi and Hanrahan), turning radiance coefficients into irradiance ones
+        const float sample_weight = 4.f * glm::pi<float>() / m_directions.size();
+        const float band_factors[3] = { glm::pi<float>(), 2.f * glm::pi<float>() / 3.f, glm::pi<float>() / 4.f };
+        for (size_t i = 0; i < coefficients_count; ++i)
+        {
+            coefficients[i] *= sample_weight * band_factors[i == 0 ? 0 : (i < 4 ? 1 : 2)];
+        }
+        return coefficients;
+    }
+
+    void IrradianceProbes::store_probe(const size_t probe, const Coefficients& coefficients)
+    {
+        float packed[texels_per_probe * 4] = {};
+        for (size_t i = 0; i < coefficients_count; ++i)
+        {
+            packed[3 * i] = coefficients[i].x;
+            packed[3 * i + 1] = coefficients[i].y;
+            packed[3 * i + 2] = coefficients[i].z;
+        }
+        const size_t slab_size = m_texture_data.size() / texels_per_probe;
+        for (size_t texel = 0; texel < texels_per_probe; ++texel)
+        {
+            m_texture_data[texel * slab_size + probe] = glm::vec4(packed[4 * texel], packed[4 * texel + 1], packed[4 * texel + 2], packed[4 * texel + 3]);
+        }
+    }
+}
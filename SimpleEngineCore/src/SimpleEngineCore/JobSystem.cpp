@@ -0,0 +1,232 @@
+#include "SimpleEngineCore/JobSystem.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Memory.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SimpleEngine {
+
+    constexpr size_t initial_jobs_capacity = 64;
+
+    struct JobQueue
+    {
+        std::vector<std::thread> workers;
+        // ring buffer: slots keep their storage when a job is popped, so a steady job rate doesn't allocate
+        std::vector<JobSystem::Job> jobs;
+        size_t jobs_head = 0;
+        size_t jobs_count = 0;
+        std::mutex mutex;
+        std::condition_variable job_available;
+        std::condition_variable idle;
+        size_t jobs_in_flight = 0;
+        bool stopping = false;
+    };
+
+    static JobQueue s_queue;
+
+    struct ParallelForState
+    {
+        const JobSystem::RangeJob* job = nullptr;
+        size_t count = 0;
+        size_t grain_size = 0;
+        size_t chunks_count = 0;
+        // allocations of the chunks are accounted to the subsystem that called parallel_for
+        EMemoryTag tag = EMemoryTag::General;
+        std::atomic<size_t> next_chunk{ 0 };
+        std::atomic<size_t> finished_chunks{ 0 };
+        // the caller and every helper hold one, the last to let go returns the state to the pool
+        std::atomic<size_t> references_count{ 0 };
+    };
+
+    static ObjectPool<ParallelForState> s_parallel_for_states(16, EMemoryTag::Jobs);
+
+    static void release(ParallelForState& state)
+    {
+        if (state.references_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            s_parallel_for_states.destroy(&state);
+        }
+    }
+
+    // called with the queue mutex held
+    static void push_job(JobSystem::Job&& job)
+    {
+        if (s_queue.jobs_count == s_queue.jobs.size())
+        {
+            std::vector<JobSystem::Job> jobs(std::max(s_queue.jobs.size() * 2, initial_jobs_capacity));
+            for (size_t i = 0; i < s_queue.jobs_count; ++i)
+            {
+                jobs[i] = std::move(s_queue.jobs[(s_queue.jobs_head + i) % s_queue.jobs.size()]);
+            }
+            s_queue.jobs = std::move(jobs);
+            s_queue.jobs_head = 0;
+        }
+        s_queue.jobs[(s_queue.jobs_head + s_queue.jobs_count) % s_queue.jobs.size()] = std::move(job);
+        ++s_queue.jobs_count;
+    }
+
+    static void run_chunks(ParallelForState& state)
+    {
+        PROFILE_SCOPE("JobSystem::parallel_for");
+        MemoryTagScope tag_scope(state.tag);
+        size_t chunk = state.next_chunk.fetch_add(1, std::memory_order_relaxed);
+        while (chunk < state.chunks_count)
+        {
+            const size_t begin = chunk * state.grain_size;
+            const size_t end = std::min(begin + state.grain_size, state.count);
+            (*state.job)(begin, end);
+            state.finished_chunks.fetch_add(1, std::memory_order_release);
+            chunk = state.next_chunk.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void worker_loop()
+    {
+        PROFILE_THREAD_NAME("Job worker");
+        MemoryTagScope tag_scope(EMemoryTag::Jobs);
+        JobSystem::Job job;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(s_queue.mutex);
+                s_queue.job_available.wait(lock, [] { return s_queue.stopping || s_queue.jobs_count > 0; });
+                if (s_queue.stopping && s_queue.jobs_count == 0)
+                {
+                    return;
+                }
+                job = std::move(s_queue.jobs[s_queue.jobs_head]);
+                s_queue.jobs_head = (s_queue.jobs_head + 1) % s_queue.jobs.size();
+                --s_queue.jobs_count;
+            }
+
+            job();
+            job = nullptr;
+
+            std::lock_guard<std::mutex> lock(s_queue.mutex);
+            if (--s_queue.jobs_in_flight == 0)
+            {
+                s_queue.idle.notify_all();
+            }
+        }
+    }
+
+    void JobSystem::init(unsigned int workers_count)
+    {
+        if (!s_queue.workers.empty())
+        {
+            return;
+        }
+
+        if (workers_count == 0)
+        {
+            const unsigned int hardware_threads = std::thread::hardware_concurrency();
+            workers_count = hardware_threads > 1 ? hardware_threads - 1 : 1;
+        }
+
+        LOG_INFO("JobSystem: starting {0} worker threads", workers_count);
+
+        s_queue.stopping = false;
+        {
+            std::lock_guard<std::mutex> lock(s_queue.mutex);
+            if (s_queue.jobs.empty())
+            {
+                s_queue.jobs.resize(initial_jobs_capacity);
+            }
+        }
+        s_queue.workers.reserve(workers_count);
+        for (unsigned int i = 0; i < workers_count; ++i)
+        {
+            s_queue.workers.emplace_back(worker_loop);
+        }
+    }
+
+    void JobSystem::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_queue.mutex);
+            s_queue.stopping = true;
+        }
+        s_queue.job_available.notify_all();
+        for (std::thread& worker : s_queue.workers)
+        {
+            worker.join();
+        }
+        s_queue.workers.clear();
+    }
+
+    void JobSystem::submit(Job job)
+    {
+        if (s_queue.workers.empty())
+        {
+            job();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(s_queue.mutex);
+            push_job(std::move(job));
+            ++s_queue.jobs_in_flight;
+        }
+        s_queue.job_available.notify_one();
+    }
+
+    void JobSystem::parallel_for(const size_t count, const size_t grain_size, const RangeJob& job)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        const size_t grain = grain_size > 0 ? grain_size : 1;
+        if (count <= grain || s_queue.workers.empty())
+        {
+            job(0, count);
+            return;
+        }
+
+        ParallelForState* pState = s_parallel_for_states.create();
+        pState->job = &job;
+        pState->count = count;
+        pState->grain_size = grain;
+        pState->chunks_count = (count + grain - 1) / grain;
+        pState->tag = MemoryTagScope::get_current();
+
+        const size_t helpers_count = std::min(pState->chunks_count - 1, s_queue.workers.size());
+        pState->references_count.store(helpers_count + 1, std::memory_order_relaxed);
+        for (size_t i = 0; i < helpers_count; ++i)
+        {
+            // helpers hold the state alive: one that starts after all chunks are taken only reads the counters.
+            // A single pointer capture is stored inside the std::function itself.
+            submit([pState]()
+                {
+                    run_chunks(*pState);
+                    release(*pState);
+                });
+        }
+
+        run_chunks(*pState);
+
+        while (pState->finished_chunks.load(std::memory_order_acquire) < pState->chunks_count)
+        {
+            std::this_thread::yield();
+        }
+        release(*pState);
+    }
+
+    void JobSystem::wait_idle()
+    {
+        std::unique_lock<std::mutex> lock(s_queue.mutex);
+        s_queue.idle.wait(lock, [] { return s_queue.jobs_in_flight == 0; });
+    }
+
+    unsigned int JobSystem::get_workers_count()
+    {
+        return static_cast<unsigned int>(s_queue.workers.size());
+    }
+}
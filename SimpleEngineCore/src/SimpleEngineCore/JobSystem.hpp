@@ -0,0 +1,51 @@
+#pragma once
+
+#include <functional>
+#include <cstddef>
+#include <type_traits>
+
+namespace SimpleEngine {
+
+    class JobSystem
+    {
+    public:
+        using Job = std::function<void()>;
+
+        // Non-owning view of a callable taking (begin, end). parallel_for returns only when the work is done,
+        // so the caller's lambda is referenced in place instead of being copied into a heap allocated std::function.
+        class RangeJob
+        {
+        public:
+            template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, RangeJob>>>
+            RangeJob(const F& callable)
+                : m_pCallable(&callable)
+                , m_invoke([](const void* pCallable, const size_t begin, const size_t end) { (*static_cast<const F*>(pCallable))(begin, end); })
+            {
+            }
+
+            void operator()(const size_t begin, const size_t end) const
+            {
+                m_invoke(m_pCallable, begin, end);
+            }
+
+        private:
+            const void* m_pCallable;
+            void (*m_invoke)(const void* pCallable, const size_t begin, const size_t end);
+        };
+
+        // workers_count == 0 means "one worker per hardware thread except the calling one"
+        static void init(unsigned int workers_count = 0);
+        static void shutdown();
+
+        static void submit(Job job);
+
+        // Splits [0, count) into chunks of grain_size and runs them on the workers.
+        // The calling thread takes part in the work and returns when every chunk is done.
+        // Doesn't allocate: the shared state comes from a pool and the helper jobs fit in std::function's inline storage.
+        static void parallel_for(const size_t count, const size_t grain_size, const RangeJob& job);
+
+        static void wait_idle();
+        static unsigned int get_workers_count();
+    };
+
+}
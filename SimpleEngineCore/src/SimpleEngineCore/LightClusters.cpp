@@ -0,0 +1,247 @@
+#include "SimpleEngineCore/LightClusters.hpp"
+#include "SimpleEngineCore/Camera.hpp"
+#include "SimpleEngineCore/JobSystem.hpp"
+#include "SimpleEngineCore/Math/BatchMath.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace SimpleEngine {
+
+    constexpr uint32_t tiles_count = LightClusters::grid_size_x * LightClusters::grid_size_y;
+    constexpr size_t lights_grain_size = 1024;
+
+    static float distance_to_range(const float value, const float min_value, const float max_value)
+    {
+        return value < min_value ? min_value - value : (value > max_value ? value - max_value : 0.f);
+    }
+
+    // maps an NDC range to the range of tiles it covers
+    static bool get_tile_range(const float min_value, const float max_value, const uint32_t grid_size, uint32_t& first, uint32_t& last)
+    {
+        if (max_value < -1.f || min_value > 1.f)
+        {
+            return false;
+        }
+        const float max_tile = static_cast<float>(grid_size - 1);
+        first = static_cast<uint32_t>(std::min(std::max((min_value + 1.f) * 0.5f * grid_size, 0.f), max_tile));
+        last = static_cast<uint32_t>(std::min(std::max((max_value + 1.f) * 0.5f * grid_size, 0.f), max_tile));
+        return true;
+    }
+
+    void LightClusters::build(const std::vector<PointLight>& lights, Camera& camera)
+    {
+        const auto start_time = std::chrono::steady_clock::now();
+
+        const glm::mat4& view_matrix = camera.get_view_matrix();
+        const glm::mat4& projection_matrix = camera.get_projection_matrix();
+        m_perspective = camera.get_projection_mode() == Camera::ProjectionMode::Perspective;
+        m_projection_scale_x = projection_matrix[0][0];
+        m_projection_scale_y = projection_matrix[1][1];
+        m_projection_offset_x = projection_matrix[3][0];
+        m_projection_offset_y = projection_matrix[3][1];
+
+        const float near_depth = camera.get_near_clip_plane();
+        const float far_depth = camera.get_far_clip_plane();
+        const float log_depth_ratio = std::log(far_depth / near_depth);
+        m_z_scale = grid_size_z / log_depth_ratio;
+        m_z_bias = -(grid_size_z * std::log(near_depth)) / log_depth_ratio;
+        for (uint32_t slice = 0; slice <= grid_size_z; ++slice)
+        {
+            m_slice_depths[slice] = near_depth * std::pow(far_depth / near_depth, static_cast<float>(slice) / grid_size_z);
+        }
+
+        const size_t lights_count = lights.size();
+        m_world_positions.resize(lights_count);
+        m_view_positions.resize(lights_count);
+        m_light_bounds.resize(lights_count);
+        m_gpu_lights.resize(lights_count);
+        for (size_t i = 0; i < lights_count; ++i)
+        {
+            m_world_positions[i] = glm::vec4(lights[i].position, 1.f);
+        }
+        BatchMath::mat4_mul_vec4(view_matrix, m_world_positions.data(), m_view_positions.data(), lights_count);
+
+        const float max_slice = static_cast<float>(grid_size_z - 1);
+        const auto depth_to_slice = [&](const float depth)
+        {
+            return static_cast<uint32_t>(std::min(std::max(std::log(depth) * m_z_scale + m_z_bias, 0.f), max_slice));
+        };
+
+        JobSystem::parallel_for(lights_count, lights_grain_size,
+            [&](const size_t begin, const size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const PointLight& light = lights[i];
+                    m_gpu_lights[i].position_radius = glm::vec4(glm::vec3(m_view_positions[i]), light.radius);
+                    m_gpu_lights[i].color_intensity = glm::vec4(light.color, light.intensity);
+
+                    const float depth = -m_view_positions[i].z;
+                    if (depth + light.radius < near_depth || depth - light.radius > far_depth)
+                    {
+                        m_light_bounds[i] = { 1, 0 };
+                        continue;
+                    }
+                    m_light_bounds[i] = { depth_to_slice(std::max(depth - light.radius, near_depth)),
+                                          depth_to_slice(std::min(depth + light.radius, far_depth)) };
+                }
+            });
+
+        JobSystem::parallel_for(grid_size_z, 1,
+            [&](const size_t begin, const size_t end)
+            {
+                for (size_t slice = begin; slice < end; ++slice)
+                {
+                    assign_slice(static_cast<uint32_t>(slice));
+                }
+            });
+
+        // slices are independent, so only their base offsets are resolved serially
+        std::array<uint32_t, grid_size_z> slice_offsets;
+        uint32_t light_indices_count = 0;
+        for (uint32_t slice = 0; slice < grid_size_z; ++slice)
+        {
+            slice_offsets[slice] = light_indices_count;
+            light_indices_count += static_cast<uint32_t>(m_slice_bins[slice].light_indices.size());
+        }
+        m_light_indices.resize(light_indices_count);
+
+        JobSystem::parallel_for(grid_size_z, 1,
+            [&](const size_t begin, const size_t end)
+            {
+                for (size_t slice = begin; slice < end; ++slice)
+                {
+                    const SliceBin& bin = m_slice_bins[slice];
+                    std::copy(bin.light_indices.begin(), bin.light_indices.end(), m_light_indices.begin() + slice_offsets[slice]);
+                    GpuCluster* clusters = &m_clusters[slice * tiles_count];
+                    for (uint32_t tile = 0; tile < tiles_count; ++tile)
+                    {
+                        clusters[tile].offset = slice_offsets[slice] + bin.tile_offsets[tile];
+                        clusters[tile].count = bin.tile_offsets[tile + 1] - bin.tile_offsets[tile];
+                    }
+                }
+            });
+
+        m_last_build_stats = Stats();
+        m_last_build_stats.lights_count = lights_count;
+        m_last_build_stats.light_indices_count = light_indices_count;
+        for (const LightBounds& bounds : m_light_bounds)
+        {
+            m_last_build_stats.visible_lights_count += bounds.first_slice <= bounds.last_slice ? 1 : 0;
+        }
+        for (const SliceBin& bin : m_slice_bins)
+        {
+            m_last_build_stats.max_lights_per_cluster = std::max(m_last_build_stats.max_lights_per_cluster, bin.max_lights_per_cluster);
+        }
+        m_last_build_stats.build_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    }
+
+    void LightClusters::assign_slice(const uint32_t slice)
+    {
+        SliceBin& bin = m_slice_bins[slice];
+        bin.tile_light_pairs.clear();
+
+        const float slice_near = m_slice_depths[slice];
+        const float slice_far = m_slice_depths[slice + 1];
+
+        // view-space bounds of every tile column and row inside this slice
+        std::array<float, grid_size_x> tile_min_x, tile_max_x;
+        std::array<float, grid_size_y> tile_min_y, tile_max_y;
+        const auto tile_bounds = [&](const float u0, const float u1, const float scale, const float offset, float& min_value, float& max_value)
+        {
+            if (m_perspective)
+            {
+                min_value = std::min(u0 * slice_near, u0 * slice_far) / scale;
+                max_value = std::max(u1 * slice_near, u1 * slice_far) / scale;
+            }
+            else
+            {
+                min_value = (u0 - offset) / scale;
+                max_value = (u1 - offset) / scale;
+            }
+        };
+        for (uint32_t x = 0; x < grid_size_x; ++x)
+        {
+            tile_bounds(-1.f + 2.f * x / grid_size_x, -1.f + 2.f * (x + 1) / grid_size_x, m_projection_scale_x, m_projection_offset_x, tile_min_x[x], tile_max_x[x]);
+        }
+        for (uint32_t y = 0; y < grid_size_y; ++y)
+        {
+            tile_bounds(-1.f + 2.f * y / grid_size_y, -1.f + 2.f * (y + 1) / grid_size_y, m_projection_scale_y, m_projection_offset_y, tile_min_y[y], tile_max_y[y]);
+        }
+
+        const auto project = [&](const float value, const float depth, const float scale, const float offset)
+        {
+            return m_perspective ? value * scale / depth : value * scale + offset;
+        };
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_light_bounds.size()); ++i)
+        {
+            if (slice < m_light_bounds[i].first_slice || slice > m_light_bounds[i].last_slice)
+            {
+                continue;
+            }
+
+            const glm::vec4& position_radius = m_gpu_lights[i].position_radius;
+            const float radius = position_radius.w;
+            const float depth = -position_radius.z;
+            const float near_depth = std::max(slice_near, depth - radius);
+            const float far_depth = std::min(slice_far, depth + radius);
+
+            // screen-space bounds of the light's box clipped to the slice
+            const float min_x = position_radius.x - radius;
+            const float max_x = position_radius.x + radius;
+            const float min_y = position_radius.y - radius;
+            const float max_y = position_radius.y + radius;
+            uint32_t first_x, last_x, first_y, last_y;
+            if (!get_tile_range(std::min(project(min_x, near_depth, m_projection_scale_x, m_projection_offset_x), project(min_x, far_depth, m_projection_scale_x, m_projection_offset_x)),
+                                std::max(project(max_x, near_depth, m_projection_scale_x, m_projection_offset_x), project(max_x, far_depth, m_projection_scale_x, m_projection_offset_x)),
+                                grid_size_x, first_x, last_x) ||
+                !get_tile_range(std::min(project(min_y, near_depth, m_projection_scale_y, m_projection_offset_y), project(min_y, far_depth, m_projection_scale_y, m_projection_offset_y)),
+                                std::max(project(max_y, near_depth, m_projection_scale_y, m_projection_offset_y), project(max_y, far_depth, m_projection_scale_y, m_projection_offset_y)),
+                                grid_size_y, first_y, last_y))
+            {
+                continue;
+            }
+
+            // the box is conservative, so every candidate cluster gets an exact sphere test
+            const float distance_z = distance_to_range(depth, slice_near, slice_far);
+            const float radius_squared = radius * radius - distance_z * distance_z;
+            for (uint32_t y = first_y; y <= last_y; ++y)
+            {
+                const float distance_y = distance_to_range(position_radius.y, tile_min_y[y], tile_max_y[y]);
+                for (uint32_t x = first_x; x <= last_x; ++x)
+                {
+                    const float distance_x = distance_to_range(position_radius.x, tile_min_x[x], tile_max_x[x]);
+                    if (distance_x * distance_x + distance_y * distance_y <= radius_squared)
+                    {
+                        const uint64_t tile = x + y * grid_size_x;
+                        bin.tile_light_pairs.push_back((tile << 32) | i);
+                    }
+                }
+            }
+        }
+
+        // counting sort by tile keeps the lights of every cluster in ascending order
+        bin.tile_offsets.assign(tiles_count + 1, 0);
+        for (const uint64_t pair : bin.tile_light_pairs)
+        {
+            ++bin.tile_offsets[(pair >> 32) + 1];
+        }
+        bin.max_lights_per_cluster = 0;
+        for (uint32_t tile = 0; tile < tiles_count; ++tile)
+        {
+            bin.max_lights_per_cluster = std::max(bin.max_lights_per_cluster, bin.tile_offsets[tile + 1]);
+            bin.tile_offsets[tile + 1] += bin.tile_offsets[tile];
+        }
+
+        std::array<uint32_t, tiles_count> fill_positions;
+        std::copy(bin.tile_offsets.begin(), bin.tile_offsets.end() - 1, fill_positions.begin());
+        bin.light_indices.resize(bin.tile_light_pairs.size());
+        for (const uint64_t pair : bin.tile_light_pairs)
+        {
+            bin.light_indices[fill_positions[pair >> 32]++] = static_cast<uint32_t>(pair);
+        }
+    }
+}
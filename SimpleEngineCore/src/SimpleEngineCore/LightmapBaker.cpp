@@ -0,0 +1,538 @@
+#include "SimpleEngineCore/LightmapBaker.hpp"
+#include "SimpleEngineCore/JobSystem.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/BakeScene.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/matrix.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+namespace SimpleEngine {
+
+    constexpr uint32_t bake_tile_size = 16;
+    constexpr uint32_t no_region = ~0u;
+    constexpr float coplanar_cos = 0.99f;
+
+    namespace {
+
+        float triangle_area(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+        {
+            return 0.5f * glm::length(glm::cross(b - a, c - a));
+        }
+
+        float triangle_area(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c)
+        {
+            return 0.5f * std::abs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y));
+        }
+
+        uint32_t find_root(std::vector<uint32_t>& parents, uint32_t index)
+        {
+            while (parents[index] != index)
+            {
+                parents[index] = parents[parents[index]];
+                index = parents[index];
+            }
+            return index;
+        }
+
+    }
+
+    std::vector<glm::vec2> LightmapBaker::generate_lightmap_uvs(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const float gutter)
+    {
+        const size_t triangles_count = indices.size() / 3;
+        std::vector<glm::vec3> face_normals(triangles_count);
+        for (size_t i = 0; i < triangles_count; ++i)
+        {
+            const glm::vec3 normal = glm::cross(positions[indices[3 * i + 1]] - positions[indices[3 * i]], positions[indices[3 * i + 2]] - positions[indices[3 * i]]);
+            const float length = glm::length(normal);
+            face_normals[i] = length > 0.f ? normal / length : glm::vec3(0.f, 0.f, 1.f);
+        }
+
+        // charts: coplanar triangles connected through shared vertices
+        std::vector<std::vector<uint32_t>> vertex_triangles(positions.size());
+        for (uint32_t i = 0; i < indices.size(); ++i)
+        {
+            vertex_triangles[indices[i]].push_back(i / 3);
+        }
+        std::vector<uint32_t> parents(triangles_count);
+        std::iota(parents.begin(), parents.end(), 0);
+        for (const std::vector<uint32_t>& triangles : vertex_triangles)
+        {
+            for (size_t a = 0; a < triangles.size(); ++a)
+            {
+                for (size_t b = a + 1; b < triangles.size(); ++b)
+                {
+                    if (glm::dot(face_normals[triangles[a]], face_normals[triangles[b]]) > coplanar_cos)
+                    {
+                        parents[find_root(parents, triangles[a])] = find_root(parents, triangles[b]);
+                    }
+                }
+            }
+        }
+
+        struct Chart
+        {
+            glm::vec3 normal{ 0.f };
+            std::vector<uint32_t> vertices;
+            glm::vec2 min{ std::numeric_limits<float>::max() };
+            glm::vec2 max{ -std::numeric_limits<float>::max() };
+            glm::vec2 offset{ 0.f };
+        };
+        std::vector<Chart> charts;
+        std::vector<uint32_t> root_to_chart(triangles_count, no_region);
+        std::vector<uint32_t> vertex_charts(positions.size(), no_region);
+        size_t shared_vertices_count = 0;
+        for (uint32_t i = 0; i < triangles_count; ++i)
+        {
+            const uint32_t root = find_root(parents, i);
+            if (root_to_chart[root] == no_region)
+            {
+                root_to_chart[root] = static_cast<uint32_t>(charts.size());
+                charts.emplace_back();
+            }
+            const uint32_t chart_index = root_to_chart[root];
+            Chart& chart = charts[chart_index];
+            chart.normal += face_normals[i];
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t vertex = indices[3 * i + corner];
+                if (vertex_charts[vertex] == no_region)
+                {
+                    vertex_charts[vertex] = chart_index;
+                    chart.vertices.push_back(vertex);
+                }
+                else if (vertex_charts[vertex] != chart_index)
+                {
+                    ++shared_vertices_count;
+                }
+            }
+        }
+        if (shared_vertices_count > 0)
+        {
+            LOG_WARN("generate_lightmap_uvs: {0} vertices are shared by several charts", shared_vertices_count);
+        }
+
+        // planar projection of every chart onto its average plane
+        std::vector<glm::vec2> uvs(positions.size(), glm::vec2(0.f));
+        float total_area = 0.f;
+        for (Chart& chart : charts)
+        {
+            glm::vec3 tangent;
+            glm::vec3 bitangent;
+            make_orthonormal_basis(glm::normalize(chart.normal), tangent, bitangent);
+            for (const uint32_t vertex : chart.vertices)
+            {
+                uvs[vertex] = glm::vec2(glm::dot(positions[vertex], tangent), glm::dot(positions[vertex], bitangent));
+                chart.min = glm::min(chart.min, uvs[vertex]);
+                chart.max = glm::max(chart.max, uvs[vertex]);
+            }
+            const glm::vec2 size = chart.max - chart.min;
+            total_area += size.x * size.y;
+        }
+
+        // shelf packing, tallest charts first, growing the square until everything fits
+        std::vector<size_t> order(charts.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](const size_t a, const size_t b)
+            {
+                return charts[a].max.y - charts[a].min.y > charts[b].max.y - charts[b].min.y;
+            });
+        float side = std::sqrt(std::max(total_area, 1e-12f));
+        for (bool fits = false; !fits; side *= 1.05f)
+        {
+            const float margin = gutter * side;
+            float x = margin;
+            float y = margin;
+            float shelf_height = 0.f;
+            fits = true;
+            for (const size_t chart_index : order)
+            {
+                Chart& chart = charts[chart_index];
+                const glm::vec2 size = chart.max - chart.min;
+                if (x + size.x + margin > side)
+                {
+                    x = margin;
+                    y += shelf_height + margin;
+                    shelf_height = 0.f;
+                }
+                if (x + size.x + margin > side || y + size.y + margin > side)
+                {
+                    fits = false;
+                    break;
+                }
+                chart.offset = glm::vec2(x, y);
+                x += size.x + margin;
+                shelf_height = std::max(shelf_height, size.y);
+            }
+            if (fits)
+            {
+                break;
+            }
+        }
+
+        for (const Chart& chart : charts)
+        {
+            for (const uint32_t vertex : chart.vertices)
+            {
+                uvs[vertex] = (uvs[vertex] - chart.min + chart.offset) / side;
+            }
+        }
+        return uvs;
+    }
+
+    size_t LightmapBaker::add_mesh(Mesh mesh)
+    {
+        m_meshes.push_back(std::move(mesh));
+        return m_meshes.size() - 1;
+    }
+
+    size_t LightmapBaker::add_instance(const size_t mesh_index, const glm::mat4& world_matrix)
+    {
+        Instance instance;
+        instance.mesh_index = mesh_index;
+        instance.world_matrix = world_matrix;
+        m_instances.push_back(instance);
+        return m_instances.size() - 1;
+    }
+
+    void LightmapBaker::clear()
+    {
+        m_meshes.clear();
+        m_instances.clear();
+        m_lightmap.clear();
+        m_lightmap_size = 0;
+    }
+
+    bool LightmapBaker::allocate_regions(const Settings& settings)
+    {
+        // region size gives every instance the requested world space texel density
+        std::vector<float> mesh_uv_areas(m_meshes.size(), 0.f);
+        for (size_t i = 0; i < m_meshes.size(); ++i)
+        {
+            const Mesh& mesh = m_meshes[i];
+            for (size_t j = 0; j + 2 < mesh.indices.size(); j += 3)
+            {
+                mesh_uv_areas[i] += triangle_area(mesh.lightmap_uvs[mesh.indices[j]], mesh.lightmap_uvs[mesh.indices[j + 1]], mesh.lightmap_uvs[mesh.indices[j + 2]]);
+            }
+        }
+        std::vector<float> density_scales(m_instances.size(), 0.f);
+        for (size_t i = 0; i < m_instances.size(); ++i)
+        {
+            const Instance& instance = m_instances[i];
+            const Mesh& mesh = m_meshes[instance.mesh_index];
+            float world_area = 0.f;
+            for (size_t j = 0; j + 2 < mesh.indices.size(); j += 3)
+            {
+                world_area += triangle_area(glm::vec3(instance.world_matrix * glm::vec4(mesh.positions[mesh.indices[j]], 1.f)),
+                                            glm::vec3(instance.world_matrix * glm::vec4(mesh.positions[mesh.indices[j + 1]], 1.f)),
+                                            glm::vec3(instance.world_matrix * glm::vec4(mesh.positions[mesh.indices[j + 2]], 1.f)));
+            }
+            density_scales[i] = mesh_uv_areas[instance.mesh_index] > 0.f ? std::sqrt(world_area / mesh_uv_areas[instance.mesh_index]) : 0.f;
+        }
+
+        std::vector<size_t> order(m_instances.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](const size_t a, const size_t b) { return density_scales[a] > density_scales[b]; });
+
+        const uint32_t size = settings.lightmap_size;
+        float texels_per_unit = settings.texels_per_unit;
+        for (int attempt = 0; attempt < 32; ++attempt, texels_per_unit *= 0.85f)
+        {
+            uint32_t x = 0;
+            uint32_t y = 0;
+            uint32_t shelf_height = 0;
+            bool fits = true;
+            for (const size_t instance_index : order)
+            {
+                Instance& instance = m_instances[instance_index];
+                const uint32_t region_size = std::clamp(static_cast<uint32_t>(std::ceil(density_scales[instance_index] * texels_per_unit)), min_region_size, size);
+                if (x + region_size > size)
+                {
+                    x = 0;
+                    y += shelf_height;
+                    shelf_height = 0;
+                }
+                if (y + region_size > size)
+                {
+                    fits = false;
+                    break;
+                }
+                instance.region_x = x;
+                instance.region_y = y;
+                instance.region_size = region_size;
+                x += region_size;
+                shelf_height = std::max(shelf_height, region_size);
+            }
+            if (fits)
+            {
+                m_stats.texels_per_unit = texels_per_unit;
+                for (Instance& instance : m_instances)
+                {
+                    instance.scale_offset = glm::vec4(static_cast<float>(instance.region_size), static_cast<float>(instance.region_size),
+                                                      static_cast<float>(instance.region_x), static_cast<float>(instance.region_y)) / static_cast<float>(size);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool LightmapBaker::bake(const Settings& settings, const DirectionalLight& directional_light, const std::vector<SpotLight>& spot_lights)
+    {
+        const auto start_time = std::chrono::steady_clock::now();
+        m_stats = Stats();
+        m_stats.instances_count = m_instances.size();
+        if (m_instances.empty() || settings.lightmap_size == 0)
+        {
+            LOG_WARN("LightmapBaker: nothing to bake");
+            return false;
+        }
+        if (!allocate_regions(settings))
+        {
+            LOG_ERROR("LightmapBaker: {0} instances do not fit a {1}x{1} lightmap", m_instances.size(), settings.lightmap_size);
+            return false;
+        }
+
+        BakeScene scene;
+        {
+            std::vector<glm::vec3> vertices;
+            for (const Instance& instance : m_instances)
+            {
+                const Mesh& mesh = m_meshes[instance.mesh_index];
+                for (const uint32_t index : mesh.indices)
+                {
+                    vertices.push_back(glm::vec3(instance.world_matrix * glm::vec4(mesh.positions[index], 1.f)));
+                }
+            }
+            m_stats.triangles_count = vertices.size() / 3;
+            const auto bvh_start_time = std::chrono::steady_clock::now();
+            BakeScene::Settings scene_settings;
+            scene_settings.max_bounces = settings.max_bounces;
+            scene_settings.albedo = settings.albedo;
+            scene_settings.sky_color = settings.sky_color;
+            scene.build(vertices, directional_light, spot_lights, scene_settings);
+            m_stats.bvh_build_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - bvh_start_time).count();
+        }
+
+        // surface point behind every texel center covered by a triangle
+        const uint32_t size = settings.lightmap_size;
+        const size_t texels_count = static_cast<size_t>(size) * size;
+        std::vector<glm::vec3> texel_positions(texels_count);
+        std::vector<glm::vec3> texel_normals(texels_count);
+        std::vector<uint32_t> texel_regions(texels_count, no_region);
+        std::vector<uint8_t> covered(texels_count, 0);
+        JobSystem::parallel_for(m_instances.size(), 1, [&](const size_t begin, const size_t end)
+            {
+                for (size_t instance_index = begin; instance_index < end; ++instance_index)
+                {
+                    const Instance& instance = m_instances[instance_index];
+                    const Mesh& mesh = m_meshes[instance.mesh_index];
+                    const glm::mat3 normal_matrix = glm::transpose(glm::inverse(glm::mat3(instance.world_matrix)));
+                    const uint32_t region_size = instance.region_size;
+                    for (uint32_t y = 0; y < region_size; ++y)
+                    {
+                        for (uint32_t x = 0; x < region_size; ++x)
+                        {
+                            texel_regions[(instance.region_y + y) * size_t(size) + instance.region_x + x] = static_cast<uint32_t>(instance_index);
+                        }
+                    }
+
+                    for (size_t j = 0; j + 2 < mesh.indices.size(); j += 3)
+                    {
+                        const uint32_t i0 = mesh.indices[j];
+                        const uint32_t i1 = mesh.indices[j + 1];
+                        const uint32_t i2 = mesh.indices[j + 2];
+                        const glm::vec2 a = mesh.lightmap_uvs[i0] * static_cast<float>(region_size);
+                        const glm::vec2 b = mesh.lightmap_uvs[i1] * static_cast<float>(region_size);
+                        const glm::vec2 c = mesh.lightmap_uvs[i2] * static_cast<float>(region_size);
+                        const float area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+                        if (std::abs(area) < 1e-12f)
+                        {
+                            continue;
+                        }
+                        const glm::vec2 min = glm::max(glm::floor(glm::min(a, glm::min(b, c))), glm::vec2(0.f));
+                        const glm::vec2 max = glm::min(glm::ceil(glm::max(a, glm::max(b, c))), glm::vec2(static_cast<float>(region_size)));
+                        for (uint32_t y = static_cast<uint32_t>(min.y); y < static_cast<uint32_t>(max.y); ++y)
+                        {
+                            for (uint32_t x = static_cast<uint32_t>(min.x); x < static_cast<uint32_t>(max.x); ++x)
+                            {
+                                const glm::vec2 p(x + 0.5f, y + 0.5f);
+                                const float w0 = ((b.x - p.x) * (c.y - p.y) - (c.x - p.x) * (b.y - p.y)) / area;
+                                const float w1 = ((c.x - p.x) * (a.y - p.y) - (a.x - p.x) * (c.y - p.y)) / area;
+                                const float w2 = 1.f - w0 - w1;
+                                if (w0 < -1e-5f || w1 < -1e-5f || w2 < -1e-5f)
+                                {
+                                    continue;
+                                }
+                                const size_t texel = (instance.region_y + y) * size_t(size) + instance.region_x + x;
+                                const glm::vec3 local_position = mesh.positions[i0] * w0 + mesh.positions[i1] * w1 + mesh.positions[i2] * w2;
+                                const glm::vec3 local_normal = mesh.normals[i0] * w0 + mesh.normals[i1] * w1 + mesh.normals[i2] * w2;
+                                texel_positions[texel] = glm::vec3(instance.world_matrix * glm::vec4(local_position, 1.f));
+                                texel_normals[texel] = glm::normalize(normal_matrix * local_normal);
+                                covered[texel] = 1;
+                            }
+                        }
+                    }
+                }
+            });
+        m_stats.covered_texels_count = static_cast<size_t>(std::count(covered.begin(), covered.end(), uint8_t(1)));
+
+        // path tracing, one tile of texels per job
+        std::vector<glm::vec3> irradiance(texels_count, glm::vec3(0.f));
+        std::atomic<uint64_t> rays_count{ 0 };
+        const uint32_t tiles_per_side = (size + bake_tile_size - 1) / bake_tile_size;
+        JobSystem::parallel_for(static_cast<size_t>(tiles_per_side) * tiles_per_side, 1, [&](const size_t begin, const size_t end)
+            {
+                uint64_t local_rays_count = 0;
+                for (size_t tile = begin; tile < end; ++tile)
+                {
+                    const uint32_t tile_x = static_cast<uint32_t>(tile % tiles_per_side) * bake_tile_size;
+                    const uint32_t tile_y = static_cast<uint32_t>(tile / tiles_per_side) * bake_tile_size;
+                    for (uint32_t y = tile_y; y < std::min(tile_y + bake_tile_size, size); ++y)
+                    {
+                        for (uint32_t x = tile_x; x < std::min(tile_x + bake_tile_size, size); ++x)
+                        {
+                            const size_t texel = y * size_t(size) + x;
+                            if (!covered[texel])
+                            {
+                                continue;
+                            }
+                            BakeRandom random(static_cast<uint32_t>(texel) * 9781u + settings.seed * 6271u);
+                            glm::vec3 texel_irradiance(0.f);
+                            for (uint32_t sample = 0; sample < settings.samples_per_texel; ++sample)
+                            {
+                                texel_irradiance += scene.sample_indirect_irradiance(texel_positions[texel], texel_normals[texel], settings.max_bounces, random, local_rays_count);
+                            }
+                            irradiance[texel] = texel_irradiance / static_cast<float>(std::max(settings.samples_per_texel, 1u));
+                        }
+                    }
+                }
+                rays_count.fetch_add(local_rays_count, std::memory_order_relaxed);
+            });
+        m_stats.rays_count = rays_count.load();
+
+        // Denoising: a joint bilateral filter guided by normals and positions, so it smooths the noise
+        // without blurring across edges or between instances
+        m_lightmap_size = size;
+        m_lightmap.assign(texels_count, glm::vec3(0.f));
+        const int radius = static_cast<int>(settings.denoise_radius);
+        const float spatial_factor = -1.f / (2.f * std::max(0.5f * radius, 0.5f) * std::max(0.5f * radius, 0.5f));
+        const float position_sigma = 2.f / std::max(m_stats.texels_per_unit, 1e-3f);
+        const float position_factor = -1.f / (2.f * position_sigma * position_sigma);
+        JobSystem::parallel_for(size, 8, [&](const size_t begin, const size_t end)
+            {
+                for (size_t y = begin; y < end; ++y)
+                {
+                    for (size_t x = 0; x < size; ++x)
+                    {
+                        const size_t texel = y * size + x;
+                        if (!covered[texel])
+                        {
+                            continue;
+                        }
+                        glm::vec3 sum(0.f);
+                        float weights_sum = 0.f;
+                        for (int dy = -radius; dy <= radius; ++dy)
+                        {
+                            for (int dx = -radius; dx <= radius; ++dx)
+                            {
+                                const int nx = static_cast<int>(x) + dx;
+                                const int ny = static_cast<int>(y) + dy;
+                                if (nx < 0 || ny < 0 || nx >= static_cast<int>(size) || ny >= static_cast<int>(size))
+                                {
+                                    continue;
+                                }
+                                const size_t neighbour = static_cast<size_t>(ny) * size + nx;
+                                if (!covered[neighbour] || texel_regions[neighbour] != texel_regions[texel])
+                                {
+                                    continue;
+                                }
+                                const float normal_weight = std::pow(std::max(glm::dot(texel_normals[texel], texel_normals[neighbour]), 0.f), 16.f);
+                                const glm::vec3 offset = texel_positions[neighbour] - texel_positions[texel];
+                                const float weight = std::exp((dx * dx + dy * dy) * spatial_factor + glm::dot(offset, offset) * position_factor) * normal_weight;
+                                sum += irradiance[neighbour] * weight;
+                                weights_sum += weight;
+                            }
+                        }
+                        m_lightmap[texel] = weights_sum > 0.f ? sum / weights_sum : irradiance[texel];
+                    }
+                }
+            });
+
+        // Dilation: every pass grows the covered texels by one into the gutters of their own region,
+        // so bilinear filtering at chart borders never reads unlit texels
+        std::vector<uint8_t> next_covered = covered;
+        for (uint32_t pass = 0; pass < settings.dilation_passes; ++pass)
+        {
+            JobSystem::parallel_for(size, 8, [&](const size_t begin, const size_t end)
+                {
+                    for (size_t y = begin; y < end; ++y)
+                    {
+                        for (size_t x = 0; x < size; ++x)
+                        {
+                            const size_t texel = y * size + x;
+                            if (covered[texel] || texel_regions[texel] == no_region)
+                            {
+                                continue;
+                            }
+                            glm::vec3 sum(0.f);
+                            int count = 0;
+                            for (int dy = -1; dy <= 1; ++dy)
+                            {
+                                for (int dx = -1; dx <= 1; ++dx)
+                                {
+                                    const int nx = static_cast<int>(x) + dx;
+                                    const int ny = static_cast<int>(y) + dy;
+                                    if (nx < 0 || ny < 0 || nx >= static_cast<int>(size) || ny >= static_cast<int>(size))
+                                    {
+                                        continue;
+                                    }
+                                    const size_t neighbour = static_cast<size_t>(ny) * size + nx;
+                                    if (covered[neighbour] && texel_regions[neighbour] == texel_regions[texel])
+                                    {
+                                        sum += m_lightmap[neighbour];
+                                        ++count;
+                                    }
+                                }
+                            }
+                            if (count > 0)
+                            {
+                                m_lightmap[texel] = sum / static_cast<float>(count);
+                                next_covered[texel] = 1;
+                            }
+                        }
+                    }
+                });
+            covered = next_covered;
+        }
+
+        m_stats.bake_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+        m_stats.rays_per_second = m_stats.bake_time_ms > 0.0 ? m_stats.rays_count / (m_stats.bake_time_ms / 1000.0) : 0.0;
+        LOG_INFO("Baked a {0}x{0} lightmap: {1} instances, {2} texels, {3} rays in {4:.1f} ms ({5:.2f} Mrays/s)",
+                 size, m_stats.instances_count, m_stats.covered_texels_count, m_stats.rays_count, m_stats.bake_time_ms, m_stats.rays_per_second / 1e6);
+        return true;
+    }
+
+    bool LightmapBaker::save_pfm(const std::string& path) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            LOG_ERROR("LightmapBaker: cannot open {0}", path);
+            return false;
+        }
+        // negative scale means little endian, rows go from the bottom like the lightmap
+        file << "PF\n" << m_lightmap_size << " " << m_lightmap_size << "\n-1.0\n";
+        file.write(reinterpret_cast<const char*>(m_lightmap.data()), static_cast<std::streamsize>(m_lightmap.size() * sizeof(glm::vec3)));
+        return static_cast<bool>(file);
+    }
+}
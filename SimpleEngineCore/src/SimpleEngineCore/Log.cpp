@@ -0,0 +1,311 @@
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Memory.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SimpleEngine {
+
+    struct RecordHeader
+    {
+        // the whole record, a multiple of 8; 0 marks padding up to the end of the buffer
+        uint32_t size;
+        Log::ELevel level;
+        int64_t time_ns;
+        const char* format;
+        void (*decode)(const uint8_t* pArgs, const char* format, fmt::memory_buffer& buffer);
+    };
+
+    // single producer (the owning thread), single consumer (the writer thread) byte ring
+    struct ThreadBuffer
+    {
+        static constexpr size_t capacity = size_t(1) << 18;
+        // a larger record would stall its thread until the buffer is nearly empty
+        static constexpr size_t max_record_size = capacity / 4;
+
+        std::unique_ptr<uint8_t[]> data = std::make_unique<uint8_t[]>(capacity);
+
+        alignas(64) std::atomic<uint64_t> write_position{ 0 };
+        // producer side copies, only touched by the owning thread
+        uint64_t cached_read_position = 0;
+        uint64_t record_end = 0;
+
+        alignas(64) std::atomic<uint64_t> read_position{ 0 };
+        // set when the owning thread exits, the buffer is released once it is drained
+        std::atomic<bool> is_abandoned{ false };
+    };
+
+    class LogWriter
+    {
+    public:
+        static LogWriter& get()
+        {
+            static LogWriter writer;
+            return writer;
+        }
+
+        ThreadBuffer* add_buffer()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_buffers.push_back(std::make_unique<ThreadBuffer>());
+            return m_buffers.back().get();
+        }
+
+        void wake()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_is_woken = true;
+            }
+            m_wake_condition.notify_one();
+        }
+
+        void flush()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // the pass running now may have read a buffer before the caller's last record was published
+            const uint64_t target_pass = m_passes_count + 2;
+            m_is_woken = true;
+            m_wake_condition.notify_one();
+            m_flushed_condition.wait(lock, [&]() { return m_passes_count >= target_pass || m_is_stopped; });
+        }
+
+        void add_dropped()
+        {
+            m_dropped_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        uint64_t get_dropped_count() const
+        {
+            return m_dropped_count.load(std::memory_order_relaxed);
+        }
+
+    private:
+        LogWriter()
+        {
+            // constructed before the writer, so it is destroyed after the writer stopped using it
+            spdlog::default_logger_raw();
+            m_thread = std::thread(&LogWriter::run, this);
+        }
+
+        ~LogWriter()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_is_stopping = true;
+            }
+            m_wake_condition.notify_one();
+            m_thread.join();
+        }
+
+        void run()
+        {
+            MemoryTagScope tag_scope(EMemoryTag::Log);
+            std::vector<ThreadBuffer*> buffers;
+            uint64_t reported_dropped_count = 0;
+            while (true)
+            {
+                bool is_stopping = false;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    is_stopping = m_is_stopping;
+                    m_is_woken = false;
+                    // threads that exited leave their buffer behind until it is written out
+                    for (size_t i = 0; i < m_buffers.size();)
+                    {
+                        ThreadBuffer& buffer = *m_buffers[i];
+                        if (buffer.is_abandoned.load(std::memory_order_acquire)
+                            && buffer.read_position.load(std::memory_order_relaxed) == buffer.write_position.load(std::memory_order_acquire))
+                        {
+                            m_buffers.erase(m_buffers.begin() + i);
+                            continue;
+                        }
+                        ++i;
+                    }
+                    buffers.clear();
+                    for (const std::unique_ptr<ThreadBuffer>& pBuffer : m_buffers)
+                    {
+                        buffers.push_back(pBuffer.get());
+                    }
+                }
+
+                size_t written_count = 0;
+                for (ThreadBuffer* pBuffer : buffers)
+                {
+                    written_count += drain(*pBuffer);
+                }
+                const uint64_t dropped_count = get_dropped_count();
+                if (dropped_count != reported_dropped_count)
+                {
+                    spdlog::default_logger_raw()->warn("Log: {0} messages dropped, their thread's buffer was full", dropped_count - reported_dropped_count);
+                    reported_dropped_count = dropped_count;
+                }
+                if (written_count > 0)
+                {
+                    spdlog::default_logger_raw()->flush();
+                }
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                ++m_passes_count;
+                m_flushed_condition.notify_all();
+                if (is_stopping && written_count == 0)
+                {
+                    m_is_stopped = true;
+                    return;
+                }
+                if (written_count == 0)
+                {
+                    m_wake_condition.wait_for(lock, std::chrono::milliseconds(5), [&]() { return m_is_woken || m_is_stopping; });
+                }
+            }
+        }
+
+        size_t drain(ThreadBuffer& buffer)
+        {
+            size_t written_count = 0;
+            uint64_t read_position = buffer.read_position.load(std::memory_order_relaxed);
+            const uint64_t write_position = buffer.write_position.load(std::memory_order_acquire);
+            while (read_position < write_position)
+            {
+                const size_t offset = read_position % ThreadBuffer::capacity;
+                RecordHeader header;
+                std::memcpy(&header, buffer.data.get() + offset, sizeof(header.size));
+                if (header.size == 0)
+                {
+                    read_position += ThreadBuffer::capacity - offset;
+                    continue;
+                }
+                std::memcpy(&header, buffer.data.get() + offset, sizeof(header));
+                write_record(header, buffer.data.get() + offset + sizeof(RecordHeader));
+                read_position += header.size;
+                ++written_count;
+            }
+            buffer.read_position.store(read_position, std::memory_order_release);
+            return written_count;
+        }
+
+        void write_record(const RecordHeader& header, const uint8_t* pArgs)
+        {
+            m_format_buffer.clear();
+            try
+            {
+                header.decode(pArgs, header.format, m_format_buffer);
+            }
+            catch (const fmt::format_error& error)
+            {
+                m_format_buffer.clear();
+                fmt::format_to(std::back_inserter(m_format_buffer), "bad log format \"{0}\": {1}", header.format, error.what());
+            }
+            constexpr spdlog::level::level_enum levels[] = { spdlog::level::info, spdlog::level::warn, spdlog::level::err, spdlog::level::critical };
+            const spdlog::log_clock::time_point time(std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(header.time_ns)));
+            spdlog::default_logger_raw()->log(time, spdlog::source_loc{}, levels[static_cast<size_t>(header.level)],
+                                              spdlog::string_view_t(m_format_buffer.data(), m_format_buffer.size()));
+        }
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake_condition;
+        std::condition_variable m_flushed_condition;
+        std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+        bool m_is_woken = false;
+        bool m_is_stopping = false;
+        bool m_is_stopped = false;
+        uint64_t m_passes_count = 0;
+        std::atomic<uint64_t> m_dropped_count{ 0 };
+        fmt::memory_buffer m_format_buffer;
+        std::thread m_thread;
+    };
+
+    struct ThreadBufferOwner
+    {
+        ~ThreadBufferOwner()
+        {
+            if (pBuffer)
+            {
+                pBuffer->is_abandoned.store(true, std::memory_order_release);
+            }
+        }
+
+        ThreadBuffer* pBuffer = nullptr;
+    };
+
+    static thread_local ThreadBufferOwner t_buffer;
+
+    uint8_t* Log::begin_record(const ELevel level, const char* format, const size_t args_size, const DecodeFn decode)
+    {
+        LogWriter& writer = LogWriter::get();
+        if (!t_buffer.pBuffer)
+        {
+            t_buffer.pBuffer = writer.add_buffer();
+        }
+        ThreadBuffer& buffer = *t_buffer.pBuffer;
+
+        const size_t size = (sizeof(RecordHeader) + args_size + 7) & ~size_t(7);
+        if (size > ThreadBuffer::max_record_size)
+        {
+            writer.add_dropped();
+            return nullptr;
+        }
+        uint64_t position = buffer.write_position.load(std::memory_order_relaxed);
+        const size_t offset = position % ThreadBuffer::capacity;
+        // records are contiguous, one that doesn't fit before the end of the buffer starts over at its beginning
+        const size_t padding = offset + size > ThreadBuffer::capacity ? ThreadBuffer::capacity - offset : 0;
+        while (position + padding + size - buffer.cached_read_position > ThreadBuffer::capacity)
+        {
+            buffer.cached_read_position = buffer.read_position.load(std::memory_order_acquire);
+            if (position + padding + size - buffer.cached_read_position <= ThreadBuffer::capacity)
+            {
+                break;
+            }
+            if (level < ELevel::Error)
+            {
+                writer.add_dropped();
+                return nullptr;
+            }
+            writer.wake();
+            std::this_thread::yield();
+        }
+
+        if (padding > 0)
+        {
+            const uint32_t padding_marker = 0;
+            std::memcpy(buffer.data.get() + offset, &padding_marker, sizeof(padding_marker));
+            position += padding;
+        }
+        RecordHeader header;
+        header.size = static_cast<uint32_t>(size);
+        header.level = level;
+        header.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        header.format = format;
+        header.decode = decode;
+        uint8_t* pRecord = buffer.data.get() + position % ThreadBuffer::capacity;
+        std::memcpy(pRecord, &header, sizeof(header));
+        buffer.record_end = position + size;
+        return pRecord + sizeof(RecordHeader);
+    }
+
+    void Log::end_record(const ELevel level)
+    {
+        t_buffer.pBuffer->write_position.store(t_buffer.pBuffer->record_end, std::memory_order_release);
+        if (level == ELevel::Critical)
+        {
+            flush();
+        }
+    }
+
+    void Log::flush()
+    {
+        LogWriter::get().flush();
+    }
+
+    uint64_t Log::get_dropped_count()
+    {
+        return LogWriter::get().get_dropped_count();
+    }
+
+}
@@ -0,0 +1,309 @@
+#include "SimpleEngineCore/Math/BatchMath.hpp"
+#include "SimpleEngineCore/Math/BatchMathKernels.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(_MSC_VER) && defined(SIMPLE_ENGINE_BATCH_MATH_X64)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace SimpleEngine {
+
+    static void mat4_mul_scalar(const float* a, const size_t a_stride, const float* b, float* out, const size_t count)
+    {
+        for (size_t n = 0; n < count; ++n, a += a_stride, b += 16, out += 16)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    out[j * 4 + i] = a[i] * b[j * 4] + a[4 + i] * b[j * 4 + 1] + a[8 + i] * b[j * 4 + 2] + a[12 + i] * b[j * 4 + 3];
+                }
+            }
+        }
+    }
+
+    static void mat4_mul_vec4_scalar(const float* m, const float* v, float* out, const size_t count)
+    {
+        for (size_t n = 0; n < count; ++n, v += 4, out += 4)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                out[i] = m[i] * v[0] + m[4 + i] * v[1] + m[8 + i] * v[2] + m[12 + i] * v[3];
+            }
+        }
+    }
+
+    // Rows of the 3x3 inverse are the cross products of the columns divided by the determinant
+    static float inverse_rows_scalar(const float* m, float rows[3][3])
+    {
+        const float* c0 = m;
+        const float* c1 = m + 4;
+        const float* c2 = m + 8;
+        rows[0][0] = c1[1] * c2[2] - c1[2] * c2[1];
+        rows[0][1] = c1[2] * c2[0] - c1[0] * c2[2];
+        rows[0][2] = c1[0] * c2[1] - c1[1] * c2[0];
+        rows[1][0] = c2[1] * c0[2] - c2[2] * c0[1];
+        rows[1][1] = c2[2] * c0[0] - c2[0] * c0[2];
+        rows[1][2] = c2[0] * c0[1] - c2[1] * c0[0];
+        rows[2][0] = c0[1] * c1[2] - c0[2] * c1[1];
+        rows[2][1] = c0[2] * c1[0] - c0[0] * c1[2];
+        rows[2][2] = c0[0] * c1[1] - c0[1] * c1[0];
+        return 1.f / (c0[0] * rows[0][0] + c0[1] * rows[0][1] + c0[2] * rows[0][2]);
+    }
+
+    static void affine_inverse_scalar(const float* m, float* out, const size_t count)
+    {
+        for (size_t n = 0; n < count; ++n, m += 16, out += 16)
+        {
+            float rows[3][3];
+            const float inv_det = inverse_rows_scalar(m, rows);
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    out[j * 4 + i] = rows[i][j] * inv_det;
+                }
+                out[12 + i] = -(rows[i][0] * m[12] + rows[i][1] * m[13] + rows[i][2] * m[14]) * inv_det;
+            }
+            out[3] = 0.f;
+            out[7] = 0.f;
+            out[11] = 0.f;
+            out[15] = 1.f;
+        }
+    }
+
+    static void normal_matrix_scalar(const float* m, float* out, const size_t count)
+    {
+        for (size_t n = 0; n < count; ++n, m += 16, out += 9)
+        {
+            float rows[3][3];
+            const float inv_det = inverse_rows_scalar(m, rows);
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    out[i * 3 + j] = rows[i][j] * inv_det;
+                }
+            }
+        }
+    }
+
+    static void transform_aabb_scalar(const float* m, const float* in, float* out, const size_t count)
+    {
+        for (size_t n = 0; n < count; ++n, m += 16, in += 6, out += 6)
+        {
+            float center[3];
+            float extent[3];
+            for (int i = 0; i < 3; ++i)
+            {
+                center[i] = (in[i] + in[3 + i]) * 0.5f;
+                extent[i] = (in[3 + i] - in[i]) * 0.5f;
+            }
+            for (int i = 0; i < 3; ++i)
+            {
+                const float new_center = m[i] * center[0] + m[4 + i] * center[1] + m[8 + i] * center[2] + m[12 + i];
+                const float new_extent = std::abs(m[i]) * extent[0] + std::abs(m[4 + i]) * extent[1] + std::abs(m[8 + i]) * extent[2];
+                out[i] = new_center - new_extent;
+                out[3 + i] = new_center + new_extent;
+            }
+        }
+    }
+
+    static void sincos_scalar(const float* x, float* sin_out, float* cos_out, const size_t count)
+    {
+        using namespace BatchMathConstants;
+        for (size_t n = 0; n < count; ++n)
+        {
+            const bool negative = x[n] < 0.f;
+            float value = std::abs(x[n]);
+
+            // octant index rounded up to an even number, reduced with extended precision
+            int32_t j = static_cast<int32_t>(value * four_over_pi);
+            j = (j + 1) & ~1;
+            const float y = static_cast<float>(j);
+            value = ((value + y * minus_dp1) + y * minus_dp2) + y * minus_dp3;
+
+            const float z = value * value;
+            const float cos_poly = ((coscof_p0 * z + coscof_p1) * z + coscof_p2) * z * z - 0.5f * z + 1.f;
+            const float sin_poly = ((sincof_p0 * z + sincof_p1) * z + sincof_p2) * z * value + value;
+
+            const bool use_sin_poly = (j & 2) == 0;
+            const float s = use_sin_poly ? sin_poly : cos_poly;
+            const float c = use_sin_poly ? cos_poly : sin_poly;
+            sin_out[n] = (negative != ((j & 4) != 0)) ? -s : s;
+            cos_out[n] = (((j - 2) & 4) == 0) ? -c : c;
+        }
+    }
+
+    const BatchMathKernels& get_batch_math_kernels_scalar()
+    {
+        static const BatchMathKernels kernels = {
+            mat4_mul_scalar,
+            mat4_mul_vec4_scalar,
+            affine_inverse_scalar,
+            normal_matrix_scalar,
+            transform_aabb_scalar,
+            sincos_scalar
+        };
+        return kernels;
+    }
+
+
+    struct CpuFeatures
+    {
+        bool sse42 = false;
+        bool avx2 = false;
+        bool avx512 = false;
+    };
+
+    static CpuFeatures detect_cpu_features()
+    {
+        CpuFeatures features;
+#if defined(SIMPLE_ENGINE_BATCH_MATH_X64)
+    #if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        const int max_leaf = info[0];
+        __cpuid(info, 1);
+        features.sse42 = (info[2] & (1 << 20)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool fma = (info[2] & (1 << 12)) != 0;
+        if (osxsave && max_leaf >= 7)
+        {
+            const unsigned long long xcr0 = _xgetbv(0);
+            const bool os_avx = (xcr0 & 0x6) == 0x6;
+            const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;
+            __cpuidex(info, 7, 0);
+            features.avx2 = os_avx && fma && (info[1] & (1 << 5)) != 0;
+            features.avx512 = os_avx512 && (info[1] & (1 << 16)) != 0;
+        }
+    #else
+        __builtin_cpu_init();
+        features.sse42 = __builtin_cpu_supports("sse4.2");
+        features.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        features.avx512 = __builtin_cpu_supports("avx512f");
+    #endif
+#endif
+        return features;
+    }
+
+    static const CpuFeatures& get_cpu_features()
+    {
+        static const CpuFeatures features = detect_cpu_features();
+        return features;
+    }
+
+    static const BatchMathKernels& get_kernels(const BatchMath::EInstructionSet instruction_set)
+    {
+        switch (instruction_set)
+        {
+#if defined(SIMPLE_ENGINE_BATCH_MATH_X64)
+            case BatchMath::EInstructionSet::SSE42:  return get_batch_math_kernels_sse42();
+            case BatchMath::EInstructionSet::AVX2:   return get_batch_math_kernels_avx2();
+            case BatchMath::EInstructionSet::AVX512: return get_batch_math_kernels_avx512();
+#endif
+            default: return get_batch_math_kernels_scalar();
+        }
+    }
+
+    static BatchMath::EInstructionSet detect_best_instruction_set()
+    {
+        BatchMath::EInstructionSet best = BatchMath::EInstructionSet::Scalar;
+        if (BatchMath::is_supported(BatchMath::EInstructionSet::AVX512))
+        {
+            best = BatchMath::EInstructionSet::AVX512;
+        }
+        else if (BatchMath::is_supported(BatchMath::EInstructionSet::AVX2))
+        {
+            best = BatchMath::EInstructionSet::AVX2;
+        }
+        else if (BatchMath::is_supported(BatchMath::EInstructionSet::SSE42))
+        {
+            best = BatchMath::EInstructionSet::SSE42;
+        }
+        LOG_INFO("BatchMath: using {0} kernels", BatchMath::get_instruction_set_name(best));
+        return best;
+    }
+
+    static BatchMath::EInstructionSet s_instruction_set = detect_best_instruction_set();
+    static const BatchMathKernels* s_kernels = &get_kernels(s_instruction_set);
+
+    BatchMath::EInstructionSet BatchMath::get_instruction_set()
+    {
+        return s_instruction_set;
+    }
+
+    bool BatchMath::is_supported(const EInstructionSet instruction_set)
+    {
+        switch (instruction_set)
+        {
+            case EInstructionSet::Scalar: return true;
+            case EInstructionSet::SSE42:  return get_cpu_features().sse42;
+            case EInstructionSet::AVX2:   return get_cpu_features().sse42 && get_cpu_features().avx2;
+            case EInstructionSet::AVX512: return get_cpu_features().sse42 && get_cpu_features().avx512;
+        }
+        return false;
+    }
+
+    bool BatchMath::set_instruction_set(const EInstructionSet instruction_set)
+    {
+        if (!is_supported(instruction_set))
+        {
+            return false;
+        }
+        s_instruction_set = instruction_set;
+        s_kernels = &get_kernels(instruction_set);
+        return true;
+    }
+
+    const char* BatchMath::get_instruction_set_name(const EInstructionSet instruction_set)
+    {
+        switch (instruction_set)
+        {
+            case EInstructionSet::Scalar: return "Scalar";
+            case EInstructionSet::SSE42:  return "SSE4.2";
+            case EInstructionSet::AVX2:   return "AVX2";
+            case EInstructionSet::AVX512: return "AVX-512";
+        }
+        return "Unknown";
+    }
+
+    void BatchMath::mat4_mul(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, const size_t count)
+    {
+        s_kernels->mat4_mul(reinterpret_cast<const float*>(a), 16, reinterpret_cast<const float*>(b), reinterpret_cast<float*>(out), count);
+    }
+
+    void BatchMath::mat4_mul(const glm::mat4& a, const glm::mat4* b, glm::mat4* out, const size_t count)
+    {
+        s_kernels->mat4_mul(reinterpret_cast<const float*>(&a), 0, reinterpret_cast<const float*>(b), reinterpret_cast<float*>(out), count);
+    }
+
+    void BatchMath::mat4_mul_vec4(const glm::mat4& m, const glm::vec4* v, glm::vec4* out, const size_t count)
+    {
+        s_kernels->mat4_mul_vec4(reinterpret_cast<const float*>(&m), reinterpret_cast<const float*>(v), reinterpret_cast<float*>(out), count);
+    }
+
+    void BatchMath::affine_inverse(const glm::mat4* m, glm::mat4* out, const size_t count)
+    {
+        s_kernels->affine_inverse(reinterpret_cast<const float*>(m), reinterpret_cast<float*>(out), count);
+    }
+
+    void BatchMath::normal_matrix(const glm::mat4* m, glm::mat3* out, const size_t count)
+    {
+        s_kernels->normal_matrix(reinterpret_cast<const float*>(m), reinterpret_cast<float*>(out), count);
+    }
+
+    void BatchMath::transform_aabb(const glm::mat4* m, const AABB* in, AABB* out, const size_t count)
+    {
+        s_kernels->transform_aabb(reinterpret_cast<const float*>(m), reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), count);
+    }
+
+    void BatchMath::sincos(const float* angles, float* sin_out, float* cos_out, const size_t count)
+    {
+        s_kernels->sincos(angles, sin_out, cos_out, count);
+    }
+}
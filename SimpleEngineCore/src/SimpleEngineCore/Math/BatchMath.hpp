@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+
+#include <cstddef>
+
+namespace SimpleEngine {
+
+    struct AABB
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // Array versions of the hot matrix/vector math. The implementation is picked once
+    // at startup from the best instruction set the CPU supports (SSE4.2, AVX2 or AVX-512)
+    // and falls back to plain C++ everywhere else. Outputs may not alias inputs.
+    class BatchMath
+    {
+    public:
+        enum class EInstructionSet
+        {
+            Scalar,
+            SSE42,
+            AVX2,
+            AVX512
+        };
+
+        static EInstructionSet get_instruction_set();
+        static bool is_supported(const EInstructionSet instruction_set);
+        // Forces a specific implementation (for benchmarks and accuracy checks); returns false if unsupported
+        static bool set_instruction_set(const EInstructionSet instruction_set);
+        static const char* get_instruction_set_name(const EInstructionSet instruction_set);
+
+        // out[i] = a[i] * b[i]
+        static void mat4_mul(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, const size_t count);
+        // out[i] = a * b[i]
+        static void mat4_mul(const glm::mat4& a, const glm::mat4* b, glm::mat4* out, const size_t count);
+        // out[i] = m * v[i]
+        static void mat4_mul_vec4(const glm::mat4& m, const glm::vec4* v, glm::vec4* out, const size_t count);
+        // Inverse of matrices with a (0, 0, 0, 1) bottom row
+        static void affine_inverse(const glm::mat4* m, glm::mat4* out, const size_t count);
+        // transpose(inverse(mat3(m[i])))
+        static void normal_matrix(const glm::mat4* m, glm::mat3* out, const size_t count);
+        // Bounds of the transformed box corners, affine matrices only
+        static void transform_aabb(const glm::mat4* m, const AABB* in, AABB* out, const size_t count);
+        // Cephes-style polynomial approximation, ~1e-7 absolute error for |x| < 8192
+        static void sincos(const float* angles, float* sin_out, float* cos_out, const size_t count);
+    };
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+namespace SimpleEngine {
+
+    // Raw float kernels behind BatchMath. Matrices are column-major 4x4 (16 floats),
+    // normal matrices are 3x3 (9 floats), AABBs are min.xyz followed by max.xyz (6 floats).
+    struct BatchMathKernels
+    {
+        // a_stride is 16 to walk an array of matrices or 0 to reuse a single one
+        void (*mat4_mul)(const float* a, const size_t a_stride, const float* b, float* out, const size_t count);
+        void (*mat4_mul_vec4)(const float* m, const float* v, float* out, const size_t count);
+        void (*affine_inverse)(const float* m, float* out, const size_t count);
+        void (*normal_matrix)(const float* m, float* out, const size_t count);
+        void (*transform_aabb)(const float* m, const float* in, float* out, const size_t count);
+        void (*sincos)(const float* x, float* sin_out, float* cos_out, const size_t count);
+    };
+
+    const BatchMathKernels& get_batch_math_kernels_scalar();
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SIMPLE_ENGINE_BATCH_MATH_X64
+    const BatchMathKernels& get_batch_math_kernels_sse42();
+    const BatchMathKernels& get_batch_math_kernels_avx2();
+    const BatchMathKernels& get_batch_math_kernels_avx512();
+#endif
+
+    namespace BatchMathConstants {
+        constexpr float four_over_pi = 1.27323954473516f;
+        constexpr float minus_dp1 = -0.78515625f;
+        constexpr float minus_dp2 = -2.4187564849853515625e-4f;
+        constexpr float minus_dp3 = -3.77489497744594108e-8f;
+        constexpr float sincof_p0 = -1.9515295891e-4f;
+        constexpr float sincof_p1 = 8.3321608736e-3f;
+        constexpr float sincof_p2 = -1.6666654611e-1f;
+        constexpr float coscof_p0 = 2.443315711809948e-5f;
+        constexpr float coscof_p1 = -1.388731625493765e-3f;
+        constexpr float coscof_p2 = 4.166664568298827e-2f;
+    }
+
+}
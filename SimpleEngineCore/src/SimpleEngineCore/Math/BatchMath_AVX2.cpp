@@ -0,0 +1,248 @@
+#include "SimpleEngineCore/Math/BatchMathKernels.hpp"
+
+#if defined(SIMPLE_ENGINE_BATCH_MATH_X64)
+
+#include <immintrin.h>
+
+namespace SimpleEngine {
+
+    // Two matrices or vectors per 256-bit register, one in each 128-bit lane.
+    // Tails and single elements go through the SSE4.2 kernels.
+
+    static inline __m256 load3x2(const float* p0, const float* p1)
+    {
+        const __m128 xy0 = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p0));
+        const __m128 xy1 = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p1));
+        return _mm256_set_m128(_mm_movelh_ps(xy1, _mm_load_ss(p1 + 2)), _mm_movelh_ps(xy0, _mm_load_ss(p0 + 2)));
+    }
+
+    static inline void store3(float* p, const __m128 v)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+    }
+
+    static inline __m256 load_column_x2(const float* m, const size_t column)
+    {
+        return _mm256_set_m128(_mm_loadu_ps(m + 16 + column * 4), _mm_loadu_ps(m + column * 4));
+    }
+
+    static inline __m256 cross3x2(const __m256 a, const __m256 b)
+    {
+        const __m256 a_yzx = _mm256_permute_ps(a, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m256 b_yzx = _mm256_permute_ps(b, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m256 c = _mm256_fmsub_ps(a, b_yzx, _mm256_mul_ps(a_yzx, b));
+        return _mm256_permute_ps(c, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    static inline __m256 mul_columns(const __m256 a0, const __m256 a1, const __m256 a2, const __m256 a3, const __m256 b)
+    {
+        __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(b, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm256_fmadd_ps(a1, _mm256_permute_ps(b, _MM_SHUFFLE(1, 1, 1, 1)), r);
+        r = _mm256_fmadd_ps(a2, _mm256_permute_ps(b, _MM_SHUFFLE(2, 2, 2, 2)), r);
+        return _mm256_fmadd_ps(a3, _mm256_permute_ps(b, _MM_SHUFFLE(3, 3, 3, 3)), r);
+    }
+
+    static void mat4_mul_avx2(const float* a, const size_t a_stride, const float* b, float* out, const size_t count)
+    {
+        for (size_t n = 0; n < count; ++n, a += a_stride, b += 16, out += 16)
+        {
+            const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+            const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+            const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+            const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+            _mm256_storeu_ps(out,     mul_columns(a0, a1, a2, a3, _mm256_loadu_ps(b)));
+            _mm256_storeu_ps(out + 8, mul_columns(a0, a1, a2, a3, _mm256_loadu_ps(b + 8)));
+        }
+    }
+
+    static void mat4_mul_vec4_avx2(const float* m, const float* v, float* out, const size_t count)
+    {
+        const __m256 m0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m));
+        const __m256 m1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 4));
+        const __m256 m2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 8));
+        const __m256 m3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 12));
+        size_t n = 0;
+        for (; n + 2 <= count; n += 2)
+        {
+            _mm256_storeu_ps(out + n * 4, mul_columns(m0, m1, m2, m3, _mm256_loadu_ps(v + n * 4)));
+        }
+        if (n < count)
+        {
+            get_batch_math_kernels_sse42().mat4_mul_vec4(m, v + n * 4, out + n * 4, count - n);
+        }
+    }
+
+    // Rows of the 3x3 inverses of m[0] and m[1] (cross products of the columns over the determinant)
+    static inline void inverse_rows_x2(const float* m, __m256& r0, __m256& r1, __m256& r2)
+    {
+        const __m256 c0 = load3x2(m, m + 16);
+        const __m256 c1 = load3x2(m + 4, m + 20);
+        const __m256 c2 = load3x2(m + 8, m + 24);
+        r0 = cross3x2(c1, c2);
+        r1 = cross3x2(c2, c0);
+        r2 = cross3x2(c0, c1);
+        const __m256 inv_det = _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_dp_ps(c0, r0, 0x7F));
+        r0 = _mm256_mul_ps(r0, inv_det);
+        r1 = _mm256_mul_ps(r1, inv_det);
+        r2 = _mm256_mul_ps(r2, inv_det);
+    }
+
+    static void affine_inverse_avx2(const float* m, float* out, const size_t count)
+    {
+        size_t n = 0;
+        for (; n + 2 <= count; n += 2, m += 32, out += 32)
+        {
+            __m256 r0, r1, r2;
+            inverse_rows_x2(m, r0, r1, r2);
+
+            // per-lane transpose of (r0, r1, r2, 0) into the inverse columns
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+            const __m256 t1 = _mm256_unpacklo_ps(r2, zero);
+            const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+            const __m256 t3 = _mm256_unpackhi_ps(r2, zero);
+            const __m256 c0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 c1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 c2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+
+            const __m256 t = load3x2(m + 12, m + 28);
+            __m256 translation = _mm256_mul_ps(c0, _mm256_permute_ps(t, _MM_SHUFFLE(0, 0, 0, 0)));
+            translation = _mm256_fmadd_ps(c1, _mm256_permute_ps(t, _MM_SHUFFLE(1, 1, 1, 1)), translation);
+            translation = _mm256_fmadd_ps(c2, _mm256_permute_ps(t, _MM_SHUFFLE(2, 2, 2, 2)), translation);
+            translation = _mm256_blend_ps(_mm256_sub_ps(zero, translation), _mm256_set1_ps(1.f), 0x88);
+
+            _mm256_storeu_ps(out,      _mm256_permute2f128_ps(c0, c1, 0x20));
+            _mm256_storeu_ps(out + 8,  _mm256_permute2f128_ps(c2, translation, 0x20));
+            _mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(c0, c1, 0x31));
+            _mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(c2, translation, 0x31));
+        }
+        if (n < count)
+        {
+            get_batch_math_kernels_sse42().affine_inverse(m, out, count - n);
+        }
+    }
+
+    static void normal_matrix_avx2(const float* m, float* out, const size_t count)
+    {
+        size_t n = 0;
+        for (; n + 2 <= count; n += 2, m += 32, out += 18)
+        {
+            __m256 r0, r1, r2;
+            inverse_rows_x2(m, r0, r1, r2);
+            // overlapping stores: each column overwrites the padding lane of the previous one
+            _mm_storeu_ps(out,      _mm256_castps256_ps128(r0));
+            _mm_storeu_ps(out + 3,  _mm256_castps256_ps128(r1));
+            _mm_storeu_ps(out + 6,  _mm256_castps256_ps128(r2));
+            _mm_storeu_ps(out + 9,  _mm256_extractf128_ps(r0, 1));
+            _mm_storeu_ps(out + 12, _mm256_extractf128_ps(r1, 1));
+            store3(out + 15, _mm256_extractf128_ps(r2, 1));
+        }
+        if (n < count)
+        {
+            get_batch_math_kernels_sse42().normal_matrix(m, out, count - n);
+        }
+    }
+
+    static void transform_aabb_avx2(const float* m, const float* in, float* out, const size_t count)
+    {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+        size_t n = 0;
+        for (; n + 2 <= count; n += 2, m += 32, in += 12, out += 12)
+        {
+            const __m256 box_min = load3x2(in, in + 6);
+            const __m256 box_max = load3x2(in + 3, in + 9);
+            const __m256 center = _mm256_blend_ps(_mm256_mul_ps(_mm256_add_ps(box_min, box_max), half), _mm256_set1_ps(1.f), 0x88);
+            const __m256 extent = _mm256_mul_ps(_mm256_sub_ps(box_max, box_min), half);
+
+            const __m256 c0 = load_column_x2(m, 0);
+            const __m256 c1 = load_column_x2(m, 1);
+            const __m256 c2 = load_column_x2(m, 2);
+            const __m256 c3 = load_column_x2(m, 3);
+
+            const __m256 new_center = mul_columns(c0, c1, c2, c3, center);
+            const __m256 new_extent = mul_columns(_mm256_and_ps(c0, abs_mask), _mm256_and_ps(c1, abs_mask), _mm256_and_ps(c2, abs_mask), _mm256_setzero_ps(), extent);
+            const __m256 new_min = _mm256_sub_ps(new_center, new_extent);
+            const __m256 new_max = _mm256_add_ps(new_center, new_extent);
+
+            store3(out,     _mm256_castps256_ps128(new_min));
+            store3(out + 3, _mm256_castps256_ps128(new_max));
+            store3(out + 6, _mm256_extractf128_ps(new_min, 1));
+            store3(out + 9, _mm256_extractf128_ps(new_max, 1));
+        }
+        if (n < count)
+        {
+            get_batch_math_kernels_sse42().transform_aabb(m, in, out, count - n);
+        }
+    }
+
+    static inline void sincos8(const __m256 x, __m256& s, __m256& c)
+    {
+        using namespace BatchMathConstants;
+        const __m256 sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(0x80000000)));
+
+        __m256 sign_bit_sin = _mm256_and_ps(x, sign_mask);
+        __m256 value = _mm256_andnot_ps(sign_mask, x);
+
+        __m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(value, _mm256_set1_ps(four_over_pi)));
+        j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+        const __m256 y = _mm256_cvtepi32_ps(j);
+
+        const __m256 swap_sign_bit_sin = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29));
+        const __m256 poly_mask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+        const __m256i j_cos = _mm256_sub_epi32(j, _mm256_set1_epi32(2));
+        const __m256 sign_bit_cos = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(j_cos, _mm256_set1_epi32(4)), 29));
+        sign_bit_sin = _mm256_xor_ps(sign_bit_sin, swap_sign_bit_sin);
+
+        value = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_dp1), value);
+        value = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_dp2), value);
+        value = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_dp3), value);
+
+        const __m256 z = _mm256_mul_ps(value, value);
+
+        __m256 cos_poly = _mm256_fmadd_ps(_mm256_set1_ps(coscof_p0), z, _mm256_set1_ps(coscof_p1));
+        cos_poly = _mm256_fmadd_ps(cos_poly, z, _mm256_set1_ps(coscof_p2));
+        cos_poly = _mm256_mul_ps(_mm256_mul_ps(cos_poly, z), z);
+        cos_poly = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), cos_poly);
+        cos_poly = _mm256_add_ps(cos_poly, _mm256_set1_ps(1.f));
+
+        __m256 sin_poly = _mm256_fmadd_ps(_mm256_set1_ps(sincof_p0), z, _mm256_set1_ps(sincof_p1));
+        sin_poly = _mm256_fmadd_ps(sin_poly, z, _mm256_set1_ps(sincof_p2));
+        sin_poly = _mm256_fmadd_ps(_mm256_mul_ps(sin_poly, z), value, value);
+
+        s = _mm256_xor_ps(_mm256_blendv_ps(cos_poly, sin_poly, poly_mask), sign_bit_sin);
+        c = _mm256_xor_ps(_mm256_blendv_ps(sin_poly, cos_poly, poly_mask), sign_bit_cos);
+    }
+
+    static void sincos_avx2(const float* x, float* sin_out, float* cos_out, const size_t count)
+    {
+        size_t n = 0;
+        for (; n + 8 <= count; n += 8)
+        {
+            __m256 s, c;
+            sincos8(_mm256_loadu_ps(x + n), s, c);
+            _mm256_storeu_ps(sin_out + n, s);
+            _mm256_storeu_ps(cos_out + n, c);
+        }
+        if (n < count)
+        {
+            get_batch_math_kernels_sse42().sincos(x + n, sin_out + n, cos_out + n, count - n);
+        }
+    }
+
+    const BatchMathKernels& get_batch_math_kernels_avx2()
+    {
+        static const BatchMathKernels kernels = {
+            mat4_mul_avx2,
+            mat4_mul_vec4_avx2,
+            affine_inverse_avx2,
+            normal_matrix_avx2,
+            transform_aabb_avx2,
+            sincos_avx2
+        };
+        return kernels;
+    }
+}
+
+#endif
@@ -0,0 +1,297 @@
+#include "SimpleEngineCore/Math/BatchMathKernels.hpp"
+
+#if defined(SIMPLE_ENGINE_BATCH_MATH_X64)
+
+#include <immintrin.h>
+
+namespace SimpleEngine {
+
+    // Only AVX-512F instructions are used. A register holds either one whole matrix
+    // (one column per 128-bit lane) or the same column of four matrices.
+    // Tails go through the AVX2 kernels.
+
+    static inline void store3(float* p, const __m128 v)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+    }
+
+    // 4x4 transpose of 128-bit lanes: four matrices in, four "same column of every matrix" registers out (and back)
+    static inline void transpose_lanes(__m512& m0, __m512& m1, __m512& m2, __m512& m3)
+    {
+        const __m512 t0 = _mm512_shuffle_f32x4(m0, m1, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m512 t1 = _mm512_shuffle_f32x4(m2, m3, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m512 t2 = _mm512_shuffle_f32x4(m0, m1, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m512 t3 = _mm512_shuffle_f32x4(m2, m3, _MM_SHUFFLE(3, 2, 3, 2));
+        m0 = _mm512_shuffle_f32x4(t0, t1, _MM_SHUFFLE(2, 0, 2, 0));
+        m1 = _mm512_shuffle_f32x4(t0, t1, _MM_SHUFFLE(3, 1, 3, 1));
+        m2 = _mm512_shuffle_f32x4(t2, t3, _MM_SHUFFLE(2, 0, 2, 0));
+        m3 = _mm512_shuffle_f32x4(t2, t3, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+
+    static inline __m512 and_ps(const __m512 a, const __m512i mask)
+    {
+        return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), mask));
+    }
+
+    static inline __m512 xor_ps(const __m512 a, const __m512 b)
+    {
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+    }
+
+    static inline __m512 cross3x4(const __m512 a, const __m512 b)
+    {
+        const __m512 a_yzx = _mm512_permute_ps(a, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m512 b_yzx = _mm512_permute_ps(b, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m512 c = _mm512_fmsub_ps(a, b_yzx, _mm512_mul_ps(a_yzx, b));
+        return _mm512_permute_ps(c, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    // x + y + z broadcast to the xyz lanes of every 128-bit lane
+    static inline __m512 dot3x4(const __m512 a, const __m512 b)
+    {
+        const __m512 p = _mm512_mul_ps(a, b);
+        return _mm512_add_ps(_mm512_add_ps(p, _mm512_permute_ps(p, _MM_SHUFFLE(3, 0, 2, 1))), _mm512_permute_ps(p, _MM_SHUFFLE(3, 1, 0, 2)));
+    }
+
+    static inline __m512 mul_columns(const __m512 a0, const __m512 a1, const __m512 a2, const __m512 a3, const __m512 b)
+    {
+        __m512 r = _mm512_mul_ps(a0, _mm512_permute_ps(b, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm512_fmadd_ps(a1, _mm512_permute_ps(b, _MM_SHUFFLE(1, 1, 1, 1)), r);
+        r = _mm512_fmadd_ps(a2, _mm512_permute_ps(b, _MM_SHUFFLE(2, 2, 2, 2)), r);
+        return _mm512_fmadd_ps(a3, _mm512_permute_ps(b, _MM_SHUFFLE(3, 3, 3, 3)), r);
+    }
+
+    static void mat4_mul_avx512(const float* a, const size_t a_stride, const float* b, float* out, const size_t count)
+    {
+        for (size_t n = 0; n < count; ++n, a += a_stride, b += 16, out += 16)
+        {
+            const __m512 a0 = _mm512_broadcast_f32x4(_mm_loadu_ps(a));
+            const __m512 a1 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 4));
+            const __m512 a2 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 8));
+            const __m512 a3 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 12));
+            _mm512_storeu_ps(out, mul_columns(a0, a1, a2, a3, _mm512_loadu_ps(b)));
+        }
+    }
+
+    static void mat4_mul_vec4_avx512(const float* m, const float* v, float* out, const size_t count)
+    {
+        const __m512 m0 = _mm512_broadcast_f32x4(_mm_loadu_ps(m));
+        const __m512 m1 = _mm512_broadcast_f32x4(_mm_loadu_ps(m + 4));
+        const __m512 m2 = _mm512_broadcast_f32x4(_mm_loadu_ps(m + 8));
+        const __m512 m3 = _mm512_broadcast_f32x4(_mm_loadu_ps(m + 12));
+        size_t n = 0;
+        for (; n + 4 <= count; n += 4)
+        {
+            _mm512_storeu_ps(out + n * 4, mul_columns(m0, m1, m2, m3, _mm512_loadu_ps(v + n * 4)));
+        }
+        if (n < count)
+        {
+            get_batch_math_kernels_avx2().mat4_mul_vec4(m, v + n * 4, out + n * 4, count - n);
+        }
+    }
+
+    // Loads four matrices as column registers with the w lanes of the 3x3 part cleared
+    static inline void load_columns_x4(const float* m, __m512& c0, __m512& c1, __m512& c2, __m512& c3)
+    {
+        c0 = _mm512_loadu_ps(m);
+        c1 = _mm512_loadu_ps(m + 16);
+        c2 = _mm512_loadu_ps(m + 32);
+        c3 = _mm512_loadu_ps(m + 48);
+        transpose_lanes(c0, c1, c2, c3);
+        const __mmask16 xyz = 0x7777;
+        c0 = _mm512_maskz_mov_ps(xyz, c0);
+        c1 = _mm512_maskz_mov_ps(xyz, c1);
+        c2 = _mm512_maskz_mov_ps(xyz, c2);
+    }
+
+    static inline void inverse_rows_x4(const __m512 c0, const __m512 c1, const __m512 c2, __m512& r0, __m512& r1, __m512& r2)
+    {
+        r0 = cross3x4(c1, c2);
+        r1 = cross3x4(c2, c0);
+        r2 = cross3x4(c0, c1);
+        // the w lanes of the determinant are zero, keep them finite
+        const __m512 det = _mm512_mask_mov_ps(dot3x4(c0, r0), 0x8888, _mm512_set1_ps(1.f));
+        const __m512 inv_det = _mm512_div_ps(_mm512_set1_ps(1.f), det);
+        r0 = _mm512_mul_ps(r0, inv_det);
+        r1 = _mm512_mul_ps(r1, inv_det);
+        r2 = _mm512_mul_ps(r2, inv_det);
+    }
+
+    static void affine_inverse_avx512(const float* m, float* out, const size_t count)
+    {
+        size_t n = 0;
+        for (; n + 4 <= count; n += 4, m += 64, out += 64)
+        {
+            __m512 c0, c1, c2, c3;
+            load_columns_x4(m, c0, c1, c2, c3);
+            __m512 r0, r1, r2;
+            inverse_rows_x4(c0, c1, c2, r0, r1, r2);
+
+            // per-lane transpose of (r0, r1, r2, 0) into the inverse columns
+            const __m512 zero = _mm512_setzero_ps();
+            const __m512 t0 = _mm512_unpacklo_ps(r0, r1);
+            const __m512 t1 = _mm512_unpacklo_ps(r2, zero);
+            const __m512 t2 = _mm512_unpackhi_ps(r0, r1);
+            const __m512 t3 = _mm512_unpackhi_ps(r2, zero);
+            __m512 i0 = _mm512_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+            __m512 i1 = _mm512_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+            __m512 i2 = _mm512_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+
+            __m512 i3 = _mm512_mul_ps(i0, _mm512_permute_ps(c3, _MM_SHUFFLE(0, 0, 0, 0)));
+            i3 = _mm512_fmadd_ps(i1, _mm512_permute_ps(c3, _MM_SHUFFLE(1, 1, 1, 1)), i3);
+            i3 = _mm512_fmadd_ps(i2, _mm512_permute_ps(c3, _MM_SHUFFLE(2, 2, 2, 2)), i3);
+            i3 = _mm512_mask_mov_ps(_mm512_sub_ps(zero, i3), 0x8888, _mm512_set1_ps(1.f));
+
+            transpose_lanes(i0, i1, i2, i3);
+            _mm512_storeu_ps(out, i0);
+            _mm512_storeu_ps(out + 16, i1);
+            _mm512_storeu_ps(out + 32, i2);
+            _mm512_storeu_ps(out + 48, i3);
+        }
+        if (n < count)
+        {
+            get_batch_math_kernels_avx2().affine_inverse(m, out, count - n);
+        }
+    }
+
+    static void normal_matrix_avx512(const float* m, float* out, const size_t count)
+    {
+        size_t n = 0;
+        for (; n + 4 <= count; n += 4, m += 64, out += 36)
+        {
+            __m512 c0, c1, c2, c3;
+            load_columns_x4(m, c0, c1, c2, c3);
+            __m512 r0, r1, r2;
+            inverse_rows_x4(c0, c1, c2, r0, r1, r2);
+
+            // overlapping stores: each column overwrites the padding lane of the previous one
+            _mm_storeu_ps(out,      _mm512_extractf32x4_ps(r0, 0));
+            _mm_storeu_ps(out + 3,  _mm512_extractf32x4_ps(r1, 0));
+            _mm_storeu_ps(out + 6,  _mm512_extractf32x4_ps(r2, 0));
+            _mm_storeu_ps(out + 9,  _mm512_extractf32x4_ps(r0, 1));
+            _mm_storeu_ps(out + 12, _mm512_extractf32x4_ps(r1, 1));
+            _mm_storeu_ps(out + 15, _mm512_extractf32x4_ps(r2, 1));
+            _mm_storeu_ps(out + 18, _mm512_extractf32x4_ps(r0, 2));
+            _mm_storeu_ps(out + 21, _mm512_extractf32x4_ps(r1, 2));
+            _mm_storeu_ps(out + 24, _mm512_extractf32x4_ps(r2, 2));
+            _mm_storeu_ps(out + 27, _mm512_extractf32x4_ps(r0, 3));
+            _mm_storeu_ps(out + 30, _mm512_extractf32x4_ps(r1, 3));
+            store3(out + 33, _mm512_extractf32x4_ps(r2, 3));
+        }
+        if (n < count)
+        {
+            get_batch_math_kernels_avx2().normal_matrix(m, out, count - n);
+        }
+    }
+
+    static void transform_aabb_avx512(const float* m, const float* in, float* out, const size_t count)
+    {
+        // four boxes are 24 floats: min.xyz of box k sits at 6k, max.xyz at 6k + 3
+        const __m512i min_index = _mm512_setr_epi32(0, 1, 2, 2, 6, 7, 8, 8, 12, 13, 14, 14, 18, 19, 20, 20);
+        const __m512i max_index = _mm512_setr_epi32(3, 4, 5, 5, 9, 10, 11, 11, 15, 16, 17, 17, 21, 22, 23, 23);
+        // and back: index < 16 selects from the min register, >= 16 from the max register
+        const __m512i out_low_index = _mm512_setr_epi32(0, 1, 2, 16, 17, 18, 4, 5, 6, 20, 21, 22, 8, 9, 10, 24);
+        const __m512i out_high_index = _mm512_setr_epi32(25, 26, 12, 13, 14, 28, 29, 30, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m512 half = _mm512_set1_ps(0.5f);
+        const __m512i abs_mask = _mm512_set1_epi32(0x7FFFFFFF);
+
+        size_t n = 0;
+        for (; n + 4 <= count; n += 4, m += 64, in += 24, out += 24)
+        {
+            const __m512 boxes_low = _mm512_loadu_ps(in);
+            const __m512 boxes_high = _mm512_maskz_loadu_ps(0x00FF, in + 16);
+            const __m512 box_min = _mm512_permutex2var_ps(boxes_low, min_index, boxes_high);
+            const __m512 box_max = _mm512_permutex2var_ps(boxes_low, max_index, boxes_high);
+            const __m512 center = _mm512_mask_mov_ps(_mm512_mul_ps(_mm512_add_ps(box_min, box_max), half), 0x8888, _mm512_set1_ps(1.f));
+            const __m512 extent = _mm512_maskz_mov_ps(0x7777, _mm512_mul_ps(_mm512_sub_ps(box_max, box_min), half));
+
+            __m512 m0 = _mm512_loadu_ps(m);
+            __m512 m1 = _mm512_loadu_ps(m + 16);
+            __m512 m2 = _mm512_loadu_ps(m + 32);
+            __m512 m3 = _mm512_loadu_ps(m + 48);
+            transpose_lanes(m0, m1, m2, m3);
+
+            const __m512 new_center = mul_columns(m0, m1, m2, m3, center);
+            const __m512 new_extent = mul_columns(and_ps(m0, abs_mask), and_ps(m1, abs_mask), and_ps(m2, abs_mask), _mm512_setzero_ps(), extent);
+            const __m512 new_min = _mm512_sub_ps(new_center, new_extent);
+            const __m512 new_max = _mm512_add_ps(new_center, new_extent);
+
+            _mm512_storeu_ps(out, _mm512_permutex2var_ps(new_min, out_low_index, new_max));
+            _mm512_mask_storeu_ps(out + 16, 0x00FF, _mm512_permutex2var_ps(new_min, out_high_index, new_max));
+        }
+        if (n < count)
+        {
+            get_batch_math_kernels_avx2().transform_aabb(m, in, out, count - n);
+        }
+    }
+
+    static inline void sincos16(const __m512 x, __m512& s, __m512& c)
+    {
+        using namespace BatchMathConstants;
+        const __m512i sign_mask = _mm512_set1_epi32(static_cast<int>(0x80000000));
+
+        __m512i sign_bit_sin = _mm512_and_si512(_mm512_castps_si512(x), sign_mask);
+        __m512 value = _mm512_castsi512_ps(_mm512_andnot_si512(sign_mask, _mm512_castps_si512(x)));
+
+        __m512i j = _mm512_cvttps_epi32(_mm512_mul_ps(value, _mm512_set1_ps(four_over_pi)));
+        j = _mm512_and_si512(_mm512_add_epi32(j, _mm512_set1_epi32(1)), _mm512_set1_epi32(~1));
+        const __m512 y = _mm512_cvtepi32_ps(j);
+
+        const __m512i swap_sign_bit_sin = _mm512_slli_epi32(_mm512_and_si512(j, _mm512_set1_epi32(4)), 29);
+        const __mmask16 use_sin_poly = _mm512_testn_epi32_mask(j, _mm512_set1_epi32(2));
+        const __m512i j_cos = _mm512_sub_epi32(j, _mm512_set1_epi32(2));
+        const __m512i sign_bit_cos = _mm512_slli_epi32(_mm512_andnot_si512(j_cos, _mm512_set1_epi32(4)), 29);
+        sign_bit_sin = _mm512_xor_si512(sign_bit_sin, swap_sign_bit_sin);
+
+        value = _mm512_fmadd_ps(y, _mm512_set1_ps(minus_dp1), value);
+        value = _mm512_fmadd_ps(y, _mm512_set1_ps(minus_dp2), value);
+        value = _mm512_fmadd_ps(y, _mm512_set1_ps(minus_dp3), value);
+
+        const __m512 z = _mm512_mul_ps(value, value);
+
+        __m512 cos_poly = _mm512_fmadd_ps(_mm512_set1_ps(coscof_p0), z, _mm512_set1_ps(coscof_p1));
+        cos_poly = _mm512_fmadd_ps(cos_poly, z, _mm512_set1_ps(coscof_p2));
+        cos_poly = _mm512_mul_ps(_mm512_mul_ps(cos_poly, z), z);
+        cos_poly = _mm512_fnmadd_ps(z, _mm512_set1_ps(0.5f), cos_poly);
+        cos_poly = _mm512_add_ps(cos_poly, _mm512_set1_ps(1.f));
+
+        __m512 sin_poly = _mm512_fmadd_ps(_mm512_set1_ps(sincof_p0), z, _mm512_set1_ps(sincof_p1));
+        sin_poly = _mm512_fmadd_ps(sin_poly, z, _mm512_set1_ps(sincof_p2));
+        sin_poly = _mm512_fmadd_ps(_mm512_mul_ps(sin_poly, z), value, value);
+
+        s = xor_ps(_mm512_mask_blend_ps(use_sin_poly, cos_poly, sin_poly), _mm512_castsi512_ps(sign_bit_sin));
+        c = xor_ps(_mm512_mask_blend_ps(use_sin_poly, sin_poly, cos_poly), _mm512_castsi512_ps(sign_bit_cos));
+    }
+
+    static void sincos_avx512(const float* x, float* sin_out, float* cos_out, const size_t count)
+    {
+        size_t n = 0;
+        for (; n + 16 <= count; n += 16)
+        {
+            __m512 s, c;
+            sincos16(_mm512_loadu_ps(x + n), s, c);
+            _mm512_storeu_ps(sin_out + n, s);
+            _mm512_storeu_ps(cos_out + n, c);
+        }
+        if (n < count)
+        {
+            get_batch_math_kernels_avx2().sincos(x + n, sin_out + n, cos_out + n, count - n);
+        }
+    }
+
+    const BatchMathKernels& get_batch_math_kernels_avx512()
+    {
+        static const BatchMathKernels kernels = {
+            mat4_mul_avx512,
+            mat4_mul_vec4_avx512,
+            affine_inverse_avx512,
+            normal_matrix_avx512,
+            transform_aabb_avx512,
+            sincos_avx512
+        };
+        return kernels;
+    }
+}
+
+#endif
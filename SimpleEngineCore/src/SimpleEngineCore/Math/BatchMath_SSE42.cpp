@@ -0,0 +1,206 @@
+#include "SimpleEngineCore/Math/BatchMathKernels.hpp"
+
+#if defined(SIMPLE_ENGINE_BATCH_MATH_X64)
+
+#include <nmmintrin.h>
+
+namespace SimpleEngine {
+
+    static inline __m128 load3(const float* p)
+    {
+        const __m128 xy = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p));
+        return _mm_movelh_ps(xy, _mm_load_ss(p + 2));
+    }
+
+    static inline void store3(float* p, const __m128 v)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+    }
+
+    static inline __m128 cross3(const __m128 a, const __m128 b)
+    {
+        const __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+        return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    static inline __m128 mat4_mul_column(const __m128 a0, const __m128 a1, const __m128 a2, const __m128 a3, const __m128 b)
+    {
+        __m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+        return _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3))));
+    }
+
+    static void mat4_mul_sse42(const float* a, const size_t a_stride, const float* b, float* out, const size_t count)
+    {
+        for (size_t n = 0; n < count; ++n, a += a_stride, b += 16, out += 16)
+        {
+            const __m128 a0 = _mm_loadu_ps(a);
+            const __m128 a1 = _mm_loadu_ps(a + 4);
+            const __m128 a2 = _mm_loadu_ps(a + 8);
+            const __m128 a3 = _mm_loadu_ps(a + 12);
+            _mm_storeu_ps(out,      mat4_mul_column(a0, a1, a2, a3, _mm_loadu_ps(b)));
+            _mm_storeu_ps(out + 4,  mat4_mul_column(a0, a1, a2, a3, _mm_loadu_ps(b + 4)));
+            _mm_storeu_ps(out + 8,  mat4_mul_column(a0, a1, a2, a3, _mm_loadu_ps(b + 8)));
+            _mm_storeu_ps(out + 12, mat4_mul_column(a0, a1, a2, a3, _mm_loadu_ps(b + 12)));
+        }
+    }
+
+    static void mat4_mul_vec4_sse42(const float* m, const float* v, float* out, const size_t count)
+    {
+        const __m128 m0 = _mm_loadu_ps(m);
+        const __m128 m1 = _mm_loadu_ps(m + 4);
+        const __m128 m2 = _mm_loadu_ps(m + 8);
+        const __m128 m3 = _mm_loadu_ps(m + 12);
+        for (size_t n = 0; n < count; ++n, v += 4, out += 4)
+        {
+            _mm_storeu_ps(out, mat4_mul_column(m0, m1, m2, m3, _mm_loadu_ps(v)));
+        }
+    }
+
+    // Rows of the 3x3 inverse are the cross products of the columns divided by the determinant
+    static inline void inverse_rows(const float* m, __m128& r0, __m128& r1, __m128& r2)
+    {
+        const __m128 c0 = load3(m);
+        const __m128 c1 = load3(m + 4);
+        const __m128 c2 = load3(m + 8);
+        r0 = cross3(c1, c2);
+        r1 = cross3(c2, c0);
+        r2 = cross3(c0, c1);
+        const __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.f), _mm_dp_ps(c0, r0, 0x7F));
+        r0 = _mm_mul_ps(r0, inv_det);
+        r1 = _mm_mul_ps(r1, inv_det);
+        r2 = _mm_mul_ps(r2, inv_det);
+    }
+
+    static void affine_inverse_sse42(const float* m, float* out, const size_t count)
+    {
+        for (size_t n = 0; n < count; ++n, m += 16, out += 16)
+        {
+            __m128 r0, r1, r2;
+            inverse_rows(m, r0, r1, r2);
+            __m128 r3 = _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            const __m128 t = load3(m + 12);
+            __m128 translation = _mm_mul_ps(r0, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0)));
+            translation = _mm_add_ps(translation, _mm_mul_ps(r1, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+            translation = _mm_add_ps(translation, _mm_mul_ps(r2, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+            translation = _mm_sub_ps(_mm_setzero_ps(), translation);
+
+            _mm_storeu_ps(out, r0);
+            _mm_storeu_ps(out + 4, r1);
+            _mm_storeu_ps(out + 8, r2);
+            _mm_storeu_ps(out + 12, _mm_blend_ps(translation, _mm_set1_ps(1.f), 0x8));
+        }
+    }
+
+    static void normal_matrix_sse42(const float* m, float* out, const size_t count)
+    {
+        for (size_t n = 0; n < count; ++n, m += 16, out += 9)
+        {
+            __m128 r0, r1, r2;
+            inverse_rows(m, r0, r1, r2);
+            // overlapping stores: each column overwrites the padding lane of the previous one
+            _mm_storeu_ps(out, r0);
+            _mm_storeu_ps(out + 3, r1);
+            store3(out + 6, r2);
+        }
+    }
+
+    static void transform_aabb_sse42(const float* m, const float* in, float* out, const size_t count)
+    {
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        for (size_t n = 0; n < count; ++n, m += 16, in += 6, out += 6)
+        {
+            const __m128 box_min = load3(in);
+            const __m128 box_max = load3(in + 3);
+            const __m128 center = _mm_mul_ps(_mm_add_ps(box_min, box_max), half);
+            const __m128 extent = _mm_mul_ps(_mm_sub_ps(box_max, box_min), half);
+
+            const __m128 c0 = _mm_loadu_ps(m);
+            const __m128 c1 = _mm_loadu_ps(m + 4);
+            const __m128 c2 = _mm_loadu_ps(m + 8);
+            const __m128 c3 = _mm_loadu_ps(m + 12);
+
+            const __m128 new_center = mat4_mul_column(c0, c1, c2, c3, _mm_blend_ps(center, _mm_set1_ps(1.f), 0x8));
+            const __m128 new_extent = mat4_mul_column(_mm_and_ps(c0, abs_mask), _mm_and_ps(c1, abs_mask), _mm_and_ps(c2, abs_mask), _mm_setzero_ps(), extent);
+
+            store3(out, _mm_sub_ps(new_center, new_extent));
+            store3(out + 3, _mm_add_ps(new_center, new_extent));
+        }
+    }
+
+    static inline void sincos4(const __m128 x, __m128& s, __m128& c)
+    {
+        using namespace BatchMathConstants;
+        const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000)));
+
+        __m128 sign_bit_sin = _mm_and_ps(x, sign_mask);
+        __m128 value = _mm_andnot_ps(sign_mask, x);
+
+        __m128i j = _mm_cvttps_epi32(_mm_mul_ps(value, _mm_set1_ps(four_over_pi)));
+        j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+        const __m128 y = _mm_cvtepi32_ps(j);
+
+        const __m128 swap_sign_bit_sin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29));
+        const __m128 poly_mask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+        const __m128i j_cos = _mm_sub_epi32(j, _mm_set1_epi32(2));
+        const __m128 sign_bit_cos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(j_cos, _mm_set1_epi32(4)), 29));
+        sign_bit_sin = _mm_xor_ps(sign_bit_sin, swap_sign_bit_sin);
+
+        value = _mm_add_ps(value, _mm_mul_ps(y, _mm_set1_ps(minus_dp1)));
+        value = _mm_add_ps(value, _mm_mul_ps(y, _mm_set1_ps(minus_dp2)));
+        value = _mm_add_ps(value, _mm_mul_ps(y, _mm_set1_ps(minus_dp3)));
+
+        const __m128 z = _mm_mul_ps(value, value);
+
+        __m128 cos_poly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(coscof_p0), z), _mm_set1_ps(coscof_p1));
+        cos_poly = _mm_add_ps(_mm_mul_ps(cos_poly, z), _mm_set1_ps(coscof_p2));
+        cos_poly = _mm_mul_ps(_mm_mul_ps(cos_poly, z), z);
+        cos_poly = _mm_sub_ps(cos_poly, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+        cos_poly = _mm_add_ps(cos_poly, _mm_set1_ps(1.f));
+
+        __m128 sin_poly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(sincof_p0), z), _mm_set1_ps(sincof_p1));
+        sin_poly = _mm_add_ps(_mm_mul_ps(sin_poly, z), _mm_set1_ps(sincof_p2));
+        sin_poly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sin_poly, z), value), value);
+
+        s = _mm_xor_ps(_mm_blendv_ps(cos_poly, sin_poly, poly_mask), sign_bit_sin);
+        c = _mm_xor_ps(_mm_blendv_ps(sin_poly, cos_poly, poly_mask), sign_bit_cos);
+    }
+
+    static void sincos_sse42(const float* x, float* sin_out, float* cos_out, const size_t count)
+    {
+        size_t n = 0;
+        for (; n + 4 <= count; n += 4)
+        {
+            __m128 s, c;
+            sincos4(_mm_loadu_ps(x + n), s, c);
+            _mm_storeu_ps(sin_out + n, s);
+            _mm_storeu_ps(cos_out + n, c);
+        }
+        if (n < count)
+        {
+            get_batch_math_kernels_scalar().sincos(x + n, sin_out + n, cos_out + n, count - n);
+        }
+    }
+
+    const BatchMathKernels& get_batch_math_kernels_sse42()
+    {
+        static const BatchMathKernels kernels = {
+            mat4_mul_sse42,
+            mat4_mul_vec4_sse42,
+            affine_inverse_sse42,
+            normal_matrix_sse42,
+            transform_aabb_sse42,
+            sincos_sse42
+        };
+        return kernels;
+    }
+}
+
+#endif
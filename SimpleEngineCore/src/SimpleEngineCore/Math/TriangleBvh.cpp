@@ -0,0 +1,542 @@
+#include "TriangleBvh.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    // SSE2 is part of x64, so unlike BatchMath this needs no runtime dispatch
+    #define SIMPLE_ENGINE_TRIANGLE_BVH_SSE
+    #include <emmintrin.h>
+#endif
+
+namespace SimpleEngine {
+
+    constexpr size_t bins_count = 12;
+    constexpr uint32_t max_leaf_triangles = 4;
+    constexpr size_t traversal_stack_size = 128;
+    constexpr float triangle_epsilon = 1e-9f;
+    constexpr float min_hit_distance = 1e-4f;
+
+    namespace {
+
+        struct Bounds
+        {
+            glm::vec3 min{ std::numeric_limits<float>::max() };
+            glm::vec3 max{ -std::numeric_limits<float>::max() };
+
+            void grow(const glm::vec3& point)
+            {
+                min = glm::min(min, point);
+                max = glm::max(max, point);
+            }
+
+            void grow(const Bounds& bounds)
+            {
+                min = glm::min(min, bounds.min);
+                max = glm::max(max, bounds.max);
+            }
+
+            float get_surface_area() const
+            {
+                const glm::vec3 size = glm::max(max - min, glm::vec3(0.f));
+                return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+            }
+        };
+
+        struct BinaryNode
+        {
+            Bounds bounds;
+            uint32_t left = 0;
+            uint32_t right = 0;
+            uint32_t first = 0;
+            uint32_t count = 0;
+        };
+
+        struct Ray
+        {
+            glm::vec3 origin;
+            glm::vec3 direction;
+            glm::vec3 inverse_direction;
+        };
+
+        // Binned SAH build of a binary BVH, later collapsed into the four-wide one
+        class BinaryBuilder
+        {
+        public:
+            explicit BinaryBuilder(const std::vector<glm::vec3>& vertices)
+            {
+                const size_t triangles_count = vertices.size() / 3;
+                m_triangle_bounds.resize(triangles_count);
+                m_centroids.resize(triangles_count);
+                m_triangles.resize(triangles_count);
+                for (uint32_t i = 0; i < triangles_count; ++i)
+                {
+                    Bounds& bounds = m_triangle_bounds[i];
+                    bounds.grow(vertices[3 * i]);
+                    bounds.grow(vertices[3 * i + 1]);
+                    bounds.grow(vertices[3 * i + 2]);
+                    m_centroids[i] = (bounds.min + bounds.max) * 0.5f;
+                    m_triangles[i] = i;
+                }
+                nodes.reserve(2 * triangles_count);
+                if (triangles_count > 0)
+                {
+                    build(0, static_cast<uint32_t>(triangles_count));
+                }
+            }
+
+            const std::vector<uint32_t>& get_triangles() const { return m_triangles; }
+
+            std::vector<BinaryNode> nodes;
+
+        private:
+            uint32_t build(const uint32_t first, const uint32_t count)
+            {
+                const uint32_t node_index = static_cast<uint32_t>(nodes.size());
+                nodes.emplace_back();
+
+                Bounds bounds;
+                Bounds centroid_bounds;
+                for (uint32_t i = first; i < first + count; ++i)
+                {
+                    bounds.grow(m_triangle_bounds[m_triangles[i]]);
+                    centroid_bounds.grow(m_centroids[m_triangles[i]]);
+                }
+                nodes[node_index].bounds = bounds;
+
+                if (count <= max_leaf_triangles)
+                {
+                    nodes[node_index].first = first;
+                    nodes[node_index].count = count;
+                    return node_index;
+                }
+
+                int best_axis = -1;
+                size_t best_split = 0;
+                float best_cost = std::numeric_limits<float>::max();
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    const float extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+                    if (extent <= 0.f)
+                    {
+                        continue;
+                    }
+
+                    Bounds bin_bounds[bins_count];
+                    uint32_t bin_counts[bins_count] = {};
+                    const float scale = bins_count / extent;
+                    for (uint32_t i = first; i < first + count; ++i)
+                    {
+                        const size_t bin = get_bin(m_centroids[m_triangles[i]][axis], centroid_bounds.min[axis], scale);
+                        bin_bounds[bin].grow(m_triangle_bounds[m_triangles[i]]);
+                        ++bin_counts[bin];
+                    }
+
+                    // sweep from the right to get the cost of every split in one pass from the left
+                    float right_areas[bins_count];
+                    uint32_t right_counts[bins_count];
+                    Bounds right_bounds;
+                    uint32_t right_count = 0;
+                    for (size_t bin = bins_count - 1; bin > 0; --bin)
+                    {
+                        right_bounds.grow(bin_bounds[bin]);
+                        right_count += bin_counts[bin];
+                        right_areas[bin] = right_bounds.get_surface_area();
+                        right_counts[bin] = right_count;
+                    }
+                    Bounds left_bounds;
+                    uint32_t left_count = 0;
+                    for (size_t split = 1; split < bins_count; ++split)
+                    {
+                        left_bounds.grow(bin_bounds[split - 1]);
+                        left_count += bin_counts[split - 1];
+                        if (left_count == 0 || right_counts[split] == 0)
+                        {
+                            continue;
+                        }
+                        const float cost = left_bounds.get_surface_area() * left_count + right_areas[split] * right_counts[split];
+                        if (cost < best_cost)
+                        {
+                            best_cost = cost;
+                            best_axis = axis;
+                            best_split = split;
+                        }
+                    }
+                }
+
+                uint32_t middle = first + count / 2;
+                if (best_axis >= 0)
+                {
+                    const float scale = bins_count / (centroid_bounds.max[best_axis] - centroid_bounds.min[best_axis]);
+                    const auto it = std::partition(m_triangles.begin() + first, m_triangles.begin() + first + count,
+                        [&](const uint32_t triangle)
+                        {
+                            return get_bin(m_centroids[triangle][best_axis], centroid_bounds.min[best_axis], scale) < best_split;
+                        });
+                    middle = static_cast<uint32_t>(it - m_triangles.begin());
+                }
+                // with all centroids in one point the triangles are just halved
+
+                const uint32_t left = build(first, middle - first);
+                const uint32_t right = build(middle, first + count - middle);
+                nodes[node_index].left = left;
+                nodes[node_index].right = right;
+                return node_index;
+            }
+
+            static size_t get_bin(const float value, const float min, const float scale)
+            {
+                return std::min(static_cast<size_t>((value - min) * scale), bins_count - 1);
+            }
+
+            std::vector<Bounds> m_triangle_bounds;
+            std::vector<glm::vec3> m_centroids;
+            std::vector<uint32_t> m_triangles;
+        };
+
+    }
+
+    void TriangleBvh::build(const std::vector<glm::vec3>& vertices)
+    {
+        m_nodes.clear();
+        m_packets.clear();
+        m_triangles_count = vertices.size() / 3;
+        m_root = empty_child;
+        if (m_triangles_count == 0)
+        {
+            return;
+        }
+
+        const BinaryBuilder builder(vertices);
+        const std::vector<BinaryNode>& binary_nodes = builder.nodes;
+        const std::vector<uint32_t>& triangles = builder.get_triangles();
+
+        const auto create_packet = [&](const BinaryNode& leaf)
+        {
+            TrianglePacket packet = {};
+            for (uint32_t lane = 0; lane < 4; ++lane)
+            {
+                packet.triangles[lane] = invalid_triangle;
+                if (lane >= leaf.count)
+                {
+                    // zero edges: a degenerate triangle at the first vertex of the packet
+                    packet.v0_x[lane] = packet.v0_x[0];
+                    packet.v0_y[lane] = packet.v0_y[0];
+                    packet.v0_z[lane] = packet.v0_z[0];
+                    continue;
+                }
+                const uint32_t triangle = triangles[leaf.first + lane];
+                const glm::vec3& v0 = vertices[3 * triangle];
+                const glm::vec3 e1 = vertices[3 * triangle + 1] - v0;
+                const glm::vec3 e2 = vertices[3 * triangle + 2] - v0;
+                packet.v0_x[lane] = v0.x; packet.v0_y[lane] = v0.y; packet.v0_z[lane] = v0.z;
+                packet.e1_x[lane] = e1.x; packet.e1_y[lane] = e1.y; packet.e1_z[lane] = e1.z;
+                packet.e2_x[lane] = e2.x; packet.e2_y[lane] = e2.y; packet.e2_z[lane] = e2.z;
+                packet.triangles[lane] = triangle;
+            }
+            m_packets.push_back(packet);
+            return leaf_flag | static_cast<uint32_t>(m_packets.size() - 1);
+        };
+
+        // every wide node takes the two to four binary descendants with the largest surface areas
+        const auto collapse = [&](const auto& self, const uint32_t binary_index) -> uint32_t
+        {
+            const BinaryNode& binary_node = binary_nodes[binary_index];
+            if (binary_node.count > 0)
+            {
+                return create_packet(binary_node);
+            }
+
+            uint32_t children[4] = { binary_node.left, binary_node.right, 0, 0 };
+            size_t children_count = 2;
+            while (children_count < 4)
+            {
+                int largest = -1;
+                float largest_area = -1.f;
+                for (size_t i = 0; i < children_count; ++i)
+                {
+                    const BinaryNode& child = binary_nodes[children[i]];
+                    if (child.count == 0 && child.bounds.get_surface_area() > largest_area)
+                    {
+                        largest = static_cast<int>(i);
+                        largest_area = child.bounds.get_surface_area();
+                    }
+                }
+                if (largest < 0)
+                {
+                    break;
+                }
+                const BinaryNode& opened = binary_nodes[children[largest]];
+                children[largest] = opened.left;
+                children[children_count++] = opened.right;
+            }
+
+            const uint32_t node_index = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.emplace_back();
+            Node node;
+            for (size_t i = 0; i < 4; ++i)
+            {
+                if (i >= children_count)
+                {
+                    // a point box at the far corner of the float range is never entered before max_distance,
+                    // an inverted box would turn into an infinite slab instead
+                    node.min_x[i] = node.min_y[i] = node.min_z[i] = std::numeric_limits<float>::max();
+                    node.max_x[i] = node.max_y[i] = node.max_z[i] = std::numeric_limits<float>::max();
+                    node.children[i] = empty_child;
+                    continue;
+                }
+                const Bounds& bounds = binary_nodes[children[i]].bounds;
+                node.min_x[i] = bounds.min.x; node.min_y[i] = bounds.min.y; node.min_z[i] = bounds.min.z;
+                node.max_x[i] = bounds.max.x; node.max_y[i] = bounds.max.y; node.max_z[i] = bounds.max.z;
+                node.children[i] = self(self, children[i]);
+            }
+            m_nodes[node_index] = node;
+            return node_index;
+        };
+
+        m_nodes.reserve(binary_nodes.size() / 2 + 1);
+        m_packets.reserve(m_triangles_count / 2 + 1);
+        m_root = collapse(collapse, 0);
+    }
+
+#if defined(SIMPLE_ENGINE_TRIANGLE_BVH_SSE)
+
+    // bit i of the result is set when the ray enters child i before max_distance
+    static inline int intersect_boxes(const float* min_x, const float* min_y, const float* min_z,
+                                      const float* max_x, const float* max_y, const float* max_z,
+                                      const Ray& ray, const float max_distance, float* near_distances)
+    {
+        const __m128 origin_x = _mm_set1_ps(ray.origin.x);
+        const __m128 origin_y = _mm_set1_ps(ray.origin.y);
+        const __m128 origin_z = _mm_set1_ps(ray.origin.z);
+        const __m128 inverse_x = _mm_set1_ps(ray.inverse_direction.x);
+        const __m128 inverse_y = _mm_set1_ps(ray.inverse_direction.y);
+        const __m128 inverse_z = _mm_set1_ps(ray.inverse_direction.z);
+
+        const __m128 t0_x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(min_x), origin_x), inverse_x);
+        const __m128 t1_x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(max_x), origin_x), inverse_x);
+        const __m128 t0_y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(min_y), origin_y), inverse_y);
+        const __m128 t1_y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(max_y), origin_y), inverse_y);
+        const __m128 t0_z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(min_z), origin_z), inverse_z);
+        const __m128 t1_z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(max_z), origin_z), inverse_z);
+
+        __m128 t_near = _mm_max_ps(_mm_min_ps(t0_x, t1_x), _mm_min_ps(t0_y, t1_y));
+        t_near = _mm_max_ps(t_near, _mm_max_ps(_mm_min_ps(t0_z, t1_z), _mm_setzero_ps()));
+        __m128 t_far = _mm_min_ps(_mm_max_ps(t0_x, t1_x), _mm_max_ps(t0_y, t1_y));
+        t_far = _mm_min_ps(t_far, _mm_min_ps(_mm_max_ps(t0_z, t1_z), _mm_set1_ps(max_distance)));
+
+        _mm_storeu_ps(near_distances, t_near);
+        return _mm_movemask_ps(_mm_cmple_ps(t_near, t_far));
+    }
+
+    static inline __m128 dot4(const __m128 ax, const __m128 ay, const __m128 az, const __m128 bx, const __m128 by, const __m128 bz)
+    {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+    }
+
+    // Moller-Trumbore on four triangles, bit i of the result is set for a hit closer than max_distance
+    static inline int intersect_triangles(const float* v0_x, const float* v0_y, const float* v0_z,
+                                          const float* e1_x, const float* e1_y, const float* e1_z,
+                                          const float* e2_x, const float* e2_y, const float* e2_z,
+                                          const Ray& ray, const float max_distance, float* distances, float* us, float* vs)
+    {
+        const __m128 direction_x = _mm_set1_ps(ray.direction.x);
+        const __m128 direction_y = _mm_set1_ps(ray.direction.y);
+        const __m128 direction_z = _mm_set1_ps(ray.direction.z);
+        const __m128 edge1_x = _mm_load_ps(e1_x);
+        const __m128 edge1_y = _mm_load_ps(e1_y);
+        const __m128 edge1_z = _mm_load_ps(e1_z);
+        const __m128 edge2_x = _mm_load_ps(e2_x);
+        const __m128 edge2_y = _mm_load_ps(e2_y);
+        const __m128 edge2_z = _mm_load_ps(e2_z);
+
+        const __m128 p_x = _mm_sub_ps(_mm_mul_ps(direction_y, edge2_z), _mm_mul_ps(direction_z, edge2_y));
+        const __m128 p_y = _mm_sub_ps(_mm_mul_ps(direction_z, edge2_x), _mm_mul_ps(direction_x, edge2_z));
+        const __m128 p_z = _mm_sub_ps(_mm_mul_ps(direction_x, edge2_y), _mm_mul_ps(direction_y, edge2_x));
+        const __m128 determinant = dot4(edge1_x, edge1_y, edge1_z, p_x, p_y, p_z);
+        const __m128 inverse_determinant = _mm_div_ps(_mm_set1_ps(1.f), determinant);
+
+        const __m128 t_x = _mm_sub_ps(_mm_set1_ps(ray.origin.x), _mm_load_ps(v0_x));
+        const __m128 t_y = _mm_sub_ps(_mm_set1_ps(ray.origin.y), _mm_load_ps(v0_y));
+        const __m128 t_z = _mm_sub_ps(_mm_set1_ps(ray.origin.z), _mm_load_ps(v0_z));
+        const __m128 u = _mm_mul_ps(dot4(t_x, t_y, t_z, p_x, p_y, p_z), inverse_determinant);
+
+        const __m128 q_x = _mm_sub_ps(_mm_mul_ps(t_y, edge1_z), _mm_mul_ps(t_z, edge1_y));
+        const __m128 q_y = _mm_sub_ps(_mm_mul_ps(t_z, edge1_x), _mm_mul_ps(t_x, edge1_z));
+        const __m128 q_z = _mm_sub_ps(_mm_mul_ps(t_x, edge1_y), _mm_mul_ps(t_y, edge1_x));
+        const __m128 v = _mm_mul_ps(dot4(direction_x, direction_y, direction_z, q_x, q_y, q_z), inverse_determinant);
+        const __m128 t = _mm_mul_ps(dot4(edge2_x, edge2_y, edge2_z, q_x, q_y, q_z), inverse_determinant);
+
+        const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        __m128 mask = _mm_cmpgt_ps(_mm_and_ps(determinant, abs_mask), _mm_set1_ps(triangle_epsilon));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(u, _mm_setzero_ps()));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(v, _mm_setzero_ps()));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.f)));
+        mask = _mm_and_ps(mask, _mm_cmpgt_ps(t, _mm_set1_ps(min_hit_distance)));
+        mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(max_distance)));
+
+        _mm_storeu_ps(distances, t);
+        _mm_storeu_ps(us, u);
+        _mm_storeu_ps(vs, v);
+        return _mm_movemask_ps(mask);
+    }
+
+#else
+
+    static inline int intersect_boxes(const float* min_x, const float* min_y, const float* min_z,
+                                      const float* max_x, const float* max_y, const float* max_z,
+                                      const Ray& ray, const float max_distance, float* near_distances)
+    {
+        int mask = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const glm::vec3 t0 = (glm::vec3(min_x[i], min_y[i], min_z[i]) - ray.origin) * ray.inverse_direction;
+            const glm::vec3 t1 = (glm::vec3(max_x[i], max_y[i], max_z[i]) - ray.origin) * ray.inverse_direction;
+            const glm::vec3 t_min = glm::min(t0, t1);
+            const glm::vec3 t_max = glm::max(t0, t1);
+            const float t_near = std::max(std::max(t_min.x, t_min.y), std::max(t_min.z, 0.f));
+            const float t_far = std::min(std::min(t_max.x, t_max.y), std::min(t_max.z, max_distance));
+            near_distances[i] = t_near;
+            mask |= t_near <= t_far ? 1 << i : 0;
+        }
+        return mask;
+    }
+
+    static inline int intersect_triangles(const float* v0_x, const float* v0_y, const float* v0_z,
+                                          const float* e1_x, const float* e1_y, const float* e1_z,
+                                          const float* e2_x, const float* e2_y, const float* e2_z,
+                                          const Ray& ray, const float max_distance, float* distances, float* us, float* vs)
+    {
+        int mask = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const glm::vec3 edge1(e1_x[i], e1_y[i], e1_z[i]);
+            const glm::vec3 edge2(e2_x[i], e2_y[i], e2_z[i]);
+            const glm::vec3 p = glm::cross(ray.direction, edge2);
+            const float determinant = glm::dot(edge1, p);
+            if (std::abs(determinant) <= triangle_epsilon)
+            {
+                continue;
+            }
+            const float inverse_determinant = 1.f / determinant;
+            const glm::vec3 t = ray.origin - glm::vec3(v0_x[i], v0_y[i], v0_z[i]);
+            const glm::vec3 q = glm::cross(t, edge1);
+            us[i] = glm::dot(t, p) * inverse_determinant;
+            vs[i] = glm::dot(ray.direction, q) * inverse_determinant;
+            distances[i] = glm::dot(edge2, q) * inverse_determinant;
+            if (us[i] >= 0.f && vs[i] >= 0.f && us[i] + vs[i] <= 1.f && distances[i] > min_hit_distance && distances[i] < max_distance)
+            {
+                mask |= 1 << i;
+            }
+        }
+        return mask;
+    }
+
+#endif
+
+    template<bool any_hit>
+    bool TriangleBvh::traverse(const glm::vec3& origin, const glm::vec3& direction, const float max_distance, Hit& hit) const
+    {
+        if (m_root == empty_child)
+        {
+            return false;
+        }
+
+        Ray ray;
+        ray.origin = origin;
+        ray.direction = direction;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            // keeps the slab test free of 0 * inf
+            const float component = std::abs(direction[axis]) > 1e-20f ? direction[axis] : std::copysign(1e-20f, direction[axis]);
+            ray.inverse_direction[axis] = 1.f / component;
+        }
+
+        uint32_t stack[traversal_stack_size];
+        size_t stack_size = 0;
+        stack[stack_size++] = m_root;
+        float closest = max_distance;
+        bool found = false;
+
+        while (stack_size > 0)
+        {
+            const uint32_t reference = stack[--stack_size];
+            if (reference & leaf_flag)
+            {
+                const TrianglePacket& packet = m_packets[reference & ~leaf_flag];
+                float distances[4];
+                float us[4];
+                float vs[4];
+                int mask = intersect_triangles(packet.v0_x, packet.v0_y, packet.v0_z,
+                                               packet.e1_x, packet.e1_y, packet.e1_z,
+                                               packet.e2_x, packet.e2_y, packet.e2_z,
+                                               ray, closest, distances, us, vs);
+                if (mask == 0)
+                {
+                    continue;
+                }
+                if (any_hit)
+                {
+                    return true;
+                }
+                for (int lane = 0; mask != 0; ++lane, mask >>= 1)
+                {
+                    if ((mask & 1) && distances[lane] < closest)
+                    {
+                        closest = distances[lane];
+                        hit.distance = distances[lane];
+                        hit.triangle = packet.triangles[lane];
+                        hit.u = us[lane];
+                        hit.v = vs[lane];
+                        found = true;
+                    }
+                }
+                continue;
+            }
+
+            const Node& node = m_nodes[reference];
+            float near_distances[4];
+            int mask = intersect_boxes(node.min_x, node.min_y, node.min_z, node.max_x, node.max_y, node.max_z, ray, closest, near_distances);
+
+            // push the farthest child first so the nearest one is visited next
+            uint32_t hit_children[4];
+            float hit_distances[4];
+            size_t hits_count = 0;
+            for (int i = 0; mask != 0; ++i, mask >>= 1)
+            {
+                if (mask & 1)
+                {
+                    size_t position = hits_count++;
+                    while (position > 0 && hit_distances[position - 1] < near_distances[i])
+                    {
+                        hit_children[position] = hit_children[position - 1];
+                        hit_distances[position] = hit_distances[position - 1];
+                        --position;
+                    }
+                    hit_children[position] = node.children[i];
+                    hit_distances[position] = near_distances[i];
+                }
+            }
+            for (size_t i = 0; i < hits_count && stack_size < traversal_stack_size; ++i)
+            {
+                stack[stack_size++] = hit_children[i];
+            }
+        }
+        return found;
+    }
+
+    bool TriangleBvh::intersect(const glm::vec3& origin, const glm::vec3& direction, const float max_distance, Hit& hit) const
+    {
+        return traverse<false>(origin, direction, max_distance, hit);
+    }
+
+    bool TriangleBvh::occluded(const glm::vec3& origin, const glm::vec3& direction, const float max_distance) const
+    {
+        Hit hit;
+        return traverse<true>(origin, direction, max_distance, hit);
+    }
+}
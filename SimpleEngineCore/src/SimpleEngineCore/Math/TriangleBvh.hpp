@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // Four-wide BVH over world space triangles for the CPU ray tracers.
+    // Nodes keep the bounds of their four children as SoA, so a ray is tested against all of them
+    // with one SIMD slab test, and every leaf is a packet of up to four triangles tested together.
+    class TriangleBvh
+    {
+    public:
+        static constexpr uint32_t invalid_triangle = ~0u;
+
+        struct Hit
+        {
+            float distance = 0.f;
+            uint32_t triangle = invalid_triangle;
+            // barycentric coordinates of vertices 1 and 2
+            float u = 0.f;
+            float v = 0.f;
+        };
+
+        // three vertices per triangle, triangle i is vertices[3 * i] .. vertices[3 * i + 2]
+        void build(const std::vector<glm::vec3>& vertices);
+
+        bool intersect(const glm::vec3& origin, const glm::vec3& direction, const float max_distance, Hit& hit) const;
+        // any hit closer than max_distance, for shadow rays
+        bool occluded(const glm::vec3& origin, const glm::vec3& direction, const float max_distance) const;
+
+        size_t get_triangles_count() const { return m_triangles_count; }
+        size_t get_nodes_count() const { return m_nodes.size(); }
+
+    private:
+        // child references: inner node index, or leaf_flag | packet index
+        static constexpr uint32_t leaf_flag = 0x80000000u;
+        static constexpr uint32_t empty_child = ~0u;
+
+        struct alignas(16) Node
+        {
+            float min_x[4];
+            float min_y[4];
+            float min_z[4];
+            float max_x[4];
+            float max_y[4];
+            float max_z[4];
+            uint32_t children[4];
+        };
+
+        // vertex 0 and both edges, missing triangles have zero edges and never hit
+        struct alignas(16) TrianglePacket
+        {
+            float v0_x[4];
+            float v0_y[4];
+            float v0_z[4];
+            float e1_x[4];
+            float e1_y[4];
+            float e1_z[4];
+            float e2_x[4];
+            float e2_y[4];
+            float e2_z[4];
+            uint32_t triangles[4];
+        };
+
+        template<bool any_hit>
+        bool traverse(const glm::vec3& origin, const glm::vec3& direction, const float max_distance, Hit& hit) const;
+
+        std::vector<Node> m_nodes;
+        std::vector<TrianglePacket> m_packets;
+        size_t m_triangles_count = 0;
+        uint32_t m_root = empty_child;
+    };
+
+}
@@ -0,0 +1,448 @@
+#include "SimpleEngineCore/Memory.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace SimpleEngine {
+
+    constexpr size_t tags_count = static_cast<size_t>(EMemoryTag::Count);
+
+    const char* get_memory_tag_name(const EMemoryTag tag)
+    {
+        static const char* names[tags_count] = { "General", "Rendering", "Lighting", "Jobs", "Events", "Input", "UI", "Profiler", "Log", "IO" };
+        return tag < EMemoryTag::Count ? names[static_cast<size_t>(tag)] : "Unknown";
+    }
+
+    // touched by operator new on every thread, a cache line per tag keeps the subsystems from contending
+    struct alignas(64) TagCounters
+    {
+        std::atomic<uint64_t> live_bytes{ 0 };
+        std::atomic<uint64_t> live_allocations_count{ 0 };
+        std::atomic<uint64_t> peak_live_bytes{ 0 };
+        std::atomic<uint64_t> frame_allocations_count{ 0 };
+        std::atomic<uint64_t> frame_bytes{ 0 };
+    };
+
+    // constant initialized: operator new may run before any dynamic initializer
+    static TagCounters s_tag_counters[tags_count];
+    // finished frames, written by new_frame() on the main thread
+    static MemoryTracker::TagStats s_frame_stats[tags_count];
+    static std::mutex s_frame_stats_mutex;
+
+    static thread_local EMemoryTag t_memory_tag = EMemoryTag::General;
+
+    static void on_allocate(const EMemoryTag tag, const size_t size)
+    {
+        TagCounters& counters = s_tag_counters[static_cast<size_t>(tag)];
+        const uint64_t live_bytes = counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        counters.live_allocations_count.fetch_add(1, std::memory_order_relaxed);
+        counters.frame_allocations_count.fetch_add(1, std::memory_order_relaxed);
+        counters.frame_bytes.fetch_add(size, std::memory_order_relaxed);
+        uint64_t peak_live_bytes = counters.peak_live_bytes.load(std::memory_order_relaxed);
+        while (live_bytes > peak_live_bytes
+               && !counters.peak_live_bytes.compare_exchange_weak(peak_live_bytes, live_bytes, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    static void on_free(const EMemoryTag tag, const size_t size)
+    {
+        TagCounters& counters = s_tag_counters[static_cast<size_t>(tag)];
+        counters.live_bytes.fetch_sub(size, std::memory_order_relaxed);
+        counters.live_allocations_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    bool MemoryTracker::is_enabled()
+    {
+#ifdef SIMPLE_ENGINE_MEMORY_TRACKING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void MemoryTracker::new_frame()
+    {
+        std::lock_guard<std::mutex> lock(s_frame_stats_mutex);
+        for (size_t i = 0; i < tags_count; ++i)
+        {
+            TagCounters& counters = s_tag_counters[i];
+            TagStats& stats = s_frame_stats[i];
+            stats.frame_allocations_count = counters.frame_allocations_count.exchange(0, std::memory_order_relaxed);
+            stats.frame_bytes = counters.frame_bytes.exchange(0, std::memory_order_relaxed);
+            stats.peak_frame_allocations_count = std::max(stats.peak_frame_allocations_count, stats.frame_allocations_count);
+            stats.peak_frame_bytes = std::max(stats.peak_frame_bytes, stats.frame_bytes);
+        }
+    }
+
+    MemoryTracker::TagStats MemoryTracker::get_stats(const EMemoryTag tag)
+    {
+        const TagCounters& counters = s_tag_counters[static_cast<size_t>(tag)];
+        TagStats stats;
+        {
+            std::lock_guard<std::mutex> lock(s_frame_stats_mutex);
+            stats = s_frame_stats[static_cast<size_t>(tag)];
+        }
+        stats.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+        stats.live_allocations_count = counters.live_allocations_count.load(std::memory_order_relaxed);
+        stats.peak_live_bytes = counters.peak_live_bytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    uint64_t MemoryTracker::get_current_frame_allocations_count(const EMemoryTag tag)
+    {
+        return s_tag_counters[static_cast<size_t>(tag)].frame_allocations_count.load(std::memory_order_relaxed);
+    }
+
+    void MemoryTracker::reset_peaks()
+    {
+        std::lock_guard<std::mutex> lock(s_frame_stats_mutex);
+        for (size_t i = 0; i < tags_count; ++i)
+        {
+            s_tag_counters[i].peak_live_bytes.store(s_tag_counters[i].live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            s_frame_stats[i].peak_frame_allocations_count = s_frame_stats[i].frame_allocations_count;
+            s_frame_stats[i].peak_frame_bytes = s_frame_stats[i].frame_bytes;
+        }
+    }
+
+
+    MemoryTagScope::MemoryTagScope(const EMemoryTag tag)
+        : m_previous_tag(t_memory_tag)
+    {
+        t_memory_tag = tag;
+    }
+
+    MemoryTagScope::~MemoryTagScope()
+    {
+        t_memory_tag = m_previous_tag;
+    }
+
+    EMemoryTag MemoryTagScope::get_current()
+    {
+        return t_memory_tag;
+    }
+
+
+    FrameArena::FrameArena(const size_t capacity, const EMemoryTag tag)
+        : m_capacity(capacity)
+        , m_tag(tag)
+    {
+        MemoryTagScope tag_scope(m_tag);
+        m_pBuffer = std::make_unique<uint8_t[]>(m_capacity);
+        m_overflow_blocks.reserve(16);
+    }
+
+    FrameArena::~FrameArena()
+    {
+        free_overflow_blocks();
+    }
+
+    void* FrameArena::allocate(const size_t size, const size_t alignment)
+    {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(m_pBuffer.get());
+        size_t offset = m_offset.load(std::memory_order_relaxed);
+        while (true)
+        {
+            const size_t aligned_offset = ((base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+            if (aligned_offset + size > m_capacity)
+            {
+                return allocate_overflow(size, alignment);
+            }
+            if (m_offset.compare_exchange_weak(offset, aligned_offset + size, std::memory_order_relaxed))
+            {
+                return m_pBuffer.get() + aligned_offset;
+            }
+        }
+    }
+
+    void* FrameArena::allocate_overflow(const size_t size, const size_t alignment)
+    {
+        MemoryTagScope tag_scope(m_tag);
+        void* pBlock = ::operator new(size, std::align_val_t(alignment));
+        std::lock_guard<std::mutex> lock(m_overflow_mutex);
+        m_overflow_blocks.emplace_back(pBlock, alignment);
+        m_overflow_bytes.fetch_add(size, std::memory_order_relaxed);
+        return pBlock;
+    }
+
+    void FrameArena::free_overflow_blocks()
+    {
+        for (const std::pair<void*, size_t>& block : m_overflow_blocks)
+        {
+            ::operator delete(block.first, std::align_val_t(block.second));
+        }
+        m_overflow_blocks.clear();
+    }
+
+    size_t FrameArena::get_used_bytes() const
+    {
+        return std::min(m_offset.load(std::memory_order_relaxed), m_capacity) + m_overflow_bytes.load(std::memory_order_relaxed);
+    }
+
+    void FrameArena::reset()
+    {
+        const size_t used_bytes = get_used_bytes();
+        m_peak_used_bytes = std::max(m_peak_used_bytes, used_bytes);
+        free_overflow_blocks();
+
+        if (m_overflow_bytes.load(std::memory_order_relaxed) > 0)
+        {
+            // alignment padding of the overflow blocks isn't counted, the slack covers it
+            size_t capacity = std::max<size_t>(m_capacity, 4096);
+            while (capacity < used_bytes + used_bytes / 4)
+            {
+                capacity *= 2;
+            }
+            MemoryTagScope tag_scope(m_tag);
+            m_pBuffer = nullptr;
+            m_pBuffer = std::make_unique<uint8_t[]>(capacity);
+            m_capacity = capacity;
+        }
+        m_offset.store(0, std::memory_order_relaxed);
+        m_overflow_bytes.store(0, std::memory_order_relaxed);
+    }
+
+
+    constexpr size_t initial_frame_arena_capacity = size_t(1) << 20;
+
+    struct FrameArenas
+    {
+        FrameArena arenas[2] = { FrameArena(initial_frame_arena_capacity), FrameArena(initial_frame_arena_capacity) };
+        std::atomic<size_t> current{ 0 };
+    };
+
+    static FrameArenas& get_frame_arenas()
+    {
+        static FrameArenas frame_arenas;
+        return frame_arenas;
+    }
+
+    FrameArena& FrameMemory::get_arena()
+    {
+        FrameArenas& frame_arenas = get_frame_arenas();
+        return frame_arenas.arenas[frame_arenas.current.load(std::memory_order_relaxed)];
+    }
+
+    const FrameArena& FrameMemory::get_previous_arena()
+    {
+        FrameArenas& frame_arenas = get_frame_arenas();
+        return frame_arenas.arenas[frame_arenas.current.load(std::memory_order_relaxed) ^ 1];
+    }
+
+    void FrameMemory::new_frame()
+    {
+        FrameArenas& frame_arenas = get_frame_arenas();
+        const size_t next = frame_arenas.current.load(std::memory_order_relaxed) ^ 1;
+        frame_arenas.arenas[next].reset();
+        frame_arenas.current.store(next, std::memory_order_relaxed);
+    }
+
+
+    FixedPool::FixedPool(const size_t block_size, const size_t blocks_per_chunk, const EMemoryTag tag)
+        // a block holds the free list link and keeps the next block aligned for any fundamental type
+        : m_block_size((std::max(block_size, sizeof(FreeBlock)) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1))
+        , m_blocks_per_chunk(std::max<size_t>(blocks_per_chunk, 1))
+        , m_tag(tag)
+    {
+    }
+
+    FixedPool::~FixedPool() = default;
+
+    void* FixedPool::allocate()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_pFreeBlocks)
+        {
+            MemoryTagScope tag_scope(m_tag);
+            m_chunks.push_back(std::make_unique<uint8_t[]>(m_block_size * m_blocks_per_chunk));
+            uint8_t* pChunk = m_chunks.back().get();
+            for (size_t i = m_blocks_per_chunk; i > 0; --i)
+            {
+                FreeBlock* pBlock = reinterpret_cast<FreeBlock*>(pChunk + (i - 1) * m_block_size);
+                pBlock->pNext = m_pFreeBlocks;
+                m_pFreeBlocks = pBlock;
+            }
+            m_blocks_count.fetch_add(m_blocks_per_chunk, std::memory_order_relaxed);
+        }
+        FreeBlock* pBlock = m_pFreeBlocks;
+        m_pFreeBlocks = pBlock->pNext;
+        m_used_blocks_count.fetch_add(1, std::memory_order_relaxed);
+        return pBlock;
+    }
+
+    void FixedPool::deallocate(void* pBlock)
+    {
+        if (!pBlock)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        FreeBlock* pFreeBlock = static_cast<FreeBlock*>(pBlock);
+        pFreeBlock->pNext = m_pFreeBlocks;
+        m_pFreeBlocks = pFreeBlock;
+        m_used_blocks_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+
+    constexpr size_t blocks_per_pool_chunk = 256;
+
+    struct TagPools
+    {
+        TagPools(const EMemoryTag tag)
+            : pools{ FixedPool(MemoryPools::min_block_size, blocks_per_pool_chunk, tag),
+                     FixedPool(MemoryPools::min_block_size << 1, blocks_per_pool_chunk, tag),
+                     FixedPool(MemoryPools::min_block_size << 2, blocks_per_pool_chunk, tag),
+                     FixedPool(MemoryPools::min_block_size << 3, blocks_per_pool_chunk, tag),
+                     FixedPool(MemoryPools::min_block_size << 4, blocks_per_pool_chunk, tag) }
+        {
+        }
+
+        FixedPool pools[MemoryPools::size_classes_count];
+    };
+
+    static TagPools& get_tag_pools(const EMemoryTag tag)
+    {
+        // chunks are only allocated on first use, an unused tag costs its pool headers
+        static TagPools* tag_pools[tags_count] = {};
+        static std::once_flag once;
+        std::call_once(once, []()
+            {
+                for (size_t i = 0; i < tags_count; ++i)
+                {
+                    // never freed: containers in other statics may return blocks during exit
+                    tag_pools[i] = new TagPools(static_cast<EMemoryTag>(i));
+                }
+            });
+        return *tag_pools[static_cast<size_t>(tag)];
+    }
+
+    static size_t get_size_class(const size_t size)
+    {
+        size_t size_class = 0;
+        while ((MemoryPools::min_block_size << size_class) < size)
+        {
+            ++size_class;
+        }
+        return size_class;
+    }
+
+    void* MemoryPools::allocate(const size_t size, const size_t alignment, const EMemoryTag tag)
+    {
+        if (size > max_block_size || alignment > alignof(std::max_align_t))
+        {
+            MemoryTagScope tag_scope(tag);
+            return ::operator new(size, std::align_val_t(alignment));
+        }
+        return get_tag_pools(tag).pools[get_size_class(size)].allocate();
+    }
+
+    void MemoryPools::deallocate(void* p, const size_t size, const size_t alignment, const EMemoryTag tag)
+    {
+        if (size > max_block_size || alignment > alignof(std::max_align_t))
+        {
+            ::operator delete(p, std::align_val_t(alignment));
+            return;
+        }
+        get_tag_pools(tag).pools[get_size_class(size)].deallocate(p);
+    }
+
+    const FixedPool& MemoryPools::get_pool(const EMemoryTag tag, const size_t size_class)
+    {
+        return get_tag_pools(tag).pools[size_class];
+    }
+
+}
+
+#ifdef SIMPLE_ENGINE_MEMORY_TRACKING
+
+namespace {
+
+    // in front of every tracked allocation: what to subtract on free, and where the malloc block starts
+    struct AllocationHeader
+    {
+        uint64_t size;
+        uint32_t offset;
+        SimpleEngine::EMemoryTag tag;
+    };
+
+    constexpr size_t header_size = alignof(std::max_align_t) > 16 ? alignof(std::max_align_t) : 16;
+    static_assert(sizeof(AllocationHeader) <= header_size, "allocation header doesn't fit");
+
+    void* tracked_allocate(const size_t size, size_t alignment) noexcept
+    {
+        alignment = std::max(alignment, alignof(std::max_align_t));
+        const size_t extra = header_size + (alignment > alignof(std::max_align_t) ? alignment : 0);
+        if (size > SIZE_MAX - extra)
+        {
+            return nullptr;
+        }
+        uint8_t* pBlock = static_cast<uint8_t*>(std::malloc(size + extra));
+        if (!pBlock)
+        {
+            return nullptr;
+        }
+        const uintptr_t user_address = (reinterpret_cast<uintptr_t>(pBlock) + header_size + alignment - 1) & ~(uintptr_t(alignment) - 1);
+        uint8_t* pUser = reinterpret_cast<uint8_t*>(user_address);
+        AllocationHeader* pHeader = reinterpret_cast<AllocationHeader*>(pUser - header_size);
+        pHeader->size = size;
+        pHeader->offset = static_cast<uint32_t>(pUser - pBlock);
+        pHeader->tag = SimpleEngine::MemoryTagScope::get_current();
+        SimpleEngine::on_allocate(pHeader->tag, size);
+        return pUser;
+    }
+
+    void* tracked_allocate_or_throw(const size_t size, const size_t alignment)
+    {
+        while (true)
+        {
+            void* p = tracked_allocate(size, alignment);
+            if (p)
+            {
+                return p;
+            }
+            const std::new_handler handler = std::get_new_handler();
+            if (!handler)
+            {
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+
+    void tracked_free(void* p) noexcept
+    {
+        if (!p)
+        {
+            return;
+        }
+        uint8_t* pUser = static_cast<uint8_t*>(p);
+        const AllocationHeader* pHeader = reinterpret_cast<const AllocationHeader*>(pUser - header_size);
+        SimpleEngine::on_free(pHeader->tag, static_cast<size_t>(pHeader->size));
+        std::free(pUser - pHeader->offset);
+    }
+
+}
+
+void* operator new(size_t size) { return tracked_allocate_or_throw(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return tracked_allocate_or_throw(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return tracked_allocate(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return tracked_allocate(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return tracked_allocate_or_throw(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return tracked_allocate_or_throw(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return tracked_allocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return tracked_allocate(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* p) noexcept { tracked_free(p); }
+void operator delete[](void* p) noexcept { tracked_free(p); }
+void operator delete(void* p, size_t) noexcept { tracked_free(p); }
+void operator delete[](void* p, size_t) noexcept { tracked_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { tracked_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { tracked_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { tracked_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { tracked_free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { tracked_free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { tracked_free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(p); }
+
+#endif
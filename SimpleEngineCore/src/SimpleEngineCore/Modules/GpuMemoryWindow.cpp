@@ -0,0 +1,190 @@
+#include "GpuMemoryWindow.hpp"
+#include "SimpleEngineCore/GpuMemory.hpp"
+#include "SimpleEngineCore/Assets/TextureStreamer.hpp"
+
+#include <imgui/imgui.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace SimpleEngine {
+
+    constexpr size_t largest_resources_count = 16;
+
+    static std::vector<GpuMemory::ResourceInfo> s_resources;
+
+    static const char* format_bytes(char (&text)[32], const uint64_t bytes)
+    {
+        if (bytes < 1024 * 1024)
+        {
+            std::snprintf(text, sizeof(text), "%.1f KB", bytes / 1024.0);
+        }
+        else
+        {
+            std::snprintf(text, sizeof(text), "%.2f MB", bytes / (1024.0 * 1024.0));
+        }
+        return text;
+    }
+
+    static void draw_budget(const GpuMemory::Stats& stats)
+    {
+        char total[32];
+        char budget[32];
+        char peak[32];
+        if (stats.budget_bytes > 0)
+        {
+            const float fraction = static_cast<float>(static_cast<double>(stats.total_bytes) / static_cast<double>(stats.budget_bytes));
+            char overlay[96];
+            std::snprintf(overlay, sizeof(overlay), "%s of %s", format_bytes(total, stats.total_bytes), format_bytes(budget, stats.budget_bytes));
+            ImGui::ProgressBar(std::min(fraction, 1.f), ImVec2(-1.f, 0.f), overlay);
+        }
+        else
+        {
+            ImGui::Text("%s, no budget", format_bytes(total, stats.total_bytes));
+        }
+        ImGui::Text("Peak %s, evicted %s in %llu evictions", format_bytes(peak, stats.peak_total_bytes), format_bytes(budget, stats.evicted_bytes),
+                    static_cast<unsigned long long>(stats.evictions_count));
+
+        int budget_mb = static_cast<int>(stats.budget_bytes >> 20);
+        if (ImGui::SliderInt("Budget (MB, 0 = none)", &budget_mb, 0, 8192))
+        {
+            GpuMemory::set_budget(static_cast<uint64_t>(budget_mb) << 20);
+        }
+    }
+
+    static void draw_categories(const GpuMemory::Stats& stats)
+    {
+        if (!ImGui::BeginTable("##categories", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            return;
+        }
+        ImGui::TableSetupColumn("Category");
+        ImGui::TableSetupColumn("Resources");
+        ImGui::TableSetupColumn("Bytes");
+        ImGui::TableSetupColumn("Peak");
+        ImGui::TableHeadersRow();
+        char text[32];
+        for (size_t i = 0; i < static_cast<size_t>(EGpuMemoryCategory::Count); ++i)
+        {
+            const GpuMemory::CategoryStats& category = stats.categories[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(get_gpu_memory_category_name(static_cast<EGpuMemoryCategory>(i)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", category.resources_count);
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(format_bytes(text, category.bytes));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(format_bytes(text, category.peak_bytes));
+        }
+        ImGui::EndTable();
+    }
+
+    static void draw_largest_resources()
+    {
+        GpuMemory::get_resources(s_resources);
+        const size_t shown_count = std::min(s_resources.size(), largest_resources_count);
+        std::partial_sort(s_resources.begin(), s_resources.begin() + shown_count, s_resources.end(),
+            [](const GpuMemory::ResourceInfo& a, const GpuMemory::ResourceInfo& b) { return a.bytes > b.bytes; });
+
+        if (!ImGui::BeginTable("##resources", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            return;
+        }
+        ImGui::TableSetupColumn("Resource");
+        ImGui::TableSetupColumn("Category");
+        ImGui::TableSetupColumn("Bytes");
+        ImGui::TableSetupColumn("Last used frame");
+        ImGui::TableHeadersRow();
+        char text[32];
+        for (size_t i = 0; i < shown_count; ++i)
+        {
+            const GpuMemory::ResourceInfo& resource = s_resources[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s%s", resource.name, resource.streamable ? " (streamable)" : "");
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(get_gpu_memory_category_name(resource.category));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(format_bytes(text, resource.bytes));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(resource.last_used_frame));
+        }
+        ImGui::EndTable();
+    }
+
+    static void draw_texture_streaming()
+    {
+        const TextureStreamer::Stats stats = TextureStreamer::get_stats();
+        char resident[32];
+        char budget[32];
+        char text[32];
+        if (stats.budget_bytes > 0)
+        {
+            const float fraction = static_cast<float>(static_cast<double>(stats.resident_bytes) / static_cast<double>(stats.budget_bytes));
+            char overlay[96];
+            std::snprintf(overlay, sizeof(overlay), "%s resident of %s", format_bytes(resident, stats.resident_bytes), format_bytes(budget, stats.budget_bytes));
+            ImGui::ProgressBar(std::min(fraction, 1.f), ImVec2(-1.f, 0.f), overlay);
+        }
+        ImGui::Text("Pending: %s", format_bytes(text, stats.pending_bytes));
+        ImGui::Text("Wanted: %s", format_bytes(text, stats.wanted_bytes));
+        ImGui::Text("Textures: %zu, %zu loading, %zu failed", stats.textures_count, stats.loading_count, stats.failed_count);
+        ImGui::Text("Streamed in %s, out %s", format_bytes(resident, stats.streamed_in_bytes), format_bytes(budget, stats.streamed_out_bytes));
+
+        int budget_mb = static_cast<int>(stats.budget_bytes >> 20);
+        if (ImGui::SliderInt("Streaming budget (MB)", &budget_mb, 16, 4096))
+        {
+            TextureStreamer::set_budget(static_cast<uint64_t>(budget_mb) << 20);
+        }
+    }
+
+    static void draw_driver_info()
+    {
+        const GpuMemory::DriverInfo info = GpuMemory::query_driver_memory();
+        if (!info.available)
+        {
+            ImGui::TextUnformatted("The driver exposes neither GL_NVX_gpu_memory_info nor GL_ATI_meminfo");
+            return;
+        }
+        char text[32];
+        ImGui::Text("Through %s", info.extension);
+        if (info.total_bytes > 0)
+        {
+            ImGui::Text("Dedicated: %s", format_bytes(text, info.total_bytes));
+        }
+        ImGui::Text("Available: %s", format_bytes(text, info.available_bytes));
+        if (info.evictions_count > 0)
+        {
+            ImGui::Text("Evicted by the driver: %s in %llu evictions", format_bytes(text, info.evicted_bytes),
+                        static_cast<unsigned long long>(info.evictions_count));
+        }
+    }
+
+    void GpuMemoryWindow::draw(bool* p_open)
+    {
+        if (!ImGui::Begin("GPU Memory", p_open))
+        {
+            ImGui::End();
+            return;
+        }
+
+        const GpuMemory::Stats stats = GpuMemory::get_stats();
+        draw_budget(stats);
+        draw_categories(stats);
+        if (ImGui::CollapsingHeader("Largest resources"))
+        {
+            draw_largest_resources();
+        }
+        if (ImGui::CollapsingHeader("Texture streaming", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            draw_texture_streaming();
+        }
+        if (ImGui::CollapsingHeader("Driver"))
+        {
+            draw_driver_info();
+        }
+
+        ImGui::End();
+    }
+}
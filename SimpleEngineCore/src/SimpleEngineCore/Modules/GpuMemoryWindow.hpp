@@ -0,0 +1,12 @@
+#pragma once
+
+namespace SimpleEngine {
+
+    // ImGui panel for GpuMemory: bytes per category against the budget, the largest resources, texture streaming and what the driver reports
+    class GpuMemoryWindow
+    {
+    public:
+        static void draw(bool* p_open);
+    };
+
+}
@@ -0,0 +1,165 @@
+#include "MemoryWindow.hpp"
+#include "SimpleEngineCore/Memory.hpp"
+
+#include <imgui/imgui.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+
+namespace SimpleEngine {
+
+    constexpr size_t history_frames_count = 240;
+
+    // heap allocations per frame of every tag, oldest first from s_history_offset
+    static std::array<float, history_frames_count> s_allocations_history{};
+    static size_t s_history_offset = 0;
+
+    static const char* format_bytes(char (&text)[32], const uint64_t bytes)
+    {
+        if (bytes < 1024)
+        {
+            std::snprintf(text, sizeof(text), "%llu B", static_cast<unsigned long long>(bytes));
+        }
+        else if (bytes < 1024 * 1024)
+        {
+            std::snprintf(text, sizeof(text), "%.1f KB", bytes / 1024.0);
+        }
+        else
+        {
+            std::snprintf(text, sizeof(text), "%.2f MB", bytes / (1024.0 * 1024.0));
+        }
+        return text;
+    }
+
+    static void draw_tags()
+    {
+        constexpr size_t tags_count = static_cast<size_t>(EMemoryTag::Count);
+        MemoryTracker::TagStats stats[tags_count];
+        float frame_allocations_count = 0.f;
+        for (size_t i = 0; i < tags_count; ++i)
+        {
+            stats[i] = MemoryTracker::get_stats(static_cast<EMemoryTag>(i));
+            frame_allocations_count += static_cast<float>(stats[i].frame_allocations_count);
+        }
+        s_allocations_history[s_history_offset] = frame_allocations_count;
+        s_history_offset = (s_history_offset + 1) % history_frames_count;
+
+        const float max_allocations_count = *std::max_element(s_allocations_history.begin(), s_allocations_history.end());
+        ImGui::Text("Heap allocations last frame: %.0f, max %.0f over %zu frames", frame_allocations_count, max_allocations_count, history_frames_count);
+        ImGui::PlotHistogram("##allocations", s_allocations_history.data(), static_cast<int>(history_frames_count), static_cast<int>(s_history_offset),
+                             nullptr, 0.f, std::max(max_allocations_count, 1.f), ImVec2(ImGui::GetContentRegionAvail().x, 60.f));
+        if (ImGui::Button("Reset peaks"))
+        {
+            MemoryTracker::reset_peaks();
+        }
+
+        if (!ImGui::BeginTable("##tags", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            return;
+        }
+        ImGui::TableSetupColumn("Tag");
+        ImGui::TableSetupColumn("Live");
+        ImGui::TableSetupColumn("Peak live");
+        ImGui::TableSetupColumn("Allocations/frame");
+        ImGui::TableSetupColumn("Bytes/frame");
+        ImGui::TableSetupColumn("Peak allocations/frame");
+        ImGui::TableSetupColumn("Peak bytes/frame");
+        ImGui::TableHeadersRow();
+        char text[32];
+        for (size_t i = 0; i < tags_count; ++i)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(get_memory_tag_name(static_cast<EMemoryTag>(i)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%s in %llu", format_bytes(text, stats[i].live_bytes), static_cast<unsigned long long>(stats[i].live_allocations_count));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(format_bytes(text, stats[i].peak_live_bytes));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats[i].frame_allocations_count));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(format_bytes(text, stats[i].frame_bytes));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats[i].peak_frame_allocations_count));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(format_bytes(text, stats[i].peak_frame_bytes));
+        }
+        ImGui::EndTable();
+    }
+
+    static void draw_frame_arenas()
+    {
+        char used[32];
+        char capacity[32];
+        char peak[32];
+        const FrameArena& arena = FrameMemory::get_arena();
+        const FrameArena& previous_arena = FrameMemory::get_previous_arena();
+        ImGui::Text("Current: %s of %s, peak %s", format_bytes(used, arena.get_used_bytes()), format_bytes(capacity, arena.get_capacity()),
+                    format_bytes(peak, arena.get_peak_used_bytes()));
+        ImGui::Text("Previous: %s of %s, peak %s", format_bytes(used, previous_arena.get_used_bytes()), format_bytes(capacity, previous_arena.get_capacity()),
+                    format_bytes(peak, previous_arena.get_peak_used_bytes()));
+        if (arena.get_overflow_bytes() > 0)
+        {
+            ImGui::Text("Overflowed to the heap: %s, the arena grows on the next reset", format_bytes(used, arena.get_overflow_bytes()));
+        }
+    }
+
+    static void draw_pools()
+    {
+        if (!ImGui::BeginTable("##pools", 1 + static_cast<int>(MemoryPools::size_classes_count), ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            return;
+        }
+        char name[32];
+        ImGui::TableSetupColumn("Tag");
+        for (size_t size_class = 0; size_class < MemoryPools::size_classes_count; ++size_class)
+        {
+            std::snprintf(name, sizeof(name), "%zu B blocks", MemoryPools::min_block_size << size_class);
+            ImGui::TableSetupColumn(name);
+        }
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < static_cast<size_t>(EMemoryTag::Count); ++i)
+        {
+            const EMemoryTag tag = static_cast<EMemoryTag>(i);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(get_memory_tag_name(tag));
+            for (size_t size_class = 0; size_class < MemoryPools::size_classes_count; ++size_class)
+            {
+                const FixedPool& pool = MemoryPools::get_pool(tag, size_class);
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu / %zu", pool.get_used_blocks_count(), pool.get_blocks_count());
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    void MemoryWindow::draw(bool* p_open)
+    {
+        if (!ImGui::Begin("Memory", p_open))
+        {
+            ImGui::End();
+            return;
+        }
+
+        if (MemoryTracker::is_enabled())
+        {
+            draw_tags();
+        }
+        else
+        {
+            ImGui::TextUnformatted("Heap tracking built without SIMPLE_ENGINE_MEMORY_TRACKING");
+        }
+        if (ImGui::CollapsingHeader("Frame arenas"))
+        {
+            draw_frame_arenas();
+        }
+        if (ImGui::CollapsingHeader("Pools"))
+        {
+            draw_pools();
+        }
+
+        ImGui::End();
+    }
+}
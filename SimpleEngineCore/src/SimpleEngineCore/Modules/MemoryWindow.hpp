@@ -0,0 +1,12 @@
+#pragma once
+
+namespace SimpleEngine {
+
+    // ImGui panel for MemoryTracker: heap bytes and allocations per subsystem, frame arenas and pools
+    class MemoryWindow
+    {
+    public:
+        static void draw(bool* p_open);
+    };
+
+}
@@ -0,0 +1,183 @@
+#include "ProfilerWindow.hpp"
+#include "SimpleEngineCore/Memory.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuProfiler.hpp"
+
+#include <imgui/imgui.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+#ifdef SIMPLE_ENGINE_PROFILING
+
+    constexpr float row_height = 18.f;
+    constexpr float lane_spacing = 6.f;
+    constexpr float label_width = 110.f;
+
+    // GPU results of the newest frames are still in flight
+    static int s_selected_frame_age = static_cast<int>(GpuProfiler::frames_in_flight);
+    static std::string s_status;
+
+    static ImU32 get_scope_color(const char* name)
+    {
+        static const ImU32 palette[] = {
+            IM_COL32(86, 156, 214, 255),  IM_COL32(78, 201, 176, 255),  IM_COL32(220, 170, 90, 255),  IM_COL32(197, 134, 192, 255),
+            IM_COL32(106, 153, 85, 255),  IM_COL32(206, 105, 105, 255), IM_COL32(156, 156, 220, 255), IM_COL32(181, 206, 168, 255)
+        };
+        uint32_t hash = 2166136261u;
+        for (const char* c = name; *c; ++c)
+        {
+            hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+        }
+        return palette[hash % (sizeof(palette) / sizeof(palette[0]))];
+    }
+
+    static void draw_timeline(const Profiler::Frame& frame)
+    {
+        // lanes: CPU threads in registration order, then the GPU
+        FrameVector<uint32_t> lanes;
+        for (const Profiler::Event& event : frame.events)
+        {
+            if (std::find(lanes.begin(), lanes.end(), event.thread) == lanes.end())
+            {
+                lanes.push_back(event.thread);
+            }
+        }
+        std::sort(lanes.begin(), lanes.end());
+        FrameVector<uint32_t> lane_depths(lanes.size(), 0);
+        for (const Profiler::Event& event : frame.events)
+        {
+            const size_t lane = std::lower_bound(lanes.begin(), lanes.end(), event.thread) - lanes.begin();
+            lane_depths[lane] = std::max(lane_depths[lane], event.depth + 1);
+        }
+        FrameVector<float> lane_offsets(lanes.size(), 0.f);
+        float height = 0.f;
+        for (size_t lane = 0; lane < lanes.size(); ++lane)
+        {
+            lane_offsets[lane] = height;
+            height += lane_depths[lane] * row_height + lane_spacing;
+        }
+
+        const std::vector<std::string> thread_names = Profiler::get_thread_names();
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float width = std::max(ImGui::GetContentRegionAvail().x, label_width + 1.f);
+        const float timeline_x = origin.x + label_width;
+        const float timeline_width = width - label_width;
+        const double frame_ns = static_cast<double>(std::max<uint64_t>(frame.end_ns - frame.start_ns, 1));
+        ImGui::Dummy(ImVec2(width, std::max(height, row_height)));
+
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        for (size_t lane = 0; lane < lanes.size(); ++lane)
+        {
+            const char* label = lanes[lane] == Profiler::gpu_thread ? "GPU"
+                : lanes[lane] < thread_names.size() ? thread_names[lanes[lane]].c_str() : "?";
+            draw_list->AddText(ImVec2(origin.x, origin.y + lane_offsets[lane]), IM_COL32(200, 200, 200, 255), label);
+        }
+
+        draw_list->PushClipRect(ImVec2(timeline_x, origin.y), ImVec2(timeline_x + timeline_width, origin.y + height), true);
+        const Profiler::Event* hovered_event = nullptr;
+        for (const Profiler::Event& event : frame.events)
+        {
+            const size_t lane = std::lower_bound(lanes.begin(), lanes.end(), event.thread) - lanes.begin();
+            const float x0 = timeline_x + static_cast<float>((static_cast<double>(event.start_ns) - frame.start_ns) / frame_ns * timeline_width);
+            const float x1 = std::max(timeline_x + static_cast<float>((static_cast<double>(event.end_ns) - frame.start_ns) / frame_ns * timeline_width), x0 + 1.f);
+            const float y0 = origin.y + lane_offsets[lane] + event.depth * row_height;
+            const ImVec2 min(x0, y0);
+            const ImVec2 max(x1, y0 + row_height - 1.f);
+            draw_list->AddRectFilled(min, max, get_scope_color(event.name));
+            if (ImGui::CalcTextSize(event.name).x < x1 - x0 - 4.f)
+            {
+                draw_list->AddText(ImVec2(x0 + 2.f, y0 + 1.f), IM_COL32(20, 20, 20, 255), event.name);
+            }
+            if (ImGui::IsMouseHoveringRect(min, max))
+            {
+                hovered_event = &event;
+            }
+        }
+        draw_list->PopClipRect();
+
+        if (hovered_event)
+        {
+            ImGui::SetTooltip("%s\n%.3f ms", hovered_event->name, (hovered_event->end_ns - hovered_event->start_ns) / 1e6);
+        }
+    }
+
+#endif
+
+    void ProfilerWindow::draw(bool* p_open)
+    {
+        if (!ImGui::Begin("Profiler", p_open))
+        {
+            ImGui::End();
+            return;
+        }
+
+#ifdef SIMPLE_ENGINE_PROFILING
+        const std::deque<Profiler::Frame>& frames = Profiler::get_frames();
+        FrameVector<float> frame_times_ms;
+        frame_times_ms.reserve(frames.size());
+        float max_frame_time_ms = 0.f;
+        float total_frame_time_ms = 0.f;
+        for (const Profiler::Frame& frame : frames)
+        {
+            frame_times_ms.push_back((frame.end_ns - frame.start_ns) / 1e6f);
+            max_frame_time_ms = std::max(max_frame_time_ms, frame_times_ms.back());
+            total_frame_time_ms += frame_times_ms.back();
+        }
+
+        bool paused = Profiler::is_paused();
+        if (ImGui::Checkbox("Pause", &paused))
+        {
+            Profiler::set_paused(paused);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button(Profiler::is_capturing() ? "Stop capture" : "Start capture"))
+        {
+            if (Profiler::is_capturing())
+            {
+                Profiler::stop_capture();
+            }
+            else
+            {
+                Profiler::start_capture();
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save trace"))
+        {
+            const char* path = "profile_trace.json";
+            s_status = Profiler::save_chrome_trace(path) ? std::string("Saved ") + path : std::string("Could not write ") + path;
+        }
+        ImGui::Text("Captured events: %zu, dropped events: %llu", Profiler::get_captured_events_count(), static_cast<unsigned long long>(Profiler::get_dropped_events_count()));
+        if (!s_status.empty())
+        {
+            ImGui::TextUnformatted(s_status.c_str());
+        }
+
+        if (frames.empty())
+        {
+            ImGui::TextUnformatted("No frames yet");
+            ImGui::End();
+            return;
+        }
+
+        ImGui::Text("Frame: %.2f ms average, %.2f ms max", total_frame_time_ms / frames.size(), max_frame_time_ms);
+        ImGui::PlotHistogram("##frame_times", frame_times_ms.data(), static_cast<int>(frame_times_ms.size()), 0, nullptr, 0.f, max_frame_time_ms,
+                             ImVec2(ImGui::GetContentRegionAvail().x, 60.f));
+        ImGui::SliderInt("Frames ago", &s_selected_frame_age, 0, static_cast<int>(frames.size()) - 1);
+        s_selected_frame_age = std::clamp(s_selected_frame_age, 0, static_cast<int>(frames.size()) - 1);
+
+        const Profiler::Frame& frame = frames[frames.size() - 1 - s_selected_frame_age];
+        ImGui::Text("Frame %llu: %.3f ms", static_cast<unsigned long long>(frame.index), (frame.end_ns - frame.start_ns) / 1e6);
+        ImGui::Separator();
+        draw_timeline(frame);
+#else
+        ImGui::TextUnformatted("Built without SIMPLE_ENGINE_PROFILING");
+#endif
+
+        ImGui::End();
+    }
+}
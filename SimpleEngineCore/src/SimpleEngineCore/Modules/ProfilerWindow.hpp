@@ -0,0 +1,12 @@
+#pragma once
+
+namespace SimpleEngine {
+
+    // ImGui panel for the Profiler: frame time history and a flame timeline of one frame per thread and the GPU
+    class ProfilerWindow
+    {
+    public:
+        static void draw(bool* p_open);
+    };
+
+}
\ No newline at end of file
@@ -1,14 +1,39 @@
 #include "UIModule.hpp"
+#include "SimpleEngineCore/Memory.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuProfiler.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/GLCapture.hpp"
 
 #include <imgui/imgui.h>
 #include <imgui/backends/imgui_impl_opengl3.h>
 #include <imgui/backends/imgui_impl_glfw.h>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <chrono>
+#include <new>
+
 namespace SimpleEngine {
+
+    static bool s_headless = false;
+    static std::chrono::steady_clock::time_point s_last_frame_time;
+
+    // everything ImGui allocates is accounted to the UI tag, whoever calls into it
+    static void* allocate_ui_memory(const size_t size, void*)
+    {
+        MemoryTagScope tag_scope(EMemoryTag::UI);
+        return ::operator new(size, std::nothrow);
+    }
+
+    static void free_ui_memory(void* p, void*)
+    {
+        ::operator delete(p);
+    }
+
     void UIModule::on_window_create(GLFWwindow* pWindow)
     {
         IMGUI_CHECKVERSION();
+        ImGui::SetAllocatorFunctions(allocate_ui_memory, free_ui_memory);
         ImGui::CreateContext();
 
         ImGuiIO& io = ImGui::GetIO();
@@ -19,23 +44,56 @@ namespace SimpleEngine {
         ImGui_ImplGlfw_InitForOpenGL(pWindow, true);
     }
 
+    void UIModule::on_headless_window_create(const unsigned int width, const unsigned int height)
+    {
+        IMGUI_CHECKVERSION();
+        ImGui::SetAllocatorFunctions(allocate_ui_memory, free_ui_memory);
+        ImGui::CreateContext();
+
+        ImGuiIO& io = ImGui::GetIO();
+        io.ConfigFlags |= ImGuiConfigFlags_::ImGuiConfigFlags_DockingEnable;
+        io.IniFilename = nullptr;
+        io.DisplaySize = ImVec2(static_cast<float>(width), static_cast<float>(height));
+        s_headless = true;
+        s_last_frame_time = std::chrono::steady_clock::now();
+
+        ImGui_ImplOpenGL3_Init();
+    }
+
     void UIModule::on_window_close()
     {
         ImGui_ImplOpenGL3_Shutdown();
-        ImGui_ImplGlfw_Shutdown();
+        if (!s_headless)
+        {
+            ImGui_ImplGlfw_Shutdown();
+        }
         ImGui::DestroyContext();
+        s_headless = false;
     }
 
     void UIModule::on_ui_draw_begin()
     {
         ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
+        if (s_headless)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            ImGui::GetIO().DeltaTime = std::max(std::chrono::duration<float>(now - s_last_frame_time).count(), 1e-6f);
+            s_last_frame_time = now;
+        }
+        else
+        {
+            ImGui_ImplGlfw_NewFrame();
+        }
         ImGui::NewFrame();
     }
 
     void UIModule::on_ui_draw_end()
     {
+        PROFILE_SCOPE("UIModule::on_ui_draw_end");
+        PROFILE_GPU_SCOPE("UI");
         ImGui::Render();
+        // editor UI is not part of GL captures
+        GLCapture::pause();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
         {
@@ -44,5 +102,6 @@ namespace SimpleEngine {
             ImGui::RenderPlatformWindowsDefault();
             glfwMakeContextCurrent(backup_current_context);
         }
+        GLCapture::resume();
     }
 }
\ No newline at end of file
@@ -8,6 +8,8 @@ namespace SimpleEngine {
     {
     public:
         static void on_window_create(GLFWwindow* pWindow);
+        // no platform backend and no extra viewports, the UI is drawn into the offscreen target
+        static void on_headless_window_create(const unsigned int width, const unsigned int height);
         static void on_window_close();
         static void on_ui_draw_begin();
         static void on_ui_draw_end();
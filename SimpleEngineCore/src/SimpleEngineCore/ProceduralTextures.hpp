@@ -0,0 +1,24 @@
+#pragma once
+
+namespace SimpleEngine {
+
+    // RGB8 images, 3 bytes per texel, rows of width texels
+    void generate_circle(unsigned char* data,
+                         const unsigned int width,
+                         const unsigned int height,
+                         const unsigned int center_x,
+                         const unsigned int center_y,
+                         const unsigned int radius,
+                         const unsigned char color_r,
+                         const unsigned char color_g,
+                         const unsigned char color_b);
+
+    void generate_smile_texture(unsigned char* data,
+                                const unsigned int width,
+                                const unsigned int height);
+
+    void generate_quads_texture(unsigned char* data,
+                                const unsigned int width,
+                                const unsigned int height);
+
+}
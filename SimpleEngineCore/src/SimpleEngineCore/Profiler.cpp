@@ -0,0 +1,272 @@
+#include "SimpleEngineCore/Profiler.hpp"
+#include "SimpleEngineCore/Memory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace SimpleEngine {
+
+    // a capture stops growing here, about 128 MB of events
+    constexpr size_t max_captured_events_count = size_t(1) << 22;
+
+    // Single producer, single consumer: the owning thread advances head, the collector advances tail
+    struct ThreadEvents
+    {
+        std::array<Profiler::Event, Profiler::thread_buffer_capacity> events;
+        std::atomic<size_t> head{ 0 };
+        std::atomic<size_t> tail{ 0 };
+        std::atomic<uint64_t> dropped_count{ 0 };
+        uint32_t depth = 0;
+        uint32_t index = 0;
+        std::string name;
+    };
+
+    struct ProfilerState
+    {
+        const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+        // taken by a thread once to register, never on the recording path
+        std::mutex threads_mutex;
+        std::vector<std::unique_ptr<ThreadEvents>> threads;
+
+        uint64_t frame_index = 0;
+        uint64_t frame_start_ns = 0;
+        std::deque<Profiler::Frame> frames;
+        bool paused = false;
+        bool capturing = false;
+        std::vector<Profiler::Event> captured_events;
+    };
+
+    static ProfilerState s_profiler;
+    static thread_local ThreadEvents* t_thread_events = nullptr;
+
+    static ThreadEvents& get_thread_events()
+    {
+        if (!t_thread_events)
+        {
+            std::lock_guard<std::mutex> lock(s_profiler.threads_mutex);
+            s_profiler.threads.push_back(std::make_unique<ThreadEvents>());
+            t_thread_events = s_profiler.threads.back().get();
+            t_thread_events->index = static_cast<uint32_t>(s_profiler.threads.size() - 1);
+            t_thread_events->name = "Thread " + std::to_string(t_thread_events->index);
+        }
+        return *t_thread_events;
+    }
+
+    uint64_t Profiler::now_ns()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_profiler.start_time).count());
+    }
+
+    uint32_t Profiler::begin_scope()
+    {
+        return get_thread_events().depth++;
+    }
+
+    void Profiler::end_scope(const char* name, const uint64_t start_ns, const uint32_t depth)
+    {
+        const uint64_t end_ns = now_ns();
+        ThreadEvents& thread_events = get_thread_events();
+        thread_events.depth = depth;
+
+        const size_t head = thread_events.head.load(std::memory_order_relaxed);
+        if (head - thread_events.tail.load(std::memory_order_acquire) == thread_buffer_capacity)
+        {
+            thread_events.dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Event& event = thread_events.events[head % thread_buffer_capacity];
+        event.name = name;
+        event.start_ns = start_ns;
+        event.end_ns = end_ns;
+        event.depth = depth;
+        event.thread = thread_events.index;
+        thread_events.head.store(head + 1, std::memory_order_release);
+    }
+
+    void Profiler::new_frame()
+    {
+        MemoryTagScope tag_scope(EMemoryTag::Profiler);
+        Frame frame;
+        // the oldest frame is dropped below, its events keep their capacity for this one
+        if (!s_profiler.paused && s_profiler.frames.size() >= history_frames_count)
+        {
+            frame.events = std::move(s_profiler.frames.front().events);
+            frame.events.clear();
+            s_profiler.frames.pop_front();
+        }
+        frame.index = s_profiler.frame_index;
+        frame.start_ns = s_profiler.frame_start_ns;
+        frame.end_ns = now_ns();
+        {
+            std::lock_guard<std::mutex> lock(s_profiler.threads_mutex);
+            for (const std::unique_ptr<ThreadEvents>& thread_events : s_profiler.threads)
+            {
+                const size_t tail = thread_events->tail.load(std::memory_order_relaxed);
+                const size_t head = thread_events->head.load(std::memory_order_acquire);
+                for (size_t i = tail; i < head; ++i)
+                {
+                    frame.events.push_back(thread_events->events[i % thread_buffer_capacity]);
+                }
+                thread_events->tail.store(head, std::memory_order_release);
+            }
+        }
+
+        if (s_profiler.capturing)
+        {
+            const size_t count = std::min(frame.events.size(), max_captured_events_count - s_profiler.captured_events.size());
+            s_profiler.captured_events.insert(s_profiler.captured_events.end(), frame.events.begin(), frame.events.begin() + count);
+        }
+        if (!s_profiler.paused)
+        {
+            s_profiler.frames.push_back(std::move(frame));
+        }
+
+        ++s_profiler.frame_index;
+        s_profiler.frame_start_ns = now_ns();
+    }
+
+    uint64_t Profiler::get_frame_index()
+    {
+        return s_profiler.frame_index;
+    }
+
+    void Profiler::add_gpu_events(const uint64_t frame_index, const std::vector<Event>& events)
+    {
+        if (s_profiler.capturing)
+        {
+            const size_t count = std::min(events.size(), max_captured_events_count - s_profiler.captured_events.size());
+            s_profiler.captured_events.insert(s_profiler.captured_events.end(), events.begin(), events.begin() + count);
+        }
+        // frames are consecutive, so the frame is found by its distance from the newest one
+        if (s_profiler.paused || s_profiler.frames.empty() || frame_index > s_profiler.frames.back().index)
+        {
+            return;
+        }
+        const uint64_t age = s_profiler.frames.back().index - frame_index;
+        if (age < s_profiler.frames.size())
+        {
+            std::vector<Event>& frame_events = s_profiler.frames[s_profiler.frames.size() - 1 - age].events;
+            frame_events.insert(frame_events.end(), events.begin(), events.end());
+        }
+    }
+
+    void Profiler::set_thread_name(const char* name)
+    {
+        ThreadEvents& thread_events = get_thread_events();
+        std::lock_guard<std::mutex> lock(s_profiler.threads_mutex);
+        thread_events.name = name;
+    }
+
+    std::vector<std::string> Profiler::get_thread_names()
+    {
+        std::lock_guard<std::mutex> lock(s_profiler.threads_mutex);
+        std::vector<std::string> names;
+        for (const std::unique_ptr<ThreadEvents>& thread_events : s_profiler.threads)
+        {
+            names.push_back(thread_events->name);
+        }
+        return names;
+    }
+
+    const std::deque<Profiler::Frame>& Profiler::get_frames()
+    {
+        return s_profiler.frames;
+    }
+
+    void Profiler::set_paused(const bool paused)
+    {
+        s_profiler.paused = paused;
+    }
+
+    bool Profiler::is_paused()
+    {
+        return s_profiler.paused;
+    }
+
+    uint64_t Profiler::get_dropped_events_count()
+    {
+        std::lock_guard<std::mutex> lock(s_profiler.threads_mutex);
+        uint64_t dropped_count = 0;
+        for (const std::unique_ptr<ThreadEvents>& thread_events : s_profiler.threads)
+        {
+            dropped_count += thread_events->dropped_count.load(std::memory_order_relaxed);
+        }
+        return dropped_count;
+    }
+
+    void Profiler::start_capture()
+    {
+        s_profiler.captured_events.clear();
+        s_profiler.capturing = true;
+    }
+
+    void Profiler::stop_capture()
+    {
+        s_profiler.capturing = false;
+    }
+
+    bool Profiler::is_capturing()
+    {
+        return s_profiler.capturing;
+    }
+
+    size_t Profiler::get_captured_events_count()
+    {
+        return s_profiler.captured_events.size();
+    }
+
+    static void write_json_string(std::ofstream& file, const char* text)
+    {
+        file << '"';
+        for (const char* c = text; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                file << '\\';
+            }
+            file << *c;
+        }
+        file << '"';
+    }
+
+    bool Profiler::save_chrome_trace(const std::string& path)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        // complete ("X") events in microseconds; CPU threads in process 1, the GPU queue in process 2
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+        file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+        const std::vector<std::string> thread_names = get_thread_names();
+        for (size_t i = 0; i < thread_names.size(); ++i)
+        {
+            file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":";
+            write_json_string(file, thread_names[i].c_str());
+            file << "}}";
+        }
+        file.precision(3);
+        file << std::fixed;
+        for (const Event& event : s_profiler.captured_events)
+        {
+            const bool gpu = event.thread == gpu_thread;
+            file << ",\n{\"name\":";
+            write_json_string(file, event.name);
+            file << ",\"cat\":\"" << (gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":" << (gpu ? 2 : 1)
+                 << ",\"tid\":" << (gpu ? 0 : event.thread)
+                 << ",\"ts\":" << event.start_ns / 1000.0
+                 << ",\"dur\":" << (event.end_ns - event.start_ns) / 1000.0 << "}";
+        }
+        file << "\n]}\n";
+        return file.good();
+    }
+}
@@ -0,0 +1,201 @@
+#include "Framebuffer.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+namespace SimpleEngine {
+
+    static GLuint s_default_framebuffer = 0;
+
+    constexpr GLenum format_to_GLenum(const Framebuffer::EFormat format)
+    {
+        switch (format)
+        {
+            case Framebuffer::EFormat::RGBA8:           return GL_RGBA8;
+            case Framebuffer::EFormat::RGBA16F:         return GL_RGBA16F;
+            case Framebuffer::EFormat::R11F_G11F_B10F:  return GL_R11F_G11F_B10F;
+            case Framebuffer::EFormat::RG16_SNORM:      return GL_RG16_SNORM;
+            case Framebuffer::EFormat::R32F:            return GL_R32F;
+            case Framebuffer::EFormat::Depth24Stencil8: return GL_DEPTH24_STENCIL8;
+            case Framebuffer::EFormat::Depth32F:        return GL_DEPTH_COMPONENT32F;
+        }
+
+        LOG_ERROR("Unknown Framebuffer format");
+        return GL_RGBA8;
+    }
+
+
+    Framebuffer::Framebuffer(const unsigned int width, const unsigned int height, std::initializer_list<EFormat> color_formats, const EFormat depth_format)
+        : m_width(width)
+        , m_height(height)
+        , m_color_formats(color_formats)
+        , m_depth_format(depth_format)
+    {
+        glCreateFramebuffers(1, &m_id);
+        create_attachments();
+    }
+
+
+    Framebuffer::~Framebuffer()
+    {
+        if (m_id != 0 && m_id == s_default_framebuffer)
+        {
+            s_default_framebuffer = 0;
+        }
+        delete_attachments();
+        glDeleteFramebuffers(1, &m_id);
+    }
+
+
+    Framebuffer& Framebuffer::operator=(Framebuffer&& framebuffer) noexcept
+    {
+        if (this != &framebuffer)
+        {
+            if (m_id != 0 && m_id == s_default_framebuffer)
+            {
+                s_default_framebuffer = 0;
+            }
+            delete_attachments();
+            glDeleteFramebuffers(1, &m_id);
+            m_id = framebuffer.m_id;
+            m_width = framebuffer.m_width;
+            m_height = framebuffer.m_height;
+            m_color_formats = std::move(framebuffer.m_color_formats);
+            m_depth_format = framebuffer.m_depth_format;
+            m_color_attachments = std::move(framebuffer.m_color_attachments);
+            m_depth_attachment = framebuffer.m_depth_attachment;
+            m_is_complete = framebuffer.m_is_complete;
+            m_gpu_memory_id = framebuffer.m_gpu_memory_id;
+            framebuffer.m_id = 0;
+            framebuffer.m_color_attachments.clear();
+            framebuffer.m_depth_attachment = 0;
+            framebuffer.m_gpu_memory_id = GpuMemory::invalid_resource;
+        }
+        return *this;
+    }
+
+
+    Framebuffer::Framebuffer(Framebuffer&& framebuffer) noexcept
+        : m_id(framebuffer.m_id)
+        , m_width(framebuffer.m_width)
+        , m_height(framebuffer.m_height)
+        , m_color_formats(std::move(framebuffer.m_color_formats))
+        , m_depth_format(framebuffer.m_depth_format)
+        , m_color_attachments(std::move(framebuffer.m_color_attachments))
+        , m_depth_attachment(framebuffer.m_depth_attachment)
+        , m_is_complete(framebuffer.m_is_complete)
+        , m_gpu_memory_id(framebuffer.m_gpu_memory_id)
+    {
+        framebuffer.m_id = 0;
+        framebuffer.m_color_attachments.clear();
+        framebuffer.m_depth_attachment = 0;
+        framebuffer.m_gpu_memory_id = GpuMemory::invalid_resource;
+    }
+
+
+    void Framebuffer::create_attachments()
+    {
+        std::vector<GLenum> draw_buffers;
+        uint64_t attachments_bytes = 0;
+        m_color_attachments.resize(m_color_formats.size());
+        glCreateTextures(GL_TEXTURE_2D, static_cast<GLsizei>(m_color_attachments.size()), m_color_attachments.data());
+        for (size_t i = 0; i < m_color_attachments.size(); ++i)
+        {
+            const GLuint texture = m_color_attachments[i];
+            glTextureStorage2D(texture, 1, format_to_GLenum(m_color_formats[i]), m_width, m_height);
+            glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glNamedFramebufferTexture(m_id, GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i), texture, 0);
+            draw_buffers.push_back(GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i));
+            attachments_bytes += GpuMemory::get_texture_bytes(format_to_GLenum(m_color_formats[i]), m_width, m_height, 1, 1);
+        }
+        glNamedFramebufferDrawBuffers(m_id, static_cast<GLsizei>(draw_buffers.size()), draw_buffers.data());
+
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_depth_attachment);
+        glTextureStorage2D(m_depth_attachment, 1, format_to_GLenum(m_depth_format), m_width, m_height);
+        glTextureParameteri(m_depth_attachment, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(m_depth_attachment, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(m_depth_attachment, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_depth_attachment, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        const GLenum depth_attachment_point = m_depth_format == EFormat::Depth24Stencil8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+        glNamedFramebufferTexture(m_id, depth_attachment_point, m_depth_attachment, 0);
+        attachments_bytes += GpuMemory::get_texture_bytes(format_to_GLenum(m_depth_format), m_width, m_height, 1, 1);
+        m_gpu_memory_id = GpuMemory::register_resource(EGpuMemoryCategory::RenderTargets, attachments_bytes, "Framebuffer");
+
+        m_is_complete = glCheckNamedFramebufferStatus(m_id, GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        if (!m_is_complete)
+        {
+            LOG_CRITICAL("Framebuffer {0}x{1} is incomplete", m_width, m_height);
+        }
+    }
+
+
+    void Framebuffer::delete_attachments()
+    {
+        glDeleteTextures(static_cast<GLsizei>(m_color_attachments.size()), m_color_attachments.data());
+        glDeleteTextures(1, &m_depth_attachment);
+        GpuMemory::unregister_resource(m_gpu_memory_id);
+        m_color_attachments.clear();
+        m_depth_attachment = 0;
+        m_gpu_memory_id = GpuMemory::invalid_resource;
+    }
+
+
+    void Framebuffer::resize(const unsigned int width, const unsigned int height)
+    {
+        if (width == m_width && height == m_height)
+        {
+            return;
+        }
+        m_width = width;
+        m_height = height;
+        delete_attachments();
+        create_attachments();
+    }
+
+
+    void Framebuffer::bind() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+    }
+
+
+    void Framebuffer::unbind()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, s_default_framebuffer);
+    }
+
+
+    void Framebuffer::set_as_default() const
+    {
+        s_default_framebuffer = m_id;
+        bind();
+    }
+
+
+    unsigned int Framebuffer::get_default_handle()
+    {
+        return s_default_framebuffer;
+    }
+
+
+    void Framebuffer::bind_color_attachment(const size_t index, const unsigned int unit) const
+    {
+        glBindTextureUnit(unit, m_color_attachments[index]);
+    }
+
+
+    void Framebuffer::bind_depth_attachment(const unsigned int unit) const
+    {
+        glBindTextureUnit(unit, m_depth_attachment);
+    }
+
+
+    void Framebuffer::blit_depth_to_default() const
+    {
+        glBlitNamedFramebuffer(m_id, s_default_framebuffer, 0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "SimpleEngineCore/GpuMemory.hpp"
+
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+namespace SimpleEngine {
+
+    class Framebuffer {
+    public:
+
+        enum class EFormat
+        {
+            RGBA8,
+            RGBA16F,
+            R11F_G11F_B10F,
+            RG16_SNORM,
+            R32F,
+            Depth24Stencil8,
+            Depth32F
+        };
+
+        Framebuffer(const unsigned int width, const unsigned int height, std::initializer_list<EFormat> color_formats, const EFormat depth_format = EFormat::Depth24Stencil8);
+        ~Framebuffer();
+
+        Framebuffer(const Framebuffer&) = delete;
+        Framebuffer& operator=(const Framebuffer&) = delete;
+        Framebuffer& operator=(Framebuffer&& framebuffer) noexcept;
+        Framebuffer(Framebuffer&& framebuffer) noexcept;
+
+        void bind() const;
+        // binds the default framebuffer: the window's one, or the offscreen target in headless mode
+        static void unbind();
+
+        // makes unbind() and blit_depth_to_default() target this framebuffer instead of the window
+        void set_as_default() const;
+        static unsigned int get_default_handle();
+
+        // recreates the attachments, contents are lost
+        void resize(const unsigned int width, const unsigned int height);
+
+        void bind_color_attachment(const size_t index, const unsigned int unit) const;
+        void bind_depth_attachment(const unsigned int unit) const;
+
+        // the default framebuffer needs a matching depth format (usually Depth24Stencil8)
+        void blit_depth_to_default() const;
+
+        unsigned int get_color_attachment_handle(const size_t index) const { return m_color_attachments[index]; }
+        unsigned int get_depth_attachment_handle() const { return m_depth_attachment; }
+        unsigned int get_width() const { return m_width; }
+        unsigned int get_height() const { return m_height; }
+        bool is_complete() const { return m_is_complete; }
+
+    private:
+        void create_attachments();
+        void delete_attachments();
+
+        unsigned int m_id = 0;
+        unsigned int m_width = 0;
+        unsigned int m_height = 0;
+        std::vector<EFormat> m_color_formats;
+        EFormat m_depth_format;
+        std::vector<unsigned int> m_color_attachments;
+        unsigned int m_depth_attachment = 0;
+        bool m_is_complete = false;
+        GpuMemory::ResourceId m_gpu_memory_id = GpuMemory::invalid_resource;
+    };
+
+}
@@ -0,0 +1,162 @@
+#include "FramebufferReadback.hpp"
+
+#include <glad/glad.h>
+
+namespace SimpleEngine {
+
+    FramebufferReadback::FramebufferReadback(const size_t slots_count)
+        : m_slots(std::make_unique<Slot[]>(slots_count))
+        , m_slots_count(slots_count)
+    {
+        m_encoder = std::thread([this]() { encode(); });
+    }
+
+
+    FramebufferReadback::~FramebufferReadback()
+    {
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_slot_ready.notify_one();
+        m_encoder.join();
+        for (size_t i = 0; i < m_slots_count; ++i)
+        {
+            if (m_slots[i].buffer != 0)
+            {
+                glUnmapNamedBuffer(m_slots[i].buffer);
+                glDeleteBuffers(1, &m_slots[i].buffer);
+                GpuMemory::unregister_resource(m_slots[i].gpu_memory_id);
+            }
+        }
+    }
+
+
+    bool FramebufferReadback::request(const unsigned int framebuffer, const unsigned int width, const unsigned int height, const uint64_t frame_index, Sink sink)
+    {
+        // the slots are used in request order, so images reach the workers in frame order
+        Slot& slot = m_slots[m_next_slot];
+        if (slot.state.load(std::memory_order_acquire) != ESlotState::Free)
+        {
+            ++m_dropped_count;
+            return false;
+        }
+
+        const size_t size = static_cast<size_t>(width) * height * 4;
+        if (slot.capacity < size)
+        {
+            if (slot.buffer != 0)
+            {
+                glUnmapNamedBuffer(slot.buffer);
+                glDeleteBuffers(1, &slot.buffer);
+            }
+            // coherent: once the fence signals, the copy is visible through the mapping without a barrier
+            constexpr GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glCreateBuffers(1, &slot.buffer);
+            glNamedBufferStorage(slot.buffer, size, nullptr, flags);
+            slot.pMapped = static_cast<unsigned char*>(glMapNamedBufferRange(slot.buffer, 0, size, flags));
+            slot.capacity = size;
+            if (slot.gpu_memory_id == GpuMemory::invalid_resource)
+            {
+                slot.gpu_memory_id = GpuMemory::register_resource(EGpuMemoryCategory::Readback, size, "Readback buffer");
+            }
+            else
+            {
+                GpuMemory::resize_resource(slot.gpu_memory_id, size);
+            }
+        }
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        slot.image.width = width;
+        slot.image.height = height;
+        slot.image.frame_index = frame_index;
+        slot.image.pixels = slot.pMapped;
+        slot.sink = std::move(sink);
+        slot.state.store(ESlotState::Copying, std::memory_order_release);
+        m_next_slot = (m_next_slot + 1) % m_slots_count;
+        return true;
+    }
+
+
+    void FramebufferReadback::submit(Slot& slot)
+    {
+        glDeleteSync(static_cast<GLsync>(slot.fence));
+        slot.fence = nullptr;
+        slot.state.store(ESlotState::Encoding, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_encode_queue.push_back(&slot);
+        }
+        m_slot_ready.notify_one();
+    }
+
+
+    void FramebufferReadback::encode()
+    {
+        while (true)
+        {
+            Slot* pSlot = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_slot_ready.wait(lock, [this] { return m_stop || !m_encode_queue.empty(); });
+                if (m_encode_queue.empty())
+                {
+                    return;
+                }
+                pSlot = m_encode_queue.front();
+                m_encode_queue.pop_front();
+            }
+            pSlot->sink(pSlot->image);
+            pSlot->sink = nullptr;
+            pSlot->state.store(ESlotState::Free, std::memory_order_release);
+        }
+    }
+
+
+    void FramebufferReadback::poll()
+    {
+        // oldest first, a copy can't finish before an earlier one
+        for (size_t i = 0; i < m_slots_count; ++i)
+        {
+            Slot& slot = m_slots[(m_next_slot + i) % m_slots_count];
+            if (slot.state.load(std::memory_order_acquire) != ESlotState::Copying)
+            {
+                continue;
+            }
+            const GLenum result = glClientWaitSync(static_cast<GLsync>(slot.fence), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+            {
+                return;
+            }
+            submit(slot);
+        }
+    }
+
+
+    void FramebufferReadback::flush()
+    {
+        for (size_t i = 0; i < m_slots_count; ++i)
+        {
+            Slot& slot = m_slots[(m_next_slot + i) % m_slots_count];
+            if (slot.state.load(std::memory_order_acquire) == ESlotState::Copying)
+            {
+                glClientWaitSync(static_cast<GLsync>(slot.fence), GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+                submit(slot);
+            }
+        }
+        for (size_t i = 0; i < m_slots_count; ++i)
+        {
+            while (m_slots[i].state.load(std::memory_order_acquire) != ESlotState::Free)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+}
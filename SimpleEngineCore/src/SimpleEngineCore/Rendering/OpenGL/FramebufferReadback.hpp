@@ -0,0 +1,88 @@
+#pragma once
+
+#include "SimpleEngineCore/GpuMemory.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace SimpleEngine {
+
+    // Asynchronous color readback: each request copies a framebuffer into one of a ring of persistently mapped
+    // pixel pack buffers and fences the copy. poll() hands copies the GPU has finished to an encoder thread,
+    // so the main thread never waits for the GPU and never touches the pixels. The encoder is a thread of its own
+    // rather than a JobSystem job: a PNG takes milliseconds and would hold up the frame's parallel_for chunks.
+    class FramebufferReadback {
+    public:
+        struct Image
+        {
+            unsigned int width = 0;
+            unsigned int height = 0;
+            uint64_t frame_index = 0;
+            // RGBA8, bottom row first as GL returns it, only valid during the sink call
+            const unsigned char* pixels = nullptr;
+        };
+
+        // runs on the encoder thread
+        using Sink = std::function<void(const Image& image)>;
+
+        // slots_count copies can be in flight, about the GPU latency in frames plus the time the sinks take
+        explicit FramebufferReadback(const size_t slots_count = 4);
+        ~FramebufferReadback();
+
+        FramebufferReadback(const FramebufferReadback&) = delete;
+        FramebufferReadback& operator=(const FramebufferReadback&) = delete;
+
+        // copies the read buffer of framebuffer (0 for the window), false when every slot is still busy
+        bool request(const unsigned int framebuffer, const unsigned int width, const unsigned int height, const uint64_t frame_index, Sink sink);
+        // once per frame, never blocks
+        void poll();
+        // blocks until every requested image went through its sink
+        void flush();
+
+        size_t get_dropped_count() const { return m_dropped_count; }
+
+    private:
+        enum class ESlotState
+        {
+            Free,
+            // waiting for the GPU copy, owned by the main thread
+            Copying,
+            // queued for or in the sink, owned by the encoder thread
+            Encoding
+        };
+
+        struct Slot
+        {
+            unsigned int buffer = 0;
+            size_t capacity = 0;
+            GpuMemory::ResourceId gpu_memory_id = GpuMemory::invalid_resource;
+            unsigned char* pMapped = nullptr;
+            void* fence = nullptr;
+            Image image;
+            Sink sink;
+            std::atomic<ESlotState> state{ ESlotState::Free };
+        };
+
+        void submit(Slot& slot);
+        void encode();
+
+        std::unique_ptr<Slot[]> m_slots;
+        size_t m_slots_count = 0;
+        size_t m_next_slot = 0;
+        size_t m_dropped_count = 0;
+
+        std::thread m_encoder;
+        std::mutex m_mutex;
+        std::condition_variable m_slot_ready;
+        std::deque<Slot*> m_encode_queue;
+        bool m_stop = false;
+    };
+
+}
@@ -0,0 +1,1850 @@
+#include "GLCapture.hpp"
+#include "GLCaptureFormat.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+    using ECommand = GLCaptureFormat::ECommand;
+
+    static constexpr size_t max_vertex_attributes = 16;
+    static constexpr size_t max_texture_units = 32;
+
+    struct TrackedTexture
+    {
+        GLenum target = GL_TEXTURE_2D;
+        GLsizei levels = 0;
+        GLenum internal_format = 0;
+        GLsizei width = 0;
+        GLsizei height = 0;
+        GLsizei depth = 1;
+        std::vector<std::pair<GLenum, GLint>> parameters;
+    };
+
+    struct TrackedBuffer
+    {
+        GLsizeiptr size = 0;
+        GLenum usage = GL_STATIC_DRAW;
+    };
+
+    struct TrackedShader
+    {
+        GLenum type = 0;
+        std::string source;
+    };
+
+    struct TrackedProgram
+    {
+        std::vector<GLuint> attached_shaders;
+        // shaders are usually deleted right after linking, the sources are kept to recreate the program
+        std::vector<TrackedShader> linked_shaders;
+    };
+
+    struct TrackedVertexArray
+    {
+        struct Attribute
+        {
+            bool enabled = false;
+            bool has_format = false;
+            GLint size = 4;
+            GLenum type = GL_FLOAT;
+            GLboolean normalized = GL_FALSE;
+            GLuint relative_offset = 0;
+            GLuint binding = 0;
+        };
+
+        struct Binding
+        {
+            GLuint buffer = 0;
+            GLintptr offset = 0;
+            GLsizei stride = 16;
+        };
+
+        TrackedVertexArray()
+        {
+            for (size_t i = 0; i < attributes.size(); ++i)
+            {
+                attributes[i].binding = static_cast<GLuint>(i);
+            }
+        }
+
+        std::array<Attribute, max_vertex_attributes> attributes;
+        std::array<Binding, max_vertex_attributes> bindings;
+        GLuint element_buffer = 0;
+    };
+
+    struct TrackedFramebuffer
+    {
+        std::map<GLenum, std::pair<GLuint, GLint>> attachments;
+        std::vector<GLenum> draw_buffers;
+        GLenum read_buffer = 0;
+    };
+
+    struct CaptureState
+    {
+        bool installed = false;
+        bool pending_start = false;
+        bool recording = false;
+        int paused_depth = 0;
+
+        std::string path;
+        uint32_t frames_count = 0;
+        uint32_t captured_frames_count = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::chrono::steady_clock::time_point start_time;
+        std::vector<uint8_t> stream;
+
+        std::unordered_map<GLuint, TrackedBuffer> buffers;
+        std::unordered_map<GLuint, TrackedTexture> textures;
+        std::unordered_map<GLuint, TrackedShader> shaders;
+        std::unordered_map<GLuint, TrackedProgram> programs;
+        std::unordered_map<GLuint, TrackedVertexArray> vertex_arrays;
+        std::unordered_map<GLuint, TrackedFramebuffer> framebuffers;
+        std::unordered_map<GLuint, GLenum> queries;
+
+        GLuint bound_vertex_array = 0;
+        std::map<GLenum, GLuint> bound_buffers;
+        std::map<std::pair<GLenum, GLuint>, GLuint> indexed_buffers;
+        std::array<GLuint, max_texture_units> texture_units{};
+    };
+
+    static CaptureState s_capture;
+
+
+    static bool is_recording()
+    {
+        return s_capture.recording && s_capture.paused_depth == 0;
+    }
+
+    template<typename T>
+    static void write(const T value)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        s_capture.stream.insert(s_capture.stream.end(), bytes, bytes + sizeof(T));
+    }
+
+    static void write_command(const ECommand command)
+    {
+        write<uint16_t>(static_cast<uint16_t>(command));
+    }
+
+    static void write_blob(const void* data, const uint64_t size)
+    {
+        write<uint64_t>(data ? size : 0);
+        if (data && size > 0)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            s_capture.stream.insert(s_capture.stream.end(), bytes, bytes + size);
+        }
+    }
+
+    static void write_names(const GLsizei n, const GLuint* names)
+    {
+        write<uint32_t>(static_cast<uint32_t>(n));
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            write<uint32_t>(names[i]);
+        }
+    }
+
+    static void write_floats(const GLfloat* values, const size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            write<float>(values[i]);
+        }
+    }
+
+    static GLuint* get_bound_buffer(const GLenum target)
+    {
+        if (target == GL_ELEMENT_ARRAY_BUFFER && s_capture.bound_vertex_array != 0)
+        {
+            return &s_capture.vertex_arrays[s_capture.bound_vertex_array].element_buffer;
+        }
+        return &s_capture.bound_buffers[target];
+    }
+
+
+    // size of client memory read by glTextureSubImage*, with the default unpack alignment of 4
+    static uint64_t get_image_size(const GLsizei width, const GLsizei height, const GLsizei depth, const GLenum format, const GLenum type)
+    {
+        uint64_t components = 4;
+        switch (format)
+        {
+            case GL_RED:
+            case GL_DEPTH_COMPONENT:
+            case GL_DEPTH_STENCIL:  components = 1; break;
+            case GL_RG:             components = 2; break;
+            case GL_RGB:
+            case GL_BGR:            components = 3; break;
+        }
+        uint64_t pixel_size = components;
+        switch (type)
+        {
+            case GL_UNSIGNED_BYTE:
+            case GL_BYTE:                          pixel_size = components; break;
+            case GL_HALF_FLOAT:
+            case GL_SHORT:
+            case GL_UNSIGNED_SHORT:                pixel_size = 2 * components; break;
+            case GL_FLOAT:
+            case GL_INT:
+            case GL_UNSIGNED_INT:                  pixel_size = 4 * components; break;
+            case GL_UNSIGNED_INT_24_8:
+            case GL_UNSIGNED_INT_10F_11F_11F_REV:  pixel_size = 4; break;
+        }
+        if (width <= 0 || height <= 0 || depth <= 0)
+        {
+            return 0;
+        }
+        const uint64_t row_size = (width * pixel_size + 3) / 4 * 4;
+        return row_size * (static_cast<uint64_t>(height) * depth - 1) + width * pixel_size;
+    }
+
+
+    // the format every level of a texture is read back and replayed with, false if it is not supported
+    static bool get_readback_format(const GLenum internal_format, GLenum& format, GLenum& type, uint64_t& pixel_size)
+    {
+        switch (internal_format)
+        {
+            case GL_RGB8:
+            case GL_RGBA8:                format = GL_RGBA;            type = GL_UNSIGNED_BYTE;                pixel_size = 4; return true;
+            case GL_RGB16F:
+            case GL_RGBA16F:              format = GL_RGBA;            type = GL_HALF_FLOAT;                   pixel_size = 8; return true;
+            case GL_R11F_G11F_B10F:       format = GL_RGB;             type = GL_UNSIGNED_INT_10F_11F_11F_REV; pixel_size = 4; return true;
+            case GL_RG16_SNORM:           format = GL_RG;              type = GL_SHORT;                        pixel_size = 4; return true;
+            case GL_R32F:                 format = GL_RED;             type = GL_FLOAT;                        pixel_size = 4; return true;
+            case GL_DEPTH24_STENCIL8:     format = GL_DEPTH_STENCIL;   type = GL_UNSIGNED_INT_24_8;            pixel_size = 4; return true;
+            case GL_DEPTH_COMPONENT32F:   format = GL_DEPTH_COMPONENT; type = GL_FLOAT;                        pixel_size = 4; return true;
+        }
+        return false;
+    }
+
+
+    // ---- hooks: record when capturing, track objects always, then call the driver ----
+
+    static PFNGLGENBUFFERSPROC real_glGenBuffers = nullptr;
+    static PFNGLCREATEBUFFERSPROC real_glCreateBuffers = nullptr;
+    static PFNGLDELETEBUFFERSPROC real_glDeleteBuffers = nullptr;
+    static PFNGLBINDBUFFERPROC real_glBindBuffer = nullptr;
+    static PFNGLBUFFERDATAPROC real_glBufferData = nullptr;
+    static PFNGLNAMEDBUFFERDATAPROC real_glNamedBufferData = nullptr;
+    static PFNGLNAMEDBUFFERSUBDATAPROC real_glNamedBufferSubData = nullptr;
+    static PFNGLBINDBUFFERBASEPROC real_glBindBufferBase = nullptr;
+
+    static PFNGLCREATETEXTURESPROC real_glCreateTextures = nullptr;
+    static PFNGLDELETETEXTURESPROC real_glDeleteTextures = nullptr;
+    static PFNGLTEXTURESTORAGE2DPROC real_glTextureStorage2D = nullptr;
+    static PFNGLTEXTURESTORAGE3DPROC real_glTextureStorage3D = nullptr;
+    static PFNGLTEXTURESUBIMAGE2DPROC real_glTextureSubImage2D = nullptr;
+    static PFNGLTEXTURESUBIMAGE3DPROC real_glTextureSubImage3D = nullptr;
+    static PFNGLTEXTUREPARAMETERIPROC real_glTextureParameteri = nullptr;
+    static PFNGLGENERATETEXTUREMIPMAPPROC real_glGenerateTextureMipmap = nullptr;
+    static PFNGLBINDTEXTUREUNITPROC real_glBindTextureUnit = nullptr;
+    static PFNGLCOPYIMAGESUBDATAPROC real_glCopyImageSubData = nullptr;
+
+    static PFNGLGENVERTEXARRAYSPROC real_glGenVertexArrays = nullptr;
+    static PFNGLDELETEVERTEXARRAYSPROC real_glDeleteVertexArrays = nullptr;
+    static PFNGLBINDVERTEXARRAYPROC real_glBindVertexArray = nullptr;
+    static PFNGLENABLEVERTEXATTRIBARRAYPROC real_glEnableVertexAttribArray = nullptr;
+    static PFNGLBINDVERTEXBUFFERPROC real_glBindVertexBuffer = nullptr;
+    static PFNGLVERTEXATTRIBFORMATPROC real_glVertexAttribFormat = nullptr;
+    static PFNGLVERTEXATTRIBBINDINGPROC real_glVertexAttribBinding = nullptr;
+
+    static PFNGLCREATESHADERPROC real_glCreateShader = nullptr;
+    static PFNGLSHADERSOURCEPROC real_glShaderSource = nullptr;
+    static PFNGLCOMPILESHADERPROC real_glCompileShader = nullptr;
+    static PFNGLDELETESHADERPROC real_glDeleteShader = nullptr;
+    static PFNGLCREATEPROGRAMPROC real_glCreateProgram = nullptr;
+    static PFNGLATTACHSHADERPROC real_glAttachShader = nullptr;
+    static PFNGLDETACHSHADERPROC real_glDetachShader = nullptr;
+    static PFNGLLINKPROGRAMPROC real_glLinkProgram = nullptr;
+    static PFNGLDELETEPROGRAMPROC real_glDeleteProgram = nullptr;
+    static PFNGLUSEPROGRAMPROC real_glUseProgram = nullptr;
+    static PFNGLGETUNIFORMLOCATIONPROC real_glGetUniformLocation = nullptr;
+    static PFNGLUNIFORM1IPROC real_glUniform1i = nullptr;
+    static PFNGLUNIFORM1FPROC real_glUniform1f = nullptr;
+    static PFNGLUNIFORM2FPROC real_glUniform2f = nullptr;
+    static PFNGLUNIFORM3FPROC real_glUniform3f = nullptr;
+    static PFNGLUNIFORM4FPROC real_glUniform4f = nullptr;
+    static PFNGLUNIFORMMATRIX3FVPROC real_glUniformMatrix3fv = nullptr;
+    static PFNGLUNIFORMMATRIX4FVPROC real_glUniformMatrix4fv = nullptr;
+
+    static PFNGLCREATEFRAMEBUFFERSPROC real_glCreateFramebuffers = nullptr;
+    static PFNGLDELETEFRAMEBUFFERSPROC real_glDeleteFramebuffers = nullptr;
+    static PFNGLBINDFRAMEBUFFERPROC real_glBindFramebuffer = nullptr;
+    static PFNGLNAMEDFRAMEBUFFERTEXTUREPROC real_glNamedFramebufferTexture = nullptr;
+    static PFNGLNAMEDFRAMEBUFFERDRAWBUFFERPROC real_glNamedFramebufferDrawBuffer = nullptr;
+    static PFNGLNAMEDFRAMEBUFFERDRAWBUFFERSPROC real_glNamedFramebufferDrawBuffers = nullptr;
+    static PFNGLNAMEDFRAMEBUFFERREADBUFFERPROC real_glNamedFramebufferReadBuffer = nullptr;
+    static PFNGLBLITNAMEDFRAMEBUFFERPROC real_glBlitNamedFramebuffer = nullptr;
+
+    static PFNGLCREATEQUERIESPROC real_glCreateQueries = nullptr;
+    static PFNGLDELETEQUERIESPROC real_glDeleteQueries = nullptr;
+    static PFNGLQUERYCOUNTERPROC real_glQueryCounter = nullptr;
+    static PFNGLGETQUERYOBJECTIVPROC real_glGetQueryObjectiv = nullptr;
+    static PFNGLGETQUERYOBJECTUI64VPROC real_glGetQueryObjectui64v = nullptr;
+
+    static PFNGLENABLEPROC real_glEnable = nullptr;
+    static PFNGLDISABLEPROC real_glDisable = nullptr;
+    static PFNGLVIEWPORTPROC real_glViewport = nullptr;
+    static PFNGLSCISSORPROC real_glScissor = nullptr;
+    static PFNGLCLEARCOLORPROC real_glClearColor = nullptr;
+    static PFNGLCLEARPROC real_glClear = nullptr;
+    static PFNGLPOLYGONOFFSETPROC real_glPolygonOffset = nullptr;
+    static PFNGLFINISHPROC real_glFinish = nullptr;
+    static PFNGLDRAWELEMENTSPROC real_glDrawElements = nullptr;
+    static PFNGLDRAWARRAYSPROC real_glDrawArrays = nullptr;
+
+
+    static void APIENTRY hook_glGenBuffers(GLsizei n, GLuint* buffers)
+    {
+        real_glGenBuffers(n, buffers);
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            s_capture.buffers[buffers[i]] = TrackedBuffer();
+        }
+        if (is_recording())
+        {
+            write_command(ECommand::GenBuffers);
+            write_names(n, buffers);
+        }
+    }
+
+    static void APIENTRY hook_glCreateBuffers(GLsizei n, GLuint* buffers)
+    {
+        real_glCreateBuffers(n, buffers);
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            s_capture.buffers[buffers[i]] = TrackedBuffer();
+        }
+        if (is_recording())
+        {
+            write_command(ECommand::CreateBuffers);
+            write_names(n, buffers);
+        }
+    }
+
+    static void APIENTRY hook_glDeleteBuffers(GLsizei n, const GLuint* buffers)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::DeleteBuffers);
+            write_names(n, buffers);
+        }
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            s_capture.buffers.erase(buffers[i]);
+            for (auto& [target, buffer] : s_capture.bound_buffers)
+            {
+                buffer = buffer == buffers[i] ? 0 : buffer;
+            }
+            for (auto& [binding, buffer] : s_capture.indexed_buffers)
+            {
+                buffer = buffer == buffers[i] ? 0 : buffer;
+            }
+            for (auto& [id, vertex_array] : s_capture.vertex_arrays)
+            {
+                vertex_array.element_buffer = vertex_array.element_buffer == buffers[i] ? 0 : vertex_array.element_buffer;
+            }
+        }
+        real_glDeleteBuffers(n, buffers);
+    }
+
+    static void APIENTRY hook_glBindBuffer(GLenum target, GLuint buffer)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::BindBuffer);
+            write<uint32_t>(target);
+            write<uint32_t>(buffer);
+        }
+        *get_bound_buffer(target) = buffer;
+        real_glBindBuffer(target, buffer);
+    }
+
+    static void APIENTRY hook_glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::BufferData);
+            write<uint32_t>(target);
+            write<uint64_t>(size);
+            write_blob(data, size);
+            write<uint32_t>(usage);
+        }
+        s_capture.buffers[*get_bound_buffer(target)] = { size, usage };
+        real_glBufferData(target, size, data, usage);
+    }
+
+    static void APIENTRY hook_glNamedBufferData(GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::NamedBufferData);
+            write<uint32_t>(buffer);
+            write<uint64_t>(size);
+            write_blob(data, size);
+            write<uint32_t>(usage);
+        }
+        s_capture.buffers[buffer] = { size, usage };
+        real_glNamedBufferData(buffer, size, data, usage);
+    }
+
+    static void APIENTRY hook_glNamedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::NamedBufferSubData);
+            write<uint32_t>(buffer);
+            write<uint64_t>(offset);
+            write_blob(data, size);
+        }
+        real_glNamedBufferSubData(buffer, offset, size, data);
+    }
+
+    static void APIENTRY hook_glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::BindBufferBase);
+            write<uint32_t>(target);
+            write<uint32_t>(index);
+            write<uint32_t>(buffer);
+        }
+        s_capture.indexed_buffers[{ target, index }] = buffer;
+        s_capture.bound_buffers[target] = buffer;
+        real_glBindBufferBase(target, index, buffer);
+    }
+
+
+    static void APIENTRY hook_glCreateTextures(GLenum target, GLsizei n, GLuint* textures)
+    {
+        real_glCreateTextures(target, n, textures);
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            TrackedTexture texture;
+            texture.target = target;
+            s_capture.textures[textures[i]] = texture;
+        }
+        if (is_recording())
+        {
+            write_command(ECommand::CreateTextures);
+            write<uint32_t>(target);
+            write_names(n, textures);
+        }
+    }
+
+    static void APIENTRY hook_glDeleteTextures(GLsizei n, const GLuint* textures)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::DeleteTextures);
+            write_names(n, textures);
+        }
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            s_capture.textures.erase(textures[i]);
+            std::replace(s_capture.texture_units.begin(), s_capture.texture_units.end(), textures[i], 0u);
+        }
+        real_glDeleteTextures(n, textures);
+    }
+
+    static void APIENTRY hook_glTextureStorage2D(GLuint texture, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::TextureStorage2D);
+            write<uint32_t>(texture);
+            write<int32_t>(levels);
+            write<uint32_t>(internalformat);
+            write<int32_t>(width);
+            write<int32_t>(height);
+        }
+        TrackedTexture& tracked = s_capture.textures[texture];
+        tracked.levels = levels;
+        tracked.internal_format = internalformat;
+        tracked.width = width;
+        tracked.height = height;
+        tracked.depth = 1;
+        real_glTextureStorage2D(texture, levels, internalformat, width, height);
+    }
+
+    static void APIENTRY hook_glTextureStorage3D(GLuint texture, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::TextureStorage3D);
+            write<uint32_t>(texture);
+            write<int32_t>(levels);
+            write<uint32_t>(internalformat);
+            write<int32_t>(width);
+            write<int32_t>(height);
+            write<int32_t>(depth);
+        }
+        TrackedTexture& tracked = s_capture.textures[texture];
+        tracked.levels = levels;
+        tracked.internal_format = internalformat;
+        tracked.width = width;
+        tracked.height = height;
+        tracked.depth = depth;
+        real_glTextureStorage3D(texture, levels, internalformat, width, height, depth);
+    }
+
+    static void APIENTRY hook_glTextureSubImage2D(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::TextureSubImage2D);
+            write<uint32_t>(texture);
+            write<int32_t>(level);
+            write<int32_t>(xoffset);
+            write<int32_t>(yoffset);
+            write<int32_t>(width);
+            write<int32_t>(height);
+            write<uint32_t>(format);
+            write<uint32_t>(type);
+            write_blob(pixels, get_image_size(width, height, 1, format, type));
+        }
+        real_glTextureSubImage2D(texture, level, xoffset, yoffset, width, height, format, type, pixels);
+    }
+
+    static void APIENTRY hook_glTextureSubImage3D(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::TextureSubImage3D);
+            write<uint32_t>(texture);
+            write<int32_t>(level);
+            write<int32_t>(xoffset);
+            write<int32_t>(yoffset);
+            write<int32_t>(zoffset);
+            write<int32_t>(width);
+            write<int32_t>(height);
+            write<int32_t>(depth);
+            write<uint32_t>(format);
+            write<uint32_t>(type);
+            write_blob(pixels, get_image_size(width, height, depth, format, type));
+        }
+        real_glTextureSubImage3D(texture, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+    }
+
+    static void APIENTRY hook_glTextureParameteri(GLuint texture, GLenum pname, GLint param)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::TextureParameteri);
+            write<uint32_t>(texture);
+            write<uint32_t>(pname);
+            write<int32_t>(param);
+        }
+        std::vector<std::pair<GLenum, GLint>>& parameters = s_capture.textures[texture].parameters;
+        const auto found = std::find_if(parameters.begin(), parameters.end(), [pname](const auto& parameter) { return parameter.first == pname; });
+        if (found != parameters.end())
+        {
+            found->second = param;
+        }
+        else
+        {
+            parameters.emplace_back(pname, param);
+        }
+        real_glTextureParameteri(texture, pname, param);
+    }
+
+    static void APIENTRY hook_glGenerateTextureMipmap(GLuint texture)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::GenerateTextureMipmap);
+            write<uint32_t>(texture);
+        }
+        real_glGenerateTextureMipmap(texture);
+    }
+
+    static void APIENTRY hook_glBindTextureUnit(GLuint unit, GLuint texture)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::BindTextureUnit);
+            write<uint32_t>(unit);
+            write<uint32_t>(texture);
+        }
+        if (unit < max_texture_units)
+        {
+            s_capture.texture_units[unit] = texture;
+        }
+        real_glBindTextureUnit(unit, texture);
+    }
+
+    static void APIENTRY hook_glCopyImageSubData(GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ,
+                                                 GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ,
+                                                 GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::CopyImageSubData);
+            write<uint32_t>(srcName);
+            write<uint32_t>(srcTarget);
+            write<int32_t>(srcLevel);
+            write<int32_t>(srcX);
+            write<int32_t>(srcY);
+            write<int32_t>(srcZ);
+            write<uint32_t>(dstName);
+            write<uint32_t>(dstTarget);
+            write<int32_t>(dstLevel);
+            write<int32_t>(dstX);
+            write<int32_t>(dstY);
+            write<int32_t>(dstZ);
+            write<int32_t>(srcWidth);
+            write<int32_t>(srcHeight);
+            write<int32_t>(srcDepth);
+        }
+        real_glCopyImageSubData(srcName, srcTarget, srcLevel, srcX, srcY, srcZ, dstName, dstTarget, dstLevel, dstX, dstY, dstZ, srcWidth, srcHeight, srcDepth);
+    }
+
+
+    static void APIENTRY hook_glGenVertexArrays(GLsizei n, GLuint* arrays)
+    {
+        real_glGenVertexArrays(n, arrays);
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            s_capture.vertex_arrays[arrays[i]] = TrackedVertexArray();
+        }
+        if (is_recording())
+        {
+            write_command(ECommand::GenVertexArrays);
+            write_names(n, arrays);
+        }
+    }
+
+    static void APIENTRY hook_glDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::DeleteVertexArrays);
+            write_names(n, arrays);
+        }
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            s_capture.vertex_arrays.erase(arrays[i]);
+            if (s_capture.bound_vertex_array == arrays[i])
+            {
+                s_capture.bound_vertex_array = 0;
+            }
+        }
+        real_glDeleteVertexArrays(n, arrays);
+    }
+
+    static void APIENTRY hook_glBindVertexArray(GLuint array)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::BindVertexArray);
+            write<uint32_t>(array);
+        }
+        s_capture.bound_vertex_array = array;
+        real_glBindVertexArray(array);
+    }
+
+    static TrackedVertexArray* get_bound_vertex_array()
+    {
+        const auto found = s_capture.vertex_arrays.find(s_capture.bound_vertex_array);
+        return found != s_capture.vertex_arrays.end() ? &found->second : nullptr;
+    }
+
+    static void APIENTRY hook_glEnableVertexAttribArray(GLuint index)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::EnableVertexAttribArray);
+            write<uint32_t>(index);
+        }
+        TrackedVertexArray* vertex_array = get_bound_vertex_array();
+        if (vertex_array && index < max_vertex_attributes)
+        {
+            vertex_array->attributes[index].enabled = true;
+        }
+        real_glEnableVertexAttribArray(index);
+    }
+
+    static void APIENTRY hook_glBindVertexBuffer(GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::BindVertexBuffer);
+            write<uint32_t>(bindingindex);
+            write<uint32_t>(buffer);
+            write<uint64_t>(offset);
+            write<int32_t>(stride);
+        }
+        TrackedVertexArray* vertex_array = get_bound_vertex_array();
+        if (vertex_array && bindingindex < max_vertex_attributes)
+        {
+            vertex_array->bindings[bindingindex] = { buffer, offset, stride };
+        }
+        real_glBindVertexBuffer(bindingindex, buffer, offset, stride);
+    }
+
+    static void APIENTRY hook_glVertexAttribFormat(GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::VertexAttribFormat);
+            write<uint32_t>(attribindex);
+            write<int32_t>(size);
+            write<uint32_t>(type);
+            write<uint32_t>(normalized);
+            write<uint32_t>(relativeoffset);
+        }
+        TrackedVertexArray* vertex_array = get_bound_vertex_array();
+        if (vertex_array && attribindex < max_vertex_attributes)
+        {
+            TrackedVertexArray::Attribute& attribute = vertex_array->attributes[attribindex];
+            attribute.has_format = true;
+            attribute.size = size;
+            attribute.type = type;
+            attribute.normalized = normalized;
+            attribute.relative_offset = relativeoffset;
+        }
+        real_glVertexAttribFormat(attribindex, size, type, normalized, relativeoffset);
+    }
+
+    static void APIENTRY hook_glVertexAttribBinding(GLuint attribindex, GLuint bindingindex)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::VertexAttribBinding);
+            write<uint32_t>(attribindex);
+            write<uint32_t>(bindingindex);
+        }
+        TrackedVertexArray* vertex_array = get_bound_vertex_array();
+        if (vertex_array && attribindex < max_vertex_attributes)
+        {
+            vertex_array->attributes[attribindex].binding = bindingindex;
+        }
+        real_glVertexAttribBinding(attribindex, bindingindex);
+    }
+
+
+    static GLuint APIENTRY hook_glCreateShader(GLenum type)
+    {
+        const GLuint shader = real_glCreateShader(type);
+        s_capture.shaders[shader].type = type;
+        if (is_recording())
+        {
+            write_command(ECommand::CreateShader);
+            write<uint32_t>(type);
+            write<uint32_t>(shader);
+        }
+        return shader;
+    }
+
+    static void APIENTRY hook_glShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+    {
+        std::string source;
+        for (GLsizei i = 0; i < count; ++i)
+        {
+            if (length && length[i] >= 0)
+            {
+                source.append(string[i], length[i]);
+            }
+            else
+            {
+                source.append(string[i]);
+            }
+        }
+        if (is_recording())
+        {
+            write_command(ECommand::ShaderSource);
+            write<uint32_t>(shader);
+            write_blob(source.data(), source.size());
+        }
+        s_capture.shaders[shader].source = std::move(source);
+        real_glShaderSource(shader, count, string, length);
+    }
+
+    static void APIENTRY hook_glCompileShader(GLuint shader)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::CompileShader);
+            write<uint32_t>(shader);
+        }
+        real_glCompileShader(shader);
+    }
+
+    static void APIENTRY hook_glDeleteShader(GLuint shader)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::DeleteShader);
+            write<uint32_t>(shader);
+        }
+        s_capture.shaders.erase(shader);
+        real_glDeleteShader(shader);
+    }
+
+    static GLuint APIENTRY hook_glCreateProgram()
+    {
+        const GLuint program = real_glCreateProgram();
+        s_capture.programs[program] = TrackedProgram();
+        if (is_recording())
+        {
+            write_command(ECommand::CreateProgram);
+            write<uint32_t>(program);
+        }
+        return program;
+    }
+
+    static void APIENTRY hook_glAttachShader(GLuint program, GLuint shader)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::AttachShader);
+            write<uint32_t>(program);
+            write<uint32_t>(shader);
+        }
+        s_capture.programs[program].attached_shaders.push_back(shader);
+        real_glAttachShader(program, shader);
+    }
+
+    static void APIENTRY hook_glDetachShader(GLuint program, GLuint shader)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::DetachShader);
+            write<uint32_t>(program);
+            write<uint32_t>(shader);
+        }
+        std::vector<GLuint>& attached_shaders = s_capture.programs[program].attached_shaders;
+        attached_shaders.erase(std::remove(attached_shaders.begin(), attached_shaders.end(), shader), attached_shaders.end());
+        real_glDetachShader(program, shader);
+    }
+
+    static void APIENTRY hook_glLinkProgram(GLuint program)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::LinkProgram);
+            write<uint32_t>(program);
+        }
+        TrackedProgram& tracked = s_capture.programs[program];
+        tracked.linked_shaders.clear();
+        for (const GLuint shader : tracked.attached_shaders)
+        {
+            tracked.linked_shaders.push_back(s_capture.shaders[shader]);
+        }
+        real_glLinkProgram(program);
+    }
+
+    static void APIENTRY hook_glDeleteProgram(GLuint program)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::DeleteProgram);
+            write<uint32_t>(program);
+        }
+        s_capture.programs.erase(program);
+        real_glDeleteProgram(program);
+    }
+
+    static void APIENTRY hook_glUseProgram(GLuint program)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::UseProgram);
+            write<uint32_t>(program);
+        }
+        real_glUseProgram(program);
+    }
+
+    static GLint APIENTRY hook_glGetUniformLocation(GLuint program, const GLchar* name)
+    {
+        const GLint location = real_glGetUniformLocation(program, name);
+        if (is_recording())
+        {
+            // the replayer looks the name up in its own program and maps the location the engine saw to it
+            write_command(ECommand::GetUniformLocation);
+            write<uint32_t>(program);
+            write_blob(name, std::char_traits<char>::length(name));
+            write<int32_t>(location);
+        }
+        return location;
+    }
+
+    static void APIENTRY hook_glUniform1i(GLint location, GLint v0)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::Uniform1i);
+            write<int32_t>(location);
+            write<int32_t>(v0);
+        }
+        real_glUniform1i(location, v0);
+    }
+
+    static void APIENTRY hook_glUniform1f(GLint location, GLfloat v0)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::Uniform1f);
+            write<int32_t>(location);
+            write<float>(v0);
+        }
+        real_glUniform1f(location, v0);
+    }
+
+    static void APIENTRY hook_glUniform2f(GLint location, GLfloat v0, GLfloat v1)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::Uniform2f);
+            write<int32_t>(location);
+            write<float>(v0);
+            write<float>(v1);
+        }
+        real_glUniform2f(location, v0, v1);
+    }
+
+    static void APIENTRY hook_glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::Uniform3f);
+            write<int32_t>(location);
+            write<float>(v0);
+            write<float>(v1);
+            write<float>(v2);
+        }
+        real_glUniform3f(location, v0, v1, v2);
+    }
+
+    static void APIENTRY hook_glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::Uniform4f);
+            write<int32_t>(location);
+            write<float>(v0);
+            write<float>(v1);
+            write<float>(v2);
+            write<float>(v3);
+        }
+        real_glUniform4f(location, v0, v1, v2, v3);
+    }
+
+    static void APIENTRY hook_glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::UniformMatrix3fv);
+            write<int32_t>(location);
+            write<int32_t>(count);
+            write<uint32_t>(transpose);
+            write_floats(value, 9 * static_cast<size_t>(count));
+        }
+        real_glUniformMatrix3fv(location, count, transpose, value);
+    }
+
+    static void APIENTRY hook_glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::UniformMatrix4fv);
+            write<int32_t>(location);
+            write<int32_t>(count);
+            write<uint32_t>(transpose);
+            write_floats(value, 16 * static_cast<size_t>(count));
+        }
+        real_glUniformMatrix4fv(location, count, transpose, value);
+    }
+
+
+    static void APIENTRY hook_glCreateFramebuffers(GLsizei n, GLuint* framebuffers)
+    {
+        real_glCreateFramebuffers(n, framebuffers);
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            s_capture.framebuffers[framebuffers[i]] = TrackedFramebuffer();
+        }
+        if (is_recording())
+        {
+            write_command(ECommand::CreateFramebuffers);
+            write_names(n, framebuffers);
+        }
+    }
+
+    static void APIENTRY hook_glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::DeleteFramebuffers);
+            write_names(n, framebuffers);
+        }
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            s_capture.framebuffers.erase(framebuffers[i]);
+        }
+        real_glDeleteFramebuffers(n, framebuffers);
+    }
+
+    static void APIENTRY hook_glBindFramebuffer(GLenum target, GLuint framebuffer)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::BindFramebuffer);
+            write<uint32_t>(target);
+            write<uint32_t>(framebuffer);
+        }
+        real_glBindFramebuffer(target, framebuffer);
+    }
+
+    static void APIENTRY hook_glNamedFramebufferTexture(GLuint framebuffer, GLenum attachment, GLuint texture, GLint level)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::NamedFramebufferTexture);
+            write<uint32_t>(framebuffer);
+            write<uint32_t>(attachment);
+            write<uint32_t>(texture);
+            write<int32_t>(level);
+        }
+        std::map<GLenum, std::pair<GLuint, GLint>>& attachments = s_capture.framebuffers[framebuffer].attachments;
+        if (texture != 0)
+        {
+            attachments[attachment] = { texture, level };
+        }
+        else
+        {
+            attachments.erase(attachment);
+        }
+        real_glNamedFramebufferTexture(framebuffer, attachment, texture, level);
+    }
+
+    static void APIENTRY hook_glNamedFramebufferDrawBuffer(GLuint framebuffer, GLenum buf)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::NamedFramebufferDrawBuffer);
+            write<uint32_t>(framebuffer);
+            write<uint32_t>(buf);
+        }
+        s_capture.framebuffers[framebuffer].draw_buffers = { buf };
+        real_glNamedFramebufferDrawBuffer(framebuffer, buf);
+    }
+
+    static void APIENTRY hook_glNamedFramebufferDrawBuffers(GLuint framebuffer, GLsizei n, const GLenum* bufs)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::NamedFramebufferDrawBuffers);
+            write<uint32_t>(framebuffer);
+            write_names(n, bufs);
+        }
+        s_capture.framebuffers[framebuffer].draw_buffers.assign(bufs, bufs + n);
+        real_glNamedFramebufferDrawBuffers(framebuffer, n, bufs);
+    }
+
+    static void APIENTRY hook_glNamedFramebufferReadBuffer(GLuint framebuffer, GLenum src)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::NamedFramebufferReadBuffer);
+            write<uint32_t>(framebuffer);
+            write<uint32_t>(src);
+        }
+        s_capture.framebuffers[framebuffer].read_buffer = src;
+        real_glNamedFramebufferReadBuffer(framebuffer, src);
+    }
+
+    static void APIENTRY hook_glBlitNamedFramebuffer(GLuint readFramebuffer, GLuint drawFramebuffer, GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+                                                     GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::BlitNamedFramebuffer);
+            write<uint32_t>(readFramebuffer);
+            write<uint32_t>(drawFramebuffer);
+            write<int32_t>(srcX0);
+            write<int32_t>(srcY0);
+            write<int32_t>(srcX1);
+            write<int32_t>(srcY1);
+            write<int32_t>(dstX0);
+            write<int32_t>(dstY0);
+            write<int32_t>(dstX1);
+            write<int32_t>(dstY1);
+            write<uint32_t>(mask);
+            write<uint32_t>(filter);
+        }
+        real_glBlitNamedFramebuffer(readFramebuffer, drawFramebuffer, srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+    }
+
+
+    static void APIENTRY hook_glCreateQueries(GLenum target, GLsizei n, GLuint* ids)
+    {
+        real_glCreateQueries(target, n, ids);
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            s_capture.queries[ids[i]] = target;
+        }
+        if (is_recording())
+        {
+            write_command(ECommand::CreateQueries);
+            write<uint32_t>(target);
+            write_names(n, ids);
+        }
+    }
+
+    static void APIENTRY hook_glDeleteQueries(GLsizei n, const GLuint* ids)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::DeleteQueries);
+            write_names(n, ids);
+        }
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            s_capture.queries.erase(ids[i]);
+        }
+        real_glDeleteQueries(n, ids);
+    }
+
+    static void APIENTRY hook_glQueryCounter(GLuint id, GLenum target)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::QueryCounter);
+            write<uint32_t>(id);
+            write<uint32_t>(target);
+        }
+        real_glQueryCounter(id, target);
+    }
+
+    // results are not recorded, the replayer reads them again so it waits on the GPU where the engine did
+    static void APIENTRY hook_glGetQueryObjectiv(GLuint id, GLenum pname, GLint* params)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::GetQueryObjectiv);
+            write<uint32_t>(id);
+            write<uint32_t>(pname);
+        }
+        real_glGetQueryObjectiv(id, pname, params);
+    }
+
+    static void APIENTRY hook_glGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::GetQueryObjectui64v);
+            write<uint32_t>(id);
+            write<uint32_t>(pname);
+        }
+        real_glGetQueryObjectui64v(id, pname, params);
+    }
+
+
+    static void APIENTRY hook_glEnable(GLenum cap)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::Enable);
+            write<uint32_t>(cap);
+        }
+        real_glEnable(cap);
+    }
+
+    static void APIENTRY hook_glDisable(GLenum cap)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::Disable);
+            write<uint32_t>(cap);
+        }
+        real_glDisable(cap);
+    }
+
+    static void APIENTRY hook_glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::Viewport);
+            write<int32_t>(x);
+            write<int32_t>(y);
+            write<int32_t>(width);
+            write<int32_t>(height);
+        }
+        real_glViewport(x, y, width, height);
+    }
+
+    static void APIENTRY hook_glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::Scissor);
+            write<int32_t>(x);
+            write<int32_t>(y);
+            write<int32_t>(width);
+            write<int32_t>(height);
+        }
+        real_glScissor(x, y, width, height);
+    }
+
+    static void APIENTRY hook_glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::ClearColor);
+            write<float>(red);
+            write<float>(green);
+            write<float>(blue);
+            write<float>(alpha);
+        }
+        real_glClearColor(red, green, blue, alpha);
+    }
+
+    static void APIENTRY hook_glClear(GLbitfield mask)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::Clear);
+            write<uint32_t>(mask);
+        }
+        real_glClear(mask);
+    }
+
+    static void APIENTRY hook_glPolygonOffset(GLfloat factor, GLfloat units)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::PolygonOffset);
+            write<float>(factor);
+            write<float>(units);
+        }
+        real_glPolygonOffset(factor, units);
+    }
+
+    static void APIENTRY hook_glFinish()
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::Finish);
+        }
+        real_glFinish();
+    }
+
+    static void APIENTRY hook_glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+    {
+        if (is_recording())
+        {
+            // indices is an offset into the bound element buffer, the engine never draws from client memory
+            write_command(ECommand::DrawElements);
+            write<uint32_t>(mode);
+            write<int32_t>(count);
+            write<uint32_t>(type);
+            write<uint64_t>(reinterpret_cast<uintptr_t>(indices));
+        }
+        real_glDrawElements(mode, count, type, indices);
+    }
+
+    static void APIENTRY hook_glDrawArrays(GLenum mode, GLint first, GLsizei count)
+    {
+        if (is_recording())
+        {
+            write_command(ECommand::DrawArrays);
+            write<uint32_t>(mode);
+            write<int32_t>(first);
+            write<int32_t>(count);
+        }
+        real_glDrawArrays(mode, first, count);
+    }
+
+
+    // ---- initial state ----
+
+    static void write_buffers_state()
+    {
+        std::vector<uint8_t> contents;
+        for (const auto& [buffer, tracked] : s_capture.buffers)
+        {
+            write_command(ECommand::CreateBuffers);
+            write_names(1, &buffer);
+            if (tracked.size <= 0)
+            {
+                continue;
+            }
+            contents.resize(tracked.size);
+            glGetNamedBufferSubData(buffer, 0, tracked.size, contents.data());
+            write_command(ECommand::NamedBufferData);
+            write<uint32_t>(buffer);
+            write<uint64_t>(tracked.size);
+            write_blob(contents.data(), contents.size());
+            write<uint32_t>(tracked.usage);
+        }
+    }
+
+    static void write_textures_state()
+    {
+        std::vector<uint8_t> contents;
+        for (const auto& [texture, tracked] : s_capture.textures)
+        {
+            write_command(ECommand::CreateTextures);
+            write<uint32_t>(tracked.target);
+            write_names(1, &texture);
+            if (tracked.levels == 0)
+            {
+                continue;
+            }
+
+            const bool is_3d = tracked.target == GL_TEXTURE_3D || tracked.target == GL_TEXTURE_2D_ARRAY;
+            write_command(is_3d ? ECommand::TextureStorage3D : ECommand::TextureStorage2D);
+            write<uint32_t>(texture);
+            write<int32_t>(tracked.levels);
+            write<uint32_t>(tracked.internal_format);
+            write<int32_t>(tracked.width);
+            write<int32_t>(tracked.height);
+            if (is_3d)
+            {
+                write<int32_t>(tracked.depth);
+            }
+            for (const auto& [pname, param] : tracked.parameters)
+            {
+                write_command(ECommand::TextureParameteri);
+                write<uint32_t>(texture);
+                write<uint32_t>(pname);
+                write<int32_t>(param);
+            }
+
+            GLenum format = 0;
+            GLenum type = 0;
+            uint64_t pixel_size = 0;
+            if (!get_readback_format(tracked.internal_format, format, type, pixel_size))
+            {
+                LOG_WARN("GL capture: contents of texture {0} with internal format 0x{1:x} are not captured", texture, tracked.internal_format);
+                continue;
+            }
+            for (GLsizei level = 0; level < tracked.levels; ++level)
+            {
+                const GLsizei width = std::max(tracked.width >> level, 1);
+                const GLsizei height = std::max(tracked.height >> level, 1);
+                const GLsizei depth = tracked.target == GL_TEXTURE_3D ? std::max(tracked.depth >> level, 1) : tracked.depth;
+                contents.resize(pixel_size * width * height * depth);
+                glGetTextureImage(texture, level, format, type, static_cast<GLsizei>(contents.size()), contents.data());
+
+                write_command(is_3d ? ECommand::TextureSubImage3D : ECommand::TextureSubImage2D);
+                write<uint32_t>(texture);
+                write<int32_t>(level);
+                write<int32_t>(0);
+                write<int32_t>(0);
+                if (is_3d)
+                {
+                    write<int32_t>(0);
+                }
+                write<int32_t>(width);
+                write<int32_t>(height);
+                if (is_3d)
+                {
+                    write<int32_t>(depth);
+                }
+                write<uint32_t>(format);
+                write<uint32_t>(type);
+                write_blob(contents.data(), contents.size());
+            }
+        }
+    }
+
+    static void write_uniforms_state(const GLuint program)
+    {
+        GLint uniforms_count = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniforms_count);
+        for (GLint i = 0; i < uniforms_count; ++i)
+        {
+            GLchar name[256];
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, i, sizeof(name), nullptr, &size, &type, name);
+            const GLint location = real_glGetUniformLocation(program, name);
+            // block members and arrays are not set through the uniform calls the engine makes
+            if (location < 0 || size != 1)
+            {
+                continue;
+            }
+
+            GLfloat values[16] = {};
+            GLint value = 0;
+            ECommand command = ECommand::Count;
+            switch (type)
+            {
+                case GL_FLOAT:             command = ECommand::Uniform1f; break;
+                case GL_FLOAT_VEC2:        command = ECommand::Uniform2f; break;
+                case GL_FLOAT_VEC3:        command = ECommand::Uniform3f; break;
+                case GL_FLOAT_VEC4:        command = ECommand::Uniform4f; break;
+                case GL_FLOAT_MAT3:        command = ECommand::UniformMatrix3fv; break;
+                case GL_FLOAT_MAT4:        command = ECommand::UniformMatrix4fv; break;
+                case GL_INT:
+                case GL_BOOL:
+                case GL_SAMPLER_2D:
+                case GL_SAMPLER_3D:
+                case GL_SAMPLER_CUBE:
+                case GL_SAMPLER_2D_SHADOW: command = ECommand::Uniform1i; break;
+            }
+            if (command == ECommand::Count)
+            {
+                continue;
+            }
+
+            write_command(ECommand::GetUniformLocation);
+            write<uint32_t>(program);
+            write_blob(name, std::char_traits<char>::length(name));
+            write<int32_t>(location);
+
+            write_command(command);
+            write<int32_t>(location);
+            if (command == ECommand::Uniform1i)
+            {
+                glGetUniformiv(program, location, &value);
+                write<int32_t>(value);
+                continue;
+            }
+            glGetUniformfv(program, location, values);
+            switch (command)
+            {
+                case ECommand::Uniform1f:        write_floats(values, 1); break;
+                case ECommand::Uniform2f:        write_floats(values, 2); break;
+                case ECommand::Uniform3f:        write_floats(values, 3); break;
+                case ECommand::Uniform4f:        write_floats(values, 4); break;
+                case ECommand::UniformMatrix3fv: write<int32_t>(1); write<uint32_t>(GL_FALSE); write_floats(values, 9); break;
+                case ECommand::UniformMatrix4fv: write<int32_t>(1); write<uint32_t>(GL_FALSE); write_floats(values, 16); break;
+                default: break;
+            }
+        }
+    }
+
+    static void write_programs_state()
+    {
+        // shader names that cannot collide with the ones the engine creates later, the replayer maps them anyway
+        GLuint next_shader = 0x80000000u;
+        for (const auto& [program, tracked] : s_capture.programs)
+        {
+            write_command(ECommand::CreateProgram);
+            write<uint32_t>(program);
+            if (tracked.linked_shaders.empty())
+            {
+                continue;
+            }
+
+            std::vector<GLuint> shaders;
+            for (const TrackedShader& shader : tracked.linked_shaders)
+            {
+                shaders.push_back(next_shader++);
+                write_command(ECommand::CreateShader);
+                write<uint32_t>(shader.type);
+                write<uint32_t>(shaders.back());
+                write_command(ECommand::ShaderSource);
+                write<uint32_t>(shaders.back());
+                write_blob(shader.source.data(), shader.source.size());
+                write_command(ECommand::CompileShader);
+                write<uint32_t>(shaders.back());
+                write_command(ECommand::AttachShader);
+                write<uint32_t>(program);
+                write<uint32_t>(shaders.back());
+            }
+            write_command(ECommand::LinkProgram);
+            write<uint32_t>(program);
+            for (const GLuint shader : shaders)
+            {
+                write_command(ECommand::DetachShader);
+                write<uint32_t>(program);
+                write<uint32_t>(shader);
+                write_command(ECommand::DeleteShader);
+                write<uint32_t>(shader);
+            }
+
+            write_command(ECommand::UseProgram);
+            write<uint32_t>(program);
+            write_uniforms_state(program);
+        }
+    }
+
+    static void write_vertex_arrays_state()
+    {
+        for (const auto& [vertex_array, tracked] : s_capture.vertex_arrays)
+        {
+            write_command(ECommand::GenVertexArrays);
+            write_names(1, &vertex_array);
+            write_command(ECommand::BindVertexArray);
+            write<uint32_t>(vertex_array);
+            for (size_t i = 0; i < max_vertex_attributes; ++i)
+            {
+                const TrackedVertexArray::Binding& binding = tracked.bindings[i];
+                if (binding.buffer != 0)
+                {
+                    write_command(ECommand::BindVertexBuffer);
+                    write<uint32_t>(static_cast<uint32_t>(i));
+                    write<uint32_t>(binding.buffer);
+                    write<uint64_t>(binding.offset);
+                    write<int32_t>(binding.stride);
+                }
+                const TrackedVertexArray::Attribute& attribute = tracked.attributes[i];
+                if (attribute.has_format)
+                {
+                    write_command(ECommand::VertexAttribFormat);
+                    write<uint32_t>(static_cast<uint32_t>(i));
+                    write<int32_t>(attribute.size);
+                    write<uint32_t>(attribute.type);
+                    write<uint32_t>(attribute.normalized);
+                    write<uint32_t>(attribute.relative_offset);
+                }
+                if (attribute.binding != i)
+                {
+                    write_command(ECommand::VertexAttribBinding);
+                    write<uint32_t>(static_cast<uint32_t>(i));
+                    write<uint32_t>(attribute.binding);
+                }
+                if (attribute.enabled)
+                {
+                    write_command(ECommand::EnableVertexAttribArray);
+                    write<uint32_t>(static_cast<uint32_t>(i));
+                }
+            }
+            if (tracked.element_buffer != 0)
+            {
+                write_command(ECommand::BindBuffer);
+                write<uint32_t>(GL_ELEMENT_ARRAY_BUFFER);
+                write<uint32_t>(tracked.element_buffer);
+            }
+        }
+    }
+
+    static void write_framebuffers_state()
+    {
+        for (const auto& [framebuffer, tracked] : s_capture.framebuffers)
+        {
+            write_command(ECommand::CreateFramebuffers);
+            write_names(1, &framebuffer);
+            for (const auto& [attachment, texture] : tracked.attachments)
+            {
+                write_command(ECommand::NamedFramebufferTexture);
+                write<uint32_t>(framebuffer);
+                write<uint32_t>(attachment);
+                write<uint32_t>(texture.first);
+                write<int32_t>(texture.second);
+            }
+            if (!tracked.draw_buffers.empty())
+            {
+                write_command(ECommand::NamedFramebufferDrawBuffers);
+                write<uint32_t>(framebuffer);
+                write_names(static_cast<GLsizei>(tracked.draw_buffers.size()), tracked.draw_buffers.data());
+            }
+            if (tracked.read_buffer != 0)
+            {
+                write_command(ECommand::NamedFramebufferReadBuffer);
+                write<uint32_t>(framebuffer);
+                write<uint32_t>(tracked.read_buffer);
+            }
+        }
+    }
+
+    static void write_bound_state()
+    {
+        for (const auto& [binding, buffer] : s_capture.indexed_buffers)
+        {
+            write_command(ECommand::BindBufferBase);
+            write<uint32_t>(binding.first);
+            write<uint32_t>(binding.second);
+            write<uint32_t>(buffer);
+        }
+        // bind the tracked indexed buffers first, BindBufferBase also changes the generic binding
+        for (const auto& [target, buffer] : s_capture.bound_buffers)
+        {
+            // the element buffer is vertex array state
+            if (target == GL_ELEMENT_ARRAY_BUFFER)
+            {
+                continue;
+            }
+            write_command(ECommand::BindBuffer);
+            write<uint32_t>(target);
+            write<uint32_t>(buffer);
+        }
+        for (size_t unit = 0; unit < max_texture_units; ++unit)
+        {
+            if (s_capture.texture_units[unit] != 0)
+            {
+                write_command(ECommand::BindTextureUnit);
+                write<uint32_t>(static_cast<uint32_t>(unit));
+                write<uint32_t>(s_capture.texture_units[unit]);
+            }
+        }
+        write_command(ECommand::BindVertexArray);
+        write<uint32_t>(s_capture.bound_vertex_array);
+
+        GLint program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        write_command(ECommand::UseProgram);
+        write<uint32_t>(program);
+
+        GLint framebuffer = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        write_command(ECommand::BindFramebuffer);
+        write<uint32_t>(GL_FRAMEBUFFER);
+        write<uint32_t>(framebuffer);
+
+        GLint rectangle[4] = {};
+        glGetIntegerv(GL_VIEWPORT, rectangle);
+        write_command(ECommand::Viewport);
+        for (const GLint value : rectangle)
+        {
+            write<int32_t>(value);
+        }
+        glGetIntegerv(GL_SCISSOR_BOX, rectangle);
+        write_command(ECommand::Scissor);
+        for (const GLint value : rectangle)
+        {
+            write<int32_t>(value);
+        }
+
+        GLfloat color[4] = {};
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, color);
+        write_command(ECommand::ClearColor);
+        write_floats(color, 4);
+
+        GLfloat polygon_offset[2] = {};
+        glGetFloatv(GL_POLYGON_OFFSET_FACTOR, &polygon_offset[0]);
+        glGetFloatv(GL_POLYGON_OFFSET_UNITS, &polygon_offset[1]);
+        write_command(ECommand::PolygonOffset);
+        write_floats(polygon_offset, 2);
+
+        for (const GLenum cap : { GL_DEPTH_TEST, GL_SCISSOR_TEST, GL_POLYGON_OFFSET_FILL, GL_BLEND, GL_CULL_FACE, GL_STENCIL_TEST, GL_FRAMEBUFFER_SRGB })
+        {
+            write_command(glIsEnabled(cap) ? ECommand::Enable : ECommand::Disable);
+            write<uint32_t>(cap);
+        }
+    }
+
+    static void write_state()
+    {
+        // readbacks go to client memory
+        GLint pack_buffer = 0;
+        glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &pack_buffer);
+        real_glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        write_buffers_state();
+        write_textures_state();
+        write_programs_state();
+        write_vertex_arrays_state();
+        write_framebuffers_state();
+        for (const auto& [query, target] : s_capture.queries)
+        {
+            write_command(ECommand::CreateQueries);
+            write<uint32_t>(target);
+            write_names(1, &query);
+        }
+        write_bound_state();
+        write_command(ECommand::StateEnd);
+
+        real_glBindBuffer(GL_PIXEL_PACK_BUFFER, pack_buffer);
+        // write_programs_state leaves every program in use in turn
+        GLint program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        real_glUseProgram(program);
+    }
+
+
+    static void finish_capture()
+    {
+        s_capture.recording = false;
+
+        GLCaptureFormat::Header header;
+        std::copy(std::begin(GLCaptureFormat::magic), std::end(GLCaptureFormat::magic), header.magic);
+        header.version = GLCaptureFormat::version;
+        header.width = s_capture.width;
+        header.height = s_capture.height;
+        header.frames_count = s_capture.captured_frames_count;
+
+        std::ofstream file(s_capture.path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(s_capture.stream.data()), s_capture.stream.size());
+        if (file.good())
+        {
+            LOG_INFO("GL capture of {0} frames written to {1} ({2} KB)", header.frames_count, s_capture.path, (sizeof(header) + s_capture.stream.size()) / 1024);
+        }
+        else
+        {
+            LOG_CRITICAL("GL capture: can't write {0}", s_capture.path);
+        }
+        std::vector<uint8_t>().swap(s_capture.stream);
+    }
+
+
+#define SIMPLE_ENGINE_GL_CAPTURE_HOOK(name) real_##name = glad_##name; glad_##name = hook_##name;
+
+    void GLCapture::install()
+    {
+        if (s_capture.installed)
+        {
+            return;
+        }
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glGenBuffers)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glCreateBuffers)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glDeleteBuffers)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glBindBuffer)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glBufferData)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glNamedBufferData)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glNamedBufferSubData)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glBindBufferBase)
+
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glCreateTextures)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glDeleteTextures)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glTextureStorage2D)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glTextureStorage3D)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glTextureSubImage2D)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glTextureSubImage3D)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glTextureParameteri)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glGenerateTextureMipmap)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glBindTextureUnit)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glCopyImageSubData)
+
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glGenVertexArrays)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glDeleteVertexArrays)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glBindVertexArray)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glEnableVertexAttribArray)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glBindVertexBuffer)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glVertexAttribFormat)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glVertexAttribBinding)
+
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glCreateShader)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glShaderSource)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glCompileShader)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glDeleteShader)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glCreateProgram)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glAttachShader)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glDetachShader)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glLinkProgram)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glDeleteProgram)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glUseProgram)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glGetUniformLocation)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glUniform1i)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glUniform1f)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glUniform2f)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glUniform3f)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glUniform4f)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glUniformMatrix3fv)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glUniformMatrix4fv)
+
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glCreateFramebuffers)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glDeleteFramebuffers)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glBindFramebuffer)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glNamedFramebufferTexture)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glNamedFramebufferDrawBuffer)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glNamedFramebufferDrawBuffers)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glNamedFramebufferReadBuffer)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glBlitNamedFramebuffer)
+
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glCreateQueries)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glDeleteQueries)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glQueryCounter)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glGetQueryObjectiv)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glGetQueryObjectui64v)
+
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glEnable)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glDisable)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glViewport)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glScissor)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glClearColor)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glClear)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glPolygonOffset)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glFinish)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glDrawElements)
+        SIMPLE_ENGINE_GL_CAPTURE_HOOK(glDrawArrays)
+        s_capture.installed = true;
+    }
+
+#undef SIMPLE_ENGINE_GL_CAPTURE_HOOK
+
+
+    bool GLCapture::is_installed()
+    {
+        return s_capture.installed;
+    }
+
+
+    bool GLCapture::begin(const std::string& path, const uint32_t frames_count, const uint32_t width, const uint32_t height)
+    {
+        if (!s_capture.installed)
+        {
+            LOG_CRITICAL("GL capture: hooks are not installed");
+            return false;
+        }
+        if (is_capturing() || frames_count == 0)
+        {
+            return false;
+        }
+        s_capture.path = path;
+        s_capture.frames_count = frames_count;
+        s_capture.captured_frames_count = 0;
+        s_capture.width = width;
+        s_capture.height = height;
+        s_capture.pending_start = true;
+        return true;
+    }
+
+
+    bool GLCapture::is_capturing()
+    {
+        return s_capture.pending_start || s_capture.recording;
+    }
+
+
+    uint32_t GLCapture::get_captured_frames_count()
+    {
+        return s_capture.captured_frames_count;
+    }
+
+
+    void GLCapture::on_frame_end()
+    {
+        if (s_capture.pending_start)
+        {
+            s_capture.pending_start = false;
+            s_capture.stream.clear();
+            write_state();
+            s_capture.recording = true;
+            s_capture.start_time = std::chrono::steady_clock::now();
+            return;
+        }
+        if (!s_capture.recording)
+        {
+            return;
+        }
+
+        write_command(ECommand::FrameEnd);
+        write<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_capture.start_time).count());
+        if (++s_capture.captured_frames_count == s_capture.frames_count)
+        {
+            finish_capture();
+        }
+    }
+
+
+    void GLCapture::pause()
+    {
+        ++s_capture.paused_depth;
+    }
+
+
+    void GLCapture::resume()
+    {
+        --s_capture.paused_depth;
+    }
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace SimpleEngine {
+
+    // Records the GL calls of N frames into a file for GLReplayer, see GLCaptureFormat.hpp.
+    // install() swaps glad's function pointers of every GL function the engine calls for hooks that track
+    // the objects the engine creates, so a capture can start on any frame: it begins with commands recreating
+    // every live buffer, texture (contents read back), program, vertex array, framebuffer and the bound state.
+    // Calls made through other loaders (the ImGui backend) are not seen, pause() keeps them out of the stream.
+    class GLCapture {
+    public:
+        // right after glad is loaded, before any GL object is created
+        static void install();
+        static bool is_installed();
+
+        // starts with the next frame, framebuffer 0 is width x height
+        static bool begin(const std::string& path, const uint32_t frames_count, const uint32_t width, const uint32_t height);
+        static bool is_capturing();
+        // frames written so far by the current or last capture
+        static uint32_t get_captured_frames_count();
+
+        // frame boundary, called before presenting
+        static void on_frame_end();
+
+        static void pause();
+        static void resume();
+    };
+
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+
+namespace SimpleEngine {
+
+    // Binary stream written by GLCapture and read by GLReplayer, little endian.
+    // File: Header, then commands: a uint16 ECommand followed by its arguments in call order.
+    // Enums, object names, counts and ints are 32 bit, sizes and offsets 64 bit, floats 32 bit.
+    // Object names are the ones the captured process saw, the replayer maps them to its own.
+    // n-element arrays are a uint32 count followed by the elements, blobs and strings a uint64 size followed by the bytes.
+    namespace GLCaptureFormat {
+
+        constexpr char magic[8] = { 'S', 'E', 'G', 'L', 'C', 'A', 'P', '\0' };
+        constexpr uint32_t version = 1;
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            // size of framebuffer 0 in the captured process
+            uint32_t width;
+            uint32_t height;
+            uint32_t frames_count;
+        };
+
+        enum class ECommand : uint16_t
+        {
+            // initial state recreating every object alive when the capture started is done, frames follow
+            StateEnd,
+            // uint64 nanoseconds since the capture started, at the end of each frame
+            FrameEnd,
+
+            GenBuffers,
+            CreateBuffers,
+            DeleteBuffers,
+            BindBuffer,
+            BufferData,
+            NamedBufferData,
+            NamedBufferSubData,
+            BindBufferBase,
+
+            CreateTextures,
+            DeleteTextures,
+            TextureStorage2D,
+            TextureStorage3D,
+            TextureSubImage2D,
+            TextureSubImage3D,
+            TextureParameteri,
+            GenerateTextureMipmap,
+            BindTextureUnit,
+            CopyImageSubData,
+
+            GenVertexArrays,
+            DeleteVertexArrays,
+            BindVertexArray,
+            EnableVertexAttribArray,
+            BindVertexBuffer,
+            VertexAttribFormat,
+            VertexAttribBinding,
+
+            CreateShader,
+            ShaderSource,
+            CompileShader,
+            DeleteShader,
+            CreateProgram,
+            AttachShader,
+            DetachShader,
+            LinkProgram,
+            DeleteProgram,
+            UseProgram,
+            GetUniformLocation,
+            Uniform1i,
+            Uniform1f,
+            Uniform2f,
+            Uniform3f,
+            Uniform4f,
+            UniformMatrix3fv,
+            UniformMatrix4fv,
+
+            CreateFramebuffers,
+            DeleteFramebuffers,
+            BindFramebuffer,
+            NamedFramebufferTexture,
+            NamedFramebufferDrawBuffer,
+            NamedFramebufferDrawBuffers,
+            NamedFramebufferReadBuffer,
+            BlitNamedFramebuffer,
+
+            CreateQueries,
+            DeleteQueries,
+            QueryCounter,
+            GetQueryObjectiv,
+            GetQueryObjectui64v,
+
+            Enable,
+            Disable,
+            Viewport,
+            Scissor,
+            ClearColor,
+            Clear,
+            PolygonOffset,
+            Finish,
+            DrawElements,
+            DrawArrays,
+
+            Count
+        };
+
+    }
+
+}
@@ -0,0 +1,772 @@
+#include "GLReplayer.hpp"
+#include "Framebuffer.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace SimpleEngine {
+
+    GLReplayer::GLReplayer() = default;
+    GLReplayer::~GLReplayer() = default;
+
+
+    bool GLReplayer::load(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            LOG_CRITICAL("GL replay: can't open {0}", path);
+            return false;
+        }
+        m_stream.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (m_stream.size() < sizeof(m_header))
+        {
+            LOG_CRITICAL("GL replay: {0} is too short", path);
+            return false;
+        }
+        std::memcpy(&m_header, m_stream.data(), sizeof(m_header));
+        if (std::memcmp(m_header.magic, GLCaptureFormat::magic, sizeof(m_header.magic)) != 0)
+        {
+            LOG_CRITICAL("GL replay: {0} is not a GL capture", path);
+            return false;
+        }
+        if (m_header.version != GLCaptureFormat::version)
+        {
+            LOG_CRITICAL("GL replay: {0} has version {1}, expected {2}", path, m_header.version, GLCaptureFormat::version);
+            return false;
+        }
+        return true;
+    }
+
+
+    template<typename T>
+    T GLReplayer::read()
+    {
+        T value{};
+        if (m_position + sizeof(T) > m_stream.size())
+        {
+            m_is_truncated = true;
+            m_position = m_stream.size();
+            return value;
+        }
+        std::memcpy(&value, m_stream.data() + m_position, sizeof(T));
+        m_position += sizeof(T);
+        return value;
+    }
+
+
+    const void* GLReplayer::read_blob(uint64_t& size)
+    {
+        size = read<uint64_t>();
+        if (size > m_stream.size() - m_position)
+        {
+            m_is_truncated = true;
+            m_position = m_stream.size();
+            size = 0;
+            return nullptr;
+        }
+        const void* data = size > 0 ? m_stream.data() + m_position : nullptr;
+        m_position += size;
+        return data;
+    }
+
+
+    std::vector<unsigned int> GLReplayer::read_names()
+    {
+        const uint32_t count = read<uint32_t>();
+        std::vector<unsigned int> names;
+        for (uint32_t i = 0; i < count && !m_is_truncated; ++i)
+        {
+            names.push_back(read<uint32_t>());
+        }
+        return names;
+    }
+
+
+    unsigned int GLReplayer::get_name(const NameMap& names, const uint32_t name)
+    {
+        const auto found = names.find(name);
+        return found != names.end() ? found->second : 0;
+    }
+
+
+    unsigned int GLReplayer::get_framebuffer(const uint32_t name) const
+    {
+        return name == 0 ? Framebuffer::get_default_handle() : get_name(m_framebuffers, name);
+    }
+
+
+    int GLReplayer::get_uniform_location(const int32_t location) const
+    {
+        // -1 is silently ignored by glUniform*, like in the captured process
+        const auto found = m_uniform_locations.find({ m_current_program, location });
+        return found != m_uniform_locations.end() ? found->second : -1;
+    }
+
+
+    bool GLReplayer::execute(const ECommand command)
+    {
+        switch (command)
+        {
+            case ECommand::GenBuffers:
+            case ECommand::CreateBuffers:
+            {
+                for (const uint32_t name : read_names())
+                {
+                    GLuint buffer = 0;
+                    if (command == ECommand::GenBuffers)
+                    {
+                        glGenBuffers(1, &buffer);
+                    }
+                    else
+                    {
+                        glCreateBuffers(1, &buffer);
+                    }
+                    m_buffers[name] = buffer;
+                }
+                return true;
+            }
+            case ECommand::DeleteBuffers:
+            {
+                for (const uint32_t name : read_names())
+                {
+                    const GLuint buffer = get_name(m_buffers, name);
+                    glDeleteBuffers(1, &buffer);
+                    m_buffers.erase(name);
+                }
+                return true;
+            }
+            case ECommand::BindBuffer:
+            {
+                const GLenum target = read<uint32_t>();
+                glBindBuffer(target, get_name(m_buffers, read<uint32_t>()));
+                return true;
+            }
+            case ECommand::BufferData:
+            {
+                const GLenum target = read<uint32_t>();
+                const uint64_t size = read<uint64_t>();
+                uint64_t data_size = 0;
+                const void* data = read_blob(data_size);
+                glBufferData(target, size, data, read<uint32_t>());
+                return true;
+            }
+            case ECommand::NamedBufferData:
+            {
+                const GLuint buffer = get_name(m_buffers, read<uint32_t>());
+                const uint64_t size = read<uint64_t>();
+                uint64_t data_size = 0;
+                const void* data = read_blob(data_size);
+                glNamedBufferData(buffer, size, data, read<uint32_t>());
+                return true;
+            }
+            case ECommand::NamedBufferSubData:
+            {
+                const GLuint buffer = get_name(m_buffers, read<uint32_t>());
+                const uint64_t offset = read<uint64_t>();
+                uint64_t size = 0;
+                const void* data = read_blob(size);
+                glNamedBufferSubData(buffer, offset, size, data);
+                return true;
+            }
+            case ECommand::BindBufferBase:
+            {
+                const GLenum target = read<uint32_t>();
+                const GLuint index = read<uint32_t>();
+                glBindBufferBase(target, index, get_name(m_buffers, read<uint32_t>()));
+                return true;
+            }
+
+            case ECommand::CreateTextures:
+            {
+                const GLenum target = read<uint32_t>();
+                for (const uint32_t name : read_names())
+                {
+                    GLuint texture = 0;
+                    glCreateTextures(target, 1, &texture);
+                    m_textures[name] = texture;
+                }
+                return true;
+            }
+            case ECommand::DeleteTextures:
+            {
+                for (const uint32_t name : read_names())
+                {
+                    const GLuint texture = get_name(m_textures, name);
+                    glDeleteTextures(1, &texture);
+                    m_textures.erase(name);
+                }
+                return true;
+            }
+            case ECommand::TextureStorage2D:
+            {
+                const GLuint texture = get_name(m_textures, read<uint32_t>());
+                const GLsizei levels = read<int32_t>();
+                const GLenum internal_format = read<uint32_t>();
+                const GLsizei width = read<int32_t>();
+                glTextureStorage2D(texture, levels, internal_format, width, read<int32_t>());
+                return true;
+            }
+            case ECommand::TextureStorage3D:
+            {
+                const GLuint texture = get_name(m_textures, read<uint32_t>());
+                const GLsizei levels = read<int32_t>();
+                const GLenum internal_format = read<uint32_t>();
+                const GLsizei width = read<int32_t>();
+                const GLsizei height = read<int32_t>();
+                glTextureStorage3D(texture, levels, internal_format, width, height, read<int32_t>());
+                return true;
+            }
+            case ECommand::TextureSubImage2D:
+            {
+                const GLuint texture = get_name(m_textures, read<uint32_t>());
+                const GLint level = read<int32_t>();
+                const GLint x = read<int32_t>();
+                const GLint y = read<int32_t>();
+                const GLsizei width = read<int32_t>();
+                const GLsizei height = read<int32_t>();
+                const GLenum format = read<uint32_t>();
+                const GLenum type = read<uint32_t>();
+                uint64_t size = 0;
+                const void* pixels = read_blob(size);
+                if (pixels)
+                {
+                    glTextureSubImage2D(texture, level, x, y, width, height, format, type, pixels);
+                }
+                return true;
+            }
+            case ECommand::TextureSubImage3D:
+            {
+                const GLuint texture = get_name(m_textures, read<uint32_t>());
+                const GLint level = read<int32_t>();
+                const GLint x = read<int32_t>();
+                const GLint y = read<int32_t>();
+                const GLint z = read<int32_t>();
+                const GLsizei width = read<int32_t>();
+                const GLsizei height = read<int32_t>();
+                const GLsizei depth = read<int32_t>();
+                const GLenum format = read<uint32_t>();
+                const GLenum type = read<uint32_t>();
+                uint64_t size = 0;
+                const void* pixels = read_blob(size);
+                if (pixels)
+                {
+                    glTextureSubImage3D(texture, level, x, y, z, width, height, depth, format, type, pixels);
+                }
+                return true;
+            }
+            case ECommand::TextureParameteri:
+            {
+                const GLuint texture = get_name(m_textures, read<uint32_t>());
+                const GLenum pname = read<uint32_t>();
+                glTextureParameteri(texture, pname, read<int32_t>());
+                return true;
+            }
+            case ECommand::GenerateTextureMipmap:
+            {
+                glGenerateTextureMipmap(get_name(m_textures, read<uint32_t>()));
+                return true;
+            }
+            case ECommand::BindTextureUnit:
+            {
+                const GLuint unit = read<uint32_t>();
+                glBindTextureUnit(unit, get_name(m_textures, read<uint32_t>()));
+                return true;
+            }
+            case ECommand::CopyImageSubData:
+            {
+                GLint source[6];
+                GLint destination[6];
+                source[0] = get_name(m_textures, read<uint32_t>());
+                for (int i = 1; i < 6; ++i)
+                {
+                    source[i] = read<int32_t>();
+                }
+                destination[0] = get_name(m_textures, read<uint32_t>());
+                for (int i = 1; i < 6; ++i)
+                {
+                    destination[i] = read<int32_t>();
+                }
+                const GLsizei width = read<int32_t>();
+                const GLsizei height = read<int32_t>();
+                const GLsizei depth = read<int32_t>();
+                glCopyImageSubData(source[0], source[1], source[2], source[3], source[4], source[5],
+                                   destination[0], destination[1], destination[2], destination[3], destination[4], destination[5],
+                                   width, height, depth);
+                return true;
+            }
+
+            case ECommand::GenVertexArrays:
+            {
+                for (const uint32_t name : read_names())
+                {
+                    GLuint vertex_array = 0;
+                    glGenVertexArrays(1, &vertex_array);
+                    m_vertex_arrays[name] = vertex_array;
+                }
+                return true;
+            }
+            case ECommand::DeleteVertexArrays:
+            {
+                for (const uint32_t name : read_names())
+                {
+                    const GLuint vertex_array = get_name(m_vertex_arrays, name);
+                    glDeleteVertexArrays(1, &vertex_array);
+                    m_vertex_arrays.erase(name);
+                }
+                return true;
+            }
+            case ECommand::BindVertexArray:
+            {
+                glBindVertexArray(get_name(m_vertex_arrays, read<uint32_t>()));
+                return true;
+            }
+            case ECommand::EnableVertexAttribArray:
+            {
+                glEnableVertexAttribArray(read<uint32_t>());
+                return true;
+            }
+            case ECommand::BindVertexBuffer:
+            {
+                const GLuint binding = read<uint32_t>();
+                const GLuint buffer = get_name(m_buffers, read<uint32_t>());
+                const uint64_t offset = read<uint64_t>();
+                glBindVertexBuffer(binding, buffer, offset, read<int32_t>());
+                return true;
+            }
+            case ECommand::VertexAttribFormat:
+            {
+                const GLuint attribute = read<uint32_t>();
+                const GLint size = read<int32_t>();
+                const GLenum type = read<uint32_t>();
+                const GLboolean normalized = static_cast<GLboolean>(read<uint32_t>());
+                glVertexAttribFormat(attribute, size, type, normalized, read<uint32_t>());
+                return true;
+            }
+            case ECommand::VertexAttribBinding:
+            {
+                const GLuint attribute = read<uint32_t>();
+                glVertexAttribBinding(attribute, read<uint32_t>());
+                return true;
+            }
+
+            case ECommand::CreateShader:
+            {
+                const GLenum type = read<uint32_t>();
+                m_shaders[read<uint32_t>()] = glCreateShader(type);
+                return true;
+            }
+            case ECommand::ShaderSource:
+            {
+                const GLuint shader = get_name(m_shaders, read<uint32_t>());
+                uint64_t size = 0;
+                const GLchar* source = static_cast<const GLchar*>(read_blob(size));
+                const GLint length = static_cast<GLint>(size);
+                glShaderSource(shader, 1, &source, &length);
+                return true;
+            }
+            case ECommand::CompileShader:
+            {
+                glCompileShader(get_name(m_shaders, read<uint32_t>()));
+                return true;
+            }
+            case ECommand::DeleteShader:
+            {
+                const uint32_t name = read<uint32_t>();
+                glDeleteShader(get_name(m_shaders, name));
+                m_shaders.erase(name);
+                return true;
+            }
+            case ECommand::CreateProgram:
+            {
+                m_programs[read<uint32_t>()] = glCreateProgram();
+                return true;
+            }
+            case ECommand::AttachShader:
+            case ECommand::DetachShader:
+            {
+                const GLuint program = get_name(m_programs, read<uint32_t>());
+                const GLuint shader = get_name(m_shaders, read<uint32_t>());
+                if (command == ECommand::AttachShader)
+                {
+                    glAttachShader(program, shader);
+                }
+                else
+                {
+                    glDetachShader(program, shader);
+                }
+                return true;
+            }
+            case ECommand::LinkProgram:
+            {
+                const GLuint program = get_name(m_programs, read<uint32_t>());
+                glLinkProgram(program);
+                GLint success = GL_FALSE;
+                glGetProgramiv(program, GL_LINK_STATUS, &success);
+                if (success == GL_FALSE)
+                {
+                    LOG_ERROR("GL replay: a captured program failed to link on this driver");
+                }
+                return true;
+            }
+            case ECommand::DeleteProgram:
+            {
+                const uint32_t name = read<uint32_t>();
+                glDeleteProgram(get_name(m_programs, name));
+                m_programs.erase(name);
+                return true;
+            }
+            case ECommand::UseProgram:
+            {
+                m_current_program = read<uint32_t>();
+                glUseProgram(get_name(m_programs, m_current_program));
+                return true;
+            }
+            case ECommand::GetUniformLocation:
+            {
+                const uint32_t program = read<uint32_t>();
+                uint64_t size = 0;
+                const char* name = static_cast<const char*>(read_blob(size));
+                const int32_t location = read<int32_t>();
+                const std::string uniform_name(name ? name : "", size);
+                m_uniform_locations[{ program, location }] = glGetUniformLocation(get_name(m_programs, program), uniform_name.c_str());
+                return true;
+            }
+            case ECommand::Uniform1i:
+            {
+                const GLint location = get_uniform_location(read<int32_t>());
+                glUniform1i(location, read<int32_t>());
+                return true;
+            }
+            case ECommand::Uniform1f:
+            case ECommand::Uniform2f:
+            case ECommand::Uniform3f:
+            case ECommand::Uniform4f:
+            {
+                const GLint location = get_uniform_location(read<int32_t>());
+                const int count = 1 + static_cast<int>(command) - static_cast<int>(ECommand::Uniform1f);
+                GLfloat values[4] = {};
+                for (int i = 0; i < count; ++i)
+                {
+                    values[i] = read<float>();
+                }
+                switch (count)
+                {
+                    case 1: glUniform1f(location, values[0]); break;
+                    case 2: glUniform2f(location, values[0], values[1]); break;
+                    case 3: glUniform3f(location, values[0], values[1], values[2]); break;
+                    case 4: glUniform4f(location, values[0], values[1], values[2], values[3]); break;
+                }
+                return true;
+            }
+            case ECommand::UniformMatrix3fv:
+            case ECommand::UniformMatrix4fv:
+            {
+                const GLint location = get_uniform_location(read<int32_t>());
+                const GLsizei count = read<int32_t>();
+                const GLboolean transpose = static_cast<GLboolean>(read<uint32_t>());
+                const size_t matrix_size = command == ECommand::UniformMatrix3fv ? 9 : 16;
+                std::vector<GLfloat> values(matrix_size * std::max(count, 0));
+                for (GLfloat& value : values)
+                {
+                    value = read<float>();
+                }
+                if (command == ECommand::UniformMatrix3fv)
+                {
+                    glUniformMatrix3fv(location, count, transpose, values.data());
+                }
+                else
+                {
+                    glUniformMatrix4fv(location, count, transpose, values.data());
+                }
+                return true;
+            }
+
+            case ECommand::CreateFramebuffers:
+            {
+                for (const uint32_t name : read_names())
+                {
+                    GLuint framebuffer = 0;
+                    glCreateFramebuffers(1, &framebuffer);
+                    m_framebuffers[name] = framebuffer;
+                }
+                return true;
+            }
+            case ECommand::DeleteFramebuffers:
+            {
+                for (const uint32_t name : read_names())
+                {
+                    const GLuint framebuffer = get_name(m_framebuffers, name);
+                    glDeleteFramebuffers(1, &framebuffer);
+                    m_framebuffers.erase(name);
+                }
+                return true;
+            }
+            case ECommand::BindFramebuffer:
+            {
+                const GLenum target = read<uint32_t>();
+                glBindFramebuffer(target, get_framebuffer(read<uint32_t>()));
+                return true;
+            }
+            case ECommand::NamedFramebufferTexture:
+            {
+                const GLuint framebuffer = get_framebuffer(read<uint32_t>());
+                const GLenum attachment = read<uint32_t>();
+                const GLuint texture = get_name(m_textures, read<uint32_t>());
+                glNamedFramebufferTexture(framebuffer, attachment, texture, read<int32_t>());
+                return true;
+            }
+            case ECommand::NamedFramebufferDrawBuffer:
+            {
+                const GLuint framebuffer = get_framebuffer(read<uint32_t>());
+                glNamedFramebufferDrawBuffer(framebuffer, read<uint32_t>());
+                return true;
+            }
+            case ECommand::NamedFramebufferDrawBuffers:
+            {
+                const GLuint framebuffer = get_framebuffer(read<uint32_t>());
+                const std::vector<unsigned int> buffers = read_names();
+                glNamedFramebufferDrawBuffers(framebuffer, static_cast<GLsizei>(buffers.size()), buffers.data());
+                return true;
+            }
+            case ECommand::NamedFramebufferReadBuffer:
+            {
+                const GLuint framebuffer = get_framebuffer(read<uint32_t>());
+                glNamedFramebufferReadBuffer(framebuffer, read<uint32_t>());
+                return true;
+            }
+            case ECommand::BlitNamedFramebuffer:
+            {
+                const GLuint read_framebuffer = get_framebuffer(read<uint32_t>());
+                const GLuint draw_framebuffer = get_framebuffer(read<uint32_t>());
+                GLint rectangles[8];
+                for (GLint& value : rectangles)
+                {
+                    value = read<int32_t>();
+                }
+                const GLbitfield mask = read<uint32_t>();
+                glBlitNamedFramebuffer(read_framebuffer, draw_framebuffer, rectangles[0], rectangles[1], rectangles[2], rectangles[3],
+                                       rectangles[4], rectangles[5], rectangles[6], rectangles[7], mask, read<uint32_t>());
+                return true;
+            }
+
+            case ECommand::CreateQueries:
+            {
+                const GLenum target = read<uint32_t>();
+                for (const uint32_t name : read_names())
+                {
+                    GLuint query = 0;
+                    glCreateQueries(target, 1, &query);
+                    m_queries[name] = query;
+                }
+                return true;
+            }
+            case ECommand::DeleteQueries:
+            {
+                for (const uint32_t name : read_names())
+                {
+                    const GLuint query = get_name(m_queries, name);
+                    glDeleteQueries(1, &query);
+                    m_queries.erase(name);
+                    m_issued_queries.erase(name);
+                }
+                return true;
+            }
+            case ECommand::QueryCounter:
+            {
+                const uint32_t name = read<uint32_t>();
+                glQueryCounter(get_name(m_queries, name), read<uint32_t>());
+                m_issued_queries.insert(name);
+                return true;
+            }
+            case ECommand::GetQueryObjectiv:
+            case ECommand::GetQueryObjectui64v:
+            {
+                const uint32_t name = read<uint32_t>();
+                const GLenum pname = read<uint32_t>();
+                if (m_issued_queries.count(name) == 0)
+                {
+                    return true;
+                }
+                if (command == ECommand::GetQueryObjectiv)
+                {
+                    GLint value = 0;
+                    glGetQueryObjectiv(get_name(m_queries, name), pname, &value);
+                }
+                else
+                {
+                    GLuint64 value = 0;
+                    glGetQueryObjectui64v(get_name(m_queries, name), pname, &value);
+                }
+                return true;
+            }
+
+            case ECommand::Enable:
+            {
+                glEnable(read<uint32_t>());
+                return true;
+            }
+            case ECommand::Disable:
+            {
+                glDisable(read<uint32_t>());
+                return true;
+            }
+            case ECommand::Viewport:
+            case ECommand::Scissor:
+            {
+                GLint rectangle[4];
+                for (GLint& value : rectangle)
+                {
+                    value = read<int32_t>();
+                }
+                if (command == ECommand::Viewport)
+                {
+                    glViewport(rectangle[0], rectangle[1], rectangle[2], rectangle[3]);
+                }
+                else
+                {
+                    glScissor(rectangle[0], rectangle[1], rectangle[2], rectangle[3]);
+                }
+                return true;
+            }
+            case ECommand::ClearColor:
+            {
+                GLfloat color[4];
+                for (GLfloat& value : color)
+                {
+                    value = read<float>();
+                }
+                glClearColor(color[0], color[1], color[2], color[3]);
+                return true;
+            }
+            case ECommand::Clear:
+            {
+                glClear(read<uint32_t>());
+                return true;
+            }
+            case ECommand::PolygonOffset:
+            {
+                const GLfloat factor = read<float>();
+                glPolygonOffset(factor, read<float>());
+                return true;
+            }
+            case ECommand::Finish:
+            {
+                glFinish();
+                return true;
+            }
+            case ECommand::DrawElements:
+            {
+                const GLenum mode = read<uint32_t>();
+                const GLsizei count = read<int32_t>();
+                const GLenum type = read<uint32_t>();
+                const uint64_t offset = read<uint64_t>();
+                glDrawElements(mode, count, type, reinterpret_cast<const void*>(static_cast<uintptr_t>(offset)));
+                return true;
+            }
+            case ECommand::DrawArrays:
+            {
+                const GLenum mode = read<uint32_t>();
+                const GLint first = read<int32_t>();
+                glDrawArrays(mode, first, read<int32_t>());
+                return true;
+            }
+
+            case ECommand::StateEnd:
+            case ECommand::FrameEnd:
+            case ECommand::Count:
+                break;
+        }
+        return false;
+    }
+
+
+    bool GLReplayer::run_until(const ECommand end, uint64_t* timestamp_ns)
+    {
+        while (m_position < m_stream.size())
+        {
+            const uint16_t value = read<uint16_t>();
+            const ECommand command = static_cast<ECommand>(value);
+            if (command == end)
+            {
+                const uint64_t timestamp = command == ECommand::FrameEnd ? read<uint64_t>() : 0;
+                if (timestamp_ns)
+                {
+                    *timestamp_ns = timestamp;
+                }
+                return !m_is_truncated;
+            }
+            if (value >= static_cast<uint16_t>(ECommand::Count) || !execute(command) || m_is_truncated)
+            {
+                LOG_CRITICAL("GL replay: bad command {0} at byte {1}", value, m_position);
+                return false;
+            }
+        }
+        return false;
+    }
+
+
+    bool GLReplayer::replay(const Settings& settings, Stats& stats)
+    {
+        using clock = std::chrono::steady_clock;
+        const auto to_ms = [](const clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+        m_pDefaultFramebuffer = std::make_unique<Framebuffer>(m_header.width, m_header.height, std::initializer_list<Framebuffer::EFormat>{ Framebuffer::EFormat::RGBA8 });
+        m_pDefaultFramebuffer->set_as_default();
+        m_position = sizeof(m_header);
+        m_is_truncated = false;
+
+        const clock::time_point setup_start = clock::now();
+        if (!run_until(ECommand::StateEnd, nullptr))
+        {
+            LOG_CRITICAL("GL replay: the initial state is incomplete");
+            return false;
+        }
+        glFinish();
+        stats.setup_time_ms = to_ms(clock::now() - setup_start);
+
+        const size_t frames_position = m_position;
+        std::vector<double> submit_times_ms;
+        std::vector<double> frame_times_ms;
+        const clock::time_point replay_start = clock::now();
+        for (uint32_t loop = 0; loop < std::max(settings.loops, 1u); ++loop)
+        {
+            m_position = frames_position;
+            const clock::time_point loop_start = clock::now();
+            for (uint32_t frame = 0; frame < m_header.frames_count; ++frame)
+            {
+                const clock::time_point frame_start = clock::now();
+                uint64_t timestamp_ns = 0;
+                if (!run_until(ECommand::FrameEnd, &timestamp_ns))
+                {
+                    LOG_CRITICAL("GL replay: frame {0} is incomplete", frame);
+                    return false;
+                }
+                const clock::time_point submit_end = clock::now();
+                glFinish();
+                const clock::time_point frame_end = clock::now();
+                submit_times_ms.push_back(to_ms(submit_end - frame_start));
+                frame_times_ms.push_back(to_ms(frame_end - frame_start));
+
+                if (settings.paced)
+                {
+                    std::this_thread::sleep_until(loop_start + std::chrono::nanoseconds(timestamp_ns));
+                }
+            }
+        }
+        stats.total_time_ms = to_ms(clock::now() - replay_start);
+        stats.frames_count = static_cast<uint32_t>(frame_times_ms.size());
+        stats.submit_times = FrameTimeHarness::make_distribution(std::move(submit_times_ms), 2.0);
+        stats.frame_times = FrameTimeHarness::make_distribution(std::move(frame_times_ms), 2.0);
+        return true;
+    }
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "GLCaptureFormat.hpp"
+#include "SimpleEngineCore/FrameTimeHarness.hpp"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+    class Framebuffer;
+
+    // Plays back a file written by GLCapture on the current GL context, without the engine or the scene:
+    // only the recorded GL calls run, which isolates driver and GPU cost from engine CPU cost.
+    // Framebuffer 0 of the captured process becomes an offscreen framebuffer of the captured size.
+    class GLReplayer
+    {
+    public:
+        struct Settings
+        {
+            // waits until each frame's original timestamp instead of replaying as fast as possible
+            bool paced = false;
+            // the frames are replayed this many times, on top of the state the previous loop left
+            uint32_t loops = 1;
+        };
+
+        struct Stats
+        {
+            uint32_t frames_count = 0;
+            // recreating the objects alive when the capture started
+            double setup_time_ms = 0.0;
+            double total_time_ms = 0.0;
+            // CPU time issuing each frame's calls
+            FrameTimeHarness::Distribution submit_times;
+            // the same plus waiting for the GPU to finish the frame
+            FrameTimeHarness::Distribution frame_times;
+        };
+
+        GLReplayer();
+        ~GLReplayer();
+
+        GLReplayer(const GLReplayer&) = delete;
+        GLReplayer& operator=(const GLReplayer&) = delete;
+
+        bool load(const std::string& path);
+
+        unsigned int get_width() const { return m_header.width; }
+        unsigned int get_height() const { return m_header.height; }
+        uint32_t get_frames_count() const { return m_header.frames_count; }
+
+        // needs a current context with glad loaded
+        bool replay(const Settings& settings, Stats& stats);
+
+    private:
+        using ECommand = GLCaptureFormat::ECommand;
+        using NameMap = std::unordered_map<uint32_t, unsigned int>;
+
+        template<typename T>
+        T read();
+        const void* read_blob(uint64_t& size);
+        std::vector<unsigned int> read_names();
+
+        // executes commands up to the first `end` command, false at the end of the stream or on a bad command
+        bool run_until(const ECommand end, uint64_t* timestamp_ns);
+        bool execute(const ECommand command);
+
+        static unsigned int get_name(const NameMap& names, const uint32_t name);
+        unsigned int get_framebuffer(const uint32_t name) const;
+        int get_uniform_location(const int32_t location) const;
+
+        GLCaptureFormat::Header m_header{};
+        std::vector<uint8_t> m_stream;
+        size_t m_position = 0;
+        bool m_is_truncated = false;
+
+        NameMap m_buffers;
+        NameMap m_textures;
+        NameMap m_vertex_arrays;
+        NameMap m_shaders;
+        NameMap m_programs;
+        NameMap m_framebuffers;
+        NameMap m_queries;
+        // queries read before they were issued in the replay (the capture started between issue and read)
+        std::unordered_set<uint32_t> m_issued_queries;
+        // (captured program, captured location) -> location in the replayed program
+        std::map<std::pair<uint32_t, int32_t>, int> m_uniform_locations;
+        uint32_t m_current_program = 0;
+
+        std::unique_ptr<Framebuffer> m_pDefaultFramebuffer;
+    };
+
+}
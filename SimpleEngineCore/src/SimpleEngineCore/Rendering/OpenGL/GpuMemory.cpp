@@ -0,0 +1,341 @@
+#include "SimpleEngineCore/GpuMemory.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+
+// not every glad profile carries the vendor extensions
+#ifndef GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX
+#define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX   0x9048
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#define GL_GPU_MEMORY_INFO_EVICTION_COUNT_NVX           0x904A
+#define GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX           0x904B
+#endif
+#ifndef GL_TEXTURE_FREE_MEMORY_ATI
+#define GL_TEXTURE_FREE_MEMORY_ATI                      0x87FC
+#endif
+
+namespace SimpleEngine {
+
+    constexpr size_t categories_count = static_cast<size_t>(EGpuMemoryCategory::Count);
+
+    const char* get_gpu_memory_category_name(const EGpuMemoryCategory category)
+    {
+        static const char* names[categories_count] = { "Vertex buffers", "Index buffers", "Storage buffers", "Textures", "Render targets", "Shadow maps", "Readback" };
+        return category < EGpuMemoryCategory::Count ? names[static_cast<size_t>(category)] : "Unknown";
+    }
+
+    struct GpuResource
+    {
+        GpuMemory::ResourceInfo info;
+        GpuMemory::EvictCallback evict_callback = nullptr;
+        void* pEvictContext = nullptr;
+        bool registered = false;
+    };
+
+    struct GpuMemoryState
+    {
+        // slot i is ResourceId i + 1
+        std::vector<GpuResource> resources;
+        std::vector<GpuMemory::ResourceId> free_ids;
+        GpuMemory::Stats stats;
+        uint64_t frame_index = 0;
+        bool over_budget_reported = false;
+        std::vector<GpuMemory::ResourceId> eviction_candidates;
+
+        enum class EDriverExtension { Unknown, None, NVX, ATI };
+        EDriverExtension driver_extension = EDriverExtension::Unknown;
+    };
+
+    // never destroyed: GL objects held by statics unregister during exit
+    static GpuMemoryState& get_state()
+    {
+        static GpuMemoryState* pState = new GpuMemoryState();
+        return *pState;
+    }
+
+    static GpuResource* find_resource(const GpuMemory::ResourceId id)
+    {
+        GpuMemoryState& state = get_state();
+        if (id == GpuMemory::invalid_resource || id > state.resources.size() || !state.resources[id - 1].registered)
+        {
+            return nullptr;
+        }
+        return &state.resources[id - 1];
+    }
+
+    static void add_bytes(const EGpuMemoryCategory category, const uint64_t bytes)
+    {
+        GpuMemory::Stats& stats = get_state().stats;
+        GpuMemory::CategoryStats& category_stats = stats.categories[static_cast<size_t>(category)];
+        category_stats.bytes += bytes;
+        category_stats.peak_bytes = std::max(category_stats.peak_bytes, category_stats.bytes);
+        stats.total_bytes += bytes;
+        stats.peak_total_bytes = std::max(stats.peak_total_bytes, stats.total_bytes);
+    }
+
+    static void remove_bytes(const EGpuMemoryCategory category, const uint64_t bytes)
+    {
+        GpuMemory::Stats& stats = get_state().stats;
+        stats.categories[static_cast<size_t>(category)].bytes -= bytes;
+        stats.total_bytes -= bytes;
+    }
+
+    GpuMemory::ResourceId GpuMemory::register_resource(const EGpuMemoryCategory category, const uint64_t bytes, const char* name)
+    {
+        GpuMemoryState& state = get_state();
+        ResourceId id = invalid_resource;
+        if (!state.free_ids.empty())
+        {
+            id = state.free_ids.back();
+            state.free_ids.pop_back();
+        }
+        else
+        {
+            state.resources.emplace_back();
+            id = static_cast<ResourceId>(state.resources.size());
+        }
+
+        GpuResource& resource = state.resources[id - 1];
+        resource = GpuResource();
+        resource.info.name = name;
+        resource.info.category = category;
+        resource.info.bytes = bytes;
+        resource.info.last_used_frame = state.frame_index;
+        resource.registered = true;
+        ++state.stats.categories[static_cast<size_t>(category)].resources_count;
+        add_bytes(category, bytes);
+        return id;
+    }
+
+    void GpuMemory::resize_resource(const ResourceId id, const uint64_t bytes)
+    {
+        GpuResource* pResource = find_resource(id);
+        if (!pResource)
+        {
+            return;
+        }
+        remove_bytes(pResource->info.category, pResource->info.bytes);
+        pResource->info.bytes = bytes;
+        add_bytes(pResource->info.category, bytes);
+    }
+
+    void GpuMemory::unregister_resource(const ResourceId id)
+    {
+        GpuResource* pResource = find_resource(id);
+        if (!pResource)
+        {
+            return;
+        }
+        GpuMemoryState& state = get_state();
+        remove_bytes(pResource->info.category, pResource->info.bytes);
+        --state.stats.categories[static_cast<size_t>(pResource->info.category)].resources_count;
+        pResource->registered = false;
+        state.free_ids.push_back(id);
+    }
+
+    void GpuMemory::set_evict_callback(const ResourceId id, const EvictCallback callback, void* pContext)
+    {
+        GpuResource* pResource = find_resource(id);
+        if (!pResource)
+        {
+            return;
+        }
+        pResource->evict_callback = callback;
+        pResource->pEvictContext = pContext;
+        pResource->info.streamable = callback != nullptr;
+    }
+
+    void GpuMemory::touch(const ResourceId id)
+    {
+        GpuResource* pResource = find_resource(id);
+        if (pResource)
+        {
+            pResource->info.last_used_frame = get_state().frame_index;
+        }
+    }
+
+    void GpuMemory::set_budget(const uint64_t bytes)
+    {
+        GpuMemoryState& state = get_state();
+        state.stats.budget_bytes = bytes;
+        state.over_budget_reported = false;
+    }
+
+    uint64_t GpuMemory::get_budget()
+    {
+        return get_state().stats.budget_bytes;
+    }
+
+    void GpuMemory::new_frame()
+    {
+        GpuMemoryState& state = get_state();
+        ++state.frame_index;
+        const uint64_t budget = state.stats.budget_bytes;
+        if (budget == 0 || state.stats.total_bytes <= budget)
+        {
+            state.over_budget_reported = false;
+            return;
+        }
+
+        // resources used this frame or the last one are still needed, evicting them would only thrash
+        state.eviction_candidates.clear();
+        for (size_t i = 0; i < state.resources.size(); ++i)
+        {
+            const GpuResource& resource = state.resources[i];
+            if (resource.registered && resource.evict_callback && resource.info.last_used_frame + 1 < state.frame_index)
+            {
+                state.eviction_candidates.push_back(static_cast<ResourceId>(i + 1));
+            }
+        }
+        std::sort(state.eviction_candidates.begin(), state.eviction_candidates.end(), [&](const ResourceId a, const ResourceId b)
+            {
+                return state.resources[a - 1].info.last_used_frame < state.resources[b - 1].info.last_used_frame;
+            });
+
+        for (const ResourceId id : state.eviction_candidates)
+        {
+            if (state.stats.total_bytes <= budget)
+            {
+                break;
+            }
+            // a callback may register or unregister resources, so the slot is looked up again every time
+            const GpuResource* pResource = find_resource(id);
+            if (!pResource || !pResource->evict_callback)
+            {
+                continue;
+            }
+            const size_t freed_bytes = pResource->evict_callback(pResource->pEvictContext, static_cast<size_t>(state.stats.total_bytes - budget));
+            if (freed_bytes > 0)
+            {
+                state.stats.evicted_bytes += freed_bytes;
+                ++state.stats.evictions_count;
+            }
+        }
+
+        if (state.stats.total_bytes > budget && !state.over_budget_reported)
+        {
+            LOG_WARN("GPU memory: {0} MB in use over a {1} MB budget, nothing left to evict", state.stats.total_bytes >> 20, budget >> 20);
+            state.over_budget_reported = true;
+        }
+    }
+
+    GpuMemory::Stats GpuMemory::get_stats()
+    {
+        return get_state().stats;
+    }
+
+    void GpuMemory::get_resources(std::vector<ResourceInfo>& resources)
+    {
+        resources.clear();
+        for (const GpuResource& resource : get_state().resources)
+        {
+            if (resource.registered)
+            {
+                resources.push_back(resource.info);
+            }
+        }
+    }
+
+    static bool has_extension(const char* name)
+    {
+        GLint extensions_count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensions_count);
+        for (GLint i = 0; i < extensions_count; ++i)
+        {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+            if (extension && std::strcmp(extension, name) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    GpuMemory::DriverInfo GpuMemory::query_driver_memory()
+    {
+        GpuMemoryState& state = get_state();
+        using EDriverExtension = GpuMemoryState::EDriverExtension;
+        if (state.driver_extension == EDriverExtension::Unknown)
+        {
+            state.driver_extension = has_extension("GL_NVX_gpu_memory_info") ? EDriverExtension::NVX
+                : has_extension("GL_ATI_meminfo") ? EDriverExtension::ATI
+                : EDriverExtension::None;
+        }
+
+        // both extensions report kilobytes
+        DriverInfo info;
+        if (state.driver_extension == EDriverExtension::NVX)
+        {
+            GLint total_kb = 0;
+            GLint available_kb = 0;
+            GLint evicted_kb = 0;
+            GLint evictions_count = 0;
+            glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total_kb);
+            glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available_kb);
+            glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX, &evicted_kb);
+            glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTION_COUNT_NVX, &evictions_count);
+            info.available = true;
+            info.extension = "GL_NVX_gpu_memory_info";
+            info.total_bytes = static_cast<uint64_t>(total_kb) * 1024;
+            info.available_bytes = static_cast<uint64_t>(available_kb) * 1024;
+            info.evicted_bytes = static_cast<uint64_t>(evicted_kb) * 1024;
+            info.evictions_count = static_cast<uint64_t>(evictions_count);
+        }
+        else if (state.driver_extension == EDriverExtension::ATI)
+        {
+            // free memory of the texture pool, largest free block, free auxiliary memory, largest auxiliary block
+            GLint free_kb[4] = {};
+            glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, free_kb);
+            info.available = true;
+            info.extension = "GL_ATI_meminfo";
+            info.available_bytes = static_cast<uint64_t>(free_kb[0]) * 1024;
+        }
+        return info;
+    }
+
+    static uint64_t get_texel_bytes(const unsigned int internal_format)
+    {
+        switch (internal_format)
+        {
+            case GL_R8:                 return 1;
+            case GL_RG8:
+            case GL_R16F:               return 2;
+            // three component formats are padded to four by every driver
+            case GL_RGB8:
+            case GL_RGBA8:
+            case GL_SRGB8_ALPHA8:
+            case GL_R32F:
+            case GL_RG16F:
+            case GL_RG16_SNORM:
+            case GL_R11F_G11F_B10F:
+            case GL_DEPTH24_STENCIL8:
+            case GL_DEPTH_COMPONENT24:
+            case GL_DEPTH_COMPONENT32F: return 4;
+            case GL_RGB16F:
+            case GL_RGBA16F:
+            case GL_RG32F:              return 8;
+            case GL_RGB32F:
+            case GL_RGBA32F:            return 16;
+        }
+        return 4;
+    }
+
+    uint64_t GpuMemory::get_texture_bytes(const unsigned int internal_format, const unsigned int width, const unsigned int height,
+                                          const unsigned int depth, const unsigned int mip_levels)
+    {
+        const uint64_t texel_bytes = get_texel_bytes(internal_format);
+        uint64_t bytes = 0;
+        for (unsigned int level = 0; level < std::max(mip_levels, 1u); ++level)
+        {
+            const uint64_t level_width = std::max(width >> level, 1u);
+            const uint64_t level_height = std::max(height >> level, 1u);
+            const uint64_t level_depth = std::max(depth >> level, 1u);
+            bytes += level_width * level_height * level_depth * texel_bytes;
+        }
+        return bytes;
+    }
+
+}
@@ -0,0 +1,150 @@
+#include "GpuProfiler.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace SimpleEngine {
+
+    constexpr uint32_t no_scope = ~0u;
+
+    struct GpuScope
+    {
+        const char* name = nullptr;
+        uint32_t begin_query = 0;
+        uint32_t end_query = 0;
+        uint32_t depth = 0;
+    };
+
+    struct GpuFramePool
+    {
+        std::array<GLuint, 2 * GpuProfiler::max_scopes_per_frame> queries{};
+        std::vector<GpuScope> scopes;
+        uint32_t used_queries_count = 0;
+        uint64_t frame_index = 0;
+        // CPU minus GPU clock when the frame started
+        int64_t clock_offset_ns = 0;
+        bool pending = false;
+    };
+
+    struct GpuProfilerState
+    {
+        std::array<GpuFramePool, GpuProfiler::frames_in_flight> pools;
+        size_t current_pool = 0;
+        std::vector<uint32_t> open_scopes;
+        std::vector<Profiler::Event> events;
+        bool initialized = false;
+    };
+
+    static GpuProfilerState s_gpu_profiler;
+
+    static void resolve_pool(GpuFramePool& pool)
+    {
+        s_gpu_profiler.events.clear();
+        for (const GpuScope& scope : pool.scopes)
+        {
+            if (scope.end_query == no_scope)
+            {
+                continue;
+            }
+            GLuint64 begin_ns = 0;
+            GLuint64 end_ns = 0;
+            glGetQueryObjectui64v(pool.queries[scope.begin_query], GL_QUERY_RESULT, &begin_ns);
+            glGetQueryObjectui64v(pool.queries[scope.end_query], GL_QUERY_RESULT, &end_ns);
+
+            Profiler::Event event;
+            event.name = scope.name;
+            event.start_ns = static_cast<uint64_t>(std::max<int64_t>(static_cast<int64_t>(begin_ns) + pool.clock_offset_ns, 0));
+            event.end_ns = static_cast<uint64_t>(std::max<int64_t>(static_cast<int64_t>(end_ns) + pool.clock_offset_ns, 0));
+            event.depth = scope.depth;
+            event.thread = Profiler::gpu_thread;
+            s_gpu_profiler.events.push_back(event);
+        }
+        Profiler::add_gpu_events(pool.frame_index, s_gpu_profiler.events);
+        pool.pending = false;
+    }
+
+    void GpuProfiler::init()
+    {
+        for (GpuFramePool& pool : s_gpu_profiler.pools)
+        {
+            glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(pool.queries.size()), pool.queries.data());
+            pool.scopes.reserve(max_scopes_per_frame);
+        }
+        s_gpu_profiler.initialized = true;
+    }
+
+    void GpuProfiler::shutdown()
+    {
+        for (GpuFramePool& pool : s_gpu_profiler.pools)
+        {
+            glDeleteQueries(static_cast<GLsizei>(pool.queries.size()), pool.queries.data());
+            pool.scopes.clear();
+            pool.pending = false;
+        }
+        s_gpu_profiler.open_scopes.clear();
+        s_gpu_profiler.initialized = false;
+    }
+
+    void GpuProfiler::new_frame()
+    {
+        if (!s_gpu_profiler.initialized)
+        {
+            return;
+        }
+        s_gpu_profiler.current_pool = (s_gpu_profiler.current_pool + 1) % frames_in_flight;
+        GpuFramePool& pool = s_gpu_profiler.pools[s_gpu_profiler.current_pool];
+        if (pool.pending)
+        {
+            resolve_pool(pool);
+        }
+
+        GLint64 gpu_time_ns = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpu_time_ns);
+        pool.clock_offset_ns = static_cast<int64_t>(Profiler::now_ns()) - gpu_time_ns;
+        pool.frame_index = Profiler::get_frame_index();
+        pool.scopes.clear();
+        pool.used_queries_count = 0;
+        pool.pending = true;
+        s_gpu_profiler.open_scopes.clear();
+    }
+
+    void GpuProfiler::begin_scope(const char* name)
+    {
+        GpuFramePool& pool = s_gpu_profiler.pools[s_gpu_profiler.current_pool];
+        // a full pool still tracks nesting so the matching end_scope pops the right entry
+        if (!pool.pending || pool.used_queries_count + 2 > pool.queries.size())
+        {
+            s_gpu_profiler.open_scopes.push_back(no_scope);
+            return;
+        }
+        GpuScope scope;
+        scope.name = name;
+        scope.begin_query = pool.used_queries_count++;
+        scope.end_query = no_scope;
+        scope.depth = static_cast<uint32_t>(s_gpu_profiler.open_scopes.size());
+        glQueryCounter(pool.queries[scope.begin_query], GL_TIMESTAMP);
+        s_gpu_profiler.open_scopes.push_back(static_cast<uint32_t>(pool.scopes.size()));
+        pool.scopes.push_back(scope);
+    }
+
+    void GpuProfiler::end_scope()
+    {
+        if (s_gpu_profiler.open_scopes.empty())
+        {
+            return;
+        }
+        const uint32_t scope_index = s_gpu_profiler.open_scopes.back();
+        s_gpu_profiler.open_scopes.pop_back();
+        if (scope_index == no_scope)
+        {
+            return;
+        }
+        GpuFramePool& pool = s_gpu_profiler.pools[s_gpu_profiler.current_pool];
+        GpuScope& scope = pool.scopes[scope_index];
+        scope.end_query = pool.used_queries_count++;
+        glQueryCounter(pool.queries[scope.end_query], GL_TIMESTAMP);
+    }
+}
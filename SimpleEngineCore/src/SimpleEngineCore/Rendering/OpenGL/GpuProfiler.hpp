@@ -0,0 +1,47 @@
+#pragma once
+
+#include "SimpleEngineCore/Profiler.hpp"
+
+namespace SimpleEngine {
+
+    // GPU side of the Profiler: every scope writes GL_TIMESTAMP queries from a per-frame pool.
+    // A pool is read back when it comes around again, frames_in_flight frames later, so the CPU only
+    // waits when the GPU falls further behind than that.
+    class GpuProfiler
+    {
+    public:
+        static constexpr size_t frames_in_flight = 4;
+        static constexpr size_t max_scopes_per_frame = 128;
+
+        // needs the GL context
+        static void init();
+        static void shutdown();
+
+        static void new_frame();
+        static void begin_scope(const char* name);
+        static void end_scope();
+    };
+
+    class GpuProfileScope
+    {
+    public:
+        explicit GpuProfileScope(const char* name) { GpuProfiler::begin_scope(name); }
+        ~GpuProfileScope() { GpuProfiler::end_scope(); }
+
+        GpuProfileScope(const GpuProfileScope&) = delete;
+        GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+    };
+
+}
+
+#ifdef SIMPLE_ENGINE_PROFILING
+
+#define PROFILE_GPU_SCOPE(name)     ::SimpleEngine::GpuProfileScope SIMPLE_ENGINE_PROFILE_CONCAT(profile_gpu_scope_, __LINE__)(name)
+#define PROFILE_GPU_FRAME()         ::SimpleEngine::GpuProfiler::new_frame()
+
+#else
+
+#define PROFILE_GPU_SCOPE(name)
+#define PROFILE_GPU_FRAME()
+
+#endif
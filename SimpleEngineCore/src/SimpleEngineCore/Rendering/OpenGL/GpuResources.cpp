@@ -0,0 +1,119 @@
+#include "GpuResources.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+namespace SimpleEngine {
+
+    // frames the CPU may run ahead of the GPU before end_frame() waits for the oldest one
+    constexpr size_t max_frames_in_flight = 8;
+
+    struct FrameFence
+    {
+        uint64_t frame_index = 0;
+        GLsync fence = nullptr;
+    };
+
+    static FrameFence s_fences[max_frames_in_flight];
+    static size_t s_first_fence = 0;
+    static size_t s_fences_count = 0;
+    static uint64_t s_frame_index = 0;
+    // every frame before it is finished on the GPU
+    static uint64_t s_finished_frames_count = 0;
+
+    static ResourcePool<VertexBuffer> s_vertex_buffers;
+    static ResourcePool<IndexBuffer> s_index_buffers;
+    static ResourcePool<VertexArray> s_vertex_arrays;
+    static ResourcePool<ShaderStorageBuffer> s_shader_storage_buffers;
+    static ResourcePool<ShaderProgram> s_shader_programs;
+    static ResourcePool<Texture2D> s_textures_2d;
+    static ResourcePool<Texture3D> s_textures_3d;
+
+    template<> ResourcePool<VertexBuffer>& GpuResources::get_pool<VertexBuffer>() { return s_vertex_buffers; }
+    template<> ResourcePool<IndexBuffer>& GpuResources::get_pool<IndexBuffer>() { return s_index_buffers; }
+    template<> ResourcePool<VertexArray>& GpuResources::get_pool<VertexArray>() { return s_vertex_arrays; }
+    template<> ResourcePool<ShaderStorageBuffer>& GpuResources::get_pool<ShaderStorageBuffer>() { return s_shader_storage_buffers; }
+    template<> ResourcePool<ShaderProgram>& GpuResources::get_pool<ShaderProgram>() { return s_shader_programs; }
+    template<> ResourcePool<Texture2D>& GpuResources::get_pool<Texture2D>() { return s_textures_2d; }
+    template<> ResourcePool<Texture3D>& GpuResources::get_pool<Texture3D>() { return s_textures_3d; }
+
+    static void release_retired()
+    {
+        s_vertex_buffers.release_retired(s_finished_frames_count);
+        s_index_buffers.release_retired(s_finished_frames_count);
+        s_vertex_arrays.release_retired(s_finished_frames_count);
+        s_shader_storage_buffers.release_retired(s_finished_frames_count);
+        s_shader_programs.release_retired(s_finished_frames_count);
+        s_textures_2d.release_retired(s_finished_frames_count);
+        s_textures_3d.release_retired(s_finished_frames_count);
+    }
+
+    static void pop_fence()
+    {
+        FrameFence& frame_fence = s_fences[s_first_fence];
+        glDeleteSync(frame_fence.fence);
+        frame_fence.fence = nullptr;
+        s_finished_frames_count = frame_fence.frame_index + 1;
+        s_first_fence = (s_first_fence + 1) % max_frames_in_flight;
+        --s_fences_count;
+    }
+
+    void GpuResources::end_frame()
+    {
+        if (s_fences_count == max_frames_in_flight)
+        {
+            LOG_WARN("GpuResources: the GPU is {0} frames behind, waiting for it", max_frames_in_flight);
+            glClientWaitSync(s_fences[s_first_fence].fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            pop_fence();
+        }
+        FrameFence& frame_fence = s_fences[(s_first_fence + s_fences_count) % max_frames_in_flight];
+        frame_fence.frame_index = s_frame_index;
+        frame_fence.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ++s_fences_count;
+        ++s_frame_index;
+    }
+
+    void GpuResources::collect()
+    {
+        while (s_fences_count > 0)
+        {
+            const GLenum status = glClientWaitSync(s_fences[s_first_fence].fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            {
+                break;
+            }
+            pop_fence();
+        }
+        release_retired();
+    }
+
+    void GpuResources::shutdown()
+    {
+        glFinish();
+        while (s_fences_count > 0)
+        {
+            pop_fence();
+        }
+        s_vertex_arrays.clear();
+        s_vertex_buffers.clear();
+        s_index_buffers.clear();
+        s_shader_storage_buffers.clear();
+        s_shader_programs.clear();
+        s_textures_2d.clear();
+        s_textures_3d.clear();
+    }
+
+    uint64_t GpuResources::get_frame_index()
+    {
+        return s_frame_index;
+    }
+
+    size_t GpuResources::get_retired_count()
+    {
+        return s_vertex_buffers.get_retired_count() + s_index_buffers.get_retired_count() + s_vertex_arrays.get_retired_count()
+            + s_shader_storage_buffers.get_retired_count() + s_shader_programs.get_retired_count()
+            + s_textures_2d.get_retired_count() + s_textures_3d.get_retired_count();
+    }
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "ResourcePool.hpp"
+#include "VertexBuffer.hpp"
+#include "IndexBuffer.hpp"
+#include "VertexArray.hpp"
+#include "ShaderStorageBuffer.hpp"
+#include "ShaderProgram.hpp"
+#include "Texture2D.hpp"
+#include "Texture3D.hpp"
+
+namespace SimpleEngine {
+
+    using VertexBufferHandle = Handle<VertexBuffer>;
+    using IndexBufferHandle = Handle<IndexBuffer>;
+    using VertexArrayHandle = Handle<VertexArray>;
+    using ShaderStorageBufferHandle = Handle<ShaderStorageBuffer>;
+    using ShaderProgramHandle = Handle<ShaderProgram>;
+    using Texture2DHandle = Handle<Texture2D>;
+    using Texture3DHandle = Handle<Texture3D>;
+
+    // Owner of the engine's buffers, textures, vertex arrays and programs, one ResourcePool per type.
+    // Destruction is deferred: end_frame() fences every frame and an object destroyed during a frame is only
+    // deleted once collect() sees that frame's fence signaled, when no command still in flight can use it.
+    // GL context thread only.
+    class GpuResources
+    {
+    public:
+        template<typename T, typename... Args>
+        static Handle<T> create(Args&&... args)
+        {
+            return get_pool<T>().create(std::forward<Args>(args)...);
+        }
+
+        // nullptr for a null or destroyed handle
+        template<typename T>
+        static T* get(const Handle<T> handle)
+        {
+            return get_pool<T>().get(handle);
+        }
+
+        // nulls the handle, other copies of it go stale
+        template<typename T>
+        static void destroy(Handle<T>& handle)
+        {
+            get_pool<T>().destroy(handle, get_frame_index());
+            handle = Handle<T>();
+        }
+
+        template<typename T>
+        static ResourcePool<T>& get_pool();
+
+        // after the frame's last command
+        static void end_frame();
+        // deletes what the GPU is done with, never waits
+        static void collect();
+        // waits for the GPU and deletes everything, before the context goes away
+        static void shutdown();
+
+        static uint64_t get_frame_index();
+        static size_t get_retired_count();
+    };
+
+    template<> ResourcePool<VertexBuffer>& GpuResources::get_pool<VertexBuffer>();
+    template<> ResourcePool<IndexBuffer>& GpuResources::get_pool<IndexBuffer>();
+    template<> ResourcePool<VertexArray>& GpuResources::get_pool<VertexArray>();
+    template<> ResourcePool<ShaderStorageBuffer>& GpuResources::get_pool<ShaderStorageBuffer>();
+    template<> ResourcePool<ShaderProgram>& GpuResources::get_pool<ShaderProgram>();
+    template<> ResourcePool<Texture2D>& GpuResources::get_pool<Texture2D>();
+    template<> ResourcePool<Texture3D>& GpuResources::get_pool<Texture3D>();
+
+}
@@ -0,0 +1,61 @@
+#include "GpuTimer.hpp"
+
+#include <glad/glad.h>
+
+namespace SimpleEngine {
+
+    GpuTimer::GpuTimer()
+    {
+        glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(m_queries.size()), m_queries.data());
+    }
+
+
+    GpuTimer::~GpuTimer()
+    {
+        glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+    }
+
+
+    void GpuTimer::begin()
+    {
+        // only blocks when the GPU is more than queries_count frames behind
+        read_results(m_pending_count == queries_count);
+        glQueryCounter(m_queries[2 * ((m_first_pending + m_pending_count) % queries_count)], GL_TIMESTAMP);
+    }
+
+
+    void GpuTimer::end()
+    {
+        glQueryCounter(m_queries[2 * ((m_first_pending + m_pending_count) % queries_count) + 1], GL_TIMESTAMP);
+        ++m_pending_count;
+        read_results(false);
+    }
+
+
+    void GpuTimer::read_results(bool wait)
+    {
+        while (m_pending_count > 0)
+        {
+            const GLuint begin_query = m_queries[2 * m_first_pending];
+            const GLuint end_query = m_queries[2 * m_first_pending + 1];
+            if (!wait)
+            {
+                // the end timestamp is written last
+                GLint available = 0;
+                glGetQueryObjectiv(end_query, GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available)
+                {
+                    return;
+                }
+            }
+            GLuint64 begin_ns = 0;
+            GLuint64 end_ns = 0;
+            glGetQueryObjectui64v(begin_query, GL_QUERY_RESULT, &begin_ns);
+            glGetQueryObjectui64v(end_query, GL_QUERY_RESULT, &end_ns);
+            m_last_time_ms = (end_ns - begin_ns) / 1000000.0;
+            m_first_pending = (m_first_pending + 1) % queries_count;
+            --m_pending_count;
+            wait = false;
+        }
+    }
+}
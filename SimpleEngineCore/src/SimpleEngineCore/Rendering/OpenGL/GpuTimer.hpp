@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace SimpleEngine {
+
+    // Measures GPU time between begin() and end() with pairs of GL_TIMESTAMP queries, so timers can nest.
+    // Results are read a few frames later, so the CPU never waits for the GPU.
+    class GpuTimer {
+    public:
+        GpuTimer();
+        ~GpuTimer();
+
+        GpuTimer(const GpuTimer&) = delete;
+        GpuTimer& operator=(const GpuTimer&) = delete;
+
+        void begin();
+        void end();
+
+        double get_last_time_ms() const { return m_last_time_ms; }
+
+    private:
+        void read_results(bool wait);
+
+        static constexpr size_t queries_count = 4;
+        // begin and end timestamps of each pending measurement
+        std::array<unsigned int, 2 * queries_count> m_queries{};
+        size_t m_first_pending = 0;
+        size_t m_pending_count = 0;
+        double m_last_time_ms = 0.0;
+    };
+
+}
@@ -0,0 +1,160 @@
+#include "HeadlessContext.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#ifdef SIMPLE_ENGINE_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstring>
+#endif
+
+namespace SimpleEngine {
+
+    HeadlessContext::~HeadlessContext()
+    {
+        destroy();
+    }
+
+#ifdef SIMPLE_ENGINE_HEADLESS_EGL
+
+    static bool has_extension(const char* extensions, const char* name)
+    {
+        const size_t length = std::strlen(name);
+        for (const char* found = extensions ? std::strstr(extensions, name) : nullptr; found; found = std::strstr(found + length, name))
+        {
+            const bool starts = found == extensions || found[-1] == ' ';
+            const bool ends = found[length] == ' ' || found[length] == '\0';
+            if (starts && ends)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool HeadlessContext::create()
+    {
+        // the surfaceless platform needs neither a display server nor a device node
+        EGLDisplay display = EGL_NO_DISPLAY;
+        if (has_extension(eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS), "EGL_MESA_platform_surfaceless"))
+        {
+            const auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (get_platform_display)
+            {
+                display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            }
+        }
+        if (display == EGL_NO_DISPLAY)
+        {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+        EGLint major_version = 0;
+        EGLint minor_version = 0;
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major_version, &minor_version))
+        {
+            LOG_CRITICAL("Can't initialize an EGL display");
+            return false;
+        }
+        m_display = display;
+        LOG_INFO("EGL {0}.{1} initialized, vendor: {2}", major_version, minor_version, eglQueryString(display, EGL_VENDOR));
+
+        if (!has_extension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+        {
+            LOG_CRITICAL("EGL_KHR_surfaceless_context is not supported");
+            destroy();
+            return false;
+        }
+        if (!eglBindAPI(EGL_OPENGL_API))
+        {
+            LOG_CRITICAL("EGL can't bind the desktop OpenGL API");
+            destroy();
+            return false;
+        }
+
+        const EGLint config_attributes[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_NONE
+        };
+        EGLConfig config = nullptr;
+        EGLint configs_count = 0;
+        if (!eglChooseConfig(display, config_attributes, &config, 1, &configs_count) || configs_count == 0)
+        {
+            LOG_CRITICAL("No EGL config supports desktop OpenGL");
+            destroy();
+            return false;
+        }
+
+        // the renderer needs 4.5 (direct state access), llvmpipe doesn't expose 4.6 yet
+        EGLContext context = EGL_NO_CONTEXT;
+        for (const EGLint minor_version : { 6, 5 })
+        {
+            const EGLint context_attributes[] = {
+                EGL_CONTEXT_MAJOR_VERSION, 4,
+                EGL_CONTEXT_MINOR_VERSION, minor_version,
+                EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+                EGL_NONE
+            };
+            context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+            if (context != EGL_NO_CONTEXT)
+            {
+                break;
+            }
+        }
+        if (context == EGL_NO_CONTEXT)
+        {
+            LOG_CRITICAL("Can't create an OpenGL 4.5 core context with EGL (error 0x{0:x})", eglGetError());
+            destroy();
+            return false;
+        }
+        m_context = context;
+
+        if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+        {
+            LOG_CRITICAL("Can't make the EGL context current");
+            destroy();
+            return false;
+        }
+        return true;
+    }
+
+    void HeadlessContext::destroy()
+    {
+        if (m_display)
+        {
+            eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (m_context)
+            {
+                eglDestroyContext(m_display, m_context);
+            }
+            eglTerminate(m_display);
+        }
+        m_context = nullptr;
+        m_display = nullptr;
+    }
+
+    void* HeadlessContext::get_proc_address(const char* name)
+    {
+        return reinterpret_cast<void*>(eglGetProcAddress(name));
+    }
+
+#else
+
+    bool HeadlessContext::create()
+    {
+        LOG_CRITICAL("Headless rendering needs an engine built with SIMPLE_ENGINE_HEADLESS_EGL");
+        return false;
+    }
+
+    void HeadlessContext::destroy()
+    {
+    }
+
+    void* HeadlessContext::get_proc_address(const char* name)
+    {
+        return nullptr;
+    }
+
+#endif
+}
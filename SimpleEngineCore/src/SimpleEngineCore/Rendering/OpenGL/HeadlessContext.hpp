@@ -0,0 +1,27 @@
+#pragma once
+
+namespace SimpleEngine {
+
+    // OpenGL context without a window or display server: surfaceless EGL, rendering only into framebuffer
+    // objects. Runs on GPU servers and on Mesa llvmpipe in CI. Needs SIMPLE_ENGINE_HEADLESS_EGL.
+    class HeadlessContext
+    {
+    public:
+        HeadlessContext() = default;
+        ~HeadlessContext();
+
+        HeadlessContext(const HeadlessContext&) = delete;
+        HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+        // creates the context and makes it current on the calling thread
+        bool create();
+        void destroy();
+
+        static void* get_proc_address(const char* name);
+
+    private:
+        void* m_display = nullptr;
+        void* m_context = nullptr;
+    };
+
+}
\ No newline at end of file
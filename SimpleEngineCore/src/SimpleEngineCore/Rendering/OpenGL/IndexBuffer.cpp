@@ -20,21 +20,30 @@ namespace SimpleEngine {
         glGenBuffers(1, &m_id);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), data, usage_to_GLenum(usage));
+        m_gpu_memory_id = GpuMemory::register_resource(EGpuMemoryCategory::IndexBuffers, count * sizeof(GLuint), "Index buffer");
     }
 
 
     IndexBuffer::~IndexBuffer()
     {
         glDeleteBuffers(1, &m_id);
+        GpuMemory::unregister_resource(m_gpu_memory_id);
     }
 
 
     IndexBuffer& IndexBuffer::operator=(IndexBuffer&& index_buffer) noexcept
     {
-        m_id = index_buffer.m_id;
-        m_count = index_buffer.m_count;
-        index_buffer.m_id = 0;
-        index_buffer.m_count = 0;
+        if (this != &index_buffer)
+        {
+            glDeleteBuffers(1, &m_id);
+            GpuMemory::unregister_resource(m_gpu_memory_id);
+            m_id = index_buffer.m_id;
+            m_count = index_buffer.m_count;
+            m_gpu_memory_id = index_buffer.m_gpu_memory_id;
+            index_buffer.m_id = 0;
+            index_buffer.m_count = 0;
+            index_buffer.m_gpu_memory_id = GpuMemory::invalid_resource;
+        }
         return *this;
     }
 
@@ -42,9 +51,11 @@ namespace SimpleEngine {
     IndexBuffer::IndexBuffer(IndexBuffer&& index_buffer) noexcept
         : m_id(index_buffer.m_id)
         , m_count(index_buffer.m_count)
+        , m_gpu_memory_id(index_buffer.m_gpu_memory_id)
     {
         index_buffer.m_id = 0;
         index_buffer.m_count = 0;
+        index_buffer.m_gpu_memory_id = GpuMemory::invalid_resource;
     }
 
 
@@ -21,6 +21,7 @@ namespace SimpleEngine {
     private:
         unsigned int m_id = 0;
         size_t m_count;
+        GpuMemory::ResourceId m_gpu_memory_id = GpuMemory::invalid_resource;
     };
 
 }
@@ -4,6 +4,8 @@
 #include <GLFW/glfw3.h>
 
 #include "VertexArray.hpp"
+#include "GpuResources.hpp"
+#include "GLCapture.hpp"
 #include "SimpleEngineCore/Log.hpp"
 
 
@@ -46,11 +48,19 @@ namespace SimpleEngine {
     {
         glfwMakeContextCurrent(pWindow);
 
-        if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
+        return init(reinterpret_cast<void* (*)(const char*)>(glfwGetProcAddress));
+    }
+
+    bool Renderer_OpenGL::init(void* (*get_proc_address)(const char* name))
+    {
+        if (!gladLoadGLLoader(get_proc_address))
         {
             LOG_CRITICAL("Failed to initialize GLAD");
             return false;
         }
+#ifdef SIMPLE_ENGINE_GL_CAPTURE
+        GLCapture::install();
+#endif
 
         LOG_INFO("OpenGL context initialized:");
         LOG_INFO("  OpenGL Vendor: {0}", get_vendor_str());
@@ -115,6 +125,28 @@ namespace SimpleEngine {
         glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(vertex_array.get_indices_count()), GL_UNSIGNED_INT, nullptr);
     }
 
+    void Renderer_OpenGL::draw_arrays(const VertexArray& vertex_array, const unsigned int vertices_count)
+    {
+        vertex_array.bind();
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices_count));
+    }
+
+    void Renderer_OpenGL::draw(const Handle<VertexArray> vertex_array)
+    {
+        if (const VertexArray* pVertexArray = GpuResources::get(vertex_array))
+        {
+            draw(*pVertexArray);
+        }
+    }
+
+    void Renderer_OpenGL::draw_arrays(const Handle<VertexArray> vertex_array, const unsigned int vertices_count)
+    {
+        if (const VertexArray* pVertexArray = GpuResources::get(vertex_array))
+        {
+            draw_arrays(*pVertexArray, vertices_count);
+        }
+    }
+
     void Renderer_OpenGL::set_clear_color(const float r, const float g, const float b, const float a)
     {
         glClearColor(r, g, b, a);
@@ -140,6 +172,11 @@ namespace SimpleEngine {
         glDisable(GL_DEPTH_TEST);
     }
 
+    void Renderer_OpenGL::finish()
+    {
+        glFinish();
+    }
+
     const char* Renderer_OpenGL::get_vendor_str()
     {
         return reinterpret_cast<const char*>(glGetString(GL_VENDOR));
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ResourcePool.hpp"
+
 struct GLFWwindow;
 
 namespace SimpleEngine {
@@ -8,13 +10,21 @@ namespace SimpleEngine {
     class Renderer_OpenGL {
     public:
         static bool init(GLFWwindow* pWindow);
+        // for a context that is already current, e.g. a headless one
+        static bool init(void* (*get_proc_address)(const char* name));
 
         static void draw(const VertexArray& vertex_array);
+        static void draw_arrays(const VertexArray& vertex_array, const unsigned int vertices_count);
+        // a stale handle draws nothing
+        static void draw(const Handle<VertexArray> vertex_array);
+        static void draw_arrays(const Handle<VertexArray> vertex_array, const unsigned int vertices_count);
         static void set_clear_color(const float r, const float g, const float b, const float a);
         static void clear();
         static void set_viewport(const unsigned int width, const unsigned int height, const unsigned int left_offset = 0, const unsigned int bottom_offset = 0);
         static void enable_depth_test();
         static void disable_depth_test();
+        // blocks until all submitted commands are executed
+        static void finish();
 
         static const char* get_vendor_str();
         static const char* get_renderer_str();
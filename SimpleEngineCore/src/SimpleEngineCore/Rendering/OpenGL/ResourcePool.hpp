@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+    template<typename T>
+    class ResourcePool;
+
+    // 32-bit reference to an object of a ResourcePool: a slot index and the generation of the slot.
+    // Destroying the object bumps the generation, so copies of the handle still around resolve to nothing
+    // instead of to whatever reuses the slot. The default handle is null.
+    template<typename T>
+    class Handle
+    {
+    public:
+        Handle() = default;
+
+        explicit operator bool() const { return m_value != 0; }
+        bool operator==(const Handle& other) const { return m_value == other.m_value; }
+        bool operator!=(const Handle& other) const { return m_value != other.m_value; }
+
+        uint32_t get_value() const { return m_value; }
+
+    private:
+        friend class ResourcePool<T>;
+
+        static constexpr uint32_t index_bits = 20;
+        static constexpr uint32_t index_mask = (1u << index_bits) - 1;
+        static constexpr uint32_t max_generation = (1u << (32 - index_bits)) - 1;
+
+        Handle(const uint32_t index, const uint32_t generation)
+            : m_value((generation << index_bits) | index)
+        {
+        }
+
+        uint32_t get_index() const { return m_value & index_mask; }
+        uint32_t get_generation() const { return m_value >> index_bits; }
+
+        uint32_t m_value = 0;
+    };
+
+    // Objects packed in one array, so walking them touches contiguous memory, reached from handles through
+    // a table of slots. Destroyed objects are retired rather than deleted: they leave the array at once but
+    // are only released once the frame they were retired in is known to be over, see GpuResources.
+    // Pointers from get() are valid until the next create() or destroy() on the pool.
+    template<typename T>
+    class ResourcePool
+    {
+    public:
+        template<typename... Args>
+        Handle<T> create(Args&&... args)
+        {
+            uint32_t index = 0;
+            if (!m_free_slots.empty())
+            {
+                index = m_free_slots.back();
+                m_free_slots.pop_back();
+            }
+            else
+            {
+                index = static_cast<uint32_t>(m_slots.size());
+                m_slots.push_back(Slot());
+            }
+            Slot& slot = m_slots[index];
+            slot.object_index = static_cast<uint32_t>(m_objects.size());
+            m_objects.emplace_back(std::forward<Args>(args)...);
+            m_object_slots.push_back(index);
+            return Handle<T>(index, slot.generation);
+        }
+
+        T* get(const Handle<T> handle)
+        {
+            const Slot* pSlot = find_slot(handle);
+            return pSlot ? &m_objects[pSlot->object_index] : nullptr;
+        }
+
+        const T* get(const Handle<T> handle) const
+        {
+            const Slot* pSlot = find_slot(handle);
+            return pSlot ? &m_objects[pSlot->object_index] : nullptr;
+        }
+
+        // the handle goes stale at once, the object is kept until release_retired() passes frame_index
+        void destroy(const Handle<T> handle, const uint64_t frame_index)
+        {
+            if (!find_slot(handle))
+            {
+                return;
+            }
+
+            Slot& slot = m_slots[handle.get_index()];
+            const uint32_t object_index = slot.object_index;
+            m_retired.emplace_back(frame_index, std::move(m_objects[object_index]));
+            // the last object fills the hole, what it replaces was moved from
+            if (object_index + 1 != m_objects.size())
+            {
+                m_objects[object_index] = std::move(m_objects.back());
+                m_object_slots[object_index] = m_object_slots.back();
+                m_slots[m_object_slots[object_index]].object_index = object_index;
+            }
+            m_objects.pop_back();
+            m_object_slots.pop_back();
+
+            slot.generation = slot.generation == Handle<T>::max_generation ? 1 : slot.generation + 1;
+            m_free_slots.push_back(handle.get_index());
+        }
+
+        // releases the objects retired in frames before finished_frames_count
+        void release_retired(const uint64_t finished_frames_count)
+        {
+            // retired in frame order
+            size_t released_count = 0;
+            while (released_count < m_retired.size() && m_retired[released_count].first < finished_frames_count)
+            {
+                ++released_count;
+            }
+            if (released_count > 0)
+            {
+                m_retired.erase(m_retired.begin(), m_retired.begin() + static_cast<std::ptrdiff_t>(released_count));
+            }
+        }
+
+        // every object and every retired one, handles all go stale
+        void clear()
+        {
+            m_retired.clear();
+            m_objects.clear();
+            m_object_slots.clear();
+            m_free_slots.clear();
+            for (uint32_t index = 0; index < static_cast<uint32_t>(m_slots.size()); ++index)
+            {
+                Slot& slot = m_slots[index];
+                slot.generation = slot.generation == Handle<T>::max_generation ? 1 : slot.generation + 1;
+                m_free_slots.push_back(index);
+            }
+        }
+
+        size_t get_count() const { return m_objects.size(); }
+        size_t get_retired_count() const { return m_retired.size(); }
+
+        T* begin() { return m_objects.data(); }
+        T* end() { return m_objects.data() + m_objects.size(); }
+
+    private:
+        struct Slot
+        {
+            uint32_t object_index = 0;
+            // never 0, so no live handle is null
+            uint32_t generation = 1;
+        };
+
+        const Slot* find_slot(const Handle<T> handle) const
+        {
+            const uint32_t index = handle.get_index();
+            if (!handle || index >= m_slots.size() || m_slots[index].generation != handle.get_generation())
+            {
+                return nullptr;
+            }
+            return &m_slots[index];
+        }
+
+        std::vector<T> m_objects;
+        // slot of each object, to fix the slot up when an object moves
+        std::vector<uint32_t> m_object_slots;
+        std::vector<Slot> m_slots;
+        std::vector<uint32_t> m_free_slots;
+        std::vector<std::pair<uint64_t, T>> m_retired;
+    };
+
+}
@@ -90,18 +90,21 @@ namespace SimpleEngine
         glUseProgram(0);
     }
 
-    ShaderProgram& ShaderProgram::operator=(ShaderProgram&& shader_program)
+    ShaderProgram& ShaderProgram::operator=(ShaderProgram&& shader_program) noexcept
     {
-        glDeleteProgram(m_id);
-        m_id = shader_program.m_id;
-        m_is_compiled = shader_program.m_is_compiled;
+        if (this != &shader_program)
+        {
+            glDeleteProgram(m_id);
+            m_id = shader_program.m_id;
+            m_is_compiled = shader_program.m_is_compiled;
 
-        shader_program.m_id = 0;
-        shader_program.m_is_compiled = false;
+            shader_program.m_id = 0;
+            shader_program.m_is_compiled = false;
+        }
         return *this;
     }
 
-    ShaderProgram::ShaderProgram(ShaderProgram&& shader_program)
+    ShaderProgram::ShaderProgram(ShaderProgram&& shader_program) noexcept
         : m_id(shader_program.m_id)
         , m_is_compiled(shader_program.m_is_compiled)
     {
@@ -129,8 +132,18 @@ namespace SimpleEngine
         glUniform1f(glGetUniformLocation(m_id, name), value);
     }
 
+    void ShaderProgram::set_vec2(const char* name, const glm::vec2& value) const
+    {
+        glUniform2f(glGetUniformLocation(m_id, name), value.x, value.y);
+    }
+
     void ShaderProgram::set_vec3(const char* name, const glm::vec3& value) const
     {
         glUniform3f(glGetUniformLocation(m_id, name), value.x, value.y, value.z);
     }
+
+    void ShaderProgram::set_vec4(const char* name, const glm::vec4& value) const
+    {
+        glUniform4f(glGetUniformLocation(m_id, name), value.x, value.y, value.z, value.w);
+    }
 }
@@ -8,8 +8,8 @@ namespace SimpleEngine {
     {
     public:
         ShaderProgram(const char* vertex_shader_src, const char* fragment_shader_src);
-        ShaderProgram(ShaderProgram&&);
-        ShaderProgram& operator=(ShaderProgram&&);
+        ShaderProgram(ShaderProgram&&) noexcept;
+        ShaderProgram& operator=(ShaderProgram&&) noexcept;
         ~ShaderProgram();
 
         ShaderProgram() = delete;
@@ -23,7 +23,9 @@ namespace SimpleEngine {
         void set_matrix3(const char* name, const glm::mat3& matrix) const;
         void set_int(const char* name, const int value) const;
         void set_float(const char* name, const float value) const;
+        void set_vec2(const char* name, const glm::vec2& value) const;
         void set_vec3(const char* name, const glm::vec3& value) const;
+        void set_vec4(const char* name, const glm::vec4& value) const;
 
     private:
         unsigned int m_id = 0;
@@ -0,0 +1,74 @@
+#include "ShaderStorageBuffer.hpp"
+
+#include <algorithm>
+#include <glad/glad.h>
+
+namespace SimpleEngine {
+
+    // binding a buffer without a data store is an error, so there is always some storage
+    constexpr size_t min_capacity = 256;
+
+    ShaderStorageBuffer::ShaderStorageBuffer(const size_t capacity)
+        : m_capacity(std::max(capacity, min_capacity))
+    {
+        glCreateBuffers(1, &m_id);
+        glNamedBufferData(m_id, m_capacity, nullptr, GL_STREAM_DRAW);
+        m_gpu_memory_id = GpuMemory::register_resource(EGpuMemoryCategory::StorageBuffers, m_capacity, "Shader storage buffer");
+    }
+
+
+    ShaderStorageBuffer::~ShaderStorageBuffer()
+    {
+        glDeleteBuffers(1, &m_id);
+        GpuMemory::unregister_resource(m_gpu_memory_id);
+    }
+
+
+    ShaderStorageBuffer& ShaderStorageBuffer::operator=(ShaderStorageBuffer&& shader_storage_buffer) noexcept
+    {
+        if (this != &shader_storage_buffer)
+        {
+            glDeleteBuffers(1, &m_id);
+            GpuMemory::unregister_resource(m_gpu_memory_id);
+            m_id = shader_storage_buffer.m_id;
+            m_capacity = shader_storage_buffer.m_capacity;
+            m_gpu_memory_id = shader_storage_buffer.m_gpu_memory_id;
+            shader_storage_buffer.m_id = 0;
+            shader_storage_buffer.m_capacity = 0;
+            shader_storage_buffer.m_gpu_memory_id = GpuMemory::invalid_resource;
+        }
+        return *this;
+    }
+
+
+    ShaderStorageBuffer::ShaderStorageBuffer(ShaderStorageBuffer&& shader_storage_buffer) noexcept
+        : m_id(shader_storage_buffer.m_id)
+        , m_capacity(shader_storage_buffer.m_capacity)
+        , m_gpu_memory_id(shader_storage_buffer.m_gpu_memory_id)
+    {
+        shader_storage_buffer.m_id = 0;
+        shader_storage_buffer.m_capacity = 0;
+        shader_storage_buffer.m_gpu_memory_id = GpuMemory::invalid_resource;
+    }
+
+
+    void ShaderStorageBuffer::set_data(const void* data, const size_t size)
+    {
+        if (size > m_capacity)
+        {
+            m_capacity = std::max(size, m_capacity * 2);
+            GpuMemory::resize_resource(m_gpu_memory_id, m_capacity);
+        }
+        glNamedBufferData(m_id, m_capacity, nullptr, GL_STREAM_DRAW);
+        if (size > 0)
+        {
+            glNamedBufferSubData(m_id, 0, size, data);
+        }
+    }
+
+
+    void ShaderStorageBuffer::bind(const unsigned int binding) const
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_id);
+    }
+}
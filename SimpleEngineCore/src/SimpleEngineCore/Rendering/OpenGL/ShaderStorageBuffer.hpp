@@ -0,0 +1,34 @@
+#pragma once
+
+#include "SimpleEngineCore/GpuMemory.hpp"
+
+#include <cstddef>
+
+namespace SimpleEngine {
+
+    class ShaderStorageBuffer {
+    public:
+
+        ShaderStorageBuffer(const size_t capacity = 0);
+        ~ShaderStorageBuffer();
+
+        ShaderStorageBuffer(const ShaderStorageBuffer&) = delete;
+        ShaderStorageBuffer& operator=(const ShaderStorageBuffer&) = delete;
+        ShaderStorageBuffer& operator=(ShaderStorageBuffer&& shader_storage_buffer) noexcept;
+        ShaderStorageBuffer(ShaderStorageBuffer&& shader_storage_buffer) noexcept;
+
+        // Orphans the previous storage so the upload never waits for the GPU to finish reading it.
+        // The storage only grows, so steady-state frames do not reallocate.
+        void set_data(const void* data, const size_t size);
+        void bind(const unsigned int binding) const;
+
+        unsigned int get_handle() const { return m_id; }
+        size_t get_capacity() const { return m_capacity; }
+
+    private:
+        unsigned int m_id = 0;
+        size_t m_capacity = 0;
+        GpuMemory::ResourceId m_gpu_memory_id = GpuMemory::invalid_resource;
+    };
+
+}
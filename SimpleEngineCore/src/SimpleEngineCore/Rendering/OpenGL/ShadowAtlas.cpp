@@ -0,0 +1,129 @@
+#include "ShadowAtlas.hpp"
+#include "Framebuffer.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+namespace SimpleEngine {
+
+    ShadowAtlas::ShadowAtlas(const unsigned int size)
+        : m_size(size)
+    {
+        create();
+    }
+
+
+    ShadowAtlas::~ShadowAtlas()
+    {
+        destroy();
+    }
+
+
+    void ShadowAtlas::resize(const unsigned int size)
+    {
+        if (size == m_size)
+        {
+            return;
+        }
+        destroy();
+        m_size = size;
+        create();
+    }
+
+
+    void ShadowAtlas::create()
+    {
+        const GLsizei size = static_cast<GLsizei>(m_size);
+
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_cache_texture);
+        glTextureStorage2D(m_cache_texture, 1, GL_DEPTH_COMPONENT32F, size, size);
+        glTextureParameteri(m_cache_texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(m_cache_texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        // compare mode with linear filtering gives 2x2 hardware PCF on sampler2DShadow
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_live_texture);
+        glTextureStorage2D(m_live_texture, 1, GL_DEPTH_COMPONENT32F, size, size);
+        glTextureParameteri(m_live_texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(m_live_texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(m_live_texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_live_texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_live_texture, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTextureParameteri(m_live_texture, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+        const GLuint textures[] = { m_cache_texture, m_live_texture };
+        GLuint* framebuffers[] = { &m_cache_framebuffer, &m_live_framebuffer };
+        for (int i = 0; i < 2; ++i)
+        {
+            glCreateFramebuffers(1, framebuffers[i]);
+            glNamedFramebufferTexture(*framebuffers[i], GL_DEPTH_ATTACHMENT, textures[i], 0);
+            glNamedFramebufferDrawBuffer(*framebuffers[i], GL_NONE);
+            glNamedFramebufferReadBuffer(*framebuffers[i], GL_NONE);
+            if (glCheckNamedFramebufferStatus(*framebuffers[i], GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            {
+                LOG_CRITICAL("Shadow atlas framebuffer is incomplete");
+            }
+        }
+        m_gpu_memory_id = GpuMemory::register_resource(EGpuMemoryCategory::ShadowMaps,
+                                                       2 * GpuMemory::get_texture_bytes(GL_DEPTH_COMPONENT32F, m_size, m_size, 1, 1), "Shadow atlas");
+    }
+
+
+    void ShadowAtlas::destroy()
+    {
+        glDeleteFramebuffers(1, &m_cache_framebuffer);
+        glDeleteFramebuffers(1, &m_live_framebuffer);
+        glDeleteTextures(1, &m_cache_texture);
+        glDeleteTextures(1, &m_live_texture);
+        GpuMemory::unregister_resource(m_gpu_memory_id);
+        m_gpu_memory_id = GpuMemory::invalid_resource;
+        m_cache_framebuffer = m_live_framebuffer = 0;
+        m_cache_texture = m_live_texture = 0;
+    }
+
+
+    void ShadowAtlas::begin_tile(const unsigned int framebuffer, const unsigned int x, const unsigned int y, const unsigned int size)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(x, y, size, size);
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(x, y, size, size);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.f, 4.f);
+    }
+
+
+    void ShadowAtlas::begin_cache_tile(const unsigned int x, const unsigned int y, const unsigned int size)
+    {
+        begin_tile(m_cache_framebuffer, x, y, size);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+
+    void ShadowAtlas::copy_cache_to_live(const unsigned int x, const unsigned int y, const unsigned int size)
+    {
+        glCopyImageSubData(m_cache_texture, GL_TEXTURE_2D, 0, x, y, 0,
+                           m_live_texture, GL_TEXTURE_2D, 0, x, y, 0,
+                           size, size, 1);
+    }
+
+
+    void ShadowAtlas::begin_live_tile(const unsigned int x, const unsigned int y, const unsigned int size)
+    {
+        begin_tile(m_live_framebuffer, x, y, size);
+    }
+
+
+    void ShadowAtlas::end()
+    {
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glDisable(GL_SCISSOR_TEST);
+        Framebuffer::unbind();
+    }
+
+
+    void ShadowAtlas::bind_live(const unsigned int unit) const
+    {
+        glBindTextureUnit(unit, m_live_texture);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "SimpleEngineCore/GpuMemory.hpp"
+
+namespace SimpleEngine {
+
+    // Two depth atlases of the same size: static casters are cached in one,
+    // the other is sampled by the lighting passes and receives dynamic casters every frame.
+    class ShadowAtlas {
+    public:
+        explicit ShadowAtlas(const unsigned int size);
+        ~ShadowAtlas();
+
+        ShadowAtlas(const ShadowAtlas&) = delete;
+        ShadowAtlas& operator=(const ShadowAtlas&) = delete;
+
+        void resize(const unsigned int size);
+
+        // clears the tile in the cache atlas and restricts drawing to it
+        void begin_cache_tile(const unsigned int x, const unsigned int y, const unsigned int size);
+        void copy_cache_to_live(const unsigned int x, const unsigned int y, const unsigned int size);
+        void begin_live_tile(const unsigned int x, const unsigned int y, const unsigned int size);
+        // binds the default framebuffer back, the viewport is left to the caller
+        void end();
+
+        void bind_live(const unsigned int unit) const;
+        unsigned int get_size() const { return m_size; }
+
+    private:
+        void create();
+        void destroy();
+        void begin_tile(const unsigned int framebuffer, const unsigned int x, const unsigned int y, const unsigned int size);
+
+        unsigned int m_size = 0;
+        unsigned int m_cache_texture = 0;
+        unsigned int m_live_texture = 0;
+        unsigned int m_cache_framebuffer = 0;
+        unsigned int m_live_framebuffer = 0;
+        GpuMemory::ResourceId m_gpu_memory_id = GpuMemory::invalid_resource;
+    };
+
+}
@@ -12,6 +12,7 @@ namespace SimpleEngine
     {
         glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
         const GLsizei mip_levels = static_cast<GLsizei>(std::log2(std::max(m_width, m_height))) + 1;
+        m_mip_levels = static_cast<unsigned int>(mip_levels);
         glTextureStorage2D(m_id, mip_levels, GL_RGB8, m_width, m_height);
         glTextureSubImage2D(m_id, 0, 0, 0, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE, data);
         glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -19,20 +20,112 @@ namespace SimpleEngine
         glTextureParameteri(m_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTextureParameteri(m_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glGenerateTextureMipmap(m_id);
+        m_gpu_memory_id = GpuMemory::register_resource(EGpuMemoryCategory::Textures,
+                                                       GpuMemory::get_texture_bytes(GL_RGB8, m_width, m_height, 1, mip_levels), "Texture");
+    }
+
+    Texture2D::Texture2D(const float* data, const unsigned int width, const unsigned int height)
+        : m_width(width)
+        , m_height(height)
+    {
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
+        glTextureStorage2D(m_id, 1, GL_RGB16F, m_width, m_height);
+        glTextureSubImage2D(m_id, 0, 0, 0, m_width, m_height, GL_RGB, GL_FLOAT, data);
+        glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(m_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        m_gpu_memory_id = GpuMemory::register_resource(EGpuMemoryCategory::Textures,
+                                                       GpuMemory::get_texture_bytes(GL_RGB16F, m_width, m_height, 1, 1), "Float texture");
+    }
+
+    Texture2D::Texture2D(const unsigned char* const* mip_data, const unsigned int mip_levels, const unsigned int width, const unsigned int height,
+                         const unsigned int first_level)
+        : m_width(width)
+        , m_height(height)
+        , m_mip_levels(mip_levels)
+        , m_first_level(std::min(first_level, mip_levels - 1))
+    {
+        create_mip_chain_storage();
+        for (unsigned int level = m_first_level; level < m_mip_levels; ++level)
+        {
+            glTextureSubImage2D(m_id, static_cast<GLint>(level - m_first_level), 0, 0, std::max(m_width >> level, 1u), std::max(m_height >> level, 1u),
+                                GL_RGBA, GL_UNSIGNED_BYTE, mip_data[level - m_first_level]);
+        }
+        m_gpu_memory_id = GpuMemory::register_resource(EGpuMemoryCategory::Textures,
+                                                       GpuMemory::get_texture_bytes(GL_RGBA8, std::max(m_width >> m_first_level, 1u), std::max(m_height >> m_first_level, 1u),
+                                                                                    1, m_mip_levels - m_first_level), "Cooked texture");
+    }
+
+    void Texture2D::create_mip_chain_storage()
+    {
+        const unsigned int levels = m_mip_levels - m_first_level;
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
+        glTextureStorage2D(m_id, static_cast<GLsizei>(levels), GL_RGBA8, std::max(m_width >> m_first_level, 1u), std::max(m_height >> m_first_level, 1u));
+        glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTextureParameteri(m_id, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTextureParameteri(m_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    void Texture2D::set_first_level(const unsigned int first_level, const unsigned char* const* level_data)
+    {
+        const unsigned int new_first_level = std::min(first_level, m_mip_levels - 1);
+        if (new_first_level == m_first_level)
+        {
+            return;
+        }
+        const unsigned int old_id = m_id;
+        const unsigned int old_first_level = m_first_level;
+        m_first_level = new_first_level;
+        create_mip_chain_storage();
+        for (unsigned int level = m_first_level; level < m_mip_levels; ++level)
+        {
+            const unsigned int level_width = std::max(m_width >> level, 1u);
+            const unsigned int level_height = std::max(m_height >> level, 1u);
+            if (level >= old_first_level)
+            {
+                glCopyImageSubData(old_id, GL_TEXTURE_2D, static_cast<GLint>(level - old_first_level), 0, 0, 0,
+                                   m_id, GL_TEXTURE_2D, static_cast<GLint>(level - m_first_level), 0, 0, 0, level_width, level_height, 1);
+            }
+            else
+            {
+                glTextureSubImage2D(m_id, static_cast<GLint>(level - m_first_level), 0, 0, level_width, level_height,
+                                    GL_RGBA, GL_UNSIGNED_BYTE, level_data[level - m_first_level]);
+            }
+        }
+        // commands still in flight keep the old storage alive until they are done with it
+        glDeleteTextures(1, &old_id);
+        GpuMemory::resize_resource(m_gpu_memory_id, GpuMemory::get_texture_bytes(GL_RGBA8, std::max(m_width >> m_first_level, 1u), std::max(m_height >> m_first_level, 1u),
+                                                                                 1, m_mip_levels - m_first_level));
+    }
+
+    void Texture2D::set_min_lod(const int min_lod)
+    {
+        glTextureParameteri(m_id, GL_TEXTURE_MIN_LOD, min_lod);
     }
 
     Texture2D::~Texture2D()
     {
         glDeleteTextures(1, &m_id);
+        GpuMemory::unregister_resource(m_gpu_memory_id);
     }
 
     Texture2D& Texture2D::operator=(Texture2D&& texture) noexcept
     {
-        glDeleteTextures(1, &m_id);
-        m_id = texture.m_id;
-        m_width = texture.m_width;
-        m_height = texture.m_height;
-        texture.m_id = 0;
+        if (this != &texture)
+        {
+            glDeleteTextures(1, &m_id);
+            GpuMemory::unregister_resource(m_gpu_memory_id);
+            m_id = texture.m_id;
+            m_width = texture.m_width;
+            m_height = texture.m_height;
+            m_mip_levels = texture.m_mip_levels;
+            m_first_level = texture.m_first_level;
+            m_gpu_memory_id = texture.m_gpu_memory_id;
+            texture.m_id = 0;
+            texture.m_gpu_memory_id = GpuMemory::invalid_resource;
+        }
         return *this;
     }
 
@@ -41,11 +134,16 @@ namespace SimpleEngine
         m_id = texture.m_id;
         m_width = texture.m_width;
         m_height = texture.m_height;
+        m_mip_levels = texture.m_mip_levels;
+        m_first_level = texture.m_first_level;
+        m_gpu_memory_id = texture.m_gpu_memory_id;
         texture.m_id = 0;
+        texture.m_gpu_memory_id = GpuMemory::invalid_resource;
     }
 
     void Texture2D::bind(const unsigned int unit) const
     {
         glBindTextureUnit(unit, m_id);
+        GpuMemory::touch(m_gpu_memory_id);
     }
 }
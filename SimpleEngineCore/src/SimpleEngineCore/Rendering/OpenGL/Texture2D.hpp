@@ -1,10 +1,18 @@
 #pragma once
 
+#include "SimpleEngineCore/GpuMemory.hpp"
+
 namespace SimpleEngine {
 
     class Texture2D {
     public:
         Texture2D(const unsigned char* data, const unsigned int width, const unsigned int height);
+        // linear RGB data such as lightmaps: half float storage, clamped and without mipmaps
+        Texture2D(const float* data, const unsigned int width, const unsigned int height);
+        // RGBA8 mip chain of a width x height texture, the largest level first like cooked textures store them.
+        // Only the levels from first_level down are given and allocated, mip_data[0] is first_level
+        Texture2D(const unsigned char* const* mip_data, const unsigned int mip_levels, const unsigned int width, const unsigned int height,
+                  const unsigned int first_level = 0);
         ~Texture2D();
 
         Texture2D(const Texture2D&) = delete;
@@ -14,10 +22,27 @@ namespace SimpleEngine {
 
         void bind(const unsigned int unit) const;
 
+        // Reallocates a mip chain texture with the levels from first_level down: levels kept are copied on the GPU,
+        // new ones come from level_data, level_data[0] being first_level. Nothing is read when only dropping levels
+        void set_first_level(const unsigned int first_level, const unsigned char* const* level_data);
+        // no level below this one is sampled, counted from the first allocated level
+        void set_min_lod(const int min_lod);
+
+        unsigned int get_width() const { return m_width; }
+        unsigned int get_height() const { return m_height; }
+        unsigned int get_mip_levels() const { return m_mip_levels; }
+        unsigned int get_first_level() const { return m_first_level; }
+        GpuMemory::ResourceId get_gpu_memory_id() const { return m_gpu_memory_id; }
+
     private:
+        void create_mip_chain_storage();
+
         unsigned int m_id = 0;
         unsigned int m_width = 0;
         unsigned int m_height = 0;
+        unsigned int m_mip_levels = 1;
+        unsigned int m_first_level = 0;
+        GpuMemory::ResourceId m_gpu_memory_id = GpuMemory::invalid_resource;
     };
 
 }
\ No newline at end of file
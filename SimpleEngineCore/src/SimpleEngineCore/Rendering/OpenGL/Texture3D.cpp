@@ -0,0 +1,67 @@
+#include "Texture3D.hpp"
+
+#include <glad/glad.h>
+
+namespace SimpleEngine
+{
+    Texture3D::Texture3D(const unsigned int width, const unsigned int height, const unsigned int depth)
+        : m_width(width)
+        , m_height(height)
+        , m_depth(depth)
+    {
+        glCreateTextures(GL_TEXTURE_3D, 1, &m_id);
+        glTextureStorage3D(m_id, 1, GL_RGBA16F, m_width, m_height, m_depth);
+        glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_id, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(m_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        m_gpu_memory_id = GpuMemory::register_resource(EGpuMemoryCategory::Textures,
+                                                       GpuMemory::get_texture_bytes(GL_RGBA16F, m_width, m_height, m_depth, 1), "Volume texture");
+    }
+
+    Texture3D::~Texture3D()
+    {
+        glDeleteTextures(1, &m_id);
+        GpuMemory::unregister_resource(m_gpu_memory_id);
+    }
+
+    Texture3D& Texture3D::operator=(Texture3D&& texture) noexcept
+    {
+        if (this != &texture)
+        {
+            glDeleteTextures(1, &m_id);
+            GpuMemory::unregister_resource(m_gpu_memory_id);
+            m_id = texture.m_id;
+            m_width = texture.m_width;
+            m_height = texture.m_height;
+            m_depth = texture.m_depth;
+            m_gpu_memory_id = texture.m_gpu_memory_id;
+            texture.m_id = 0;
+            texture.m_gpu_memory_id = GpuMemory::invalid_resource;
+        }
+        return *this;
+    }
+
+    Texture3D::Texture3D(Texture3D&& texture) noexcept
+    {
+        m_id = texture.m_id;
+        m_width = texture.m_width;
+        m_height = texture.m_height;
+        m_depth = texture.m_depth;
+        m_gpu_memory_id = texture.m_gpu_memory_id;
+        texture.m_id = 0;
+        texture.m_gpu_memory_id = GpuMemory::invalid_resource;
+    }
+
+    void Texture3D::set_data(const float* data)
+    {
+        glTextureSubImage3D(m_id, 0, 0, 0, 0, m_width, m_height, m_depth, GL_RGBA, GL_FLOAT, data);
+    }
+
+    void Texture3D::bind(const unsigned int unit) const
+    {
+        glBindTextureUnit(unit, m_id);
+        GpuMemory::touch(m_gpu_memory_id);
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "SimpleEngineCore/GpuMemory.hpp"
+
+namespace SimpleEngine {
+
+    // RGBA half float volume, linearly filtered and clamped, for data the shaders interpolate trilinearly
+    class Texture3D {
+    public:
+        Texture3D(const unsigned int width, const unsigned int height, const unsigned int depth);
+        ~Texture3D();
+
+        Texture3D(const Texture3D&) = delete;
+        Texture3D& operator=(const Texture3D&) = delete;
+        Texture3D& operator=(Texture3D&& texture) noexcept;
+        Texture3D(Texture3D&& texture) noexcept;
+
+        // width * height * depth RGBA floats
+        void set_data(const float* data);
+        void bind(const unsigned int unit) const;
+
+    private:
+        unsigned int m_id = 0;
+        unsigned int m_width = 0;
+        unsigned int m_height = 0;
+        unsigned int m_depth = 0;
+        GpuMemory::ResourceId m_gpu_memory_id = GpuMemory::invalid_resource;
+    };
+
+}
\ No newline at end of file
@@ -20,10 +20,16 @@ namespace SimpleEngine {
 
     VertexArray& VertexArray::operator=(VertexArray&& vertex_array) noexcept
     {
-        m_id = vertex_array.m_id;
-        m_elements_count = vertex_array.m_id;
-        vertex_array.m_id = 0;
-        vertex_array.m_elements_count = 0;
+        if (this != &vertex_array)
+        {
+            glDeleteVertexArrays(1, &m_id);
+            m_id = vertex_array.m_id;
+            m_elements_count = vertex_array.m_elements_count;
+            m_indices_count = vertex_array.m_indices_count;
+            vertex_array.m_id = 0;
+            vertex_array.m_elements_count = 0;
+            vertex_array.m_indices_count = 0;
+        }
         return *this;
     }
 
@@ -31,9 +37,11 @@ namespace SimpleEngine {
     VertexArray::VertexArray(VertexArray&& vertex_array) noexcept
         : m_id(vertex_array.m_id)
         , m_elements_count(vertex_array.m_elements_count)
+        , m_indices_count(vertex_array.m_indices_count)
     {
         vertex_array.m_id = 0;
         vertex_array.m_elements_count = 0;
+        vertex_array.m_indices_count = 0;
     }
 
 
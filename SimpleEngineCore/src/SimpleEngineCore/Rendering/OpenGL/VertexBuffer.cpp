@@ -106,19 +106,29 @@ namespace SimpleEngine {
         glGenBuffers(1, &m_id);
         glBindBuffer(GL_ARRAY_BUFFER, m_id);
         glBufferData(GL_ARRAY_BUFFER, size, data, usage_to_GLenum(usage));
+        m_gpu_memory_id = GpuMemory::register_resource(EGpuMemoryCategory::VertexBuffers, size, "Vertex buffer");
     }
 
 
     VertexBuffer::~VertexBuffer()
     {
         glDeleteBuffers(1, &m_id);
+        GpuMemory::unregister_resource(m_gpu_memory_id);
     }
 
 
     VertexBuffer& VertexBuffer::operator=(VertexBuffer&& vertex_buffer) noexcept
     {
-        m_id = vertex_buffer.m_id;
-        vertex_buffer.m_id = 0;
+        if (this != &vertex_buffer)
+        {
+            glDeleteBuffers(1, &m_id);
+            GpuMemory::unregister_resource(m_gpu_memory_id);
+            m_id = vertex_buffer.m_id;
+            m_buffer_layout = std::move(vertex_buffer.m_buffer_layout);
+            m_gpu_memory_id = vertex_buffer.m_gpu_memory_id;
+            vertex_buffer.m_id = 0;
+            vertex_buffer.m_gpu_memory_id = GpuMemory::invalid_resource;
+        }
         return *this;
     }
 
@@ -126,8 +136,10 @@ namespace SimpleEngine {
     VertexBuffer::VertexBuffer(VertexBuffer&& vertex_buffer) noexcept
         : m_id(vertex_buffer.m_id)
         , m_buffer_layout(std::move(vertex_buffer.m_buffer_layout))
+        , m_gpu_memory_id(vertex_buffer.m_gpu_memory_id)
     {
         vertex_buffer.m_id = 0;
+        vertex_buffer.m_gpu_memory_id = GpuMemory::invalid_resource;
     }
 
 }
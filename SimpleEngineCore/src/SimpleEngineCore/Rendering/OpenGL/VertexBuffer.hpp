@@ -1,7 +1,12 @@
 #pragma once
 
+#include "SimpleEngineCore/GpuMemory.hpp"
+#include "SimpleEngineCore/Memory.hpp"
+
 #include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <utility>
 
 namespace SimpleEngine {
 
@@ -31,8 +36,27 @@ namespace SimpleEngine {
     class BufferLayout
     {
     public:
+        // a handful of elements, small enough for the pools
+        using Elements = std::vector<BufferElement, PoolAllocator<BufferElement, EMemoryTag::Rendering>>;
+
         BufferLayout(std::initializer_list<BufferElement> elements)
             : m_elements(elements)
+        {
+            compute_offsets();
+        }
+
+        // for layouts only known at run time, like those of cooked meshes
+        explicit BufferLayout(Elements elements)
+            : m_elements(std::move(elements))
+        {
+            compute_offsets();
+        }
+
+        const Elements& get_elements() const { return m_elements; }
+        size_t get_stride() const { return m_stride; }
+
+    private:
+        void compute_offsets()
         {
             size_t offset = 0;
             m_stride = 0;
@@ -44,11 +68,7 @@ namespace SimpleEngine {
             }
         }
 
-        const std::vector<BufferElement>& get_elements() const { return m_elements; }
-        size_t get_stride() const { return m_stride; }
-
-    private:
-        std::vector<BufferElement> m_elements;
+        Elements m_elements;
         size_t m_stride = 0;
     };
 
@@ -78,6 +98,7 @@ namespace SimpleEngine {
     private:
         unsigned int m_id = 0;
         BufferLayout m_buffer_layout;
+        GpuMemory::ResourceId m_gpu_memory_id = GpuMemory::invalid_resource;
     };
 
 }
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace SimpleEngine {
+
+    // Compile-time description of a struct: specialize Reflection<T> with the struct's name and a tuple of its
+    // fields, in the order they are serialized,
+    //
+    //     template<>
+    //     struct Reflection<PointLight>
+    //     {
+    //         static constexpr const char* name = "PointLight";
+    //         static constexpr auto fields = std::make_tuple(reflect_field("position", &PointLight::position),
+    //                                                        reflect_field("radius", &PointLight::radius));
+    //     };
+    //
+    // Fields left out of the tuple keep their default values when loaded. The names are what files are matched
+    // against, so renaming one breaks the files saved before.
+    template<typename T>
+    struct Reflection;
+
+    template<typename Class, typename T>
+    struct ReflectedField
+    {
+        using ClassType = Class;
+        using Type = T;
+
+        const char* name;
+        T Class::* pMember;
+    };
+
+    template<typename Class, typename T>
+    constexpr ReflectedField<Class, T> reflect_field(const char* name, T Class::* pMember)
+    {
+        return ReflectedField<Class, T>{ name, pMember };
+    }
+
+    template<typename T>
+    constexpr size_t get_fields_count()
+    {
+        return std::tuple_size_v<std::decay_t<decltype(Reflection<T>::fields)>>;
+    }
+
+    namespace ReflectionDetail {
+
+        template<typename T, typename F, size_t... I>
+        constexpr void for_each_field(F& function, std::index_sequence<I...>)
+        {
+            (function(std::get<I>(Reflection<T>::fields), std::integral_constant<size_t, I>()), ...);
+        }
+
+        template<typename T, auto pMember, size_t I>
+        constexpr size_t get_field_index()
+        {
+            if constexpr (I == get_fields_count<T>())
+            {
+                return I;
+            }
+            else
+            {
+                constexpr auto field = std::get<I>(Reflection<T>::fields);
+                if constexpr (std::is_same_v<decltype(field.pMember), decltype(pMember)>)
+                {
+                    if (field.pMember == pMember)
+                    {
+                        return I;
+                    }
+                }
+                return get_field_index<T, pMember, I + 1>();
+            }
+        }
+
+    }
+
+    // function(field, index) for every reflected field of T, index is a std::integral_constant
+    template<typename T, typename F>
+    constexpr void for_each_field(F&& function)
+    {
+        ReflectionDetail::for_each_field<T>(function, std::make_index_sequence<get_fields_count<T>()>());
+    }
+
+    // position of &T::member in Reflection<T>::fields
+    template<typename T, auto pMember>
+    constexpr size_t get_field_index()
+    {
+        constexpr size_t index = ReflectionDetail::get_field_index<T, pMember, 0>();
+        static_assert(index < get_fields_count<T>(), "the member isn't reflected");
+        return index;
+    }
+
+}
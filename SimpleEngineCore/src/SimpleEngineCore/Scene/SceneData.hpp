@@ -0,0 +1,279 @@
+#pragma once
+
+#include "SimpleEngineCore/Scene/Reflection.hpp"
+#include "SimpleEngineCore/PointLight.hpp"
+#include "SimpleEngineCore/SpotLight.hpp"
+#include "SimpleEngineCore/DirectionalLight.hpp"
+
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // a cube of the scene, parented to another cube of the same scene or to nothing
+    struct SceneCube
+    {
+        static constexpr uint32_t no_parent = UINT32_MAX;
+
+        glm::vec3 position{ 0.f };
+        glm::quat rotation{ 1.f, 0.f, 0.f, 0.f };
+        glm::vec3 scale{ 1.f };
+        // index among the scene's cubes
+        uint32_t parent = no_parent;
+        bool dynamic = false;
+    };
+
+    // the lighting parameters of the Application that belong to no light
+    struct SceneEnvironment
+    {
+        glm::vec3 light_source_position{ 0.f };
+        glm::vec3 light_source_color{ 1.f };
+        float ambient_factor = 0.1f;
+        float diffuse_factor = 1.f;
+        float specular_factor = 0.5f;
+        float shininess = 32.f;
+    };
+
+    template<>
+    struct Reflection<SceneCube>
+    {
+        static constexpr const char* name = "Cube";
+        static constexpr auto fields = std::make_tuple(
+            reflect_field("position", &SceneCube::position),
+            reflect_field("rotation", &SceneCube::rotation),
+            reflect_field("scale", &SceneCube::scale),
+            reflect_field("parent", &SceneCube::parent),
+            reflect_field("dynamic", &SceneCube::dynamic));
+    };
+
+    template<>
+    struct Reflection<PointLight>
+    {
+        static constexpr const char* name = "PointLight";
+        static constexpr auto fields = std::make_tuple(
+            reflect_field("position", &PointLight::position),
+            reflect_field("radius", &PointLight::radius),
+            reflect_field("color", &PointLight::color),
+            reflect_field("intensity", &PointLight::intensity));
+    };
+
+    template<>
+    struct Reflection<SpotLight>
+    {
+        static constexpr const char* name = "SpotLight";
+        static constexpr auto fields = std::make_tuple(
+            reflect_field("position", &SpotLight::position),
+            reflect_field("range", &SpotLight::range),
+            reflect_field("direction", &SpotLight::direction),
+            reflect_field("intensity", &SpotLight::intensity),
+            reflect_field("color", &SpotLight::color),
+            reflect_field("inner_angle", &SpotLight::inner_angle),
+            reflect_field("outer_angle", &SpotLight::outer_angle),
+            reflect_field("cast_shadows", &SpotLight::cast_shadows),
+            reflect_field("shadow_resolution", &SpotLight::shadow_resolution));
+    };
+
+    template<>
+    struct Reflection<DirectionalLight>
+    {
+        static constexpr const char* name = "DirectionalLight";
+        static constexpr auto fields = std::make_tuple(
+            reflect_field("direction", &DirectionalLight::direction),
+            reflect_field("intensity", &DirectionalLight::intensity),
+            reflect_field("color", &DirectionalLight::color),
+            reflect_field("cast_shadows", &DirectionalLight::cast_shadows),
+            reflect_field("shadow_resolution", &DirectionalLight::shadow_resolution),
+            reflect_field("shadow_center", &DirectionalLight::shadow_center),
+            reflect_field("shadow_extent", &DirectionalLight::shadow_extent));
+    };
+
+    template<>
+    struct Reflection<SceneEnvironment>
+    {
+        static constexpr const char* name = "Environment";
+        static constexpr auto fields = std::make_tuple(
+            reflect_field("light_source_position", &SceneEnvironment::light_source_position),
+            reflect_field("light_source_color", &SceneEnvironment::light_source_color),
+            reflect_field("ambient_factor", &SceneEnvironment::ambient_factor),
+            reflect_field("diffuse_factor", &SceneEnvironment::diffuse_factor),
+            reflect_field("specular_factor", &SceneEnvironment::specular_factor),
+            reflect_field("shininess", &SceneEnvironment::shininess));
+    };
+
+    // the field types scene files can hold
+    enum class EFieldType : uint32_t
+    {
+        Float,
+        UInt32,
+        // one byte, 0 or 1
+        Bool,
+        Vec3,
+        // x, y, z, w
+        Quat
+    };
+
+    template<typename T>
+    constexpr EFieldType get_field_type()
+    {
+        if constexpr (std::is_same_v<T, float>) return EFieldType::Float;
+        else if constexpr (std::is_same_v<T, uint32_t>) return EFieldType::UInt32;
+        else if constexpr (std::is_same_v<T, bool>) return EFieldType::Bool;
+        else if constexpr (std::is_same_v<T, glm::vec3>) return EFieldType::Vec3;
+        else if constexpr (std::is_same_v<T, glm::quat>) return EFieldType::Quat;
+        else static_assert(!sizeof(T), "the field type can't be serialized");
+    }
+
+    // bools are stored as bytes so that every field is a plain array
+    template<typename T>
+    using StoredField = std::conditional_t<std::is_same_v<T, bool>, uint8_t, T>;
+
+    // Components of one type stored field by field, one array per reflected field. Scene files hold the arrays
+    // as they are, so loading one is a copy per field whatever the number of components.
+    template<typename T>
+    class ComponentArray
+    {
+        template<typename Fields>
+        struct ArraysOf;
+
+        template<typename... Fields>
+        struct ArraysOf<std::tuple<Fields...>>
+        {
+            using Type = std::tuple<std::vector<StoredField<typename Fields::Type>>...>;
+        };
+
+    public:
+        using Component = T;
+        using Arrays = typename ArraysOf<std::decay_t<decltype(Reflection<T>::fields)>>::Type;
+
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+        void clear()
+        {
+            std::apply([](auto&... arrays) { (arrays.clear(), ...); }, m_arrays);
+            m_size = 0;
+        }
+
+        void reserve(const size_t count)
+        {
+            std::apply([count](auto&... arrays) { (arrays.reserve(count), ...); }, m_arrays);
+        }
+
+        // the new components take the defaults of T
+        void resize(const size_t count)
+        {
+            const T defaults{};
+            for_each_field<T>([this, count, &defaults](const auto& field, auto index)
+            {
+                auto& array = std::get<decltype(index)::value>(m_arrays);
+                array.resize(count, static_cast<typename std::decay_t<decltype(array)>::value_type>(defaults.*field.pMember));
+            });
+            m_size = count;
+        }
+
+        void push_back(const T& component)
+        {
+            for_each_field<T>([this, &component](const auto& field, auto index)
+            {
+                auto& array = std::get<decltype(index)::value>(m_arrays);
+                array.push_back(static_cast<typename std::decay_t<decltype(array)>::value_type>(component.*field.pMember));
+            });
+            ++m_size;
+        }
+
+        T get(const size_t i) const
+        {
+            T component{};
+            for_each_field<T>([this, i, &component](const auto& field, auto index)
+            {
+                using Type = typename std::decay_t<decltype(field)>::Type;
+                component.*field.pMember = static_cast<Type>(std::get<decltype(index)::value>(m_arrays)[i]);
+            });
+            return component;
+        }
+
+        // replaces the components, one pass per field
+        void assign(const T* components, const size_t count)
+        {
+            for_each_field<T>([this, components, count](const auto& field, auto index)
+            {
+                auto& array = std::get<decltype(index)::value>(m_arrays);
+                array.resize(count);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    array[i] = static_cast<typename std::decay_t<decltype(array)>::value_type>(components[i].*field.pMember);
+                }
+            });
+            m_size = count;
+        }
+
+        // writes size() components, one pass per field; the fields that aren't reflected are left as they are
+        void copy_to(T* components) const
+        {
+            for_each_field<T>([this, components](const auto& field, auto index)
+            {
+                using Type = typename std::decay_t<decltype(field)>::Type;
+                const auto& array = std::get<decltype(index)::value>(m_arrays);
+                for (size_t i = 0; i < m_size; ++i)
+                {
+                    components[i].*field.pMember = static_cast<Type>(array[i]);
+                }
+            });
+        }
+
+        // the array of the I-th reflected field, resize() the whole component array rather than one field
+        template<size_t I>
+        auto& get_array() { return std::get<I>(m_arrays); }
+        template<size_t I>
+        const auto& get_array() const { return std::get<I>(m_arrays); }
+
+        // the array of a member, e.g. get_field<&PointLight::position>()
+        template<auto pMember>
+        auto& get_field() { return std::get<get_field_index<T, pMember>()>(m_arrays); }
+        template<auto pMember>
+        const auto& get_field() const { return std::get<get_field_index<T, pMember>()>(m_arrays); }
+
+    private:
+        Arrays m_arrays;
+        size_t m_size = 0;
+    };
+
+    // everything a scene file holds; the Application has one directional light and one environment,
+    // they are arrays here only so that every component is stored the same way
+    struct SceneData
+    {
+        ComponentArray<SceneCube> cubes;
+        ComponentArray<PointLight> point_lights;
+        ComponentArray<SpotLight> spot_lights;
+        ComponentArray<DirectionalLight> directional_lights;
+        ComponentArray<SceneEnvironment> environments;
+
+        // function(components) for every component array, in file order
+        template<typename F>
+        void for_each_component(F&& function)
+        {
+            function(cubes);
+            function(point_lights);
+            function(spot_lights);
+            function(directional_lights);
+            function(environments);
+        }
+
+        template<typename F>
+        void for_each_component(F&& function) const
+        {
+            function(cubes);
+            function(point_lights);
+            function(spot_lights);
+            function(directional_lights);
+            function(environments);
+        }
+    };
+
+}
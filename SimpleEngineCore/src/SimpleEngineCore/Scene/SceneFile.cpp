@@ -0,0 +1,686 @@
+#include "SceneFile.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Assets/MappedFile.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+namespace SimpleEngine {
+
+    using namespace SceneFileFormat;
+
+    static bool is_range_valid(const uint64_t offset, const uint64_t size, const size_t file_size)
+    {
+        return offset <= file_size && size <= file_size - offset;
+    }
+
+    static uint64_t align(const uint64_t offset)
+    {
+        return (offset + alignment - 1) & ~static_cast<uint64_t>(alignment - 1);
+    }
+
+    static std::string_view get_record_name(const char (&name)[max_name_size])
+    {
+        const void* pEnd = std::memchr(name, '\0', max_name_size);
+        return std::string_view(name, pEnd != nullptr ? static_cast<const char*>(pEnd) - name : max_name_size);
+    }
+
+    static void set_record_name(char (&name)[max_name_size], const char* value)
+    {
+        std::memset(name, 0, max_name_size);
+        std::memcpy(name, value, std::min(std::strlen(value), max_name_size));
+    }
+
+    static const char* get_type_name(const EFieldType type)
+    {
+        switch (type)
+        {
+            case EFieldType::Float: return "float";
+            case EFieldType::UInt32: return "uint";
+            case EFieldType::Bool: return "bool";
+            case EFieldType::Vec3: return "vec3";
+            case EFieldType::Quat: return "quat";
+        }
+        return "";
+    }
+
+    static bool parse_type_name(std::string_view name, EFieldType& type)
+    {
+        for (const EFieldType candidate : { EFieldType::Float, EFieldType::UInt32, EFieldType::Bool, EFieldType::Vec3, EFieldType::Quat })
+        {
+            if (name == get_type_name(candidate))
+            {
+                type = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static size_t get_values_count(const EFieldType type)
+    {
+        switch (type)
+        {
+            case EFieldType::Vec3: return 3;
+            case EFieldType::Quat: return 4;
+            default: return 1;
+        }
+    }
+
+    // written next to the file and renamed over it once complete, a failed save leaves the previous file intact
+    static bool replace_file(const std::string& temp_path, const std::string& path)
+    {
+        std::error_code error;
+        std::filesystem::rename(temp_path, path, error);
+        if (error)
+        {
+            LOG_ERROR("SceneFile: can't replace {0}: {1}", path, error.message());
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+        return true;
+    }
+
+    bool write_scene_binary(const std::string& path, const SceneData& scene)
+    {
+        std::vector<ComponentRecord> components;
+        std::vector<FieldRecord> fields;
+        std::vector<const void*> fields_data;
+        std::vector<uint64_t> fields_sizes;
+        scene.for_each_component([&](const auto& component_array)
+        {
+            using T = typename std::decay_t<decltype(component_array)>::Component;
+            ComponentRecord component{};
+            set_record_name(component.name, Reflection<T>::name);
+            component.count = component_array.size();
+            component.first_field = static_cast<uint32_t>(fields.size());
+            component.fields_count = static_cast<uint32_t>(get_fields_count<T>());
+            components.push_back(component);
+
+            for_each_field<T>([&](const auto& field, auto index)
+            {
+                const auto& array = component_array.template get_array<decltype(index)::value>();
+                using Stored = typename std::decay_t<decltype(array)>::value_type;
+                FieldRecord field_record{};
+                set_record_name(field_record.name, field.name);
+                field_record.type = get_field_type<typename std::decay_t<decltype(field)>::Type>();
+                field_record.element_size = sizeof(Stored);
+                fields.push_back(field_record);
+                fields_data.push_back(array.data());
+                fields_sizes.push_back(component_array.size() * sizeof(Stored));
+            });
+        });
+
+        Header header{};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.components_count = static_cast<uint32_t>(components.size());
+        header.fields_count = static_cast<uint32_t>(fields.size());
+
+        const uint64_t tables_end = sizeof(Header) + components.size() * sizeof(ComponentRecord) + fields.size() * sizeof(FieldRecord);
+        uint64_t offset = tables_end;
+        for (size_t i = 0; i < fields.size(); ++i)
+        {
+            fields[i].offset = align(offset);
+            offset = fields[i].offset + fields_sizes[i];
+        }
+
+        const std::string temp_path = path + ".tmp";
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                LOG_ERROR("SceneFile: can't write {0}", temp_path);
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(components.data()), components.size() * sizeof(ComponentRecord));
+            file.write(reinterpret_cast<const char*>(fields.data()), fields.size() * sizeof(FieldRecord));
+
+            static const char padding[alignment] = {};
+            uint64_t written = tables_end;
+            for (size_t i = 0; i < fields.size(); ++i)
+            {
+                file.write(padding, fields[i].offset - written);
+                file.write(static_cast<const char*>(fields_data[i]), fields_sizes[i]);
+                written = fields[i].offset + fields_sizes[i];
+            }
+            if (!file.flush())
+            {
+                LOG_ERROR("SceneFile: can't write {0}", temp_path);
+                return false;
+            }
+        }
+        return replace_file(temp_path, path);
+    }
+
+    static void append_value(std::string& text, const float value)
+    {
+        // enough digits to read back the same float
+        char buffer[32];
+        const int size = std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+        text.append(buffer, size);
+    }
+
+    static void append_value(std::string& text, const uint32_t value)
+    {
+        char buffer[16];
+        const int size = std::snprintf(buffer, sizeof(buffer), "%u", value);
+        text.append(buffer, size);
+    }
+
+    static void append_value(std::string& text, const uint8_t value)
+    {
+        text += value != 0 ? '1' : '0';
+    }
+
+    static void append_value(std::string& text, const glm::vec3& value)
+    {
+        append_value(text, value.x);
+        text += ' ';
+        append_value(text, value.y);
+        text += ' ';
+        append_value(text, value.z);
+    }
+
+    static void append_value(std::string& text, const glm::quat& value)
+    {
+        append_value(text, value.x);
+        text += ' ';
+        append_value(text, value.y);
+        text += ' ';
+        append_value(text, value.z);
+        text += ' ';
+        append_value(text, value.w);
+    }
+
+    bool write_scene_text(const std::string& path, const SceneData& scene)
+    {
+        const std::string temp_path = path + ".tmp";
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                LOG_ERROR("SceneFile: can't write {0}", temp_path);
+                return false;
+            }
+
+            // written a block at a time rather than built whole, a million cubes make about 100 MB of text
+            constexpr size_t block_size = 1 << 20;
+            std::string text = std::string(text_magic) + " " + std::to_string(version) + "\n";
+            scene.for_each_component([&](const auto& component_array)
+            {
+                using T = typename std::decay_t<decltype(component_array)>::Component;
+                text += Reflection<T>::name;
+                text += ' ';
+                text += std::to_string(component_array.size());
+                for_each_field<T>([&](const auto& field, auto)
+                {
+                    text += ' ';
+                    text += field.name;
+                    text += ':';
+                    text += get_type_name(get_field_type<typename std::decay_t<decltype(field)>::Type>());
+                });
+                text += '\n';
+
+                for (size_t i = 0; i < component_array.size(); ++i)
+                {
+                    for_each_field<T>([&](const auto&, auto index)
+                    {
+                        if (decltype(index)::value != 0)
+                        {
+                            text += ' ';
+                        }
+                        append_value(text, component_array.template get_array<decltype(index)::value>()[i]);
+                    });
+                    text += '\n';
+                    if (text.size() >= block_size)
+                    {
+                        file.write(text.data(), text.size());
+                        text.clear();
+                    }
+                }
+            });
+            file.write(text.data(), text.size());
+            if (!file.flush())
+            {
+                LOG_ERROR("SceneFile: can't write {0}", temp_path);
+                return false;
+            }
+        }
+        return replace_file(temp_path, path);
+    }
+
+    static bool read_scene_binary(const std::string& path, const uint8_t* data, const size_t size, SceneData& scene)
+    {
+        Header header;
+        if (size < sizeof(Header))
+        {
+            LOG_ERROR("SceneFile: {0} is too small", path);
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(Header));
+        if (header.version != version)
+        {
+            LOG_ERROR("SceneFile: {0} is version {1}, version {2} is supported", path, header.version, version);
+            return false;
+        }
+        const uint64_t fields_offset = sizeof(Header) + static_cast<uint64_t>(header.components_count) * sizeof(ComponentRecord);
+        if (!is_range_valid(sizeof(Header), static_cast<uint64_t>(header.components_count) * sizeof(ComponentRecord), size)
+            || !is_range_valid(fields_offset, static_cast<uint64_t>(header.fields_count) * sizeof(FieldRecord), size))
+        {
+            LOG_ERROR("SceneFile: {0} has invalid tables", path);
+            return false;
+        }
+
+        // copied out of the mapping, it gives no alignment guarantee to the tables
+        std::vector<ComponentRecord> components(header.components_count);
+        std::vector<FieldRecord> fields(header.fields_count);
+        std::memcpy(components.data(), data + sizeof(Header), components.size() * sizeof(ComponentRecord));
+        std::memcpy(fields.data(), data + fields_offset, fields.size() * sizeof(FieldRecord));
+        for (const ComponentRecord& component : components)
+        {
+            // a component without fields in the file still can't have more objects than the file has bytes
+            bool valid = component.count <= size
+                && component.first_field <= fields.size() && component.fields_count <= fields.size() - component.first_field;
+            for (uint32_t i = 0; valid && i < component.fields_count; ++i)
+            {
+                const FieldRecord& field = fields[component.first_field + i];
+                valid = field.element_size <= size && is_range_valid(field.offset, component.count * field.element_size, size);
+            }
+            if (!valid)
+            {
+                LOG_ERROR("SceneFile: {0} has an invalid component {1}", path, get_record_name(component.name));
+                return false;
+            }
+        }
+
+        scene.for_each_component([&](auto& component_array)
+        {
+            using T = typename std::decay_t<decltype(component_array)>::Component;
+            const ComponentRecord* pComponent = nullptr;
+            for (const ComponentRecord& component : components)
+            {
+                if (get_record_name(component.name) == Reflection<T>::name)
+                {
+                    pComponent = &component;
+                    break;
+                }
+            }
+            if (pComponent == nullptr)
+            {
+                component_array.clear();
+                return;
+            }
+
+            // the defaults stay in the fields the file doesn't have
+            const size_t count = static_cast<size_t>(pComponent->count);
+            component_array.resize(count);
+            for_each_field<T>([&](const auto& field, auto index)
+            {
+                auto& array = component_array.template get_array<decltype(index)::value>();
+                using Stored = typename std::decay_t<decltype(array)>::value_type;
+                constexpr EFieldType type = get_field_type<typename std::decay_t<decltype(field)>::Type>();
+                for (uint32_t i = 0; i < pComponent->fields_count; ++i)
+                {
+                    const FieldRecord& field_record = fields[pComponent->first_field + i];
+                    if (get_record_name(field_record.name) != field.name)
+                    {
+                        continue;
+                    }
+                    if (field_record.type != type || field_record.element_size != sizeof(Stored))
+                    {
+                        LOG_WARN("SceneFile: {0}: {1}.{2} is a {3}, expected a {4}, skipping it",
+                                 path, Reflection<T>::name, field.name, get_type_name(field_record.type), get_type_name(type));
+                        break;
+                    }
+                    std::memcpy(array.data(), data + field_record.offset, count * sizeof(Stored));
+                    break;
+                }
+            });
+        });
+        return true;
+    }
+
+    // Reads the text form line by line. Values are separated by spaces or tabs, a line never runs into the next one.
+    struct TextReader
+    {
+        const char* p;
+        const char* end;
+        size_t line = 1;
+
+        void skip_spaces()
+        {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            {
+                ++p;
+            }
+        }
+
+        bool is_line_end()
+        {
+            skip_spaces();
+            return p == end || *p == '\n';
+        }
+
+        void next_line()
+        {
+            while (p < end && *p != '\n')
+            {
+                ++p;
+            }
+            if (p < end)
+            {
+                ++p;
+                ++line;
+            }
+        }
+
+        std::string_view read_word()
+        {
+            skip_spaces();
+            const char* begin = p;
+            while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+            {
+                ++p;
+            }
+            return std::string_view(begin, p - begin);
+        }
+
+        // the buffer ends with a null character, strtof and strtoul stop there at the latest
+        bool read(float& value)
+        {
+            if (is_line_end())
+            {
+                return false;
+            }
+            char* number_end;
+            value = std::strtof(p, &number_end);
+            const bool read = number_end != p;
+            p = number_end;
+            return read;
+        }
+
+        bool read(uint64_t& value)
+        {
+            if (is_line_end() || *p == '-')
+            {
+                return false;
+            }
+            char* number_end;
+            value = std::strtoull(p, &number_end, 10);
+            const bool read = number_end != p;
+            p = number_end;
+            return read;
+        }
+
+        bool read(uint32_t& value)
+        {
+            uint64_t number;
+            if (!read(number) || number > UINT32_MAX)
+            {
+                return false;
+            }
+            value = static_cast<uint32_t>(number);
+            return true;
+        }
+
+        bool read(uint8_t& value)
+        {
+            uint64_t number;
+            if (!read(number) || number > 1)
+            {
+                return false;
+            }
+            value = static_cast<uint8_t>(number);
+            return true;
+        }
+
+        bool read(glm::vec3& value)
+        {
+            return read(value.x) && read(value.y) && read(value.z);
+        }
+
+        bool read(glm::quat& value)
+        {
+            return read(value.x) && read(value.y) && read(value.z) && read(value.w);
+        }
+
+        bool skip(const EFieldType type)
+        {
+            for (size_t i = 0; i < get_values_count(type); ++i)
+            {
+                if (read_word().empty())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    struct TextField
+    {
+        std::string_view name;
+        EFieldType type;
+    };
+
+    template<typename T>
+    static bool read_text_components(const std::string& path, TextReader& reader, const std::vector<TextField>& text_fields,
+                                     const size_t count, ComponentArray<T>& component_array)
+    {
+        // the reflected field each column goes to, fields_count for the columns skipped
+        constexpr size_t fields_count = get_fields_count<T>();
+        std::vector<size_t> field_indices(text_fields.size(), fields_count);
+        for (size_t column = 0; column < text_fields.size(); ++column)
+        {
+            for_each_field<T>([&](const auto& field, auto index)
+            {
+                if (text_fields[column].name != field.name)
+                {
+                    return;
+                }
+                constexpr EFieldType type = get_field_type<typename std::decay_t<decltype(field)>::Type>();
+                if (text_fields[column].type != type)
+                {
+                    LOG_WARN("SceneFile: {0}: {1}.{2} is a {3}, expected a {4}, skipping it",
+                             path, Reflection<T>::name, field.name, get_type_name(text_fields[column].type), get_type_name(type));
+                    return;
+                }
+                field_indices[column] = decltype(index)::value;
+            });
+        }
+
+        component_array.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t column = 0; column < text_fields.size(); ++column)
+            {
+                bool read = false;
+                if (field_indices[column] == fields_count)
+                {
+                    read = reader.skip(text_fields[column].type);
+                }
+                else
+                {
+                    for_each_field<T>([&](const auto&, auto index)
+                    {
+                        if (decltype(index)::value == field_indices[column])
+                        {
+                            read = reader.read(component_array.template get_array<decltype(index)::value>()[i]);
+                        }
+                    });
+                }
+                if (!read)
+                {
+                    LOG_ERROR("SceneFile: {0} line {1}: invalid {2} value for {3}.{4}",
+                              path, reader.line, get_type_name(text_fields[column].type), Reflection<T>::name, text_fields[column].name);
+                    return false;
+                }
+            }
+            if (!reader.is_line_end())
+            {
+                LOG_ERROR("SceneFile: {0} line {1}: more values than the {2} header lists", path, reader.line, Reflection<T>::name);
+                return false;
+            }
+            reader.next_line();
+        }
+        return true;
+    }
+
+    static bool read_scene_text(const std::string& path, const std::string& text, SceneData& scene)
+    {
+        TextReader reader{ text.data(), text.data() + text.size() };
+        uint64_t file_version = 0;
+        if (reader.read_word() != "SimpleEngine" || reader.read_word() != "scene" || !reader.read(file_version) || file_version != version)
+        {
+            LOG_ERROR("SceneFile: {0} isn't a version {1} text scene", path, version);
+            return false;
+        }
+        reader.next_line();
+
+        std::vector<TextField> text_fields;
+        while (true)
+        {
+            while (reader.p < reader.end && reader.is_line_end())
+            {
+                reader.next_line();
+            }
+            if (reader.p == reader.end)
+            {
+                return true;
+            }
+
+            const size_t header_line = reader.line;
+            const std::string_view name = reader.read_word();
+            uint64_t count = 0;
+            // a component takes a line per object
+            if (!reader.read(count) || count > text.size())
+            {
+                LOG_ERROR("SceneFile: {0} line {1}: expected the count of {2}", path, header_line, name);
+                return false;
+            }
+            text_fields.clear();
+            while (!reader.is_line_end())
+            {
+                const std::string_view word = reader.read_word();
+                const size_t separator = word.find(':');
+                TextField text_field;
+                if (separator == std::string_view::npos || !parse_type_name(word.substr(separator + 1), text_field.type))
+                {
+                    LOG_ERROR("SceneFile: {0} line {1}: expected name:type, got {2}", path, header_line, word);
+                    return false;
+                }
+                text_field.name = word.substr(0, separator);
+                text_fields.push_back(text_field);
+            }
+            reader.next_line();
+
+            bool known = false;
+            bool read = true;
+            scene.for_each_component([&](auto& component_array)
+            {
+                using T = typename std::decay_t<decltype(component_array)>::Component;
+                if (!known && name == Reflection<T>::name)
+                {
+                    known = true;
+                    read = read_text_components(path, reader, text_fields, static_cast<size_t>(count), component_array);
+                }
+            });
+            if (!read)
+            {
+                return false;
+            }
+            if (!known)
+            {
+                LOG_WARN("SceneFile: {0} line {1}: skipping unknown component {2}", path, header_line, name);
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    reader.next_line();
+                }
+            }
+        }
+    }
+
+    // parents must be other cubes of the scene and can't loop, TransformHierarchy trusts them
+    static bool are_cube_parents_valid(const ComponentArray<SceneCube>& cubes)
+    {
+        const std::vector<uint32_t>& parents = cubes.get_field<&SceneCube::parent>();
+        // 0: not visited, 1: on the chain being walked, 2: leads to a root
+        std::vector<uint8_t> states(cubes.size(), 0);
+        for (const uint32_t parent : parents)
+        {
+            if (parent != SceneCube::no_parent && parent >= cubes.size())
+            {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < cubes.size(); ++i)
+        {
+            uint32_t cube = static_cast<uint32_t>(i);
+            while (cube != SceneCube::no_parent && states[cube] == 0)
+            {
+                states[cube] = 1;
+                cube = parents[cube];
+            }
+            if (cube != SceneCube::no_parent && states[cube] == 1)
+            {
+                return false;
+            }
+            for (cube = static_cast<uint32_t>(i); cube != SceneCube::no_parent && states[cube] == 1; cube = parents[cube])
+            {
+                states[cube] = 2;
+            }
+        }
+        return true;
+    }
+
+    bool read_scene(const std::string& path, SceneData& scene)
+    {
+        scene.for_each_component([](auto& component_array) { component_array.clear(); });
+
+        MappedFile file;
+        if (!file.open(path))
+        {
+            return false;
+        }
+        // one pass from the start to the end, the OS can read it all ahead
+        file.prefetch(0, file.get_size());
+
+        bool read = false;
+        const size_t text_magic_size = sizeof(text_magic) - 1;
+        if (file.get_size() >= sizeof(magic) && std::memcmp(file.get_data(), magic, sizeof(magic)) == 0)
+        {
+            read = read_scene_binary(path, file.get_data(), file.get_size(), scene);
+        }
+        else if (file.get_size() >= text_magic_size && std::memcmp(file.get_data(), text_magic, text_magic_size) == 0)
+        {
+            // copied for the null character the number parsing relies on
+            const std::string text(reinterpret_cast<const char*>(file.get_data()), file.get_size());
+            read = read_scene_text(path, text, scene);
+        }
+        else
+        {
+            LOG_ERROR("SceneFile: {0} isn't a scene file", path);
+        }
+
+        if (read && !are_cube_parents_valid(scene.cubes))
+        {
+            LOG_ERROR("SceneFile: {0} has cubes parented to missing cubes or to their own children", path);
+            read = false;
+        }
+        if (!read)
+        {
+            scene.for_each_component([](auto& component_array) { component_array.clear(); });
+        }
+        return read;
+    }
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "SimpleEngineCore/Scene/SceneData.hpp"
+
+#include <string>
+
+namespace SimpleEngine {
+
+    // Scene files in two forms holding the same SceneData, components and fields matched by their reflected names:
+    // fields missing from a file keep their defaults and the ones the engine doesn't know are skipped, so files
+    // survive adding fields. Renaming one or changing its type drops it from older files.
+    //
+    // Binary, little endian: Header, the component records, the field records, then each field's array as it is
+    // in memory, starting on a 64 byte boundary. Loading maps the file and copies each array whole, the time it
+    // takes is reading the file.
+    //
+    // Text, for diffing: "SimpleEngine scene 1", then per component a line with its name, count and name:type fields
+    // (float, uint, bool, vec3, quat as x y z w) followed by one line of values per component.
+    namespace SceneFileFormat {
+
+        constexpr char magic[8] = { 'S', 'E', 'S', 'C', 'E', 'N', 'E', '\0' };
+        constexpr char text_magic[] = "SimpleEngine scene";
+        constexpr uint32_t version = 1;
+        constexpr uint32_t alignment = 64;
+        constexpr size_t max_name_size = 32;
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t components_count;
+            uint32_t fields_count;
+            uint32_t reserved;
+        };
+        static_assert(sizeof(Header) == 24, "Header is read straight from the file");
+
+        struct ComponentRecord
+        {
+            // null padded, not necessarily null terminated
+            char name[max_name_size];
+            uint64_t count;
+            uint32_t first_field;
+            uint32_t fields_count;
+        };
+        static_assert(sizeof(ComponentRecord) == 48, "ComponentRecord is read straight from the file");
+
+        struct FieldRecord
+        {
+            char name[max_name_size];
+            EFieldType type;
+            uint32_t element_size;
+            // from the start of the file, count * element_size bytes
+            uint64_t offset;
+        };
+        static_assert(sizeof(FieldRecord) == 48, "FieldRecord is read straight from the file");
+
+    }
+
+    // false with the error logged
+    bool write_scene_binary(const std::string& path, const SceneData& scene);
+    bool write_scene_text(const std::string& path, const SceneData& scene);
+
+    // either form, told apart by the first bytes; false with the error logged and scene emptied when the file
+    // can't be read or references cubes it doesn't have
+    bool read_scene(const std::string& path, SceneData& scene);
+
+}
@@ -0,0 +1,67 @@
+#include "SceneSaver.hpp"
+
+#include "SimpleEngineCore/Scene/SceneFile.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <chrono>
+
+namespace SimpleEngine {
+
+    SceneSaver::SceneSaver()
+    {
+        m_writer = std::thread([this]() { write(); });
+    }
+
+
+    SceneSaver::~SceneSaver()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_request_ready.notify_one();
+        m_writer.join();
+    }
+
+
+    void SceneSaver::save(SceneData&& scene, const std::string& path, const bool text)
+    {
+        m_pending_count.fetch_add(1, std::memory_order_acq_rel);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.push_back(Request{ std::move(scene), path, text });
+        }
+        m_request_ready.notify_one();
+    }
+
+
+    void SceneSaver::write()
+    {
+        while (true)
+        {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_request_ready.wait(lock, [this] { return m_stop || !m_requests.empty(); });
+                // pending saves are written before stopping
+                if (m_requests.empty())
+                {
+                    return;
+                }
+                request = std::move(m_requests.front());
+                m_requests.pop_front();
+            }
+
+            const auto start_time = std::chrono::steady_clock::now();
+            const bool written = request.text ? write_scene_text(request.path, request.scene) : write_scene_binary(request.path, request.scene);
+            if (written)
+            {
+                const double time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+                LOG_INFO("Saved scene {0}: {1} cubes, {2} point lights, {3} spot lights in {4:.1f} ms",
+                         request.path, request.scene.cubes.size(), request.scene.point_lights.size(), request.scene.spot_lights.size(), time_ms);
+            }
+            m_pending_count.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+}
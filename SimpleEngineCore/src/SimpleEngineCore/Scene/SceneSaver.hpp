@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SimpleEngineCore/Scene/SceneData.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace SimpleEngine {
+
+    // Writes scene snapshots on a thread of its own, the main thread only pays for taking the snapshot.
+    // Saves are written in the order they were requested; the destructor finishes the pending ones.
+    // A thread rather than a JobSystem job for the same reason as FramebufferReadback's encoder.
+    class SceneSaver
+    {
+    public:
+        SceneSaver();
+        ~SceneSaver();
+
+        SceneSaver(const SceneSaver&) = delete;
+        SceneSaver& operator=(const SceneSaver&) = delete;
+
+        void save(SceneData&& scene, const std::string& path, const bool text);
+        // from save() until the file is written
+        bool is_saving() const { return m_pending_count.load(std::memory_order_acquire) > 0; }
+
+    private:
+        struct Request
+        {
+            SceneData scene;
+            std::string path;
+            bool text = false;
+        };
+
+        void write();
+
+        std::thread m_writer;
+        std::mutex m_mutex;
+        std::condition_variable m_request_ready;
+        std::deque<Request> m_requests;
+        std::atomic<size_t> m_pending_count{ 0 };
+        bool m_stop = false;
+    };
+
+}
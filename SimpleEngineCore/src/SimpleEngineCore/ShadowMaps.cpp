@@ -0,0 +1,220 @@
+#include "SimpleEngineCore/ShadowMaps.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace SimpleEngine {
+
+    // a depth32F texel in both the cache and the live atlas
+    constexpr size_t bytes_per_atlas_texel = 2 * sizeof(float);
+
+    static uint32_t compact_bits(uint32_t value)
+    {
+        value &= 0x55555555;
+        value = (value | (value >> 1)) & 0x33333333;
+        value = (value | (value >> 2)) & 0x0F0F0F0F;
+        value = (value | (value >> 4)) & 0x00FF00FF;
+        value = (value | (value >> 8)) & 0x0000FFFF;
+        return value;
+    }
+
+    ShadowMaps::ShadowMaps(const size_t memory_budget_bytes)
+    {
+        set_memory_budget(memory_budget_bytes);
+    }
+
+    void ShadowMaps::set_memory_budget(const size_t memory_budget_bytes)
+    {
+        m_memory_budget_bytes = memory_budget_bytes;
+        uint32_t atlas_size = max_atlas_size;
+        while (atlas_size > min_atlas_size && static_cast<size_t>(atlas_size) * atlas_size * bytes_per_atlas_texel > memory_budget_bytes)
+        {
+            atlas_size /= 2;
+        }
+        if (atlas_size != m_atlas_size)
+        {
+            m_atlas_size = atlas_size;
+            m_requested_resolutions.clear();
+            m_tiles.clear();
+            invalidate_all();
+        }
+        m_stats.atlas_bytes = static_cast<size_t>(m_atlas_size) * m_atlas_size * bytes_per_atlas_texel;
+    }
+
+    void ShadowMaps::allocate(const std::vector<uint32_t>& requested_resolutions)
+    {
+        if (requested_resolutions == m_requested_resolutions)
+        {
+            return;
+        }
+        m_requested_resolutions = requested_resolutions;
+
+        const size_t shadows_count = requested_resolutions.size();
+        std::vector<uint32_t> sizes(shadows_count, 0);
+        uint64_t used_area = 0;
+        for (size_t i = 0; i < shadows_count; ++i)
+        {
+            if (requested_resolutions[i] == 0)
+            {
+                continue;
+            }
+            // tiles are powers of two so they pack without gaps
+            uint32_t size = min_resolution;
+            while (size < requested_resolutions[i] && size < m_atlas_size)
+            {
+                size *= 2;
+            }
+            sizes[i] = size;
+            used_area += static_cast<uint64_t>(size) * size;
+        }
+
+        m_stats.downgraded_shadows_count = 0;
+        m_stats.dropped_shadows_count = 0;
+        std::vector<uint8_t> downgraded(shadows_count, 0);
+        const uint64_t atlas_area = static_cast<uint64_t>(m_atlas_size) * m_atlas_size;
+        while (used_area > atlas_area)
+        {
+            size_t largest = 0;
+            for (size_t i = 0; i < shadows_count; ++i)
+            {
+                if (sizes[i] >= sizes[largest])
+                {
+                    largest = i;
+                }
+            }
+            used_area -= static_cast<uint64_t>(sizes[largest]) * sizes[largest];
+            downgraded[largest] = 1;
+            if (sizes[largest] == min_resolution)
+            {
+                sizes[largest] = 0;
+                ++m_stats.dropped_shadows_count;
+                continue;
+            }
+            sizes[largest] /= 2;
+            used_area += static_cast<uint64_t>(sizes[largest]) * sizes[largest];
+        }
+
+        // Placing tiles from the largest down at the Morton position of their offset never overlaps:
+        // every offset is a multiple of the current tile area, i.e. an aligned square of that size.
+        std::vector<size_t> order(shadows_count);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) { return sizes[a] > sizes[b]; });
+
+        std::vector<Tile> tiles(shadows_count);
+        uint64_t offset = 0;
+        for (const size_t i : order)
+        {
+            if (sizes[i] == 0)
+            {
+                break;
+            }
+            const uint64_t area = static_cast<uint64_t>(sizes[i]) * sizes[i];
+            const uint32_t tile_index = static_cast<uint32_t>(offset / area);
+            tiles[i].x = compact_bits(tile_index) * sizes[i];
+            tiles[i].y = compact_bits(tile_index >> 1) * sizes[i];
+            tiles[i].size = sizes[i];
+            offset += area;
+        }
+
+        m_cache_states.resize(shadows_count);
+        for (size_t i = 0; i < shadows_count; ++i)
+        {
+            const bool tile_changed = i >= m_tiles.size() || tiles[i].x != m_tiles[i].x || tiles[i].y != m_tiles[i].y || tiles[i].size != m_tiles[i].size;
+            if (tile_changed)
+            {
+                m_cache_states[i].valid = false;
+            }
+            m_stats.downgraded_shadows_count += downgraded[i] && sizes[i] != 0 ? 1 : 0;
+        }
+        m_tiles = std::move(tiles);
+        m_stats.shadows_count = std::count_if(sizes.begin(), sizes.end(), [](const uint32_t size) { return size != 0; });
+        m_stats.used_bytes = static_cast<size_t>(offset) * bytes_per_atlas_texel;
+    }
+
+    glm::mat4 ShadowMaps::get_atlas_matrix(const size_t shadow_index) const
+    {
+        const Tile& tile = m_tiles[shadow_index];
+        const float half_size = 0.5f * tile.size / m_atlas_size;
+        return glm::mat4(half_size, 0.f, 0.f, 0.f,
+                         0.f, half_size, 0.f, 0.f,
+                         0.f, 0.f, 0.5f, 0.f,
+                         static_cast<float>(tile.x) / m_atlas_size + half_size, static_cast<float>(tile.y) / m_atlas_size + half_size, 0.5f, 1.f);
+    }
+
+    glm::vec4 ShadowMaps::get_atlas_rect(const size_t shadow_index) const
+    {
+        const Tile& tile = m_tiles[shadow_index];
+        const float atlas_size = static_cast<float>(m_atlas_size);
+        return glm::vec4(tile.x, tile.y, tile.x + tile.size, tile.y + tile.size) / atlas_size;
+    }
+
+    bool ShadowMaps::needs_static_redraw(const size_t shadow_index, const glm::mat4& light_view_projection, const uint64_t static_geometry_version)
+    {
+        CacheState& state = m_cache_states[shadow_index];
+        if (state.valid && state.light_view_projection == light_view_projection && state.static_geometry_version >= static_geometry_version)
+        {
+            ++m_stats.cache_hits;
+            return false;
+        }
+        state.light_view_projection = light_view_projection;
+        state.static_geometry_version = static_geometry_version;
+        state.valid = true;
+        ++m_stats.cache_misses;
+        return true;
+    }
+
+    void ShadowMaps::invalidate_all()
+    {
+        for (CacheState& state : m_cache_states)
+        {
+            state.valid = false;
+        }
+    }
+
+    void ShadowMaps::begin_frame()
+    {
+        m_stats.cache_hits = 0;
+        m_stats.cache_misses = 0;
+        m_stats.static_casters_drawn = 0;
+        m_stats.dynamic_casters_drawn = 0;
+    }
+
+    void ShadowMaps::record_casters_drawn(const size_t static_count, const size_t dynamic_count)
+    {
+        m_stats.static_casters_drawn += static_count;
+        m_stats.dynamic_casters_drawn += dynamic_count;
+    }
+
+    void ShadowMaps::record_times(const double cpu_time_ms, const double gpu_time_ms)
+    {
+        m_stats.cpu_time_ms = cpu_time_ms;
+        m_stats.gpu_time_ms = gpu_time_ms;
+    }
+
+    static glm::vec3 get_up_vector(const glm::vec3& direction)
+    {
+        // world up is +Z
+        return std::abs(direction.z) > 0.99f ? glm::vec3(0.f, 1.f, 0.f) : glm::vec3(0.f, 0.f, 1.f);
+    }
+
+    glm::mat4 ShadowMaps::get_view_projection(const DirectionalLight& light)
+    {
+        const glm::vec3 direction = glm::normalize(light.direction);
+        const float extent = light.shadow_extent;
+        const glm::mat4 view_matrix = glm::lookAt(light.shadow_center - direction * (2.f * extent), light.shadow_center, get_up_vector(direction));
+        return glm::ortho(-extent, extent, -extent, extent, extent, 3.f * extent) * view_matrix;
+    }
+
+    glm::mat4 ShadowMaps::get_view_projection(const SpotLight& light)
+    {
+        const glm::vec3 direction = glm::normalize(light.direction);
+        const glm::mat4 view_matrix = glm::lookAt(light.position, light.position + direction, get_up_vector(direction));
+        return glm::perspective(glm::radians(2.f * light.outer_angle), 1.f, 0.1f, light.range) * view_matrix;
+    }
+}
@@ -0,0 +1,531 @@
+#include "SimpleEngineCore/TransformHierarchy.hpp"
+#include "SimpleEngineCore/JobSystem.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Math/BatchMath.hpp"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace SimpleEngine {
+
+    constexpr uint32_t invalid_index = UINT32_MAX;
+    constexpr size_t update_grain_size = 1024;
+    // local matrices composed per BatchMath call
+    constexpr uint32_t update_batch_size = 64;
+    // ranges ahead whose first node is prefetched; the parent's world matrix is prefetched half as far ahead,
+    // once its index has arrived
+    constexpr size_t update_prefetch_distance = 8;
+
+    static inline uint32_t count_trailing_zeros(const uint64_t bits)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(bits));
+#endif
+    }
+
+    static inline void prefetch(const void* p)
+    {
+#if defined(_MSC_VER)
+        _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+        __builtin_prefetch(p);
+#endif
+    }
+
+    static size_t get_dirty_words_count(const size_t nodes_count)
+    {
+        return (nodes_count + 63) / 64;
+    }
+
+    TransformHierarchy::NodeId TransformHierarchy::create_node(const NodeId parent,
+                                                               const glm::vec3& position,
+                                                               const glm::quat& rotation,
+                                                               const glm::vec3& scale)
+    {
+        NodeId node;
+        if (!m_free_nodes.empty())
+        {
+            node = m_free_nodes.back();
+            m_free_nodes.pop_back();
+        }
+        else
+        {
+            node = static_cast<NodeId>(m_node_to_index.size());
+            m_node_to_index.push_back(invalid_index);
+        }
+
+        const uint32_t index = static_cast<uint32_t>(m_world_matrices.size());
+        m_node_to_index[node] = index;
+        m_index_to_node.push_back(node);
+        m_parent_indices.push_back(parent == invalid_node ? invalid_index : m_node_to_index[parent]);
+        m_first_child_indices.push_back(0);
+        m_children_counts.push_back(0);
+        m_local_positions.push_back(position);
+        m_local_rotations.push_back(rotation);
+        m_local_scales.push_back(scale);
+        m_world_matrices.emplace_back(1.f);
+        m_normal_matrices.emplace_back(1.f);
+        m_world_versions.push_back(0);
+        m_dirty_bits.resize(get_dirty_words_count(m_world_matrices.size()), 0);
+
+        mark_dirty(index);
+        m_order_dirty = true;
+        return node;
+    }
+
+    void TransformHierarchy::create_nodes(const size_t count,
+                                          const glm::vec3* positions,
+                                          const glm::quat* rotations,
+                                          const glm::vec3* scales,
+                                          const uint32_t* parents,
+                                          NodeId* nodes)
+    {
+        const uint32_t first_index = static_cast<uint32_t>(m_world_matrices.size());
+        const size_t new_count = first_index + count;
+        for (size_t i = 0; i < count; ++i)
+        {
+            NodeId node;
+            if (!m_free_nodes.empty())
+            {
+                node = m_free_nodes.back();
+                m_free_nodes.pop_back();
+            }
+            else
+            {
+                node = static_cast<NodeId>(m_node_to_index.size());
+                m_node_to_index.push_back(invalid_index);
+            }
+            m_node_to_index[node] = first_index + static_cast<uint32_t>(i);
+            nodes[i] = node;
+        }
+
+        m_index_to_node.insert(m_index_to_node.end(), nodes, nodes + count);
+        m_parent_indices.resize(new_count, invalid_index);
+        if (parents != nullptr)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (parents[i] < count)
+                {
+                    m_parent_indices[first_index + i] = first_index + parents[i];
+                }
+            }
+        }
+        m_first_child_indices.resize(new_count, 0);
+        m_children_counts.resize(new_count, 0);
+        m_local_positions.insert(m_local_positions.end(), positions, positions + count);
+        m_local_rotations.insert(m_local_rotations.end(), rotations, rotations + count);
+        m_local_scales.insert(m_local_scales.end(), scales, scales + count);
+        m_world_matrices.resize(new_count, glm::mat4(1.f));
+        m_normal_matrices.resize(new_count, glm::mat3(1.f));
+        m_world_versions.resize(new_count, 0);
+
+        m_dirty_bits.resize(get_dirty_words_count(new_count), 0);
+        for (size_t index = first_index; index < new_count; ++index)
+        {
+            mark_dirty(static_cast<uint32_t>(index));
+        }
+        m_order_dirty = true;
+    }
+
+    void TransformHierarchy::destroy_node(const NodeId node)
+    {
+        if (!is_alive(node))
+        {
+            return;
+        }
+        m_pending_destroy.push_back(m_node_to_index[node]);
+        m_order_dirty = true;
+    }
+
+    void TransformHierarchy::set_parent(const NodeId node, const NodeId parent)
+    {
+        const uint32_t index = m_node_to_index[node];
+        const uint32_t parent_index = parent == invalid_node ? invalid_index : m_node_to_index[parent];
+
+        for (uint32_t ancestor = parent_index; ancestor != invalid_index; ancestor = m_parent_indices[ancestor])
+        {
+            if (ancestor == index)
+            {
+                LOG_ERROR("TransformHierarchy: can't attach node {0} to its own descendant {1}", node, parent);
+                return;
+            }
+        }
+
+        m_parent_indices[index] = parent_index;
+        mark_dirty(index);
+        m_order_dirty = true;
+    }
+
+    void TransformHierarchy::set_local_position(const NodeId node, const glm::vec3& position)
+    {
+        const uint32_t index = m_node_to_index[node];
+        m_local_positions[index] = position;
+        mark_dirty(index);
+    }
+
+    void TransformHierarchy::set_local_rotation(const NodeId node, const glm::quat& rotation)
+    {
+        const uint32_t index = m_node_to_index[node];
+        m_local_rotations[index] = rotation;
+        mark_dirty(index);
+    }
+
+    void TransformHierarchy::set_local_scale(const NodeId node, const glm::vec3& scale)
+    {
+        const uint32_t index = m_node_to_index[node];
+        m_local_scales[index] = scale;
+        mark_dirty(index);
+    }
+
+    void TransformHierarchy::set_local_transform(const NodeId node, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        const uint32_t index = m_node_to_index[node];
+        m_local_positions[index] = position;
+        m_local_rotations[index] = rotation;
+        m_local_scales[index] = scale;
+        mark_dirty(index);
+    }
+
+    TransformHierarchy::NodeId TransformHierarchy::get_parent(const NodeId node) const
+    {
+        const uint32_t parent_index = m_parent_indices[m_node_to_index[node]];
+        return parent_index == invalid_index ? invalid_node : m_index_to_node[parent_index];
+    }
+
+    bool TransformHierarchy::is_alive(const NodeId node) const
+    {
+        return node < m_node_to_index.size() && m_node_to_index[node] != invalid_index;
+    }
+
+    void TransformHierarchy::mark_dirty(const uint32_t index)
+    {
+        uint64_t& word = m_dirty_bits[index / 64];
+        const uint64_t bit = uint64_t(1) << (index % 64);
+        if (!(word & bit))
+        {
+            word |= bit;
+            ++m_dirty_count;
+        }
+    }
+
+    void TransformHierarchy::rebuild_order()
+    {
+        const size_t old_count = m_world_matrices.size();
+
+        std::vector<uint8_t> removed(old_count, 0);
+        for (const uint32_t index : m_pending_destroy)
+        {
+            removed[index] = 1;
+        }
+        m_pending_destroy.clear();
+
+        // children adjacency of the current (possibly unordered) arrays
+        std::vector<uint32_t> children_offsets(old_count + 1, 0);
+        for (size_t i = 0; i < old_count; ++i)
+        {
+            if (m_parent_indices[i] != invalid_index)
+            {
+                ++children_offsets[m_parent_indices[i] + 1];
+            }
+        }
+        for (size_t i = 0; i < old_count; ++i)
+        {
+            children_offsets[i + 1] += children_offsets[i];
+        }
+        std::vector<uint32_t> children(children_offsets[old_count]);
+        std::vector<uint32_t> fill_positions(children_offsets.begin(), children_offsets.end() - 1);
+        for (size_t i = 0; i < old_count; ++i)
+        {
+            if (m_parent_indices[i] != invalid_index)
+            {
+                children[fill_positions[m_parent_indices[i]]++] = static_cast<uint32_t>(i);
+            }
+        }
+
+        // breadth-first traversal; subtrees of removed nodes are never reached
+        std::vector<uint32_t> order;
+        order.reserve(old_count);
+        for (size_t i = 0; i < old_count; ++i)
+        {
+            if (m_parent_indices[i] == invalid_index && !removed[i])
+            {
+                order.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        std::vector<uint32_t> first_child_indices(old_count);
+        std::vector<uint32_t> children_counts(old_count);
+        m_level_offsets.clear();
+        m_level_offsets.push_back(0);
+        size_t level_begin = 0;
+        while (level_begin < order.size())
+        {
+            const size_t level_end = order.size();
+            for (size_t new_index = level_begin; new_index < level_end; ++new_index)
+            {
+                const uint32_t old_index = order[new_index];
+                first_child_indices[new_index] = static_cast<uint32_t>(order.size());
+                for (uint32_t c = children_offsets[old_index]; c < children_offsets[old_index + 1]; ++c)
+                {
+                    if (!removed[children[c]])
+                    {
+                        order.push_back(children[c]);
+                    }
+                }
+                children_counts[new_index] = static_cast<uint32_t>(order.size()) - first_child_indices[new_index];
+            }
+            m_level_offsets.push_back(static_cast<uint32_t>(level_end));
+            level_begin = level_end;
+        }
+
+        std::vector<uint32_t> old_to_new(old_count, invalid_index);
+        for (size_t new_index = 0; new_index < order.size(); ++new_index)
+        {
+            old_to_new[order[new_index]] = static_cast<uint32_t>(new_index);
+        }
+
+        const size_t new_count = order.size();
+        std::vector<uint32_t> parent_indices(new_count);
+        std::vector<glm::vec3> local_positions(new_count);
+        std::vector<glm::quat> local_rotations(new_count);
+        std::vector<glm::vec3> local_scales(new_count);
+        std::vector<glm::mat4> world_matrices(new_count);
+        std::vector<glm::mat3> normal_matrices(new_count);
+        std::vector<uint64_t> world_versions(new_count);
+        std::vector<uint64_t> dirty_bits(get_dirty_words_count(new_count), 0);
+        std::vector<NodeId> index_to_node(new_count);
+
+        m_dirty_count = 0;
+        for (size_t new_index = 0; new_index < new_count; ++new_index)
+        {
+            const uint32_t old_index = order[new_index];
+            const uint32_t old_parent = m_parent_indices[old_index];
+            parent_indices[new_index] = old_parent == invalid_index ? invalid_index : old_to_new[old_parent];
+            local_positions[new_index] = m_local_positions[old_index];
+            local_rotations[new_index] = m_local_rotations[old_index];
+            local_scales[new_index] = m_local_scales[old_index];
+            world_matrices[new_index] = m_world_matrices[old_index];
+            normal_matrices[new_index] = m_normal_matrices[old_index];
+            world_versions[new_index] = m_world_versions[old_index];
+            index_to_node[new_index] = m_index_to_node[old_index];
+            m_node_to_index[index_to_node[new_index]] = static_cast<uint32_t>(new_index);
+            if (m_dirty_bits[old_index / 64] & (uint64_t(1) << (old_index % 64)))
+            {
+                dirty_bits[new_index / 64] |= uint64_t(1) << (new_index % 64);
+                ++m_dirty_count;
+            }
+        }
+
+        for (size_t old_index = 0; old_index < old_count; ++old_index)
+        {
+            if (old_to_new[old_index] == invalid_index)
+            {
+                const NodeId node = m_index_to_node[old_index];
+                m_node_to_index[node] = invalid_index;
+                m_free_nodes.push_back(node);
+            }
+        }
+
+        first_child_indices.resize(new_count);
+        children_counts.resize(new_count);
+
+        m_parent_indices = std::move(parent_indices);
+        m_first_child_indices = std::move(first_child_indices);
+        m_children_counts = std::move(children_counts);
+        m_local_positions = std::move(local_positions);
+        m_local_rotations = std::move(local_rotations);
+        m_local_scales = std::move(local_scales);
+        m_world_matrices = std::move(world_matrices);
+        m_normal_matrices = std::move(normal_matrices);
+        m_world_versions = std::move(world_versions);
+        m_dirty_bits = std::move(dirty_bits);
+        m_index_to_node = std::move(index_to_node);
+
+        m_order_dirty = false;
+    }
+
+    void TransformHierarchy::update_run(const uint32_t first, const uint32_t last)
+    {
+        // reused across calls, runs of a single node are common and shouldn't pay for constructing a whole batch
+        static thread_local std::vector<glm::mat4> s_local_matrices(update_batch_size);
+        glm::mat4* local_matrices = s_local_matrices.data();
+        for (uint32_t batch_first = first; batch_first < last; batch_first += update_batch_size)
+        {
+            const uint32_t batch_count = std::min(last - batch_first, update_batch_size);
+            for (uint32_t i = 0; i < batch_count; ++i)
+            {
+                const uint32_t index = batch_first + i;
+                const glm::mat3 rotation = glm::mat3_cast(m_local_rotations[index]);
+                const glm::vec3& scale = m_local_scales[index];
+                local_matrices[i] = glm::mat4(glm::vec4(rotation[0] * scale.x, 0.f),
+                                              glm::vec4(rotation[1] * scale.y, 0.f),
+                                              glm::vec4(rotation[2] * scale.z, 0.f),
+                                              glm::vec4(m_local_positions[index], 1.f));
+            }
+
+            // siblings are adjacent: one product call per parent, roots take their local matrix
+            uint32_t siblings_begin = 0;
+            while (siblings_begin < batch_count)
+            {
+                const uint32_t parent_index = m_parent_indices[batch_first + siblings_begin];
+                uint32_t siblings_end = siblings_begin + 1;
+                while (siblings_end < batch_count && m_parent_indices[batch_first + siblings_end] == parent_index)
+                {
+                    ++siblings_end;
+                }
+                glm::mat4* pWorld = &m_world_matrices[batch_first + siblings_begin];
+                if (parent_index == invalid_index)
+                {
+                    std::copy(local_matrices + siblings_begin, local_matrices + siblings_end, pWorld);
+                }
+                else
+                {
+                    BatchMath::mat4_mul(m_world_matrices[parent_index], local_matrices + siblings_begin, pWorld, siblings_end - siblings_begin);
+                }
+                siblings_begin = siblings_end;
+            }
+
+            BatchMath::normal_matrix(&m_world_matrices[batch_first], &m_normal_matrices[batch_first], batch_count);
+            std::fill(m_world_versions.begin() + batch_first, m_world_versions.begin() + batch_first + batch_count, m_update_count);
+        }
+    }
+
+    void TransformHierarchy::update_nodes(const IndexRange* ranges, const size_t count)
+    {
+        m_range_offsets.resize(count + 1);
+        m_range_offsets[0] = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_range_offsets[i + 1] = m_range_offsets[i] + (ranges[i].end - ranges[i].begin);
+        }
+
+        // chunks of nodes rather than of ranges, the ranges go from single nodes to whole levels
+        JobSystem::parallel_for(m_range_offsets[count], update_grain_size,
+            [&](const size_t begin, const size_t end)
+            {
+                size_t range = std::upper_bound(m_range_offsets.begin(), m_range_offsets.end(), static_cast<uint32_t>(begin)) - m_range_offsets.begin() - 1;
+                size_t position = begin;
+                while (position < end)
+                {
+                    // moved leaves are scattered single node ranges, each missing the cache on every array it reads
+                    if (range + update_prefetch_distance < count)
+                    {
+                        const uint32_t index = ranges[range + update_prefetch_distance].begin;
+                        prefetch(&m_parent_indices[index]);
+                        prefetch(&m_local_positions[index]);
+                        prefetch(&m_local_rotations[index]);
+                        prefetch(&m_local_scales[index]);
+                        prefetch(&m_world_matrices[index]);
+                        prefetch(&m_world_matrices[index][3]);
+                        prefetch(&m_normal_matrices[index]);
+                        prefetch(&m_world_versions[index]);
+                    }
+                    if (range + update_prefetch_distance / 2 < count)
+                    {
+                        const uint32_t parent_index = m_parent_indices[ranges[range + update_prefetch_distance / 2].begin];
+                        if (parent_index != invalid_index)
+                        {
+                            prefetch(&m_world_matrices[parent_index]);
+                            prefetch(&m_world_matrices[parent_index][3]);
+                        }
+                    }
+                    const uint32_t first = ranges[range].begin + static_cast<uint32_t>(position - m_range_offsets[range]);
+                    const uint32_t last = std::min(ranges[range].end, first + static_cast<uint32_t>(end - position));
+                    update_run(first, last);
+                    position += last - first;
+                    ++range;
+                }
+            });
+    }
+
+    void TransformHierarchy::update()
+    {
+        ++m_update_count;
+        m_last_update_stats = UpdateStats();
+        if (m_order_dirty)
+        {
+            rebuild_order();
+            m_last_update_stats.order_rebuilt = true;
+        }
+        m_last_update_stats.nodes_count = m_world_matrices.size();
+        m_last_update_stats.levels_count = m_level_offsets.empty() ? 0 : m_level_offsets.size() - 1;
+
+        if (m_dirty_count == 0)
+        {
+            return;
+        }
+
+        // adds [begin, end) to the next level, merged with the last range when they touch or overlap
+        const auto append_range = [this](const uint32_t begin, const uint32_t end)
+        {
+            if (!m_next_ranges.empty() && begin <= m_next_ranges.back().end)
+            {
+                m_next_ranges.back().end = std::max(m_next_ranges.back().end, end);
+            }
+            else if (begin < end)
+            {
+                m_next_ranges.push_back(IndexRange{ begin, end });
+            }
+        };
+
+        m_current_ranges.clear();
+        for (size_t level = 0; level + 1 < m_level_offsets.size(); ++level)
+        {
+            if (m_current_ranges.empty() && m_dirty_count == 0)
+            {
+                break;
+            }
+
+            // the children of a run of parents are one run, the breadth-first order puts the children of
+            // consecutive parents one after another; ranges before the limit are added first to keep them sorted
+            m_next_ranges.clear();
+            size_t parents_cursor = 0;
+            const auto append_children = [&](const uint32_t limit)
+            {
+                for (; parents_cursor < m_current_ranges.size(); ++parents_cursor)
+                {
+                    const IndexRange& parents = m_current_ranges[parents_cursor];
+                    const uint32_t first_child = m_first_child_indices[parents.begin];
+                    if (first_child > limit)
+                    {
+                        break;
+                    }
+                    append_range(first_child, m_first_child_indices[parents.end - 1] + m_children_counts[parents.end - 1]);
+                }
+            };
+
+            // the dirty nodes of the level, in order; the ones below an updated parent are already covered
+            const uint32_t level_begin = m_level_offsets[level];
+            const uint32_t level_end = m_level_offsets[level + 1];
+            for (uint32_t word_index = level_begin / 64; m_dirty_count > 0 && word_index * 64 < level_end; ++word_index)
+            {
+                const uint32_t word_begin = std::max(level_begin, word_index * 64);
+                const uint32_t word_end = std::min(level_end, word_index * 64 + 64);
+                const uint64_t mask = (word_end - word_begin == 64 ? ~uint64_t(0) : (uint64_t(1) << (word_end - word_begin)) - 1) << (word_begin % 64);
+                uint64_t bits = m_dirty_bits[word_index] & mask;
+                m_dirty_bits[word_index] &= ~mask;
+                while (bits != 0)
+                {
+                    const uint32_t index = word_index * 64 + count_trailing_zeros(bits);
+                    bits &= bits - 1;
+                    --m_dirty_count;
+                    append_children(index);
+                    append_range(index, index + 1);
+                }
+            }
+            append_children(invalid_index);
+
+            update_nodes(m_next_ranges.data(), m_next_ranges.size());
+            m_last_update_stats.updated_nodes_count += m_range_offsets[m_next_ranges.size()];
+            std::swap(m_current_ranges, m_next_ranges);
+        }
+    }
+}
@@ -1,7 +1,12 @@
 #include "SimpleEngineCore/Window.hpp"
+#include "SimpleEngineCore/Event.hpp"
 #include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
 #include "SimpleEngineCore/Modules/UIModule.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/Renderer_OpenGL.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/HeadlessContext.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/Framebuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/GLCapture.hpp"
 
 #include <GLFW/glfw3.h>
 #include <imgui/imgui.h>
@@ -9,10 +14,12 @@
 
 namespace SimpleEngine {
 
-    Window::Window(std::string title, const unsigned int width, const unsigned int height)
+    Window::Window(std::string title, const unsigned int width, const unsigned int height, const bool headless)
         : m_data({ std::move(title), width, height })
+        , m_is_headless(headless)
     {
-        int resultCode = init();
+        int resultCode = m_is_headless ? init_headless() : init();
+        m_is_initialized = resultCode == 0;
     }
 
     Window::~Window()
@@ -59,20 +66,17 @@ namespace SimpleEngine {
                 {
                     case GLFW_PRESS:
                     {
-                        EventKeyPressed event(static_cast<KeyCode>(key), false);
-                        data.eventCallbackFn(event);
+                        data.pEventBus->post(EventKeyPressed(static_cast<KeyCode>(key), false));
                         break;
                     }
                     case GLFW_RELEASE:
                     {
-                        EventKeyReleased event(static_cast<KeyCode>(key));
-                        data.eventCallbackFn(event);
+                        data.pEventBus->post(EventKeyReleased(static_cast<KeyCode>(key)));
                         break;
                     }
                     case GLFW_REPEAT:
                     {
-                        EventKeyPressed event(static_cast<KeyCode>(key), true);
-                        data.eventCallbackFn(event);
+                        data.pEventBus->post(EventKeyPressed(static_cast<KeyCode>(key), true));
                         break;
                     }
                 }
@@ -90,14 +94,12 @@ namespace SimpleEngine {
                 {
                     case GLFW_PRESS:
                     {
-                        EventMouseButtonPressed event(static_cast<MouseButton>(button), x_pos, y_pos);
-                        data.eventCallbackFn(event);
+                        data.pEventBus->post(EventMouseButtonPressed(static_cast<MouseButton>(button), x_pos, y_pos));
                         break;
                     }
                     case GLFW_RELEASE:
                     {
-                        EventMouseButtonReleased event(static_cast<MouseButton>(button), x_pos, y_pos);
-                        data.eventCallbackFn(event);
+                        data.pEventBus->post(EventMouseButtonReleased(static_cast<MouseButton>(button), x_pos, y_pos));
                         break;
                     }
                 }
@@ -110,8 +112,7 @@ namespace SimpleEngine {
                 WindowData& data = *static_cast<WindowData*>(glfwGetWindowUserPointer(pWindow));
                 data.width = width;
                 data.height = height;
-                EventWindowResize event(width, height);
-                data.eventCallbackFn(event);
+                data.pEventBus->post(EventWindowResize(width, height));
             }
         );
 
@@ -119,8 +120,7 @@ namespace SimpleEngine {
             [](GLFWwindow* pWindow, double x, double y)
             {
                 WindowData& data = *static_cast<WindowData*>(glfwGetWindowUserPointer(pWindow));
-                EventMouseMoved event(x, y);
-                data.eventCallbackFn(event);
+                data.pEventBus->post(EventMouseMoved(x, y));
             }
         );
 
@@ -128,8 +128,7 @@ namespace SimpleEngine {
             [](GLFWwindow* pWindow)
             {
                 WindowData& data = *static_cast<WindowData*>(glfwGetWindowUserPointer(pWindow));
-                EventWindowClose event;
-                data.eventCallbackFn(event);
+                data.pEventBus->post(EventWindowClose());
             }
         );
 
@@ -144,8 +143,51 @@ namespace SimpleEngine {
         return 0;
     }
 
+    int Window::init_headless()
+    {
+        LOG_INFO("Creating headless context '{0}' with size {1}x{2}", m_data.title, m_data.width, m_data.height);
+
+        m_pHeadlessContext = std::make_unique<HeadlessContext>();
+        if (!m_pHeadlessContext->create())
+        {
+            LOG_CRITICAL("Can't create headless context {0}", m_data.title);
+            return -1;
+        }
+
+        if (!Renderer_OpenGL::init(&HeadlessContext::get_proc_address))
+        {
+            LOG_CRITICAL("Failed to initialize OpenGL renderer");
+            return -3;
+        }
+
+        // stands in for the window's framebuffer, the depth format matches what GLFW gives by default
+        m_pOffscreenFramebuffer = std::make_unique<Framebuffer>(m_data.width, m_data.height,
+            std::initializer_list<Framebuffer::EFormat>{ Framebuffer::EFormat::RGBA8 },
+            Framebuffer::EFormat::Depth24Stencil8);
+        if (!m_pOffscreenFramebuffer->is_complete())
+        {
+            return -4;
+        }
+        m_pOffscreenFramebuffer->set_as_default();
+        Renderer_OpenGL::set_viewport(m_data.width, m_data.height);
+
+        UIModule::on_headless_window_create(m_data.width, m_data.height);
+
+        return 0;
+    }
+
     void Window::shutdown()
     {
+        if (m_is_headless)
+        {
+            if (m_is_initialized)
+            {
+                UIModule::on_window_close();
+            }
+            m_pOffscreenFramebuffer = nullptr;
+            m_pHeadlessContext = nullptr;
+            return;
+        }
         UIModule::on_window_close();
         glfwDestroyWindow(m_pWindow);
         glfwTerminate();
@@ -153,15 +195,15 @@ namespace SimpleEngine {
 
     void Window::on_update()
     {
+        PROFILE_SCOPE("Window::on_update");
+        GLCapture::on_frame_end();
+        if (m_is_headless)
+        {
+            // nothing to present, wait for the frame so CPU timings include the GPU work like a vsynced swap
+            Renderer_OpenGL::finish();
+            return;
+        }
         glfwSwapBuffers(m_pWindow);
         glfwPollEvents();
     }
-
-    glm::vec2 Window::get_current_cursor_position() const
-    {
-        double x_pos;
-        double y_pos;
-        glfwGetCursorPos(m_pWindow, &x_pos, &y_pos);
-        return {x_pos, y_pos};
-    }
 }
\ No newline at end of file
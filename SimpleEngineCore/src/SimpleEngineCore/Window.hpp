@@ -1,21 +1,21 @@
 #pragma once
 
-#include "SimpleEngineCore/Event.hpp"
-
 #include <string>
-#include <functional>
-#include <glm/ext/vector_float2.hpp>
+#include <memory>
 
 struct GLFWwindow;
 
 namespace SimpleEngine {
 
+    class EventBus;
+    class Framebuffer;
+    class HeadlessContext;
+
     class Window
     {
     public:
-        using EventCallbackFn = std::function<void(BaseEvent&)>;
-
-        Window(std::string title, const unsigned int width, const unsigned int height);
+        // headless: no OS window, everything is rendered into an offscreen framebuffer of the given size
+        Window(std::string title, const unsigned int width, const unsigned int height, const bool headless = false);
         ~Window();
 
         Window(const Window&) = delete;
@@ -24,13 +24,15 @@ namespace SimpleEngine {
         Window& operator=(Window&&) = delete;
 
         void on_update();
+        bool is_initialized() const { return m_is_initialized; }
+        bool is_headless() const { return m_is_headless; }
         unsigned int get_width() const { return m_data.width; }
         unsigned int get_height() const { return m_data.height; }
-        glm::vec2 get_current_cursor_position() const;
 
-        void set_event_callback(const EventCallbackFn& callback)
+        // the GLFW callbacks post their events to the bus, they are delivered by its dispatch_queued()
+        void set_event_bus(EventBus* pEventBus)
         {
-            m_data.eventCallbackFn = callback;
+            m_data.pEventBus = pEventBus;
         }
 
     private:
@@ -39,14 +41,19 @@ namespace SimpleEngine {
             std::string title;
             unsigned int width;
             unsigned int height;
-            EventCallbackFn eventCallbackFn;
+            EventBus* pEventBus = nullptr;
         };
 
         int init();
+        int init_headless();
         void shutdown();
 
         GLFWwindow* m_pWindow = nullptr;
+        std::unique_ptr<HeadlessContext> m_pHeadlessContext;
+        std::unique_ptr<Framebuffer> m_pOffscreenFramebuffer;
         WindowData m_data;
+        bool m_is_headless = false;
+        bool m_is_initialized = false;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,489 @@
+#include "SimpleEngineCore/WorldPartition.hpp"
+
+#include "SimpleEngineCore/IO/VirtualFileSystem.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+    using Cube = WorldPartition::Cube;
+    using NodeId = TransformHierarchy::NodeId;
+    using RequestId = VirtualFileSystem::RequestId;
+
+    static constexpr char s_cell_magic[4] = { 'S', 'E', 'W', 'C' };
+    static constexpr uint32_t s_cell_version = 1;
+    // objects created between two looks at the clock
+    constexpr size_t activation_chunk_size = 64;
+    // smoothing of the camera's velocity, in seconds
+    constexpr float velocity_smoothing_time = 0.25f;
+
+    struct CellHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t cubes_count;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(CellHeader) == 16, "CellHeader is read straight from the file");
+    static_assert(sizeof(Cube) == 40, "cubes are read straight from the file");
+
+    enum class ECellState : uint8_t
+    {
+        Loading,
+        // read, its nodes are being created
+        Pending,
+        Active,
+        Empty,
+        Failed
+    };
+
+    struct Cell
+    {
+        ECellState state = ECellState::Loading;
+        RequestId read = VirtualFileSystem::invalid_request;
+        // released once the cell is active
+        std::vector<Cube> cubes;
+        std::vector<NodeId> nodes;
+    };
+
+    struct CompletedRead
+    {
+        RequestId id = VirtualFileSystem::invalid_request;
+        VirtualFileSystem::EReadStatus status = VirtualFileSystem::EReadStatus::Failed;
+        bool corrupt = false;
+        std::vector<Cube> cubes;
+    };
+
+    struct WorldPartitionState
+    {
+        WorldPartition::Settings settings;
+        TransformHierarchy* pTransforms = nullptr;
+        WorldPartition::NodesCallback on_nodes_added = nullptr;
+        WorldPartition::NodesCallback on_nodes_removed = nullptr;
+        void* pContext = nullptr;
+        bool initialized = false;
+
+        std::unordered_map<uint64_t, Cell> cells;
+        std::unordered_map<RequestId, uint64_t> reads;
+
+        // filled on the JobSystem workers
+        std::mutex completed_mutex;
+        std::vector<CompletedRead> completed;
+        std::vector<CompletedRead> received;
+
+        bool camera_known = false;
+        glm::vec3 camera_position{ 0.f };
+        double time = 0.0;
+        WorldPartition::Stats stats;
+
+        std::vector<std::pair<float, uint64_t>> candidates;
+        std::vector<NodeId> nodes;
+    };
+
+    static WorldPartitionState s_state;
+
+    static uint64_t get_key(const glm::ivec2& cell)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cell.x)) << 32) | static_cast<uint32_t>(cell.y);
+    }
+
+    static glm::ivec2 get_cell(const uint64_t key)
+    {
+        return glm::ivec2(static_cast<int32_t>(static_cast<uint32_t>(key >> 32)), static_cast<int32_t>(static_cast<uint32_t>(key)));
+    }
+
+    // in the XY plane, 0 inside the cell
+    static float get_distance(const glm::vec2& point, const glm::ivec2& cell, const float cell_size)
+    {
+        const glm::vec2 cell_min = glm::vec2(cell) * cell_size;
+        return glm::length(point - glm::clamp(point, cell_min, cell_min + cell_size));
+    }
+
+    // from the point of the segment nearest to the cell's center, slightly more than the exact distance near the corners
+    static float get_distance(const glm::vec2& begin, const glm::vec2& end, const glm::ivec2& cell, const float cell_size)
+    {
+        const glm::vec2 center = (glm::vec2(cell) + 0.5f) * cell_size;
+        const glm::vec2 direction = end - begin;
+        const float length_squared = glm::dot(direction, direction);
+        const float t = length_squared > 0.f ? glm::clamp(glm::dot(center - begin, direction) / length_squared, 0.f, 1.f) : 0.f;
+        return get_distance(begin + direction * t, cell, cell_size);
+    }
+
+    static void on_read(void*, const VirtualFileSystem::ReadResult& result)
+    {
+        CompletedRead read;
+        read.id = result.id;
+        read.status = result.status;
+        if (result.status == VirtualFileSystem::EReadStatus::Completed)
+        {
+            // the cubes are copied out here, the main thread only creates their nodes
+            CellHeader header;
+            if (result.size < sizeof(CellHeader))
+            {
+                read.corrupt = true;
+            }
+            else
+            {
+                std::memcpy(&header, result.data, sizeof(CellHeader));
+                read.corrupt = std::memcmp(header.magic, s_cell_magic, sizeof(s_cell_magic)) != 0 || header.version != s_cell_version
+                    || result.size != sizeof(CellHeader) + static_cast<uint64_t>(header.cubes_count) * sizeof(Cube);
+            }
+            if (!read.corrupt)
+            {
+                read.cubes.resize(header.cubes_count);
+                std::memcpy(read.cubes.data(), result.data + sizeof(CellHeader), read.cubes.size() * sizeof(Cube));
+            }
+        }
+        std::lock_guard<std::mutex> lock(s_state.completed_mutex);
+        s_state.completed.push_back(std::move(read));
+    }
+
+    static void update_velocity(const glm::vec3& camera_position, const double time)
+    {
+        if (s_state.camera_known && time > s_state.time)
+        {
+            const float delta_time = static_cast<float>(time - s_state.time);
+            const glm::vec3 motion = camera_position - s_state.camera_position;
+            if (glm::length(motion) > s_state.settings.load_radius)
+            {
+                // a jump rather than a motion, there is nothing to extrapolate
+                s_state.stats.camera_velocity = glm::vec3(0.f);
+            }
+            else
+            {
+                const float blend = 1.f - std::exp(-delta_time / velocity_smoothing_time);
+                s_state.stats.camera_velocity = glm::mix(s_state.stats.camera_velocity, motion / delta_time, blend);
+            }
+        }
+        s_state.camera_known = true;
+        s_state.camera_position = camera_position;
+        s_state.time = time;
+    }
+
+    static void receive_reads()
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_state.completed_mutex);
+            std::swap(s_state.completed, s_state.received);
+        }
+        for (CompletedRead& read : s_state.received)
+        {
+            const auto read_it = s_state.reads.find(read.id);
+            // cancelled when its cell was unloaded
+            if (read_it == s_state.reads.end())
+            {
+                continue;
+            }
+            const glm::ivec2 cell_coordinates = get_cell(read_it->second);
+            Cell& cell = s_state.cells.at(read_it->second);
+            s_state.reads.erase(read_it);
+            cell.read = VirtualFileSystem::invalid_request;
+
+            if (read.status == VirtualFileSystem::EReadStatus::NotFound)
+            {
+                cell.state = ECellState::Empty;
+            }
+            else if (read.status != VirtualFileSystem::EReadStatus::Completed || read.corrupt)
+            {
+                LOG_ERROR("WorldPartition: reading cell {0} failed: {1}", WorldPartition::get_cell_path(s_state.settings.directory, cell_coordinates),
+                          read.corrupt ? "corrupt" : get_read_status_name(read.status));
+                cell.state = ECellState::Failed;
+            }
+            else
+            {
+                cell.state = read.cubes.empty() ? ECellState::Empty : ECellState::Pending;
+                cell.cubes = std::move(read.cubes);
+                ++s_state.stats.loaded_cells_count;
+            }
+        }
+        s_state.received.clear();
+    }
+
+    static void unload_distant_cells(const glm::vec2& position, const glm::vec2& predicted_position)
+    {
+        const WorldPartition::Settings& settings = s_state.settings;
+        const float unload_distance = settings.load_radius + settings.unload_margin;
+        s_state.nodes.clear();
+        for (auto cell_it = s_state.cells.begin(); cell_it != s_state.cells.end();)
+        {
+            if (get_distance(position, predicted_position, get_cell(cell_it->first), settings.cell_size) <= unload_distance)
+            {
+                ++cell_it;
+                continue;
+            }
+            Cell& cell = cell_it->second;
+            if (cell.read != VirtualFileSystem::invalid_request)
+            {
+                VirtualFileSystem::cancel(cell.read);
+                s_state.reads.erase(cell.read);
+                ++s_state.stats.cancelled_reads_count;
+            }
+            if (cell.state == ECellState::Pending || cell.state == ECellState::Active)
+            {
+                ++s_state.stats.unloaded_cells_count;
+            }
+            s_state.nodes.insert(s_state.nodes.end(), cell.nodes.begin(), cell.nodes.end());
+            cell_it = s_state.cells.erase(cell_it);
+        }
+        if (s_state.nodes.empty())
+        {
+            return;
+        }
+        s_state.on_nodes_removed(s_state.pContext, s_state.nodes.data(), s_state.nodes.size());
+        for (const NodeId node : s_state.nodes)
+        {
+            s_state.pTransforms->destroy_node(node);
+        }
+    }
+
+    static void start_reads(const glm::vec2& position, const glm::vec2& predicted_position)
+    {
+        const WorldPartition::Settings& settings = s_state.settings;
+        if (s_state.reads.size() >= settings.max_reads_in_flight)
+        {
+            return;
+        }
+        const glm::ivec2 first_cell(glm::floor((glm::min(position, predicted_position) - settings.load_radius) / settings.cell_size));
+        const glm::ivec2 last_cell(glm::floor((glm::max(position, predicted_position) + settings.load_radius) / settings.cell_size));
+        s_state.candidates.clear();
+        for (int y = first_cell.y; y <= last_cell.y; ++y)
+        {
+            for (int x = first_cell.x; x <= last_cell.x; ++x)
+            {
+                const glm::ivec2 cell(x, y);
+                if (get_distance(position, predicted_position, cell, settings.cell_size) <= settings.load_radius && s_state.cells.count(get_key(cell)) == 0)
+                {
+                    s_state.candidates.emplace_back(get_distance(position, cell, settings.cell_size), get_key(cell));
+                }
+            }
+        }
+        // the cells around the camera first, then the ones it is heading for
+        const size_t reads_count = std::min(s_state.candidates.size(), settings.max_reads_in_flight - s_state.reads.size());
+        std::partial_sort(s_state.candidates.begin(), s_state.candidates.begin() + reads_count, s_state.candidates.end());
+        for (size_t i = 0; i < reads_count; ++i)
+        {
+            const std::string path = WorldPartition::get_cell_path(settings.directory, get_cell(s_state.candidates[i].second));
+            VirtualFileSystem::ReadRequest request;
+            request.path = path;
+            request.callback = on_read;
+            request.priority = s_state.candidates[i].first <= settings.load_radius ? VirtualFileSystem::EPriority::Normal : VirtualFileSystem::EPriority::Low;
+            Cell& cell = s_state.cells[s_state.candidates[i].second];
+            cell.read = VirtualFileSystem::read_async(request);
+            if (cell.read == VirtualFileSystem::invalid_request)
+            {
+                cell.state = ECellState::Failed;
+                continue;
+            }
+            s_state.reads.emplace(cell.read, s_state.candidates[i].second);
+        }
+    }
+
+    static void activate_cells(const glm::vec2& position, const std::chrono::steady_clock::time_point start_time)
+    {
+        const WorldPartition::Settings& settings = s_state.settings;
+        s_state.candidates.clear();
+        for (const auto& [key, cell] : s_state.cells)
+        {
+            if (cell.state == ECellState::Pending)
+            {
+                s_state.candidates.emplace_back(get_distance(position, get_cell(key), settings.cell_size), key);
+            }
+        }
+        std::sort(s_state.candidates.begin(), s_state.candidates.end());
+
+        // at least one chunk per update, however small the budget
+        s_state.nodes.clear();
+        bool over_budget = false;
+        for (size_t i = 0; i < s_state.candidates.size() && !over_budget; ++i)
+        {
+            Cell& cell = s_state.cells.at(s_state.candidates[i].second);
+            while (cell.nodes.size() < cell.cubes.size())
+            {
+                const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_time;
+                if (!s_state.nodes.empty() && elapsed.count() >= settings.activation_budget_ms)
+                {
+                    over_budget = true;
+                    break;
+                }
+                const size_t end = std::min(cell.nodes.size() + activation_chunk_size, cell.cubes.size());
+                for (size_t j = cell.nodes.size(); j < end; ++j)
+                {
+                    const Cube& cube = cell.cubes[j];
+                    const NodeId node = s_state.pTransforms->create_node(TransformHierarchy::invalid_node, cube.position, cube.rotation, cube.scale);
+                    cell.nodes.push_back(node);
+                    s_state.nodes.push_back(node);
+                }
+            }
+            if (cell.nodes.size() == cell.cubes.size())
+            {
+                cell.state = ECellState::Active;
+                std::vector<Cube>().swap(cell.cubes);
+            }
+        }
+        if (!s_state.nodes.empty())
+        {
+            s_state.on_nodes_added(s_state.pContext, s_state.nodes.data(), s_state.nodes.size());
+        }
+    }
+
+    void WorldPartition::init(const Settings& settings, TransformHierarchy& transforms, const NodesCallback on_nodes_added,
+                              const NodesCallback on_nodes_removed, void* pContext)
+    {
+        shutdown();
+        s_state.settings = settings;
+        s_state.settings.cell_size = std::max(settings.cell_size, 1.f);
+        s_state.settings.load_radius = std::max(settings.load_radius, 0.f);
+        s_state.settings.unload_margin = std::max(settings.unload_margin, 0.f);
+        s_state.settings.max_reads_in_flight = std::max(settings.max_reads_in_flight, 1u);
+        s_state.pTransforms = &transforms;
+        s_state.on_nodes_added = on_nodes_added;
+        s_state.on_nodes_removed = on_nodes_removed;
+        s_state.pContext = pContext;
+        {
+            // completions of reads cancelled by the last shutdown
+            std::lock_guard<std::mutex> lock(s_state.completed_mutex);
+            s_state.completed.clear();
+        }
+        s_state.camera_known = false;
+        s_state.stats = Stats();
+        s_state.initialized = true;
+    }
+
+    void WorldPartition::shutdown()
+    {
+        if (!s_state.initialized)
+        {
+            return;
+        }
+        s_state.nodes.clear();
+        for (auto& [key, cell] : s_state.cells)
+        {
+            if (cell.read != VirtualFileSystem::invalid_request)
+            {
+                VirtualFileSystem::cancel(cell.read);
+            }
+            s_state.nodes.insert(s_state.nodes.end(), cell.nodes.begin(), cell.nodes.end());
+        }
+        if (!s_state.nodes.empty())
+        {
+            s_state.on_nodes_removed(s_state.pContext, s_state.nodes.data(), s_state.nodes.size());
+            for (const NodeId node : s_state.nodes)
+            {
+                s_state.pTransforms->destroy_node(node);
+            }
+        }
+        s_state.cells.clear();
+        s_state.reads.clear();
+        s_state.nodes.clear();
+        s_state.pTransforms = nullptr;
+        s_state.initialized = false;
+    }
+
+    bool WorldPartition::is_initialized()
+    {
+        return s_state.initialized;
+    }
+
+    void WorldPartition::update(const glm::vec3& camera_position, const double time)
+    {
+        if (!s_state.initialized || !VirtualFileSystem::is_initialized())
+        {
+            return;
+        }
+        PROFILE_SCOPE("WorldPartition::update");
+        const auto start_time = std::chrono::steady_clock::now();
+        update_velocity(camera_position, time);
+
+        // the loaded area stretches from the camera to where it will be in prefetch_seconds
+        const Settings& settings = s_state.settings;
+        const glm::vec2 position(camera_position);
+        glm::vec2 prefetch_offset = glm::vec2(s_state.stats.camera_velocity) * settings.prefetch_seconds;
+        const float prefetch_distance = glm::length(prefetch_offset);
+        if (prefetch_distance > settings.load_radius)
+        {
+            prefetch_offset *= settings.load_radius / prefetch_distance;
+        }
+        const glm::vec2 predicted_position = position + prefetch_offset;
+
+        receive_reads();
+        unload_distant_cells(position, predicted_position);
+        start_reads(position, predicted_position);
+        activate_cells(position, start_time);
+        s_state.stats.update_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    }
+
+    glm::ivec2 WorldPartition::get_cell(const glm::vec3& position, const float cell_size)
+    {
+        return glm::ivec2(glm::floor(glm::vec2(position) / cell_size));
+    }
+
+    std::string WorldPartition::get_cell_path(const std::string& directory, const glm::ivec2& cell)
+    {
+        const std::string name = std::to_string(cell.x) + "_" + std::to_string(cell.y) + ".cell";
+        return directory.empty() ? name : directory + "/" + name;
+    }
+
+    bool WorldPartition::save_cell(const std::string& path, const Cube* cubes, const size_t count)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        CellHeader header;
+        std::memcpy(header.magic, s_cell_magic, sizeof(s_cell_magic));
+        header.version = s_cell_version;
+        header.cubes_count = static_cast<uint32_t>(count);
+        header.reserved = 0;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(cubes), count * sizeof(Cube));
+        return static_cast<bool>(file);
+    }
+
+    WorldPartition::Stats WorldPartition::get_stats()
+    {
+        Stats stats = s_state.stats;
+        for (const auto& [key, cell] : s_state.cells)
+        {
+            switch (cell.state)
+            {
+                case ECellState::Loading:
+                    ++stats.loading_cells_count;
+                    break;
+                case ECellState::Pending:
+                    ++stats.pending_cells_count;
+                    break;
+                case ECellState::Active:
+                    ++stats.active_cells_count;
+                    break;
+                case ECellState::Empty:
+                    ++stats.empty_cells_count;
+                    break;
+                case ECellState::Failed:
+                    ++stats.failed_cells_count;
+                    break;
+            }
+            stats.active_cubes_count += cell.nodes.size();
+        }
+        return stats;
+    }
+
+    const WorldPartition::Settings& WorldPartition::get_settings()
+    {
+        return s_state.settings;
+    }
+
+}
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <memory>
+#include <cstring>
+#include <string>
 #include <imgui/imgui.h>
 
 #include <SimpleEngineCore/Input.hpp>
@@ -8,14 +10,14 @@
 
 class SimpleEngineEditor : public SimpleEngine::Application
 {
-    double m_initial_mouse_pos_x = 0.0;
-    double m_initial_mouse_pos_y = 0.0;
     float camera_position[3] = { 0.f, 0.f, 1.f };
     float camera_rotation[3] = { 0.f, 0.f, 0.f };
     float camera_fov = 60.f;
     float camera_near_plane = 0.1f;
     float camera_far_plane = 100.f;
     bool perspective_camera = true;
+    char scene_path[256] = "scene.sescene";
+    bool scene_as_text = false;
 
     virtual void on_update() override
     {
@@ -73,19 +75,17 @@ class SimpleEngineEditor : public SimpleEngine::Application
         
         if (SimpleEngine::Input::IsMouseButtonPressed(SimpleEngine::MouseButton::MOUSE_BUTTON_RIGHT))
         {
-            glm::vec2 current_cursor_position = get_current_cursor_position();
+            const glm::vec2 mouse_delta = SimpleEngine::Input::GetMouseDelta();
             if (SimpleEngine::Input::IsMouseButtonPressed(SimpleEngine::MouseButton::MOUSE_BUTTON_LEFT))
             {
-                camera.move_right(static_cast<float>(current_cursor_position.x - m_initial_mouse_pos_x) / 100.f);
-                camera.move_up(static_cast<float>(m_initial_mouse_pos_y - current_cursor_position.y) / 100.f);
+                camera.move_right(mouse_delta.x / 100.f);
+                camera.move_up(-mouse_delta.y / 100.f);
             }
             else
             {
-                rotation_delta.z += static_cast<float>(m_initial_mouse_pos_x - current_cursor_position.x) / 5.f;
-                rotation_delta.y -= static_cast<float>(m_initial_mouse_pos_y - current_cursor_position.y) / 5.f;
+                rotation_delta.z -= mouse_delta.x / 5.f;
+                rotation_delta.y += mouse_delta.y / 5.f;
             }
-            m_initial_mouse_pos_x = current_cursor_position.x;
-            m_initial_mouse_pos_y = current_cursor_position.y;
         }
 
         camera.add_movement_and_rotation(movement_delta, rotation_delta);
@@ -113,21 +113,23 @@ class SimpleEngineEditor : public SimpleEngine::Application
         ImGuiID dockspace_id = ImGui::GetID("MyDockSpace");
         ImGui::DockSpace(dockspace_id, ImVec2(0.0f, 0.0f), dockspace_flags);
 
+        bool open_scene_popup = false;
+        bool save_scene_popup = false;
         if (ImGui::BeginMenuBar())
         {
             if (ImGui::BeginMenu("File"))
             {
                 if (ImGui::MenuItem("New Scene...", NULL))
                 {
-
+                    new_scene();
                 }
                 if (ImGui::MenuItem("Open Scene...", NULL))
                 {
-
+                    open_scene_popup = true;
                 }
-                if (ImGui::MenuItem("Save Scene...", NULL))
+                if (ImGui::MenuItem("Save Scene...", NULL, false, !is_saving_scene()))
                 {
-
+                    save_scene_popup = true;
                 }
                 ImGui::Separator();
                 if (ImGui::MenuItem("Exit", NULL))
@@ -138,17 +140,48 @@ class SimpleEngineEditor : public SimpleEngine::Application
             }
             ImGui::EndMenuBar();
         }
-        ImGui::End();
-    }
-
 
-    virtual void on_mouse_button_event(const SimpleEngine::MouseButton button_code,
-                                       const double x_pos,
-                                       const double y_pos,
-                                       const bool pressed) override
-    {
-        m_initial_mouse_pos_x = x_pos;
-        m_initial_mouse_pos_y = y_pos;
+        // opened outside of the menu, whose ID stack is gone once it closes
+        if (open_scene_popup)
+        {
+            ImGui::OpenPopup("Open Scene");
+        }
+        if (save_scene_popup)
+        {
+            ImGui::OpenPopup("Save Scene");
+        }
+        if (ImGui::BeginPopupModal("Open Scene", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+        {
+            ImGui::InputText("Path", scene_path, sizeof(scene_path));
+            if (ImGui::Button("Open"))
+            {
+                load_scene(scene_path);
+                ImGui::CloseCurrentPopup();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel"))
+            {
+                ImGui::CloseCurrentPopup();
+            }
+            ImGui::EndPopup();
+        }
+        if (ImGui::BeginPopupModal("Save Scene", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+        {
+            ImGui::InputText("Path", scene_path, sizeof(scene_path));
+            ImGui::Checkbox("Text, for diffing", &scene_as_text);
+            if (ImGui::Button("Save"))
+            {
+                save_scene(scene_path, scene_as_text ? ESceneFormat::Text : ESceneFormat::Binary);
+                ImGui::CloseCurrentPopup();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel"))
+            {
+                ImGui::CloseCurrentPopup();
+            }
+            ImGui::EndPopup();
+        }
+        ImGui::End();
     }
 
     virtual void on_ui_draw() override
@@ -200,6 +233,137 @@ class SimpleEngineEditor : public SimpleEngine::Application
         {
             camera.set_projection_mode(perspective_camera ? SimpleEngine::Camera::ProjectionMode::Perspective : SimpleEngine::Camera::ProjectionMode::Orthographic);
         }
+
+        ImGui::Separator();
+        // play back with SimpleEngineReplay frames.glcap
+        if (ImGui::Button("Capture 60 GL frames"))
+        {
+            capture_gl_frames("frames.glcap", 60);
+        }
+        if (is_capturing_gl_frames())
+        {
+            ImGui::SameLine();
+            ImGui::Text("capturing...");
+        }
+        if (ImGui::Button("Screenshot"))
+        {
+            save_screenshot("screenshot.png");
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Record 120 frames"))
+        {
+            record_frames("frames", 120);
+        }
+        if (is_recording_frames())
+        {
+            ImGui::SameLine();
+            ImGui::Text("recording...");
+        }
+        ImGui::Text("Readback: %.3f ms", get_readback_time_ms());
+        // replay with --frame-time-harness --input=input.seinput
+        if (!SimpleEngine::Input::IsRecording())
+        {
+            if (ImGui::Button("Record input"))
+            {
+                SimpleEngine::Input::StartRecording();
+            }
+        }
+        else if (ImGui::Button("Stop and save input"))
+        {
+            SimpleEngine::Input::StopRecording().save("input.seinput");
+        }
+
+        ImGui::Separator();
+        if (ImGui::Button("Stream generated world"))
+        {
+            // small cells for the editor camera's pace
+            SimpleEngine::WorldPartition::Settings world_settings;
+            world_settings.cell_size = 16.f;
+            world_settings.load_radius = 48.f;
+            world_settings.unload_margin = 8.f;
+            if (save_stress_world(world_settings, 32, 4))
+            {
+                load_world(world_settings);
+            }
+        }
+        if (SimpleEngine::WorldPartition::is_initialized())
+        {
+            ImGui::SameLine();
+            if (ImGui::Button("Unload world"))
+            {
+                unload_world();
+            }
+            const SimpleEngine::WorldPartition::Stats world_stats = SimpleEngine::WorldPartition::get_stats();
+            ImGui::Text("Cells: %zu active, %zu pending, %zu loading, %zu empty", world_stats.active_cells_count, world_stats.pending_cells_count,
+                        world_stats.loading_cells_count, world_stats.empty_cells_count);
+            ImGui::Text("Cubes: %zu, update %.3f ms", world_stats.active_cubes_count, world_stats.update_time_ms);
+            ImGui::Text("Loaded %llu, unloaded %llu, cancelled %llu", static_cast<unsigned long long>(world_stats.loaded_cells_count),
+                        static_cast<unsigned long long>(world_stats.unloaded_cells_count), static_cast<unsigned long long>(world_stats.cancelled_reads_count));
+        }
+        ImGui::End();
+
+        ImGui::Begin("Lighting");
+        ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+        if (ImGui::Button("Load lights benchmark (4096 lights)"))
+        {
+            load_lights_benchmark_scene(4096);
+            animate_point_lights = true;
+        }
+        ImGui::Checkbox("Animate point lights", &animate_point_lights);
+        const SimpleEngine::LightClusters::Stats& light_clusters_stats = get_light_clusters_stats();
+        ImGui::Text("Point lights: %zu (%zu in view)", light_clusters_stats.lights_count, light_clusters_stats.visible_lights_count);
+        ImGui::Text("Light indices: %zu, max per cluster: %u", light_clusters_stats.light_indices_count, light_clusters_stats.max_lights_per_cluster);
+        ImGui::Text("Cluster build: %.3f ms", light_clusters_stats.build_time_ms);
+
+        ImGui::Separator();
+        if (ImGui::RadioButton("Forward", render_path == ERenderPath::Forward))
+        {
+            render_path = ERenderPath::Forward;
+        }
+        ImGui::SameLine();
+        if (ImGui::RadioButton("Deferred", render_path == ERenderPath::Deferred))
+        {
+            render_path = ERenderPath::Deferred;
+        }
+        ImGui::Checkbox("Compare render paths", &compare_render_paths);
+        ImGui::Checkbox("Profiler", &show_profiler);
+        ImGui::SameLine();
+        ImGui::Checkbox("Memory", &show_memory);
+        ImGui::SameLine();
+        ImGui::Checkbox("GPU memory", &show_gpu_memory);
+        ImGui::Text("Forward:  %.3f ms GPU", get_render_path_time_ms(ERenderPath::Forward));
+        ImGui::Text("Deferred: %.3f ms GPU", get_render_path_time_ms(ERenderPath::Deferred));
+
+        ImGui::Separator();
+        ImGui::Checkbox("Directional light shadows", &directional_light.cast_shadows);
+        ImGui::Checkbox("Animate dynamic casters", &animate_dynamic_casters);
+        int shadow_budget_mb = static_cast<int>(get_shadow_memory_budget() >> 20);
+        if (ImGui::SliderInt("Shadow budget (MB)", &shadow_budget_mb, 2, 256))
+        {
+            set_shadow_memory_budget(static_cast<size_t>(shadow_budget_mb) << 20);
+        }
+        const SimpleEngine::ShadowMaps::Stats& shadow_stats = get_shadow_stats();
+        ImGui::Text("Shadows: %zu (%zu downgraded, %zu dropped)", shadow_stats.shadows_count, shadow_stats.downgraded_shadows_count, shadow_stats.dropped_shadows_count);
+        ImGui::Text("Cache hits: %zu, misses: %zu", shadow_stats.cache_hits, shadow_stats.cache_misses);
+        ImGui::Text("Casters drawn: %zu static, %zu dynamic", shadow_stats.static_casters_drawn, shadow_stats.dynamic_casters_drawn);
+        ImGui::Text("Atlas: %.1f of %.1f MB used", shadow_stats.used_bytes / 1048576.0, shadow_stats.atlas_bytes / 1048576.0);
+        ImGui::Text("Shadow pass: %.3f ms CPU, %.3f ms GPU", shadow_stats.cpu_time_ms, shadow_stats.gpu_time_ms);
+
+        ImGui::Separator();
+        if (ImGui::Button("Bake lightmaps"))
+        {
+            bake_lightmaps();
+        }
+        const SimpleEngine::LightmapBaker::Stats& lightmap_stats = get_lightmap_stats();
+        ImGui::Text("Lightmap: %zu instances, %zu texels (%.2f per unit)", lightmap_stats.instances_count, lightmap_stats.covered_texels_count, lightmap_stats.texels_per_unit);
+        ImGui::Text("Bake: %.1f ms, %.2f Mrays/s", lightmap_stats.bake_time_ms, lightmap_stats.rays_per_second / 1e6);
+
+        ImGui::Separator();
+        ImGui::Checkbox("Irradiance probes", &irradiance_probes_enabled);
+        ImGui::SliderFloat("Probe budget (ms)", &irradiance_probes_budget_ms, 0.5f, 16.f);
+        const SimpleEngine::IrradianceProbes::Stats& probes_stats = get_irradiance_probes_stats();
+        ImGui::Text("Probes: %zu, %zu stale", probes_stats.probes_count, probes_stats.stale_probes_count);
+        ImGui::Text("Last update: %zu probes in %.3f ms", probes_stats.probes_baked_last_update, probes_stats.update_time_ms);
         ImGui::End();
     }
 
@@ -207,10 +371,55 @@ class SimpleEngineEditor : public SimpleEngine::Application
 };
 
 
-int main()
+int main(int argc, char** argv)
 {
     auto pSimpleEngineEditor = std::make_unique<SimpleEngineEditor>();
 
+    // --frame-time-harness [--frames=N] [--output=path] [--baseline=path] [--threshold=0.1] [--input=path] [--assert-no-allocations]:
+    // headless stress scene run, exits with 1 when frame times regressed against the baseline
+    // or, with --assert-no-allocations, when a frame after the warm-up allocated from the heap
+    if (argc > 1 && std::strcmp(argv[1], "--frame-time-harness") == 0)
+    {
+        SimpleEngine::FrameTimeHarness::Settings settings;
+        for (int i = 2; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            const size_t separator = argument.find('=');
+            const std::string name = argument.substr(0, separator);
+            const std::string value = separator == std::string::npos ? std::string() : argument.substr(separator + 1);
+            if (name == "--frames")
+            {
+                settings.frames_count = static_cast<uint32_t>(std::stoul(value));
+            }
+            else if (name == "--output")
+            {
+                settings.output_path = value;
+            }
+            else if (name == "--baseline")
+            {
+                settings.baseline_path = value;
+            }
+            else if (name == "--threshold")
+            {
+                settings.regression_threshold = std::stod(value);
+            }
+            else if (name == "--input")
+            {
+                settings.input_recording_path = value;
+            }
+            else if (name == "--assert-no-allocations")
+            {
+                settings.assert_no_heap_allocations = true;
+            }
+            else
+            {
+                std::cerr << "Unknown argument " << argument << std::endl;
+                return -1;
+            }
+        }
+        return pSimpleEngineEditor->run_frame_time_harness(settings);
+    }
+
     int returnCode = pSimpleEngineEditor->start(1024, 1024, "SimpleEngine Editor");
 
     //std::cin.get();
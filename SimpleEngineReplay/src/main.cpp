@@ -0,0 +1,68 @@
+#include "SimpleEngineCore/Rendering/OpenGL/GLReplayer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/HeadlessContext.hpp"
+
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <string>
+
+static void print_distribution(const char* name, const SimpleEngine::FrameTimeHarness::Distribution& distribution)
+{
+    std::printf("%-8s p50 %8.3f ms  p95 %8.3f ms  p99 %8.3f ms  max %8.3f ms  mean %8.3f ms\n",
+                name, distribution.p50_ms, distribution.p95_ms, distribution.p99_ms, distribution.max_ms, distribution.mean_ms);
+}
+
+// SimpleEngineReplay capture.glcap [--paced] [--loops=N]
+// Plays back a GL capture on a headless context, as fast as possible unless --paced is given.
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s capture.glcap [--paced] [--loops=N]\n", argv[0]);
+        return -1;
+    }
+
+    SimpleEngine::GLReplayer::Settings settings;
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--paced")
+        {
+            settings.paced = true;
+        }
+        else if (argument.rfind("--loops=", 0) == 0)
+        {
+            settings.loops = static_cast<uint32_t>(std::stoul(argument.substr(8)));
+        }
+        else
+        {
+            std::fprintf(stderr, "Unknown argument %s\n", argument.c_str());
+            return -1;
+        }
+    }
+
+    SimpleEngine::HeadlessContext context;
+    // glad is loaded directly: no capture hooks and no debug output callback in the way of the timings
+    if (!context.create() || !gladLoadGLLoader(&SimpleEngine::HeadlessContext::get_proc_address))
+    {
+        std::fprintf(stderr, "Can't create a headless OpenGL context\n");
+        return -1;
+    }
+
+    SimpleEngine::GLReplayer::Stats stats;
+    {
+        SimpleEngine::GLReplayer replayer;
+        if (!replayer.load(argv[1]) || !replayer.replay(settings, stats))
+        {
+            return -1;
+        }
+        std::printf("%s: %u frames at %ux%u, replayed %u frames%s\n", argv[1], replayer.get_frames_count(),
+                    replayer.get_width(), replayer.get_height(), stats.frames_count, settings.paced ? " at the captured pace" : "");
+    }
+
+    std::printf("setup    %.3f ms\n", stats.setup_time_ms);
+    std::printf("total    %.3f ms, %.1f frames/s\n", stats.total_time_ms, stats.frames_count * 1000.0 / stats.total_time_ms);
+    print_distribution("submit", stats.submit_times);
+    print_distribution("frame", stats.frame_times);
+    return 0;
+}